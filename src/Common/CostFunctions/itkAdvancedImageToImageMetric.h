@@ -28,6 +28,8 @@
 #include "itkLimiterFunctionBase.h"
 #include "itkFixedArray.h"
 #include "itkAdvancedTransform.h"
+#include "itkTransformSampleCache.h"
+#include "itkSparseDerivativeCostFunction.h"
 #include "vnl/vnl_sparse_matrix.h"
 
 // Needed for checking for B-spline for faster implementation
@@ -35,6 +37,10 @@
 #include "itkAdvancedCombinationTransform.h"
 
 #include "itkMultiThreader.h"
+#include "itkPersistentThreadPool.h"
+#include "itkPhaseProfiler.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkRealTimeClock.h"
 
 namespace itk
 {
@@ -70,6 +76,27 @@ namespace itk
  *    <tt>(MovingImageDerivativeScales 1 1 0)</tt>\n
  *    to penalize deformations in the z-direction. The default value is that
  *    this feature is not used.
+ * \parameter UsePersistentThreadPool: execute the multi-threaded parts of the
+ *    metric on a pool of threads that is kept alive between iterations, instead
+ *    of creating new threads in every iteration. Example:\n
+ *    <tt>(UsePersistentThreadPool "false")</tt>\n
+ *    The default is "true".
+ * \parameter UseDynamicSampleScheduling: distribute the samples over the threads
+ *    dynamically, in chunks, instead of in equal contiguous parts. Threads that
+ *    finish their own part early steal chunks from the others. This helps when
+ *    the cost per sample varies, e.g. with masks or B-spline transforms. Example:\n
+ *    <tt>(UseDynamicSampleScheduling "true")</tt>\n
+ *    The default is "false".
+ * \parameter SampleSchedulingChunkSize: the number of samples that a thread claims
+ *    at once when UseDynamicSampleScheduling is "true". Example:\n
+ *    <tt>(SampleSchedulingChunkSize 256)</tt>\n
+ *    The default is 0, which means that it is determined automatically.
+ * \parameter UseStructureOfArraysSamples: let the image sampler also write its
+ *    output as a structure of arrays, with contiguous arrays of coordinates and
+ *    values, and let the multi-threaded sample loops pass these arrays to the
+ *    transform directly, instead of reading the array of ImageSample structs. Example:\n
+ *    <tt>(UseStructureOfArraysSamples "true")</tt>\n
+ *    The default is "false".
  *
  * \ingroup RegistrationMetrics
  *
@@ -77,7 +104,8 @@ namespace itk
 
 template< class TFixedImage, class TMovingImage >
 class AdvancedImageToImageMetric :
-  public ImageToImageMetric< TFixedImage, TMovingImage >
+  public ImageToImageMetric< TFixedImage, TMovingImage >,
+  public SparseDerivativeCostFunction
 {
 public:
 
@@ -129,6 +157,9 @@ public:
   typedef typename DerivativeType::ValueType                DerivativeValueType;
   typedef typename Superclass::ParametersType               ParametersType;
 
+  /** The type of a sparse derivative, see SparseDerivativeCostFunction. */
+  typedef BlockSparseDerivative SparseDerivativeType;
+
   /** Some useful extra typedefs. */
   typedef typename FixedImageType::PixelType               FixedImagePixelType;
   typedef typename MovingImageType::RegionType             MovingImageRegionType;
@@ -139,6 +170,7 @@ public:
   typedef typename ImageSamplerType::Pointer                      ImageSamplerPointer;
   typedef typename ImageSamplerType::OutputVectorContainerType    ImageSampleContainerType;
   typedef typename ImageSamplerType::OutputVectorContainerPointer ImageSampleContainerPointer;
+  typedef typename ImageSamplerType::ImageSampleContainerSoAType  ImageSampleContainerSoAType;
 
   /** Typedefs for Limiter support. */
   typedef LimiterFunctionBase< RealType, FixedImageDimension >  FixedImageLimiterType;
@@ -154,6 +186,11 @@ public:
     ScalarType, FixedImageDimension, MovingImageDimension >      AdvancedTransformType;
   typedef typename AdvancedTransformType::NumberOfParametersType NumberOfParametersType;
 
+  /** Typedefs for the cache of mapped points and transform Jacobians. */
+  typedef TransformSampleCache<
+    FixedImageType, AdvancedTransformType >                      TransformSampleCacheType;
+  typedef typename TransformSampleCacheType::Pointer             TransformSampleCachePointer;
+
   /** Typedef's for the B-spline transform. */
   typedef AdvancedCombinationTransform< ScalarType, FixedImageDimension >          CombinationTransformType;
   typedef AdvancedBSplineDeformableTransform< ScalarType, FixedImageDimension, 1 > BSplineOrder1TransformType;
@@ -167,6 +204,7 @@ public:
   /** Typedefs for multi-threading. */
   typedef itk::MultiThreader                      ThreaderType;
   typedef typename ThreaderType::ThreadInfoStruct ThreadInfoType;
+  typedef itk::PersistentThreadPool               ThreadPoolType;
 
   /** Public methods ********************/
 
@@ -264,6 +302,14 @@ public:
   /** Set number of threads to use for computations. */
   virtual void SetNumberOfThreads( ThreadIdType numberOfThreads );
 
+  /** Set the parameters of the transform. This hides the function of the
+   * superclass. If UseMetricSingleThreaded is false, the parameters have
+   * already been set by BeforeThreadedGetValueAndDerivative(), and the
+   * transform, which may be shared with concurrently evaluated metrics,
+   * is not touched.
+   */
+  void SetTransformParameters( const TransformParametersType & parameters ) const;
+
   /** Switch the function BeforeThreadedGetValueAndDerivative on or off. */
   itkSetMacro( UseMetricSingleThreaded, bool );
   itkGetConstReferenceMacro( UseMetricSingleThreaded, bool );
@@ -275,6 +321,50 @@ public:
   itkGetConstReferenceMacro( UseMultiThread, bool );
   itkBooleanMacro( UseMultiThread );
 
+  /** Select the use of a persistent thread pool for the multi-threaded
+   * parts of the metric. When switched off the threads are spawned and
+   * joined at every call, using the ITK MultiThreader. Default: true.
+   */
+  itkSetMacro( UsePersistentThreadPool, bool );
+  itkGetConstReferenceMacro( UsePersistentThreadPool, bool );
+  itkBooleanMacro( UsePersistentThreadPool );
+
+  /** Select dynamic (work-stealing) distribution of the samples over the
+   * threads. Each thread starts with its own contiguous part of the samples,
+   * which it processes in chunks; when it is done, it steals chunks from the
+   * end of the part of the thread with the most remaining work.
+   * Note that the order of summation then varies between runs, so results
+   * may differ in the last digits. Default: false.
+   */
+  itkSetMacro( UseDynamicSampleScheduling, bool );
+  itkGetConstReferenceMacro( UseDynamicSampleScheduling, bool );
+  itkBooleanMacro( UseDynamicSampleScheduling );
+
+  /** Set/Get the chunk size used by the dynamic sample scheduling.
+   * The default, 0, selects a chunk size based on the number of samples
+   * and threads. */
+  itkSetMacro( SampleSchedulingChunkSize, SizeValueType );
+  itkGetConstMacro( SampleSchedulingChunkSize, SizeValueType );
+
+  /** Select reading the samples in the multi-threaded sample loops from
+   * the structure-of-arrays output of the image sampler. Default: false.
+   */
+  itkSetMacro( UseStructureOfArraysSamples, bool );
+  itkGetConstReferenceMacro( UseStructureOfArraysSamples, bool );
+  itkBooleanMacro( UseStructureOfArraysSamples );
+
+  /** Get the time in seconds that each thread spent in its sample loop,
+   * during the last multi-threaded pass over the samples. */
+  const std::vector< double > & GetThreadTimings( void ) const
+  {
+    return this->m_ThreadTimings;
+  }
+
+  /** Get the load imbalance of the last multi-threaded pass over the
+   * samples, defined as the maximum divided by the mean thread time.
+   * A value of 1 means perfect balance. */
+  virtual double GetThreadLoadImbalance( void ) const;
+
   /** Contains calls from GetValueAndDerivative that are thread-unsafe,
    * together with preparation for multi-threading.
    * Note that the only reason why this function is not protected, is
@@ -283,6 +373,21 @@ public:
   virtual void BeforeThreadedGetValueAndDerivative(
     const TransformParametersType & parameters ) const;
 
+  /** Set/Get a cache of mapped points and transform Jacobians that is
+   * shared with other metrics, see TransformSampleCache. The multi-threaded
+   * sample loops read it when it holds the samples of the image sampler
+   * of this metric. Default: 0.
+   */
+  itkSetObjectMacro( TransformSampleCache, TransformSampleCacheType );
+  itkGetObjectMacro( TransformSampleCache, TransformSampleCacheType );
+
+  /** Fill the transform sample cache with the current samples of the image
+   * sampler, if the GetValueAndDerivative() of this metric reads it. Like
+   * BeforeThreadedGetValueAndDerivative(), this is public because the
+   * ComboMetric calls it, after BeforeThreadedGetValueAndDerivative().
+   */
+  virtual void UpdateTransformSampleCache( void ) const;
+
 protected:
 
   /** Constructor. */
@@ -325,6 +430,13 @@ protected:
   /** Typedefs for support of sparse Jacobians and compact support of transformations. */
   typedef typename
     AdvancedTransformType::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
+  typedef typename
+    AdvancedTransformType::MovingImageGradientType MovingImageGradientType;
+
+  /** The number of samples that is passed at once to the batched
+   * functions of the transform, see TransformPoints().
+   */
+  itkStaticConstMacro( TransformBatchSize, unsigned int, 32 );
 
   /** Protected Variables **************/
 
@@ -380,10 +492,24 @@ protected:
   /** AccumulateDerivatives threader callback function. */
   static ITK_THREAD_RETURN_TYPE AccumulateDerivativesThreaderCallback( void * arg );
 
+  /** Execute a threader callback on m_NumberOfThreads threads and wait for
+   * them to finish. Dispatches to the persistent thread pool, or to the
+   * ITK MultiThreader when UsePersistentThreadPool is false.
+   */
+  void ExecuteThreaderCallback( ThreadFunctionType callback, void * userData ) const;
+
   /** Variables for multi-threading. */
-  bool m_UseMetricSingleThreaded;
-  bool m_UseMultiThread;
-  bool m_UseOpenMP;
+  bool                    m_UseMetricSingleThreaded;
+  bool                    m_UseMultiThread;
+  bool                    m_UseOpenMP;
+  bool                    m_UsePersistentThreadPool;
+  ThreadPoolType::Pointer m_ThreadPool;
+  bool                    m_UseDynamicSampleScheduling;
+  SizeValueType           m_SampleSchedulingChunkSize;
+  bool                    m_UseStructureOfArraysSamples;
+
+  /** The cache of mapped points and transform Jacobians, shared with other metrics. */
+  TransformSampleCachePointer m_TransformSampleCache;
 
   /** Helper structs that multi-threads the computation of
    * the metric derivative using ITK threads.
@@ -424,6 +550,138 @@ protected:
   /** Initialize some multi-threading related parameters. */
   virtual void InitializeThreadingParameters( void ) const;
 
+  /** Variables for the sample scheduler. Each thread owns the sample
+   * range [st_Begin, st_End[, from which it claims chunks at the front.
+   * Other threads may steal chunks from the back.
+   */
+  struct SampleSchedulerPerThreadStruct
+  {
+    SizeValueType st_Begin;
+    SizeValueType st_End;
+    bool          st_Started;
+    double        st_StartTime;
+  };
+  mutable std::vector< SampleSchedulerPerThreadStruct > m_SampleSchedulerPerThreadVariables;
+  mutable std::vector< double >                         m_ThreadTimings;
+  mutable SimpleFastMutexLock                           m_SampleSchedulerMutex;
+  mutable SizeValueType                                 m_SampleSchedulerChunkSize;
+  RealTimeClock::Pointer                                m_SampleSchedulerClock;
+
+  /** Distribute numberOfSamples samples over the threads. Must be called
+   * single-threadedly before every multi-threaded pass over the samples;
+   * LaunchGetValueAndDerivativeThreaderCallback() does this for the
+   * samples of the image sampler.
+   */
+  virtual void InitializeSampleScheduler( SizeValueType numberOfSamples ) const;
+
+  /** Get the next range of samples [begin, end[ to be processed by thread
+   * threadId. Returns false when there are no samples left. Without dynamic
+   * scheduling this returns the equal contiguous part of the thread once.
+   * Typical use in ThreadedGetValueAndDerivative():\n
+   * <tt>while( this->GetNextSampleRange( threadId, pos_begin, pos_end ) ) { ... }</tt>
+   */
+  bool GetNextSampleRange( ThreadIdType threadId,
+    SizeValueType & begin, SizeValueType & end ) const;
+
+  /** The sample container read by the multi-threaded sample loops, in
+   * one of both layouts. The structure-of-arrays pointer is 0 when
+   * UseStructureOfArraysSamples is false.
+   */
+  mutable const ImageSampleContainerType *    m_ThreaderSamples;
+  mutable const ImageSampleContainerSoAType * m_ThreaderSamplesSoA;
+
+  /** Prepare the samples of the image sampler for a multi-threaded pass:
+   * sets m_ThreaderSamples and m_ThreaderSamplesSoA, and initializes the
+   * sample scheduler. Must be called after the image sampler has been
+   * updated. The samples are only read, so the sub metrics of a
+   * CombinationImageToImageMetric may call this concurrently on a shared
+   * image sampler.
+   */
+  virtual void InitializeThreaderSamples( void ) const;
+
+  /** Read the coordinates and the value of sample i, in a multi-threaded
+   * sample loop. InitializeThreaderSamples() must have been called.
+   */
+  void GetThreaderSample( SizeValueType i,
+    FixedImagePointType & fixedPoint, RealType & fixedImageValue ) const
+  {
+    if( this->m_ThreaderSamplesSoA )
+    {
+      typename ImageSampleContainerSoAType::RealType value;
+      this->m_ThreaderSamplesSoA->GetSample( i, fixedPoint, value );
+      fixedImageValue = static_cast< RealType >( value );
+    }
+    else
+    {
+      const typename ImageSampleContainerType::Element & sample
+        = this->m_ThreaderSamples->ElementAt( i );
+      fixedPoint      = sample.m_ImageCoordinates;
+      fixedImageValue = static_cast< RealType >( sample.m_ImageValue );
+    }
+  }
+
+
+  /** The entry of the transform sample cache for the samples of the
+   * multi-threaded sample loops, or 0. Set by InitializeThreaderSamples().
+   */
+  mutable const typename TransformSampleCacheType::CachedSamplesType * m_ThreaderCachedSamples;
+
+  /** Whether the GetValueAndDerivative() of this metric reads the transform
+   * sample cache, with the current settings. Default: false.
+   */
+  virtual bool GetReadsTransformSampleCache( void ) const { return false; }
+
+  /** Transform sample i of a multi-threaded sample loop, like
+   * TransformPoint(). The mapped point is read from the transform sample
+   * cache, if it holds the samples.
+   */
+  bool TransformThreaderSample( SizeValueType i,
+    const FixedImagePointType & fixedPoint, MovingImagePointType & mappedPoint ) const
+  {
+    if( this->m_ThreaderCachedSamples )
+    {
+      mappedPoint = this->m_ThreaderCachedSamples->m_MappedPoints[ i ];
+      return true;
+    }
+    return this->TransformPoint( fixedPoint, mappedPoint );
+  }
+
+
+  /** Transform the samples [begin, begin + numberOfSamples) of a
+   * multi-threaded sample loop in one batch, like TransformPoints(). With
+   * structure-of-arrays samples, the coordinate arrays are passed to the
+   * transform directly. The mapped points are read from the transform
+   * sample cache, if it holds the samples. The number of samples may not
+   * exceed TransformBatchSize.
+   */
+  void TransformThreaderSamples( SizeValueType begin,
+    SizeValueType numberOfSamples, MovingImagePointType * mappedPoints ) const;
+
+  /** Compute the inner product of the transform Jacobian of sample i of a
+   * multi-threaded sample loop and the moving image gradient, like
+   * AdvancedTransform::EvaluateJacobianWithImageGradientProduct(). The
+   * Jacobian is read from the transform sample cache, if it holds the samples.
+   */
+  void EvaluateThreaderSampleJacobianWithImageGradientProduct( SizeValueType i,
+    const FixedImagePointType & fixedPoint,
+    const MovingImageDerivativeType & movingImageDerivative,
+    DerivativeType & imageJacobian, NonZeroJacobianIndicesType & nzji ) const
+  {
+    if( this->m_ThreaderCachedSamples )
+    {
+      nzji = this->m_ThreaderCachedSamples->m_NonZeroJacobianIndices[ i ];
+      this->EvaluateTransformJacobianInnerProduct(
+        this->m_ThreaderCachedSamples->m_Jacobians[ i ], movingImageDerivative, imageJacobian );
+    }
+    else
+    {
+      this->m_AdvancedTransform->EvaluateJacobianWithImageGradientProduct(
+        fixedPoint, movingImageDerivative, imageJacobian, nzji );
+    }
+  }
+
+
+
   /** Protected methods ************** */
 
   /** Methods for image sampler support **********/
@@ -487,6 +745,15 @@ protected:
     const FixedImagePointType & fixedImagePoint,
     MovingImagePointType & mappedPoint ) const;
 
+  /** Transform a batch of points from FixedImage domain to MovingImage domain,
+   * with a single call to the transform. As for TransformPoint(), all
+   * mapped points are currently considered to be valid.
+   */
+  virtual void TransformPoints(
+    const FixedImagePointType * fixedImagePoints,
+    MovingImagePointType * mappedPoints,
+    SizeValueType numberOfPoints ) const;
+
   /** This function returns a reference to the transform Jacobians.
    * This is either a reference to the full TransformJacobian or
    * a reference to a sparse Jacobians.
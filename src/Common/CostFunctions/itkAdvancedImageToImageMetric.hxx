@@ -23,6 +23,7 @@
 #include "itkImageRegionConstIterator.h"          // used for extrema computation
 #include "itkImageRegionConstIteratorWithIndex.h" // used for extrema computation
 #include "itkAdvancedRayCastInterpolateImageFunction.h"
+#include <algorithm> // for std::max, std::copy
 
 #ifdef ELASTIX_USE_OPENMP
 #include <omp.h>
@@ -88,6 +89,25 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   this->m_Threader->SetUseThreadPool( false ); // setting to true makes elastix hang
                                                // at a WaitForSingleMethodThread()
 
+  /** Our own pool of persistent threads. The threads are created lazily,
+   * at the first multi-threaded call.
+   */
+  this->m_UsePersistentThreadPool = true;
+  this->m_ThreadPool              = ThreadPoolType::New();
+  this->m_ThreadPool->SetNumberOfThreads( this->m_NumberOfThreads );
+
+  /** Sample scheduling related variables. */
+  this->m_UseDynamicSampleScheduling = false;
+  this->m_SampleSchedulingChunkSize  = 0;
+  this->m_SampleSchedulerChunkSize   = 1;
+  this->m_SampleSchedulerClock       = RealTimeClock::New();
+
+  /** Sample layout read by the threads. */
+  this->m_UseStructureOfArraysSamples = false;
+  this->m_ThreaderSamples             = 0;
+  this->m_ThreaderSamplesSoA          = 0;
+  this->m_ThreaderCachedSamples       = 0;
+
   /** OpenMP related. Switch to on when available */
 #ifdef ELASTIX_USE_OPENMP
   this->m_UseOpenMP = true;
@@ -130,6 +150,7 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 ::SetNumberOfThreads( ThreadIdType numberOfThreads )
 {
   Superclass::SetNumberOfThreads( numberOfThreads );
+  this->m_ThreadPool->SetNumberOfThreads( this->m_NumberOfThreads );
 
 #ifdef ELASTIX_USE_OPENMP
   const int nthreads = static_cast< int >( this->m_NumberOfThreads );
@@ -213,6 +234,222 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 } // end InitializeThreadingParameters()
 
 
+/**
+ * ********************* InitializeSampleScheduler ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::InitializeSampleScheduler( SizeValueType numberOfSamples ) const
+{
+  const ThreadIdType nrOfThreads = this->m_NumberOfThreads;
+  this->m_SampleSchedulerPerThreadVariables.resize( nrOfThreads );
+  this->m_ThreadTimings.assign( nrOfThreads, 0.0 );
+
+  /** Start with the same equal contiguous parts as the static scheduling,
+   * so that without imbalance every thread only processes its own part.
+   */
+  const SizeValueType nrOfSamplesPerThread
+    = ( numberOfSamples + nrOfThreads - 1 ) / nrOfThreads;
+  for( ThreadIdType i = 0; i < nrOfThreads; ++i )
+  {
+    SizeValueType begin = nrOfSamplesPerThread * i;
+    SizeValueType end   = begin + nrOfSamplesPerThread;
+    begin = ( begin > numberOfSamples ) ? numberOfSamples : begin;
+    end   = ( end > numberOfSamples ) ? numberOfSamples : end;
+
+    this->m_SampleSchedulerPerThreadVariables[ i ].st_Begin     = begin;
+    this->m_SampleSchedulerPerThreadVariables[ i ].st_End       = end;
+    this->m_SampleSchedulerPerThreadVariables[ i ].st_Started   = false;
+    this->m_SampleSchedulerPerThreadVariables[ i ].st_StartTime = 0.0;
+  }
+
+  /** Determine the chunk size. By default aim at 16 chunks per thread,
+   * with a minimum of 32 samples to keep the locking overhead low.
+   */
+  this->m_SampleSchedulerChunkSize = this->m_SampleSchedulingChunkSize;
+  if( this->m_SampleSchedulerChunkSize == 0 )
+  {
+    this->m_SampleSchedulerChunkSize = nrOfSamplesPerThread / 16;
+    if( this->m_SampleSchedulerChunkSize < 32 )
+    {
+      this->m_SampleSchedulerChunkSize = 32;
+    }
+  }
+
+} // end InitializeSampleScheduler()
+
+
+/**
+ * ********************* GetNextSampleRange ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+bool
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::GetNextSampleRange( ThreadIdType threadId,
+  SizeValueType & begin, SizeValueType & end ) const
+{
+  SampleSchedulerPerThreadStruct & own
+    = this->m_SampleSchedulerPerThreadVariables[ threadId ];
+
+  /** Start the timer of this thread at its first request. */
+  if( !own.st_Started )
+  {
+    own.st_Started   = true;
+    own.st_StartTime = this->m_SampleSchedulerClock->GetTimeInSeconds();
+  }
+
+  bool found = false;
+  if( !this->m_UseDynamicSampleScheduling )
+  {
+    /** Static scheduling: hand out the own part at once. Only this thread
+     * accesses its own part, so no locking is needed. */
+    if( own.st_Begin < own.st_End )
+    {
+      begin        = own.st_Begin;
+      end          = own.st_End;
+      own.st_Begin = own.st_End;
+      found        = true;
+    }
+  }
+  else
+  {
+    const SizeValueType chunkSize = this->m_SampleSchedulerChunkSize;
+    this->m_SampleSchedulerMutex.Lock();
+    if( own.st_Begin < own.st_End )
+    {
+      /** Claim a chunk from the front of the own part. */
+      begin        = own.st_Begin;
+      end          = ( own.st_End - begin > chunkSize ) ? begin + chunkSize : own.st_End;
+      own.st_Begin = end;
+      found        = true;
+    }
+    else
+    {
+      /** Steal a chunk from the back of the part with the most work left. */
+      SizeValueType mostRemaining = 0;
+      ThreadIdType  victim        = 0;
+      for( ThreadIdType i = 0; i < this->m_SampleSchedulerPerThreadVariables.size(); ++i )
+      {
+        const SampleSchedulerPerThreadStruct & other = this->m_SampleSchedulerPerThreadVariables[ i ];
+        const SizeValueType remaining = other.st_End - other.st_Begin;
+        if( remaining > mostRemaining )
+        {
+          mostRemaining = remaining;
+          victim        = i;
+        }
+      }
+      if( mostRemaining > 0 )
+      {
+        SampleSchedulerPerThreadStruct & other = this->m_SampleSchedulerPerThreadVariables[ victim ];
+        end          = other.st_End;
+        begin        = ( mostRemaining > chunkSize ) ? end - chunkSize : other.st_Begin;
+        other.st_End = begin;
+        found        = true;
+      }
+    }
+    this->m_SampleSchedulerMutex.Unlock();
+  }
+
+  /** Stop the timer of this thread when it runs out of work. */
+  if( !found )
+  {
+    this->m_ThreadTimings[ threadId ]
+      = this->m_SampleSchedulerClock->GetTimeInSeconds() - own.st_StartTime;
+  }
+
+  return found;
+
+} // end GetNextSampleRange()
+
+
+/**
+ * ********************* GetThreadLoadImbalance ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+double
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::GetThreadLoadImbalance( void ) const
+{
+  double maxTime = 0.0;
+  double sumTime = 0.0;
+  for( std::size_t i = 0; i < this->m_ThreadTimings.size(); ++i )
+  {
+    maxTime  = std::max( maxTime, this->m_ThreadTimings[ i ] );
+    sumTime += this->m_ThreadTimings[ i ];
+  }
+
+  if( sumTime <= 0.0 ) { return 1.0; }
+  return maxTime * static_cast< double >( this->m_ThreadTimings.size() ) / sumTime;
+
+} // end GetThreadLoadImbalance()
+
+
+/**
+ * ********************* InitializeThreaderSamples ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::InitializeThreaderSamples( void ) const
+{
+  this->m_ThreaderSamples    = this->GetImageSampler()->GetOutput();
+  this->m_ThreaderSamplesSoA = 0;
+  if( this->m_UseStructureOfArraysSamples )
+  {
+    /** The sampler generates the structure of arrays together with its
+     * output, see BeforeThreadedGetValueAndDerivative().
+     */
+    this->m_ThreaderSamplesSoA = this->GetImageSampler()->GetOutputSoA();
+    if( this->m_ThreaderSamplesSoA->Size() != this->m_ThreaderSamples->Size() )
+    {
+      itkExceptionMacro( << "ERROR: the structure-of-arrays samples do not match the "
+                         << "samples of the image sampler. Set GenerateOutputSoA of the "
+                         << "image sampler before updating it." );
+    }
+  }
+
+  /** Read the mapped points and Jacobians from the transform sample cache,
+   * if it holds these samples.
+   */
+  this->m_ThreaderCachedSamples = 0;
+  if( this->m_TransformSampleCache.IsNotNull() )
+  {
+    this->m_ThreaderCachedSamples = this->m_TransformSampleCache->Find(
+      this->m_ThreaderSamples, this->m_AdvancedTransform );
+  }
+
+  /** Distribute the samples over the threads. */
+  this->InitializeSampleScheduler( this->m_ThreaderSamples->Size() );
+
+} // end InitializeThreaderSamples()
+
+
+/**
+ * ********************* UpdateTransformSampleCache ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::UpdateTransformSampleCache( void ) const
+{
+  if( this->m_TransformSampleCache.IsNull() || !this->m_UseImageSampler
+    || !this->GetReadsTransformSampleCache() )
+  {
+    return;
+  }
+
+  this->m_TransformSampleCache->Update(
+    this->GetImageSampler()->GetOutput(), this->m_AdvancedTransform );
+
+} // end UpdateTransformSampleCache()
+
+
 /**
  * ****************** ComputeFixedImageExtrema ***************************
  */
@@ -417,6 +654,12 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
     this->m_ImageSampler->SetInput( this->m_FixedImage );
     this->m_ImageSampler->SetMask( this->m_FixedImageMask );
     this->m_ImageSampler->SetInputImageRegion( this->GetFixedImageRegion() );
+
+    /** Let the sampler also generate the structure-of-arrays samples. */
+    if( this->m_UseStructureOfArraysSamples )
+    {
+      this->m_ImageSampler->GenerateOutputSoAOn();
+    }
   }
 
 } // end InitializeImageSampler()
@@ -814,6 +1057,66 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 } // end TransformPoint()
 
 
+/**
+ * ********************** TransformPoints ************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::TransformPoints(
+  const FixedImagePointType * fixedImagePoints,
+  MovingImagePointType * mappedPoints,
+  SizeValueType numberOfPoints ) const
+{
+  this->m_AdvancedTransform->TransformPoints(
+    fixedImagePoints, mappedPoints, numberOfPoints );
+
+} // end TransformPoints()
+
+
+/**
+ * ********************** TransformThreaderSamples ************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::TransformThreaderSamples(
+  SizeValueType begin,
+  SizeValueType numberOfSamples,
+  MovingImagePointType * mappedPoints ) const
+{
+  if( this->m_ThreaderCachedSamples )
+  {
+    std::copy( this->m_ThreaderCachedSamples->m_MappedPoints.begin() + begin,
+      this->m_ThreaderCachedSamples->m_MappedPoints.begin() + begin + numberOfSamples,
+      mappedPoints );
+  }
+  else if( this->m_ThreaderSamplesSoA )
+  {
+    /** Pass the coordinate arrays of the samples to the transform. */
+    const typename ImageSampleContainerSoAType::CoordRepType * coordinates[ FixedImageDimension ];
+    for( unsigned int d = 0; d < FixedImageDimension; ++d )
+    {
+      coordinates[ d ] = this->m_ThreaderSamplesSoA->GetCoordinates( d ) + begin;
+    }
+    this->m_AdvancedTransform->TransformPointsSoA( coordinates, mappedPoints, numberOfSamples );
+  }
+  else
+  {
+    /** Gather the samples, and transform them in one call. */
+    FixedImagePointType fixedPoints[ Self::TransformBatchSize ];
+    for( SizeValueType k = 0; k < numberOfSamples; ++k )
+    {
+      fixedPoints[ k ] = this->m_ThreaderSamples->ElementAt( begin + k ).m_ImageCoordinates;
+    }
+    this->TransformPoints( fixedPoints, mappedPoints, numberOfSamples );
+  }
+
+} // end TransformThreaderSamples()
+
+
 /**
  * *************** EvaluateTransformJacobian ****************
  */
@@ -884,6 +1187,28 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 } // end GetSelfHessian()
 
 
+/**
+ * *********************** SetTransformParameters ***********************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::SetTransformParameters( const TransformParametersType & parameters ) const
+{
+  /** The CombinationImageToImageMetric sets the parameters once, before
+   * evaluating its sub-metrics (concurrently).
+   */
+  if( !this->m_UseMetricSingleThreaded )
+  {
+    return;
+  }
+
+  this->Superclass::SetTransformParameters( parameters );
+
+} // end SetTransformParameters()
+
+
 /**
  * *********************** BeforeThreadedGetValueAndDerivative ***********************
  */
@@ -893,12 +1218,23 @@ void
 AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 ::BeforeThreadedGetValueAndDerivative( const TransformParametersType & parameters ) const
 {
-  /** In this function do all stuff that cannot be multi-threaded. */
+  /** Profile this phase, if desired. The sampler is profiled as a child. */
+  PhaseProfiler::ScopedProbe probe( "BeforeThreadedGetValueAndDerivative" );
+
+  /** In this function do all stuff that cannot be multi-threaded. The
+   * structure-of-arrays samples are generated by the image sampler in its
+   * update. The option is never switched off here, since that would let
+   * a sampler that is shared with other metrics select new samples.
+   */
   if( this->m_UseMetricSingleThreaded )
   {
     this->SetTransformParameters( parameters );
     if( this->m_UseImageSampler )
     {
+      if( this->m_UseStructureOfArraysSamples )
+      {
+        this->GetImageSampler()->GenerateOutputSoAOn();
+      }
       this->GetImageSampler()->Update();
     }
   }
@@ -937,16 +1273,49 @@ void
 AdvancedImageToImageMetric< TFixedImage, TMovingImage >
 ::LaunchGetValueAndDerivativeThreaderCallback( void ) const
 {
-  /** Setup threader. */
-  this->m_Threader->SetSingleMethod( this->GetValueAndDerivativeThreaderCallback,
-    const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ) );
+  /** Profile the threaded transformation, interpolation and derivative
+   * computation as one phase, if desired.
+   */
+  PhaseProfiler::ScopedProbe probe( "ThreadedGetValueAndDerivative" );
+
+  /** Prepare the samples for the threads. */
+  if( this->m_UseImageSampler )
+  {
+    this->InitializeThreaderSamples();
+  }
 
-  /** Launch. */
-  this->m_Threader->SingleMethodExecute();
+  /** Setup threader and launch. */
+  this->ExecuteThreaderCallback( this->GetValueAndDerivativeThreaderCallback,
+    const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ) );
 
 } // end LaunchGetValueAndDerivativeThreaderCallback()
 
 
+/**
+ * *********************** ExecuteThreaderCallback ***************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+AdvancedImageToImageMetric< TFixedImage, TMovingImage >
+::ExecuteThreaderCallback( ThreadFunctionType callback, void * userData ) const
+{
+  if( this->m_UsePersistentThreadPool )
+  {
+    /** The pool only restarts its threads when the number of threads changed. */
+    this->m_ThreadPool->SetNumberOfThreads( this->m_NumberOfThreads );
+    this->m_ThreadPool->SetSingleMethod( callback, userData );
+    this->m_ThreadPool->SingleMethodExecute();
+  }
+  else
+  {
+    this->m_Threader->SetSingleMethod( callback, userData );
+    this->m_Threader->SingleMethodExecute();
+  }
+
+} // end ExecuteThreaderCallback()
+
+
 /**
  *********** AccumulateDerivativesThreaderCallback *************
  */
@@ -1092,6 +1461,19 @@ AdvancedImageToImageMetric< TFixedImage, TMovingImage >
   os << indent.GetNextIndent() << "MovingImageDerivativeScales: "
      << this->m_MovingImageDerivativeScales << std::endl;
 
+  /** Variables related to multi-threading. */
+  os << indent << "Variables related to multi-threading: " << std::endl;
+  os << indent.GetNextIndent() << "UseMultiThread: "
+     << this->m_UseMultiThread << std::endl;
+  os << indent.GetNextIndent() << "UsePersistentThreadPool: "
+     << this->m_UsePersistentThreadPool << std::endl;
+  os << indent.GetNextIndent() << "UseDynamicSampleScheduling: "
+     << this->m_UseDynamicSampleScheduling << std::endl;
+  os << indent.GetNextIndent() << "SampleSchedulingChunkSize: "
+     << this->m_SampleSchedulingChunkSize << std::endl;
+  os << indent.GetNextIndent() << "UseStructureOfArraysSamples: "
+     << this->m_UseStructureOfArraysSamples << std::endl;
+
 } // end PrintSelf()
 
 
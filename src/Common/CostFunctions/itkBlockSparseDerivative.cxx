@@ -0,0 +1,252 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkBlockSparseDerivative_cxx
+#define __itkBlockSparseDerivative_cxx
+
+#include "itkBlockSparseDerivative.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+const SizeValueType BlockSparseDerivative::UnusedBlock = static_cast< SizeValueType >( -1 );
+
+/**
+ * ******************* Constructor *******************
+ */
+
+BlockSparseDerivative
+::BlockSparseDerivative()
+{
+  this->m_Size = 0;
+
+} // end Constructor()
+
+
+/**
+ * ******************* SetSize *******************
+ */
+
+void
+BlockSparseDerivative
+::SetSize( SizeValueType numberOfParameters )
+{
+  const SizeValueType blockSize = BlockSize;
+  this->m_Size = numberOfParameters;
+  this->m_BlockOffsets.assign( ( numberOfParameters + blockSize - 1 ) / blockSize, UnusedBlock );
+  this->m_Blocks.clear();
+  this->m_Values.clear();
+
+} // end SetSize()
+
+
+/**
+ * ******************* Clear *******************
+ */
+
+void
+BlockSparseDerivative
+::Clear( void )
+{
+  /** Only reset the allocated blocks, keeping the storage. */
+  for( SizeValueType k = 0; k < this->m_Blocks.size(); ++k )
+  {
+    this->m_BlockOffsets[ this->m_Blocks[ k ] ] = UnusedBlock;
+  }
+  this->m_Blocks.clear();
+  this->m_Values.clear();
+
+} // end Clear()
+
+
+/**
+ * ******************* AllocateBlock *******************
+ */
+
+SizeValueType
+BlockSparseDerivative
+::AllocateBlock( const SizeValueType block )
+{
+  const SizeValueType offset = this->m_Values.size();
+  this->m_BlockOffsets[ block ] = offset;
+  this->m_Blocks.push_back( block );
+  this->m_Values.resize( offset + BlockSize, 0.0 );
+  return offset;
+
+} // end AllocateBlock()
+
+
+/**
+ * ******************* GetBlockLength *******************
+ */
+
+SizeValueType
+BlockSparseDerivative
+::GetBlockLength( const SizeValueType k ) const
+{
+  /** The last block may extend beyond the number of parameters. */
+  const SizeValueType blockSize = BlockSize;
+  const SizeValueType begin     = this->m_Blocks[ k ] * blockSize;
+  return std::min( blockSize, this->m_Size - begin );
+
+} // end GetBlockLength()
+
+
+/**
+ * ******************* GetElement *******************
+ */
+
+BlockSparseDerivative::ValueType
+BlockSparseDerivative
+::GetElement( const SizeValueType j ) const
+{
+  const SizeValueType offset = this->m_BlockOffsets[ j / BlockSize ];
+  if( offset == UnusedBlock )
+  {
+    return 0.0;
+  }
+  return this->m_Values[ offset + j % BlockSize ];
+
+} // end GetElement()
+
+
+/**
+ * ******************* operator*= *******************
+ */
+
+BlockSparseDerivative &
+BlockSparseDerivative
+::operator*=( const ValueType factor )
+{
+  for( SizeValueType i = 0; i < this->m_Values.size(); ++i )
+  {
+    this->m_Values[ i ] *= factor;
+  }
+  return *this;
+
+} // end operator*=()
+
+
+/**
+ * ******************* operator/= *******************
+ */
+
+BlockSparseDerivative &
+BlockSparseDerivative
+::operator/=( const ValueType factor )
+{
+  for( SizeValueType i = 0; i < this->m_Values.size(); ++i )
+  {
+    this->m_Values[ i ] /= factor;
+  }
+  return *this;
+
+} // end operator/=()
+
+
+/**
+ * ******************* Add *******************
+ */
+
+void
+BlockSparseDerivative
+::Add( const Self & other, const ValueType weight )
+{
+  for( SizeValueType k = 0; k < other.GetNumberOfBlocks(); ++k )
+  {
+    const SizeValueType block  = other.m_Blocks[ k ];
+    SizeValueType       offset = this->m_BlockOffsets[ block ];
+    if( offset == UnusedBlock )
+    {
+      offset = this->AllocateBlock( block );
+    }
+
+    const ValueType * otherValues = other.GetBlockValues( k );
+    ValueType *       values      = &this->m_Values[ offset ];
+    for( SizeValueType i = 0; i < BlockSize; ++i )
+    {
+      values[ i ] += weight * otherValues[ i ];
+    }
+  }
+
+} // end Add()
+
+
+/**
+ * ******************* AddTo *******************
+ */
+
+void
+BlockSparseDerivative
+::AddTo( DenseDerivativeType & dense, const ValueType weight ) const
+{
+  for( SizeValueType k = 0; k < this->m_Blocks.size(); ++k )
+  {
+    const SizeValueType begin  = this->m_Blocks[ k ] * BlockSize;
+    const SizeValueType length = this->GetBlockLength( k );
+    const ValueType *   values = this->GetBlockValues( k );
+    ValueType *         target = dense.data_block() + begin;
+    for( SizeValueType i = 0; i < length; ++i )
+    {
+      target[ i ] += weight * values[ i ];
+    }
+  }
+
+} // end AddTo()
+
+
+/**
+ * ******************* GetDense *******************
+ */
+
+void
+BlockSparseDerivative
+::GetDense( DenseDerivativeType & dense ) const
+{
+  dense.SetSize( this->m_Size );
+  dense.Fill( 0.0 );
+  this->AddTo( dense, 1.0 );
+
+} // end GetDense()
+
+
+/**
+ * ******************* GetSquaredMagnitude *******************
+ */
+
+double
+BlockSparseDerivative
+::GetSquaredMagnitude( void ) const
+{
+  /** Elements beyond the number of parameters are never touched, so all
+   * values of the allocated blocks can be summed.
+   */
+  double sumOfSquares = 0.0;
+  for( SizeValueType i = 0; i < this->m_Values.size(); ++i )
+  {
+    sumOfSquares += this->m_Values[ i ] * this->m_Values[ i ];
+  }
+  return sumOfSquares;
+
+} // end GetSquaredMagnitude()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkBlockSparseDerivative_cxx
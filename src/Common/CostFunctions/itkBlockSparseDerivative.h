@@ -0,0 +1,167 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkBlockSparseDerivative_h
+#define __itkBlockSparseDerivative_h
+
+#include "itkArray.h"
+#include "itkIntTypes.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class BlockSparseDerivative
+ *
+ * \brief A derivative that only stores the blocks of parameters that were
+ * touched.
+ *
+ * The parameters are divided into blocks of BlockSize consecutive
+ * parameters. A block is allocated, and set to zero, the first time one
+ * of its elements is accessed with operator[]; blocks that were never
+ * accessed are zero. Penalty terms, such as the corresponding points
+ * metric, only touch the B-spline coefficients near a few points, so
+ * that scaling, adding and computing the magnitude of such a derivative
+ * costs time proportional to the number of touched blocks instead of the
+ * number of parameters.
+ *
+ * Clear() only resets the allocated blocks and keeps the storage, so a
+ * derivative can be reused every iteration. Note that a reference
+ * returned by operator[] is invalidated by the next access of a new
+ * block. The class is not thread-safe.
+ *
+ * \ingroup RegistrationMetrics
+ */
+
+class BlockSparseDerivative
+{
+public:
+
+  /** Typedefs. */
+  typedef BlockSparseDerivative Self;
+  typedef double                ValueType;
+  typedef Array< ValueType >    DenseDerivativeType;
+
+  /** The number of parameters per block. */
+  itkStaticConstMacro( BlockSize, SizeValueType, 64 );
+
+  /** The constructor. */
+  BlockSparseDerivative();
+
+  /** Set the number of parameters. This also clears the derivative. */
+  void SetSize( SizeValueType numberOfParameters );
+
+  /** Get the number of parameters. */
+  SizeValueType GetSize( void ) const
+  {
+    return this->m_Size;
+  }
+
+
+  /** Set all elements to zero, by releasing the allocated blocks. */
+  void Clear( void );
+
+  /** Get a reference to element j, allocating its block if needed. */
+  ValueType & operator[]( const SizeValueType j )
+  {
+    const SizeValueType block  = j / BlockSize;
+    SizeValueType       offset = this->m_BlockOffsets[ block ];
+    if( offset == UnusedBlock )
+    {
+      offset = this->AllocateBlock( block );
+    }
+    return this->m_Values[ offset + j % BlockSize ];
+  }
+
+
+  /** Get element j, which is zero if its block was not allocated. */
+  ValueType GetElement( const SizeValueType j ) const;
+
+  /** Get the number of allocated blocks. */
+  SizeValueType GetNumberOfBlocks( void ) const
+  {
+    return this->m_Blocks.size();
+  }
+
+
+  /** Get the block index of the k-th allocated block. Its elements are the
+   * parameters BlockSize * index up to BlockSize * ( index + 1 ), clipped
+   * to GetSize().
+   */
+  SizeValueType GetBlockIndex( const SizeValueType k ) const
+  {
+    return this->m_Blocks[ k ];
+  }
+
+
+  /** Get the values of the k-th allocated block. */
+  ValueType * GetBlockValues( const SizeValueType k )
+  {
+    return &this->m_Values[ k * BlockSize ];
+  }
+
+
+  const ValueType * GetBlockValues( const SizeValueType k ) const
+  {
+    return &this->m_Values[ k * BlockSize ];
+  }
+
+
+  /** Multiply or divide all elements by a scalar. */
+  Self & operator*=( const ValueType factor );
+
+  Self & operator/=( const ValueType factor );
+
+  /** Add weight * other to this derivative, allocating blocks as needed. */
+  void Add( const Self & other, const ValueType weight );
+
+  /** Add weight * this derivative to a dense array of the same size,
+   * only touching the elements of the allocated blocks.
+   */
+  void AddTo( DenseDerivativeType & dense, const ValueType weight ) const;
+
+  /** Copy this derivative into a dense array. */
+  void GetDense( DenseDerivativeType & dense ) const;
+
+  /** Get the sum of squares of all elements. */
+  double GetSquaredMagnitude( void ) const;
+
+private:
+
+  /** Allocate a zero block and return its offset in m_Values. */
+  SizeValueType AllocateBlock( const SizeValueType block );
+
+  /** The number of elements of the k-th allocated block. */
+  SizeValueType GetBlockLength( const SizeValueType k ) const;
+
+  /** The offset of an unallocated block. */
+  static const SizeValueType UnusedBlock;
+
+  /** The number of parameters, the offset in m_Values of every block,
+   * the indices of the allocated blocks and their values.
+   */
+  SizeValueType                m_Size;
+  std::vector< SizeValueType > m_BlockOffsets;
+  std::vector< SizeValueType > m_Blocks;
+  std::vector< ValueType >     m_Values;
+
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __itkBlockSparseDerivative_h
@@ -24,6 +24,7 @@
 #include "itkImageLinearIteratorWithIndex.h"
 #include "itkImageScanlineIterator.h"
 #include "vnl/vnl_math.h"
+#include <algorithm> // for std::min
 
 namespace itk
 {
@@ -1165,73 +1166,68 @@ ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
   JointPDFPointer & jointPDF = this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ threadId ].st_JointPDF;
   jointPDF->FillBuffer( NumericTraits< PDFValueType >::ZeroValue() );
 
-  /** Get a handle to the sample container. */
-  ImageSampleContainerPointer sampleContainer     = this->GetImageSampler()->GetOutput();
-  const unsigned long         sampleContainerSize = sampleContainer->Size();
-
-  /** Get the samples for this thread. */
-  const unsigned long nrOfSamplesPerThreads
-    = static_cast< unsigned long >( vcl_ceil( static_cast< double >( sampleContainerSize )
-    / static_cast< double >( this->m_NumberOfThreads ) ) );
-
-  unsigned long pos_begin = nrOfSamplesPerThreads * threadId;
-  unsigned long pos_end   = nrOfSamplesPerThreads * ( threadId + 1 );
-  pos_begin = ( pos_begin > sampleContainerSize ) ? sampleContainerSize : pos_begin;
-  pos_end   = ( pos_end > sampleContainerSize ) ? sampleContainerSize : pos_end;
-
-  /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator fiter;
-  typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator fend   = sampleContainer->Begin();
-  fbegin                                                 += (int)pos_begin;
-  fend                                                   += (int)pos_end;
+  /** The samples are handed out to this thread in one or more ranges
+   * [pos_begin, pos_end) by the sample scheduler.
+   */
+  SizeValueType pos_begin = 0;
+  SizeValueType pos_end   = 0;
 
   /** Create variables to store intermediate results. circumvent false sharing */
   unsigned long numberOfPixelsCounted = 0;
 
-  /** Loop over sample container and compute contribution of each sample to pdfs. */
-  for( fiter = fbegin; fiter != fend; ++fiter )
+  /** The samples are transformed in batches, see TransformThreaderSamples(). */
+  const SizeValueType  batchSize = Superclass::TransformBatchSize;
+  MovingImagePointType mappedPoints[ Superclass::TransformBatchSize ];
+
+  /** Loop over the sample ranges assigned to this thread. */
+  while( this->GetNextSampleRange( threadId, pos_begin, pos_end ) )
   {
-    /** Read fixed coordinates and initialize some variables. */
-    const FixedImagePointType & fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
-    RealType                    movingImageValue;
-    MovingImagePointType        mappedPoint;
+    /** Loop over sample container and compute contribution of each sample to pdfs. */
+    for( SizeValueType i = pos_begin; i < pos_end; ++i )
+    {
+      /** Transform the next batch of points, from the sample coordinates. */
+      const SizeValueType k = ( i - pos_begin ) % batchSize;
+      if( k == 0 )
+      {
+        this->TransformThreaderSamples( i, std::min( batchSize, pos_end - i ), mappedPoints );
+      }
 
-    /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+      /** Initialize some variables. */
+      const MovingImagePointType & mappedPoint = mappedPoints[ k ];
+      FixedImagePointType          fixedPoint;
+      RealType                     fixedImageValue;
+      RealType                     movingImageValue;
 
-    /** Check if point is inside mask. */
-    if( sampleOk )
-    {
-      sampleOk = this->IsInsideMovingMask( mappedPoint );
-    }
+      /** Check if point is inside mask. */
+      bool sampleOk = this->IsInsideMovingMask( mappedPoint );
 
-    /** Compute the moving image value and check if the point is
-     * inside the moving image buffer.
-     */
-    if( sampleOk )
-    {
-      sampleOk = this->EvaluateMovingImageValueAndDerivative(
-        mappedPoint, movingImageValue, 0 );
-    }
+      /** Compute the moving image value and check if the point is
+       * inside the moving image buffer.
+       */
+      if( sampleOk )
+      {
+        sampleOk = this->EvaluateMovingImageValueAndDerivative(
+          mappedPoint, movingImageValue, 0 );
+      }
 
-    if( sampleOk )
-    {
-      numberOfPixelsCounted++;
+      if( sampleOk )
+      {
+        numberOfPixelsCounted++;
 
-      /** Get the fixed image value. */
-      RealType fixedImageValue = static_cast< RealType >( ( *fiter ).Value().m_ImageValue );
+        /** Read the fixed image value. */
+        this->GetThreaderSample( i, fixedPoint, fixedImageValue );
 
-      /** Make sure the values fall within the histogram range. */
-      fixedImageValue  = this->GetFixedImageLimiter()->Evaluate( fixedImageValue );
-      movingImageValue = this->GetMovingImageLimiter()->Evaluate( movingImageValue );
+        /** Make sure the values fall within the histogram range. */
+        fixedImageValue  = this->GetFixedImageLimiter()->Evaluate( fixedImageValue );
+        movingImageValue = this->GetMovingImageLimiter()->Evaluate( movingImageValue );
 
-      /** Compute this sample's contribution to the joint distributions. */
-      this->UpdateJointPDFAndDerivatives(
-        fixedImageValue, movingImageValue, 0, 0,
-        jointPDF.GetPointer() );
-    }
-  } // end iterating over fixed image spatial sample container for loop
+        /** Compute this sample's contribution to the joint distributions. */
+        this->UpdateJointPDFAndDerivatives(
+          fixedImageValue, movingImageValue, 0, 0,
+          jointPDF.GetPointer() );
+      }
+    } // end iterating over fixed image spatial sample container for loop
+  } // end while loop over the sample ranges
 
   /** Only update these variables at the end to prevent unnecessary "false sharing". */
   this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ threadId ].st_NumberOfPixelsCounted = numberOfPixelsCounted;
@@ -1248,6 +1244,9 @@ void
 ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
 ::AfterThreadedComputePDFs( void ) const
 {
+  /** Profile the accumulation of the thread histograms, if desired. */
+  PhaseProfiler::ScopedProbe probe( "AfterThreadedComputePDFs" );
+
   /** Accumulate the number of pixels. */
   this->m_NumberOfPixelsCounted
     = this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[ 0 ].st_NumberOfPixelsCounted;
@@ -1335,14 +1334,17 @@ void
 ParzenWindowHistogramImageToImageMetric< TFixedImage, TMovingImage >
 ::LaunchComputePDFsThreaderCallback( void ) const
 {
-  /** Setup threader. */
-  this->m_Threader->SetSingleMethod( this->ComputePDFsThreaderCallback,
+  /** Profile the threaded histogram computation, if desired. */
+  PhaseProfiler::ScopedProbe probe( "ThreadedComputePDFs" );
+
+  /** Prepare the samples for the threads. */
+  this->InitializeThreaderSamples();
+
+  /** Setup threader and launch. */
+  this->ExecuteThreaderCallback( this->ComputePDFsThreaderCallback,
     const_cast< void * >( static_cast< const void * >(
       &this->m_ParzenWindowHistogramThreaderParameters ) ) );
 
-  /** Launch. */
-  this->m_Threader->SingleMethodExecute();
-
 } // end LaunchComputePDFsThreaderCallback()
 
 
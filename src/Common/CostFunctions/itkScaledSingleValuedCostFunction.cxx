@@ -22,6 +22,8 @@
 #include "itkScaledSingleValuedCostFunction.h"
 #include "vnl/vnl_math.h"
 
+#include <algorithm>
+
 namespace itk
 {
 
@@ -168,6 +170,79 @@ ScaledSingleValuedCostFunction
 } // end GetValueAndDerivative()
 
 
+/**
+ * **************** GetSupportsSparseDerivative ************************
+ */
+
+bool
+ScaledSingleValuedCostFunction
+::GetSupportsSparseDerivative( void ) const
+{
+  const SparseDerivativeCostFunction * sparseCostFunction
+    = dynamic_cast< const SparseDerivativeCostFunction * >( this->m_UnscaledCostFunction.GetPointer() );
+  return sparseCostFunction && sparseCostFunction->GetSupportsSparseDerivative();
+
+} // end GetSupportsSparseDerivative()
+
+
+/**
+ * **************** GetValueAndSparseDerivative ************************
+ */
+
+void
+ScaledSingleValuedCostFunction
+::GetValueAndSparseDerivative( const ParametersType & parameters,
+  MeasureType & value,
+  SparseDerivativeType & derivative ) const
+{
+  /** This function also checks if the UnscaledCostFunction has been set */
+  const unsigned int numberOfParameters = this->GetNumberOfParameters();
+  if( parameters.GetSize() != numberOfParameters )
+  {
+    itkExceptionMacro( << "Number of parameters is not like the unscaled cost function expects." );
+  }
+
+  const SparseDerivativeCostFunction * sparseCostFunction
+    = dynamic_cast< const SparseDerivativeCostFunction * >( this->m_UnscaledCostFunction.GetPointer() );
+  if( !sparseCostFunction )
+  {
+    itkExceptionMacro( << "The unscaled cost function does not support a sparse derivative." );
+  }
+
+  if( this->m_UseScales )
+  {
+    ParametersType scaledParameters = parameters;
+    this->ConvertScaledToUnscaledParameters( scaledParameters );
+    sparseCostFunction->GetValueAndSparseDerivative( scaledParameters, value, derivative );
+
+    /** Only the allocated blocks are divided by the scales. */
+    const ScalesType &  scales    = this->GetScales();
+    const SizeValueType blockSize = SparseDerivativeType::BlockSize;
+    for( SizeValueType k = 0; k < derivative.GetNumberOfBlocks(); ++k )
+    {
+      const SizeValueType begin  = derivative.GetBlockIndex( k ) * blockSize;
+      const SizeValueType end    = std::min( begin + blockSize, static_cast< SizeValueType >( numberOfParameters ) );
+      double *            values = derivative.GetBlockValues( k );
+      for( SizeValueType i = begin; i < end; ++i )
+      {
+        values[ i - begin ] /= scales[ i ];
+      }
+    }
+  }
+  else
+  {
+    sparseCostFunction->GetValueAndSparseDerivative( parameters, value, derivative );
+  }
+
+  if( this->GetNegateCostFunction() )
+  {
+    value       = -value;
+    derivative *= -1.0;
+  }
+
+} // end GetValueAndSparseDerivative()
+
+
 /**
  * **************** GetNumberOfParameters ************************
  */
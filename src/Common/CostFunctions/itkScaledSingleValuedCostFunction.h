@@ -20,6 +20,7 @@
 #define __itkScaledSingleValuedCostFunction_h
 
 #include "itkSingleValuedCostFunction.h"
+#include "itkSparseDerivativeCostFunction.h"
 #include "itkIntTypes.h" //temp, needed for IdentifierType
 
 namespace itk
@@ -63,6 +64,8 @@ public:
 
   typedef Array< double > ScalesType;
 
+  typedef BlockSparseDerivative SparseDerivativeType;
+
   /** Divide the parameters by the scales and call the GetValue routine
    * of the unscaled cost function.
    */
@@ -82,6 +85,19 @@ public:
     MeasureType & value,
     DerivativeType & derivative ) const;
 
+  /** Return true if the unscaled cost function supports a sparse
+   * derivative, see SparseDerivativeCostFunction.
+   */
+  virtual bool GetSupportsSparseDerivative( void ) const;
+
+  /** Same procedure as GetValueAndDerivative, but with a sparse derivative.
+   * The scales are only applied to the allocated blocks.
+   */
+  virtual void GetValueAndSparseDerivative(
+    const ParametersType & parameters,
+    MeasureType & value,
+    SparseDerivativeType & derivative ) const;
+
   /** Ask the UnscaledCostFunction how many parameters it has. */
   virtual NumberOfParametersType GetNumberOfParameters( void ) const;
 
@@ -37,6 +37,7 @@
 #include "itkImageBase.h"
 #include "itkAdvancedTransform.h"
 #include "itkSingleValuedCostFunction.h"
+#include "itkSparseDerivativeCostFunction.h"
 #include "itkExceptionObject.h"
 #include "itkSpatialObject.h"
 #include "itkPointSet.h"
@@ -60,7 +61,8 @@ namespace itk
 
 template< class TFixedPointSet, class TMovingPointSet >
 class SingleValuedPointSetToPointSetMetric :
-  public SingleValuedCostFunction
+  public SingleValuedCostFunction,
+  public SparseDerivativeCostFunction
 {
 public:
 
@@ -117,6 +119,9 @@ public:
   typedef typename DerivativeType::ValueType DerivativeValueType;
   typedef Superclass::ParametersType         ParametersType;
 
+  /** The type of a sparse derivative, see SparseDerivativeCostFunction. */
+  typedef BlockSparseDerivative SparseDerivativeType;
+
   /** Typedefs for support of sparse Jacobians and compact support of transformations. */
   typedef typename TransformType::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
 
@@ -138,7 +143,10 @@ public:
   /** Get a pointer to the Transform.  */
   itkGetConstObjectMacro( Transform, TransformType );
 
-  /** Set the parameters defining the Transform. */
+  /** Set the parameters defining the Transform. If UseMetricSingleThreaded
+   * is false, the parameters have already been set by
+   * BeforeThreadedGetValueAndDerivative(), and the transform is not touched.
+   */
   void SetTransformParameters( const ParametersType & parameters ) const;
 
   /** Return the number of parameters required by the transform. */
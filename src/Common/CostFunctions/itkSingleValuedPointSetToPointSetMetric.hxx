@@ -73,6 +73,14 @@ SingleValuedPointSetToPointSetMetric< TFixedPointSet, TMovingPointSet >
   {
     itkExceptionMacro( << "Transform has not been assigned" );
   }
+
+  /** The CombinationImageToImageMetric sets the parameters once, before
+   * evaluating its sub-metrics (concurrently).
+   */
+  if( !this->m_UseMetricSingleThreaded )
+  {
+    return;
+  }
   this->m_Transform->SetParameters( parameters );
 
 } // end SetTransformParameters()
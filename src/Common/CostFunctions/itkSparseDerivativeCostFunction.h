@@ -0,0 +1,76 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkSparseDerivativeCostFunction_h
+#define __itkSparseDerivativeCostFunction_h
+
+#include "itkSingleValuedCostFunction.h"
+#include "itkBlockSparseDerivative.h"
+
+namespace itk
+{
+
+/** \class SparseDerivativeCostFunction
+ *
+ * \brief Interface of cost functions that can return their derivative as
+ * a BlockSparseDerivative.
+ *
+ * The AdvancedImageToImageMetric and the SingleValuedPointSetToPointSetMetric
+ * derive from this class, next to their ITK base class. By default a cost
+ * function does not support a sparse derivative. Cost functions that only
+ * touch a small part of the parameters override both methods. Users, such
+ * as the CombinationImageToImageMetric and the ScaledSingleValuedCostFunction,
+ * find the interface with a dynamic_cast.
+ *
+ * Note that the class has no typedefs, to avoid ambiguities with the
+ * typedefs of the ITK base classes.
+ *
+ * \ingroup RegistrationMetrics
+ */
+
+class SparseDerivativeCostFunction
+{
+public:
+
+  /** The destructor. */
+  virtual ~SparseDerivativeCostFunction() {}
+
+  /** Return true if GetValueAndSparseDerivative() is implemented. */
+  virtual bool GetSupportsSparseDerivative( void ) const
+  {
+    return false;
+  }
+
+
+  /** Compute the value and the derivative, like GetValueAndDerivative().
+   * The derivative is resized to the number of parameters and cleared.
+   */
+  virtual void GetValueAndSparseDerivative(
+    const SingleValuedCostFunction::ParametersType & itkNotUsed( parameters ),
+    SingleValuedCostFunction::MeasureType & itkNotUsed( value ),
+    BlockSparseDerivative & itkNotUsed( derivative ) ) const
+  {
+    throw ExceptionObject( __FILE__, __LINE__,
+      "This cost function does not support a sparse derivative." );
+  }
+
+
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __itkSparseDerivativeCostFunction_h
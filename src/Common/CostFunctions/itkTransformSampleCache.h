@@ -0,0 +1,160 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkTransformSampleCache_h
+#define __itkTransformSampleCache_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkImageSample.h"
+#include "itkVectorDataContainer.h"
+#include "itkMultiThreader.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace itk
+{
+
+/** \class TransformSampleCache
+ *
+ * \brief Stores the mapped points and transform Jacobians of the samples
+ * of an image sampler, to be shared by several metrics.
+ *
+ * When several metrics of a CombinationImageToImageMetric use the same
+ * image sampler and transform, each of them would transform the same
+ * samples and evaluate the same transform Jacobians. Instead, the
+ * combination fills this cache once per iteration, by calling Update()
+ * for the samples of each metric, and the metrics read the results in
+ * their multi-threaded sample loops. An entry is identified by the sample
+ * container and the transform; Update() for a pair that is already
+ * present does nothing. Clear() must be called whenever the samples or
+ * the transform parameters change. The storage is kept for reuse.
+ *
+ * Note that the cache stores a full Jacobian per sample, which takes
+ * OutputSpaceDimension * GetNumberOfNonZeroJacobianIndices() doubles.
+ *
+ * \ingroup RegistrationMetrics
+ */
+
+template< class TFixedImage, class TTransform >
+class TransformSampleCache : public Object
+{
+public:
+
+  /** Standard ITK-stuff. */
+  typedef TransformSampleCache       Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( TransformSampleCache, Object );
+
+  /** Typedefs. */
+  typedef TFixedImage                                  FixedImageType;
+  typedef ImageSample< FixedImageType >                ImageSampleType;
+  typedef VectorDataContainer<
+    unsigned long, ImageSampleType >                   ImageSampleContainerType;
+  typedef TTransform                                   TransformType;
+  typedef typename TransformType::InputPointType       InputPointType;
+  typedef typename TransformType::OutputPointType      OutputPointType;
+  typedef typename TransformType::JacobianType         JacobianType;
+  typedef typename TransformType::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
+
+  /** The cached results for the samples of one sample container. */
+  struct CachedSamplesType
+  {
+    const ImageSampleContainerType *          m_Samples;
+    const TransformType *                     m_Transform;
+    std::vector< OutputPointType >            m_MappedPoints;
+    std::vector< JacobianType >               m_Jacobians;
+    std::vector< NonZeroJacobianIndicesType > m_NonZeroJacobianIndices;
+  };
+
+  /** Set/Get the number of threads used by Update(). */
+  itkSetClampMacro( NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
+  /** Remove all entries. */
+  virtual void Clear( void );
+
+  /** Compute the mapped points, Jacobians and nonzero Jacobian indices of
+   * all samples, using the current parameters of the transform, unless
+   * they are present already. Not thread-safe.
+   */
+  virtual void Update( const ImageSampleContainerType * samples,
+    const TransformType * transform );
+
+  /** Get the entry for these samples and this transform, or 0 if the
+   * cache does not hold them. The entry is valid until the next call to
+   * Clear() or Update().
+   */
+  const CachedSamplesType * Find( const ImageSampleContainerType * samples,
+    const TransformType * transform ) const;
+
+  /** Get the number of entries. */
+  SizeValueType GetNumberOfEntries( void ) const
+  {
+    return this->m_NumberOfEntries;
+  }
+
+
+protected:
+
+  /** The constructor. */
+  TransformSampleCache();
+
+  /** The destructor. */
+  virtual ~TransformSampleCache() {}
+
+  /** PrintSelf. */
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+private:
+
+  /** The private constructor. */
+  TransformSampleCache( const Self & ); // purposely not implemented
+  /** The private copy constructor. */
+  void operator=( const Self & );       // purposely not implemented
+
+  /** Threader callback that fills a part of an entry. */
+  static ITK_THREAD_RETURN_TYPE UpdateThreaderCallback( void * arg );
+
+  /** For threading: store thread data. */
+  struct MultiThreaderUpdateType
+  {
+    CachedSamplesType * st_Entry;
+  };
+
+  /** The entries; only the first m_NumberOfEntries are valid. */
+  std::vector< CachedSamplesType > m_Entries;
+  SizeValueType                    m_NumberOfEntries;
+  ThreadIdType                     m_NumberOfThreads;
+
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkTransformSampleCache.hxx"
+#endif
+
+#endif // end #ifndef __itkTransformSampleCache_h
@@ -0,0 +1,187 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkTransformSampleCache_hxx
+#define __itkTransformSampleCache_hxx
+
+#include "itkTransformSampleCache.h"
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TFixedImage, class TTransform >
+TransformSampleCache< TFixedImage, TTransform >
+::TransformSampleCache()
+{
+  this->m_NumberOfEntries = 0;
+  this->m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+
+} // end Constructor()
+
+
+/**
+ * ******************* Clear *******************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+TransformSampleCache< TFixedImage, TTransform >
+::Clear( void )
+{
+  /** Keep the storage of the entries, to reuse it in the next iteration. */
+  this->m_NumberOfEntries = 0;
+
+} // end Clear()
+
+
+/**
+ * ******************* Find *******************
+ */
+
+template< class TFixedImage, class TTransform >
+const typename TransformSampleCache< TFixedImage, TTransform >::CachedSamplesType *
+TransformSampleCache< TFixedImage, TTransform >
+::Find( const ImageSampleContainerType * samples,
+  const TransformType * transform ) const
+{
+  for( SizeValueType i = 0; i < this->m_NumberOfEntries; ++i )
+  {
+    const CachedSamplesType & entry = this->m_Entries[ i ];
+    if( entry.m_Samples == samples && entry.m_Transform == transform )
+    {
+      return &entry;
+    }
+  }
+  return 0;
+
+} // end Find()
+
+
+/**
+ * ******************* Update *******************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+TransformSampleCache< TFixedImage, TTransform >
+::Update( const ImageSampleContainerType * samples,
+  const TransformType * transform )
+{
+  if( samples == 0 || transform == 0 || this->Find( samples, transform ) )
+  {
+    return;
+  }
+
+  /** Take the next entry, reusing its storage if possible. */
+  if( this->m_NumberOfEntries == this->m_Entries.size() )
+  {
+    this->m_Entries.push_back( CachedSamplesType() );
+  }
+  CachedSamplesType & entry = this->m_Entries[ this->m_NumberOfEntries ];
+  entry.m_Samples   = samples;
+  entry.m_Transform = transform;
+
+  /** Allocate the results. Jacobians that already have the right size
+   * are not reallocated.
+   */
+  const SizeValueType numberOfSamples = samples->Size();
+  const SizeValueType nnzji           = transform->GetNumberOfNonZeroJacobianIndices();
+  entry.m_MappedPoints.resize( numberOfSamples );
+  entry.m_Jacobians.resize( numberOfSamples );
+  entry.m_NonZeroJacobianIndices.resize( numberOfSamples );
+  for( SizeValueType i = 0; i < numberOfSamples; ++i )
+  {
+    entry.m_Jacobians[ i ].SetSize( TransformType::OutputSpaceDimension, nnzji );
+    entry.m_NonZeroJacobianIndices[ i ].resize( nnzji );
+  }
+
+  /** Fill the entry multi-threadedly. */
+  MultiThreaderUpdateType temp;
+  temp.st_Entry = &entry;
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( this->m_NumberOfThreads );
+  threader->SetSingleMethod( UpdateThreaderCallback, &temp );
+  threader->SingleMethodExecute();
+
+  ++this->m_NumberOfEntries;
+
+} // end Update()
+
+
+/**
+ * ******************* UpdateThreaderCallback *******************
+ */
+
+template< class TFixedImage, class TTransform >
+ITK_THREAD_RETURN_TYPE
+TransformSampleCache< TFixedImage, TTransform >
+::UpdateThreaderCallback( void * arg )
+{
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+  ThreadInfoType * infoStruct  = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType     threadId    = infoStruct->ThreadID;
+  ThreadIdType     nrOfThreads = infoStruct->NumberOfThreads;
+
+  MultiThreaderUpdateType * temp
+    = static_cast< MultiThreaderUpdateType * >( infoStruct->UserData );
+  CachedSamplesType & entry = *temp->st_Entry;
+
+  /** Determine the range of samples of this thread. */
+  const SizeValueType numberOfSamples = entry.m_Samples->Size();
+  const SizeValueType subSize         = ( numberOfSamples + nrOfThreads - 1 ) / nrOfThreads;
+  const SizeValueType pos_begin       = std::min( threadId * subSize, numberOfSamples );
+  const SizeValueType pos_end         = std::min( pos_begin + subSize, numberOfSamples );
+
+  /** Transform the samples and evaluate the Jacobians. */
+  for( SizeValueType i = pos_begin; i < pos_end; ++i )
+  {
+    const InputPointType & fixedPoint = entry.m_Samples->ElementAt( i ).m_ImageCoordinates;
+    entry.m_MappedPoints[ i ] = entry.m_Transform->TransformPoint( fixedPoint );
+    entry.m_Transform->GetJacobian( fixedPoint,
+      entry.m_Jacobians[ i ], entry.m_NonZeroJacobianIndices[ i ] );
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end UpdateThreaderCallback()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+TransformSampleCache< TFixedImage, TTransform >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "NumberOfEntries: " << this->m_NumberOfEntries << std::endl;
+  os << indent << "NumberOfThreads: " << this->m_NumberOfThreads << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkTransformSampleCache_hxx
@@ -22,6 +22,7 @@
 #include "itkImageFullSampler.h"
 
 #include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkPhaseProfiler.h"
 
 namespace itk
 {
@@ -35,6 +36,9 @@ void
 ImageFullSampler< TInputImage >
 ::GenerateData( void )
 {
+  /** Profile the sampling, if desired. */
+  PhaseProfiler::ScopedProbe probe( "ImageSampler" );
+
   /** If desired we exercise a multi-threaded version. */
   if( this->m_UseMultiThread )
   {
@@ -49,6 +53,7 @@ ImageFullSampler< TInputImage >
 
   /** Clear the container. */
   sampleContainer->Initialize();
+  this->InitializeOutputSoA( 0 );
 
   /** Set up a region iterator within the user specified image region. */
   typedef ImageRegionConstIteratorWithIndex< InputImageType > InputImageIterator;
@@ -64,6 +69,8 @@ ImageFullSampler< TInputImage >
     {
       sampleContainer->Reserve( this->GetCroppedInputImageRegion()
         .GetNumberOfPixels() );
+      this->InitializeOutputSoA( this->GetCroppedInputImageRegion()
+        .GetNumberOfPixels() );
     }
     catch( std::exception & excp )
     {
@@ -95,6 +102,7 @@ ImageFullSampler< TInputImage >
 
       /** Store in container */
       sampleContainer->SetElement( ind, tempSample );
+      this->SetOutputSoASample( ind, tempSample );
 
     } // end for
   }   // end if no mask
@@ -123,6 +131,7 @@ ImageFullSampler< TInputImage >
 
         /** Store in container. */
         sampleContainer->push_back( tempSample );
+        this->PushBackOutputSoASample( tempSample );
 
       } // end if
     }   // end for
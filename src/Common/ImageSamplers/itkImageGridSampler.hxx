@@ -21,6 +21,7 @@
 #include "itkImageGridSampler.h"
 
 #include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkPhaseProfiler.h"
 
 namespace itk
 {
@@ -66,6 +67,9 @@ void
 ImageGridSampler< TInputImage >
 ::GenerateData( void )
 {
+  /** Profile the sampling, if desired. */
+  PhaseProfiler::ScopedProbe probe( "ImageSampler" );
+
   /** Get handles to the input image, output sample container, and the mask. */
   InputImageConstPointer inputImage = this->GetInput();
   typename ImageSampleContainerType::Pointer sampleContainer = this->GetOutput();
@@ -73,6 +77,7 @@ ImageGridSampler< TInputImage >
 
   /** Clear the container. */
   sampleContainer->Initialize();
+  this->InitializeOutputSoA( 0 );
 
   /** Set up a region iterator within the user specified image region. */
   typedef ImageRegionConstIteratorWithIndex< InputImageType > InputImageIterator;
@@ -143,6 +148,7 @@ ImageGridSampler< TInputImage >
 
             // Store sample in container.
             sampleContainer->push_back( tempsample );
+            this->PushBackOutputSoASample( tempsample );
 
           } // end x
           index[ 0 ]  = sampleGridIndex[ 0 ];
@@ -191,6 +197,7 @@ ImageGridSampler< TInputImage >
 
               // Store sample in container.
               sampleContainer->push_back( tempsample );
+              this->PushBackOutputSoASample( tempsample );
 
             } // end if in mask
               // Jump to next position on grid
@@ -21,6 +21,7 @@
 
 #include "itkImageRandomCoordinateSampler.h"
 #include "vnl/vnl_math.h"
+#include "itkPhaseProfiler.h"
 
 namespace itk
 {
@@ -57,6 +58,9 @@ void
 ImageRandomCoordinateSampler< TInputImage >
 ::GenerateData( void )
 {
+  /** Profile the sampling, if desired. */
+  PhaseProfiler::ScopedProbe probe( "ImageSampler" );
+
   /** Get a handle to the mask. If there was no mask supplied we exercise a multi-threaded version. */
   typename MaskType::ConstPointer mask = this->GetMask();
   if( mask.IsNull() && this->m_UseMultiThread )
@@ -87,8 +91,9 @@ ImageRandomCoordinateSampler< TInputImage >
   this->GenerateSampleRegion( smallestImageContIndex, largestImageContIndex,
     smallestContIndex, largestContIndex );
 
-  /** Reserve memory for the output. */
+  /** Reserve memory for the output, in both layouts. */
   sampleContainer->Reserve( this->GetNumberOfSamples() );
+  this->InitializeOutputSoA( this->GetNumberOfSamples() );
 
   /** Setup an iterator over the output, which is of ImageSampleContainerType. */
   typename ImageSampleContainerType::Iterator iter;
@@ -114,6 +119,7 @@ ImageRandomCoordinateSampler< TInputImage >
       /** Compute the value at the contindex. */
       sampleValue = static_cast< ImageSampleValueType >(
         this->m_Interpolator->EvaluateAtContinuousIndex( sampleContIndex ) );
+      this->SetOutputSoASample( iter.Index(), ( *iter ).Value() );
 
     } // end for loop
   }   // end if no mask
@@ -148,6 +154,7 @@ ImageRandomCoordinateSampler< TInputImage >
           typename ImageSampleContainerType::iterator stlend = sampleContainer->end();
           stlnow                                            += iter.Index();
           sampleContainer->erase( stlnow, stlend );
+          this->InitializeOutputSoA( iter.Index() );
           itkExceptionMacro( << "Could not find enough image samples within "
                              << "reasonable time. Probably the mask is too small" );
         }
@@ -163,6 +170,7 @@ ImageRandomCoordinateSampler< TInputImage >
       /** Compute the value at the point. */
       sampleValue = static_cast< ImageSampleValueType >(
         this->m_Interpolator->EvaluateAtContinuousIndex( sampleContIndex ) );
+      this->SetOutputSoASample( iter.Index(), ( *iter ).Value() );
 
     } // end for loop
   }   // end if mask
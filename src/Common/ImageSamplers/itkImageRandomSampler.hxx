@@ -22,6 +22,7 @@
 
 #include "itkMersenneTwisterRandomVariateGenerator.h"
 #include "itkImageRandomConstIteratorWithIndex.h"
+#include "itkPhaseProfiler.h"
 
 namespace itk
 {
@@ -35,6 +36,9 @@ void
 ImageRandomSampler< TInputImage >
 ::GenerateData( void )
 {
+  /** Profile the sampling, if desired. */
+  PhaseProfiler::ScopedProbe probe( "ImageSampler" );
+
   /** Get a handle to the mask. If there was no mask supplied we exercise a multi-threaded version. */
   typename MaskType::ConstPointer mask = this->GetMask();
   if( mask.IsNull() && this->m_UseMultiThread )
@@ -47,8 +51,9 @@ ImageRandomSampler< TInputImage >
   InputImageConstPointer inputImage = this->GetInput();
   typename ImageSampleContainerType::Pointer sampleContainer = this->GetOutput();
 
-  /** Reserve memory for the output. */
+  /** Reserve memory for the output, in both layouts. */
   sampleContainer->Reserve( this->GetNumberOfSamples() );
+  this->InitializeOutputSoA( this->GetNumberOfSamples() );
 
   /** Setup a random iterator over the input image. */
   typedef ImageRandomConstIteratorWithIndex< InputImageType > RandomIteratorType;
@@ -73,6 +78,7 @@ ImageRandomSampler< TInputImage >
         ( *iter ).Value().m_ImageCoordinates );
       /** Get the value and put it in the sample. */
       ( *iter ).Value().m_ImageValue = randIter.Get();
+      this->SetOutputSoASample( iter.Index(), ( *iter ).Value() );
       /** Jump to a random position. */
       ++randIter;
 
@@ -107,6 +113,7 @@ ImageRandomSampler< TInputImage >
           typename ImageSampleContainerType::iterator stlend = sampleContainer->end();
           stlnow                                            += iter.Index();
           sampleContainer->erase( stlnow, stlend );
+          this->InitializeOutputSoA( iter.Index() );
           itkExceptionMacro( << "Could not find enough image samples within "
                              << "reasonable time. Probably the mask is too small" );
         }
@@ -121,6 +128,7 @@ ImageRandomSampler< TInputImage >
       /** Put the coordinates and the value in the sample. */
       ( *iter ).Value().m_ImageCoordinates = inputPoint;
       ( *iter ).Value().m_ImageValue       = randIter.Get();
+      this->SetOutputSoASample( iter.Index(), ( *iter ).Value() );
 
     } // end for loop
 
@@ -20,6 +20,7 @@
 #define __ImageRandomSamplerSparseMask_txx
 
 #include "itkImageRandomSamplerSparseMask.h"
+#include "itkPhaseProfiler.h"
 
 namespace itk
 {
@@ -49,6 +50,9 @@ void
 ImageRandomSamplerSparseMask< TInputImage >
 ::GenerateData( void )
 {
+  /** Profile the sampling, if desired. */
+  PhaseProfiler::ScopedProbe probe( "ImageSampler" );
+
   /** Get a handle to the mask. */
   typename MaskType::ConstPointer mask = this->GetMask();
 
@@ -64,6 +68,7 @@ ImageRandomSamplerSparseMask< TInputImage >
 
   /** Clear the container. */
   sampleContainer->Initialize();
+  this->InitializeOutputSoA( 0 );
 
   /** Make sure the internal full sampler is up-to-date. */
   this->m_InternalFullSampler->SetInput( inputImage );
@@ -114,6 +119,7 @@ ImageRandomSamplerSparseMask< TInputImage >
     unsigned long randomIndex
       = this->m_RandomGenerator->GetIntegerVariate( numberOfValidSamples - 1 );
     sampleContainer->push_back( allValidSamples->ElementAt( randomIndex ) );
+    this->PushBackOutputSoASample( allValidSamples->ElementAt( randomIndex ) );
   }
 
 } // end GenerateData()
@@ -0,0 +1,185 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkImageSampleContainerSoA_h
+#define __itkImageSampleContainerSoA_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkImageSample.h"
+#include "itkVectorDataContainer.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class ImageSampleContainerSoA
+ *
+ * \brief A structure-of-arrays container of image samples.
+ *
+ * The ImageSamplerBase produces a VectorDataContainer of ImageSample's,
+ * i.e. an array of structs, in which the coordinates and the value of a
+ * sample are stored next to each other. This class stores the same
+ * samples as separate contiguous arrays: one per coordinate dimension,
+ * and one for the values. Each array starts at an address that is aligned
+ * to \c Alignment bytes. This layout allows loops over the samples, such
+ * as the batched transformation of points, to be vectorized.
+ *
+ * The container is filled with CopyFrom(), with SetSize() followed by
+ * SetSample(), or with PushBack(). The samplers fill it in this way while
+ * they generate their output, see ImageSamplerBase::GetOutputSoA().
+ *
+ * \ingroup ImageSamplers
+ */
+
+template< class TImage >
+class ImageSampleContainerSoA : public Object
+{
+public:
+
+  /** Standard ITK-stuff. */
+  typedef ImageSampleContainerSoA    Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( ImageSampleContainerSoA, Object );
+
+  /** The image dimension. */
+  itkStaticConstMacro( ImageDimension, unsigned int, TImage::ImageDimension );
+
+  /** The alignment in bytes of the arrays; suits SSE and AVX. */
+  itkStaticConstMacro( Alignment, unsigned int, 32 );
+
+  /** Typedefs. */
+  typedef TImage                                                ImageType;
+  typedef ImageSample< ImageType >                              ImageSampleType;
+  typedef typename ImageSampleType::PointType                   PointType;
+  typedef typename PointType::ValueType                         CoordRepType;
+  typedef typename ImageSampleType::RealType                    RealType;
+  typedef VectorDataContainer< unsigned long, ImageSampleType > ImageSampleContainerType;
+
+  /** Set the number of samples. The contents of the first samples are
+   * preserved; the contents of added samples are undefined.
+   */
+  virtual void SetSize( SizeValueType size );
+
+  /** Reserve memory for at least capacity samples, preserving the contents. */
+  virtual void Reserve( SizeValueType capacity );
+
+  /** Get the number of samples. */
+  SizeValueType Size( void ) const { return this->m_Size; }
+
+  /** Fill this container with the samples of an array-of-structs container. */
+  virtual void CopyFrom( const ImageSampleContainerType * container );
+
+  /** Get the array with the coordinates of all samples in dimension dim. */
+  const CoordRepType * GetCoordinates( unsigned int dim ) const
+  {
+    return this->m_Coordinates[ dim ];
+  }
+
+
+  CoordRepType * GetCoordinates( unsigned int dim )
+  {
+    return this->m_Coordinates[ dim ];
+  }
+
+
+  /** Get the array with the values of all samples. */
+  const RealType * GetValues( void ) const { return this->m_Values; }
+  RealType * GetValues( void ) { return this->m_Values; }
+
+  /** Get the coordinates and the value of sample i. */
+  void GetSample( SizeValueType i, PointType & point, RealType & value ) const
+  {
+    for( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+      point[ d ] = this->m_Coordinates[ d ][ i ];
+    }
+    value = this->m_Values[ i ];
+  }
+
+
+  /** Set the coordinates and the value of sample i. */
+  void SetSample( SizeValueType i, const PointType & point, const RealType & value )
+  {
+    for( unsigned int d = 0; d < ImageDimension; ++d )
+    {
+      this->m_Coordinates[ d ][ i ] = point[ d ];
+    }
+    this->m_Values[ i ] = value;
+  }
+
+
+  /** Append a sample. The capacity grows geometrically. Unlike SetSize(),
+   * this function does not call Modified(), since it is called per sample.
+   */
+  void PushBack( const PointType & point, const RealType & value )
+  {
+    if( this->m_Size == this->m_Capacity )
+    {
+      this->Reserve( this->m_Capacity < 64 ? 64 : 2 * this->m_Capacity );
+    }
+    this->SetSample( this->m_Size, point, value );
+    ++this->m_Size;
+  }
+
+
+protected:
+
+  /** The constructor. */
+  ImageSampleContainerSoA();
+
+  /** The destructor. */
+  virtual ~ImageSampleContainerSoA() {}
+
+  /** PrintSelf. */
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+private:
+
+  /** The private constructor. */
+  ImageSampleContainerSoA( const Self & ); // purposely not implemented
+  /** The private copy constructor. */
+  void operator=( const Self & );          // purposely not implemented
+
+  /** The number of bytes of an array of n elements of size elementSize,
+   * rounded up to a multiple of the alignment. */
+  static SizeValueType GetPaddedArraySize( SizeValueType n, SizeValueType elementSize );
+
+  /** All arrays live in one buffer; the pointers point into it. */
+  std::vector< char > m_Buffer;
+  CoordRepType *      m_Coordinates[ ImageDimension ];
+  RealType *          m_Values;
+  SizeValueType       m_Size;
+  SizeValueType       m_Capacity;
+
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkImageSampleContainerSoA.hxx"
+#endif
+
+#endif // end #ifndef __itkImageSampleContainerSoA_h
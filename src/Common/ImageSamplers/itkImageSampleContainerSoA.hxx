@@ -0,0 +1,178 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkImageSampleContainerSoA_hxx
+#define __itkImageSampleContainerSoA_hxx
+
+#include "itkImageSampleContainerSoA.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+/**
+ * ******************* Constructor *******************
+ */
+
+template< class TImage >
+ImageSampleContainerSoA< TImage >
+::ImageSampleContainerSoA()
+{
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    this->m_Coordinates[ d ] = 0;
+  }
+  this->m_Values   = 0;
+  this->m_Size     = 0;
+  this->m_Capacity = 0;
+
+} // end Constructor()
+
+
+/**
+ * ******************* GetPaddedArraySize *******************
+ */
+
+template< class TImage >
+SizeValueType
+ImageSampleContainerSoA< TImage >
+::GetPaddedArraySize( SizeValueType n, SizeValueType elementSize )
+{
+  const SizeValueType alignment = Self::Alignment;
+  return ( ( n * elementSize + alignment - 1 ) / alignment ) * alignment;
+
+} // end GetPaddedArraySize()
+
+
+/**
+ * ******************* Reserve *******************
+ */
+
+template< class TImage >
+void
+ImageSampleContainerSoA< TImage >
+::Reserve( SizeValueType capacity )
+{
+  if( capacity <= this->m_Capacity ) { return; }
+
+  const SizeValueType coordinateBytes = GetPaddedArraySize( capacity, sizeof( CoordRepType ) );
+  const SizeValueType valueBytes      = GetPaddedArraySize( capacity, sizeof( RealType ) );
+
+  /** Allocate one extra alignment block, to be able to align the start. */
+  std::vector< char > buffer( ImageDimension * coordinateBytes + valueBytes + Self::Alignment );
+
+  /** Align the start of the buffer, and let the arrays follow each other. */
+  char *            p      = &buffer[ 0 ];
+  const std::size_t offset = reinterpret_cast< std::size_t >( p ) % Self::Alignment;
+  if( offset != 0 ) { p += Self::Alignment - offset; }
+
+  CoordRepType * coordinates[ ImageDimension ];
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    coordinates[ d ] = reinterpret_cast< CoordRepType * >( p );
+    p               += coordinateBytes;
+  }
+  RealType * values = reinterpret_cast< RealType * >( p );
+
+  /** Preserve the current samples. */
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    std::copy( this->m_Coordinates[ d ], this->m_Coordinates[ d ] + this->m_Size, coordinates[ d ] );
+    this->m_Coordinates[ d ] = coordinates[ d ];
+  }
+  std::copy( this->m_Values, this->m_Values + this->m_Size, values );
+  this->m_Values = values;
+
+  this->m_Buffer.swap( buffer );
+  this->m_Capacity = capacity;
+
+} // end Reserve()
+
+
+/**
+ * ******************* SetSize *******************
+ */
+
+template< class TImage >
+void
+ImageSampleContainerSoA< TImage >
+::SetSize( SizeValueType size )
+{
+  this->Reserve( size );
+
+  if( size != this->m_Size )
+  {
+    this->m_Size = size;
+    this->Modified();
+  }
+
+} // end SetSize()
+
+
+/**
+ * ******************* CopyFrom *******************
+ */
+
+template< class TImage >
+void
+ImageSampleContainerSoA< TImage >
+::CopyFrom( const ImageSampleContainerType * container )
+{
+  const SizeValueType size = container->Size();
+  this->SetSize( size );
+
+  /** Copy dimension by dimension, so that the writes are contiguous. */
+  for( unsigned int d = 0; d < ImageDimension; ++d )
+  {
+    CoordRepType * coordinates = this->m_Coordinates[ d ];
+    for( SizeValueType i = 0; i < size; ++i )
+    {
+      coordinates[ i ] = container->ElementAt( i ).m_ImageCoordinates[ d ];
+    }
+  }
+  for( SizeValueType i = 0; i < size; ++i )
+  {
+    this->m_Values[ i ] = container->ElementAt( i ).m_ImageValue;
+  }
+
+  this->Modified();
+
+} // end CopyFrom()
+
+
+/**
+ * ******************* PrintSelf *******************
+ */
+
+template< class TImage >
+void
+ImageSampleContainerSoA< TImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Size: " << this->m_Size << std::endl;
+  os << indent << "Capacity: " << this->m_Capacity << std::endl;
+  os << indent << "Alignment: " << Self::Alignment << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkImageSampleContainerSoA_hxx
@@ -20,6 +20,7 @@
 
 #include "itkImageToVectorContainerFilter.h"
 #include "itkImageSample.h"
+#include "itkImageSampleContainerSoA.h"
 #include "itkVectorDataContainer.h"
 #include "itkSpatialObject.h"
 
@@ -77,6 +78,8 @@ public:
   typedef ImageSample< InputImageType >                         ImageSampleType;
   typedef VectorDataContainer< unsigned long, ImageSampleType > ImageSampleContainerType;
   typedef typename ImageSampleContainerType::Pointer            ImageSampleContainerPointer;
+  typedef ImageSampleContainerSoA< InputImageType >             ImageSampleContainerSoAType;
+  typedef typename ImageSampleContainerSoAType::Pointer         ImageSampleContainerSoAPointer;
   typedef typename InputImageType::SizeType                     InputImageSizeType;
   typedef typename InputImageType::IndexType                    InputImageIndexType;
   typedef typename InputImageType::PointType                    InputImagePointType;
@@ -167,6 +170,25 @@ public:
   /** Get the number of samples. */
   itkGetConstMacro( NumberOfSamples, unsigned long );
 
+  /** Whether the samplers also write their output as a structure of arrays,
+   * see GetOutputSoA(). Default: false.
+   */
+  itkSetMacro( GenerateOutputSoA, bool );
+  itkGetConstMacro( GenerateOutputSoA, bool );
+  itkBooleanMacro( GenerateOutputSoA );
+
+  /** Get the output samples as a structure of arrays: contiguous, aligned
+   * arrays of the coordinates per dimension and of the values. This
+   * container is filled by the sampler together with the output container,
+   * when GenerateOutputSoA is set, and is empty otherwise. It is only read
+   * here, so that several threads may call this function after Update().
+   */
+  const ImageSampleContainerSoAType * GetOutputSoA( void ) const
+  {
+    return this->m_OutputSoA.GetPointer();
+  }
+
+
   /** \todo: Temporary, should think about interface. */
   itkSetMacro( UseMultiThread, bool );
 
@@ -203,6 +225,36 @@ protected:
 
   virtual void AfterThreadedGenerateData( void );
 
+  /** Set the size of the structure-of-arrays output, which is then filled
+   * by SetOutputSoASample(), or clear it before PushBackOutputSoASample().
+   * These functions do nothing when GenerateOutputSoA is false, apart from
+   * emptying the structure-of-arrays output. They are called by the
+   * GenerateData() functions of the samplers, and by AfterThreadedGenerateData().
+   */
+  void InitializeOutputSoA( SizeValueType numberOfSamples )
+  {
+    this->m_OutputSoA->SetSize( this->m_GenerateOutputSoA ? numberOfSamples : 0 );
+  }
+
+
+  void SetOutputSoASample( SizeValueType i, const ImageSampleType & sample )
+  {
+    if( this->m_GenerateOutputSoA )
+    {
+      this->m_OutputSoA->SetSample( i, sample.m_ImageCoordinates, sample.m_ImageValue );
+    }
+  }
+
+
+  void PushBackOutputSoASample( const ImageSampleType & sample )
+  {
+    if( this->m_GenerateOutputSoA )
+    {
+      this->m_OutputSoA->PushBack( sample.m_ImageCoordinates, sample.m_ImageValue );
+    }
+  }
+
+
   /***/
   unsigned long                              m_NumberOfSamples;
   std::vector< ImageSampleContainerPointer > m_ThreaderSampleContainer;
@@ -228,6 +280,9 @@ private:
   InputImageRegionType m_CroppedInputImageRegion;
   InputImageRegionType m_DummyInputImageRegion;
 
+  bool                           m_GenerateOutputSoA;
+  ImageSampleContainerSoAPointer m_OutputSoA;
+
 };
 
 } // end namespace itk
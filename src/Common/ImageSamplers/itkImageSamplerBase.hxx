@@ -36,6 +36,8 @@ ImageSamplerBase< TInputImage >
   this->m_NumberOfMasks             = 0;
   this->m_NumberOfInputImageRegions = 0;
   this->m_NumberOfSamples           = 0;
+  this->m_GenerateOutputSoA         = false;
+  this->m_OutputSoA                 = ImageSampleContainerSoAType::New();
 
   //tmp?
   this->m_UseMultiThread = false;
@@ -448,12 +450,22 @@ ImageSamplerBase< TInputImage >
   sampleContainer->clear();
   sampleContainer->reserve( this->m_NumberOfSamples );
 
-  /** Combine the results of all threads. */
+  /** Combine the results of all threads, in both layouts. */
+  this->InitializeOutputSoA( this->m_NumberOfSamples );
+  SizeValueType sampleId = 0;
   for( std::size_t i = 0; i < this->GetNumberOfThreads(); i++ )
   {
+    const ImageSampleContainerType * sampleContainerThisThread
+      = this->m_ThreaderSampleContainer[ i ];
     sampleContainer->insert( sampleContainer->end(),
-      this->m_ThreaderSampleContainer[ i ]->begin(),
-      this->m_ThreaderSampleContainer[ i ]->end() );
+      sampleContainerThisThread->begin(), sampleContainerThisThread->end() );
+    if( this->m_GenerateOutputSoA )
+    {
+      for( SizeValueType j = 0; j < sampleContainerThisThread->Size(); ++j, ++sampleId )
+      {
+        this->SetOutputSoASample( sampleId, sampleContainerThisThread->ElementAt( j ) );
+      }
+    }
   }
 
 } // end AfterThreadedGenerateData()
@@ -486,6 +498,7 @@ ImageSamplerBase< TInputImage >
     os << indent.GetNextIndent() << this->m_InputImageRegionVector[ i ] << std::endl;
   }
   os << indent << "CroppedInputImageRegion" << this->m_CroppedInputImageRegion << std::endl;
+  os << indent << "GenerateOutputSoA: " << this->m_GenerateOutputSoA << std::endl;
 
 } // end PrintSelf()
 
@@ -22,6 +22,7 @@
 #include "itkMultiInputImageRandomCoordinateSampler.h"
 #include "vnl/vnl_inverse.h"
 #include "itkConfigure.h"
+#include "itkPhaseProfiler.h"
 
 namespace itk
 {
@@ -58,6 +59,9 @@ void
 MultiInputImageRandomCoordinateSampler< TInputImage >
 ::GenerateData( void )
 {
+  /** Profile the sampling, if desired. */
+  PhaseProfiler::ScopedProbe probe( "ImageSampler" );
+
   /** Check. */
   if( !this->CheckInputImageRegions() )
   {
@@ -80,8 +84,9 @@ MultiInputImageRandomCoordinateSampler< TInputImage >
   this->GenerateSampleRegion(
     smallestContIndex, largestContIndex );
 
-  /** Reserve memory for the output. */
+  /** Reserve memory for the output, in both layouts. */
   sampleContainer->Reserve( this->GetNumberOfSamples() );
+  this->InitializeOutputSoA( this->GetNumberOfSamples() );
 
   /** Setup an iterator over the output, which is of ImageSampleContainerType. */
   typename ImageSampleContainerType::Iterator iter;
@@ -107,6 +112,7 @@ MultiInputImageRandomCoordinateSampler< TInputImage >
       /** Compute the value at the contindex. */
       sampleValue = static_cast< ImageSampleValueType >(
         this->m_Interpolator->EvaluateAtContinuousIndex( sampleContIndex ) );
+      this->SetOutputSoASample( iter.Index(), ( *iter ).Value() );
 
     } // end for loop
   }   // end if no mask
@@ -140,6 +146,7 @@ MultiInputImageRandomCoordinateSampler< TInputImage >
           typename ImageSampleContainerType::iterator stlend = sampleContainer->end();
           stlnow                                            += iter.Index();
           sampleContainer->erase( stlnow, stlend );
+          this->InitializeOutputSoA( iter.Index() );
           itkExceptionMacro( << "Could not find enough image samples within "
                              << "reasonable time. Probably the mask is too small" );
         }
@@ -153,6 +160,7 @@ MultiInputImageRandomCoordinateSampler< TInputImage >
       /** Compute the value at the contindex. */
       sampleValue = static_cast< ImageSampleValueType >(
         this->m_Interpolator->EvaluateAtContinuousIndex( sampleContIndex ) );
+      this->SetOutputSoASample( iter.Index(), ( *iter ).Value() );
 
     } // end for loop
   }   // end if mask
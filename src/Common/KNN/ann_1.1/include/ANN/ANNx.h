@@ -48,6 +48,20 @@ enum  {ANN_IN=0, ANN_OUT=1};  // shrinking indices
                 // what to do in case of error
 enum ANNerr {ANNwarn = 0, ANNabort = 1};
 
+//----------------------------------------------------------------------
+//  Thread-local storage
+//  The search procedures keep their state in global variables, to
+//  keep argument lists short.  These are declared thread-local, so
+//  that several threads can search (the same or different) trees
+//  simultaneously.
+//----------------------------------------------------------------------
+
+#if defined(_MSC_VER)
+  #define ANN_THREAD_LOCAL __declspec(thread)
+#else
+  #define ANN_THREAD_LOCAL __thread
+#endif
+
 //----------------------------------------------------------------------
 //  Maximum number of points to visit
 //  We have an option for terminating the search early if the
@@ -57,7 +71,7 @@ enum ANNerr {ANNwarn = 0, ANNabort = 1};
 //----------------------------------------------------------------------
 
 extern int    ANNmaxPtsVisited; // maximum number of pts visited
-extern int    ANNptsVisited;    // number of pts visited in search
+extern ANN_THREAD_LOCAL int ANNptsVisited;    // number of pts visited in search
 
 //----------------------------------------------------------------------
 //  Global function declarations
@@ -24,7 +24,9 @@
 namespace itk
 {
 
-unsigned int ANNBinaryTreeCreator::m_NumberOfANNBinaryTrees = 0;
+unsigned int        ANNBinaryTreeCreator::m_NumberOfANNBinaryTrees = 0;
+bool                ANNBinaryTreeCreator::m_TrivialLeafAllocated   = false;
+SimpleFastMutexLock ANNBinaryTreeCreator::m_Mutex;
 
 /**
  * ************************ CreateANNkDTree *************************
@@ -35,7 +37,19 @@ ANNBinaryTreeCreator::CreateANNkDTree(
   ANNPointArrayType pa, int n, int d, int bs,
   ANNSplitRuleType split )
 {
-  IncreaseReferenceCount();
+  m_Mutex.Lock();
+  m_NumberOfANNBinaryTrees++;
+
+  /** The first tree allocates the global KD_TRIVIAL leaf, which may not race. */
+  if( !m_TrivialLeafAllocated )
+  {
+    ANNkDTreeType * tree = new ANNkd_tree( pa, n, d, bs, split );
+    m_TrivialLeafAllocated = true;
+    m_Mutex.Unlock();
+    return tree;
+  }
+  m_Mutex.Unlock();
+
   return new ANNkd_tree( pa, n, d, bs, split );
 }   // end CreateANNkDTree
 
@@ -49,7 +63,19 @@ ANNBinaryTreeCreator::CreateANNbdTree(
   ANNPointArrayType pa, int n, int d, int bs,
   ANNSplitRuleType split, ANNShrinkRuleType shrink )
 {
-  IncreaseReferenceCount();
+  m_Mutex.Lock();
+  m_NumberOfANNBinaryTrees++;
+
+  /** The first tree allocates the global KD_TRIVIAL leaf, which may not race. */
+  if( !m_TrivialLeafAllocated )
+  {
+    ANNbdTreeType * tree = new ANNbd_tree( pa, n, d, bs, split, shrink );
+    m_TrivialLeafAllocated = true;
+    m_Mutex.Unlock();
+    return tree;
+  }
+  m_Mutex.Unlock();
+
   return new ANNbd_tree( pa, n, d, bs, split, shrink );
 }   // end CreateANNbdTree
 
@@ -106,7 +132,9 @@ ANNBinaryTreeCreator::DeleteANNBruteForceTree( ANNBruteForceTreeType * & tree )
 void
 ANNBinaryTreeCreator::IncreaseReferenceCount( void )
 {
+  m_Mutex.Lock();
   m_NumberOfANNBinaryTrees++;
+  m_Mutex.Unlock();
 }   // end IncreaseReferenceCount
 
 
@@ -117,11 +145,14 @@ ANNBinaryTreeCreator::IncreaseReferenceCount( void )
 void
 ANNBinaryTreeCreator::DecreaseReferenceCount( void )
 {
+  m_Mutex.Lock();
   m_NumberOfANNBinaryTrees--;
   if( m_NumberOfANNBinaryTrees == 0 )
   {
     annClose();
+    m_TrivialLeafAllocated = false;
   }
+  m_Mutex.Unlock();
 }   // end DecreaseReferenceCount
 
 
@@ -21,6 +21,7 @@
 
 #include "itkObject.h"
 #include "itkObjectFactory.h"
+#include "itkSimpleFastMutexLock.h"
 #include "ANN/ANN.h"
 
 namespace itk
@@ -65,6 +66,11 @@ public:
    * of any sort exist, we can call annClose(). This little
    * function is cause of going through the trouble of creating
    * this class with static creating functions.
+   *
+   * The functions may be called concurrently from several threads.
+   * The reference count is protected by a mutex. The first kD or bd
+   * tree is constructed while holding the mutex as well, since ANN
+   * lazily allocates a shared trivial leaf in that case.
    */
 
   /** Static function to create an ANN kDTree. */
@@ -101,7 +107,9 @@ private:
   void operator=( const Self & );         // purposely not implemented
 
   /** Member variables. */
-  static unsigned int m_NumberOfANNBinaryTrees;
+  static unsigned int          m_NumberOfANNBinaryTrees;
+  static bool                  m_TrivialLeafAllocated;
+  static SimpleFastMutexLock   m_Mutex;
 
 };
 
@@ -240,6 +240,27 @@ public:
     ParameterIndexArrayType & indices,
     bool & inside ) const;
 
+  /** Transform a batch of points by a B-spline deformable transformation.
+   * The coefficient pointers and the offsets of the support region are set
+   * up once for the batch, after which the deformation of every point is
+   * computed from the coefficient buffers directly.
+   * For the cubic B-spline, the vectorized kernel is used when
+   * UseVectorizedTransformPoint is set.
+   */
+  virtual void TransformPoints(
+    const InputPointType * inputPoints,
+    OutputPointType * outputPoints,
+    SizeValueType numberOfPoints ) const;
+
+  /** Transform a batch of points that are stored as a structure of arrays,
+   * see AdvancedTransform::TransformPointsSoA(). The points are read from
+   * the coordinate arrays in the loops of TransformPoints() directly.
+   */
+  virtual void TransformPointsSoA(
+    const ScalarType * const * inputCoordinates,
+    OutputPointType * outputPoints,
+    SizeValueType numberOfPoints ) const;
+
   /** Get number of weights. */
   unsigned long GetNumberOfWeights( void ) const
   {
@@ -266,6 +287,16 @@ public:
     DerivativeType & imageJacobian,
     NonZeroJacobianIndicesType & nonZeroJacobianIndices ) const;
 
+  /** Compute the inner products of the Jacobian with the moving image gradient
+   * for a batch of points, without a virtual call per point.
+   */
+  virtual void EvaluateJacobianWithImageGradientProducts(
+    const InputPointType * ipp,
+    const MovingImageGradientType * movingImageGradients,
+    DerivativeType * imageJacobians,
+    NonZeroJacobianIndicesType * nonZeroJacobianIndices,
+    SizeValueType numberOfPoints ) const;
+
   /** Compute the spatial Jacobian of the transformation. */
   virtual void GetSpatialJacobian(
     const InputPointType & ipp,
@@ -322,6 +353,57 @@ protected:
   /** Wrap flat array into images of coefficients. */
   void WrapAsImages( void );
 
+  /** The vectorized implementation of TransformPoints(), for the cubic
+   * B-spline only. The weights are computed for several points at once,
+   * and the coefficients are read with contiguous vector loads.
+   */
+  virtual void TransformPointsVectorized(
+    const InputPointType * inputPoints,
+    OutputPointType * outputPoints,
+    SizeValueType numberOfPoints ) const;
+
+  /** Read input point i from an array of points, or from an array per
+   * coordinate dimension, in the implementations of TransformPoints().
+   */
+  struct InputPointArrayReader
+  {
+    InputPointArrayReader( const InputPointType * inputPoints ) : m_InputPoints( inputPoints ) {}
+    void Read( SizeValueType i, InputPointType & point ) const
+    {
+      point = this->m_InputPoints[ i ];
+    }
+
+
+    const InputPointType * m_InputPoints;
+  };
+
+  struct InputCoordinateArraysReader
+  {
+    InputCoordinateArraysReader( const ScalarType * const * inputCoordinates ) :
+      m_InputCoordinates( inputCoordinates ) {}
+    void Read( SizeValueType i, InputPointType & point ) const
+    {
+      for( unsigned int d = 0; d < SpaceDimension; ++d )
+      {
+        point[ d ] = this->m_InputCoordinates[ d ][ i ];
+      }
+    }
+
+
+    const ScalarType * const * m_InputCoordinates;
+  };
+
+  /** The implementations of TransformPoints() and TransformPointsVectorized(),
+   * for both layouts of the input points.
+   */
+  template< class TInputPointReader >
+  void TransformPointsImplementation( const TInputPointReader & inputPoints,
+    OutputPointType * outputPoints, SizeValueType numberOfPoints ) const;
+
+  template< class TInputPointReader >
+  void TransformPointsVectorizedImplementation( const TInputPointReader & inputPoints,
+    OutputPointType * outputPoints, SizeValueType numberOfPoints ) const;
+
   virtual void ComputeNonZeroJacobianIndices(
     NonZeroJacobianIndicesType & nonZeroJacobianIndices,
     const RegionType & supportRegion ) const;
@@ -40,9 +40,10 @@
 #include "itkContinuousIndex.h"
 #include "itkImageScanlineConstIterator.h"
 #include "itkIdentityTransform.h"
+#include "itkCubicBSplineTransformPointKernel.h"
 #include "vnl/vnl_math.h"
 #include <vector>
-#include <algorithm> // std::copy
+#include <algorithm> // std::copy, std::min
 
 namespace itk
 {
@@ -337,6 +338,312 @@ AdvancedBSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
 }
 
 
+/**
+ * ********************* TransformPoints ****************************
+ */
+
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+AdvancedBSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
+::TransformPoints(
+  const InputPointType * inputPoints,
+  OutputPointType * outputPoints,
+  SizeValueType numberOfPoints ) const
+{
+  /** Without coefficients, fall back to the per-point version, which warns. */
+  if( !this->m_CoefficientImages[ 0 ] )
+  {
+    Superclass::TransformPoints( inputPoints, outputPoints, numberOfPoints );
+    return;
+  }
+
+  /** Use the vectorized kernel if requested. */
+  if( this->m_UseVectorizedTransformPoint && VSplineOrder == 3 )
+  {
+    this->TransformPointsVectorized( inputPoints, outputPoints, numberOfPoints );
+    return;
+  }
+
+  this->TransformPointsImplementation(
+    InputPointArrayReader( inputPoints ), outputPoints, numberOfPoints );
+
+} // end TransformPoints()
+
+
+/**
+ * ********************* TransformPointsSoA ****************************
+ */
+
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+AdvancedBSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
+::TransformPointsSoA(
+  const ScalarType * const * inputCoordinates,
+  OutputPointType * outputPoints,
+  SizeValueType numberOfPoints ) const
+{
+  /** Without coefficients, fall back to the per-point version, which warns. */
+  if( !this->m_CoefficientImages[ 0 ] )
+  {
+    Superclass::TransformPointsSoA( inputCoordinates, outputPoints, numberOfPoints );
+    return;
+  }
+
+  /** Use the vectorized kernel if requested. */
+  if( this->m_UseVectorizedTransformPoint && VSplineOrder == 3 )
+  {
+    this->TransformPointsVectorizedImplementation(
+      InputCoordinateArraysReader( inputCoordinates ), outputPoints, numberOfPoints );
+    return;
+  }
+
+  this->TransformPointsImplementation(
+    InputCoordinateArraysReader( inputCoordinates ), outputPoints, numberOfPoints );
+
+} // end TransformPointsSoA()
+
+
+/**
+ * ********************* TransformPointsImplementation ****************************
+ */
+
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+template< class TInputPointReader >
+void
+AdvancedBSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
+::TransformPointsImplementation(
+  const TInputPointReader & inputPoints,
+  OutputPointType * outputPoints,
+  SizeValueType numberOfPoints ) const
+{
+  /** Allocate memory on the stack. */
+  const unsigned long numberOfWeights = WeightsFunctionType::NumberOfWeights;
+  typename WeightsType::ValueType weightsArray[ numberOfWeights ];
+  WeightsType weights( weightsArray, numberOfWeights, false );
+
+  /** Get the coefficient buffers. All coefficient images share the same
+   * buffered region, and thus the same offset table.
+   */
+  const PixelType * coefficients[ SpaceDimension ];
+  for( unsigned int j = 0; j < SpaceDimension; ++j )
+  {
+    coefficients[ j ] = this->m_CoefficientImages[ j ]->GetBufferPointer();
+  }
+  const OffsetValueType * offsetTable = this->m_CoefficientImages[ 0 ]->GetOffsetTable();
+
+  /** Compute the buffer offsets of the support region relative to its start
+   * index, in the same order as an iterator would visit them.
+   */
+  OffsetValueType supportOffsets[ numberOfWeights ];
+  for( unsigned long k = 0; k < numberOfWeights; ++k )
+  {
+    unsigned long remainder = k;
+    supportOffsets[ k ] = 0;
+    for( unsigned int j = 0; j < SpaceDimension; ++j )
+    {
+      supportOffsets[ k ] += ( remainder % this->m_SupportSize[ j ] ) * offsetTable[ j ];
+      remainder           /= this->m_SupportSize[ j ];
+    }
+  }
+
+  /** Loop over the points. */
+  for( SizeValueType i = 0; i < numberOfPoints; ++i )
+  {
+    /** Copy the input point, as the input and output arrays may be the same. */
+    InputPointType point;
+    inputPoints.Read( i, point );
+    ContinuousIndexType cindex;
+    this->TransformPointToContinuousGridIndex( point, cindex );
+
+    /** NOTE: if the support region does not lie totally within the grid
+     * we assume zero displacement and return the input point.
+     */
+    if( !this->InsideValidRegion( cindex ) )
+    {
+      outputPoints[ i ] = point;
+      continue;
+    }
+
+    /** Compute the interpolation weights. */
+    IndexType supportIndex;
+    this->m_WeightsFunction->ComputeStartIndex( cindex, supportIndex );
+    this->m_WeightsFunction->Evaluate( cindex, supportIndex, weights );
+    const OffsetValueType startOffset
+      = this->m_CoefficientImages[ 0 ]->ComputeOffset( supportIndex );
+
+    /** Multiply the weights with the coefficients to compute the displacement. */
+    OutputPointType outputPoint;
+    outputPoint.Fill( NumericTraits< ScalarType >::ZeroValue() );
+    for( unsigned long k = 0; k < numberOfWeights; ++k )
+    {
+      const OffsetValueType offset = startOffset + supportOffsets[ k ];
+      for( unsigned int j = 0; j < SpaceDimension; ++j )
+      {
+        outputPoint[ j ] += static_cast< ScalarType >(
+          weightsArray[ k ] * coefficients[ j ][ offset ] );
+      }
+    }
+
+    /** The output point is the start point + displacement. */
+    for( unsigned int j = 0; j < SpaceDimension; ++j )
+    {
+      outputPoint[ j ] += point[ j ];
+    }
+    outputPoints[ i ] = outputPoint;
+  }
+
+} // end TransformPointsImplementation()
+
+
+/**
+ * ********************* TransformPointsVectorized ****************************
+ */
+
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+AdvancedBSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
+::TransformPointsVectorized(
+  const InputPointType * inputPoints,
+  OutputPointType * outputPoints,
+  SizeValueType numberOfPoints ) const
+{
+  this->TransformPointsVectorizedImplementation(
+    InputPointArrayReader( inputPoints ), outputPoints, numberOfPoints );
+
+} // end TransformPointsVectorized()
+
+
+/**
+ * ********************* TransformPointsVectorizedImplementation ****************************
+ */
+
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+template< class TInputPointReader >
+void
+AdvancedBSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
+::TransformPointsVectorizedImplementation(
+  const TInputPointReader & inputPoints,
+  OutputPointType * outputPoints,
+  SizeValueType numberOfPoints ) const
+{
+  typedef CubicBSplineTransformPointKernel< PixelType, SpaceDimension > KernelType;
+  const unsigned int  numberOfLanes   = KernelType::NumberOfLanes;
+  const unsigned long numberOfWeights = WeightsFunctionType::NumberOfWeights;
+
+  /** The support region consists of rows of four coefficients along the
+   * first dimension. Compute the buffer offsets of the rows relative to
+   * the start index of the support region.
+   */
+  const PixelType * coefficients[ SpaceDimension ];
+  for( unsigned int j = 0; j < SpaceDimension; ++j )
+  {
+    coefficients[ j ] = this->m_CoefficientImages[ j ]->GetBufferPointer();
+  }
+  const OffsetValueType * offsetTable  = this->m_CoefficientImages[ 0 ]->GetOffsetTable();
+  const unsigned long     numberOfRows = numberOfWeights / 4;
+  OffsetValueType         rowOffsets[ numberOfWeights ];
+  for( unsigned long r = 0; r < numberOfRows; ++r )
+  {
+    unsigned long remainder = r;
+    rowOffsets[ r ] = 0;
+    for( unsigned int j = 1; j < SpaceDimension; ++j )
+    {
+      rowOffsets[ r ] += ( remainder % 4 ) * offsetTable[ j ];
+      remainder       /= 4;
+    }
+  }
+
+  /** Process the points in groups of numberOfLanes. */
+  double          u[ SpaceDimension ][ numberOfLanes ];
+  double          weights1D[ SpaceDimension ][ 4 ][ 4 ];
+  OffsetValueType startOffsets[ numberOfLanes ];
+  bool            inside[ numberOfLanes ];
+  InputPointType  points[ numberOfLanes ];
+  double          rowWeights[ numberOfWeights ];
+  for( SizeValueType first = 0; first < numberOfPoints; first += numberOfLanes )
+  {
+    const unsigned int lanes = static_cast< unsigned int >(
+      std::min< SizeValueType >( numberOfLanes, numberOfPoints - first ) );
+
+    /** Compute the start index and the relative position of every point.
+     * Unused and outside lanes get u = 0, so that the weights are finite.
+     */
+    for( unsigned int lane = 0; lane < numberOfLanes; ++lane )
+    {
+      inside[ lane ] = false;
+      for( unsigned int d = 0; d < SpaceDimension; ++d )
+      {
+        u[ d ][ lane ] = 0.0;
+      }
+      if( lane >= lanes ) { continue; }
+
+      /** Copy the input point, as the input and output arrays may be the same. */
+      inputPoints.Read( first + lane, points[ lane ] );
+      ContinuousIndexType cindex;
+      this->TransformPointToContinuousGridIndex( points[ lane ], cindex );
+      inside[ lane ] = this->InsideValidRegion( cindex );
+      if( !inside[ lane ] ) { continue; }
+
+      IndexType supportIndex;
+      this->m_WeightsFunction->ComputeStartIndex( cindex, supportIndex );
+      for( unsigned int d = 0; d < SpaceDimension; ++d )
+      {
+        u[ d ][ lane ] = cindex[ d ] - static_cast< double >( supportIndex[ d ] ) - 1.0;
+      }
+      startOffsets[ lane ] = this->m_CoefficientImages[ 0 ]->ComputeOffset( supportIndex );
+    }
+
+    /** Compute the 1D weights of all lanes at once. */
+    for( unsigned int d = 0; d < SpaceDimension; ++d )
+    {
+      KernelType::ComputeWeights( u[ d ], weights1D[ d ] );
+    }
+
+    /** Compute the displacement of every point. */
+    for( unsigned int lane = 0; lane < lanes; ++lane )
+    {
+      OutputPointType & outputPoint = outputPoints[ first + lane ];
+      if( !inside[ lane ] )
+      {
+        /** NOTE: if the support region does not lie totally within the grid
+         * we assume zero displacement and return the input point.
+         */
+        outputPoint = points[ lane ];
+        continue;
+      }
+
+      double weightsX[ 4 ];
+      for( unsigned int k = 0; k < 4; ++k )
+      {
+        weightsX[ k ] = weights1D[ 0 ][ k ][ lane ];
+      }
+      for( unsigned long r = 0; r < numberOfRows; ++r )
+      {
+        unsigned long remainder = r;
+        double        weight    = 1.0;
+        for( unsigned int d = 1; d < SpaceDimension; ++d )
+        {
+          weight    *= weights1D[ d ][ remainder % 4 ][ lane ];
+          remainder /= 4;
+        }
+        rowWeights[ r ] = weight;
+      }
+
+      double displacement[ SpaceDimension ];
+      KernelType::ComputeDisplacement( coefficients, rowOffsets,
+        startOffsets[ lane ], numberOfRows, weightsX, rowWeights, displacement );
+
+      /** The output point is the start point + displacement. */
+      for( unsigned int j = 0; j < SpaceDimension; ++j )
+      {
+        outputPoint[ j ] = points[ lane ][ j ] + static_cast< ScalarType >( displacement[ j ] );
+      }
+    }
+  }
+
+} // end TransformPointsVectorizedImplementation()
+
+
 template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
 unsigned int
 AdvancedBSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
@@ -514,6 +821,32 @@ AdvancedBSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
 } // end EvaluateJacobianWithImageGradientProduct()
 
 
+/**
+ * ********************* EvaluateJacobianWithImageGradientProducts ****************************
+ */
+
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+AdvancedBSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
+::EvaluateJacobianWithImageGradientProducts(
+  const InputPointType * ipp,
+  const MovingImageGradientType * movingImageGradients,
+  DerivativeType * imageJacobians,
+  NonZeroJacobianIndicesType * nonZeroJacobianIndices,
+  SizeValueType numberOfPoints ) const
+{
+  /** Call the implementation of this class directly, to avoid the virtual
+   * dispatch per point.
+   */
+  for( SizeValueType i = 0; i < numberOfPoints; ++i )
+  {
+    this->Self::EvaluateJacobianWithImageGradientProduct( ipp[ i ],
+      movingImageGradients[ i ], imageJacobians[ i ], nonZeroJacobianIndices[ i ] );
+  }
+
+} // end EvaluateJacobianWithImageGradientProducts()
+
+
 /**
  * ********************* GetSpatialJacobian ****************************
  */
@@ -259,6 +259,15 @@ public:
   /** Return the region of the grid wholly within the support region */
   itkGetConstReferenceMacro( ValidRegion, RegionType );
 
+  /** Select the vectorized (SSE2/AVX) implementation of TransformPoints()
+   * for the cubic B-spline. The instruction set is determined at compile
+   * time; when no vector instructions are available the same algorithm is
+   * executed with scalar code. Default: false.
+   */
+  itkSetMacro( UseVectorizedTransformPoint, bool );
+  itkGetConstMacro( UseVectorizedTransformPoint, bool );
+  itkBooleanMacro( UseVectorizedTransformPoint );
+
   /** Indicates that this transform is linear. That is, given two
    * points P and Q, and scalar coefficients a and b, then
    *
@@ -340,6 +349,9 @@ protected:
   /** Odd or even order B-spline. */
   bool m_SplineOrderOdd;
 
+  /** Use the vectorized TransformPoints() kernel. */
+  bool m_UseVectorizedTransformPoint;
+
   /** Keep a pointer to the input parameters. */
   const ParametersType * m_InputParametersPointer;
 
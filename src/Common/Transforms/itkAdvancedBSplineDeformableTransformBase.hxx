@@ -60,6 +60,7 @@ AdvancedBSplineDeformableTransformBase< TScalarType, NDimensions >
   }
 
   this->m_ValidRegion = this->m_GridRegion;
+  this->m_UseVectorizedTransformPoint = false;
 
   // Initialize Jacobian images
 //   for ( unsigned int j = 0; j < SpaceDimension; j++ )
@@ -579,6 +580,8 @@ AdvancedBSplineDeformableTransformBase< TScalarType, NDimensions >
      << this->m_InputParametersPointer << std::endl;
   os << indent << "ValidRegion: " << this->m_ValidRegion << std::endl;
   os << indent << "LastJacobianIndex: " << this->m_LastJacobianIndex << std::endl;
+  os << indent << "UseVectorizedTransformPoint: "
+     << ( this->m_UseVectorizedTransformPoint ? "true" : "false" ) << std::endl;
 }
 
 
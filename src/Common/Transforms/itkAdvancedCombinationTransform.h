@@ -161,6 +161,22 @@ public:
   /**  Method to transform a point. */
   virtual OutputPointType TransformPoint( const InputPointType  & point ) const;
 
+  /** Method to transform a batch of points. The combination method is
+   * selected once for the whole batch, instead of once per point.
+   */
+  virtual void TransformPoints(
+    const InputPointType * inputPoints,
+    OutputPointType * outputPoints,
+    SizeValueType numberOfPoints ) const;
+
+  /** Method to transform a batch of points that are stored as a structure
+   * of arrays, see AdvancedTransform::TransformPointsSoA().
+   */
+  virtual void TransformPointsSoA(
+    const ScalarType * const * inputCoordinates,
+    OutputPointType * outputPoints,
+    SizeValueType numberOfPoints ) const;
+
   /** ITK4 change:
    * The following pure virtual functions must be overloaded.
    * For now just throw an exception, since these are not used in elastix.
@@ -252,6 +268,16 @@ public:
     DerivativeType & imageJacobian,
     NonZeroJacobianIndicesType & nonZeroJacobianIndices ) const;
 
+  /** Compute the inner products of the Jacobian with the moving image gradient
+   * for a batch of points.
+   */
+  virtual void EvaluateJacobianWithImageGradientProducts(
+    const InputPointType * ipp,
+    const MovingImageGradientType * movingImageGradients,
+    DerivativeType * imageJacobians,
+    NonZeroJacobianIndicesType * nonZeroJacobianIndices,
+    SizeValueType numberOfPoints ) const;
+
   /** Compute the spatial Jacobian of the transformation. */
   virtual void GetSpatialJacobian(
     const InputPointType & ipp,
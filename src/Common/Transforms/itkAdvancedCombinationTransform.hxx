@@ -19,6 +19,7 @@
 #define __itkAdvancedCombinationTransform_hxx
 
 #include "itkAdvancedCombinationTransform.h"
+#include <algorithm> // for std::min
 
 namespace itk
 {
@@ -1652,6 +1653,135 @@ AdvancedCombinationTransform< TScalarType, NDimensions >
 } // end EvaluateJacobianWithImageGradientProduct()
 
 
+/**
+ * ****************** TransformPoints ****************************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::TransformPoints(
+  const InputPointType * inputPoints,
+  OutputPointType * outputPoints,
+  SizeValueType numberOfPoints ) const
+{
+  /** Select the combination method once, in the same way as
+   * UpdateCombinationMethod() does.
+   */
+  if( this->m_CurrentTransform.IsNull() )
+  {
+    this->NoCurrentTransformSet();
+  }
+  else if( this->m_InitialTransform.IsNull() )
+  {
+    this->m_CurrentTransform->TransformPoints(
+      inputPoints, outputPoints, numberOfPoints );
+  }
+  else if( this->m_UseAddition )
+  {
+    for( SizeValueType i = 0; i < numberOfPoints; ++i )
+    {
+      outputPoints[ i ] = this->TransformPointUseAddition( inputPoints[ i ] );
+    }
+  }
+  else
+  {
+    /** Composition: apply the current transform in-place to the
+     * output of the initial transform.
+     */
+    this->m_InitialTransform->TransformPoints(
+      inputPoints, outputPoints, numberOfPoints );
+    this->m_CurrentTransform->TransformPoints(
+      outputPoints, outputPoints, numberOfPoints );
+  }
+
+} // end TransformPoints()
+
+
+/**
+ * ****************** TransformPointsSoA ****************************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::TransformPointsSoA(
+  const ScalarType * const * inputCoordinates,
+  OutputPointType * outputPoints,
+  SizeValueType numberOfPoints ) const
+{
+  /** Select the combination method once, as in TransformPoints(). */
+  if( this->m_CurrentTransform.IsNull() )
+  {
+    this->NoCurrentTransformSet();
+  }
+  else if( this->m_InitialTransform.IsNull() )
+  {
+    this->m_CurrentTransform->TransformPointsSoA(
+      inputCoordinates, outputPoints, numberOfPoints );
+  }
+  else if( this->m_UseAddition )
+  {
+    Superclass::TransformPointsSoA( inputCoordinates, outputPoints, numberOfPoints );
+  }
+  else
+  {
+    /** Composition: the initial transform reads the coordinate arrays. */
+    this->m_InitialTransform->TransformPointsSoA(
+      inputCoordinates, outputPoints, numberOfPoints );
+    this->m_CurrentTransform->TransformPoints(
+      outputPoints, outputPoints, numberOfPoints );
+  }
+
+} // end TransformPointsSoA()
+
+
+/**
+ * ****************** EvaluateJacobianWithImageGradientProducts ****************************
+ */
+
+template< typename TScalarType, unsigned int NDimensions >
+void
+AdvancedCombinationTransform< TScalarType, NDimensions >
+::EvaluateJacobianWithImageGradientProducts(
+  const InputPointType * ipp,
+  const MovingImageGradientType * movingImageGradients,
+  DerivativeType * imageJacobians,
+  NonZeroJacobianIndicesType * nonZeroJacobianIndices,
+  SizeValueType numberOfPoints ) const
+{
+  /** The Jacobian only depends on the current transform. */
+  if( this->m_CurrentTransform.IsNull() )
+  {
+    this->NoCurrentTransformSet();
+  }
+  else if( this->m_InitialTransform.IsNull() || this->m_UseAddition )
+  {
+    this->m_CurrentTransform->EvaluateJacobianWithImageGradientProducts(
+      ipp, movingImageGradients, imageJacobians, nonZeroJacobianIndices,
+      numberOfPoints );
+  }
+  else
+  {
+    /** Composition: the current transform is evaluated at the points
+     * mapped by the initial transform. These are computed in chunks,
+     * in a buffer on the stack.
+     */
+    const SizeValueType chunkSize = 64;
+    InputPointType      mappedPoints[ chunkSize ];
+    for( SizeValueType begin = 0; begin < numberOfPoints; begin += chunkSize )
+    {
+      const SizeValueType size = std::min( chunkSize, numberOfPoints - begin );
+      this->m_InitialTransform->TransformPoints( ipp + begin, mappedPoints, size );
+      this->m_CurrentTransform->EvaluateJacobianWithImageGradientProducts(
+        mappedPoints, movingImageGradients + begin, imageJacobians + begin,
+        nonZeroJacobianIndices + begin, size );
+    }
+  }
+
+} // end EvaluateJacobianWithImageGradientProducts()
+
+
 /**
  * ****************** GetSpatialJacobian ****************************
  */
@@ -123,6 +123,7 @@ public:
   typedef typename Superclass::ParametersType         ParametersType;
   typedef typename Superclass::NumberOfParametersType NumberOfParametersType;
   typedef typename Superclass::JacobianType           JacobianType;
+  typedef typename Superclass::DerivativeType         DerivativeType;
   typedef typename Superclass::InputVectorType        InputVectorType;
   typedef typename Superclass::OutputVectorType       OutputVectorType;
   typedef typename Superclass
@@ -144,6 +145,7 @@ public:
   typedef typename Superclass
     ::JacobianOfSpatialHessianType JacobianOfSpatialHessianType;
   typedef typename Superclass::InternalMatrixType InternalMatrixType;
+  typedef typename Superclass::MovingImageGradientType MovingImageGradientType;
 
   /** Standard matrix type for this class. */
   typedef Matrix< TScalarType,
@@ -341,6 +343,20 @@ public:
    */
   OutputPointType     TransformPoint( const InputPointType & point ) const;
 
+  /** Transform a batch of points, see AdvancedTransform::TransformPoints(). */
+  virtual void TransformPoints(
+    const InputPointType * inputPoints,
+    OutputPointType * outputPoints,
+    SizeValueType numberOfPoints ) const;
+
+  /** Transform a batch of points that are stored as a structure of arrays,
+   * see AdvancedTransform::TransformPointsSoA().
+   */
+  virtual void TransformPointsSoA(
+    const ScalarType * const * inputCoordinates,
+    OutputPointType * outputPoints,
+    SizeValueType numberOfPoints ) const;
+
   OutputVectorType    TransformVector( const InputVectorType & vector ) const;
 
   OutputVnlVectorType TransformVector( const InputVnlVectorType & vector ) const;
@@ -398,6 +414,16 @@ public:
     JacobianType &,
     NonZeroJacobianIndicesType & ) const;
 
+  /** Compute the inner products of the Jacobian with the moving image gradient
+   * for a batch of points. The Jacobian is allocated once for the batch.
+   */
+  virtual void EvaluateJacobianWithImageGradientProducts(
+    const InputPointType * ipp,
+    const MovingImageGradientType * movingImageGradients,
+    DerivativeType * imageJacobians,
+    NonZeroJacobianIndicesType * nonZeroJacobianIndices,
+    SizeValueType numberOfPoints ) const;
+
   /** Compute the spatial Jacobian of the transformation. */
   virtual void GetSpatialJacobian(
     const InputPointType &,
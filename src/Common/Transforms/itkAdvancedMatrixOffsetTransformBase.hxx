@@ -264,6 +264,55 @@ AdvancedMatrixOffsetTransformBase< TScalarType, NInputDimensions, NOutputDimensi
 }
 
 
+// Transform a batch of points
+template< class TScalarType, unsigned int NInputDimensions,
+unsigned int NOutputDimensions >
+void
+AdvancedMatrixOffsetTransformBase< TScalarType, NInputDimensions, NOutputDimensions >
+::TransformPoints(
+  const InputPointType * inputPoints,
+  OutputPointType * outputPoints,
+  SizeValueType numberOfPoints ) const
+{
+  const MatrixType & matrix = this->m_Matrix;
+  const OffsetType & offset = this->m_Offset;
+  for( SizeValueType i = 0; i < numberOfPoints; ++i )
+  {
+    outputPoints[ i ] = matrix * inputPoints[ i ] + offset;
+  }
+}
+
+
+// Transform a batch of points, stored as a structure of arrays
+template< class TScalarType, unsigned int NInputDimensions,
+unsigned int NOutputDimensions >
+void
+AdvancedMatrixOffsetTransformBase< TScalarType, NInputDimensions, NOutputDimensions >
+::TransformPointsSoA(
+  const ScalarType * const * inputCoordinates,
+  OutputPointType * outputPoints,
+  SizeValueType numberOfPoints ) const
+{
+  /** Sum in the same order as TransformPoints(), so that both layouts give
+   * identical points.
+   */
+  const MatrixType & matrix = this->m_Matrix;
+  const OffsetType & offset = this->m_Offset;
+  for( SizeValueType i = 0; i < numberOfPoints; ++i )
+  {
+    for( unsigned int r = 0; r < NOutputDimensions; ++r )
+    {
+      ScalarType value = NumericTraits< ScalarType >::Zero;
+      for( unsigned int c = 0; c < NInputDimensions; ++c )
+      {
+        value += matrix[ r ][ c ] * inputCoordinates[ c ][ i ];
+      }
+      outputPoints[ i ][ r ] = value + offset[ r ];
+    }
+  }
+}
+
+
 // Transform a vector
 template< class TScalarType, unsigned int NInputDimensions,
 unsigned int NOutputDimensions >
@@ -607,6 +656,36 @@ AdvancedMatrixOffsetTransformBase< TScalarType, NInputDimensions, NOutputDimensi
 } // end GetJacobian()
 
 
+/**
+ * ********************* EvaluateJacobianWithImageGradientProducts ****************************
+ */
+
+template< class TScalarType, unsigned int NInputDimensions,
+unsigned int NOutputDimensions >
+void
+AdvancedMatrixOffsetTransformBase< TScalarType, NInputDimensions, NOutputDimensions >
+::EvaluateJacobianWithImageGradientProducts(
+  const InputPointType * ipp,
+  const MovingImageGradientType * movingImageGradients,
+  DerivativeType * imageJacobians,
+  NonZeroJacobianIndicesType * nonZeroJacobianIndices,
+  SizeValueType numberOfPoints ) const
+{
+  /** The Jacobian has the same size for all points, so it is allocated
+   * only once. GetJacobian() is virtual, because subclasses define the
+   * Jacobian with respect to their own parameters.
+   */
+  JacobianType jacobian;
+  for( SizeValueType i = 0; i < numberOfPoints; ++i )
+  {
+    this->GetJacobian( ipp[ i ], jacobian, nonZeroJacobianIndices[ i ] );
+    Superclass::MultiplyJacobianWithImageGradient(
+      jacobian, movingImageGradients[ i ], imageJacobians[ i ] );
+  }
+
+} // end EvaluateJacobianWithImageGradientProducts()
+
+
 /**
  * ********************* GetSpatialJacobian ****************************
  */
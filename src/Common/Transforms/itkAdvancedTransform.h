@@ -204,6 +204,42 @@ public:
     DerivativeType & imageJacobian,
     NonZeroJacobianIndicesType & nonZeroJacobianIndices ) const;
 
+  /** Transform a batch of points.
+   * The default implementation calls TransformPoint() for each point.
+   * Subclasses override this to perform the per-point setup and the virtual
+   * dispatch only once per batch. The inputPoints and outputPoints arrays
+   * may be the same array.
+   */
+  virtual void TransformPoints(
+    const InputPointType * inputPoints,
+    OutputPointType * outputPoints,
+    SizeValueType numberOfPoints ) const;
+
+  /** Transform a batch of points that are stored as a structure of arrays:
+   * inputCoordinates[ d ] points to the d-th coordinates of the points,
+   * as in an ImageSampleContainerSoA. The default implementation gathers
+   * the points in chunks and calls TransformPoints(). Subclasses override
+   * this to read the coordinate arrays directly.
+   */
+  virtual void TransformPointsSoA(
+    const ScalarType * const * inputCoordinates,
+    OutputPointType * outputPoints,
+    SizeValueType numberOfPoints ) const;
+
+  /** Compute the inner product of the Jacobian with the moving image gradient
+   * for a batch of points. The imageJacobians and nonZeroJacobianIndices
+   * arrays should contain numberOfPoints elements, with the sizes that
+   * EvaluateJacobianWithImageGradientProduct() expects.
+   * The default implementation calls EvaluateJacobianWithImageGradientProduct()
+   * for each point.
+   */
+  virtual void EvaluateJacobianWithImageGradientProducts(
+    const InputPointType * ipp,
+    const MovingImageGradientType * movingImageGradients,
+    DerivativeType * imageJacobians,
+    NonZeroJacobianIndicesType * nonZeroJacobianIndices,
+    SizeValueType numberOfPoints ) const;
+
   /** Compute the spatial Jacobian of the transformation.
    *
    * The spatial Jacobian is expressed as a vector of partial derivatives of the
@@ -315,6 +351,14 @@ protected:
   AdvancedTransform( NumberOfParametersType numberOfParameters );
   virtual ~AdvancedTransform() {}
 
+  /** Multiply the moving image gradient with a full Jacobian:
+   * imageJacobian = movingImageGradient^T * jacobian.
+   */
+  static void MultiplyJacobianWithImageGradient(
+    const JacobianType & jacobian,
+    const MovingImageGradientType & movingImageGradient,
+    DerivativeType & imageJacobian );
+
   bool m_HasNonZeroSpatialHessian;
   bool m_HasNonZeroJacobianOfSpatialHessian;
 
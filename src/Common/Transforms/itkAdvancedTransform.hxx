@@ -35,6 +35,7 @@
 #define _itkAdvancedTransform_hxx
 
 #include "itkAdvancedTransform.h"
+#include <algorithm> // for std::min
 
 namespace itk
 {
@@ -85,6 +86,24 @@ AdvancedTransform< TScalarType, NInputDimensions, NOutputDimensions >
   this->GetJacobian( ipp, jacobian, nonZeroJacobianIndices );
 
   /** Perform a full multiplication. */
+  Self::MultiplyJacobianWithImageGradient(
+    jacobian, movingImageGradient, imageJacobian );
+
+} // end EvaluateJacobianWithImageGradientProduct()
+
+
+/**
+ * ********************* MultiplyJacobianWithImageGradient ****************************
+ */
+
+template< class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions >
+void
+AdvancedTransform< TScalarType, NInputDimensions, NOutputDimensions >
+::MultiplyJacobianWithImageGradient(
+  const JacobianType & jacobian,
+  const MovingImageGradientType & movingImageGradient,
+  DerivativeType & imageJacobian )
+{
   typedef typename JacobianType::const_iterator JacobianIteratorType;
   typedef typename DerivativeType::iterator     DerivativeIteratorType;
   JacobianIteratorType jac = jacobian.begin();
@@ -104,7 +123,82 @@ AdvancedTransform< TScalarType, NInputDimensions, NOutputDimensions >
     }
   }
 
-} // end EvaluateJacobianWithImageGradientProduct()
+} // end MultiplyJacobianWithImageGradient()
+
+
+/**
+ * ********************* TransformPoints ****************************
+ */
+
+template< class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions >
+void
+AdvancedTransform< TScalarType, NInputDimensions, NOutputDimensions >
+::TransformPoints(
+  const InputPointType * inputPoints,
+  OutputPointType * outputPoints,
+  SizeValueType numberOfPoints ) const
+{
+  for( SizeValueType i = 0; i < numberOfPoints; ++i )
+  {
+    outputPoints[ i ] = this->TransformPoint( inputPoints[ i ] );
+  }
+
+} // end TransformPoints()
+
+
+/**
+ * ********************* TransformPointsSoA ****************************
+ */
+
+template< class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions >
+void
+AdvancedTransform< TScalarType, NInputDimensions, NOutputDimensions >
+::TransformPointsSoA(
+  const ScalarType * const * inputCoordinates,
+  OutputPointType * outputPoints,
+  SizeValueType numberOfPoints ) const
+{
+  /** Gather the points in chunks, in a buffer on the stack. */
+  const SizeValueType chunkSize = 64;
+  InputPointType      inputPoints[ chunkSize ];
+  for( SizeValueType begin = 0; begin < numberOfPoints; begin += chunkSize )
+  {
+    const SizeValueType size = std::min( chunkSize, numberOfPoints - begin );
+    for( unsigned int d = 0; d < NInputDimensions; ++d )
+    {
+      const ScalarType * coordinates = inputCoordinates[ d ] + begin;
+      for( SizeValueType i = 0; i < size; ++i )
+      {
+        inputPoints[ i ][ d ] = coordinates[ i ];
+      }
+    }
+    this->TransformPoints( inputPoints, outputPoints + begin, size );
+  }
+
+} // end TransformPointsSoA()
+
+
+/**
+ * ********************* EvaluateJacobianWithImageGradientProducts ****************************
+ */
+
+template< class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions >
+void
+AdvancedTransform< TScalarType, NInputDimensions, NOutputDimensions >
+::EvaluateJacobianWithImageGradientProducts(
+  const InputPointType * ipp,
+  const MovingImageGradientType * movingImageGradients,
+  DerivativeType * imageJacobians,
+  NonZeroJacobianIndicesType * nonZeroJacobianIndices,
+  SizeValueType numberOfPoints ) const
+{
+  for( SizeValueType i = 0; i < numberOfPoints; ++i )
+  {
+    this->EvaluateJacobianWithImageGradientProduct( ipp[ i ],
+      movingImageGradients[ i ], imageJacobians[ i ], nonZeroJacobianIndices[ i ] );
+  }
+
+} // end EvaluateJacobianWithImageGradientProducts()
 
 
 /**
@@ -0,0 +1,267 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkCubicBSplineTransformPointKernel_h
+#define __itkCubicBSplineTransformPointKernel_h
+
+#include "itkMacro.h"
+#include "itkIntTypes.h"
+
+/** Select the instruction set at compile time. AVX is enough for the
+ * double precision operations used here; AVX2 implies AVX.
+ */
+#if defined( __AVX__ )
+#define ELX_CUBIC_BSPLINE_KERNEL_USE_AVX
+#include <immintrin.h>
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define ELX_CUBIC_BSPLINE_KERNEL_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace itk
+{
+
+/** \class CubicBSplineTransformPointKernel
+ *
+ * \brief Computational kernels for the vectorized TransformPoints() of the
+ * cubic AdvancedBSplineDeformableTransform.
+ *
+ * ComputeWeights() evaluates the four cubic B-spline weights of one
+ * dimension for NumberOfLanes points at once.
+ *
+ * ComputeDisplacement() computes the displacement of one point. The cubic
+ * support region consists of rows of four coefficients that are contiguous
+ * in memory, along the first dimension. Each row is loaded with one (AVX)
+ * or two (SSE2) vector loads, multiplied with the weights of the first
+ * dimension times the weight of the row, and accumulated.
+ *
+ * The vector instructions are used for double precision coefficients, when
+ * the compiler targets SSE2 or AVX. Otherwise, and for other pixel types,
+ * the same algorithm is executed with scalar code.
+ *
+ * \ingroup Transforms
+ */
+
+template< class TPixel, unsigned int NDimensions >
+class CubicBSplineTransformPointKernel
+{
+public:
+
+  /** The number of points for which the weights are computed at once. */
+  itkStaticConstMacro( NumberOfLanes, unsigned int, 4 );
+
+  /** Compute the weights of the cubic B-spline in one dimension, for
+   * NumberOfLanes points. On input, u contains the positions relative to
+   * the second node of the support, which lie in [0,1). On output,
+   * weights[ k ][ lane ] contains the weight of node k.
+   */
+  static void ComputeWeights( const double * u, double weights[ 4 ][ 4 ] )
+  {
+#if defined( ELX_CUBIC_BSPLINE_KERNEL_USE_AVX )
+    const __m256d sixth = _mm256_set1_pd( 1.0 / 6.0 );
+    const __m256d one   = _mm256_set1_pd( 1.0 );
+    const __m256d three = _mm256_set1_pd( 3.0 );
+    const __m256d four  = _mm256_set1_pd( 4.0 );
+    const __m256d six   = _mm256_set1_pd( 6.0 );
+    const __m256d t     = _mm256_loadu_pd( u );
+    const __m256d t2    = _mm256_mul_pd( t, t );
+    const __m256d t3    = _mm256_mul_pd( t2, t );
+    const __m256d s     = _mm256_sub_pd( one, t );
+
+    /** w0 = (1-u)^3/6, w1 = (3u^3 - 6u^2 + 4)/6,
+     * w2 = (-3u^3 + 3u^2 + 3u + 1)/6, w3 = u^3/6.
+     */
+    const __m256d w0 = _mm256_mul_pd( _mm256_mul_pd( _mm256_mul_pd( s, s ), s ), sixth );
+    const __m256d w1 = _mm256_mul_pd( _mm256_add_pd( _mm256_sub_pd(
+      _mm256_mul_pd( three, t3 ), _mm256_mul_pd( six, t2 ) ), four ), sixth );
+    const __m256d w3 = _mm256_mul_pd( t3, sixth );
+    const __m256d w2 = _mm256_sub_pd( _mm256_sub_pd( _mm256_sub_pd( one, w0 ), w1 ), w3 );
+    _mm256_storeu_pd( weights[ 0 ], w0 );
+    _mm256_storeu_pd( weights[ 1 ], w1 );
+    _mm256_storeu_pd( weights[ 2 ], w2 );
+    _mm256_storeu_pd( weights[ 3 ], w3 );
+#elif defined( ELX_CUBIC_BSPLINE_KERNEL_USE_SSE2 )
+    const __m128d sixth = _mm_set1_pd( 1.0 / 6.0 );
+    const __m128d one   = _mm_set1_pd( 1.0 );
+    const __m128d three = _mm_set1_pd( 3.0 );
+    const __m128d four  = _mm_set1_pd( 4.0 );
+    const __m128d six   = _mm_set1_pd( 6.0 );
+    for( unsigned int lane = 0; lane < NumberOfLanes; lane += 2 )
+    {
+      const __m128d t  = _mm_loadu_pd( u + lane );
+      const __m128d t2 = _mm_mul_pd( t, t );
+      const __m128d t3 = _mm_mul_pd( t2, t );
+      const __m128d s  = _mm_sub_pd( one, t );
+      const __m128d w0 = _mm_mul_pd( _mm_mul_pd( _mm_mul_pd( s, s ), s ), sixth );
+      const __m128d w1 = _mm_mul_pd( _mm_add_pd( _mm_sub_pd(
+        _mm_mul_pd( three, t3 ), _mm_mul_pd( six, t2 ) ), four ), sixth );
+      const __m128d w3 = _mm_mul_pd( t3, sixth );
+      const __m128d w2 = _mm_sub_pd( _mm_sub_pd( _mm_sub_pd( one, w0 ), w1 ), w3 );
+      _mm_storeu_pd( weights[ 0 ] + lane, w0 );
+      _mm_storeu_pd( weights[ 1 ] + lane, w1 );
+      _mm_storeu_pd( weights[ 2 ] + lane, w2 );
+      _mm_storeu_pd( weights[ 3 ] + lane, w3 );
+    }
+#else
+    for( unsigned int lane = 0; lane < NumberOfLanes; ++lane )
+    {
+      const double t  = u[ lane ];
+      const double t2 = t * t;
+      const double t3 = t2 * t;
+      const double s  = 1.0 - t;
+      weights[ 0 ][ lane ] = s * s * s * ( 1.0 / 6.0 );
+      weights[ 1 ][ lane ] = ( 3.0 * t3 - 6.0 * t2 + 4.0 ) * ( 1.0 / 6.0 );
+      weights[ 3 ][ lane ] = t3 * ( 1.0 / 6.0 );
+      weights[ 2 ][ lane ] = 1.0 - weights[ 0 ][ lane ] - weights[ 1 ][ lane ] - weights[ 3 ][ lane ];
+    }
+#endif
+  }
+
+
+  /** Compute the displacement of one point. The coefficients of row r of
+   * the support region start at coefficients[ dim ] + startOffset + rowOffsets[ r ].
+   * weightsX contains the four weights of the first dimension, and
+   * rowWeights the product of the weights of the other dimensions, per row.
+   */
+  static void ComputeDisplacement(
+    const TPixel * const * coefficients,
+    const OffsetValueType * rowOffsets,
+    OffsetValueType startOffset,
+    unsigned long numberOfRows,
+    const double * weightsX,
+    const double * rowWeights,
+    double * displacement )
+  {
+    for( unsigned int j = 0; j < NDimensions; ++j )
+    {
+      displacement[ j ] = 0.0;
+    }
+
+    for( unsigned long r = 0; r < numberOfRows; ++r )
+    {
+      const OffsetValueType offset = startOffset + rowOffsets[ r ];
+      const double          w0     = weightsX[ 0 ] * rowWeights[ r ];
+      const double          w1     = weightsX[ 1 ] * rowWeights[ r ];
+      const double          w2     = weightsX[ 2 ] * rowWeights[ r ];
+      const double          w3     = weightsX[ 3 ] * rowWeights[ r ];
+      for( unsigned int j = 0; j < NDimensions; ++j )
+      {
+        const TPixel * c = coefficients[ j ] + offset;
+        displacement[ j ] += w0 * c[ 0 ] + w1 * c[ 1 ] + w2 * c[ 2 ] + w3 * c[ 3 ];
+      }
+    }
+  }
+
+
+};
+
+#if defined( ELX_CUBIC_BSPLINE_KERNEL_USE_AVX ) || defined( ELX_CUBIC_BSPLINE_KERNEL_USE_SSE2 )
+
+/** Partial specialization for double precision coefficients, that loads
+ * the rows of the support region with vector instructions.
+ */
+template< unsigned int NDimensions >
+class CubicBSplineTransformPointKernel< double, NDimensions >
+{
+public:
+
+  itkStaticConstMacro( NumberOfLanes, unsigned int, 4 );
+
+  /** The weights do not depend on the pixel type. */
+  static void ComputeWeights( const double * u, double weights[ 4 ][ 4 ] )
+  {
+    CubicBSplineTransformPointKernel< float, NDimensions >::ComputeWeights( u, weights );
+  }
+
+
+  static void ComputeDisplacement(
+    const double * const * coefficients,
+    const OffsetValueType * rowOffsets,
+    OffsetValueType startOffset,
+    unsigned long numberOfRows,
+    const double * weightsX,
+    const double * rowWeights,
+    double * displacement )
+  {
+#if defined( ELX_CUBIC_BSPLINE_KERNEL_USE_AVX )
+    const __m256d wx = _mm256_loadu_pd( weightsX );
+    __m256d       accumulator[ NDimensions ];
+    for( unsigned int j = 0; j < NDimensions; ++j )
+    {
+      accumulator[ j ] = _mm256_setzero_pd();
+    }
+
+    for( unsigned long r = 0; r < numberOfRows; ++r )
+    {
+      const OffsetValueType offset = startOffset + rowOffsets[ r ];
+      const __m256d         w      = _mm256_mul_pd( wx, _mm256_set1_pd( rowWeights[ r ] ) );
+      for( unsigned int j = 0; j < NDimensions; ++j )
+      {
+        accumulator[ j ] = _mm256_add_pd( accumulator[ j ],
+          _mm256_mul_pd( w, _mm256_loadu_pd( coefficients[ j ] + offset ) ) );
+      }
+    }
+
+    /** Horizontal sums. */
+    double sums[ 4 ];
+    for( unsigned int j = 0; j < NDimensions; ++j )
+    {
+      _mm256_storeu_pd( sums, accumulator[ j ] );
+      displacement[ j ] = ( sums[ 0 ] + sums[ 1 ] ) + ( sums[ 2 ] + sums[ 3 ] );
+    }
+#else
+    const __m128d wx01 = _mm_loadu_pd( weightsX );
+    const __m128d wx23 = _mm_loadu_pd( weightsX + 2 );
+    __m128d       accumulator[ NDimensions ];
+    for( unsigned int j = 0; j < NDimensions; ++j )
+    {
+      accumulator[ j ] = _mm_setzero_pd();
+    }
+
+    for( unsigned long r = 0; r < numberOfRows; ++r )
+    {
+      const OffsetValueType offset = startOffset + rowOffsets[ r ];
+      const __m128d         wr     = _mm_set1_pd( rowWeights[ r ] );
+      const __m128d         w01    = _mm_mul_pd( wx01, wr );
+      const __m128d         w23    = _mm_mul_pd( wx23, wr );
+      for( unsigned int j = 0; j < NDimensions; ++j )
+      {
+        const double * c = coefficients[ j ] + offset;
+        accumulator[ j ] = _mm_add_pd( accumulator[ j ], _mm_add_pd(
+          _mm_mul_pd( w01, _mm_loadu_pd( c ) ),
+          _mm_mul_pd( w23, _mm_loadu_pd( c + 2 ) ) ) );
+      }
+    }
+
+    /** Horizontal sums. */
+    double sums[ 2 ];
+    for( unsigned int j = 0; j < NDimensions; ++j )
+    {
+      _mm_storeu_pd( sums, accumulator[ j ] );
+      displacement[ j ] = sums[ 0 ] + sums[ 1 ];
+    }
+#endif
+  }
+
+
+};
+
+#endif
+
+} // end namespace itk
+
+#endif // end #ifndef __itkCubicBSplineTransformPointKernel_h
@@ -330,7 +330,6 @@ TransformToSpatialJacobianSource< TOutputImage, TTransformPrecisionType >
   outputPtr->SetSpacing( m_OutputSpacing );
   outputPtr->SetOrigin( m_OutputOrigin );
   outputPtr->SetDirection( m_OutputDirection );
-  outputPtr->Allocate();
 
 } // end GenerateOutputInformation()
 
@@ -38,6 +38,8 @@ PURPOSE.  See the above copyright notices for more information.
 #include "itkTransform.h"
 #include "itkVector.h"
 
+#include <vector>
+
 namespace itk
 {
 
@@ -48,6 +50,17 @@ namespace itk
  * image and uses bilinear interpolation to integrate each plane of
  * voxels traversed.
  *
+ * Besides the per-ray Evaluate(), EvaluateRays() casts a number of rays at
+ * once. It computes the focal point and the bounding planes of the volume
+ * once, and integrates packets of RayPacketSize rays in lock-step, with the
+ * ray states stored as arrays over the packet, so that the RayPacketStepKernel
+ * steps the rays with vector instructions. Planes of voxels that are all
+ * below the threshold are skipped, and a ray is terminated when it has
+ * passed the last such plane that contains voxels above the threshold. The
+ * result is the same as that of Evaluate(). The RayCastResampleImageFilter,
+ * and thereby the elastix DefaultResampler, uses EvaluateRays() to render a
+ * whole image.
+ *
  * \warning This interpolator works for 3-dimensional images only.
  *
  * \ingroup ImageFunctions
@@ -118,6 +131,15 @@ public:
   /** ContinuousIndex typedef support. */
   typedef typename Superclass::ContinuousIndexType ContinuousIndexType;
 
+  /** The number of rays that EvaluateRays() integrates in lock-step. */
+  itkStaticConstMacro( RayPacketSize, unsigned int, 8 );
+
+  /** Set the input image. This also computes, per axis, the maximum
+   * intensity of each plane of voxels, which EvaluateRays() uses to skip
+   * planes below the threshold.
+   */
+  virtual void SetInputImage( const InputImageType * ptr );
+
   /** \brief
    * Interpolate the image at a point position.
    *
@@ -144,6 +166,14 @@ public:
   virtual OutputType EvaluateAtContinuousIndex(
     const ContinuousIndexType & index ) const;
 
+  /** Cast the rays through a number of points at once.
+   *
+   * Returns in values[ i ] the same as Evaluate( points[ i ] ). This
+   * method is thread safe, so different threads can cast different rays.
+   */
+  virtual void EvaluateRays( const PointType * points,
+    const unsigned int numberOfRays, OutputType * values ) const;
+
   /** Connect the Transform. */
   itkSetObjectMacro( Transform, TransformType );
   /** Get a pointer to the Transform.  */
@@ -208,6 +238,16 @@ protected:
   /// Pointer to the interpolator
   InterpolatorPointer m_Interpolator;
 
+  /// Compute the maximum intensity of each plane of voxels along each axis.
+  void ComputeSliceMaxima( void );
+
+  /// The maximum intensity of each plane of voxels along each axis
+  std::vector< double > m_SliceMaxima[ 3 ];
+
+  /// The image and its modification time for which the maxima were computed
+  const InputImageType * m_SliceMaximaImage;
+  unsigned long          m_SliceMaximaMTime;
+
 private:
 
   AdvancedRayCastInterpolateImageFunction( const Self & ); // purposely not implemented
@@ -36,13 +36,40 @@ PURPOSE.  See the above copyright notices for more information.
 
 #include "itkAdvancedRayCastInterpolateImageFunction.h"
 
+#include "itkNumericTraits.h"
+#include "itkRayPacketStepKernel.h"
 #include "vnl/vnl_math.h"
 
+#include <algorithm>
+
 // Put the helper class in an anonymous namespace so that it is not
 // exposed to the user
 namespace
 {
 
+/** The state of a ray at the start of its traversal, which is copied from
+ * the RayCastHelper to integrate a packet of rays in lock-step.
+ */
+template< class TPixel >
+struct RayTraversalState
+{
+  /// Flag indicating whether the ray is valid
+  bool m_ValidRay;
+  /// The axis along which the ray steps one plane of voxels at a time
+  unsigned int m_TraversalAxis;
+  /// The total number of planes of voxels traversed by the ray
+  int m_TotalRayVoxelPlanes;
+  /// The start position and the increment of the ray in voxels
+  double m_Position3Dvox[ 3 ];
+  double m_VoxelIncrement[ 3 ];
+  /// The index of the first plane of voxels along the traversal axis
+  int m_PlaneIndex;
+  /// Pointer to the first of the four voxels surrounding the ray
+  const TPixel * m_FirstVoxel;
+  /// The ray point spacing in mm
+  double m_RayPointSpacing;
+};
+
 /** \class Helper class to maintain state when casting a ray.
  *  This helper class keeps the AdvancedRayCastInterpolateImageFunction thread safe.
  */
@@ -161,6 +188,9 @@ public:
   }
 
 
+  /// Copy the state of the ray at the start of its traversal.
+  void GetTraversalState( RayTraversalState< PixelType > & state ) const;
+
   /// Set the initial zero state of the object
   void ZeroState();
 
@@ -1440,6 +1470,37 @@ RayCastHelper< TInputImage, TCoordRep >
 }
 
 
+/* -----------------------------------------------------------------------
+   GetTraversalState() - Copy the state of the ray at its start
+   ----------------------------------------------------------------------- */
+
+template< class TInputImage, class TCoordRep >
+void
+RayCastHelper< TInputImage, TCoordRep >
+::GetTraversalState( RayTraversalState< PixelType > & state ) const
+{
+  int i;
+
+  // The voxel pointers are NULL if the ray starts outside the volume
+  state.m_ValidRay = m_ValidRay && ( m_RayIntersectionVoxels[ 0 ] != NULL );
+  if( !state.m_ValidRay )
+  {
+    return;
+  }
+
+  for( i = 0; i < 3; i++ )
+  {
+    state.m_Position3Dvox[ i ]  = m_RayVoxelStartPosition[ i ];
+    state.m_VoxelIncrement[ i ] = m_VoxelIncrement[ i ];
+  }
+  state.m_TraversalAxis       = m_TraversalDirection - TRANSVERSE_IN_X;
+  state.m_TotalRayVoxelPlanes = m_TotalRayVoxelPlanes;
+  state.m_PlaneIndex          = m_RayIntersectionVoxelIndex[ state.m_TraversalAxis ];
+  state.m_FirstVoxel          = m_RayIntersectionVoxels[ 0 ];
+  state.m_RayPointSpacing     = this->GetRayPointSpacing();
+}
+
+
 /* -----------------------------------------------------------------------
    ZeroState() - Set the default (zero) state of the object
    ----------------------------------------------------------------------- */
@@ -1524,6 +1585,9 @@ AdvancedRayCastInterpolateImageFunction< TInputImage, TCoordRep >
   m_FocalPoint[ 0 ] = 0.;
   m_FocalPoint[ 1 ] = 0.;
   m_FocalPoint[ 2 ] = 0.;
+
+  m_SliceMaximaImage = 0;
+  m_SliceMaximaMTime = 0;
 }
 
 
@@ -1588,6 +1652,250 @@ AdvancedRayCastInterpolateImageFunction< TInputImage, TCoordRep >
 }
 
 
+/* -----------------------------------------------------------------------
+   SetInputImage() - Set the image and compute the plane maxima
+   ----------------------------------------------------------------------- */
+
+template< class TInputImage, class TCoordRep >
+void
+AdvancedRayCastInterpolateImageFunction< TInputImage, TCoordRep >
+::SetInputImage( const InputImageType * ptr )
+{
+  this->Superclass::SetInputImage( ptr );
+
+  // The resample filter sets the image before every update, so only
+  // recompute the maxima if the image has changed.
+  if( ptr != 0
+    && ( ptr != m_SliceMaximaImage || ptr->GetMTime() != m_SliceMaximaMTime ) )
+  {
+    this->ComputeSliceMaxima();
+  }
+}
+
+
+/* -----------------------------------------------------------------------
+   ComputeSliceMaxima() - Compute the maximum of each plane of voxels
+   ----------------------------------------------------------------------- */
+
+template< class TInputImage, class TCoordRep >
+void
+AdvancedRayCastInterpolateImageFunction< TInputImage, TCoordRep >
+::ComputeSliceMaxima( void )
+{
+  const SizeType size = this->m_Image->GetLargestPossibleRegion().GetSize();
+  for( unsigned int i = 0; i < 3; i++ )
+  {
+    m_SliceMaxima[ i ].assign( size[ i ], NumericTraits< double >::NonpositiveMin() );
+  }
+
+  // The ray caster assumes that the buffer is the largest possible region
+  const PixelType * voxel = this->m_Image->GetBufferPointer();
+  for( unsigned int z = 0; z < size[ 2 ]; z++ )
+  {
+    for( unsigned int y = 0; y < size[ 1 ]; y++ )
+    {
+      for( unsigned int x = 0; x < size[ 0 ]; x++, voxel++ )
+      {
+        const double value = static_cast< double >( *voxel );
+        m_SliceMaxima[ 0 ][ x ] = std::max( m_SliceMaxima[ 0 ][ x ], value );
+        m_SliceMaxima[ 1 ][ y ] = std::max( m_SliceMaxima[ 1 ][ y ], value );
+        m_SliceMaxima[ 2 ][ z ] = std::max( m_SliceMaxima[ 2 ][ z ], value );
+      }
+    }
+  }
+
+  m_SliceMaximaImage = this->m_Image;
+  m_SliceMaximaMTime = this->m_Image->GetMTime();
+}
+
+
+/* -----------------------------------------------------------------------
+   EvaluateRays() - Cast the rays through a number of points
+   ----------------------------------------------------------------------- */
+
+template< class TInputImage, class TCoordRep >
+void
+AdvancedRayCastInterpolateImageFunction< TInputImage, TCoordRep >
+::EvaluateRays( const PointType * points, const unsigned int numberOfRays,
+  OutputType * values ) const
+{
+  typedef RayCastHelper< TInputImage, TCoordRep > RayCastHelperType;
+  typedef RayTraversalState< PixelType >          RayTraversalStateType;
+  typedef RayPacketStepKernel< RayPacketSize >    RayPacketStepKernelType;
+
+  const unsigned int packetSize = RayPacketSize;
+
+  // The focal point and the bounding planes of the volume are the same
+  // for all rays, so compute them once.
+  const OutputPointType transformedFocalPoint
+    = m_Transform->TransformPoint( m_FocalPoint );
+
+  RayCastHelperType ray;
+  ray.SetImage( this->m_Image );
+  ray.ZeroState();
+  ray.Initialise();
+
+  // For each traversal axis, the axes within the planes of voxels and the
+  // offsets of the second and third of the four voxels around the ray.
+  const SizeType        size = this->m_Image->GetLargestPossibleRegion().GetSize();
+  const OffsetValueType nx   = size[ 0 ];
+  const OffsetValueType nxy  = size[ 0 ] * size[ 1 ];
+  const unsigned int    planeAxes[ 3 ][ 2 ]    = { { 1, 2 }, { 0, 2 }, { 0, 1 } };
+  const OffsetValueType planeOffsets[ 3 ][ 2 ] = { { nx, nxy }, { 1, nxy }, { 1, nx } };
+
+  // For each axis, the first and last plane with voxels above the threshold
+  int firstPlane[ 3 ], lastPlane[ 3 ];
+  for( unsigned int i = 0; i < 3; i++ )
+  {
+    firstPlane[ i ] = static_cast< int >( m_SliceMaxima[ i ].size() );
+    lastPlane[ i ]  = -1;
+    for( int j = 0; j < static_cast< int >( m_SliceMaxima[ i ].size() ); j++ )
+    {
+      if( m_SliceMaxima[ i ][ j ] > m_Threshold )
+      {
+        firstPlane[ i ] = std::min( firstPlane[ i ], j );
+        lastPlane[ i ]  = j;
+      }
+    }
+  }
+
+  // The state of the rays in the packet, stored per component so that the
+  // stepping of the rays is a loop over arrays.
+  RayTraversalStateType state;
+  double                position[ 3 ][ RayPacketSize ];
+  double                increment[ 3 ][ RayPacketSize ];
+  OffsetValueType       offset[ RayPacketSize ];
+  int                   planeIndex[ RayPacketSize ];
+  int                   numberOfPlanes[ RayPacketSize ];
+  unsigned int          axis[ RayPacketSize ];
+  double                integral[ RayPacketSize ];
+  double                rayPointSpacing[ RayPacketSize ];
+  int                   step[ 3 ][ RayPacketSize ];
+
+  const PixelType * buffer = this->m_Image->GetBufferPointer();
+
+  for( unsigned int first = 0; first < numberOfRays; first += packetSize )
+  {
+    const unsigned int numberOfLanes = std::min( packetSize, numberOfRays - first );
+    int                maxNumberOfPlanes = 0;
+
+    // The unused lanes of the last packet are stepped as well
+    for( unsigned int lane = numberOfLanes; lane < packetSize; lane++ )
+    {
+      for( unsigned int i = 0; i < 3; i++ )
+      {
+        position[ i ][ lane ]  = 0.;
+        increment[ i ][ lane ] = 0.;
+      }
+    }
+
+    // Set up the rays of the packet
+    for( unsigned int lane = 0; lane < numberOfLanes; lane++ )
+    {
+      const DirectionType direction = transformedFocalPoint - points[ first + lane ];
+      ray.SetRay( points[ first + lane ], direction );
+      ray.GetTraversalState( state );
+
+      integral[ lane ] = 0.;
+      if( !state.m_ValidRay )
+      {
+        numberOfPlanes[ lane ]  = 0;
+        rayPointSpacing[ lane ] = 0.;
+        axis[ lane ]            = 0;
+        offset[ lane ]          = 0;
+        planeIndex[ lane ]      = 0;
+        for( unsigned int i = 0; i < 3; i++ )
+        {
+          position[ i ][ lane ]  = 0.;
+          increment[ i ][ lane ] = 0.;
+        }
+        continue;
+      }
+
+      for( unsigned int i = 0; i < 3; i++ )
+      {
+        position[ i ][ lane ]  = state.m_Position3Dvox[ i ];
+        increment[ i ][ lane ] = state.m_VoxelIncrement[ i ];
+      }
+      axis[ lane ]            = state.m_TraversalAxis;
+      offset[ lane ]          = state.m_FirstVoxel - buffer;
+      planeIndex[ lane ]      = state.m_PlaneIndex;
+      numberOfPlanes[ lane ]  = state.m_TotalRayVoxelPlanes;
+      rayPointSpacing[ lane ] = state.m_RayPointSpacing;
+
+      // A ray through planes that are all below the threshold is empty
+      if( firstPlane[ axis[ lane ] ] > lastPlane[ axis[ lane ] ] )
+      {
+        numberOfPlanes[ lane ] = 0;
+      }
+      maxNumberOfPlanes = std::max( maxNumberOfPlanes, numberOfPlanes[ lane ] );
+    }
+
+    // Step the rays through the volume in lock-step
+    for( int plane = 0; plane < maxNumberOfPlanes; plane++ )
+    {
+      // Integrate the interpolated intensities above the threshold
+      for( unsigned int lane = 0; lane < numberOfLanes; lane++ )
+      {
+        if( plane >= numberOfPlanes[ lane ] )
+        {
+          continue;
+        }
+
+        // Terminate the ray once it has passed the last plane of voxels
+        // above the threshold, and skip planes that are below it.
+        const unsigned int a = axis[ lane ];
+        const int          p = planeIndex[ lane ];
+        if( ( increment[ a ][ lane ] > 0 && p > lastPlane[ a ] )
+          || ( increment[ a ][ lane ] < 0 && p < firstPlane[ a ] ) )
+        {
+          numberOfPlanes[ lane ] = plane;
+          continue;
+        }
+        if( p >= 0 && p < static_cast< int >( m_SliceMaxima[ a ].size() )
+          && m_SliceMaxima[ a ][ p ] <= m_Threshold )
+        {
+          continue;
+        }
+
+        const PixelType * voxel = buffer + offset[ lane ];
+        const double      va    = (double)( voxel[ 0 ] );
+        const double      vb    = (double)( voxel[ planeOffsets[ a ][ 0 ] ] - va );
+        const double      vc    = (double)( voxel[ planeOffsets[ a ][ 1 ] ] - va );
+        const double      vd    = (double)( voxel[ planeOffsets[ a ][ 0 ] + planeOffsets[ a ][ 1 ] ]
+          - va - vb - vc );
+
+        const double y = position[ planeAxes[ a ][ 0 ] ][ lane ]
+          - vcl_floor( position[ planeAxes[ a ][ 0 ] ][ lane ] );
+        const double z = position[ planeAxes[ a ][ 1 ] ][ lane ]
+          - vcl_floor( position[ planeAxes[ a ][ 1 ] ][ lane ] );
+
+        const double intensity = va + vb * y + vc * z + vd * y * z;
+        if( intensity > m_Threshold )
+        {
+          integral[ lane ] += intensity - m_Threshold;
+        }
+      }
+
+      // Step all rays to the next plane of voxels, with vector
+      // instructions if available. Finished rays are stepped as well,
+      // which keeps these loops free of branches.
+      RayPacketStepKernelType::Step( position, increment, step );
+      for( unsigned int lane = 0; lane < numberOfLanes; lane++ )
+      {
+        offset[ lane ]     += step[ 0 ][ lane ] + step[ 1 ][ lane ] * nx + step[ 2 ][ lane ] * nxy;
+        planeIndex[ lane ] += step[ axis[ lane ] ][ lane ];
+      }
+    }
+
+    for( unsigned int lane = 0; lane < numberOfLanes; lane++ )
+    {
+      values[ first + lane ] = static_cast< OutputType >( integral[ lane ] * rayPointSpacing[ lane ] );
+    }
+  }
+}
+
+
 } // namespace itk
 
 #endif
@@ -0,0 +1,89 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkBinaryParametersFile_h
+#define __itkBinaryParametersFile_h
+
+#include "itkObject.h"
+
+#include <string>
+
+namespace itk
+{
+
+/** \class BinaryParametersFile
+ *
+ * \brief Reads and writes an array of parameters as raw little endian values.
+ *
+ * This is the file format of the BinaryTransformParametersFileName of the
+ * elastix transforms. Write() swaps the values to little endian when needed.
+ * Read() maps the file with a MemoryMappedFile, instead of parsing the values
+ * one by one, and throws an exception when the size of the file does not
+ * match the expected number of values.
+ *
+ * \ingroup ITKSystemObjects
+ */
+
+template< class TValue >
+class BinaryParametersFile : public Object
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef BinaryParametersFile       Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( BinaryParametersFile, Object );
+
+  typedef TValue ValueType;
+
+  /** Get the path of a binary file relative to another file, such as the
+   * transform parameter file that refers to it. A full path is returned as is.
+   */
+  static std::string GetPath( const std::string & fileName,
+    const std::string & referenceFileName );
+
+  /** Write numberOfValues values to fileName. */
+  static void Write( const std::string & fileName,
+    const ValueType * values, const SizeValueType numberOfValues );
+
+  /** Read numberOfValues values from fileName. */
+  static void Read( const std::string & fileName,
+    ValueType * values, const SizeValueType numberOfValues );
+
+protected:
+
+  BinaryParametersFile() {}
+  virtual ~BinaryParametersFile() {}
+
+private:
+
+  BinaryParametersFile( const Self & ); // purposely not implemented
+  void operator=( const Self & );       // purposely not implemented
+
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBinaryParametersFile.hxx"
+#endif
+
+#endif // end #ifndef __itkBinaryParametersFile_h
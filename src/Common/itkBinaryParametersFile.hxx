@@ -0,0 +1,119 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkBinaryParametersFile_hxx
+#define __itkBinaryParametersFile_hxx
+
+#include "itkBinaryParametersFile.h"
+#include "itkMemoryMappedFile.h"
+#include "itkByteSwapper.h"
+#include <itksys/SystemTools.hxx>
+
+#include <cstring> // for memcpy
+#include <fstream>
+
+namespace itk
+{
+
+/**
+ * ********************* GetPath ****************************
+ */
+
+template< class TValue >
+std::string
+BinaryParametersFile< TValue >
+::GetPath( const std::string & fileName,
+  const std::string & referenceFileName )
+{
+  if( itksys::SystemTools::FileIsFullPath( fileName.c_str() ) )
+  {
+    return fileName;
+  }
+  const std::string directory
+    = itksys::SystemTools::GetFilenamePath( referenceFileName );
+  if( directory.empty() )
+  {
+    return fileName;
+  }
+  return directory + "/" + fileName;
+
+} // end GetPath()
+
+
+/**
+ * ********************* Write ****************************
+ */
+
+template< class TValue >
+void
+BinaryParametersFile< TValue >
+::Write( const std::string & fileName,
+  const ValueType * values, const SizeValueType numberOfValues )
+{
+  std::ofstream output( fileName.c_str(), std::ios::out | std::ios::binary );
+  if( !output.is_open() )
+  {
+    itkGenericExceptionMacro( << "ERROR: File \"" << fileName
+                              << "\" could not be opened for writing!" );
+  }
+
+  /** Write the values as little endian values, swapping if needed. */
+  ByteSwapper< ValueType >::SwapWriteRangeFromSystemToLittleEndian(
+    const_cast< ValueType * >( values ), numberOfValues, &output );
+  if( !output )
+  {
+    itkGenericExceptionMacro( << "ERROR: Could not write to \"" << fileName << "\"!" );
+  }
+
+} // end Write()
+
+
+/**
+ * ********************* Read ****************************
+ */
+
+template< class TValue >
+void
+BinaryParametersFile< TValue >
+::Read( const std::string & fileName,
+  ValueType * values, const SizeValueType numberOfValues )
+{
+  /** Map the file, instead of parsing the values one by one. */
+  MemoryMappedFile::Pointer file = MemoryMappedFile::New();
+  file->Open( fileName );
+
+  const std::size_t expectedSize = numberOfValues * sizeof( ValueType );
+  if( file->GetSize() != expectedSize )
+  {
+    itkGenericExceptionMacro( << "\nERROR: Invalid binary transform parameter file!\n"
+                              << "The file \"" << fileName << "\" contains "
+                              << file->GetSize() << " bytes, while " << numberOfValues
+                              << " parameters, i.e. " << expectedSize << " bytes, were expected." );
+  }
+
+  if( expectedSize > 0 )
+  {
+    std::memcpy( values, file->GetData(), expectedSize );
+    ByteSwapper< ValueType >::SwapRangeFromSystemToLittleEndian( values, numberOfValues );
+  }
+
+} // end Read()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkBinaryParametersFile_hxx
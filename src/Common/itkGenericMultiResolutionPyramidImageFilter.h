@@ -98,6 +98,23 @@ namespace itk
  * compute only single level of the pyramid via SetCurrentLevel() and
  * SetComputeOnlyForCurrentLevel() methods.
  *
+ * Levels that are neither smoothed nor rescaled share the pixel buffer of
+ * the input image, if the input and output types are the same, instead of
+ * copying it. The outputs of this filter should therefore not be modified.
+ *
+ * By default every level is computed from the input image. With
+ * SetUseCascadedComputation( true ) the levels are computed from fine to
+ * coarse, and a level is derived from the next finer level whenever the
+ * schedules permit it: the shrink factors of the level have to be integer
+ * multiples of those of the finer level, and the finer level has to be
+ * smoothed in every dimension in which it is rescaled. The finer level is
+ * then smoothed with the incremental sigma sqrt( sigma^2 - sigma_finer^2 )
+ * and shrunk or resampled with the relative factors, so that the coarse
+ * levels no longer require smoothing at full resolution. Because the finer
+ * level is already subsampled, the result is an approximation of the
+ * direct computation. Other levels, and all levels when only the current
+ * level is computed, use the direct computation.
+ *
  * \author Denis P. Shamonin and Marius Staring. Division of Image Processing,
  * Department of Radiology, Leiden, The Netherlands
  *
@@ -220,6 +237,13 @@ public:
   itkGetConstMacro( ComputeOnlyForCurrentLevel, bool );
   itkBooleanMacro( ComputeOnlyForCurrentLevel );
 
+  /** Set/Get whether levels are derived from the next finer level where
+   * the schedules permit it. Default false.
+   */
+  itkSetMacro( UseCascadedComputation, bool );
+  itkGetConstMacro( UseCascadedComputation, bool );
+  itkBooleanMacro( UseCascadedComputation );
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro( SameDimensionCheck,
@@ -266,6 +290,7 @@ protected:
   unsigned int          m_CurrentLevel;
   bool                  m_ComputeOnlyForCurrentLevel;
   bool                  m_SmoothingScheduleDefined;
+  bool                  m_UseCascadedComputation;
 
 private:
 
@@ -284,6 +309,12 @@ private:
   typedef ImageToImageFilter< InputImageType, OutputImageType >
     ImageToImageFilterDifferentTypes;
 
+  /** Typedef for the smoother of the cascaded computation, which smoothes
+   * the next finer level.
+   */
+  typedef SmoothingRecursiveGaussianImageFilter<
+    OutputImageType, OutputImageType > CascadeSmootherType;
+
   /** Smooth image at current level. Returns true if performed.
    * This method does not perform execution.
    */
@@ -310,6 +341,24 @@ private:
     typename ImageToImageFilterSameTypes::Pointer & rescaleSameTypes,
     typename ImageToImageFilterDifferentTypes::Pointer & rescaleDifferentTypes );
 
+  /** Returns true if the level can be derived from the next finer level. */
+  bool CanComputeFromFinerLevel( const unsigned int level ) const;
+
+  /** Compute the level from the next finer level, using the incremental
+   * sigmas and the relative shrink factors. This method performs execution.
+   */
+  void ComputeFromFinerLevel( const unsigned int level,
+    const OutputImagePointer & outputPtr,
+    typename CascadeSmootherType::Pointer & smoother,
+    typename ImageToImageFilterSameTypes::Pointer & rescaleSameTypes,
+    typename ImageToImageFilterDifferentTypes::Pointer & rescaleDifferentTypes );
+
+  /** Let the output share the input buffer, without copying. Returns false
+   * if the input and output types differ. The output must not be modified.
+   */
+  bool GraftInput( const InputImageConstPointer & input,
+    const OutputImagePointer & outputPtr ) const;
+
   /** Initialize m_SmoothingSchedule to default values for backward compatibility. */
   void SetSmoothingScheduleToDefault( void );
 
@@ -342,6 +391,9 @@ private:
    */
   bool AreRescaleFactorsAllOnes( const RescaleFactorArrayType & rescaleFactorArray ) const;
 
+  /** Returns true if the level is neither smoothed nor rescaled. */
+  bool IsIdentityLevel( const unsigned int level ) const;
+
   /** Returns true if smooth has been used in pipeline, otherwise return false. */
   bool IsSmoothingUsed( void ) const;
 
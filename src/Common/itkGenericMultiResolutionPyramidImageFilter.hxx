@@ -44,6 +44,10 @@ UpdateAndGraft(
   filter->Modified();
   filter->UpdateLargestPossibleRegion();
   thisFilter->GraftNthOutput( ilevel, filter->GetOutput() );
+
+  // Release the buffer of the filter output, so that a later update of the
+  // filter does not write into this level, which may still be read.
+  filter->GetOutput()->ReleaseData();
 } // end UpdateAndGraft()
 
 
@@ -65,6 +69,7 @@ GenericMultiResolutionPyramidImageFilter< TInputImage, TOutputImage, TPrecisionT
   temp.Fill( NumericTraits< ScalarRealType >::ZeroValue() );
   this->m_SmoothingSchedule        = temp;
   this->m_SmoothingScheduleDefined = false;
+  this->m_UseCascadedComputation   = false;
 } // end Constructor
 
 
@@ -281,7 +286,7 @@ GenericMultiResolutionPyramidImageFilter< TInputImage, TOutputImage, TPrecisionT
   //    Then pipeline is: input -> smoother -> output
   // 4. m_UseMultiResolutionSmoothingSchedule = false
   //    m_UseMultiResolutionRescaleSchedule = false
-  //    Then pipeline is: input -> copy -> output
+  //    Then pipeline is: input -> graft -> output
   //
   // 1.a) The smoother can be skipped if AreSigmasAllZeros(...)
   //      returns true for the current level.
@@ -294,6 +299,10 @@ GenericMultiResolutionPyramidImageFilter< TInputImage, TOutputImage, TPrecisionT
   //
   // Pipeline also takes care of memory allocation for N'th output if
   // SetComputeOnlyForCurrentLevel has been set to true.
+  //
+  // In the cascaded computation the levels are computed from fine to coarse,
+  // and the pipeline of a level is: finer level -> smoother -> shrinker/resample
+  // -> output, if CanComputeFromFinerLevel(...) returns true for the level.
 
   // Get the input and output pointers
   InputImageConstPointer input = this->GetInput();
@@ -301,7 +310,8 @@ GenericMultiResolutionPyramidImageFilter< TInputImage, TOutputImage, TPrecisionT
   // Check if we have to do anything at all
   if( !this->IsSmoothingUsed() && !this->IsRescaleUsed() )
   {
-    // This is a special case we just allocate output images and copy input
+    // This is a special case we just share the input buffer, or allocate
+    // output images and copy input if the types differ
     for( unsigned int level = 0; level < this->m_NumberOfLevels; ++level )
     {
       if( !this->m_ComputeOnlyForCurrentLevel )
@@ -313,6 +323,9 @@ GenericMultiResolutionPyramidImageFilter< TInputImage, TOutputImage, TPrecisionT
       if( this->ComputeForCurrentLevel( level ) )
       {
         OutputImagePointer outputPtr = this->GetOutput( level );
+        if( this->GraftInput( input, outputPtr ) ) { continue; }
+
+        outputPtr->Initialize();
         outputPtr->SetBufferedRegion( input->GetLargestPossibleRegion() );
         outputPtr->Allocate();
 
@@ -332,22 +345,45 @@ GenericMultiResolutionPyramidImageFilter< TInputImage, TOutputImage, TPrecisionT
   typename SmootherType::Pointer smoother;
   typename ImageToImageFilterSameTypes::Pointer rescaleSameTypes;
   typename ImageToImageFilterDifferentTypes::Pointer rescaleDifferentTypes;
+  typename CascadeSmootherType::Pointer cascadeSmoother;
 
-  for( unsigned int level = 0; level < this->m_NumberOfLevels; ++level )
+  // The cascaded computation requires the finer levels
+  const bool cascaded = this->m_UseCascadedComputation
+    && !this->m_ComputeOnlyForCurrentLevel;
+
+  for( unsigned int i = 0; i < this->m_NumberOfLevels; ++i )
   {
+    const unsigned int level = cascaded ? this->m_NumberOfLevels - 1 - i : i;
+
     if( !this->m_ComputeOnlyForCurrentLevel )
     {
-      this->UpdateProgress( static_cast< float >( level )
+      this->UpdateProgress( static_cast< float >( i )
         / static_cast< float >( this->m_NumberOfLevels ) );
     }
 
     if( this->ComputeForCurrentLevel( level ) )
     {
-      // Allocate memory for each output
+      // Levels without smoothing and rescaling share the input buffer
       OutputImagePointer outputPtr = this->GetOutput( level );
+      if( this->IsIdentityLevel( level ) && this->GraftInput( input, outputPtr ) )
+      {
+        continue;
+      }
+
+      // Allocate memory for each output. Initialize first, so that a buffer
+      // that is shared with the input or another level is not overwritten.
+      outputPtr->Initialize();
       outputPtr->SetBufferedRegion( outputPtr->GetRequestedRegion() );
       outputPtr->Allocate();
 
+      // Derive the level from the next finer level if possible
+      if( cascaded && this->CanComputeFromFinerLevel( level ) )
+      {
+        this->ComputeFromFinerLevel( level, outputPtr, cascadeSmoother,
+          rescaleSameTypes, rescaleDifferentTypes );
+        continue;
+      }
+
       // Setup the smoother
       const bool smootherIsUsed = this->SetupSmoother( level, smoother, input );
 
@@ -589,6 +625,144 @@ GenericMultiResolutionPyramidImageFilter< TInputImage, TOutputImage, TPrecisionT
 } // end DefineShrinkerOrResampler()
 
 
+/**
+ * ******************* CanComputeFromFinerLevel ***********************
+ */
+
+template< class TInputImage, class TOutputImage, class TPrecisionType >
+bool
+GenericMultiResolutionPyramidImageFilter< TInputImage, TOutputImage, TPrecisionType >
+::CanComputeFromFinerLevel( const unsigned int level ) const
+{
+  if( level + 1 >= this->m_NumberOfLevels ) { return false; }
+
+  SigmaArrayType         sigmaArray, finerSigmaArray;
+  RescaleFactorArrayType shrinkFactors, finerShrinkFactors;
+  this->GetSigma( level, sigmaArray );
+  this->GetSigma( level + 1, finerSigmaArray );
+  this->GetShrinkFactors( level, shrinkFactors );
+  this->GetShrinkFactors( level + 1, finerShrinkFactors );
+
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+  {
+    // The shrink factors have to be integer multiples of the finer ones
+    const unsigned int factor      = static_cast< unsigned int >( shrinkFactors[ dim ] );
+    const unsigned int finerFactor = static_cast< unsigned int >( finerShrinkFactors[ dim ] );
+    if( finerFactor == 0 || factor % finerFactor != 0 ) { return false; }
+
+    // Smoothing can only be added to the finer level
+    if( sigmaArray[ dim ] < finerSigmaArray[ dim ] ) { return false; }
+
+    // A finer level that is rescaled without smoothing is aliased
+    if( finerFactor != 1 && finerSigmaArray[ dim ] == 0.0 ) { return false; }
+  }
+
+  return true;
+} // end CanComputeFromFinerLevel()
+
+
+/**
+ * ******************* ComputeFromFinerLevel ***********************
+ */
+
+template< class TInputImage, class TOutputImage, class TPrecisionType >
+void
+GenericMultiResolutionPyramidImageFilter< TInputImage, TOutputImage, TPrecisionType >
+::ComputeFromFinerLevel( const unsigned int level,
+  const OutputImagePointer & outputPtr,
+  typename CascadeSmootherType::Pointer & smoother,
+  typename ImageToImageFilterSameTypes::Pointer & rescaleSameTypes,
+  typename ImageToImageFilterDifferentTypes::Pointer & rescaleDifferentTypes )
+{
+  // Use an image that shares the buffer of the finer level, but that is
+  // not connected to this filter, so that the mini pipeline does not
+  // update this filter.
+  OutputImagePointer finer = OutputImageType::New();
+  finer->Graft( this->GetOutput( level + 1 ) );
+
+  // Compute the incremental sigmas and the relative shrink factors
+  SigmaArrayType         sigmaArray, finerSigmaArray;
+  RescaleFactorArrayType shrinkFactors, finerShrinkFactors;
+  this->GetSigma( level, sigmaArray );
+  this->GetSigma( level + 1, finerSigmaArray );
+  this->GetShrinkFactors( level, shrinkFactors );
+  this->GetShrinkFactors( level + 1, finerShrinkFactors );
+
+  for( unsigned int dim = 0; dim < ImageDimension; dim++ )
+  {
+    const ScalarRealType variance = sigmaArray[ dim ] * sigmaArray[ dim ]
+      - finerSigmaArray[ dim ] * finerSigmaArray[ dim ];
+    sigmaArray[ dim ]     = variance > 0.0 ? vcl_sqrt( variance ) : 0.0;
+    shrinkFactors[ dim ] /= finerShrinkFactors[ dim ];
+  }
+
+  // Setup the smoother
+  const bool smootherIsUsed = !this->AreSigmasAllZeros( sigmaArray );
+  if( smootherIsUsed )
+  {
+    if( smoother.IsNull() )
+    {
+      // Never overwrite the finer level
+      smoother = CascadeSmootherType::New();
+      smoother->InPlaceOff();
+    }
+
+    smoother->SetInput( finer );
+    smoother->SetSigmaArray( sigmaArray );
+  }
+
+  // Setup the shrinker or resampler, update the pipeline and graft or copy
+  // the results to this filters output
+  if( !this->AreRescaleFactorsAllOnes( shrinkFactors ) )
+  {
+    this->DefineShrinkerOrResampler( true, shrinkFactors, outputPtr,
+      rescaleSameTypes, rescaleDifferentTypes );
+    if( smootherIsUsed )
+    {
+      rescaleSameTypes->SetInput( smoother->GetOutput() );
+    }
+    else
+    {
+      rescaleSameTypes->SetInput( finer );
+    }
+
+    UpdateAndGraft< Self, ImageToImageFilterSameTypes, OutputImageType >(
+      this, rescaleSameTypes, outputPtr, level );
+  }
+  else if( smootherIsUsed )
+  {
+    UpdateAndGraft< Self, CascadeSmootherType, OutputImageType >(
+      this, smoother, outputPtr, level );
+  }
+  else
+  {
+    // The level equals the finer level, so share its buffer
+    outputPtr->Graft( finer );
+  }
+
+} // end ComputeFromFinerLevel()
+
+
+/**
+ * ******************* GraftInput ***********************
+ */
+
+template< class TInputImage, class TOutputImage, class TPrecisionType >
+bool
+GenericMultiResolutionPyramidImageFilter< TInputImage, TOutputImage, TPrecisionType >
+::GraftInput( const InputImageConstPointer & input,
+  const OutputImagePointer & outputPtr ) const
+{
+  // The input buffer can only be shared if the types are the same
+  const OutputImageType * inputAsOutput
+    = dynamic_cast< const OutputImageType * >( input.GetPointer() );
+  if( inputAsOutput == 0 ) { return false; }
+
+  outputPtr->Graft( inputAsOutput );
+  return true;
+} // end GraftInput()
+
+
 /**
  * ******************* GenerateOutputInformation ***********************
  */
@@ -853,6 +1027,24 @@ GenericMultiResolutionPyramidImageFilter< TInputImage, TOutputImage, TPrecisionT
 } // end AreRescaleFactorsAllOnes()
 
 
+/**
+ * ******************* IsIdentityLevel ***********************
+ */
+
+template< class TInputImage, class TOutputImage, class TPrecisionType >
+bool
+GenericMultiResolutionPyramidImageFilter< TInputImage, TOutputImage, TPrecisionType >
+::IsIdentityLevel( const unsigned int level ) const
+{
+  SigmaArrayType         sigmaArray;
+  RescaleFactorArrayType rescaleFactors;
+  this->GetSigma( level, sigmaArray );
+  this->GetShrinkFactors( level, rescaleFactors );
+  return this->AreSigmasAllZeros( sigmaArray )
+         && this->AreRescaleFactorsAllOnes( rescaleFactors );
+} // end IsIdentityLevel()
+
+
 /**
  * ******************* IsSmoothingUsed ***********************
  */
@@ -916,6 +1108,8 @@ GenericMultiResolutionPyramidImageFilter< TInputImage, TOutputImage, TPrecisionT
      << ( this->m_ComputeOnlyForCurrentLevel ? "true" : "false" ) << std::endl;
   os << indent << "SmoothingScheduleDefined: "
      << ( this->m_SmoothingScheduleDefined ? "true" : "false" ) << std::endl;
+  os << indent << "UseCascadedComputation: "
+     << ( this->m_UseCascadedComputation ? "true" : "false" ) << std::endl;
   os << indent << "Smoothing Schedule: ";
   if( this->m_SmoothingSchedule.size() == 0 )
   {
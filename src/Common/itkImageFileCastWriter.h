@@ -101,7 +101,14 @@ protected:
     typename ScalarInputImageType::Pointer localInputImage = ScalarInputImageType::New();
     localInputImage->Graft( inputImage );
     caster->SetInput( localInputImage );
-    caster->Update();
+
+    /** Only cast the buffered region, which is the part that is currently
+     * written when the writer streams.
+     */
+    caster->UpdateOutputInformation();
+    caster->GetOutput()->SetRequestedRegion( localInputImage->GetBufferedRegion() );
+    caster->GetOutput()->PropagateRequestedRegion();
+    caster->GetOutput()->UpdateOutputData();
 
     /** return the pixel buffer of the casted image */
     OutputComponentType * pixelBuffer     = caster->GetOutput()->GetBufferPointer();
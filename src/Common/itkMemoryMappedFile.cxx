@@ -0,0 +1,211 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkMemoryMappedFile_cxx
+#define __itkMemoryMappedFile_cxx
+
+#include "itkMemoryMappedFile.h"
+
+#include <fstream>
+
+#if defined( _WIN32 )
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace itk
+{
+
+/**
+ * ********************* Constructor ****************************
+ */
+
+MemoryMappedFile
+::MemoryMappedFile()
+{
+  this->m_Data          = 0;
+  this->m_Size          = 0;
+  this->m_IsMapped      = false;
+  this->m_FileHandle    = 0;
+  this->m_MappingHandle = 0;
+
+} // end Constructor
+
+
+/**
+ * ********************* Destructor ****************************
+ */
+
+MemoryMappedFile
+::~MemoryMappedFile()
+{
+  this->Close();
+
+} // end Destructor
+
+
+/**
+ * ********************* Open ****************************
+ */
+
+void
+MemoryMappedFile
+::Open( const std::string & fileName )
+{
+  this->Close();
+
+#if defined( _WIN32 )
+  HANDLE file = CreateFileA( fileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
+    NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+  if( file != INVALID_HANDLE_VALUE )
+  {
+    LARGE_INTEGER fileSize;
+    if( GetFileSizeEx( file, &fileSize ) && fileSize.QuadPart > 0 )
+    {
+      HANDLE mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+      if( mapping != NULL )
+      {
+        const void * view = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+        if( view != NULL )
+        {
+          this->m_Data          = static_cast< const char * >( view );
+          this->m_Size          = static_cast< std::size_t >( fileSize.QuadPart );
+          this->m_IsMapped      = true;
+          this->m_FileHandle    = file;
+          this->m_MappingHandle = mapping;
+          return;
+        }
+        CloseHandle( mapping );
+      }
+    }
+    CloseHandle( file );
+  }
+#else
+  const int file = open( fileName.c_str(), O_RDONLY );
+  if( file >= 0 )
+  {
+    struct stat fileStatus;
+    if( fstat( file, &fileStatus ) == 0 && fileStatus.st_size > 0 )
+    {
+      const std::size_t size = static_cast< std::size_t >( fileStatus.st_size );
+      void *            view = mmap( 0, size, PROT_READ, MAP_PRIVATE, file, 0 );
+      if( view != MAP_FAILED )
+      {
+        /** The mapping stays valid after closing the file descriptor. */
+        close( file );
+        this->m_Data     = static_cast< const char * >( view );
+        this->m_Size     = size;
+        this->m_IsMapped = true;
+        return;
+      }
+    }
+    close( file );
+  }
+#endif
+
+  /** Mapping failed, e.g. for an empty file: read the file instead. */
+  this->ReadIntoBuffer( fileName );
+
+} // end Open()
+
+
+/**
+ * ********************* ReadIntoBuffer ****************************
+ */
+
+void
+MemoryMappedFile
+::ReadIntoBuffer( const std::string & fileName )
+{
+  std::ifstream input( fileName.c_str(), std::ios::in | std::ios::binary );
+  if( !input.is_open() )
+  {
+    itkExceptionMacro( << "ERROR: could not open \"" << fileName << "\" for reading." );
+  }
+
+  input.seekg( 0, std::ios::end );
+  const std::streamoff size = input.tellg();
+  input.seekg( 0, std::ios::beg );
+
+  this->m_Buffer.resize( static_cast< std::size_t >( size ) );
+  if( size > 0 )
+  {
+    input.read( &this->m_Buffer[ 0 ], size );
+    if( !input )
+    {
+      itkExceptionMacro( << "ERROR: could not read \"" << fileName << "\"." );
+    }
+    this->m_Data = &this->m_Buffer[ 0 ];
+  }
+  this->m_Size     = static_cast< std::size_t >( size );
+  this->m_IsMapped = false;
+
+} // end ReadIntoBuffer()
+
+
+/**
+ * ********************* Close ****************************
+ */
+
+void
+MemoryMappedFile
+::Close( void )
+{
+  if( this->m_IsMapped )
+  {
+#if defined( _WIN32 )
+    UnmapViewOfFile( this->m_Data );
+    CloseHandle( static_cast< HANDLE >( this->m_MappingHandle ) );
+    CloseHandle( static_cast< HANDLE >( this->m_FileHandle ) );
+#else
+    munmap( const_cast< char * >( this->m_Data ), this->m_Size );
+#endif
+  }
+
+  std::vector< char >().swap( this->m_Buffer );
+  this->m_Data          = 0;
+  this->m_Size          = 0;
+  this->m_IsMapped      = false;
+  this->m_FileHandle    = 0;
+  this->m_MappingHandle = 0;
+
+} // end Close()
+
+
+/**
+ * ********************* PrintSelf ****************************
+ */
+
+void
+MemoryMappedFile
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Size: " << this->m_Size << std::endl;
+  os << indent << "IsMapped: " << ( this->m_IsMapped ? "true" : "false" ) << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkMemoryMappedFile_cxx
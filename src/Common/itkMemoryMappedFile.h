@@ -0,0 +1,104 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkMemoryMappedFile_h
+#define __itkMemoryMappedFile_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+
+#include <string>
+#include <vector>
+
+namespace itk
+{
+
+/** \class MemoryMappedFile
+ *
+ * \brief Read-only view of the contents of a file.
+ *
+ * Open() maps the complete file into memory, using mmap() on POSIX systems
+ * and a file mapping on Windows. The pages are only read from disk when
+ * they are accessed, so large binary files can be used without an
+ * intermediate copy. When the file cannot be mapped, it is read into an
+ * internal buffer instead, so that the caller does not have to care.
+ *
+ * The data remains valid until Close() is called or the object is
+ * destroyed.
+ *
+ * \ingroup ITKSystemObjects
+ */
+
+class MemoryMappedFile : public Object
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef MemoryMappedFile           Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( MemoryMappedFile, Object );
+
+  /** Map the file. Throws an exception when the file cannot be read. */
+  virtual void Open( const std::string & fileName );
+
+  /** Unmap the file. */
+  virtual void Close( void );
+
+  /** Get the contents and the size in bytes of the file. */
+  const char * GetData( void ) const { return this->m_Data; }
+  std::size_t GetSize( void ) const { return this->m_Size; }
+
+  /** Returns true if the file is memory mapped, false if it was read into a buffer. */
+  itkGetConstMacro( IsMapped, bool );
+
+protected:
+
+  MemoryMappedFile();
+  virtual ~MemoryMappedFile();
+
+  /** PrintSelf. */
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+private:
+
+  MemoryMappedFile( const Self & ); // purposely not implemented
+  void operator=( const Self & );   // purposely not implemented
+
+  /** Read the file into m_Buffer; the fallback of Open(). */
+  void ReadIntoBuffer( const std::string & fileName );
+
+  const char *        m_Data;
+  std::size_t         m_Size;
+  bool                m_IsMapped;
+  std::vector< char > m_Buffer;
+
+  /** Platform specific handles. */
+  void * m_FileHandle;
+  void * m_MappingHandle;
+
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __itkMemoryMappedFile_h
@@ -0,0 +1,349 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkPersistentThreadPool_cxx
+#define __itkPersistentThreadPool_cxx
+
+#include "itkPersistentThreadPool.h"
+
+#if defined( ITK_USE_WIN32_THREADS )
+#include <process.h>
+#endif
+
+namespace itk
+{
+
+/**
+ * ********************* Constructor ****************************
+ */
+
+PersistentThreadPool
+::PersistentThreadPool()
+{
+  this->m_NumberOfThreads     = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  this->m_SingleMethod        = 0;
+  this->m_SingleData          = 0;
+  this->m_WorkersRunning      = false;
+  this->m_WorkAvailable       = ConditionVariable::New();
+  this->m_WorkDone            = ConditionVariable::New();
+  this->m_Generation          = 0;
+  this->m_NumberOfBusyWorkers = 0;
+  this->m_StopWorkers         = false;
+  this->m_ExceptionOccurred   = false;
+
+} // end Constructor
+
+
+/**
+ * ********************* Destructor ****************************
+ */
+
+PersistentThreadPool
+::~PersistentThreadPool()
+{
+  this->StopWorkerThreads();
+
+} // end Destructor
+
+
+/**
+ * ********************* SetNumberOfThreads ****************************
+ */
+
+void
+PersistentThreadPool
+::SetNumberOfThreads( ThreadIdType numberOfThreads )
+{
+  /** Clamp to the same range as the MultiThreader. */
+  if( numberOfThreads < 1 ) { numberOfThreads = 1; }
+  if( numberOfThreads > ITK_MAX_THREADS ) { numberOfThreads = ITK_MAX_THREADS; }
+
+  if( this->m_NumberOfThreads == numberOfThreads ) { return; }
+
+  /** The workers are restarted lazily in SingleMethodExecute(). */
+  this->StopWorkerThreads();
+  this->m_NumberOfThreads = numberOfThreads;
+  this->Modified();
+
+} // end SetNumberOfThreads()
+
+
+/**
+ * ********************* SetSingleMethod ****************************
+ */
+
+void
+PersistentThreadPool
+::SetSingleMethod( ThreadFunctionType f, void * data )
+{
+  this->m_SingleMethod = f;
+  this->m_SingleData   = data;
+
+} // end SetSingleMethod()
+
+
+/**
+ * ********************* StartWorkerThreads ****************************
+ */
+
+void
+PersistentThreadPool
+::StartWorkerThreads( void )
+{
+  if( this->m_WorkersRunning || this->m_NumberOfThreads < 2 ) { return; }
+
+  this->m_StopWorkers         = false;
+  this->m_NumberOfBusyWorkers = 0;
+
+  /** Thread 0 is the calling thread, so only NumberOfThreads - 1 workers
+   * are created. The vector is not resized afterwards, so the addresses
+   * passed to the threads stay valid.
+   */
+  this->m_Workers.resize( this->m_NumberOfThreads - 1 );
+  for( ThreadIdType i = 0; i < this->m_Workers.size(); ++i )
+  {
+    WorkerInfoType & worker = this->m_Workers[ i ];
+    worker.m_Pool     = this;
+    worker.m_ThreadID = i + 1;
+
+    /** The worker must only react to work posted after this point. Reading
+     * the generation inside the new thread would race with the posting.
+     */
+    worker.m_Generation = this->m_Generation;
+
+#if defined( ITK_USE_PTHREADS )
+    const int error = pthread_create( &worker.m_ProcessID, 0,
+      &Self::WorkerThreadLoop, &worker );
+    if( error != 0 )
+    {
+      this->m_Workers.resize( i );
+      this->m_WorkersRunning = true;
+      this->StopWorkerThreads();
+      itkExceptionMacro( << "Unable to create a worker thread, error code: " << error );
+    }
+#elif defined( ITK_USE_WIN32_THREADS )
+    worker.m_ProcessID = reinterpret_cast< ThreadProcessIdType >(
+      _beginthreadex( 0, 0, &Self::WorkerThreadLoop, &worker, 0, 0 ) );
+    if( worker.m_ProcessID == 0 )
+    {
+      this->m_Workers.resize( i );
+      this->m_WorkersRunning = true;
+      this->StopWorkerThreads();
+      itkExceptionMacro( << "Unable to create a worker thread." );
+    }
+#else
+    itkExceptionMacro( << "PersistentThreadPool requires pthreads or win32 threads." );
+#endif
+  }
+
+  this->m_WorkersRunning = true;
+
+} // end StartWorkerThreads()
+
+
+/**
+ * ********************* StopWorkerThreads ****************************
+ */
+
+void
+PersistentThreadPool
+::StopWorkerThreads( void )
+{
+  if( !this->m_WorkersRunning ) { return; }
+
+  /** Wake up all workers and let them leave their loop. */
+  this->m_Mutex.Lock();
+  this->m_StopWorkers = true;
+  this->m_WorkAvailable->Broadcast();
+  this->m_Mutex.Unlock();
+
+  /** Join them. */
+  for( ThreadIdType i = 0; i < this->m_Workers.size(); ++i )
+  {
+#if defined( ITK_USE_PTHREADS )
+    pthread_join( this->m_Workers[ i ].m_ProcessID, 0 );
+#elif defined( ITK_USE_WIN32_THREADS )
+    WaitForSingleObject( this->m_Workers[ i ].m_ProcessID, INFINITE );
+    CloseHandle( this->m_Workers[ i ].m_ProcessID );
+#endif
+  }
+
+  this->m_Workers.clear();
+  this->m_WorkersRunning = false;
+  this->m_StopWorkers    = false;
+
+} // end StopWorkerThreads()
+
+
+/**
+ * ********************* ExecuteSingleMethodForThread ****************************
+ */
+
+void
+PersistentThreadPool
+::ExecuteSingleMethodForThread( ThreadIdType threadID )
+{
+  ThreadInfoType info;
+  info.ThreadID        = threadID;
+  info.NumberOfThreads = this->m_NumberOfThreads;
+  info.ActiveFlag      = 0;
+  info.UserData        = this->m_SingleData;
+  info.ThreadFunction  = this->m_SingleMethod;
+
+  try
+  {
+    ( *this->m_SingleMethod )( &info );
+  }
+  catch( ExceptionObject & e )
+  {
+    this->m_Mutex.Lock();
+    this->m_ExceptionOccurred    = true;
+    this->m_ExceptionDescription = e.GetDescription();
+    this->m_Mutex.Unlock();
+  }
+  catch( std::exception & e )
+  {
+    this->m_Mutex.Lock();
+    this->m_ExceptionOccurred    = true;
+    this->m_ExceptionDescription = e.what();
+    this->m_Mutex.Unlock();
+  }
+  catch( ... )
+  {
+    this->m_Mutex.Lock();
+    this->m_ExceptionOccurred    = true;
+    this->m_ExceptionDescription = "Unknown exception";
+    this->m_Mutex.Unlock();
+  }
+
+} // end ExecuteSingleMethodForThread()
+
+
+/**
+ * ********************* WorkerThreadLoop ****************************
+ */
+
+ITK_THREAD_RETURN_TYPE
+PersistentThreadPool
+::WorkerThreadLoop( void * arg )
+{
+  WorkerInfoType *       worker = static_cast< WorkerInfoType * >( arg );
+  PersistentThreadPool * pool   = worker->m_Pool;
+
+  unsigned long generation = worker->m_Generation;
+  pool->m_Mutex.Lock();
+  while( true )
+  {
+    /** Sleep until new work is posted or the pool is stopped.
+     * The loop protects against spurious wake-ups.
+     */
+    while( generation == pool->m_Generation && !pool->m_StopWorkers )
+    {
+      pool->m_WorkAvailable->Wait( &pool->m_Mutex );
+    }
+    if( pool->m_StopWorkers ) { break; }
+    generation = pool->m_Generation;
+    pool->m_Mutex.Unlock();
+
+    /** Do the work. */
+    pool->ExecuteSingleMethodForThread( worker->m_ThreadID );
+
+    /** Report back; the last one wakes up the calling thread. */
+    pool->m_Mutex.Lock();
+    --pool->m_NumberOfBusyWorkers;
+    if( pool->m_NumberOfBusyWorkers == 0 )
+    {
+      pool->m_WorkDone->Signal();
+    }
+  }
+  pool->m_Mutex.Unlock();
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end WorkerThreadLoop()
+
+
+/**
+ * ********************* SingleMethodExecute ****************************
+ */
+
+void
+PersistentThreadPool
+::SingleMethodExecute( void )
+{
+  if( !this->m_SingleMethod )
+  {
+    itkExceptionMacro( << "No single method set!" );
+  }
+
+  this->m_ExceptionOccurred = false;
+
+  /** Post the work to the workers. */
+  if( this->m_NumberOfThreads > 1 )
+  {
+    this->StartWorkerThreads();
+
+    this->m_Mutex.Lock();
+    this->m_NumberOfBusyWorkers = this->m_NumberOfThreads - 1;
+    ++this->m_Generation;
+    this->m_WorkAvailable->Broadcast();
+    this->m_Mutex.Unlock();
+  }
+
+  /** The calling thread is thread 0. */
+  this->ExecuteSingleMethodForThread( 0 );
+
+  /** Barrier: wait for all workers to finish. */
+  if( this->m_NumberOfThreads > 1 )
+  {
+    this->m_Mutex.Lock();
+    while( this->m_NumberOfBusyWorkers > 0 )
+    {
+      this->m_WorkDone->Wait( &this->m_Mutex );
+    }
+    this->m_Mutex.Unlock();
+  }
+
+  if( this->m_ExceptionOccurred )
+  {
+    itkExceptionMacro( << "Exception occurred during SingleMethodExecute\n"
+                       << this->m_ExceptionDescription );
+  }
+
+} // end SingleMethodExecute()
+
+
+/**
+ * ********************* PrintSelf ****************************
+ */
+
+void
+PersistentThreadPool
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "NumberOfThreads: " << this->m_NumberOfThreads << std::endl;
+  os << indent << "WorkersRunning: " << this->m_WorkersRunning << std::endl;
+  os << indent << "Generation: " << this->m_Generation << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkPersistentThreadPool_cxx
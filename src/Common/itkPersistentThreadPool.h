@@ -0,0 +1,155 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkPersistentThreadPool_h
+#define __itkPersistentThreadPool_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleMutexLock.h"
+#include "itkConditionVariable.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class PersistentThreadPool
+ *
+ * \brief A barrier-synchronized pool of worker threads that stay alive
+ * between calls.
+ *
+ * The interface mimics the SingleMethod part of the itk::MultiThreader:
+ * a callback is set with SetSingleMethod() and executed by all threads
+ * with SingleMethodExecute(). The callback receives a
+ * MultiThreader::ThreadInfoStruct with the ThreadID, NumberOfThreads and
+ * UserData filled in, so existing threader callbacks can be dispatched
+ * to this pool without modification.
+ *
+ * Contrary to the MultiThreader, the threads are created only once, at
+ * the first call to SingleMethodExecute() after a change of the number of
+ * threads, and are put to sleep in between calls. The calling thread
+ * acts as thread 0. This avoids the creation and joining of
+ * NumberOfThreads-1 OS threads for every call, which is significant when
+ * the callback is executed thousands of times with a small amount of work,
+ * such as during the optimization of a registration.
+ *
+ * SingleMethodExecute() is not re-entrant: a pool should not be used by
+ * multiple threads simultaneously.
+ *
+ * \ingroup ITKSystemObjects
+ */
+
+class PersistentThreadPool : public Object
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef PersistentThreadPool       Self;
+  typedef Object                     Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( PersistentThreadPool, Object );
+
+  /** Typedefs. */
+  typedef MultiThreader::ThreadInfoStruct ThreadInfoType;
+
+  /** Set/Get the number of threads, including the calling thread.
+   * Changing the number of threads stops the current workers; new
+   * workers are started lazily in SingleMethodExecute().
+   */
+  virtual void SetNumberOfThreads( ThreadIdType numberOfThreads );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
+  /** Set the method and the user data that is executed by all threads. */
+  virtual void SetSingleMethod( ThreadFunctionType f, void * data );
+
+  /** Execute the single method on all threads, and wait until all
+   * threads are finished. Exceptions thrown in any of the threads are
+   * rethrown in the calling thread.
+   */
+  virtual void SingleMethodExecute( void );
+
+  /** Stop and join all worker threads. Called by the destructor. */
+  virtual void StopWorkerThreads( void );
+
+protected:
+
+  PersistentThreadPool();
+  virtual ~PersistentThreadPool();
+
+  /** PrintSelf. */
+  virtual void PrintSelf( std::ostream & os, Indent indent ) const;
+
+private:
+
+  PersistentThreadPool( const Self & ); // purposely not implemented
+  void operator=( const Self & );       // purposely not implemented
+
+  /** Per worker data, passed to the worker main loop. */
+  struct WorkerInfoType
+  {
+    PersistentThreadPool * m_Pool;
+    ThreadIdType           m_ThreadID;
+    ThreadProcessIdType    m_ProcessID;
+    unsigned long          m_Generation;
+  };
+
+  /** Create the worker threads 1 ... NumberOfThreads-1. */
+  void StartWorkerThreads( void );
+
+  /** Execute the single method for one thread, catching any exception. */
+  void ExecuteSingleMethodForThread( ThreadIdType threadID );
+
+  /** The main loop of the worker threads: sleep until a new generation
+   * of work is posted, execute it, and report back.
+   */
+  static ITK_THREAD_RETURN_TYPE WorkerThreadLoop( void * arg );
+
+  /** Member variables. */
+  ThreadIdType       m_NumberOfThreads;
+  ThreadFunctionType m_SingleMethod;
+  void *             m_SingleData;
+
+  std::vector< WorkerInfoType > m_Workers;
+  bool                          m_WorkersRunning;
+
+  /** Synchronization. m_Generation is increased every time work is posted,
+   * m_NumberOfBusyWorkers counts down to zero when the work is done.
+   */
+  SimpleMutexLock            m_Mutex;
+  ConditionVariable::Pointer m_WorkAvailable;
+  ConditionVariable::Pointer m_WorkDone;
+  unsigned long              m_Generation;
+  ThreadIdType               m_NumberOfBusyWorkers;
+  bool                       m_StopWorkers;
+
+  /** Exception handling. */
+  bool        m_ExceptionOccurred;
+  std::string m_ExceptionDescription;
+
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __itkPersistentThreadPool_h
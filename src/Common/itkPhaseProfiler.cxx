@@ -0,0 +1,313 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkPhaseProfiler_cxx
+#define __itkPhaseProfiler_cxx
+
+#include "itkPhaseProfiler.h"
+#include "itkRealTimeClock.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkMutexLockHolder.h"
+
+#include <map>
+#include <iomanip>
+
+namespace itk
+{
+
+bool PhaseProfiler::m_Enabled = false;
+
+namespace
+{
+
+/** The global state of the profiler. It is created on first use, to
+ * avoid depending on the order of static initialization.
+ */
+struct PhaseProfilerState
+{
+  typedef std::pair< SizeValueType, double > RunningPhaseType;
+
+  RealTimeClock::Pointer                      m_Clock;
+  SimpleFastMutexLock                         m_Mutex;
+  PhaseProfiler::PhaseStatisticsContainerType m_Phases;
+  std::map< std::string, SizeValueType >      m_PhaseIndices;
+  std::vector< RunningPhaseType >             m_RunningPhases;
+
+  PhaseProfilerState() { this->m_Clock = RealTimeClock::New(); }
+};
+
+PhaseProfilerState &
+GetPhaseProfilerState( void )
+{
+  static PhaseProfilerState state;
+  return state;
+}
+
+
+/** Write a time in seconds as milliseconds. */
+double
+ToMilliseconds( double seconds )
+{
+  return seconds * 1000.0;
+}
+
+
+} // end anonymous namespace
+
+/**
+ * ********************* SetEnabled ****************************
+ */
+
+void
+PhaseProfiler
+::SetEnabled( bool enabled )
+{
+  PhaseProfilerState &                   state = GetPhaseProfilerState();
+  MutexLockHolder< SimpleFastMutexLock > lock( state.m_Mutex );
+  state.m_RunningPhases.clear();
+  m_Enabled = enabled;
+
+} // end SetEnabled()
+
+
+/**
+ * ********************* GetChildPhase ****************************
+ */
+
+SizeValueType
+PhaseProfiler
+::GetChildPhase( const char * name )
+{
+  PhaseProfilerState & state = GetPhaseProfilerState();
+
+  /** The path of the child is the path of the running phase plus the name. */
+  std::string  path  = name;
+  unsigned int depth = 0;
+  if( !state.m_RunningPhases.empty() )
+  {
+    const PhaseStatisticsType & parent
+      = state.m_Phases[ state.m_RunningPhases.back().first ];
+    path  = parent.m_Path + "/" + name;
+    depth = parent.m_Depth + 1;
+  }
+
+  std::map< std::string, SizeValueType >::const_iterator it
+    = state.m_PhaseIndices.find( path );
+  if( it != state.m_PhaseIndices.end() )
+  {
+    return it->second;
+  }
+
+  /** First call of this phase. */
+  PhaseStatisticsType phase;
+  phase.m_Path          = path;
+  phase.m_Name          = name;
+  phase.m_Depth         = depth;
+  phase.m_NumberOfCalls = 0;
+  phase.m_TotalTime     = 0.0;
+  phase.m_MinimumTime   = 0.0;
+  phase.m_MaximumTime   = 0.0;
+  state.m_Phases.push_back( phase );
+  state.m_PhaseIndices[ path ] = state.m_Phases.size() - 1;
+  return state.m_Phases.size() - 1;
+
+} // end GetChildPhase()
+
+
+/**
+ * ********************* StartPhase ****************************
+ */
+
+void
+PhaseProfiler
+::StartPhase( const char * name )
+{
+  PhaseProfilerState &                   state = GetPhaseProfilerState();
+  MutexLockHolder< SimpleFastMutexLock > lock( state.m_Mutex );
+
+  const SizeValueType index = GetChildPhase( name );
+  state.m_RunningPhases.push_back( PhaseProfilerState::RunningPhaseType(
+    index, state.m_Clock->GetTimeInSeconds() ) );
+
+} // end StartPhase()
+
+
+/**
+ * ********************* StopPhase ****************************
+ */
+
+void
+PhaseProfiler
+::StopPhase( void )
+{
+  PhaseProfilerState &                   state = GetPhaseProfilerState();
+  MutexLockHolder< SimpleFastMutexLock > lock( state.m_Mutex );
+
+  /** The profiler may have been reset while the phase was running. */
+  if( state.m_RunningPhases.empty() )
+  {
+    return;
+  }
+
+  const double elapsed = state.m_Clock->GetTimeInSeconds()
+    - state.m_RunningPhases.back().second;
+  PhaseStatisticsType & phase = state.m_Phases[ state.m_RunningPhases.back().first ];
+  state.m_RunningPhases.pop_back();
+
+  if( phase.m_NumberOfCalls == 0 || elapsed < phase.m_MinimumTime )
+  {
+    phase.m_MinimumTime = elapsed;
+  }
+  if( phase.m_NumberOfCalls == 0 || elapsed > phase.m_MaximumTime )
+  {
+    phase.m_MaximumTime = elapsed;
+  }
+  phase.m_TotalTime += elapsed;
+  ++phase.m_NumberOfCalls;
+
+} // end StopPhase()
+
+
+/**
+ * ********************* AddPhaseTime ****************************
+ */
+
+void
+PhaseProfiler
+::AddPhaseTime( const char * name, double seconds )
+{
+  if( !m_Enabled )
+  {
+    return;
+  }
+
+  PhaseProfilerState &                   state = GetPhaseProfilerState();
+  MutexLockHolder< SimpleFastMutexLock > lock( state.m_Mutex );
+
+  PhaseStatisticsType & phase = state.m_Phases[ GetChildPhase( name ) ];
+  if( phase.m_NumberOfCalls == 0 || seconds < phase.m_MinimumTime )
+  {
+    phase.m_MinimumTime = seconds;
+  }
+  if( phase.m_NumberOfCalls == 0 || seconds > phase.m_MaximumTime )
+  {
+    phase.m_MaximumTime = seconds;
+  }
+  phase.m_TotalTime += seconds;
+  ++phase.m_NumberOfCalls;
+
+} // end AddPhaseTime()
+
+
+/**
+ * ********************* Reset ****************************
+ */
+
+void
+PhaseProfiler
+::Reset( void )
+{
+  PhaseProfilerState &                   state = GetPhaseProfilerState();
+  MutexLockHolder< SimpleFastMutexLock > lock( state.m_Mutex );
+  state.m_Phases.clear();
+  state.m_PhaseIndices.clear();
+  state.m_RunningPhases.clear();
+
+} // end Reset()
+
+
+/**
+ * ********************* GetPhaseStatistics ****************************
+ */
+
+PhaseProfiler::PhaseStatisticsContainerType
+PhaseProfiler
+::GetPhaseStatistics( void )
+{
+  PhaseProfilerState &                   state = GetPhaseProfilerState();
+  MutexLockHolder< SimpleFastMutexLock > lock( state.m_Mutex );
+  return state.m_Phases;
+
+} // end GetPhaseStatistics()
+
+
+/**
+ * ********************* WriteJSON ****************************
+ */
+
+void
+PhaseProfiler
+::WriteJSON( std::ostream & os )
+{
+  const PhaseStatisticsContainerType phases = GetPhaseStatistics();
+
+  /** Phase names are identifiers, so they need no escaping. */
+  os << std::setprecision( 6 ) << std::fixed;
+  os << "{\n  \"phases\": [";
+  for( SizeValueType i = 0; i < phases.size(); ++i )
+  {
+    const PhaseStatisticsType & phase = phases[ i ];
+    const double                mean  = phase.m_NumberOfCalls > 0
+      ? phase.m_TotalTime / phase.m_NumberOfCalls : 0.0;
+    os << ( i == 0 ? "\n" : ",\n" )
+       << "    { \"path\": \"" << phase.m_Path << "\""
+       << ", \"name\": \"" << phase.m_Name << "\""
+       << ", \"depth\": " << phase.m_Depth
+       << ", \"calls\": " << phase.m_NumberOfCalls
+       << ", \"total_ms\": " << ToMilliseconds( phase.m_TotalTime )
+       << ", \"mean_ms\": " << ToMilliseconds( mean )
+       << ", \"min_ms\": " << ToMilliseconds( phase.m_MinimumTime )
+       << ", \"max_ms\": " << ToMilliseconds( phase.m_MaximumTime )
+       << " }";
+  }
+  os << "\n  ]\n}\n";
+
+} // end WriteJSON()
+
+
+/**
+ * ********************* WriteCSV ****************************
+ */
+
+void
+PhaseProfiler
+::WriteCSV( std::ostream & os )
+{
+  const PhaseStatisticsContainerType phases = GetPhaseStatistics();
+
+  os << std::setprecision( 6 ) << std::fixed;
+  os << "path,depth,calls,total_ms,mean_ms,min_ms,max_ms\n";
+  for( SizeValueType i = 0; i < phases.size(); ++i )
+  {
+    const PhaseStatisticsType & phase = phases[ i ];
+    const double                mean  = phase.m_NumberOfCalls > 0
+      ? phase.m_TotalTime / phase.m_NumberOfCalls : 0.0;
+    os << phase.m_Path << ","
+       << phase.m_Depth << ","
+       << phase.m_NumberOfCalls << ","
+       << ToMilliseconds( phase.m_TotalTime ) << ","
+       << ToMilliseconds( mean ) << ","
+       << ToMilliseconds( phase.m_MinimumTime ) << ","
+       << ToMilliseconds( phase.m_MaximumTime ) << "\n";
+  }
+
+} // end WriteCSV()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkPhaseProfiler_cxx
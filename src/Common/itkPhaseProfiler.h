@@ -0,0 +1,153 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkPhaseProfiler_h
+#define __itkPhaseProfiler_h
+
+#include "itkIntTypes.h"
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace itk
+{
+
+/** \class PhaseProfiler
+ *
+ * \brief A global, hierarchical profiler of the phases of a registration.
+ *
+ * Phases are timed with a ScopedProbe, which starts a phase in its
+ * constructor and stops it in its destructor:
+ *
+ * \code
+ *   PhaseProfiler::ScopedProbe probe( "ImageSampler" );
+ * \endcode
+ *
+ * Phases that are started while another phase is running are recorded
+ * as its children, so that the phase "ImageSampler" started from within
+ * "BeforeThreadedGetValueAndDerivative" is recorded with the path
+ * "GetValueAndDerivative/BeforeThreadedGetValueAndDerivative/ImageSampler".
+ * Per path, the number of calls and the total, minimum and maximum time
+ * are accumulated, and can be written as JSON or CSV.
+ *
+ * The probes are compiled in, but the profiler is disabled by default.
+ * A disabled probe only tests a global flag, so probes can stay in the
+ * per-iteration code paths. The profiler keeps a single stack of running
+ * phases, so probes should only be placed in code that runs in the main
+ * thread, not in threader callbacks.
+ *
+ * \ingroup ITKSystemObjects
+ */
+
+class PhaseProfiler
+{
+public:
+
+  /** The accumulated statistics of one phase. */
+  struct PhaseStatisticsType
+  {
+    std::string   m_Path;
+    std::string   m_Name;
+    unsigned int  m_Depth;
+    SizeValueType m_NumberOfCalls;
+    double        m_TotalTime;
+    double        m_MinimumTime;
+    double        m_MaximumTime;
+  };
+
+  typedef std::vector< PhaseStatisticsType > PhaseStatisticsContainerType;
+
+  /** Enable or disable the profiler. Disabling clears the running phases. */
+  static void SetEnabled( bool enabled );
+
+  static bool GetEnabled( void ) { return m_Enabled; }
+
+  /** Start a phase, as child of the currently running phase. */
+  static void StartPhase( const char * name );
+
+  /** Stop the most recently started phase. */
+  static void StopPhase( void );
+
+  /** Add a time in seconds, measured elsewhere, to a child phase of the
+   * currently running phase.
+   */
+  static void AddPhaseTime( const char * name, double seconds );
+
+  /** Clear all statistics, for example at the start of a resolution. */
+  static void Reset( void );
+
+  /** Get the statistics of all phases, in the order of their first call. */
+  static PhaseStatisticsContainerType GetPhaseStatistics( void );
+
+  /** Write the statistics as a JSON object or as CSV with a header line.
+   * All times are written in milliseconds.
+   */
+  static void WriteJSON( std::ostream & os );
+
+  static void WriteCSV( std::ostream & os );
+
+  /** \class ScopedProbe
+   * \brief Times a phase during the lifetime of the probe.
+   */
+  class ScopedProbe
+  {
+public:
+
+    ScopedProbe( const char * name ) : m_Active( PhaseProfiler::GetEnabled() )
+    {
+      if( this->m_Active ) { PhaseProfiler::StartPhase( name ); }
+    }
+
+
+    ~ScopedProbe()
+    {
+      this->Stop();
+    }
+
+
+    /** Stop the phase before the end of the scope. */
+    void Stop( void )
+    {
+      if( this->m_Active ) { PhaseProfiler::StopPhase(); }
+      this->m_Active = false;
+    }
+
+
+private:
+
+    ScopedProbe( const ScopedProbe & ); // purposely not implemented
+    void operator=( const ScopedProbe & ); // purposely not implemented
+
+    bool m_Active;
+  };
+
+private:
+
+  PhaseProfiler();                        // purposely not implemented
+  PhaseProfiler( const PhaseProfiler & ); // purposely not implemented
+  void operator=( const PhaseProfiler & ); // purposely not implemented
+
+  /** Find or create the phase with the given name below the running phase. */
+  static SizeValueType GetChildPhase( const char * name );
+
+  static bool m_Enabled;
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __itkPhaseProfiler_h
@@ -0,0 +1,102 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkRayCastResampleImageFilter_h
+#define __itkRayCastResampleImageFilter_h
+
+#include "itkResampleImageFilter.h"
+#include "itkAdvancedRayCastInterpolateImageFunction.h"
+
+namespace itk
+{
+
+/** \class RayCastResampleImageFilter
+ * \brief Renders digitally reconstructed radiographs with packets of rays.
+ *
+ * This filter is a ResampleImageFilter with a fast path for the
+ * AdvancedRayCastInterpolateImageFunction. If the interpolator is a ray
+ * caster, each thread transforms the points of a line of its part of the
+ * output image, and casts all rays of the line with a single call to
+ * AdvancedRayCastInterpolateImageFunction::EvaluateRays(), which
+ * integrates the rays in packets. For other interpolators the filter
+ * behaves as the ResampleImageFilter.
+ *
+ * As in the ResampleImageFilter, each output point is mapped by the
+ * transform before the ray through it is cast, so the output is that of
+ * the ResampleImageFilter up to rounding.
+ *
+ * \ingroup GeometricTransforms
+ */
+
+template< class TInputImage, class TOutputImage, class TInterpolatorPrecisionType = double >
+class RayCastResampleImageFilter :
+  public ResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef RayCastResampleImageFilter Self;
+  typedef ResampleImageFilter<
+    TInputImage, TOutputImage, TInterpolatorPrecisionType > Superclass;
+  typedef SmartPointer< Self >       Pointer;
+  typedef SmartPointer< const Self > ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( RayCastResampleImageFilter, ResampleImageFilter );
+
+  /** Typedefs from Superclass. */
+  typedef typename Superclass::InputImageType        InputImageType;
+  typedef typename Superclass::OutputImageType       OutputImageType;
+  typedef typename Superclass::TransformType         TransformType;
+  typedef typename Superclass::InterpolatorType      InterpolatorType;
+  typedef typename Superclass::PixelType             PixelType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+
+  /** Typedefs for the ray caster. */
+  typedef AdvancedRayCastInterpolateImageFunction<
+    InputImageType, TInterpolatorPrecisionType >        RayCastInterpolatorType;
+  typedef typename RayCastInterpolatorType::PointType  RayCastPointType;
+  typedef typename RayCastInterpolatorType::OutputType RayCastOutputType;
+
+protected:
+
+  /** The constructor. */
+  RayCastResampleImageFilter() {}
+  /** The destructor. */
+  virtual ~RayCastResampleImageFilter() {}
+
+  /** Render a part of the output image. */
+  virtual void ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+    ThreadIdType threadId );
+
+private:
+
+  RayCastResampleImageFilter( const Self & ); // purposely not implemented
+  void operator=( const Self & );             // purposely not implemented
+
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkRayCastResampleImageFilter.hxx"
+#endif
+
+#endif // end #ifndef __itkRayCastResampleImageFilter_h
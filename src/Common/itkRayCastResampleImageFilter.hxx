@@ -0,0 +1,111 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkRayCastResampleImageFilter_hxx
+#define __itkRayCastResampleImageFilter_hxx
+
+#include "itkRayCastResampleImageFilter.h"
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+#include "itkNumericTraits.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template< class TInputImage, class TOutputImage, class TInterpolatorPrecisionType >
+void
+RayCastResampleImageFilter< TInputImage, TOutputImage, TInterpolatorPrecisionType >
+::ThreadedGenerateData( const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType threadId )
+{
+  /** Use the default implementation for other interpolators. */
+  const RayCastInterpolatorType * rayCaster
+    = dynamic_cast< const RayCastInterpolatorType * >( this->GetInterpolator() );
+  if( rayCaster == 0 )
+  {
+    this->Superclass::ThreadedGenerateData( outputRegionForThread, threadId );
+    return;
+  }
+
+  OutputImageType *     outputPtr = this->GetOutput();
+  const TransformType * transform = this->GetTransform();
+
+  /** Support for progress methods/callbacks. */
+  ProgressReporter progress( this, threadId,
+    outputRegionForThread.GetNumberOfPixels() );
+
+  /** The range of the output pixel type. */
+  const RayCastOutputType minValue
+    = static_cast< RayCastOutputType >( NumericTraits< PixelType >::NonpositiveMin() );
+  const RayCastOutputType maxValue
+    = static_cast< RayCastOutputType >( NumericTraits< PixelType >::max() );
+
+  /** Cast the rays of one line of the output image at a time. */
+  const unsigned int lineLength = outputRegionForThread.GetSize( 0 );
+  std::vector< RayCastPointType >  points( lineLength );
+  std::vector< RayCastOutputType > values( lineLength );
+
+  typedef ImageLinearIteratorWithIndex< OutputImageType > OutputIteratorType;
+  typename TransformType::InputPointType outputPoint;
+  OutputIteratorType                     outIt( outputPtr, outputRegionForThread );
+  outIt.SetDirection( 0 );
+  outIt.GoToBegin();
+  while( !outIt.IsAtEnd() )
+  {
+    /** Map the points of the line to the input space. */
+    for( unsigned int i = 0; i < lineLength; ++i, ++outIt )
+    {
+      outputPtr->TransformIndexToPhysicalPoint( outIt.GetIndex(), outputPoint );
+      points[ i ].CastFrom( transform->TransformPoint( outputPoint ) );
+    }
+
+    rayCaster->EvaluateRays( &points[ 0 ], lineLength, &values[ 0 ] );
+
+    /** Write the line, clamped to the range of the pixel type. */
+    outIt.GoToBeginOfLine();
+    for( unsigned int i = 0; i < lineLength; ++i, ++outIt )
+    {
+      const RayCastOutputType value = values[ i ];
+      if( value <= minValue )
+      {
+        outIt.Set( NumericTraits< PixelType >::NonpositiveMin() );
+      }
+      else if( value >= maxValue )
+      {
+        outIt.Set( NumericTraits< PixelType >::max() );
+      }
+      else
+      {
+        outIt.Set( static_cast< PixelType >( value ) );
+      }
+      progress.CompletedPixel();
+    }
+    outIt.NextLine();
+  }
+
+} // end ThreadedGenerateData()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkRayCastResampleImageFilter_hxx
@@ -0,0 +1,107 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkRayPacketStepKernel_h
+#define __itkRayPacketStepKernel_h
+
+#include "itkMacro.h"
+
+/** Select the instruction set at compile time, as in the
+ * CubicBSplineTransformPointKernel.
+ */
+#if defined( __AVX__ )
+#define ELX_RAY_PACKET_KERNEL_USE_AVX
+#include <immintrin.h>
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define ELX_RAY_PACKET_KERNEL_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace itk
+{
+
+/** \class RayPacketStepKernel
+ *
+ * \brief Steps a packet of rays to their next plane of voxels, for
+ * AdvancedRayCastInterpolateImageFunction::EvaluateRays().
+ *
+ * The positions of the rays, in voxel coordinates, are stored per
+ * component: position[ i ][ lane ]. Step() adds the increments to the
+ * positions, and returns per component the change of the truncated
+ * position, from which the caller updates the voxel offsets of the rays.
+ *
+ * The positions are stepped four (AVX) or two (SSE2) rays at a time, when
+ * the compiler targets these instruction sets, and with scalar code
+ * otherwise. The vector code only adds and truncates, so the positions and
+ * the voxel steps are exactly those of the scalar code.
+ *
+ * NumberOfLanes must be a multiple of four. All lanes are stepped, so the
+ * unused lanes of a packet should hold finite values.
+ *
+ * \ingroup ImageFunctions
+ */
+
+template< unsigned int NumberOfLanes >
+class RayPacketStepKernel
+{
+public:
+
+  /** Add increment to position, and store the change of the truncated
+   * position in step.
+   */
+  static void Step( double position[ 3 ][ NumberOfLanes ],
+    const double increment[ 3 ][ NumberOfLanes ],
+    int step[ 3 ][ NumberOfLanes ] )
+  {
+    for( unsigned int i = 0; i < 3; ++i )
+    {
+#if defined( ELX_RAY_PACKET_KERNEL_USE_AVX )
+      for( unsigned int lane = 0; lane < NumberOfLanes; lane += 4 )
+      {
+        const __m256d before = _mm256_loadu_pd( position[ i ] + lane );
+        const __m256d after  = _mm256_add_pd( before, _mm256_loadu_pd( increment[ i ] + lane ) );
+        _mm256_storeu_pd( position[ i ] + lane, after );
+        const __m128i delta = _mm_sub_epi32(
+          _mm256_cvttpd_epi32( after ), _mm256_cvttpd_epi32( before ) );
+        _mm_storeu_si128( reinterpret_cast< __m128i * >( step[ i ] + lane ), delta );
+      }
+#elif defined( ELX_RAY_PACKET_KERNEL_USE_SSE2 )
+      for( unsigned int lane = 0; lane < NumberOfLanes; lane += 2 )
+      {
+        const __m128d before = _mm_loadu_pd( position[ i ] + lane );
+        const __m128d after  = _mm_add_pd( before, _mm_loadu_pd( increment[ i ] + lane ) );
+        _mm_storeu_pd( position[ i ] + lane, after );
+        const __m128i delta = _mm_sub_epi32(
+          _mm_cvttpd_epi32( after ), _mm_cvttpd_epi32( before ) );
+        _mm_storel_epi64( reinterpret_cast< __m128i * >( step[ i ] + lane ), delta );
+      }
+#else
+      for( unsigned int lane = 0; lane < NumberOfLanes; ++lane )
+      {
+        const double before = position[ i ][ lane ];
+        position[ i ][ lane ] += increment[ i ][ lane ];
+        step[ i ][ lane ] = static_cast< int >( position[ i ][ lane ] ) - static_cast< int >( before );
+      }
+#endif
+    }
+  }
+
+};
+
+} // end namespace itk
+
+#endif // end #ifndef __itkRayPacketStepKernel_h
@@ -140,6 +140,23 @@ ScaledSingleValuedNonLinearOptimizer
 } // end GetScaledValueAndDerivative()
 
 
+/**
+ * ********************* GetScaledValueAndSparseDerivative ***********************
+ */
+
+void
+ScaledSingleValuedNonLinearOptimizer
+::GetScaledValueAndSparseDerivative(
+  const ParametersType & parameters,
+  MeasureType & value,
+  SparseDerivativeType & derivative ) const
+{
+  this->m_ScaledCostFunction->
+  GetValueAndSparseDerivative( parameters, value, derivative );
+
+} // end GetScaledValueAndSparseDerivative()
+
+
 /**
  * ********************* GetCurrentPosition ***********************
  */
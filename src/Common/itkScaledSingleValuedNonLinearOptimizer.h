@@ -84,8 +84,9 @@ public:
   typedef Superclass::CostFunctionType CostFunctionType;
 
   typedef NonLinearOptimizer::ScalesType  ScalesType;
-  typedef ScaledSingleValuedCostFunction  ScaledCostFunctionType;
-  typedef ScaledCostFunctionType::Pointer ScaledCostFunctionPointer;
+  typedef ScaledSingleValuedCostFunction               ScaledCostFunctionType;
+  typedef ScaledCostFunctionType::Pointer              ScaledCostFunctionPointer;
+  typedef ScaledCostFunctionType::SparseDerivativeType SparseDerivativeType;
 
   /** Configure the scaled cost function. This function
    * sets the current scales in the ScaledCostFunction.
@@ -176,6 +177,14 @@ protected:
     MeasureType & value,
     DerivativeType & derivative ) const;
 
+  /** Same procedure as GetScaledValueAndDerivative, but with a sparse
+   * derivative. Only call this if the scaled cost function supports it.
+   */
+  virtual void GetScaledValueAndSparseDerivative(
+    const ParametersType & parameters,
+    MeasureType & value,
+    SparseDerivativeType & derivative ) const;
+
 private:
 
   /** The private constructor. */
@@ -0,0 +1,193 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkTransformixPointTransformer_h
+#define __itkTransformixPointTransformer_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkNumericTraits.h"
+#include "itkVector.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace itk
+{
+
+/** \class TransformixPointTransformer
+ *
+ * \brief Transforms a set of points and writes them in the format of the
+ * transformix outputpoints.txt file, using multiple threads.
+ *
+ * The input consists of the input points in world coordinates, and their
+ * indices in the fixed image. TransformPoints() maps the points with the
+ * batched TransformPoints() of the transform, and computes the indices of
+ * the results in the fixed image and, if set, the moving image. The points
+ * are divided in chunks of ChunkSize points, which the threads claim one
+ * by one, so that the load remains balanced.
+ *
+ * WriteOutputPoints() formats the results in blocks of points. Within a
+ * block the threads format the chunks into separate strings, which are
+ * then written to the stream in order, without flushing per line. The
+ * output is identical to that of a serial implementation.
+ *
+ * \ingroup Transforms
+ */
+
+template< class TTransform, class TFixedImage, class TMovingImage >
+class TransformixPointTransformer : public Object
+{
+public:
+
+  /** Standard class typedefs. */
+  typedef TransformixPointTransformer Self;
+  typedef Object                      Superclass;
+  typedef SmartPointer< Self >        Pointer;
+  typedef SmartPointer< const Self >  ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro( Self );
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro( TransformixPointTransformer, Object );
+
+  /** Dimensions. */
+  itkStaticConstMacro( FixedImageDimension, unsigned int, TFixedImage::ImageDimension );
+  itkStaticConstMacro( MovingImageDimension, unsigned int, TMovingImage::ImageDimension );
+
+  /** Typedefs. */
+  typedef TTransform                                  TransformType;
+  typedef typename TransformType::InputPointType      InputPointType;
+  typedef typename TransformType::OutputPointType     OutputPointType;
+  typedef TFixedImage                                 FixedImageType;
+  typedef typename FixedImageType::IndexType          FixedImageIndexType;
+  typedef TMovingImage                                MovingImageType;
+  typedef typename MovingImageType::IndexType         MovingImageIndexType;
+  typedef Vector< float, FixedImageDimension >        DeformationVectorType;
+  typedef MultiThreader                               ThreaderType;
+  typedef ThreaderType::ThreadInfoStruct              ThreadInfoType;
+
+  /** Set/Get the transform. */
+  itkSetConstObjectMacro( Transform, TransformType );
+  itkGetConstObjectMacro( Transform, TransformType );
+
+  /** Set/Get the image that defines the fixed image domain. */
+  itkSetConstObjectMacro( FixedImage, FixedImageType );
+  itkGetConstObjectMacro( FixedImage, FixedImageType );
+
+  /** Set/Get the moving image. Optional; if set, the output indices in the
+   * moving image are computed and written too.
+   */
+  itkSetConstObjectMacro( MovingImage, MovingImageType );
+  itkGetConstObjectMacro( MovingImage, MovingImageType );
+
+  /** Set/Get the number of threads. Default: the global default. */
+  itkSetClampMacro( NumberOfThreads, ThreadIdType, 1, ITK_MAX_THREADS );
+  itkGetConstMacro( NumberOfThreads, ThreadIdType );
+
+  /** Set/Get the number of points per chunk. Default: 1024. */
+  itkSetClampMacro( ChunkSize, SizeValueType, 1, NumericTraits< SizeValueType >::max() );
+  itkGetConstMacro( ChunkSize, SizeValueType );
+
+  /** Set the input points and their indices in the fixed image. The
+   * vectors are not copied, so they should exist until the output is written.
+   */
+  virtual void SetInput(
+    const std::vector< InputPointType > & inputPoints,
+    const std::vector< FixedImageIndexType > & inputIndices );
+
+  /** Transform the input points. */
+  virtual void TransformPoints( void );
+
+  /** Write the results of TransformPoints() in the outputpoints.txt format. */
+  virtual void WriteOutputPoints( std::ostream & output );
+
+  /** Get the transformed points. */
+  const std::vector< OutputPointType > & GetOutputPoints( void ) const
+  {
+    return this->m_OutputPoints;
+  }
+
+
+protected:
+
+  TransformixPointTransformer();
+  virtual ~TransformixPointTransformer() {}
+
+  /** PrintSelf. */
+  void PrintSelf( std::ostream & os, Indent indent ) const;
+
+  /** The threaded parts. */
+  typedef enum { TransformPhase, FormatPhase } PhaseType;
+
+  /** Claim the next chunk [begin, end) of the current range. */
+  bool GetNextChunk( SizeValueType & begin, SizeValueType & end );
+
+  /** Transform the points in [begin, end). */
+  void ThreadedTransformPoints( SizeValueType begin, SizeValueType end );
+
+  /** Format the points in [begin, end) into a string. */
+  void ThreadedFormatPoints( SizeValueType begin, SizeValueType end,
+    std::string & formatted ) const;
+
+  /** Execute the current phase on the range [begin, end) with all threads. */
+  void ExecuteThreaded( PhaseType phase, SizeValueType begin, SizeValueType end );
+
+  /** The callback that is executed by all threads. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+
+private:
+
+  TransformixPointTransformer( const Self & ); // purposely not implemented
+  void operator=( const Self & );              // purposely not implemented
+
+  typename TransformType::ConstPointer   m_Transform;
+  typename FixedImageType::ConstPointer  m_FixedImage;
+  typename MovingImageType::ConstPointer m_MovingImage;
+  ThreadIdType                           m_NumberOfThreads;
+  SizeValueType                          m_ChunkSize;
+
+  const std::vector< InputPointType > *      m_InputPoints;
+  const std::vector< FixedImageIndexType > * m_InputIndices;
+  std::vector< OutputPointType >             m_OutputPoints;
+  std::vector< FixedImageIndexType >         m_OutputIndicesFixed;
+  std::vector< MovingImageIndexType >        m_OutputIndicesMoving;
+
+  /** The state of the threaded phases. */
+  ThreaderType::Pointer      m_Threader;
+  PhaseType                  m_Phase;
+  SizeValueType              m_RangeBegin;
+  SizeValueType              m_NextChunkBegin;
+  SizeValueType              m_RangeEnd;
+  SimpleFastMutexLock        m_ChunkMutex;
+  std::vector< std::string > m_FormattedChunks;
+  bool                       m_ExceptionOccurred;
+  std::string                m_ExceptionDescription;
+
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkTransformixPointTransformer.hxx"
+#endif
+
+#endif // end #ifndef __itkTransformixPointTransformer_h
@@ -0,0 +1,389 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef __itkTransformixPointTransformer_hxx
+#define __itkTransformixPointTransformer_hxx
+
+#include "itkTransformixPointTransformer.h"
+#include "itkContinuousIndex.h"
+#include "itkMath.h"
+
+#include <sstream>
+#include <algorithm> // for std::min
+
+namespace itk
+{
+
+/**
+ * ********************* Constructor ****************************
+ */
+
+template< class TTransform, class TFixedImage, class TMovingImage >
+TransformixPointTransformer< TTransform, TFixedImage, TMovingImage >
+::TransformixPointTransformer()
+{
+  this->m_NumberOfThreads   = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  this->m_ChunkSize         = 1024;
+  this->m_InputPoints       = 0;
+  this->m_InputIndices      = 0;
+  this->m_Threader          = ThreaderType::New();
+  this->m_Phase             = TransformPhase;
+  this->m_RangeBegin        = 0;
+  this->m_NextChunkBegin    = 0;
+  this->m_RangeEnd          = 0;
+  this->m_ExceptionOccurred = false;
+
+} // end Constructor
+
+
+/**
+ * ********************* SetInput ****************************
+ */
+
+template< class TTransform, class TFixedImage, class TMovingImage >
+void
+TransformixPointTransformer< TTransform, TFixedImage, TMovingImage >
+::SetInput(
+  const std::vector< InputPointType > & inputPoints,
+  const std::vector< FixedImageIndexType > & inputIndices )
+{
+  if( inputPoints.size() != inputIndices.size() )
+  {
+    itkExceptionMacro( << "The number of input points (" << inputPoints.size()
+                       << ") and input indices (" << inputIndices.size() << ") differ." );
+  }
+  this->m_InputPoints  = &inputPoints;
+  this->m_InputIndices = &inputIndices;
+  this->Modified();
+
+} // end SetInput()
+
+
+/**
+ * ********************* TransformPoints ****************************
+ */
+
+template< class TTransform, class TFixedImage, class TMovingImage >
+void
+TransformixPointTransformer< TTransform, TFixedImage, TMovingImage >
+::TransformPoints( void )
+{
+  /** Sanity checks. */
+  if( this->m_InputPoints == 0 )
+  {
+    itkExceptionMacro( << "No input points have been set." );
+  }
+  if( this->m_Transform.IsNull() || this->m_FixedImage.IsNull() )
+  {
+    itkExceptionMacro( << "The transform and the fixed image should be set." );
+  }
+
+  /** Allocate the outputs. */
+  const SizeValueType numberOfPoints = this->m_InputPoints->size();
+  this->m_OutputPoints.resize( numberOfPoints );
+  this->m_OutputIndicesFixed.resize( numberOfPoints );
+  this->m_OutputIndicesMoving.resize(
+    this->m_MovingImage.IsNotNull() ? numberOfPoints : 0 );
+
+  this->ExecuteThreaded( TransformPhase, 0, numberOfPoints );
+
+} // end TransformPoints()
+
+
+/**
+ * ********************* WriteOutputPoints ****************************
+ */
+
+template< class TTransform, class TFixedImage, class TMovingImage >
+void
+TransformixPointTransformer< TTransform, TFixedImage, TMovingImage >
+::WriteOutputPoints( std::ostream & output )
+{
+  const SizeValueType numberOfPoints = this->m_OutputPoints.size();
+  if( this->m_InputPoints == 0 || this->m_InputPoints->size() != numberOfPoints )
+  {
+    itkExceptionMacro( << "TransformPoints() should be called before WriteOutputPoints()." );
+  }
+
+  /** Format in blocks of a limited number of chunks, to bound the memory
+   * that is used for the formatted text.
+   */
+  const SizeValueType chunksPerBlock = 16 * this->m_NumberOfThreads;
+  const SizeValueType blockSize      = chunksPerBlock * this->m_ChunkSize;
+  this->m_FormattedChunks.resize( chunksPerBlock );
+  for( SizeValueType blockBegin = 0; blockBegin < numberOfPoints; blockBegin += blockSize )
+  {
+    const SizeValueType blockEnd = std::min( blockBegin + blockSize, numberOfPoints );
+    this->ExecuteThreaded( FormatPhase, blockBegin, blockEnd );
+
+    const SizeValueType numberOfChunks
+      = ( blockEnd - blockBegin + this->m_ChunkSize - 1 ) / this->m_ChunkSize;
+    for( SizeValueType c = 0; c < numberOfChunks; ++c )
+    {
+      output.write( this->m_FormattedChunks[ c ].data(),
+        static_cast< std::streamsize >( this->m_FormattedChunks[ c ].size() ) );
+    }
+  }
+  output.flush();
+
+  /** Release the memory of the formatted text. */
+  std::vector< std::string >().swap( this->m_FormattedChunks );
+
+} // end WriteOutputPoints()
+
+
+/**
+ * ********************* ExecuteThreaded ****************************
+ */
+
+template< class TTransform, class TFixedImage, class TMovingImage >
+void
+TransformixPointTransformer< TTransform, TFixedImage, TMovingImage >
+::ExecuteThreaded( PhaseType phase, SizeValueType begin, SizeValueType end )
+{
+  this->m_Phase             = phase;
+  this->m_RangeBegin        = begin;
+  this->m_NextChunkBegin    = begin;
+  this->m_RangeEnd          = end;
+  this->m_ExceptionOccurred = false;
+
+  /** Do not start more threads than there are chunks. */
+  const SizeValueType numberOfChunks = ( end - begin + this->m_ChunkSize - 1 ) / this->m_ChunkSize;
+  const ThreadIdType  numberOfThreads = static_cast< ThreadIdType >(
+    std::min< SizeValueType >( this->m_NumberOfThreads, std::max< SizeValueType >( numberOfChunks, 1 ) ) );
+
+  this->m_Threader->SetNumberOfThreads( numberOfThreads );
+  this->m_Threader->SetSingleMethod( Self::ThreaderCallback, this );
+  this->m_Threader->SingleMethodExecute();
+
+  if( this->m_ExceptionOccurred )
+  {
+    itkExceptionMacro( << "An exception occurred while transforming the points:\n"
+                       << this->m_ExceptionDescription );
+  }
+
+} // end ExecuteThreaded()
+
+
+/**
+ * ********************* ThreaderCallback ****************************
+ */
+
+template< class TTransform, class TFixedImage, class TMovingImage >
+ITK_THREAD_RETURN_TYPE
+TransformixPointTransformer< TTransform, TFixedImage, TMovingImage >
+::ThreaderCallback( void * arg )
+{
+  ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+  Self *           self       = static_cast< Self * >( infoStruct->UserData );
+
+  try
+  {
+    SizeValueType begin = 0, end = 0;
+    while( self->GetNextChunk( begin, end ) )
+    {
+      if( self->m_Phase == TransformPhase )
+      {
+        self->ThreadedTransformPoints( begin, end );
+      }
+      else
+      {
+        const SizeValueType chunk = ( begin - self->m_RangeBegin ) / self->m_ChunkSize;
+        self->ThreadedFormatPoints( begin, end, self->m_FormattedChunks[ chunk ] );
+      }
+    }
+  }
+  catch( ExceptionObject & err )
+  {
+    self->m_ChunkMutex.Lock();
+    self->m_ExceptionOccurred    = true;
+    self->m_ExceptionDescription = err.GetDescription();
+    self->m_ChunkMutex.Unlock();
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ThreaderCallback()
+
+
+/**
+ * ********************* GetNextChunk ****************************
+ */
+
+template< class TTransform, class TFixedImage, class TMovingImage >
+bool
+TransformixPointTransformer< TTransform, TFixedImage, TMovingImage >
+::GetNextChunk( SizeValueType & begin, SizeValueType & end )
+{
+  bool found = false;
+  this->m_ChunkMutex.Lock();
+  if( this->m_NextChunkBegin < this->m_RangeEnd && !this->m_ExceptionOccurred )
+  {
+    begin                  = this->m_NextChunkBegin;
+    end                    = std::min( begin + this->m_ChunkSize, this->m_RangeEnd );
+    this->m_NextChunkBegin = end;
+    found                  = true;
+  }
+  this->m_ChunkMutex.Unlock();
+
+  return found;
+
+} // end GetNextChunk()
+
+
+/**
+ * ********************* ThreadedTransformPoints ****************************
+ */
+
+template< class TTransform, class TFixedImage, class TMovingImage >
+void
+TransformixPointTransformer< TTransform, TFixedImage, TMovingImage >
+::ThreadedTransformPoints( SizeValueType begin, SizeValueType end )
+{
+  typedef ContinuousIndex< double, FixedImageDimension >  FixedImageContinuousIndexType;
+  typedef ContinuousIndex< double, MovingImageDimension > MovingImageContinuousIndexType;
+  typedef typename FixedImageIndexType::IndexValueType    FixedImageIndexValueType;
+  typedef typename MovingImageIndexType::IndexValueType   MovingImageIndexValueType;
+
+  /** Transform the chunk in one call. */
+  this->m_Transform->TransformPoints( &( *this->m_InputPoints )[ begin ],
+    &this->m_OutputPoints[ begin ], end - begin );
+
+  /** Compute the indices of the transformed points. */
+  FixedImageContinuousIndexType  fixedcindex;
+  MovingImageContinuousIndexType movingcindex;
+  for( SizeValueType j = begin; j < end; ++j )
+  {
+    this->m_FixedImage->TransformPhysicalPointToContinuousIndex(
+      this->m_OutputPoints[ j ], fixedcindex );
+    for( unsigned int i = 0; i < FixedImageDimension; ++i )
+    {
+      this->m_OutputIndicesFixed[ j ][ i ] = static_cast< FixedImageIndexValueType >(
+        Math::Round< double >( fixedcindex[ i ] ) );
+    }
+
+    if( this->m_MovingImage.IsNotNull() )
+    {
+      this->m_MovingImage->TransformPhysicalPointToContinuousIndex(
+        this->m_OutputPoints[ j ], movingcindex );
+      for( unsigned int i = 0; i < MovingImageDimension; ++i )
+      {
+        this->m_OutputIndicesMoving[ j ][ i ] = static_cast< MovingImageIndexValueType >(
+          Math::Round< double >( movingcindex[ i ] ) );
+      }
+    }
+  }
+
+} // end ThreadedTransformPoints()
+
+
+/**
+ * ********************* ThreadedFormatPoints ****************************
+ */
+
+template< class TTransform, class TFixedImage, class TMovingImage >
+void
+TransformixPointTransformer< TTransform, TFixedImage, TMovingImage >
+::ThreadedFormatPoints( SizeValueType begin, SizeValueType end,
+  std::string & formatted ) const
+{
+  std::ostringstream output;
+  output << std::showpoint << std::fixed;
+
+  for( SizeValueType j = begin; j < end; ++j )
+  {
+    const InputPointType &  inputPoint  = ( *this->m_InputPoints )[ j ];
+    const OutputPointType & outputPoint = this->m_OutputPoints[ j ];
+    DeformationVectorType   deformation;
+    deformation.CastFrom( outputPoint - inputPoint );
+
+    /** The input index. */
+    output << "Point\t" << j << "\t; InputIndex = [ ";
+    for( unsigned int i = 0; i < FixedImageDimension; ++i )
+    {
+      output << ( *this->m_InputIndices )[ j ][ i ] << " ";
+    }
+
+    /** The input point. */
+    output << "]\t; InputPoint = [ ";
+    for( unsigned int i = 0; i < FixedImageDimension; ++i )
+    {
+      output << inputPoint[ i ] << " ";
+    }
+
+    /** The output index in fixed image. */
+    output << "]\t; OutputIndexFixed = [ ";
+    for( unsigned int i = 0; i < FixedImageDimension; ++i )
+    {
+      output << this->m_OutputIndicesFixed[ j ][ i ] << " ";
+    }
+
+    /** The output point. */
+    output << "]\t; OutputPoint = [ ";
+    for( unsigned int i = 0; i < FixedImageDimension; ++i )
+    {
+      output << outputPoint[ i ] << " ";
+    }
+
+    /** The output point minus the input point. */
+    output << "]\t; Deformation = [ ";
+    for( unsigned int i = 0; i < MovingImageDimension; ++i )
+    {
+      output << deformation[ i ] << " ";
+    }
+
+    if( this->m_MovingImage.IsNotNull() )
+    {
+      /** The output index in moving image. */
+      output << "]\t; OutputIndexMoving = [ ";
+      for( unsigned int i = 0; i < MovingImageDimension; ++i )
+      {
+        output << this->m_OutputIndicesMoving[ j ][ i ] << " ";
+      }
+    }
+
+    output << "]\n";
+  }
+
+  formatted = output.str();
+
+} // end ThreadedFormatPoints()
+
+
+/**
+ * ********************* PrintSelf ****************************
+ */
+
+template< class TTransform, class TFixedImage, class TMovingImage >
+void
+TransformixPointTransformer< TTransform, TFixedImage, TMovingImage >
+::PrintSelf( std::ostream & os, Indent indent ) const
+{
+  Superclass::PrintSelf( os, indent );
+
+  os << indent << "Transform: " << this->m_Transform.GetPointer() << std::endl;
+  os << indent << "FixedImage: " << this->m_FixedImage.GetPointer() << std::endl;
+  os << indent << "MovingImage: " << this->m_MovingImage.GetPointer() << std::endl;
+  os << indent << "NumberOfThreads: " << this->m_NumberOfThreads << std::endl;
+  os << indent << "ChunkSize: " << this->m_ChunkSize << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif // end #ifndef __itkTransformixPointTransformer_hxx
@@ -474,18 +474,13 @@ AdvancedKappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
   DerivativeType & vecSum2 = this->m_KappaGetValueAndDerivativePerThreadVariables[ threadId ].st_DerivativeSum2;
 
   /** Get a handle to the sample container. */
-  ImageSampleContainerPointer sampleContainer     = this->GetImageSampler()->GetOutput();
-  const unsigned long         sampleContainerSize = sampleContainer->Size();
-
-  /** Get the samples for this thread. */
-  const unsigned long nrOfSamplesPerThreads
-    = static_cast< unsigned long >( vcl_ceil( static_cast< double >( sampleContainerSize )
-    / static_cast< double >( this->m_NumberOfThreads ) ) );
+  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
 
-  unsigned long pos_begin = nrOfSamplesPerThreads * threadId;
-  unsigned long pos_end   = nrOfSamplesPerThreads * ( threadId + 1 );
-  pos_begin = ( pos_begin > sampleContainerSize ) ? sampleContainerSize : pos_begin;
-  pos_end   = ( pos_end > sampleContainerSize ) ? sampleContainerSize : pos_end;
+  /** The samples are handed out to this thread in one or more ranges
+   * [pos_begin, pos_end) by the sample scheduler.
+   */
+  SizeValueType pos_begin = 0;
+  SizeValueType pos_end   = 0;
 
   /** Some variables. */
   RealType             movingImageValue;
@@ -497,68 +492,75 @@ AdvancedKappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
 
   /** Create iterator over the sample container. */
   typename ImageSampleContainerType::ConstIterator fiter;
-  typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator fend   = sampleContainer->Begin();
-  fbegin                                                 += (int)pos_begin;
-  fend                                                   += (int)pos_end;
+  typename ImageSampleContainerType::ConstIterator fbegin;
+  typename ImageSampleContainerType::ConstIterator fend;
 
-  /** Loop over the fixed image to calculate the kappa statistic. */
-  for( fiter = fbegin; fiter != fend; ++fiter )
+  /** Loop over the sample ranges assigned to this thread. */
+  while( this->GetNextSampleRange( threadId, pos_begin, pos_end ) )
   {
-    /** Read fixed coordinates. */
-    const FixedImagePointType & fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
-
-    /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+    fbegin  = sampleContainer->Begin();
+    fend    = sampleContainer->Begin();
+    fbegin += (int)pos_begin;
+    fend   += (int)pos_end;
 
-    /** Check if point is inside moving mask. */
-    if( sampleOk )
+    /** Loop over the fixed image to calculate the kappa statistic. */
+    for( fiter = fbegin; fiter != fend; ++fiter )
     {
-      sampleOk = this->IsInsideMovingMask( mappedPoint );
-    }
+      /** Read fixed coordinates. */
+      const FixedImagePointType & fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
 
-    /** Compute the moving image value M(T(x)) and derivative dM/dx and check if
-     * the point is inside the moving image buffer.
-     */
-    MovingImageDerivativeType movingImageDerivative;
-    if( sampleOk )
-    {
-      sampleOk = this->EvaluateMovingImageValueAndDerivative(
-        mappedPoint, movingImageValue, &movingImageDerivative );
-    }
+      /** Transform point and check if it is inside the B-spline support region. */
+      bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
 
-    /** Do the actual calculation of the metric value. */
-    if( sampleOk )
-    {
-      numberOfPixelsCounted++;
+      /** Check if point is inside moving mask. */
+      if( sampleOk )
+      {
+        sampleOk = this->IsInsideMovingMask( mappedPoint );
+      }
 
-      /** Get the fixed image value. */
-      const RealType & fixedImageValue
-        = static_cast< RealType >( ( *fiter ).Value().m_ImageValue );
+      /** Compute the moving image value M(T(x)) and derivative dM/dx and check if
+       * the point is inside the moving image buffer.
+       */
+      MovingImageDerivativeType movingImageDerivative;
+      if( sampleOk )
+      {
+        sampleOk = this->EvaluateMovingImageValueAndDerivative(
+          mappedPoint, movingImageValue, &movingImageDerivative );
+      }
+
+      /** Do the actual calculation of the metric value. */
+      if( sampleOk )
+      {
+        numberOfPixelsCounted++;
+
+        /** Get the fixed image value. */
+        const RealType & fixedImageValue
+          = static_cast< RealType >( ( *fiter ).Value().m_ImageValue );
 
 #if 0
-      /** Get the TransformJacobian dT/dmu. */
-      this->EvaluateTransformJacobian( fixedPoint, jacobian, nzji );
+        /** Get the TransformJacobian dT/dmu. */
+        this->EvaluateTransformJacobian( fixedPoint, jacobian, nzji );
 
-      /** Compute the inner products (dM/dx)^T (dT/dmu). */
-      this->EvaluateTransformJacobianInnerProduct(
-        jacobian, movingImageDerivative, imageJacobian );
+        /** Compute the inner products (dM/dx)^T (dT/dmu). */
+        this->EvaluateTransformJacobianInnerProduct(
+          jacobian, movingImageDerivative, imageJacobian );
 #else
-      /** Compute the inner product of the transform Jacobian dT/dmu and the moving image gradient dM/dx. */
-      this->m_AdvancedTransform->EvaluateJacobianWithImageGradientProduct(
-        fixedPoint, movingImageDerivative, imageJacobian, nzji );
+        /** Compute the inner product of the transform Jacobian dT/dmu and the moving image gradient dM/dx. */
+        this->m_AdvancedTransform->EvaluateJacobianWithImageGradientProduct(
+          fixedPoint, movingImageDerivative, imageJacobian, nzji );
 #endif
 
-      /** Compute this pixel's contribution to the measure and derivatives. */
-      this->UpdateValueAndDerivativeTerms(
-        fixedImageValue, movingImageValue,
-        fixedForegroundArea, movingForegroundArea, intersection,
-        imageJacobian, nzji,
-        vecSum1, vecSum2 );
+        /** Compute this pixel's contribution to the measure and derivatives. */
+        this->UpdateValueAndDerivativeTerms(
+          fixedImageValue, movingImageValue,
+          fixedForegroundArea, movingForegroundArea, intersection,
+          imageJacobian, nzji,
+          vecSum1, vecSum2 );
 
-    } // end if sampleOk
+      } // end if sampleOk
 
-  } // end for loop over the image sample container
+    } // end for loop over the image sample container
+  } // end while loop over the sample ranges
 
   /** Only update these variables at the end to prevent unnecessary "false sharing". */
   this->m_KappaGetValueAndDerivativePerThreadVariables[ threadId ].st_NumberOfPixelsCounted = numberOfPixelsCounted;
@@ -578,6 +580,9 @@ AdvancedKappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
 ::AfterThreadedGetValueAndDerivative(
   MeasureType & value, DerivativeType & derivative ) const
 {
+  /** Profile the accumulation of the thread results, if desired. */
+  PhaseProfiler::ScopedProbe probe( "AfterThreadedGetValueAndDerivative" );
+
   /** Accumulate the number of pixels. */
   this->m_NumberOfPixelsCounted
     = this->m_KappaGetValueAndDerivativePerThreadVariables[ 0 ].st_NumberOfPixelsCounted;
@@ -643,8 +648,7 @@ AdvancedKappaStatisticImageToImageMetric< TFixedImage, TMovingImage >
     temp->st_Coefficient2      = tmp2;
     temp->st_DerivativePointer = derivative.begin();
 
-    this->m_Threader->SetSingleMethod( AccumulateDerivativesThreaderCallback, temp );
-    this->m_Threader->SingleMethodExecute();
+    this->ExecuteThreaderCallback( AccumulateDerivativesThreaderCallback, temp );
 
     delete temp;
   }
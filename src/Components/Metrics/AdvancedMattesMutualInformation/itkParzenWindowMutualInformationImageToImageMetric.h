@@ -236,6 +236,15 @@ protected:
   /** Some initialization functions, called by Initialize. */
   virtual void InitializeHistograms( void );
 
+  /** The multi-threaded low memory variant reads the transform sample cache. */
+  virtual bool GetReadsTransformSampleCache( void ) const
+  {
+    return this->m_UseMultiThread
+           && !this->GetUseFiniteDifferenceDerivative()
+           && !this->GetUseExplicitPDFDerivatives();
+  }
+
+
   /** Threading related parameters. */
   struct ParzenWindowMutualInformationMultiThreaderParameterType
   {
@@ -203,6 +203,7 @@ protected:
   typedef typename Superclass::CentralDifferenceGradientFilterType CentralDifferenceGradientFilterType;
   typedef typename Superclass::MovingImageDerivativeType           MovingImageDerivativeType;
   typedef typename Superclass::NonZeroJacobianIndicesType          NonZeroJacobianIndicesType;
+  typedef typename Superclass::MovingImageGradientType             MovingImageGradientType;
 
   /** Protected typedefs for SelfHessian */
   typedef SmoothingRecursiveGaussianImageFilter<
@@ -232,6 +233,13 @@ protected:
     const NonZeroJacobianIndicesType & nzji,
     HessianType & H ) const;
 
+  /** The multi-threaded GetValueAndDerivative() reads the transform sample cache. */
+  virtual bool GetReadsTransformSampleCache( void ) const
+  {
+    return this->m_UseMultiThread;
+  }
+
+
   /** Get value and derivatives for each thread. */
   inline void ThreadedGetValueAndDerivative( ThreadIdType threadID );
 
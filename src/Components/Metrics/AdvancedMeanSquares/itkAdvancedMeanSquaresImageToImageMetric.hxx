@@ -21,6 +21,7 @@
 #include "itkAdvancedMeanSquaresImageToImageMetric.h"
 #include "vnl/algo/vnl_matrix_update.h"
 #include "itkMersenneTwisterRandomVariateGenerator.h"
+#include <algorithm> // for std::min
 
 #ifdef ELASTIX_USE_OPENMP
 #include <omp.h>
@@ -418,10 +419,21 @@ void
 AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
 ::ThreadedGetValueAndDerivative( ThreadIdType threadId )
 {
-  /** Initialize array that stores dM(x)/dmu, and the sparse Jacobian + indices. */
-  const NumberOfParametersType nnzji = this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices();
-  NonZeroJacobianIndicesType   nzji  = NonZeroJacobianIndicesType( nnzji );
-  DerivativeType               imageJacobian( nnzji );
+  /** The samples are processed in batches, so that the transform is called
+   * once per batch instead of once per sample. Allocate the buffers.
+   */
+  const SizeValueType          batchSize = Superclass::TransformBatchSize;
+  FixedImagePointType          fixedPoints[ Superclass::TransformBatchSize ];
+  RealType                     fixedImageValues[ Superclass::TransformBatchSize ];
+  MovingImagePointType         mappedPoints[ Superclass::TransformBatchSize ];
+  RealType                     movingImageValues[ Superclass::TransformBatchSize ];
+  MovingImageGradientType      movingImageDerivatives[ Superclass::TransformBatchSize ];
+  SizeValueType                sampleIndices[ Superclass::TransformBatchSize ];
+
+  /** Initialize arrays that store dM(x)/dmu, and the sparse Jacobian indices. */
+  const NumberOfParametersType              nnzji = this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices();
+  std::vector< NonZeroJacobianIndicesType > nzjis( batchSize, NonZeroJacobianIndicesType( nnzji ) );
+  std::vector< DerivativeType >             imageJacobians( batchSize, DerivativeType( nnzji ) );
 
   /** Get a handle to the pre-allocated derivative for the current thread.
    * The initialization is performed at the beginning of each resolution in
@@ -430,89 +442,92 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
    */
   DerivativeType & derivative = this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_Derivative;
 
-  /** Get a handle to the sample container. */
-  ImageSampleContainerPointer sampleContainer     = this->GetImageSampler()->GetOutput();
-  const unsigned long         sampleContainerSize = sampleContainer->Size();
-
-  /** Get the samples for this thread. */
-  const unsigned long nrOfSamplesPerThreads
-    = static_cast< unsigned long >( vcl_ceil( static_cast< double >( sampleContainerSize )
-    / static_cast< double >( this->m_NumberOfThreads ) ) );
-
-  unsigned long pos_begin = nrOfSamplesPerThreads * threadId;
-  unsigned long pos_end   = nrOfSamplesPerThreads * ( threadId + 1 );
-  pos_begin = ( pos_begin > sampleContainerSize ) ? sampleContainerSize : pos_begin;
-  pos_end   = ( pos_end > sampleContainerSize ) ? sampleContainerSize : pos_end;
-
-  /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator threader_fiter;
-  typename ImageSampleContainerType::ConstIterator threader_fbegin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator threader_fend   = sampleContainer->Begin();
-
-  threader_fbegin += (int)pos_begin;
-  threader_fend   += (int)pos_end;
+  /** The samples are handed out to this thread in one or more ranges
+   * [pos_begin, pos_end) by the sample scheduler.
+   */
+  SizeValueType pos_begin = 0;
+  SizeValueType pos_end   = 0;
 
   /** Create variables to store intermediate results. circumvent false sharing */
   unsigned long numberOfPixelsCounted = 0;
   MeasureType   measure               = NumericTraits< MeasureType >::Zero;
 
-  /** Loop over the fixed image to calculate the mean squares. */
-  for( threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter )
+  /** Loop over the sample ranges assigned to this thread. */
+  while( this->GetNextSampleRange( threadId, pos_begin, pos_end ) )
   {
-    /** Read fixed coordinates and initialize some variables. */
-    const FixedImagePointType & fixedPoint = ( *threader_fiter ).Value().m_ImageCoordinates;
-    RealType                    movingImageValue;
-    MovingImagePointType        mappedPoint;
-    MovingImageDerivativeType   movingImageDerivative;
-
-    /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
-
-    /** Check if point is inside mask. */
-    if( sampleOk )
-    {
-      sampleOk = this->IsInsideMovingMask( mappedPoint ); // thread-safe?
-    }
-
-    /** Compute the moving image value M(T(x)) and derivative dM/dx and check if
-     * the point is inside the moving image buffer.
-     */
-    if( sampleOk )
-    {
-      sampleOk = this->EvaluateMovingImageValueAndDerivative(
-        mappedPoint, movingImageValue, &movingImageDerivative );
-    }
-
-    if( sampleOk )
+    /** Loop over the fixed image samples in batches to calculate the mean squares. */
+    for( SizeValueType batch_begin = pos_begin; batch_begin < pos_end; batch_begin += batchSize )
     {
-      numberOfPixelsCounted++;
+      const SizeValueType batch_size = std::min( batchSize, pos_end - batch_begin );
 
-      /** Get the fixed image value. */
-      const RealType & fixedImageValue
-        = static_cast< RealType >( ( *threader_fiter ).Value().m_ImageValue );
-
-#if 0
-      /** Get the TransformJacobian dT/dmu. */
-      this->EvaluateTransformJacobian( fixedPoint, jacobian, nzji );
+      /** Transform all points of the batch, from the sample coordinates,
+       * or read the mapped points from the transform sample cache.
+       */
+      this->TransformThreaderSamples( batch_begin, batch_size, mappedPoints );
 
-      /** Compute the inner products (dM/dx)^T (dT/dmu). */
-      this->EvaluateTransformJacobianInnerProduct(
-        jacobian, movingImageDerivative, imageJacobian );
-#else
-      /** Compute the inner product of the transform Jacobian dT/dmu and the moving image gradient dM/dx. */
-      this->m_AdvancedTransform->EvaluateJacobianWithImageGradientProduct(
-        fixedPoint, movingImageDerivative, imageJacobian, nzji );
-#endif
+      /** Compute the moving image values M(T(x)) and derivatives dM/dx.
+       * The fixed points and values of the valid samples are read into the
+       * front of the buffers.
+       */
+      SizeValueType numberOfValidSamples = 0;
+      for( SizeValueType k = 0; k < batch_size; ++k )
+      {
+        RealType                  movingImageValue;
+        MovingImageDerivativeType movingImageDerivative;
+
+        /** Check if point is inside mask. */
+        bool sampleOk = this->IsInsideMovingMask( mappedPoints[ k ] );
+
+        /** Check if the point is inside the moving image buffer. */
+        if( sampleOk )
+        {
+          sampleOk = this->EvaluateMovingImageValueAndDerivative(
+            mappedPoints[ k ], movingImageValue, &movingImageDerivative );
+        }
+
+        if( sampleOk )
+        {
+          this->GetThreaderSample( batch_begin + k,
+            fixedPoints[ numberOfValidSamples ], fixedImageValues[ numberOfValidSamples ] );
+          movingImageValues[ numberOfValidSamples ]      = movingImageValue;
+          movingImageDerivatives[ numberOfValidSamples ] = movingImageDerivative;
+          sampleIndices[ numberOfValidSamples ]          = batch_begin + k;
+          ++numberOfValidSamples;
+        }
+      }
+      numberOfPixelsCounted += numberOfValidSamples;
 
-      /** Compute this pixel's contribution to the measure and derivatives. */
-      this->UpdateValueAndDerivativeTerms(
-        fixedImageValue, movingImageValue,
-        imageJacobian, nzji,
-        measure, derivative );
+      /** Compute the inner products of the transform Jacobian dT/dmu and the
+       * moving image gradient dM/dx of all valid samples.
+       */
+      if( this->m_ThreaderCachedSamples )
+      {
+        for( SizeValueType k = 0; k < numberOfValidSamples; ++k )
+        {
+          this->EvaluateThreaderSampleJacobianWithImageGradientProduct( sampleIndices[ k ],
+            fixedPoints[ k ], movingImageDerivatives[ k ], imageJacobians[ k ], nzjis[ k ] );
+        }
+      }
+      else
+      {
+        this->m_AdvancedTransform->EvaluateJacobianWithImageGradientProducts(
+          fixedPoints, movingImageDerivatives, &imageJacobians[ 0 ], &nzjis[ 0 ],
+          numberOfValidSamples );
+      }
 
-    } // end if sampleOk
+      /** Compute the contributions of the samples to the measure and derivatives,
+       * in the order of the samples.
+       */
+      for( SizeValueType k = 0; k < numberOfValidSamples; ++k )
+      {
+        this->UpdateValueAndDerivativeTerms(
+          fixedImageValues[ k ], movingImageValues[ k ],
+          imageJacobians[ k ], nzjis[ k ],
+          measure, derivative );
+      }
 
-  } // end for loop over the image sample container
+    } // end for loop over the batches
+  } // end while loop over the sample ranges
 
   /** Only update these variables at the end to prevent unnecessary "false sharing". */
   this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_NumberOfPixelsCounted = numberOfPixelsCounted;
@@ -531,6 +546,9 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
 ::AfterThreadedGetValueAndDerivative(
   MeasureType & value, DerivativeType & derivative ) const
 {
+  /** Profile the accumulation of the thread results, if desired. */
+  PhaseProfiler::ScopedProbe probe( "AfterThreadedGetValueAndDerivative" );
+
   /** Accumulate the number of pixels. */
   this->m_NumberOfPixelsCounted = this->m_GetValueAndDerivativePerThreadVariables[ 0 ].st_NumberOfPixelsCounted;
   for( ThreadIdType i = 1; i < this->m_NumberOfThreads; ++i )
@@ -577,9 +595,8 @@ AdvancedMeanSquaresImageToImageMetric< TFixedImage, TMovingImage >
     this->m_ThreaderMetricParameters.st_DerivativePointer   = derivative.begin();
     this->m_ThreaderMetricParameters.st_NormalizationFactor = 1.0 / normal_sum;
 
-    this->m_Threader->SetSingleMethod( this->AccumulateDerivativesThreaderCallback,
+    this->ExecuteThreaderCallback( this->AccumulateDerivativesThreaderCallback,
       const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ) );
-    this->m_Threader->SingleMethodExecute();
   }
 #ifdef ELASTIX_USE_OPENMP
   // compute multi-threadedly with openmp
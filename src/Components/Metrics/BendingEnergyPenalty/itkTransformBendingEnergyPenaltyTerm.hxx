@@ -437,143 +437,145 @@ TransformBendingEnergyPenaltyTerm< TFixedImage, TScalarType >
   DerivativeType & derivative = this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_Derivative;
 
   /** Get a handle to the sample container. */
-  ImageSampleContainerPointer sampleContainer     = this->GetImageSampler()->GetOutput();
-  const unsigned long         sampleContainerSize = sampleContainer->Size();
-
-  /** Get the samples for this thread. */
-  const unsigned long nrOfSamplesPerThreads
-    = static_cast< unsigned long >( vcl_ceil( static_cast< double >( sampleContainerSize )
-    / static_cast< double >( this->m_NumberOfThreads ) ) );
+  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
 
-  unsigned long pos_begin = nrOfSamplesPerThreads * threadId;
-  unsigned long pos_end   = nrOfSamplesPerThreads * ( threadId + 1 );
-  pos_begin = ( pos_begin > sampleContainerSize ) ? sampleContainerSize : pos_begin;
-  pos_end   = ( pos_end > sampleContainerSize ) ? sampleContainerSize : pos_end;
+  /** The samples are handed out to this thread in one or more ranges
+   * [pos_begin, pos_end) by the sample scheduler.
+   */
+  SizeValueType pos_begin = 0;
+  SizeValueType pos_end   = 0;
 
   /** Create iterator over the sample container. */
   typename ImageSampleContainerType::ConstIterator fiter;
-  typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator fend   = sampleContainer->Begin();
-  fbegin                                                 += (int)pos_begin;
-  fend                                                   += (int)pos_end;
+  typename ImageSampleContainerType::ConstIterator fbegin;
+  typename ImageSampleContainerType::ConstIterator fend;
 
   /** Create variables to store intermediate results. circumvent false sharing */
   unsigned long numberOfPixelsCounted = 0;
   MeasureType   measure               = NumericTraits< MeasureType >::Zero;
 
-  /** Loop over the fixed image to calculate the penalty term and its derivative. */
-  for( fiter = fbegin; fiter != fend; ++fiter )
+  /** Loop over the sample ranges assigned to this thread. */
+  while( this->GetNextSampleRange( threadId, pos_begin, pos_end ) )
   {
-    /** Read fixed coordinates and initialize some variables. */
-    const FixedImagePointType & fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
-    MovingImagePointType        mappedPoint;
+    fbegin  = sampleContainer->Begin();
+    fend    = sampleContainer->Begin();
+    fbegin += (int)pos_begin;
+    fend   += (int)pos_end;
 
-    /** Although the mapped point is not needed to compute the penalty term,
-     * we compute in order to check if it maps inside the support region of
-     * the B-spline and if it maps inside the moving image mask.
-     */
-
-    /** Transform point and check if it is inside the B-spline support region. */
-    bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
-
-    /** Check if point is inside mask. */
-    if( sampleOk )
+    /** Loop over the fixed image to calculate the penalty term and its derivative. */
+    for( fiter = fbegin; fiter != fend; ++fiter )
     {
-      sampleOk = this->IsInsideMovingMask( mappedPoint );
-    }
-
-    if( sampleOk )
-    {
-      numberOfPixelsCounted++;
+      /** Read fixed coordinates and initialize some variables. */
+      const FixedImagePointType & fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
+      MovingImagePointType        mappedPoint;
 
-      /** Get the spatial Hessian of the transformation at the current point.
-       * This is needed to compute the bending energy.
+      /** Although the mapped point is not needed to compute the penalty term,
+       * we compute in order to check if it maps inside the support region of
+       * the B-spline and if it maps inside the moving image mask.
        */
-      this->m_AdvancedTransform->GetJacobianOfSpatialHessian( fixedPoint,
-        spatialHessian, jacobianOfSpatialHessian, nonZeroJacobianIndices );
 
-      /** Prepare some stuff for the computation of the metric (derivative). */
-      FixedArray< InternalMatrixType, FixedImageDimension > A;
-      for( unsigned int k = 0; k < FixedImageDimension; ++k )
-      {
-        A[ k ] = spatialHessian[ k ].GetVnlMatrix();
-      }
+      /** Transform point and check if it is inside the B-spline support region. */
+      bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
 
-      /** Compute the contribution to the metric value of this point. */
-      for( unsigned int k = 0; k < FixedImageDimension; ++k )
+      /** Check if point is inside mask. */
+      if( sampleOk )
       {
-        measure += vnl_math_sqr( A[ k ].frobenius_norm() );
+        sampleOk = this->IsInsideMovingMask( mappedPoint );
       }
 
-      /** Make a distinction between a B-spline transform and other transforms. */
-      if( !transformIsBSpline )
+      if( sampleOk )
       {
-        /** Compute the contribution to the metric derivative of this point. */
-        for( unsigned int mu = 0; mu < nonZeroJacobianIndices.size(); ++mu )
-        {
-          for( unsigned int k = 0; k < FixedImageDimension; ++k )
-          {
-            /** This computes:
-             * \sum_i \sum_j A_ij B_ij = element_product(A,B).mean()*B.size()
-             */
-            const InternalMatrixType & B
-              = jacobianOfSpatialHessian[ mu ][ k ].GetVnlMatrix();
+        numberOfPixelsCounted++;
 
-            RealType matrixElementProduct = 0.0;
-            typename InternalMatrixType::const_iterator itA    = A[ k ].begin();
-            typename InternalMatrixType::const_iterator itB    = B.begin();
-            typename InternalMatrixType::const_iterator itAend = A[ k ].end();
-            while( itA != itAend )
-            {
-              matrixElementProduct += ( *itA ) * ( *itB );
-              ++itA;
-              ++itB;
-            }
+        /** Get the spatial Hessian of the transformation at the current point.
+         * This is needed to compute the bending energy.
+         */
+        this->m_AdvancedTransform->GetJacobianOfSpatialHessian( fixedPoint,
+          spatialHessian, jacobianOfSpatialHessian, nonZeroJacobianIndices );
 
-            derivative[ nonZeroJacobianIndices[ mu ] ]
-              += 2.0 * matrixElementProduct;
-          }
+        /** Prepare some stuff for the computation of the metric (derivative). */
+        FixedArray< InternalMatrixType, FixedImageDimension > A;
+        for( unsigned int k = 0; k < FixedImageDimension; ++k )
+        {
+          A[ k ] = spatialHessian[ k ].GetVnlMatrix();
         }
-      }
-      else
-      {
-        /** For the B-spline transform we know that only 1/FixedImageDimension
-         * part of the JacobianOfSpatialHessian is non-zero.
-         *
-         * In addition we know that jsh[ mu + numParPerDim * k ][ k ] is the same for all k.
-         */
 
-        /** Compute the contribution to the metric derivative of this point. */
-        const unsigned int numParPerDim
-          = nonZeroJacobianIndices.size() / FixedImageDimension;
-        for( unsigned int mu = 0; mu < numParPerDim; ++mu )
+        /** Compute the contribution to the metric value of this point. */
+        for( unsigned int k = 0; k < FixedImageDimension; ++k )
         {
-          const InternalMatrixType & B
-            = jacobianOfSpatialHessian[ mu + numParPerDim * 0 ][ 0 ].GetVnlMatrix();
+          measure += vnl_math_sqr( A[ k ].frobenius_norm() );
+        }
 
-          for( unsigned int k = 0; k < FixedImageDimension; ++k )
+        /** Make a distinction between a B-spline transform and other transforms. */
+        if( !transformIsBSpline )
+        {
+          /** Compute the contribution to the metric derivative of this point. */
+          for( unsigned int mu = 0; mu < nonZeroJacobianIndices.size(); ++mu )
           {
-            /** This computes:
-             * \sum_i \sum_j A_ij B_ij = element_product(A,B).mean()*B.size()
-             */
-            RealType matrixElementProduct = 0.0;
-            typename InternalMatrixType::const_iterator itA    = A[ k ].begin();
-            typename InternalMatrixType::const_iterator itB    = B.begin();
-            typename InternalMatrixType::const_iterator itAend = A[ k ].end();
-            while( itA != itAend )
+            for( unsigned int k = 0; k < FixedImageDimension; ++k )
             {
-              matrixElementProduct += ( *itA ) * ( *itB );
-              ++itA;
-              ++itB;
+              /** This computes:
+               * \sum_i \sum_j A_ij B_ij = element_product(A,B).mean()*B.size()
+               */
+              const InternalMatrixType & B
+                = jacobianOfSpatialHessian[ mu ][ k ].GetVnlMatrix();
+
+              RealType matrixElementProduct = 0.0;
+              typename InternalMatrixType::const_iterator itA    = A[ k ].begin();
+              typename InternalMatrixType::const_iterator itB    = B.begin();
+              typename InternalMatrixType::const_iterator itAend = A[ k ].end();
+              while( itA != itAend )
+              {
+                matrixElementProduct += ( *itA ) * ( *itB );
+                ++itA;
+                ++itB;
+              }
+
+              derivative[ nonZeroJacobianIndices[ mu ] ]
+                += 2.0 * matrixElementProduct;
             }
-
-            derivative[ nonZeroJacobianIndices[ mu + numParPerDim * k ] ]
-              += 2.0 * matrixElementProduct;
           }
         }
-      } // end if B-spline
-    }   // end if sampleOk
-  }     // end for loop over the image sample container
+        else
+        {
+          /** For the B-spline transform we know that only 1/FixedImageDimension
+           * part of the JacobianOfSpatialHessian is non-zero.
+           *
+           * In addition we know that jsh[ mu + numParPerDim * k ][ k ] is the same for all k.
+           */
+
+          /** Compute the contribution to the metric derivative of this point. */
+          const unsigned int numParPerDim
+            = nonZeroJacobianIndices.size() / FixedImageDimension;
+          for( unsigned int mu = 0; mu < numParPerDim; ++mu )
+          {
+            const InternalMatrixType & B
+              = jacobianOfSpatialHessian[ mu + numParPerDim * 0 ][ 0 ].GetVnlMatrix();
+
+            for( unsigned int k = 0; k < FixedImageDimension; ++k )
+            {
+              /** This computes:
+               * \sum_i \sum_j A_ij B_ij = element_product(A,B).mean()*B.size()
+               */
+              RealType matrixElementProduct = 0.0;
+              typename InternalMatrixType::const_iterator itA    = A[ k ].begin();
+              typename InternalMatrixType::const_iterator itB    = B.begin();
+              typename InternalMatrixType::const_iterator itAend = A[ k ].end();
+              while( itA != itAend )
+              {
+                matrixElementProduct += ( *itA ) * ( *itB );
+                ++itA;
+                ++itB;
+              }
+
+              derivative[ nonZeroJacobianIndices[ mu + numParPerDim * k ] ]
+                += 2.0 * matrixElementProduct;
+            }
+          }
+        } // end if B-spline
+      }   // end if sampleOk
+    }     // end for loop over the image sample container
+  } // end while loop over the sample ranges
 
   /** Only update these variables at the end to prevent unnecessary "false sharing". */
   this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_NumberOfPixelsCounted = numberOfPixelsCounted;
@@ -592,6 +594,9 @@ TransformBendingEnergyPenaltyTerm< TFixedImage, TScalarType >
 ::AfterThreadedGetValueAndDerivative(
   MeasureType & value, DerivativeType & derivative ) const
 {
+  /** Profile the accumulation of the thread results, if desired. */
+  PhaseProfiler::ScopedProbe probe( "AfterThreadedGetValueAndDerivative" );
+
   /** Accumulate the number of pixels. */
   this->m_NumberOfPixelsCounted = 0;
   for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
@@ -638,9 +643,8 @@ TransformBendingEnergyPenaltyTerm< TFixedImage, TScalarType >
     this->m_ThreaderMetricParameters.st_NormalizationFactor
       = static_cast< DerivativeValueType >( this->m_NumberOfPixelsCounted );
 
-    this->m_Threader->SetSingleMethod( this->AccumulateDerivativesThreaderCallback,
+    this->ExecuteThreaderCallback( this->AccumulateDerivativesThreaderCallback,
       const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ) );
-    this->m_Threader->SingleMethodExecute();
   }
 #ifdef ELASTIX_USE_OPENMP
   // compute multi-threadedly with openmp
@@ -78,6 +78,8 @@ public:
   typedef vnl_vector< CoordRepType >             VnlVectorType;
 
   typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
+  typedef typename Superclass::SparseDerivativeType       SparseDerivativeType;
+  typedef typename Superclass::ParametersType             ParametersType;
 
   /**  Get the value for single valued optimizers. */
   MeasureType GetValue( const TransformParametersType & parameters ) const;
@@ -90,11 +92,31 @@ public:
   void GetValueAndDerivative( const TransformParametersType & parameters,
     MeasureType & Value, DerivativeType & Derivative ) const;
 
+  /** The derivative only depends on the parameters that affect the points,
+   * so this metric supports a sparse derivative.
+   */
+  virtual bool GetSupportsSparseDerivative( void ) const
+  {
+    return true;
+  }
+
+
+  /** Get value and sparse derivative, see SparseDerivativeCostFunction. */
+  virtual void GetValueAndSparseDerivative( const ParametersType & parameters,
+    MeasureType & value, SparseDerivativeType & derivative ) const;
+
 protected:
 
   CorrespondingPointsEuclideanDistancePointMetric();
   virtual ~CorrespondingPointsEuclideanDistancePointMetric() {}
 
+  /** Compute the value and add the derivative to a zero derivative, which
+   * is either a DerivativeType or a SparseDerivativeType.
+   */
+  template< class TDerivative >
+  void ComputeValueAndDerivative( const TransformParametersType & parameters,
+    MeasureType & value, TDerivative & derivative ) const;
+
 private:
 
   CorrespondingPointsEuclideanDistancePointMetric( const Self & ); // purposely not implemented
@@ -139,6 +139,40 @@ void
 CorrespondingPointsEuclideanDistancePointMetric< TFixedPointSet, TMovingPointSet >
 ::GetValueAndDerivative( const TransformParametersType & parameters,
   MeasureType & value, DerivativeType & derivative ) const
+{
+  derivative = DerivativeType( this->GetNumberOfParameters() );
+  derivative.Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
+  this->ComputeValueAndDerivative( parameters, value, derivative );
+
+} // end GetValueAndDerivative()
+
+
+/**
+ * ******************* GetValueAndSparseDerivative *******************
+ */
+
+template< class TFixedPointSet, class TMovingPointSet >
+void
+CorrespondingPointsEuclideanDistancePointMetric< TFixedPointSet, TMovingPointSet >
+::GetValueAndSparseDerivative( const ParametersType & parameters,
+  MeasureType & value, SparseDerivativeType & derivative ) const
+{
+  derivative.SetSize( this->GetNumberOfParameters() );
+  this->ComputeValueAndDerivative( parameters, value, derivative );
+
+} // end GetValueAndSparseDerivative()
+
+
+/**
+ * ******************* ComputeValueAndDerivative *******************
+ */
+
+template< class TFixedPointSet, class TMovingPointSet >
+template< class TDerivative >
+void
+CorrespondingPointsEuclideanDistancePointMetric< TFixedPointSet, TMovingPointSet >
+::ComputeValueAndDerivative( const TransformParametersType & parameters,
+  MeasureType & value, TDerivative & derivative ) const
 {
   /** Sanity checks. */
   FixedPointSetConstPointer fixedPointSet = this->GetFixedPointSet();
@@ -156,8 +190,6 @@ CorrespondingPointsEuclideanDistancePointMetric< TFixedPointSet, TMovingPointSet
   /** Initialize some variables */
   this->m_NumberOfPointsCounted = 0;
   MeasureType measure = NumericTraits< MeasureType >::Zero;
-  derivative = DerivativeType( this->GetNumberOfParameters() );
-  derivative.Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
   NonZeroJacobianIndicesType nzji(
   this->m_Transform->GetNumberOfNonZeroJacobianIndices() );
   TransformJacobianType jacobian;
@@ -222,21 +254,15 @@ CorrespondingPointsEuclideanDistancePointMetric< TFixedPointSet, TMovingPointSet
       /** Calculate the contributions to the derivatives with respect to each parameter. */
       if( distance > vcl_numeric_limits< MeasureType >::epsilon() )
       {
+        /** Only pick the nonzero Jacobians. This also works for a
+         * SparseDerivativeType, which only allocates the touched blocks.
+         */
         VnlVectorType diff_2 = diffPoint / distance;
-        if( nzji.size() == this->GetNumberOfParameters() )
+        for( unsigned int i = 0; i < nzji.size(); ++i )
         {
-          /** Loop over all Jacobians. */
-          derivative -= diff_2 * jacobian;
-        }
-        else
-        {
-          /** Only pick the nonzero Jacobians. */
-          for( unsigned int i = 0; i < nzji.size(); ++i )
-          {
-            const unsigned int index  = nzji[ i ];
-            VnlVectorType      column = jacobian.get_column( i );
-            derivative[ index ] -= dot_product( diff_2, column );
-          }
+          const unsigned int index  = nzji[ i ];
+          VnlVectorType      column = jacobian.get_column( i );
+          derivative[ index ] -= dot_product( diff_2, column );
         }
       } // end if distance != 0
 
@@ -259,7 +285,7 @@ CorrespondingPointsEuclideanDistancePointMetric< TFixedPointSet, TMovingPointSet
     value       = measure / this->m_NumberOfPointsCounted;
   }
 
-} // end GetValueAndDerivative()
+} // end ComputeValueAndDerivative()
 
 
 } // end namespace itk
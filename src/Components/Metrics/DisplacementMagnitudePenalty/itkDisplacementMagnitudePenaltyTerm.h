@@ -85,6 +85,7 @@ public:
   typedef typename Superclass::ImageSampleContainerType     ImageSampleContainerType;
   typedef typename Superclass::ImageSampleContainerPointer  ImageSampleContainerPointer;
   typedef typename Superclass::ScalarType                   ScalarType;
+  typedef typename Superclass::SparseDerivativeType         SparseDerivativeType;
 
   /** Typedefs from the AdvancedTransform. */
   typedef typename Superclass::SpatialJacobianType SpatialJacobianType;
@@ -117,6 +118,21 @@ public:
     MeasureType & value,
     DerivativeType & derivative ) const;
 
+  /** With a masked or sparse image sampler only the B-spline coefficients
+   * near the samples are touched, so this term supports a sparse derivative.
+   */
+  virtual bool GetSupportsSparseDerivative( void ) const
+  {
+    return true;
+  }
+
+
+  /** Get the penalty term value and sparse derivative. */
+  virtual void GetValueAndSparseDerivative(
+    const ParametersType & parameters,
+    MeasureType & value,
+    SparseDerivativeType & derivative ) const;
+
 protected:
 
   /** Typedefs for indices and points. */
@@ -134,6 +150,15 @@ protected:
   /** The destructor. */
   virtual ~DisplacementMagnitudePenaltyTerm() {}
 
+  /** Compute the value and add the derivative to a zero derivative, which
+   * is either a DerivativeType or a SparseDerivativeType.
+   */
+  template< class TDerivative >
+  void ComputeValueAndDerivative(
+    const ParametersType & parameters,
+    MeasureType & value,
+    TDerivative & derivative ) const;
+
   /** PrintSelf. *
   void PrintSelf( std::ostream& os, Indent indent ) const;*/
 
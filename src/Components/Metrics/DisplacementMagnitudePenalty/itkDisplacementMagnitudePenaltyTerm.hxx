@@ -156,14 +156,50 @@ DisplacementMagnitudePenaltyTerm< TFixedImage, TScalarType >
   const ParametersType & parameters,
   MeasureType & value,
   DerivativeType & derivative ) const
+{
+  derivative = DerivativeType( this->GetNumberOfParameters() );
+  derivative.Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
+  this->ComputeValueAndDerivative( parameters, value, derivative );
+
+} // end GetValueAndDerivative()
+
+
+/**
+ * ****************** GetValueAndSparseDerivative *******************************
+ */
+
+template< class TFixedImage, class TScalarType >
+void
+DisplacementMagnitudePenaltyTerm< TFixedImage, TScalarType >
+::GetValueAndSparseDerivative(
+  const ParametersType & parameters,
+  MeasureType & value,
+  SparseDerivativeType & derivative ) const
+{
+  derivative.SetSize( this->GetNumberOfParameters() );
+  this->ComputeValueAndDerivative( parameters, value, derivative );
+
+} // end GetValueAndSparseDerivative()
+
+
+/**
+ * ****************** ComputeValueAndDerivative *******************************
+ */
+
+template< class TFixedImage, class TScalarType >
+template< class TDerivative >
+void
+DisplacementMagnitudePenaltyTerm< TFixedImage, TScalarType >
+::ComputeValueAndDerivative(
+  const ParametersType & parameters,
+  MeasureType & value,
+  TDerivative & derivative ) const
 {
   typedef typename MovingImagePointType::VectorType VectorType;
 
   /** Create and initialize some variables. */
   this->m_NumberOfPixelsCounted = 0;
   RealType measure = NumericTraits< RealType >::Zero;
-  derivative = DerivativeType( this->GetNumberOfParameters() );
-  derivative.Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
 
   /** Array that stores sparse jacobian+indices. */
   NonZeroJacobianIndicesType nzji( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
@@ -253,7 +289,7 @@ DisplacementMagnitudePenaltyTerm< TFixedImage, TScalarType >
   /** The return value. */
   value = static_cast< MeasureType >( measure );
 
-} // end GetValueAndDerivative()
+} // end ComputeValueAndDerivative()
 
 
 } // end namespace itk
@@ -307,7 +307,11 @@ DistancePreservingRigidityPenaltyTerm< TFixedImage, TScalarType >
   derivative = DerivativeType( this->GetNumberOfParameters() );
   derivative.Fill( NumericTraits< MeasureType >::ZeroValue() );
 
-  this->m_BSplineTransform->SetParameters( parameters );
+  /** Set the parameters, unless this was already done by the combo-metric. */
+  if( this->m_UseMetricSingleThreaded )
+  {
+    this->m_BSplineTransform->SetParameters( parameters );
+  }
 
   /** Distance-preserving penalty */
   MeasureType penaltyTermBuffer   = 0.0;
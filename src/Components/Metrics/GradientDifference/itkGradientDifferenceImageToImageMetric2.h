@@ -40,7 +40,7 @@
 #include "itkNeighborhoodOperatorImageFilter.h"
 #include "itkPoint.h"
 #include "itkCastImageFilter.h"
-#include "itkResampleImageFilter.h"
+#include "itkRayCastResampleImageFilter.h"
 #include "itkOptimizer.h"
 #include "itkAdvancedCombinationTransform.h"
 #include "itkAdvancedRayCastInterpolateImageFunction.h"
@@ -127,7 +127,7 @@ public:
   typedef typename CombinationTransformType::Pointer CombinationTransformPointer;
   typedef itk::Image< FixedImagePixelType, itkGetStaticConstMacro( FixedImageDimension ) >
     TransformedMovingImageType;
-  typedef itk::ResampleImageFilter< MovingImageType, TransformedMovingImageType >
+  typedef itk::RayCastResampleImageFilter< MovingImageType, TransformedMovingImageType >
     TransformMovingImageFilterType;
   typedef typename itk::AdvancedRayCastInterpolateImageFunction<
     MovingImageType, ScalarType >             RayCastInterpolatorType;
@@ -170,6 +170,14 @@ public:
   itkSetMacro( DerivativeDelta, double );
   itkGetConstReferenceMacro( DerivativeDelta, double );
 
+  /** Set/Get whether the derivative is computed by forward differences
+   * instead of central differences. GetValueAndDerivative() then reuses
+   * the value at the current parameters, so that the moving image is
+   * rendered NumberOfParameters + 1 instead of 2 * NumberOfParameters + 1
+   * times. Default: false */
+  itkSetMacro( UseForwardDifferences, bool );
+  itkGetConstMacro( UseForwardDifferences, bool );
+
 protected:
 
   GradientDifferenceImageToImageMetric();
@@ -236,6 +244,7 @@ private:
 
   ScalesType                  m_Scales;
   double                      m_DerivativeDelta;
+  bool                        m_UseForwardDifferences;
   double                      m_Rescalingfactor;
   CombinationTransformPointer m_CombinationTransform;
 
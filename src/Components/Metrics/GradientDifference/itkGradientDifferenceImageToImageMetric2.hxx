@@ -76,8 +76,9 @@ GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
     this->m_MaxMovedGradient[ iDimension ] = 0;
   }
 
-  this->m_DerivativeDelta = 0.001;
-  this->m_Rescalingfactor = 1.0;
+  this->m_DerivativeDelta       = 0.001;
+  this->m_UseForwardDifferences = false;
+  this->m_Rescalingfactor       = 1.0;
 }
 
 
@@ -171,6 +172,7 @@ GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
 {
   Superclass::PrintSelf( os, indent );
   os << indent << "DerivativeDelta: " << this->m_DerivativeDelta << std::endl;
+  os << indent << "UseForwardDifferences: " << this->m_UseForwardDifferences << std::endl;
 
 }
 
@@ -505,6 +507,14 @@ GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
 ::GetDerivative( const TransformParametersType & parameters,
   DerivativeType & derivative ) const
 {
+  /** Forward differences need the value at the current parameters. */
+  if( this->m_UseForwardDifferences )
+  {
+    MeasureType value = NumericTraits< MeasureType >::Zero;
+    this->GetValueAndDerivative( parameters, value, derivative );
+    return;
+  }
+
   TransformParametersType testPoint;
   testPoint = parameters;
   const unsigned int numberOfParameters = this->GetNumberOfParameters();
@@ -534,7 +544,26 @@ GradientDifferenceImageToImageMetric< TFixedImage, TMovingImage >
   MeasureType & Value, DerivativeType & derivative ) const
 {
   Value = this->GetValue( parameters );
-  this->GetDerivative( parameters, derivative );
+  if( !this->m_UseForwardDifferences )
+  {
+    this->GetDerivative( parameters, derivative );
+    return;
+  }
+
+  /** Forward differences, reusing the value at the current parameters. */
+  TransformParametersType testPoint;
+  testPoint = parameters;
+  const unsigned int numberOfParameters = this->GetNumberOfParameters();
+  derivative = DerivativeType( numberOfParameters );
+
+  for( unsigned int i = 0; i < numberOfParameters; i++ )
+  {
+    const double delta = this->m_DerivativeDelta / vcl_sqrt( this->m_Scales[ i ] );
+    testPoint[ i ] += delta;
+    const MeasureType valuep1 = this->GetValue( testPoint );
+    derivative[ i ] = ( valuep1 - Value ) / delta;
+    testPoint[ i ]  = parameters[ i ];
+  }
 
 } // end GetValueAndDerivative()
 
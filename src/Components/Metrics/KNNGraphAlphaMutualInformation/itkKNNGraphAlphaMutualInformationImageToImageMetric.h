@@ -67,6 +67,13 @@ namespace itk
  * IEEE Transactions on Medical Imaging, vol. 28, no. 9, pp. 1412 - 1421,
  * September 2009.
  *
+ * When UseMultiThread is true, the three kNN trees are generated
+ * concurrently, and the loop over the query points is distributed over
+ * the threads. Each thread accumulates its own part of the graph lengths
+ * and of the derivative, which are summed afterwards. The ANN search
+ * routines keep their state in thread-local storage, so the searchers
+ * can be shared by the threads.
+ *
  * \ingroup RegistrationMetrics
  */
 
@@ -134,6 +141,8 @@ public:
   typedef typename
     Superclass::MovingImageLimiterOutputType MovingImageLimiterOutputType;
   typedef typename Superclass::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
+  typedef typename Superclass::ThreaderType               ThreaderType;
+  typedef typename Superclass::ThreadInfoType             ThreadInfoType;
 
   /** Typedef's for storing multiple inputs. */
   typedef typename Superclass::FixedImageVectorType             FixedImageVectorType;
@@ -286,6 +295,23 @@ private:
   typedef Array2D< double >                         SpatialDerivativeType;
   typedef std::vector< SpatialDerivativeType >      SpatialDerivativeContainerType;
 
+  /** Threading related parameters. The pointers to the list samples and
+   * the derivative containers are set for every call to GetValue() or
+   * GetValueAndDerivative().
+   */
+  struct KNNGraphAlphaMutualInformationMultiThreaderParameterType
+  {
+    Self *                                        m_Metric;
+    const ListSampleType *                        st_ListSampleFixed;
+    const ListSampleType *                        st_ListSampleMoving;
+    const ListSampleType *                        st_ListSampleJoint;
+    const TransformJacobianContainerType *        st_JacobianContainer;
+    const TransformJacobianIndicesContainerType * st_JacobianIndicesContainer;
+    const SpatialDerivativeContainerType *        st_SpatialDerivativesContainer;
+    bool                                          st_DoDerivative;
+  };
+  mutable KNNGraphAlphaMutualInformationMultiThreaderParameterType m_KNNGraphAlphaMutualInformationThreaderParameters;
+
   /** This function takes the fixed image samples from the ImageSampler
    * and puts them in the listSampleFixed, together with the fixed feature
    * image samples. Also the corresponding moving image values and moving
@@ -306,6 +332,47 @@ private:
     TransformJacobianIndicesContainerType & jacobiansIndices,
     SpatialDerivativeContainerType & spatialDerivatives ) const;
 
+  /** This function sets the list samples to the three trees, generates
+   * the trees, and connects them to the searchers. The trees are
+   * generated concurrently if UseMultiThread is true.
+   */
+  void GenerateTrees(
+    const ListSamplePointer & listSampleFixed,
+    const ListSamplePointer & listSampleMoving,
+    const ListSamplePointer & listSampleJoint ) const;
+
+  /** Generate the trees assigned to thread threadId. */
+  inline void ThreadedGenerateTrees( ThreadIdType threadId );
+
+  /** Helper function to launch the threads. */
+  static ITK_THREAD_RETURN_TYPE GenerateTreesThreaderCallback( void * arg );
+
+  /** Multi-threaded version of the loop over the query points. Every thread
+   * searches the neighbours of the query points in its sample ranges, and
+   * accumulates its part of sumG in st_Value and, if st_DoDerivative is true,
+   * its part of the derivative contribution in st_Derivative.
+   */
+  inline void ThreadedComputeGraphLengths( ThreadIdType threadId );
+
+  /** Helper function to launch the threads. */
+  static ITK_THREAD_RETURN_TYPE ComputeGraphLengthsThreaderCallback( void * arg );
+
+  /** Helper function to launch the threads. */
+  void LaunchComputeGraphLengthsThreaderCallback(
+    const ListSamplePointer & listSampleFixed,
+    const ListSamplePointer & listSampleMoving,
+    const ListSamplePointer & listSampleJoint,
+    const bool & doDerivative,
+    const TransformJacobianContainerType & jacobians,
+    const TransformJacobianIndicesContainerType & jacobiansIndices,
+    const SpatialDerivativeContainerType & spatialDerivatives ) const;
+
+  /** Sum the per-thread parts of sumG and return it. If derivative is not
+   * null, also compute the derivative ( jointSize / sumG ) * contribution
+   * from the per-thread contributions. The per-thread variables are reset.
+   */
+  MeasureType AfterThreadedComputeGraphLengths( DerivativeType * derivative ) const;
+
   /** This function calculates the spatial derivative of the
    * featureNr feature image at the point mappedPoint.
    * \todo move this to base class.
@@ -44,6 +44,16 @@ KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
   this->m_BinaryKNNTreeSearcherMoving = 0;
   this->m_BinaryKNNTreeSearcherJoint  = 0;
 
+  /** Initialize the m_KNNGraphAlphaMutualInformationThreaderParameters. */
+  this->m_KNNGraphAlphaMutualInformationThreaderParameters.m_Metric = this;
+  this->m_KNNGraphAlphaMutualInformationThreaderParameters.st_ListSampleFixed             = 0;
+  this->m_KNNGraphAlphaMutualInformationThreaderParameters.st_ListSampleMoving            = 0;
+  this->m_KNNGraphAlphaMutualInformationThreaderParameters.st_ListSampleJoint             = 0;
+  this->m_KNNGraphAlphaMutualInformationThreaderParameters.st_JacobianContainer           = 0;
+  this->m_KNNGraphAlphaMutualInformationThreaderParameters.st_JacobianIndicesContainer    = 0;
+  this->m_KNNGraphAlphaMutualInformationThreaderParameters.st_SpatialDerivativesContainer = 0;
+  this->m_KNNGraphAlphaMutualInformationThreaderParameters.st_DoDerivative = false;
+
 } // end Constructor()
 
 
@@ -336,25 +346,7 @@ KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
    * and connect them to the searchers.
    */
 
-  /** Generate the tree for the fixed image samples. */
-  this->m_BinaryKNNTreeFixed->SetSample( listSampleFixed );
-  this->m_BinaryKNNTreeFixed->GenerateTree();
-
-  /** Generate the tree for the moving image samples. */
-  this->m_BinaryKNNTreeMoving->SetSample( listSampleMoving );
-  this->m_BinaryKNNTreeMoving->GenerateTree();
-
-  /** Generate the tree for the joint image samples. */
-  this->m_BinaryKNNTreeJoint->SetSample( listSampleJoint );
-  this->m_BinaryKNNTreeJoint->GenerateTree();
-
-  /** Initialize tree searchers. */
-  this->m_BinaryKNNTreeSearcherFixed
-  ->SetBinaryTree( this->m_BinaryKNNTreeFixed );
-  this->m_BinaryKNNTreeSearcherMoving
-  ->SetBinaryTree( this->m_BinaryKNNTreeMoving );
-  this->m_BinaryKNNTreeSearcherJoint
-  ->SetBinaryTree( this->m_BinaryKNNTreeJoint );
+  this->GenerateTrees( listSampleFixed, listSampleMoving, listSampleJoint );
 
   /**
    * *************** Estimate the \alpha MI ******************
@@ -407,59 +399,71 @@ KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
   unsigned int k        = this->m_BinaryKNNTreeSearcherFixed->GetKNearestNeighbors();
   double       twoGamma = jointSize * ( 1.0 - this->m_Alpha );
 
-  /** Loop over all query points, i.e. all samples. */
-  for( unsigned long i = 0; i < this->m_NumberOfPixelsCounted; i++ )
+  if( this->m_UseMultiThread )
   {
-    /** Get the i-th query point. */
-    listSampleFixed->GetMeasurementVector(  i, z_F );
-    listSampleMoving->GetMeasurementVector( i, z_M );
-    listSampleJoint->GetMeasurementVector(  i, z_J );
-
-    /** Search for the K nearest neighbours of the current query point. */
-    this->m_BinaryKNNTreeSearcherFixed->Search(  z_F, indices_F, distances_F );
-    this->m_BinaryKNNTreeSearcherMoving->Search( z_M, indices_M, distances_M );
-    this->m_BinaryKNNTreeSearcherJoint->Search(  z_J, indices_J, distances_J );
-
-    /** Add the distances between the points to get the total graph length.
-     * The outcommented implementation calculates: sum J/sqrt(F*M)
-     *
-    for ( unsigned int j = 0; j < K; j++ )
-    {
-    enumerator = vcl_sqrt( distsJ[ j ] );
-    denominator = vcl_sqrt( vcl_sqrt( distsF[ j ] ) * vcl_sqrt( distsM[ j ] ) );
-    if ( denominator > 1e-14 )
+    /** Distribute the query points over the threads. */
+    this->LaunchComputeGraphLengthsThreaderCallback(
+      listSampleFixed, listSampleMoving, listSampleJoint,
+      false, dummyJacobianContainer, dummyJacobianIndicesContainer,
+      dummySpatialDerivativesContainer );
+    sumG = this->AfterThreadedComputeGraphLengths( 0 );
+  }
+  else
+  {
+    /** Loop over all query points, i.e. all samples. */
+    for( unsigned long i = 0; i < this->m_NumberOfPixelsCounted; i++ )
     {
-    contribution += vcl_pow( enumerator / denominator, twoGamma );
-    }
-    }*/
+      /** Get the i-th query point. */
+      listSampleFixed->GetMeasurementVector(  i, z_F );
+      listSampleMoving->GetMeasurementVector( i, z_M );
+      listSampleJoint->GetMeasurementVector(  i, z_J );
+
+      /** Search for the K nearest neighbours of the current query point. */
+      this->m_BinaryKNNTreeSearcherFixed->Search(  z_F, indices_F, distances_F );
+      this->m_BinaryKNNTreeSearcherMoving->Search( z_M, indices_M, distances_M );
+      this->m_BinaryKNNTreeSearcherJoint->Search(  z_J, indices_J, distances_J );
+
+      /** Add the distances between the points to get the total graph length.
+       * The outcommented implementation calculates: sum J/sqrt(F*M)
+       *
+      for ( unsigned int j = 0; j < K; j++ )
+      {
+      enumerator = vcl_sqrt( distsJ[ j ] );
+      denominator = vcl_sqrt( vcl_sqrt( distsF[ j ] ) * vcl_sqrt( distsM[ j ] ) );
+      if ( denominator > 1e-14 )
+      {
+      contribution += vcl_pow( enumerator / denominator, twoGamma );
+      }
+      }*/
 
-    /** Add the distances of all neighbours of the query point,
-    * for the three graphs:
-    * sum M / sqrt( sum F * sum M)
-    */
+      /** Add the distances of all neighbours of the query point,
+      * for the three graphs:
+      * sum M / sqrt( sum F * sum M)
+      */
 
-    /** Variables to compute the measure. */
-    AccumulateType Gamma_F = NumericTraits< AccumulateType >::Zero;
-    AccumulateType Gamma_M = NumericTraits< AccumulateType >::Zero;
-    AccumulateType Gamma_J = NumericTraits< AccumulateType >::Zero;
+      /** Variables to compute the measure. */
+      AccumulateType Gamma_F = NumericTraits< AccumulateType >::Zero;
+      AccumulateType Gamma_M = NumericTraits< AccumulateType >::Zero;
+      AccumulateType Gamma_J = NumericTraits< AccumulateType >::Zero;
 
-    /** Loop over the neighbours. */
-    for( unsigned int p = 0; p < k; p++ )
-    {
-      Gamma_F += vcl_sqrt( distances_F[ p ] );
-      Gamma_M += vcl_sqrt( distances_M[ p ] );
-      Gamma_J += vcl_sqrt( distances_J[ p ] );
-    } // end loop over the k neighbours
-
-    /** Calculate the contribution of this query point. */
-    H = vcl_sqrt( Gamma_F * Gamma_M );
-    if( H > this->m_AvoidDivisionBy )
-    {
-      /** Compute some sums. */
-      G     = Gamma_J / H;
-      sumG += vcl_pow( G, twoGamma );
-    }
-  } // end looping over all query points
+      /** Loop over the neighbours. */
+      for( unsigned int p = 0; p < k; p++ )
+      {
+        Gamma_F += vcl_sqrt( distances_F[ p ] );
+        Gamma_M += vcl_sqrt( distances_M[ p ] );
+        Gamma_J += vcl_sqrt( distances_J[ p ] );
+      } // end loop over the k neighbours
+
+      /** Calculate the contribution of this query point. */
+      H = vcl_sqrt( Gamma_F * Gamma_M );
+      if( H > this->m_AvoidDivisionBy )
+      {
+        /** Compute some sums. */
+        G     = Gamma_J / H;
+        sumG += vcl_pow( G, twoGamma );
+      }
+    } // end looping over all query points
+  }
 
   /**
    * *************** Finally, calculate the metric value \alpha MI ******************
@@ -561,25 +565,7 @@ KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
    * and connect them to the searchers.
    */
 
-  /** Generate the tree for the fixed image samples. */
-  this->m_BinaryKNNTreeFixed->SetSample( listSampleFixed );
-  this->m_BinaryKNNTreeFixed->GenerateTree();
-
-  /** Generate the tree for the moving image samples. */
-  this->m_BinaryKNNTreeMoving->SetSample( listSampleMoving );
-  this->m_BinaryKNNTreeMoving->GenerateTree();
-
-  /** Generate the tree for the joint image samples. */
-  this->m_BinaryKNNTreeJoint->SetSample( listSampleJoint );
-  this->m_BinaryKNNTreeJoint->GenerateTree();
-
-  /** Initialize tree searchers. */
-  this->m_BinaryKNNTreeSearcherFixed
-  ->SetBinaryTree( this->m_BinaryKNNTreeFixed );
-  this->m_BinaryKNNTreeSearcherMoving
-  ->SetBinaryTree( this->m_BinaryKNNTreeMoving );
-  this->m_BinaryKNNTreeSearcherJoint
-  ->SetBinaryTree( this->m_BinaryKNNTreeJoint );
+  this->GenerateTrees( listSampleFixed, listSampleMoving, listSampleJoint );
 
   /**
    * *************** Estimate the \alpha MI and its derivatives ******************
@@ -638,83 +624,98 @@ KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
   unsigned int k        = this->m_BinaryKNNTreeSearcherFixed->GetKNearestNeighbors();
   double       twoGamma = jointSize * ( 1.0 - this->m_Alpha );
 
-  /** Loop over all query points, i.e. all samples. */
-  for( unsigned long i = 0; i < this->m_NumberOfPixelsCounted; i++ )
+  if( this->m_UseMultiThread )
+  {
+    /** Distribute the query points over the threads. The per-thread
+     * contributions are combined to the derivative in
+     * AfterThreadedComputeGraphLengths().
+     */
+    this->LaunchComputeGraphLengthsThreaderCallback(
+      listSampleFixed, listSampleMoving, listSampleJoint,
+      true, jacobianContainer, jacobianIndicesContainer,
+      spatialDerivativesContainer );
+    sumG = this->AfterThreadedComputeGraphLengths( &derivative );
+  }
+  else
   {
-    /** Get the i-th query point. */
-    listSampleFixed->GetMeasurementVector(  i, z_F );
-    listSampleMoving->GetMeasurementVector( i, z_M );
-    listSampleJoint->GetMeasurementVector(  i, z_J );
+    /** Loop over all query points, i.e. all samples. */
+    for( unsigned long i = 0; i < this->m_NumberOfPixelsCounted; i++ )
+    {
+      /** Get the i-th query point. */
+      listSampleFixed->GetMeasurementVector(  i, z_F );
+      listSampleMoving->GetMeasurementVector( i, z_M );
+      listSampleJoint->GetMeasurementVector(  i, z_J );
 
-    /** Search for the k nearest neighbours of the current query point. */
-    this->m_BinaryKNNTreeSearcherFixed->Search(  z_F, indices_F, distances_F );
-    this->m_BinaryKNNTreeSearcherMoving->Search( z_M, indices_M, distances_M );
-    this->m_BinaryKNNTreeSearcherJoint->Search(  z_J, indices_J, distances_J );
+      /** Search for the k nearest neighbours of the current query point. */
+      this->m_BinaryKNNTreeSearcherFixed->Search(  z_F, indices_F, distances_F );
+      this->m_BinaryKNNTreeSearcherMoving->Search( z_M, indices_M, distances_M );
+      this->m_BinaryKNNTreeSearcherJoint->Search(  z_J, indices_J, distances_J );
 
-    /** Variables to compute the measure and its derivative. */
-    AccumulateType Gamma_F = NumericTraits< AccumulateType >::Zero;
-    AccumulateType Gamma_M = NumericTraits< AccumulateType >::Zero;
-    AccumulateType Gamma_J = NumericTraits< AccumulateType >::Zero;
+      /** Variables to compute the measure and its derivative. */
+      AccumulateType Gamma_F = NumericTraits< AccumulateType >::Zero;
+      AccumulateType Gamma_M = NumericTraits< AccumulateType >::Zero;
+      AccumulateType Gamma_J = NumericTraits< AccumulateType >::Zero;
 
-    SpatialDerivativeType D1sparse, D2sparse_M, D2sparse_J;
-    D1sparse = spatialDerivativesContainer[ i ] * jacobianContainer[ i ];
+      SpatialDerivativeType D1sparse, D2sparse_M, D2sparse_J;
+      D1sparse = spatialDerivativesContainer[ i ] * jacobianContainer[ i ];
 
-    dGamma_M.Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
-    dGamma_J.Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
+      dGamma_M.Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
+      dGamma_J.Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
 
-    /** Loop over the neighbours. */
-    for( unsigned int p = 0; p < k; p++ )
-    {
-      /** Get the neighbour point z_ip^M. */
-      listSampleMoving->GetMeasurementVector( indices_M[ p ], z_M_ip );
-      listSampleMoving->GetMeasurementVector( indices_J[ p ], z_J_ip );
-
-      /** Get the distances. */
-      distance_F = vcl_sqrt( distances_F[ p ] );
-      distance_M = vcl_sqrt( distances_M[ p ] );
-      distance_J = vcl_sqrt( distances_J[ p ] );
-
-      /** Compute Gamma's. */
-      Gamma_F += distance_F;
-      Gamma_M += distance_M;
-      Gamma_J += distance_J;
-
-      /** Get the difference of z_ip^M with z_i^M. */
-      diff_M = z_M - z_M_ip;
-      diff_J = z_M - z_J_ip;
-
-      /** Compute derivatives. */
-      D2sparse_M = spatialDerivativesContainer[ indices_M[ p ] ]
-        * jacobianContainer[ indices_M[ p ] ];
-      D2sparse_J = spatialDerivativesContainer[ indices_J[ p ] ]
-        * jacobianContainer[ indices_J[ p ] ];
-
-      /** Update the dGamma's. */
-      this->UpdateDerivativeOfGammas(
-        D1sparse, D2sparse_M, D2sparse_J,
-        jacobianIndicesContainer[ i ],
-        jacobianIndicesContainer[ indices_M[ p ] ],
-        jacobianIndicesContainer[ indices_J[ p ] ],
-        diff_M, diff_J,
-        distance_M, distance_J,
-        dGamma_M, dGamma_J );
-
-    } // end loop over the k neighbours
-
-    /** Compute contributions. */
-    H = vcl_sqrt( Gamma_F * Gamma_M );
-    if( H > this->m_AvoidDivisionBy )
-    {
-      /** Compute some sums. */
-      G     = Gamma_J / H;
-      sumG += vcl_pow( G, twoGamma );
+      /** Loop over the neighbours. */
+      for( unsigned int p = 0; p < k; p++ )
+      {
+        /** Get the neighbour point z_ip^M. */
+        listSampleMoving->GetMeasurementVector( indices_M[ p ], z_M_ip );
+        listSampleMoving->GetMeasurementVector( indices_J[ p ], z_J_ip );
+
+        /** Get the distances. */
+        distance_F = vcl_sqrt( distances_F[ p ] );
+        distance_M = vcl_sqrt( distances_M[ p ] );
+        distance_J = vcl_sqrt( distances_J[ p ] );
+
+        /** Compute Gamma's. */
+        Gamma_F += distance_F;
+        Gamma_M += distance_M;
+        Gamma_J += distance_J;
+
+        /** Get the difference of z_ip^M with z_i^M. */
+        diff_M = z_M - z_M_ip;
+        diff_J = z_M - z_J_ip;
+
+        /** Compute derivatives. */
+        D2sparse_M = spatialDerivativesContainer[ indices_M[ p ] ]
+          * jacobianContainer[ indices_M[ p ] ];
+        D2sparse_J = spatialDerivativesContainer[ indices_J[ p ] ]
+          * jacobianContainer[ indices_J[ p ] ];
+
+        /** Update the dGamma's. */
+        this->UpdateDerivativeOfGammas(
+          D1sparse, D2sparse_M, D2sparse_J,
+          jacobianIndicesContainer[ i ],
+          jacobianIndicesContainer[ indices_M[ p ] ],
+          jacobianIndicesContainer[ indices_J[ p ] ],
+          diff_M, diff_J,
+          distance_M, distance_J,
+          dGamma_M, dGamma_J );
+
+      } // end loop over the k neighbours
+
+      /** Compute contributions. */
+      H = vcl_sqrt( Gamma_F * Gamma_M );
+      if( H > this->m_AvoidDivisionBy )
+      {
+        /** Compute some sums. */
+        G     = Gamma_J / H;
+        sumG += vcl_pow( G, twoGamma );
 
-      /** Compute the contribution to the derivative. */
-      Gpow          = vcl_pow( G, twoGamma - 1.0 );
-      contribution += ( Gpow / H ) * ( dGamma_J - ( 0.5 * Gamma_J / Gamma_M ) * dGamma_M );
-    }
+        /** Compute the contribution to the derivative. */
+        Gpow          = vcl_pow( G, twoGamma - 1.0 );
+        contribution += ( Gpow / H ) * ( dGamma_J - ( 0.5 * Gamma_J / Gamma_M ) * dGamma_M );
+      }
 
-  } // end looping over all query points
+    } // end looping over all query points
+  }
 
   /**
    * *************** Finally, calculate the metric value and derivative ******************
@@ -729,14 +730,387 @@ KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
     number  = vcl_pow( n, this->m_Alpha );
     measure = vcl_log( sumG / number ) / ( this->m_Alpha - 1.0 );
 
-    /** Compute the derivative (-2.0 * d = -jointSize). */
-    derivative = ( static_cast< AccumulateType >( jointSize ) / sumG ) * contribution;
+    /** Compute the derivative (-2.0 * d = -jointSize). In the multi-threaded
+     * case this was done in AfterThreadedComputeGraphLengths().
+     */
+    if( !this->m_UseMultiThread )
+    {
+      derivative = ( static_cast< AccumulateType >( jointSize ) / sumG ) * contribution;
+    }
   }
   value = -measure;
 
 } // end GetValueAndDerivative()
 
 
+/**
+ * ************************ GenerateTrees *************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::GenerateTrees(
+  const ListSamplePointer & listSampleFixed,
+  const ListSamplePointer & listSampleMoving,
+  const ListSamplePointer & listSampleJoint ) const
+{
+  /** Set the samples to the trees. */
+  this->m_BinaryKNNTreeFixed->SetSample( listSampleFixed );
+  this->m_BinaryKNNTreeMoving->SetSample( listSampleMoving );
+  this->m_BinaryKNNTreeJoint->SetSample( listSampleJoint );
+
+  /** Generate the trees. The three trees are independent, so they can be
+   * constructed concurrently.
+   */
+  if( this->m_UseMultiThread )
+  {
+    this->ExecuteThreaderCallback( this->GenerateTreesThreaderCallback,
+      const_cast< void * >( static_cast< const void * >(
+        &this->m_KNNGraphAlphaMutualInformationThreaderParameters ) ) );
+  }
+  else
+  {
+    this->m_BinaryKNNTreeFixed->GenerateTree();
+    this->m_BinaryKNNTreeMoving->GenerateTree();
+    this->m_BinaryKNNTreeJoint->GenerateTree();
+  }
+
+  /** Initialize tree searchers. */
+  this->m_BinaryKNNTreeSearcherFixed
+  ->SetBinaryTree( this->m_BinaryKNNTreeFixed );
+  this->m_BinaryKNNTreeSearcherMoving
+  ->SetBinaryTree( this->m_BinaryKNNTreeMoving );
+  this->m_BinaryKNNTreeSearcherJoint
+  ->SetBinaryTree( this->m_BinaryKNNTreeJoint );
+
+} // end GenerateTrees()
+
+
+/**
+ * ******************* ThreadedGenerateTrees *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ThreadedGenerateTrees( ThreadIdType threadId )
+{
+  /** Thread threadId generates the trees threadId, threadId + nrOfThreads, etc. */
+  BinaryKNNTreeType * trees[ 3 ] = {
+    this->m_BinaryKNNTreeFixed.GetPointer(),
+    this->m_BinaryKNNTreeMoving.GetPointer(),
+    this->m_BinaryKNNTreeJoint.GetPointer() };
+
+  const ThreadIdType nrOfThreads = this->m_NumberOfThreads;
+  for( ThreadIdType t = threadId; t < 3; t += nrOfThreads )
+  {
+    trees[ t ]->GenerateTree();
+  }
+
+} // end ThreadedGenerateTrees()
+
+
+/**
+ * **************** GenerateTreesThreaderCallback *******
+ */
+
+template< class TFixedImage, class TMovingImage >
+ITK_THREAD_RETURN_TYPE
+KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::GenerateTreesThreaderCallback( void * arg )
+{
+  ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType     threadId   = infoStruct->ThreadID;
+
+  KNNGraphAlphaMutualInformationMultiThreaderParameterType * temp
+    = static_cast< KNNGraphAlphaMutualInformationMultiThreaderParameterType * >( infoStruct->UserData );
+
+  temp->m_Metric->ThreadedGenerateTrees( threadId );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end GenerateTreesThreaderCallback()
+
+
+/**
+ * ******************* ThreadedComputeGraphLengths *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ThreadedComputeGraphLengths( ThreadIdType threadId )
+{
+  /** Get the inputs of this call. */
+  const KNNGraphAlphaMutualInformationMultiThreaderParameterType & params
+    = this->m_KNNGraphAlphaMutualInformationThreaderParameters;
+  const ListSampleType *                        listSampleFixed             = params.st_ListSampleFixed;
+  const ListSampleType *                        listSampleMoving            = params.st_ListSampleMoving;
+  const ListSampleType *                        listSampleJoint             = params.st_ListSampleJoint;
+  const TransformJacobianContainerType &        jacobianContainer           = *params.st_JacobianContainer;
+  const TransformJacobianIndicesContainerType & jacobianIndicesContainer    = *params.st_JacobianIndicesContainer;
+  const SpatialDerivativeContainerType &        spatialDerivativesContainer = *params.st_SpatialDerivativesContainer;
+  const bool                                    doDerivative                = params.st_DoDerivative;
+
+  /** Temporary variables, private to this thread. */
+  typedef typename NumericTraits< MeasureType >::AccumulateType AccumulateType;
+  MeasurementVectorType z_F, z_M, z_J, z_M_ip, z_J_ip, diff_M, diff_J;
+  IndexArrayType        indices_F,   indices_M,   indices_J;
+  DistanceArrayType     distances_F, distances_M, distances_J;
+  MeasureType           distance_F,  distance_M,  distance_J;
+
+  MeasureType    H, G, Gpow;
+  AccumulateType sumG = NumericTraits< AccumulateType >::Zero;
+
+  /** Get a handle to the pre-allocated derivative for the current thread.
+   * The initialization is performed at the beginning of each resolution in
+   * InitializeThreadingParameters(), and at the end of each iteration in
+   * AfterThreadedComputeGraphLengths().
+   */
+  DerivativeType & contribution = this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_Derivative;
+  DerivativeType   dGamma_M, dGamma_J;
+  if( doDerivative )
+  {
+    dGamma_M.SetSize( this->GetNumberOfParameters() );
+    dGamma_J.SetSize( this->GetNumberOfParameters() );
+  }
+
+  /** Get the size of the feature vectors. */
+  unsigned int fixedSize  = this->GetNumberOfFixedImages();
+  unsigned int movingSize = this->GetNumberOfMovingImages();
+  unsigned int jointSize  = fixedSize + movingSize;
+
+  /** Get the number of neighbours and \gamma. */
+  unsigned int k        = this->m_BinaryKNNTreeSearcherFixed->GetKNearestNeighbors();
+  double       twoGamma = jointSize * ( 1.0 - this->m_Alpha );
+
+  /** The query points are handed out to this thread in one or more ranges
+   * [pos_begin, pos_end) by the sample scheduler.
+   */
+  SizeValueType pos_begin = 0;
+  SizeValueType pos_end   = 0;
+
+  /** Loop over the sample ranges assigned to this thread. */
+  while( this->GetNextSampleRange( threadId, pos_begin, pos_end ) )
+  {
+    /** Loop over the query points. */
+    for( SizeValueType i = pos_begin; i < pos_end; ++i )
+    {
+      /** Get the i-th query point. */
+      listSampleFixed->GetMeasurementVector(  i, z_F );
+      listSampleMoving->GetMeasurementVector( i, z_M );
+      listSampleJoint->GetMeasurementVector(  i, z_J );
+
+      /** Search for the k nearest neighbours of the current query point.
+       * The searchers are shared by the threads; the ANN search state is
+       * thread-local.
+       */
+      this->m_BinaryKNNTreeSearcherFixed->Search(  z_F, indices_F, distances_F );
+      this->m_BinaryKNNTreeSearcherMoving->Search( z_M, indices_M, distances_M );
+      this->m_BinaryKNNTreeSearcherJoint->Search(  z_J, indices_J, distances_J );
+
+      /** Variables to compute the measure and its derivative. */
+      AccumulateType Gamma_F = NumericTraits< AccumulateType >::Zero;
+      AccumulateType Gamma_M = NumericTraits< AccumulateType >::Zero;
+      AccumulateType Gamma_J = NumericTraits< AccumulateType >::Zero;
+
+      if( !doDerivative )
+      {
+        /** Loop over the neighbours. */
+        for( unsigned int p = 0; p < k; p++ )
+        {
+          Gamma_F += vcl_sqrt( distances_F[ p ] );
+          Gamma_M += vcl_sqrt( distances_M[ p ] );
+          Gamma_J += vcl_sqrt( distances_J[ p ] );
+        } // end loop over the k neighbours
+      }
+      else
+      {
+        SpatialDerivativeType D1sparse, D2sparse_M, D2sparse_J;
+        D1sparse = spatialDerivativesContainer[ i ] * jacobianContainer[ i ];
+
+        dGamma_M.Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
+        dGamma_J.Fill( NumericTraits< DerivativeValueType >::ZeroValue() );
+
+        /** Loop over the neighbours. */
+        for( unsigned int p = 0; p < k; p++ )
+        {
+          /** Get the neighbour point z_ip^M. */
+          listSampleMoving->GetMeasurementVector( indices_M[ p ], z_M_ip );
+          listSampleMoving->GetMeasurementVector( indices_J[ p ], z_J_ip );
+
+          /** Get the distances. */
+          distance_F = vcl_sqrt( distances_F[ p ] );
+          distance_M = vcl_sqrt( distances_M[ p ] );
+          distance_J = vcl_sqrt( distances_J[ p ] );
+
+          /** Compute Gamma's. */
+          Gamma_F += distance_F;
+          Gamma_M += distance_M;
+          Gamma_J += distance_J;
+
+          /** Get the difference of z_ip^M with z_i^M. */
+          diff_M = z_M - z_M_ip;
+          diff_J = z_M - z_J_ip;
+
+          /** Compute derivatives. */
+          D2sparse_M = spatialDerivativesContainer[ indices_M[ p ] ]
+            * jacobianContainer[ indices_M[ p ] ];
+          D2sparse_J = spatialDerivativesContainer[ indices_J[ p ] ]
+            * jacobianContainer[ indices_J[ p ] ];
+
+          /** Update the dGamma's. */
+          this->UpdateDerivativeOfGammas(
+            D1sparse, D2sparse_M, D2sparse_J,
+            jacobianIndicesContainer[ i ],
+            jacobianIndicesContainer[ indices_M[ p ] ],
+            jacobianIndicesContainer[ indices_J[ p ] ],
+            diff_M, diff_J,
+            distance_M, distance_J,
+            dGamma_M, dGamma_J );
+
+        } // end loop over the k neighbours
+      }
+
+      /** Compute contributions. */
+      H = vcl_sqrt( Gamma_F * Gamma_M );
+      if( H > this->m_AvoidDivisionBy )
+      {
+        /** Compute some sums. */
+        G     = Gamma_J / H;
+        sumG += vcl_pow( G, twoGamma );
+
+        /** Compute the contribution to the derivative. */
+        if( doDerivative )
+        {
+          Gpow          = vcl_pow( G, twoGamma - 1.0 );
+          contribution += ( Gpow / H ) * ( dGamma_J - ( 0.5 * Gamma_J / Gamma_M ) * dGamma_M );
+        }
+      }
+
+    } // end looping over the query points
+  } // end while loop over the sample ranges
+
+  /** Only update this variable at the end to avoid false sharing. */
+  this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_Value = sumG;
+
+} // end ThreadedComputeGraphLengths()
+
+
+/**
+ * **************** ComputeGraphLengthsThreaderCallback *******
+ */
+
+template< class TFixedImage, class TMovingImage >
+ITK_THREAD_RETURN_TYPE
+KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeGraphLengthsThreaderCallback( void * arg )
+{
+  ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType     threadId   = infoStruct->ThreadID;
+
+  KNNGraphAlphaMutualInformationMultiThreaderParameterType * temp
+    = static_cast< KNNGraphAlphaMutualInformationMultiThreaderParameterType * >( infoStruct->UserData );
+
+  temp->m_Metric->ThreadedComputeGraphLengths( threadId );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ComputeGraphLengthsThreaderCallback()
+
+
+/**
+ * *********************** LaunchComputeGraphLengthsThreaderCallback***************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::LaunchComputeGraphLengthsThreaderCallback(
+  const ListSamplePointer & listSampleFixed,
+  const ListSamplePointer & listSampleMoving,
+  const ListSamplePointer & listSampleJoint,
+  const bool & doDerivative,
+  const TransformJacobianContainerType & jacobianContainer,
+  const TransformJacobianIndicesContainerType & jacobianIndicesContainer,
+  const SpatialDerivativeContainerType & spatialDerivativesContainer ) const
+{
+  /** Pass the inputs of this call to the threads. */
+  KNNGraphAlphaMutualInformationMultiThreaderParameterType & params
+    = this->m_KNNGraphAlphaMutualInformationThreaderParameters;
+  params.st_ListSampleFixed             = listSampleFixed.GetPointer();
+  params.st_ListSampleMoving            = listSampleMoving.GetPointer();
+  params.st_ListSampleJoint             = listSampleJoint.GetPointer();
+  params.st_JacobianContainer           = &jacobianContainer;
+  params.st_JacobianIndicesContainer    = &jacobianIndicesContainer;
+  params.st_SpatialDerivativesContainer = &spatialDerivativesContainer;
+  params.st_DoDerivative                = doDerivative;
+
+  /** Distribute the query points over the threads. */
+  this->InitializeSampleScheduler( this->m_NumberOfPixelsCounted );
+
+  /** Setup threader and launch. */
+  this->ExecuteThreaderCallback( this->ComputeGraphLengthsThreaderCallback,
+    const_cast< void * >( static_cast< const void * >( &params ) ) );
+
+} // end LaunchComputeGraphLengthsThreaderCallback()
+
+
+/**
+ * ******************* AfterThreadedComputeGraphLengths *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+typename KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
+KNNGraphAlphaMutualInformationImageToImageMetric< TFixedImage, TMovingImage >
+::AfterThreadedComputeGraphLengths( DerivativeType * derivative ) const
+{
+  /** Accumulate sumG. */
+  MeasureType sumG = NumericTraits< MeasureType >::Zero;
+  for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
+  {
+    sumG += this->m_GetValueAndDerivativePerThreadVariables[ i ].st_Value;
+
+    /** Reset this variable for the next iteration. */
+    this->m_GetValueAndDerivativePerThreadVariables[ i ].st_Value = NumericTraits< MeasureType >::Zero;
+  }
+
+  if( derivative == 0 )
+  {
+    return sumG;
+  }
+
+  if( sumG > this->m_AvoidDivisionBy )
+  {
+    /** Accumulate the derivatives multi-threadedly, which also resets the
+     * per-thread derivatives for the next iteration. Dividing by
+     * sumG / jointSize computes ( jointSize / sumG ) * contribution.
+     */
+    const unsigned int jointSize
+      = this->GetNumberOfFixedImages() + this->GetNumberOfMovingImages();
+    this->m_ThreaderMetricParameters.st_DerivativePointer   = derivative->begin();
+    this->m_ThreaderMetricParameters.st_NormalizationFactor
+      = sumG / static_cast< DerivativeValueType >( jointSize );
+
+    this->ExecuteThreaderCallback( this->AccumulateDerivativesThreaderCallback,
+      const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ) );
+  }
+  else
+  {
+    /** The derivative remains zero; only reset the per-thread derivatives. */
+    for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
+    {
+      this->m_GetValueAndDerivativePerThreadVariables[ i ].st_Derivative.Fill(
+        NumericTraits< DerivativeValueType >::ZeroValue() );
+    }
+  }
+
+  return sumG;
+
+} // end AfterThreadedComputeGraphLengths()
+
+
 /**
  * ************************ ComputeListSampleValuesAndDerivativePlusJacobian *************************
  */
@@ -77,6 +77,16 @@ void
 NormalizedGradientCorrelationMetric< TElastix >
 ::BeforeEachResolution( void )
 {
+  /** Get the current resolution level. */
+  unsigned int level
+    = ( this->m_Registration->GetAsITKBaseType() )->GetCurrentLevel();
+
+  /** Set the finite difference scheme. */
+  bool useForwardDifferences = false;
+  this->m_Configuration->ReadParameter( useForwardDifferences,
+    "UseForwardDifferences", this->GetComponentLabel(), level, 0 );
+  this->SetUseForwardDifferences( useForwardDifferences );
+
   typedef typename elastix::OptimizerBase< TElastix >::ITKBaseType::ScalesType ScalesType;
   ScalesType scales = this->m_Elastix->GetElxOptimizerBase()->GetAsITKBaseType()->GetScales();
   this->SetScales( scales );
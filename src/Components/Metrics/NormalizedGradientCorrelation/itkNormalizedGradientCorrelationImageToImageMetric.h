@@ -23,7 +23,7 @@
 #include "itkNeighborhoodOperatorImageFilter.h"
 #include "itkPoint.h"
 #include "itkCastImageFilter.h"
-#include "itkResampleImageFilter.h"
+#include "itkRayCastResampleImageFilter.h"
 #include "itkOptimizer.h"
 #include "itkAdvancedCombinationTransform.h"
 #include "itkAdvancedRayCastInterpolateImageFunction.h"
@@ -99,7 +99,7 @@ public:
   typedef itk::Image< unsigned char,
     itkGetStaticConstMacro( FixedImageDimension ) >   MaskImageType;
   typedef typename MaskImageType::Pointer MaskImageTypePointer;
-  typedef itk::ResampleImageFilter<
+  typedef itk::RayCastResampleImageFilter<
     MovingImageType, TransformedMovingImageType >       TransformMovingImageFilterType;
   typedef typename TransformMovingImageFilterType::Pointer TransformMovingImageFilterPointer;
   typedef typename itk::AdvancedRayCastInterpolateImageFunction
@@ -152,6 +152,14 @@ public:
   itkSetMacro( DerivativeDelta, double );
   itkGetConstReferenceMacro( DerivativeDelta, double );
 
+  /** Set/Get whether the derivative is computed by forward differences
+   * instead of central differences. GetValueAndDerivative() then reuses
+   * the value at the current parameters, so that the moving image is
+   * rendered NumberOfParameters + 1 instead of 2 * NumberOfParameters + 1
+   * times. Default: false */
+  itkSetMacro( UseForwardDifferences, bool );
+  itkGetConstMacro( UseForwardDifferences, bool );
+
   /** Set the parameters defining the Transform. */
   void SetTransformParameters( const TransformParametersType & parameters ) const;
 
@@ -181,6 +189,7 @@ private:
 
   ScalesType                  m_Scales;
   double                      m_DerivativeDelta;
+  bool                        m_UseForwardDifferences;
   CombinationTransformPointer m_CombinationTransform;
 
   /** The mean of the moving image gradients. */
@@ -43,6 +43,7 @@ NormalizedGradientCorrelationImageToImageMetric< TFixedImage, TMovingImage >
   this->m_CombinationTransform       = CombinationTransformType::New();
   this->m_TransformMovingImageFilter = TransformMovingImageFilterType::New();
   this->m_DerivativeDelta            = 0.001;
+  this->m_UseForwardDifferences      = false;
 
   for( unsigned int iDimension = 0; iDimension < MovedImageDimension; iDimension++ )
   {
@@ -134,6 +135,7 @@ NormalizedGradientCorrelationImageToImageMetric< TFixedImage, TMovingImage >
 {
   Superclass::PrintSelf( os, indent );
   os << indent << "DerivativeDelta: " << this->m_DerivativeDelta << std::endl;
+  os << indent << "UseForwardDifferences: " << this->m_UseForwardDifferences << std::endl;
 } // end PrintSelf()
 
 
@@ -455,6 +457,12 @@ NormalizedGradientCorrelationImageToImageMetric< TFixedImage, TMovingImage >
   {
     itkExceptionMacro( << "Transform has not been assigned" );
   }
+
+  /** The parameters were already set by BeforeThreadedGetValueAndDerivative(). */
+  if( !this->m_UseMetricSingleThreaded )
+  {
+    return;
+  }
   this->m_Transform->SetParameters( parameters );
 
 } // end SetTransformParameters()
@@ -470,6 +478,14 @@ NormalizedGradientCorrelationImageToImageMetric< TFixedImage, TMovingImage >
 ::GetDerivative( const TransformParametersType & parameters,
   DerivativeType & derivative ) const
 {
+  /** Forward differences need the value at the current parameters. */
+  if( this->m_UseForwardDifferences )
+  {
+    MeasureType value = NumericTraits< MeasureType >::Zero;
+    this->GetValueAndDerivative( parameters, value, derivative );
+    return;
+  }
+
   TransformParametersType testPoint;
   testPoint = parameters;
   const unsigned int numberOfParameters = this->GetNumberOfParameters();
@@ -499,7 +515,26 @@ NormalizedGradientCorrelationImageToImageMetric< TFixedImage, TMovingImage >
   MeasureType & value, DerivativeType & derivative ) const
 {
   value = this->GetValue( parameters );
-  this->GetDerivative( parameters, derivative );
+  if( !this->m_UseForwardDifferences )
+  {
+    this->GetDerivative( parameters, derivative );
+    return;
+  }
+
+  /** Forward differences, reusing the value at the current parameters. */
+  TransformParametersType testPoint;
+  testPoint = parameters;
+  const unsigned int numberOfParameters = this->GetNumberOfParameters();
+  derivative = DerivativeType( numberOfParameters );
+
+  for( unsigned int i = 0; i < numberOfParameters; i++ )
+  {
+    const double delta = this->m_DerivativeDelta / vcl_sqrt( this->m_Scales[ i ] );
+    testPoint[ i ] += delta;
+    const MeasureType valuep1 = this->GetValue( testPoint );
+    derivative[ i ] = ( valuep1 - value ) / delta;
+    testPoint[ i ]  = parameters[ i ];
+  }
 
 } // end GetValueAndDerivative()
 
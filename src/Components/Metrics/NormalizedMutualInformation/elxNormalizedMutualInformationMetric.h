@@ -65,6 +65,15 @@ namespace elastix
  *    useful if you use high order B-spline interpolator for the moving image.\n
  *    example: <tt>(MovingLimitRangeRatio 0.001 0.01 0.01)</tt> \n
  *    The default value is 0.01. Can be given for each resolution, or for all resolutions at once.
+ * \parameter UseFastAndLowMemoryVersion: Switch between a version of
+ *    normalized mutual information that explicitly computes the derivatives of the
+ *    joint histogram to each transformation parameter (false) and a
+ *    version that loops twice over the samples instead (true). The second
+ *    version does not allocate the NumberOfFixedHistogramBins *
+ *    NumberOfMovingHistogramBins * number of parameters matrix, and both of its
+ *    loops over the samples run multi-threaded.\n
+ *    example: <tt>(UseFastAndLowMemoryVersion "false")</tt> \n
+ *    The default is "true". Can be given for each resolution, or for all resolutions at once.
  *
  * \sa ParzenWindowNormalizedMutualInformationImageToImageMetric
  * \ingroup Metrics
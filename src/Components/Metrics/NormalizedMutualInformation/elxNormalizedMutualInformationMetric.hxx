@@ -103,6 +103,12 @@ NormalizedMutualInformationMetric< TElastix >
   this->SetFixedKernelBSplineOrder( fixedKernelBSplineOrder );
   this->SetMovingKernelBSplineOrder( movingKernelBSplineOrder );
 
+  /** Set whether a low memory consumption should be used. */
+  bool useFastAndLowMemoryVersion = true;
+  this->GetConfiguration()->ReadParameter( useFastAndLowMemoryVersion,
+    "UseFastAndLowMemoryVersion", this->GetComponentLabel(), level, 0 );
+  this->SetUseExplicitPDFDerivatives( !useFastAndLowMemoryVersion );
+
 } // end BeforeEachResolution()
 
 
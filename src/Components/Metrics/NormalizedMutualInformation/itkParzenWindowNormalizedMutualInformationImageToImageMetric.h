@@ -21,6 +21,8 @@
 
 #include "itkParzenWindowHistogramImageToImageMetric.h"
 
+#include "itkArray2D.h"
+
 namespace itk
 {
 
@@ -39,6 +41,13 @@ namespace itk
  * Construction of the PDFs is implemented in the superclass
  * ParzenWindowHistogramImageToImageMetric.
  *
+ * Like the ParzenWindowMutualInformationImageToImageMetric, this class
+ * offers a low memory variant of the derivative computation, which is
+ * selected with SetUseExplicitPDFDerivatives( false ). It does not store the
+ * joint histogram derivative, but loops twice over the samples: once to
+ * construct the joint histogram, and once to compute the derivative. Both
+ * loops run multi-threaded when UseMultiThread is true.
+ *
  * This implementation of the NormalizedMutualInformation is based on the
  * AdvancedImageToImageMetric, which means that:
  * \li It uses the ImageSampler-framework
@@ -104,6 +113,7 @@ public:
   typedef typename Superclass::OutputPointType            OutputPointType;
   typedef typename Superclass::TransformParametersType    TransformParametersType;
   typedef typename Superclass::TransformJacobianType      TransformJacobianType;
+  typedef typename Superclass::NumberOfParametersType     NumberOfParametersType;
   typedef typename Superclass::InterpolatorType           InterpolatorType;
   typedef typename Superclass::InterpolatorPointer        InterpolatorPointer;
   typedef typename Superclass::RealType                   RealType;
@@ -118,6 +128,7 @@ public:
   typedef typename Superclass::MovingImageMaskPointer     MovingImageMaskPointer;
   typedef typename Superclass::MeasureType                MeasureType;
   typedef typename Superclass::DerivativeType             DerivativeType;
+  typedef typename Superclass::DerivativeValueType        DerivativeValueType;
   typedef typename Superclass::ParametersType             ParametersType;
   typedef typename Superclass::FixedImagePixelType        FixedImagePixelType;
   typedef typename Superclass::MovingImageRegionType      MovingImageRegionType;
@@ -134,6 +145,8 @@ public:
     Superclass::MovingImageLimiterOutputType MovingImageLimiterOutputType;
   typedef typename
     Superclass::MovingImageDerivativeScalesType MovingImageDerivativeScalesType;
+  typedef typename Superclass::ThreaderType   ThreaderType;
+  typedef typename Superclass::ThreadInfoType ThreadInfoType;
 
   /** The fixed image dimension. */
   itkStaticConstMacro( FixedImageDimension, unsigned int,
@@ -146,14 +159,16 @@ public:
   /**  Get the value: the negative normalized mutual information. */
   MeasureType GetValue( const ParametersType & parameters ) const;
 
-  /**  Get the value and derivatives for single valued optimizers. */
+  /**  Get the value and derivatives for single valued optimizers.
+   * Uses the low memory variant if UseExplicitPDFDerivatives == false.
+   */
   void GetValueAndDerivative( const ParametersType & parameters,
     MeasureType & Value, DerivativeType & Derivative ) const;
 
 protected:
 
   /** The constructor. */
-  ParzenWindowNormalizedMutualInformationImageToImageMetric() {}
+  ParzenWindowNormalizedMutualInformationImageToImageMetric();
 
   /** The destructor. */
   virtual ~ParzenWindowNormalizedMutualInformationImageToImageMetric() {}
@@ -200,6 +215,40 @@ protected:
    */
   virtual MeasureType ComputeNormalizedMutualInformation( MeasureType & jointEntropy ) const;
 
+  /** Some initialization functions, called by Initialize. */
+  virtual void InitializeHistograms( void );
+
+  /** Get the value and analytic derivative.
+   * Called by GetValueAndDerivative if UseExplicitPDFDerivatives == false.
+   *
+   * Implements a version that avoids the large memory allocation of the
+   * explicit joint histogram derivative. This comes at the cost of looping
+   * over the samples twice, instead of once.
+   */
+  virtual void GetValueAndAnalyticDerivativeLowMemory(
+    const ParametersType & parameters,
+    MeasureType & value, DerivativeType & derivative ) const;
+
+  /** Threading related parameters. */
+  struct ParzenWindowNormalizedMutualInformationMultiThreaderParameterType
+  {
+    Self * m_Metric;
+  };
+  ParzenWindowNormalizedMutualInformationMultiThreaderParameterType m_ParzenWindowNormalizedMutualInformationThreaderParameters;
+
+  /** Multi-threaded version of the low memory derivative computation. */
+  inline void ThreadedComputeDerivativeLowMemory( ThreadIdType threadId );
+
+  /** Accumulate the derivatives of all threads. */
+  inline void AfterThreadedComputeDerivativeLowMemory(
+    DerivativeType & derivative ) const;
+
+  /** Helper function to launch the threads. */
+  static ITK_THREAD_RETURN_TYPE ComputeDerivativeLowMemoryThreaderCallback( void * arg );
+
+  /** Helper function to launch the threads. */
+  void LaunchComputeDerivativeLowMemoryThreaderCallback( void ) const;
+
 private:
 
   /** The private constructor. */
@@ -207,6 +256,29 @@ private:
   /** The private copy constructor. */
   void operator=( const Self & );                               // purposely not implemented
 
+  /** Helper array for storing the values of the JointPDF ratios. */
+  typedef double                PRatioType;
+  typedef Array2D< PRatioType > PRatioArrayType;
+  mutable PRatioArrayType m_PRatioArray;
+
+  /** Helper functions to compute the derivative for the low memory variant. */
+  void ComputeDerivativeLowMemorySingleThreaded( DerivativeType & derivative ) const;
+
+  void ComputeDerivativeLowMemory( DerivativeType & derivative ) const;
+
+  /** Helper function to update the derivative for the low memory variant. */
+  void UpdateDerivativeLowMemory(
+    const RealType & fixedImageValue,
+    const RealType & movingImageValue,
+    const DerivativeType & imageJacobian,
+    const NonZeroJacobianIndicesType & nzji,
+    DerivativeType & derivative ) const;
+
+  /** Helper function to compute m_PRatioArray in case of low memory consumption.
+   * Assumes the marginal pdfs are already log'ed.
+   */
+  void ComputePRatioArray( const double nMI, const double jointEntropy ) const;
+
 };
 
 } // end namespace itk
@@ -29,6 +29,14 @@ namespace elastix
  * \class PatternIntensityMetric
  * \brief An metric based on the itk::PatternIntensityImageToImageMetric.
  *
+ * The parameters used in this class are:
+ * \parameter Metric: Select this metric as follows:\n
+ *    <tt>(Metric "PatternIntensity")</tt>
+ * \parameter UseForwardDifferences: Compute the derivative by forward instead of central
+ *    differences, which reuses the rendering at the current parameters and saves
+ *    NumberOfParameters renderings of the moving image per iteration. \n
+ *    example: <tt>(UseForwardDifferences "true")</tt> \n
+ *    Default: "false". Can be specified for each resolution.\n
  *
  * \ingroup Metrics
  *
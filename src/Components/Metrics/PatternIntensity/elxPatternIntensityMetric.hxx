@@ -93,6 +93,12 @@ PatternIntensityMetric< TElastix >
     "OptimizeNormalizationFactor", this->GetComponentLabel(), level, 0 );
   this->SetOptimizeNormalizationFactor( optimizenormalizationfactor );
 
+  /** Set the finite difference scheme. */
+  bool useForwardDifferences = false;
+  this->m_Configuration->ReadParameter( useForwardDifferences,
+    "UseForwardDifferences", this->GetComponentLabel(), level, 0 );
+  this->SetUseForwardDifferences( useForwardDifferences );
+
   typedef typename elastix::OptimizerBase< TElastix >::ITKBaseType::ScalesType ScalesType;
   ScalesType scales = this->m_Elastix->GetElxOptimizerBase()->GetAsITKBaseType()->GetScales();
   this->SetScales( scales );
@@ -22,7 +22,7 @@
 
 #include "itkPoint.h"
 #include "itkCastImageFilter.h"
-#include "itkResampleImageFilter.h"
+#include "itkRayCastResampleImageFilter.h"
 #include "itkMultiplyImageFilter.h"
 #include "itkSubtractImageFilter.h"
 #include "itkOptimizer.h"
@@ -122,7 +122,7 @@ public:
   typedef typename itk::AdvancedRayCastInterpolateImageFunction<
     MovingImageType, ScalarType >                         RayCastInterpolatorType;
   typedef typename RayCastInterpolatorType::Pointer RayCastInterpolatorPointer;
-  typedef itk::ResampleImageFilter<
+  typedef itk::RayCastResampleImageFilter<
     MovingImageType, TransformedMovingImageType >         TransformMovingImageFilterType;
   typedef typename TransformMovingImageFilterType::Pointer TransformMovingImageFilterPointer;
   typedef itk::RescaleIntensityImageFilter<
@@ -174,6 +174,14 @@ public:
   itkSetMacro( OptimizeNormalizationFactor, bool );
   itkGetConstReferenceMacro( OptimizeNormalizationFactor, bool );
 
+  /** Set/Get whether the derivative is computed by forward differences
+   * instead of central differences. GetValueAndDerivative() then reuses
+   * the value at the current parameters, so that the moving image is
+   * rendered NumberOfParameters + 1 instead of 2 * NumberOfParameters + 1
+   * times. Default: false */
+  itkSetMacro( UseForwardDifferences, bool );
+  itkGetConstMacro( UseForwardDifferences, bool );
+
 protected:
 
   PatternIntensityImageToImageMetric();
@@ -198,6 +206,7 @@ private:
   double                             m_NoiseConstant;
   unsigned int                       m_NeighborhoodRadius;
   double                             m_DerivativeDelta;
+  bool                               m_UseForwardDifferences;
   double                             m_NormalizationFactor;
   double                             m_Rescalingfactor;
   bool                               m_OptimizeNormalizationFactor;
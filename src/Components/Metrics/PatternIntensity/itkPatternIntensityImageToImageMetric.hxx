@@ -41,6 +41,7 @@ PatternIntensityImageToImageMetric< TFixedImage, TMovingImage >
   this->m_NormalizationFactor         = 1.0;
   this->m_Rescalingfactor             = 1.0;
   this->m_DerivativeDelta             = 0.001;
+  this->m_UseForwardDifferences       = false;
   this->m_NoiseConstant               = 10000; // = sigma * sigma = 100*100 if not specified
   this->m_NeighborhoodRadius          = 3;
   this->m_FixedMeasure                = 0;
@@ -128,6 +129,7 @@ PatternIntensityImageToImageMetric< TFixedImage, TMovingImage >
 {
   Superclass::PrintSelf( os, indent );
   os << indent << "DerivativeDelta: " << this->m_DerivativeDelta << std::endl;
+  os << indent << "UseForwardDifferences: " << this->m_UseForwardDifferences << std::endl;
 
 } // end PrintSelf()
 
@@ -250,7 +252,8 @@ PatternIntensityImageToImageMetric< TFixedImage, TMovingImage >
   this->BeforeThreadedGetValueAndDerivative( parameters );
   //this->SetTransformParameters( parameters );
 
-  this->m_TransformMovingImageFilter->Modified();
+  /** GetValue() has already rendered the moving image at these parameters,
+   * so only the multiplication and the difference are updated here. */
   this->m_MultiplyImageFilter->SetConstant( scalingfactor );
   this->m_DifferenceImageFilter->UpdateLargestPossibleRegion();
   MeasureType measure = NumericTraits< MeasureType >::Zero;
@@ -410,6 +413,14 @@ PatternIntensityImageToImageMetric< TFixedImage, TMovingImage >
 ::GetDerivative( const TransformParametersType & parameters,
   DerivativeType & derivative ) const
 {
+  /** Forward differences need the value at the current parameters. */
+  if( this->m_UseForwardDifferences )
+  {
+    MeasureType value = NumericTraits< MeasureType >::Zero;
+    this->GetValueAndDerivative( parameters, value, derivative );
+    return;
+  }
+
   TransformParametersType testPoint;
   testPoint = parameters;
   const unsigned int numberOfParameters = this->GetNumberOfParameters();
@@ -439,7 +450,26 @@ PatternIntensityImageToImageMetric< TFixedImage, TMovingImage >
   MeasureType & Value, DerivativeType & derivative ) const
 {
   Value = this->GetValue( parameters );
-  this->GetDerivative( parameters, derivative );
+  if( !this->m_UseForwardDifferences )
+  {
+    this->GetDerivative( parameters, derivative );
+    return;
+  }
+
+  /** Forward differences, reusing the value at the current parameters. */
+  TransformParametersType testPoint;
+  testPoint = parameters;
+  const unsigned int numberOfParameters = this->GetNumberOfParameters();
+  derivative = DerivativeType( numberOfParameters );
+
+  for( unsigned int i = 0; i < numberOfParameters; i++ )
+  {
+    const double delta = this->m_DerivativeDelta / vcl_sqrt( this->m_Scales[ i ] );
+    testPoint[ i ] += delta;
+    const MeasureType valuep1 = this->GetValue( testPoint );
+    derivative[ i ] = ( valuep1 - Value ) / delta;
+    testPoint[ i ]  = parameters[ i ];
+  }
 
 } // end GetValueAndDerivative()
 
@@ -122,6 +122,8 @@ public:
   typedef typename Superclass::ImageSampleContainerType     ImageSampleContainerType;
   typedef typename Superclass::ImageSampleContainerPointer  ImageSampleContainerPointer;
   typedef typename Superclass::ScalarType                   ScalarType;
+  typedef typename Superclass::ThreaderType                 ThreaderType;
+  typedef typename Superclass::ThreadInfoType               ThreadInfoType;
 
   /** Typedefs from the AdvancedTransform. */
   typedef typename Superclass::SpatialJacobianType SpatialJacobianType;
@@ -194,7 +196,17 @@ public:
   virtual void BeforeThreadedGetValueAndDerivative(
     const TransformParametersType & parameters ) const;
 
-  /** The GetValueAndDerivative()-method returns the rigid penalty value and its derivative. */
+  /** The GetValueAndDerivativeSingleThreaded()-method returns the rigid penalty value and its derivative. */
+  virtual void GetValueAndDerivativeSingleThreaded(
+    const ParametersType & parameters,
+    MeasureType & value,
+    DerivativeType & derivative ) const;
+
+  /** The GetValueAndDerivative()-method returns the rigid penalty value and its derivative.
+   * The multi-threaded version fuses the separable filter passes into a single
+   * stencil per B-spline coefficient, and only visits the region where the
+   * rigidity coefficients are nonzero.
+   */
   virtual void GetValueAndDerivative(
     const ParametersType & parameters,
     MeasureType & value,
@@ -300,6 +312,43 @@ protected:
   /** PrintSelf. */
   void PrintSelf( std::ostream & os, Indent indent ) const;
 
+  /** Threading related parameters. */
+  struct TransformRigidityPenaltyTermMultiThreaderParameterType
+  {
+    Self *                  m_Metric;
+    RigidityImageRegionType st_ActiveRegion;
+    RigidityImageRegionType st_DilatedActiveRegion;
+    ScalarType              st_RigidityCoefficientSum;
+    DerivativeValueType *   st_DerivativePointer;
+    bool                    st_UseOperator[ 9 ];
+    ScalarType              st_Operators1D[ 9 ][ 3 ][ 3 ];
+    ScalarType              st_OperatorsND[ 9 ][ 27 ];
+  };
+  mutable TransformRigidityPenaltyTermMultiThreaderParameterType m_TransformRigidityPenaltyTermThreaderParameters;
+
+  /** The values and gradient magnitudes computed by each thread. */
+  struct TransformRigidityPenaltyTermPerThreadStruct
+  {
+    MeasureType st_LinearityConditionValue;
+    MeasureType st_OrthonormalityConditionValue;
+    MeasureType st_PropernessConditionValue;
+    MeasureType st_LinearityConditionGradientMagnitude;
+    MeasureType st_OrthonormalityConditionGradientMagnitude;
+    MeasureType st_PropernessConditionGradientMagnitude;
+  };
+  mutable std::vector< TransformRigidityPenaltyTermPerThreadStruct > m_TransformRigidityPenaltyTermPerThreadVariables;
+
+  /** Compute the orthonormality, properness and linearity parts for each thread. */
+  inline void ThreadedComputeConditionParts( ThreadIdType threadId );
+
+  /** Filter the parts and compute the derivative for each thread. */
+  inline void ThreadedComputeDerivative( ThreadIdType threadId );
+
+  /** Helper functions to launch the threads. */
+  static ITK_THREAD_RETURN_TYPE ComputeConditionPartsThreaderCallback( void * arg );
+
+  static ITK_THREAD_RETURN_TYPE ComputeDerivativeThreaderCallback( void * arg );
+
 private:
 
   /** The private constructor. */
@@ -322,6 +371,28 @@ private:
   CoefficientImagePointer FilterSeparable( const CoefficientImageType *,
     const std::vector< NeighborhoodType > & Operators ) const;
 
+  /** Private functions computing the value and the derivative parts of the
+   * orthonormality and properness conditions from the filtered coefficients
+   * mu_A, mu_B and mu_C. The returned value is not multiplied by the rigidity
+   * coefficient. In 2D the third elements are ignored.
+   */
+  MeasureType ComputeOrthonormalityConditionParts(
+    const ScalarType mu_A[ 3 ], const ScalarType mu_B[ 3 ], const ScalarType mu_C[ 3 ],
+    ScalarType parts[ 3 ][ 3 ] ) const;
+
+  MeasureType ComputePropernessConditionParts(
+    const ScalarType mu_A[ 3 ], const ScalarType mu_B[ 3 ], const ScalarType mu_C[ 3 ],
+    ScalarType parts[ 3 ][ 3 ] ) const;
+
+  /** Private function that allocates the condition parts used by the
+   * multi-threaded GetValueAndDerivative(), if the grid has changed.
+   */
+  void InitializeConditionParts( const RigidityImageRegionType & region ) const;
+
+  /** Private function that splits a region along the last dimension. */
+  bool GetThreadRegion( const RigidityImageRegionType & region,
+    const ThreadIdType threadId, RigidityImageRegionType & threadRegion ) const;
+
   /** Member variables. */
   BSplineTransformPointer m_BSplineTransform;
   ScalarType              m_LinearityConditionWeight;
@@ -357,6 +428,11 @@ private:
   bool                               m_UseFixedRigidityImage;
   bool                               m_UseMovingRigidityImage;
 
+  /** The orthonormality, properness and linearity parts, reused across iterations. */
+  mutable std::vector< CoefficientImagePointer > m_OrthonormalityConditionParts;
+  mutable std::vector< CoefficientImagePointer > m_PropernessConditionParts;
+  mutable std::vector< CoefficientImagePointer > m_LinearityConditionParts;
+
 };
 
 } // end namespace itk
@@ -22,6 +22,8 @@
 
 #include "itkZeroFluxNeumannBoundaryCondition.h"
 
+#include <algorithm>
+
 namespace itk
 {
 
@@ -87,6 +89,9 @@ TransformRigidityPenaltyTerm< TFixedImage, TScalarType >
 
   this->m_BSplineTransform = NULL;
 
+  /** Initialize the threader parameters. */
+  this->m_TransformRigidityPenaltyTermThreaderParameters.m_Metric = this;
+
 } // end Constructor
 
 
@@ -346,8 +351,13 @@ TransformRigidityPenaltyTerm< TFixedImage, TScalarType >
     return;
   }
 
-  /** Make sure that the transform is up to date. */
-  this->m_Transform->SetParameters( parameters );
+  /** Make sure that the transform is up to date, unless this was already
+   * done by BeforeThreadedGetValueAndDerivative().
+   */
+  if( this->m_UseMetricSingleThreaded )
+  {
+    this->m_Transform->SetParameters( parameters );
+  }
 
   /** Create and reset an iterator over m_RigidityCoefficientImage. */
   RigidityImageIteratorType it( this->m_RigidityCoefficientImage,
@@ -935,13 +945,13 @@ TransformRigidityPenaltyTerm< TFixedImage, TScalarType >
 
 
 /**
- * *********************** GetValueAndDerivative ****************
+ * *********************** GetValueAndDerivativeSingleThreaded ****************
  */
 
 template< class TFixedImage, class TScalarType >
 void
 TransformRigidityPenaltyTerm< TFixedImage, TScalarType >
-::GetValueAndDerivative( const ParametersType & parameters,
+::GetValueAndDerivativeSingleThreaded( const ParametersType & parameters,
   MeasureType & value, DerivativeType & derivative ) const
 {
   /** Fill the rigidity image based on the current transform parameters. */
@@ -1195,231 +1205,29 @@ TransformRigidityPenaltyTerm< TFixedImage, TScalarType >
 
   if( this->m_CalculateOrthonormalityCondition )
   {
-    ScalarType mu1_A, mu2_A, mu3_A, mu1_B, mu2_B, mu3_B, mu1_C, mu2_C, mu3_C;
-    ScalarType valueOC;
+    ScalarType mu_A[ 3 ] = { 0.0, 0.0, 0.0 };
+    ScalarType mu_B[ 3 ] = { 0.0, 0.0, 0.0 };
+    ScalarType mu_C[ 3 ] = { 0.0, 0.0, 0.0 };
+    ScalarType partsOC[ 3 ][ 3 ];
     while( !itOCp[ 0 ][ 0 ].IsAtEnd() )
     {
-      /** Copy values: this way we avoid calling Get() so many times.
-       * It also improves code readability.
-       */
-      mu1_A = itA[ 0 ].Get(); mu2_A = itA[ 1 ].Get();
-      mu1_B = itB[ 0 ].Get(); mu2_B = itB[ 1 ].Get();
-      if( ImageDimension == 3 )
+      /** Copy values: this way we avoid calling Get() so many times. */
+      for( unsigned int i = 0; i < ImageDimension; i++ )
       {
-        mu3_A = itA[ 2 ].Get(); mu3_B = itB[ 2 ].Get();
-        mu1_C = itC[ 0 ].Get(); mu2_C = itC[ 1 ].Get(); mu3_C = itC[ 2 ].Get();
+        mu_A[ i ] = itA[ i ].Get(); mu_B[ i ] = itB[ i ].Get();
+        if( ImageDimension == 3 ) { mu_C[ i ] = itC[ i ].Get(); }
       }
-      if( ImageDimension == 2 )
-      {
-        /** Calculate the value of the orthonormality condition. */
-        this->m_OrthonormalityConditionValue
-          += it_RCI.Get() * (
-          vcl_pow(
-          +( 1.0 + mu1_A ) * ( 1.0 + mu1_A )
-          + mu2_A * mu2_A
-          - 1.0,
-          2.0 )
-          + vcl_pow(
-          +mu1_B * mu1_B
-          + ( 1.0 + mu2_B ) * ( 1.0 + mu2_B )
-          - 1.0,
-          2.0 )
-          + vcl_pow(
-          +( 1.0 + mu1_A ) * mu1_B
-          + mu2_A * ( 1.0 + mu2_B ),
-          2.0 )
-          );
-        /** Calculate the derivative of the orthonormality condition. */
-        /** mu1, part 1 */
-        valueOC
-          = +2.0 * ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * ( 1.0 + mu1_A )
-          + 2.0 * mu2_A * mu2_A * ( 1.0 + mu1_A )
-          - 2.0 * ( 1.0 + mu1_A )
-          + mu1_B * mu1_B * ( 1.0 + mu1_A )
-          + mu2_A * ( 1.0 + mu2_B ) * mu1_B;
-        itOCp[ 0 ][ 0 ].Set( 2.0 * valueOC );
-        /** mu1, part2*/
-        valueOC
-          = +mu1_B * ( 1.0 + mu1_A ) * ( 1.0 + mu1_A )
-          + mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu1_A )
-          + 2.0 * mu1_B * mu1_B * mu1_B
-          + 2.0 * mu1_B * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B )
-          - 2.0 * mu1_B;
-        itOCp[ 0 ][ 1 ].Set( 2.0 * valueOC );
-        /** mu2, part 1 */
-        valueOC
-          = +2.0 * mu2_A * mu2_A * mu2_A
-          + 2.0 * mu2_A * ( 1.0 + mu1_A ) * ( 1.0 + mu1_A )
-          - 2.0 * mu2_A
-          + mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B )
-          + mu1_B * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B );
-        itOCp[ 1 ][ 0 ].Set( 2.0 * valueOC );
-        /** mu2, part2*/
-        valueOC
-          = +mu2_A * mu2_A * ( 1.0 + mu2_B )
-          + mu1_B * ( 1.0 + mu1_A ) * mu2_A
-          + 2.0 * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B )
-          + 2.0 * mu1_B * mu1_B * ( 1.0 + mu2_B )
-          - 2.0 * ( 1.0 + mu2_B );
-        itOCp[ 1 ][ 1 ].Set( 2.0 * valueOC );
-      } // end if dim == 2
-      else if( ImageDimension == 3 )
+
+      /** Calculate the value and the derivative parts of the orthonormality condition. */
+      this->m_OrthonormalityConditionValue
+        += it_RCI.Get() * this->ComputeOrthonormalityConditionParts( mu_A, mu_B, mu_C, partsOC );
+      for( unsigned int i = 0; i < ImageDimension; i++ )
       {
-        /** Calculate the value of the orthonormality condition. */
-        this->m_OrthonormalityConditionValue
-          += it_RCI.Get() * (
-          vcl_pow(
-          +( 1.0 + mu1_A ) * ( 1.0 + mu1_A )
-          + mu2_A * mu2_A
-          + mu3_A * mu3_A
-          - 1.0,
-          2.0 )
-          + vcl_pow(
-          +( 1.0 + mu1_A ) * mu1_B
-          + mu2_A * ( 1.0 + mu2_B )
-          + mu3_A * mu3_B,
-          2.0 )
-          + vcl_pow(
-          +( 1.0 + mu1_A ) * mu1_C
-          + mu2_A * mu2_C
-          + mu3_A * ( 1.0 + mu3_C ),
-          2.0 )
-          + vcl_pow(
-          +mu1_B * mu1_B
-          + ( 1.0 + mu2_B ) * ( 1.0 + mu2_B )
-          + mu3_B * mu3_B
-          - 1.0,
-          2.0 )
-          + vcl_pow(
-          +mu1_B * mu1_C
-          + ( 1.0 + mu2_B ) * mu2_C
-          + mu3_B * ( 1.0 + mu3_C ),
-          2.0 )
-          + vcl_pow(
-          +mu1_C * mu1_C
-          + mu2_C * mu2_C
-          + ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
-          - 1.0,
-          2.0 ) );
-        /** Calculate the derivative of the orthonormality condition. */
-        /** mu1, part 1 */
-        valueOC
-          = +2.0 * ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * ( 1.0 + mu1_A )
-          + 2.0 * mu2_A * mu2_A * ( 1.0 + mu1_A )
-          + 2.0 * ( 1.0 + mu1_A ) * mu3_A * mu3_A
-          - 2.0 * ( 1.0 + mu1_A )
-          + mu1_B * mu1_B * ( 1.0 + mu1_A )
-          + mu2_A * ( 1.0 + mu2_B ) * mu1_B
-          + mu1_B * mu3_A * mu3_B
-          + ( 1.0 + mu1_A ) * mu1_C * mu1_C
-          + mu1_C * mu2_A * mu2_C
-          + mu1_C * mu3_A * ( 1.0 + mu3_C );
-        itOCp[ 0 ][ 0 ].Set( 2.0 * valueOC );
-        /** mu1, part2 */
-        valueOC
-          = +( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * mu1_B
-          + ( 1.0 + mu1_A ) * mu2_A * mu3_B
-          + ( 1.0 + mu1_A ) * mu3_A * mu3_B
-          + mu1_B * mu1_B * mu1_B
-          + mu1_B * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B )
-          + mu1_B * mu3_B * mu3_B
-          - mu1_B
-          + mu1_B * mu1_C * mu1_C
-          + mu1_C * ( 1.0 + mu2_B ) * mu2_C
-          + mu1_C * mu3_B * ( 1.0 + mu3_C );
-        itOCp[ 0 ][ 1 ].Set( 2.0 * valueOC );
-        /** mu1, part3 */
-        valueOC
-          = +( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * mu1_C
-          + ( 1.0 + mu1_A ) * mu2_A * mu2_C
-          + ( 1.0 + mu1_A ) * mu3_A * ( 1.0 + mu3_C )
-          + mu1_B * mu1_B * mu1_C
-          + mu1_B * ( 1.0 + mu2_B ) * mu2_C
-          + mu1_B * mu3_B * ( 1.0 + mu3_C )
-          + 2.0 * mu1_C * mu1_C * mu1_C
-          + 2.0 * mu1_C * mu2_C * mu2_C
-          + 2.0 * mu1_C * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
-          - 2.0 * mu1_C;
-        itOCp[ 0 ][ 2 ].Set( 2.0 * valueOC );
-        /** mu2, part 1 */
-        valueOC
-          = +2.0 * mu2_A * mu2_A * mu2_A
-          + 2.0 * mu2_A * ( 1.0 + mu1_A ) * ( 1.0 + mu1_A )
-          - 2.0 * mu2_A
-          + 2.0 * mu2_A * mu3_A * mu3_A
-          + mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B )
-          + mu1_B * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B )
-          + ( 1.0 + mu2_B ) * mu3_A * mu3_B
-          + mu2_A * mu2_C * mu2_C
-          + ( 1.0 + mu1_A ) * mu1_C * mu2_C
-          + mu2_C * mu3_A * ( 1.0 + mu3_C );
-        itOCp[ 1 ][ 0 ].Set( 2.0 * valueOC );
-        /** mu2, part2 */
-        valueOC
-          = +mu2_A * mu2_A * ( 1.0 + mu2_B )
-          + mu1_B * ( 1.0 + mu1_A ) * mu2_A
-          + mu2_A * mu3_A * mu3_B
-          + 2.0 * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B )
-          + 2.0 * mu1_B * mu1_B * ( 1.0 + mu2_B )
-          - 2.0 * ( 1.0 + mu2_B )
-          + 2.0 * ( 1.0 + mu2_B ) * mu3_B * mu3_B
-          + ( 1.0 + mu2_B ) * mu2_C * mu2_C
-          + mu1_B * mu1_C * mu2_C
-          + mu2_C * mu3_B * ( 1.0 + mu3_C );
-        itOCp[ 1 ][ 1 ].Set( 2.0 * valueOC );
-        /** mu2, part 3 */
-        valueOC
-          = +mu2_A * mu2_A * mu2_C
-          + ( 1.0 + mu1_A ) * mu1_C * mu2_A
-          + mu2_A * mu3_A * ( 1.0 + mu3_C )
-          + ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * mu2_C
-          + mu1_B * mu1_C * mu2_B
-          + ( 1.0 + mu2_B ) * mu3_B * ( 1.0 + mu3_C )
-          + 2.0 * mu2_C * mu2_C * mu2_C
-          + 2.0 * mu1_C * mu1_C * mu2_C
-          + 2.0 * mu2_C * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
-          - 2.0 * mu2_C;
-        itOCp[ 1 ][ 2 ].Set( 2.0 * valueOC );
-        /** mu3, part 1 */
-        valueOC
-          = +2.0 * mu3_A * mu3_A * mu3_A
-          + 2.0 * mu3_A * ( 1.0 + mu1_A ) * ( 1.0 + mu1_A )
-          - 2.0 * mu3_A
-          + 2.0 * mu2_A * mu2_A * mu3_A
-          + mu3_A * mu3_B * mu3_B
-          + mu1_B * ( 1.0 + mu1_A ) * mu3_B
-          + ( 1.0 + mu2_B ) * mu2_A * mu3_B
-          + mu3_A * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
-          + ( 1.0 + mu1_A ) * mu1_C * ( 1.0 + mu3_C )
-          + mu2_C * mu2_A * ( 1.0 + mu3_C );
-        itOCp[ 2 ][ 0 ].Set( 2.0 * valueOC );
-        /** mu3, part2 */
-        valueOC
-          = +mu3_A * mu3_A * mu3_B
-          + mu1_B * ( 1.0 + mu1_A ) * mu3_A
-          + mu2_A * mu3_A * ( 1.0 + mu2_B )
-          + 2.0 *  mu3_B *  mu3_B *  mu3_B
-          + 2.0 * mu1_B * mu1_B *  mu3_B
-          - 2.0 *  mu3_B
-          + 2.0 * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * mu3_B
-          + mu3_B * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
-          + mu1_B * mu1_C * ( 1.0 + mu3_C )
-          + mu2_C * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C );
-        itOCp[ 2 ][ 1 ].Set( 2.0 * valueOC );
-        /** mu3, part 3 */
-        valueOC
-          = +mu3_A * mu3_A * ( 1.0 + mu3_C )
-          + ( 1.0 + mu1_A ) * mu1_C * mu3_A
-          + mu2_A * mu3_A * mu2_C
-          + mu3_B * mu3_B * ( 1.0 + mu3_C )
-          + mu1_B * mu1_C * mu3_B
-          + ( 1.0 + mu2_B ) * mu3_B * mu2_C
-          + 2.0 * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
-          + 2.0 * mu1_C * mu1_C * ( 1.0 + mu3_C )
-          + 2.0 * mu2_C * mu2_C * ( 1.0 + mu3_C )
-          - 2.0 * ( 1.0 + mu3_C );
-        itOCp[ 2 ][ 2 ].Set( 2.0 * valueOC );
-      } // end if dim == 3
+        for( unsigned int j = 0; j < ImageDimension; j++ )
+        {
+          itOCp[ i ][ j ].Set( partsOC[ i ][ j ] );
+        }
+      }
 
       /** Increase all iterators. */
       for( unsigned int i = 0; i < ImageDimension; i++ )
@@ -1451,218 +1259,29 @@ TransformRigidityPenaltyTerm< TFixedImage, TScalarType >
 
   if( this->m_CalculatePropernessCondition )
   {
-    ScalarType mu1_A, mu2_A, mu3_A, mu1_B, mu2_B, mu3_B, mu1_C, mu2_C, mu3_C;
-    ScalarType valuePC;
+    ScalarType mu_A[ 3 ] = { 0.0, 0.0, 0.0 };
+    ScalarType mu_B[ 3 ] = { 0.0, 0.0, 0.0 };
+    ScalarType mu_C[ 3 ] = { 0.0, 0.0, 0.0 };
+    ScalarType partsPC[ 3 ][ 3 ];
     while( !itPCp[ 0 ][ 0 ].IsAtEnd() )
     {
-      /** Copy values: this way we avoid calling Get() so many times.
-       * It also improves code readability.
-       */
-      mu1_A = itA[ 0 ].Get(); mu2_A = itA[ 1 ].Get();
-      mu1_B = itB[ 0 ].Get(); mu2_B = itB[ 1 ].Get();
-      if( ImageDimension == 3 )
+      /** Copy values: this way we avoid calling Get() so many times. */
+      for( unsigned int i = 0; i < ImageDimension; i++ )
       {
-        mu3_A = itA[ 2 ].Get(); mu3_B = itB[ 2 ].Get();
-        mu1_C = itC[ 0 ].Get(); mu2_C = itC[ 1 ].Get(); mu3_C = itC[ 2 ].Get();
+        mu_A[ i ] = itA[ i ].Get(); mu_B[ i ] = itB[ i ].Get();
+        if( ImageDimension == 3 ) { mu_C[ i ] = itC[ i ].Get(); }
       }
-      if( ImageDimension == 2 )
-      {
-        /** Calculate the value of the properness condition. */
-        this->m_PropernessConditionValue
-          += it_RCI.Get() * (
-          vcl_pow(
-          +( 1.0 + mu1_A ) * ( 1.0 + mu2_B )
-          - mu2_A * mu1_B
-          - 1.0,
-          2.0 )
-          );
-        /** Calculate the derivative of the properness condition. */
-        /** mu1, part 1 */
-        valuePC
-          = +( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * ( 1.0 + mu1_A )
-          - mu2_A * ( 1.0 + mu2_B ) * mu1_B
-          - ( 1.0 + mu2_B );
-        itPCp[ 0 ][ 0 ].Set( 2.0 * valuePC );
-        /** mu1, part 2 */
-        valuePC
-          = +mu2_A
-          + mu2_A * mu2_A * mu1_B
-          - mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu1_A );
-        itPCp[ 0 ][ 1 ].Set( 2.0 * valuePC );
-        /** mu2, part 1 */
-        valuePC
-          = +mu1_B * mu1_B * mu2_A
-          - mu1_B * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B )
-          + mu1_B;
-        itPCp[ 1 ][ 0 ].Set( 2.0 * valuePC );
-        /** mu2, part 2 */
-        valuePC
-          = -( 1.0 + mu1_A )
-          + ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B )
-          - mu1_B * ( 1.0 + mu1_A ) * mu2_A;
-        itPCp[ 1 ][ 1 ].Set( 2.0 * valuePC );
-      } // end if dim == 2
-      else if( ImageDimension == 3 )
+
+      /** Calculate the value and the derivative parts of the properness condition. */
+      this->m_PropernessConditionValue
+        += it_RCI.Get() * this->ComputePropernessConditionParts( mu_A, mu_B, mu_C, partsPC );
+      for( unsigned int i = 0; i < ImageDimension; i++ )
       {
-        /** Calculate the value of the properness condition. */
-        this->m_PropernessConditionValue
-          += it_RCI.Get() * (
-          vcl_pow(
-          -mu1_C * ( 1.0 + mu2_B ) * mu3_A
-          + mu1_B * mu2_C * mu3_A
-          + mu1_C * mu2_A * mu3_B
-          - ( 1.0 + mu1_A ) * mu2_C * mu3_B
-          - mu1_B * mu2_A * ( 1.0 + mu3_C )
-          + ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C )
-          - 1.0,
-          2.0 )
-          );
-        /** Calculate the derivative of the properness condition. */
-        /** mu1, part 1 */
-        valuePC
-          = +( 1.0 + mu1_A ) * mu2_C * mu2_C * mu3_B * mu3_B
-          + ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
-          + mu1_C * ( 1.0 + mu2_B ) * mu2_C * mu3_A * mu3_B
-          - mu1_C * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * mu3_A * ( 1.0 + mu3_C )
-          - mu1_B * mu2_C * mu2_C * mu3_A * mu3_B
-          + mu1_B * ( 1.0 + mu2_B ) * mu2_C * mu3_A * ( 1.0 + mu3_C )
-          - mu1_C * mu2_A * mu2_C * mu3_B * mu3_B
-          + mu1_C * mu2_A * ( 1.0 + mu2_B ) * mu3_B * ( 1.0 + mu3_C )
-          + mu1_B * mu2_A * mu2_C * mu3_B * ( 1.0 + mu3_C )
-          - 2.0 * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * mu2_C * mu3_B * ( 1.0 + mu3_C )
-          + mu2_C * mu3_B
-          - mu1_B * mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
-          - ( 1.0 + mu2_B ) * ( 1.0 + mu3_C );
-        itPCp[ 0 ][ 0 ].Set( 2.0 * valuePC );
-        /** mu1, part 2 */
-        valuePC
-          = +mu1_B * mu2_C * mu2_C * mu3_A * mu3_A
-          + mu1_B * mu2_A * mu2_A * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
-          - mu1_C * ( 1.0 + mu2_B ) * mu2_C * mu3_A * mu3_A
-          + mu1_C * mu2_A * ( 1.0 + mu2_B ) * mu3_A * ( 1.0 + mu3_C )
-          + mu1_C * mu2_A * mu2_C * mu3_A * mu3_B
-          - ( 1.0 + mu1_A ) * mu2_C * mu2_C * mu3_A * mu3_B
-          - 2.0 * mu1_B * mu2_A * mu2_C * mu3_A * ( 1.0 + mu3_C )
-          + ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * mu2_C * mu3_A * ( 1.0 + mu3_C )
-          - mu2_C * mu3_A
-          - mu1_C * mu2_A * mu2_A * mu3_B * ( 1.0 + mu3_C )
-          + ( 1.0 + mu1_A ) * mu2_A * mu2_C * mu3_B * ( 1.0 + mu3_C )
-          - ( 1.0 + mu1_A ) * mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
-          + mu2_A * ( 1.0 + mu3_C );
-        itPCp[ 0 ][ 1 ].Set( 2.0 * valuePC );
-        /** mu1, part 3 */
-        valuePC
-          = +mu1_C * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * mu3_A * mu3_A
-          + mu1_C * mu2_A * mu2_A * mu3_B * mu3_B
-          - mu1_B * ( 1.0 + mu2_B ) * mu2_C * mu3_A * mu3_A
-          - 2.0 * mu1_C * mu2_A * ( 1.0 + mu2_B ) * mu3_A * mu3_B
-          + ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * mu2_C * mu3_A * mu3_B
-          + mu1_B * mu2_A * ( 1.0 + mu2_B ) * mu3_A * ( 1.0 + mu3_C )
-          - ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * mu3_A * ( 1.0 + mu3_C )
-          + ( 1.0 + mu2_B ) * mu3_A
-          + mu1_B * mu2_A * mu2_C * mu3_A * mu3_B
-          - ( 1.0 + mu1_A ) * mu2_A * mu2_C * mu3_B * mu3_B
-          - mu1_B * mu2_A * mu2_A * mu3_B * ( 1.0 + mu3_C )
-          + ( 1.0 + mu1_A ) * mu2_A * ( 1.0 + mu2_B ) * mu3_B * ( 1.0 + mu3_C )
-          - mu2_A * mu3_B;
-        itPCp[ 0 ][ 2 ].Set( 2.0 * valuePC );
-        /** mu2, part 1 */
-        valuePC
-          = +mu1_C * mu1_C * mu2_A * mu3_B * mu3_B
-          + mu1_B * mu1_B * mu2_A * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
-          - mu1_C * mu1_C * ( 1.0 + mu2_B ) * mu3_A * mu3_B
-          + mu1_B * mu1_C * ( 1.0 + mu2_B ) * mu3_A * ( 1.0 + mu3_C )
-          + mu1_B * mu1_C * mu2_C * mu3_A * mu3_B
-          - mu1_B * mu1_B * mu2_C * mu3_A * ( 1.0 + mu3_C )
-          - ( 1.0 + mu1_A ) * mu1_C * mu2_C * mu3_B * mu3_B
-          - 2.0 * mu1_B * mu1_C * mu2_A * mu3_B * ( 1.0 + mu3_C )
-          + ( 1.0 + mu1_A ) * mu1_C * ( 1.0 + mu2_B ) * mu3_B * ( 1.0 + mu3_C )
-          - mu1_C * mu3_B
-          + ( 1.0 + mu1_A ) * mu1_B * mu2_C * mu3_B * ( 1.0 + mu3_C )
-          - ( 1.0 + mu1_A ) * mu1_B * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
-          + mu1_B * ( 1.0 + mu3_C );
-        itPCp[ 1 ][ 0 ].Set( 2.0 * valuePC );
-        /** mu2, part 2 */
-        valuePC
-          = +mu1_C * mu1_C * ( 1.0 + mu2_B ) * mu3_A * mu3_A
-          + ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
-          - mu1_B * mu1_C * mu2_C * mu3_A * mu3_A
-          - mu1_C * mu1_C * mu2_A * mu3_A * mu3_B
-          + ( 1.0 + mu1_A ) * mu1_C * mu2_C * mu3_A * mu3_B
-          + mu1_B * mu1_C * mu2_A * mu3_A * ( 1.0 + mu3_C )
-          - 2.0 * ( 1.0 + mu1_A ) * mu1_C * ( 1.0 + mu2_B ) * mu3_A * ( 1.0 + mu3_C )
-          + mu1_C * mu3_A
-          + ( 1.0 + mu1_A ) * mu1_B * mu2_C * mu3_A * ( 1.0 + mu3_C )
-          + ( 1.0 + mu1_A ) * mu1_C * mu2_A * mu3_B * ( 1.0 + mu3_C )
-          - ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * mu2_C * mu3_B * ( 1.0 + mu3_C )
-          - ( 1.0 + mu1_A ) * mu1_B * mu2_A * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
-          - ( 1.0 + mu1_A ) * ( 1.0 + mu3_C );
-        itPCp[ 1 ][ 1 ].Set( 2.0 * valuePC );
-        /** mu2, part 3 */
-        valuePC
-          = +mu1_B * mu1_B * mu2_C * mu3_A * mu3_A
-          + ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * mu2_C * mu3_B * mu3_B
-          - mu1_B * mu1_C * ( 1.0 + mu2_B ) * mu3_A * mu3_A
-          + ( 1.0 + mu1_A ) * mu1_C * ( 1.0 + mu2_B ) * mu3_A * mu3_B
-          + mu1_B * mu1_C * mu2_A * mu3_A * mu3_B
-          - 2.0 * ( 1.0 + mu1_A ) * mu1_B * mu2_C * mu3_A * mu3_B
-          - mu1_B * mu1_B * mu2_A * mu3_A * ( 1.0 + mu3_C )
-          + ( 1.0 + mu1_A ) * mu1_B * ( 1.0 + mu2_B ) * mu3_A * ( 1.0 + mu3_C )
-          - mu1_B * mu3_A
-          - ( 1.0 + mu1_A ) * mu1_C * mu2_A * mu3_B * mu3_B
-          + ( 1.0 + mu1_A ) * mu1_B * mu2_A * mu3_B * ( 1.0 + mu3_C )
-          - ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * mu3_B * ( 1.0 + mu3_C )
-          + ( 1.0 + mu1_A ) * mu3_B;
-        itPCp[ 1 ][ 2 ].Set( 2.0 * valuePC );
-        /** mu3, part 1 */
-        valuePC
-          = +mu1_C * mu1_C * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * mu3_A
-          + mu1_B * mu1_B * mu2_C * mu2_C * mu3_A
-          - 2.0 * mu1_B * mu1_C * ( 1.0 + mu2_B ) * mu2_C * mu3_A
-          - mu1_C * mu1_C * mu2_A * ( 1.0 + mu2_B ) * mu3_B
-          + ( 1.0 + mu1_A ) * mu1_C * ( 1.0 + mu2_B ) * mu2_C * mu3_B
-          + mu1_B * mu1_C * mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C )
-          - ( 1.0 + mu1_A ) * mu1_C * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C )
-          + mu1_C * ( 1.0 + mu2_B )
-          + mu1_B * mu1_C * mu2_A * mu2_C * mu3_B
-          - ( 1.0 + mu1_A ) * mu1_B * mu2_C * mu2_C * mu3_B
-          - mu1_B * mu1_B * mu2_A * mu2_C * ( 1.0 + mu3_C )
-          + ( 1.0 + mu1_A ) * mu1_B * ( 1.0 + mu2_B ) * mu2_C * ( 1.0 + mu3_C )
-          + mu1_B * mu2_C;
-        itPCp[ 2 ][ 0 ].Set( 2.0 * valuePC );
-        /** mu3, part 2 */
-        valuePC
-          = +mu1_C * mu1_C * mu2_A * mu2_A * mu3_B
-          + ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * mu2_C * mu2_C * mu3_B
-          - mu1_C * mu1_C * mu2_A * ( 1.0 + mu2_B ) * mu3_A
-          + ( 1.0 + mu1_A ) * mu1_C * ( 1.0 + mu2_B ) * mu2_C * mu3_A
-          + mu1_B * mu1_C * mu2_A * mu2_C * mu3_A
-          - ( 1.0 + mu1_A ) * mu1_B * mu2_C * mu2_C * mu3_A
-          - 2.0 * ( 1.0 + mu1_A ) * mu1_C * mu2_A * mu2_C * mu3_B
-          - mu1_B * mu1_C * mu2_A * mu2_A * ( 1.0 + mu3_C )
-          + ( 1.0 + mu1_A ) * mu1_C * mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C )
-          - mu1_C * mu2_A
-          + ( 1.0 + mu1_A ) * mu1_B * mu2_A * mu2_C * ( 1.0 + mu3_C )
-          - ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * mu2_C * ( 1.0 + mu3_C )
-          + ( 1.0 + mu1_A ) * mu2_C;
-        itPCp[ 2 ][ 1 ].Set( 2.0 * valuePC );
-        /** mu3, part 3 */
-        valuePC
-          = +mu1_B * mu1_B * mu2_A * mu2_A * ( 1.0 + mu3_C )
-          + ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C )
-          + mu1_B * mu1_C * mu2_A * ( 1.0 + mu2_B ) * mu3_A
-          - ( 1.0 + mu1_A ) * mu1_C * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * mu3_A
-          - mu1_B * mu1_B * mu2_A * mu2_C * mu3_A
-          + ( 1.0 + mu1_A ) * mu1_B * ( 1.0 + mu2_B ) * mu2_C * mu3_A
-          - mu1_B * mu1_C * mu2_A * mu2_A * mu3_B
-          + ( 1.0 + mu1_A ) * mu1_C * mu2_A * ( 1.0 + mu2_B ) * mu3_B
-          + ( 1.0 + mu1_A ) * mu1_B * mu2_A * mu2_C * mu3_B
-          + ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * mu2_C * mu3_B
-          - 2.0 * ( 1.0 + mu1_A ) * mu1_B * mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C )
-          + mu1_B * mu2_A
-          - ( 1.0 + mu1_A ) * ( 1.0 + mu2_B );
-        itPCp[ 2 ][ 2 ].Set( 2.0 * valuePC );
-      } // end if dim == 3
+        for( unsigned int j = 0; j < ImageDimension; j++ )
+        {
+          itPCp[ i ][ j ].Set( partsPC[ i ][ j ] );
+        }
+      }
 
       /** Increase all iterators. */
       for( unsigned int i = 0; i < ImageDimension; i++ )
@@ -2148,9 +1767,1234 @@ TransformRigidityPenaltyTerm< TFixedImage, TScalarType >
     } // end while
   }   // end for
 
+} // end GetValueAndDerivativeSingleThreaded()
+
+
+/**
+ * *********************** GetValueAndDerivative ****************
+ */
+
+template< class TFixedImage, class TScalarType >
+void
+TransformRigidityPenaltyTerm< TFixedImage, TScalarType >
+::GetValueAndDerivative( const ParametersType & parameters,
+  MeasureType & value, DerivativeType & derivative ) const
+{
+  /** Option for now to still use the single threaded code. */
+  if( !this->m_UseMultiThread )
+  {
+    return this->GetValueAndDerivativeSingleThreaded(
+      parameters, value, derivative );
+  }
+
+  /** Fill the rigidity image based on the current transform parameters. */
+  this->FillRigidityCoefficientImage( parameters );
+
+  /** Set output values to zero. */
+  value                                = NumericTraits< MeasureType >::Zero;
+  this->m_RigidityPenaltyTermValue     = NumericTraits< MeasureType >::Zero;
+  this->m_LinearityConditionValue      = NumericTraits< MeasureType >::Zero;
+  this->m_OrthonormalityConditionValue = NumericTraits< MeasureType >::Zero;
+  this->m_PropernessConditionValue     = NumericTraits< MeasureType >::Zero;
+
+  /** Set output values to zero. */
+  derivative = DerivativeType( this->GetNumberOfParameters() );
+  derivative.Fill( NumericTraits< MeasureType >::ZeroValue() );
+
+  /** Call non-thread-safe stuff, see GetValueAndDerivativeSingleThreaded(). */
+  this->BeforeThreadedGetValueAndDerivative( parameters );
+
+  /** Sanity check. */
+  if( ImageDimension != 2 && ImageDimension != 3 )
+  {
+    itkExceptionMacro( << "ERROR: This filter is only implemented for dimension 2 and 3." );
+  }
+
+  /** Get the B-spline coefficient image region and spacing. */
+  CoefficientImagePointer           inputImage = this->m_BSplineTransform->GetCoefficientImages()[ 0 ];
+  const RigidityImageRegionType     region     = inputImage->GetLargestPossibleRegion();
+  const CoefficientImageSpacingType spacing    = inputImage->GetSpacing();
+
+  /** TASK 0:
+   * Compute the rigidityCoefficientSum and check on it. At the same time
+   * determine the bounding box of the nonzero rigidity coefficients: only
+   * there the orthonormality, properness and linearity parts are needed.
+   *
+   ************************************************************************* */
+
+  SizeValueType size[ 3 ] = { 1, 1, 1 };
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+  {
+    size[ d ] = region.GetSize()[ d ];
+  }
+
+  const ScalarType * rigidityCoefficients = this->m_RigidityCoefficientImage->GetBufferPointer();
+  ScalarType         rigidityCoefficientSum = NumericTraits< ScalarType >::Zero;
+  SizeValueType      lower[ 3 ] = { size[ 0 ], size[ 1 ], size[ 2 ] };
+  SizeValueType      upper[ 3 ] = { 0, 0, 0 };
+  SizeValueType      offset = 0;
+  for( SizeValueType z = 0; z < size[ 2 ]; ++z )
+  {
+    for( SizeValueType y = 0; y < size[ 1 ]; ++y )
+    {
+      for( SizeValueType x = 0; x < size[ 0 ]; ++x, ++offset )
+      {
+        const ScalarType c = rigidityCoefficients[ offset ];
+        rigidityCoefficientSum += c;
+        if( c != NumericTraits< ScalarType >::Zero )
+        {
+          lower[ 0 ] = std::min( lower[ 0 ], x ); upper[ 0 ] = std::max( upper[ 0 ], x + 1 );
+          lower[ 1 ] = std::min( lower[ 1 ], y ); upper[ 1 ] = std::max( upper[ 1 ], y + 1 );
+          lower[ 2 ] = std::min( lower[ 2 ], z ); upper[ 2 ] = std::max( upper[ 2 ], z + 1 );
+        }
+      }
+    }
+  }
+
+  /** Check for early termination. */
+  if( rigidityCoefficientSum < 1e-14 )
+  {
+    this->m_RigidityPenaltyTermValue = NumericTraits< MeasureType >::Zero;
+    return;
+  }
+
+  /** TASK 1:
+   * Prepare for the calculation of the rigidity penalty term.
+   * The 1D operators of the separable filters are stored as weights,
+   * so that all passes are fused into a single stencil per coefficient.
+   *
+   ************************************************************************* */
+
+  TransformRigidityPenaltyTermMultiThreaderParameterType & threaderParameters
+    = this->m_TransformRigidityPenaltyTermThreaderParameters;
+
+  /** The region with nonzero rigidity coefficients, and that region
+   * dilated with the operator radius for the derivative.
+   */
+  RigidityImageIndexType                     activeIndex = region.GetIndex();
+  typename RigidityImageRegionType::SizeType activeSize;
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+  {
+    activeIndex[ d ] += static_cast< IndexValueType >( lower[ d ] );
+    activeSize[ d ]   = upper[ d ] - lower[ d ];
+  }
+  const RigidityImageRegionType activeRegion( activeIndex, activeSize );
+  threaderParameters.st_ActiveRegion        = activeRegion;
+  threaderParameters.st_DilatedActiveRegion = activeRegion;
+  threaderParameters.st_DilatedActiveRegion.PadByRadius( 1 );
+  threaderParameters.st_DilatedActiveRegion.Crop( region );
+  threaderParameters.st_RigidityCoefficientSum = rigidityCoefficientSum;
+  threaderParameters.st_DerivativePointer      = derivative.begin();
+
+  /** Create the 1D and ND operators that are needed.
+   * The operators C, F, H and I only exist in 3D.
+   */
+  const std::string operatorNames[ 9 ] = { "A", "B", "C", "D", "E", "F", "G", "H", "I" };
+  const bool        calculateOCorPC
+    = this->m_CalculateOrthonormalityCondition || this->m_CalculatePropernessCondition;
+  for( unsigned int f = 0; f < 9; f++ )
+  {
+    const bool only3D      = ( f == 2 || f == 5 || f == 7 || f == 8 );
+    const bool isLinearity = ( f >= 3 );
+    threaderParameters.st_UseOperator[ f ] = ( ImageDimension == 3 || !only3D )
+      && ( isLinearity ? this->m_CalculateLinearityCondition : calculateOCorPC );
+    if( !threaderParameters.st_UseOperator[ f ] )
+    {
+      continue;
+    }
+
+    NeighborhoodType op;
+    for( unsigned int d = 0; d < ImageDimension; d++ )
+    {
+      this->Create1DOperator( op, "F" + operatorNames[ f ] + "_xi", d + 1, spacing );
+      for( unsigned int k = 0; k < 3; k++ )
+      {
+        threaderParameters.st_Operators1D[ f ][ d ][ k ] = op[ k ];
+      }
+    }
+    this->CreateNDOperator( op, "F" + operatorNames[ f ], spacing );
+    for( unsigned int k = 0; k < op.Size(); k++ )
+    {
+      threaderParameters.st_OperatorsND[ f ][ k ] = op[ k ];
+    }
+  }
+
+  /** Make sure the orthonormality, properness and linearity parts exist.
+   * They are reused in subsequent iterations.
+   */
+  this->InitializeConditionParts( region );
+
+  /** Reset the per thread variables. */
+  this->m_TransformRigidityPenaltyTermPerThreadVariables.resize( this->m_NumberOfThreads );
+  for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
+  {
+    TransformRigidityPenaltyTermPerThreadStruct & perThread
+      = this->m_TransformRigidityPenaltyTermPerThreadVariables[ i ];
+    perThread.st_LinearityConditionValue                 = NumericTraits< MeasureType >::Zero;
+    perThread.st_OrthonormalityConditionValue            = NumericTraits< MeasureType >::Zero;
+    perThread.st_PropernessConditionValue                = NumericTraits< MeasureType >::Zero;
+    perThread.st_LinearityConditionGradientMagnitude      = NumericTraits< MeasureType >::Zero;
+    perThread.st_OrthonormalityConditionGradientMagnitude = NumericTraits< MeasureType >::Zero;
+    perThread.st_PropernessConditionGradientMagnitude     = NumericTraits< MeasureType >::Zero;
+  }
+
+  /** TASKS 2-4:
+   * Filter the B-spline coefficient images and compute the
+   * orthonormality, properness and linearity parts, multi-threaded.
+   *
+   ************************************************************************* */
+
+  this->ExecuteThreaderCallback( this->ComputeConditionPartsThreaderCallback,
+    const_cast< void * >( static_cast< const void * >( &threaderParameters ) ) );
+
+  /** TASK 5:
+   * Do the actual calculation of the rigidity penalty term value.
+   *
+   ************************************************************************* */
+
+  /** Gather the values from all threads. */
+  for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
+  {
+    const TransformRigidityPenaltyTermPerThreadStruct & perThread
+      = this->m_TransformRigidityPenaltyTermPerThreadVariables[ i ];
+    this->m_LinearityConditionValue      += perThread.st_LinearityConditionValue;
+    this->m_OrthonormalityConditionValue += perThread.st_OrthonormalityConditionValue;
+    this->m_PropernessConditionValue     += perThread.st_PropernessConditionValue;
+  }
+
+  /** Calculate the rigidity penalty term value. */
+  if( this->m_CalculateLinearityCondition )
+  {
+    this->m_LinearityConditionValue /= rigidityCoefficientSum;
+  }
+  if( this->m_CalculateOrthonormalityCondition )
+  {
+    this->m_OrthonormalityConditionValue /= rigidityCoefficientSum;
+  }
+  if( this->m_CalculatePropernessCondition )
+  {
+    this->m_PropernessConditionValue /= rigidityCoefficientSum;
+  }
+
+  if( this->m_UseLinearityCondition )
+  {
+    this->m_RigidityPenaltyTermValue
+      += this->m_LinearityConditionWeight * this->m_LinearityConditionValue;
+  }
+  if( this->m_UseOrthonormalityCondition )
+  {
+    this->m_RigidityPenaltyTermValue
+      += this->m_OrthonormalityConditionWeight * this->m_OrthonormalityConditionValue;
+  }
+  if( this->m_UsePropernessCondition )
+  {
+    this->m_RigidityPenaltyTermValue
+      += this->m_PropernessConditionWeight * this->m_PropernessConditionValue;
+  }
+  value = this->m_RigidityPenaltyTermValue;
+
+  /** TASKS 6-8:
+   * Filter the parts with the ND operators and create the derivative,
+   * multi-threaded.
+   *
+   ************************************************************************* */
+
+  this->ExecuteThreaderCallback( this->ComputeDerivativeThreaderCallback,
+    const_cast< void * >( static_cast< const void * >( &threaderParameters ) ) );
+
+  /** Set the gradient magnitudes of the several terms. */
+  MeasureType gradMagLC = NumericTraits< MeasureType >::Zero;
+  MeasureType gradMagOC = NumericTraits< MeasureType >::Zero;
+  MeasureType gradMagPC = NumericTraits< MeasureType >::Zero;
+  for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
+  {
+    const TransformRigidityPenaltyTermPerThreadStruct & perThread
+      = this->m_TransformRigidityPenaltyTermPerThreadVariables[ i ];
+    gradMagLC += perThread.st_LinearityConditionGradientMagnitude;
+    gradMagOC += perThread.st_OrthonormalityConditionGradientMagnitude;
+    gradMagPC += perThread.st_PropernessConditionGradientMagnitude;
+  }
+  this->m_LinearityConditionGradientMagnitude      = vcl_sqrt( gradMagLC );
+  this->m_OrthonormalityConditionGradientMagnitude = vcl_sqrt( gradMagOC );
+  this->m_PropernessConditionGradientMagnitude     = vcl_sqrt( gradMagPC );
+
 } // end GetValueAndDerivative()
 
 
+/**
+ * *********************** InitializeConditionParts ****************
+ */
+
+template< class TFixedImage, class TScalarType >
+void
+TransformRigidityPenaltyTerm< TFixedImage, TScalarType >
+::InitializeConditionParts( const RigidityImageRegionType & region ) const
+{
+  /** Only (re)allocate when the B-spline grid has changed, e.g. in a new resolution.
+   * The parts are not cleared: only values at nonzero rigidity coefficients are used,
+   * and these are overwritten every iteration.
+   */
+  const unsigned int NofLParts = 3 * ImageDimension - 3;
+  std::vector< CoefficientImagePointer > * parts[ 3 ] = {
+    &this->m_OrthonormalityConditionParts,
+    &this->m_PropernessConditionParts,
+    &this->m_LinearityConditionParts };
+  const unsigned int numberOfParts[ 3 ] = {
+    ImageDimension * ImageDimension,
+    ImageDimension * ImageDimension,
+    ImageDimension * NofLParts };
+
+  for( unsigned int p = 0; p < 3; p++ )
+  {
+    if( parts[ p ]->size() == numberOfParts[ p ]
+      && ( *parts[ p ] )[ 0 ]->GetLargestPossibleRegion() == region )
+    {
+      continue;
+    }
+
+    parts[ p ]->resize( numberOfParts[ p ] );
+    for( unsigned int j = 0; j < numberOfParts[ p ]; j++ )
+    {
+      ( *parts[ p ] )[ j ] = CoefficientImageType::New();
+      ( *parts[ p ] )[ j ]->SetRegions( region );
+      ( *parts[ p ] )[ j ]->Allocate();
+    }
+  }
+
+} // end InitializeConditionParts()
+
+
+/**
+ * *********************** GetThreadRegion ****************
+ */
+
+template< class TFixedImage, class TScalarType >
+bool
+TransformRigidityPenaltyTerm< TFixedImage, TScalarType >
+::GetThreadRegion( const RigidityImageRegionType & region,
+  const ThreadIdType threadId, RigidityImageRegionType & threadRegion ) const
+{
+  /** Split the region along the last dimension. */
+  const unsigned int  lastDim      = ImageDimension - 1;
+  const SizeValueType regionSize   = region.GetSize()[ lastDim ];
+  const SizeValueType nrOfThreads  = static_cast< SizeValueType >( this->m_NumberOfThreads );
+  const SizeValueType sizePerThread = ( regionSize + nrOfThreads - 1 ) / nrOfThreads;
+  const SizeValueType begin         = threadId * sizePerThread;
+  if( begin >= regionSize )
+  {
+    return false;
+  }
+  const SizeValueType end = std::min( begin + sizePerThread, regionSize );
+
+  RigidityImageIndexType index = region.GetIndex();
+  typename RigidityImageRegionType::SizeType threadSize = region.GetSize();
+  index[ lastDim ]     += static_cast< IndexValueType >( begin );
+  threadSize[ lastDim ] = end - begin;
+  threadRegion.SetIndex( index );
+  threadRegion.SetSize( threadSize );
+
+  return true;
+
+} // end GetThreadRegion()
+
+
+/**
+ * *********************** ComputeConditionPartsThreaderCallback ****************
+ */
+
+template< class TFixedImage, class TScalarType >
+ITK_THREAD_RETURN_TYPE
+TransformRigidityPenaltyTerm< TFixedImage, TScalarType >
+::ComputeConditionPartsThreaderCallback( void * arg )
+{
+  ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType     threadId   = infoStruct->ThreadID;
+
+  TransformRigidityPenaltyTermMultiThreaderParameterType * temp
+    = static_cast< TransformRigidityPenaltyTermMultiThreaderParameterType * >( infoStruct->UserData );
+
+  temp->m_Metric->ThreadedComputeConditionParts( threadId );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ComputeConditionPartsThreaderCallback()
+
+
+/**
+ * *********************** ComputeDerivativeThreaderCallback ****************
+ */
+
+template< class TFixedImage, class TScalarType >
+ITK_THREAD_RETURN_TYPE
+TransformRigidityPenaltyTerm< TFixedImage, TScalarType >
+::ComputeDerivativeThreaderCallback( void * arg )
+{
+  ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+  ThreadIdType     threadId   = infoStruct->ThreadID;
+
+  TransformRigidityPenaltyTermMultiThreaderParameterType * temp
+    = static_cast< TransformRigidityPenaltyTermMultiThreaderParameterType * >( infoStruct->UserData );
+
+  temp->m_Metric->ThreadedComputeDerivative( threadId );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ComputeDerivativeThreaderCallback()
+
+
+/**
+ * *********************** ThreadedComputeConditionParts ****************
+ */
+
+template< class TFixedImage, class TScalarType >
+void
+TransformRigidityPenaltyTerm< TFixedImage, TScalarType >
+::ThreadedComputeConditionParts( ThreadIdType threadId )
+{
+  const TransformRigidityPenaltyTermMultiThreaderParameterType & threaderParameters
+    = this->m_TransformRigidityPenaltyTermThreaderParameters;
+
+  /** Get the part of the active region for this thread. */
+  RigidityImageRegionType threadRegion;
+  if( !this->GetThreadRegion( threaderParameters.st_ActiveRegion, threadId, threadRegion ) )
+  {
+    return;
+  }
+
+  /** Get sizes and bounds, relative to the start of the B-spline grid. */
+  const RigidityImageRegionType & region = this->m_RigidityCoefficientImage->GetLargestPossibleRegion();
+  SizeValueType                   size[ 3 ]  = { 1, 1, 1 };
+  SizeValueType                   lower[ 3 ] = { 0, 0, 0 };
+  SizeValueType                   upper[ 3 ] = { 1, 1, 1 };
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+  {
+    size[ d ]  = region.GetSize()[ d ];
+    lower[ d ] = threadRegion.GetIndex()[ d ] - region.GetIndex()[ d ];
+    upper[ d ] = lower[ d ] + threadRegion.GetSize()[ d ];
+  }
+  const SizeValueType  sliceSize = size[ 0 ] * size[ 1 ];
+  const unsigned int   nkz       = ImageDimension == 3 ? 3 : 1;
+  const unsigned int   NofLParts = 3 * ImageDimension - 3;
+  const bool * const   useOp     = threaderParameters.st_UseOperator;
+
+  /** Get the buffers. */
+  const ScalarType * rigidityCoefficients = this->m_RigidityCoefficientImage->GetBufferPointer();
+  const ScalarType * coefficients[ 3 ]    = { 0, 0, 0 };
+  ScalarType *       OCparts[ 3 ][ 3 ];
+  ScalarType *       PCparts[ 3 ][ 3 ];
+  ScalarType *       LCparts[ 3 ][ 6 ];
+  for( unsigned int i = 0; i < ImageDimension; i++ )
+  {
+    coefficients[ i ] = this->m_BSplineTransform->GetCoefficientImages()[ i ]->GetBufferPointer();
+    for( unsigned int j = 0; j < ImageDimension; j++ )
+    {
+      OCparts[ i ][ j ] = this->m_OrthonormalityConditionParts[ i * ImageDimension + j ]->GetBufferPointer();
+      PCparts[ i ][ j ] = this->m_PropernessConditionParts[ i * ImageDimension + j ]->GetBufferPointer();
+    }
+    for( unsigned int j = 0; j < NofLParts; j++ )
+    {
+      LCparts[ i ][ j ] = this->m_LinearityConditionParts[ i * NofLParts + j ]->GetBufferPointer();
+    }
+  }
+
+  /** Loop over the active region of this thread. */
+  MeasureType   valueLC = NumericTraits< MeasureType >::Zero;
+  MeasureType   valueOC = NumericTraits< MeasureType >::Zero;
+  MeasureType   valuePC = NumericTraits< MeasureType >::Zero;
+  ScalarType    filtered[ 9 ][ 3 ];
+  ScalarType    neighbors[ 3 ][ 3 ][ 3 ];
+  ScalarType    parts[ 3 ][ 3 ];
+  SizeValueType xo[ 3 ], yo[ 3 ], zo[ 3 ] = { 0, 0, 0 };
+  std::fill( &filtered[ 0 ][ 0 ], &filtered[ 0 ][ 0 ] + 27, NumericTraits< ScalarType >::Zero );
+  for( SizeValueType z = lower[ 2 ]; z < upper[ 2 ]; ++z )
+  {
+    /** Neighbor offsets, clamped at the border like the zero flux Neumann
+     * boundary condition of the NeighborhoodOperatorImageFilter.
+     */
+    if( ImageDimension == 3 )
+    {
+      zo[ 0 ] = ( z > 0 ? z - 1 : z ) * sliceSize;
+      zo[ 1 ] = z * sliceSize;
+      zo[ 2 ] = ( z + 1 < size[ 2 ] ? z + 1 : z ) * sliceSize;
+    }
+    for( SizeValueType y = lower[ 1 ]; y < upper[ 1 ]; ++y )
+    {
+      yo[ 0 ] = ( y > 0 ? y - 1 : y ) * size[ 0 ];
+      yo[ 1 ] = y * size[ 0 ];
+      yo[ 2 ] = ( y + 1 < size[ 1 ] ? y + 1 : y ) * size[ 0 ];
+      for( SizeValueType x = lower[ 0 ]; x < upper[ 0 ]; ++x )
+      {
+        /** Skip coefficients that do not contribute. */
+        const SizeValueType offset = z * sliceSize + yo[ 1 ] + x;
+        const ScalarType    c      = rigidityCoefficients[ offset ];
+        if( c == NumericTraits< ScalarType >::Zero )
+        {
+          continue;
+        }
+
+        xo[ 0 ] = x > 0 ? x - 1 : x;
+        xo[ 1 ] = x;
+        xo[ 2 ] = x + 1 < size[ 0 ] ? x + 1 : x;
+
+        /** Apply the separable operators to the neighborhood of the coefficients,
+         * in the same order as the filter passes: first x, then y, then z.
+         */
+        for( unsigned int i = 0; i < ImageDimension; i++ )
+        {
+          for( unsigned int kz = 0; kz < nkz; kz++ )
+          {
+            for( unsigned int ky = 0; ky < 3; ky++ )
+            {
+              for( unsigned int kx = 0; kx < 3; kx++ )
+              {
+                neighbors[ kz ][ ky ][ kx ] = coefficients[ i ][ zo[ kz ] + yo[ ky ] + xo[ kx ] ];
+              }
+            }
+          }
+
+          for( unsigned int f = 0; f < 9; f++ )
+          {
+            if( !useOp[ f ] ) { continue; }
+            const ScalarType( &w )[ 3 ][ 3 ] = threaderParameters.st_Operators1D[ f ];
+            ScalarType resultZ = NumericTraits< ScalarType >::Zero;
+            for( unsigned int kz = 0; kz < nkz; kz++ )
+            {
+              ScalarType resultY = NumericTraits< ScalarType >::Zero;
+              for( unsigned int ky = 0; ky < 3; ky++ )
+              {
+                ScalarType resultX = NumericTraits< ScalarType >::Zero;
+                for( unsigned int kx = 0; kx < 3; kx++ )
+                {
+                  resultX += w[ 0 ][ kx ] * neighbors[ kz ][ ky ][ kx ];
+                }
+                resultY += w[ 1 ][ ky ] * resultX;
+              }
+              if( ImageDimension == 3 ) { resultZ += w[ 2 ][ kz ] * resultY; }
+              else { resultZ = resultY; }
+            }
+            filtered[ f ][ i ] = resultZ;
+          }
+        } // end for i
+
+        /** Orthonormality condition. */
+        if( this->m_CalculateOrthonormalityCondition )
+        {
+          valueOC += c * this->ComputeOrthonormalityConditionParts(
+            filtered[ 0 ], filtered[ 1 ], filtered[ 2 ], parts );
+          for( unsigned int i = 0; i < ImageDimension; i++ )
+          {
+            for( unsigned int j = 0; j < ImageDimension; j++ )
+            {
+              OCparts[ i ][ j ][ offset ] = parts[ i ][ j ];
+            }
+          }
+        }
+
+        /** Properness condition. */
+        if( this->m_CalculatePropernessCondition )
+        {
+          valuePC += c * this->ComputePropernessConditionParts(
+            filtered[ 0 ], filtered[ 1 ], filtered[ 2 ], parts );
+          for( unsigned int i = 0; i < ImageDimension; i++ )
+          {
+            for( unsigned int j = 0; j < ImageDimension; j++ )
+            {
+              PCparts[ i ][ j ][ offset ] = parts[ i ][ j ];
+            }
+          }
+        }
+
+        /** Linearity condition, with the operators D, E, G (and F, H, I). */
+        if( this->m_CalculateLinearityCondition )
+        {
+          for( unsigned int i = 0; i < ImageDimension; i++ )
+          {
+            const ScalarType fD = filtered[ 3 ][ i ];
+            const ScalarType fE = filtered[ 4 ][ i ];
+            const ScalarType fG = filtered[ 6 ][ i ];
+            valueLC += c * ( +fD * fD + fE * fE + fG * fG );
+            LCparts[ i ][ 0 ][ offset ] = 2.0 * fD;
+            LCparts[ i ][ 1 ][ offset ] = 2.0 * fE;
+            LCparts[ i ][ 2 ][ offset ] = 2.0 * fG;
+            if( ImageDimension == 3 )
+            {
+              const ScalarType fF = filtered[ 5 ][ i ];
+              const ScalarType fH = filtered[ 7 ][ i ];
+              const ScalarType fI = filtered[ 8 ][ i ];
+              valueLC += c * ( +fF * fF + fH * fH + fI * fI );
+              LCparts[ i ][ 3 ][ offset ] = 2.0 * fF;
+              LCparts[ i ][ 4 ][ offset ] = 2.0 * fH;
+              LCparts[ i ][ 5 ][ offset ] = 2.0 * fI;
+            }
+          }
+        }
+      } // end for x
+    }   // end for y
+  }     // end for z
+
+  /** Store the values of this thread. */
+  TransformRigidityPenaltyTermPerThreadStruct & perThread
+    = this->m_TransformRigidityPenaltyTermPerThreadVariables[ threadId ];
+  perThread.st_LinearityConditionValue      = valueLC;
+  perThread.st_OrthonormalityConditionValue = valueOC;
+  perThread.st_PropernessConditionValue     = valuePC;
+
+} // end ThreadedComputeConditionParts()
+
+
+/**
+ * *********************** ThreadedComputeDerivative ****************
+ */
+
+template< class TFixedImage, class TScalarType >
+void
+TransformRigidityPenaltyTerm< TFixedImage, TScalarType >
+::ThreadedComputeDerivative( ThreadIdType threadId )
+{
+  const TransformRigidityPenaltyTermMultiThreaderParameterType & threaderParameters
+    = this->m_TransformRigidityPenaltyTermThreaderParameters;
+
+  /** Get the part of the dilated active region for this thread.
+   * Outside this region all neighboring rigidity coefficients are zero.
+   */
+  RigidityImageRegionType threadRegion;
+  if( !this->GetThreadRegion( threaderParameters.st_DilatedActiveRegion, threadId, threadRegion ) )
+  {
+    return;
+  }
+
+  /** Get sizes and bounds, relative to the start of the B-spline grid. */
+  const RigidityImageRegionType & region = this->m_RigidityCoefficientImage->GetLargestPossibleRegion();
+  SizeValueType                   size[ 3 ]  = { 1, 1, 1 };
+  SizeValueType                   lower[ 3 ] = { 0, 0, 0 };
+  SizeValueType                   upper[ 3 ] = { 1, 1, 1 };
+  for( unsigned int d = 0; d < ImageDimension; d++ )
+  {
+    size[ d ]  = region.GetSize()[ d ];
+    lower[ d ] = threadRegion.GetIndex()[ d ] - region.GetIndex()[ d ];
+    upper[ d ] = lower[ d ] + threadRegion.GetSize()[ d ];
+  }
+  const SizeValueType sliceSize            = size[ 0 ] * size[ 1 ];
+  const SizeValueType numberOfCoefficients = sliceSize * size[ 2 ];
+  const unsigned int  nkz                  = ImageDimension == 3 ? 3 : 1;
+  const unsigned int  NofLParts            = 3 * ImageDimension - 3;
+
+  /** Get the buffers. */
+  const ScalarType * rigidityCoefficients = this->m_RigidityCoefficientImage->GetBufferPointer();
+  const ScalarType * OCparts[ 3 ][ 3 ];
+  const ScalarType * PCparts[ 3 ][ 3 ];
+  const ScalarType * LCparts[ 3 ][ 6 ];
+  for( unsigned int i = 0; i < ImageDimension; i++ )
+  {
+    for( unsigned int j = 0; j < ImageDimension; j++ )
+    {
+      OCparts[ i ][ j ] = this->m_OrthonormalityConditionParts[ i * ImageDimension + j ]->GetBufferPointer();
+      PCparts[ i ][ j ] = this->m_PropernessConditionParts[ i * ImageDimension + j ]->GetBufferPointer();
+    }
+    for( unsigned int j = 0; j < NofLParts; j++ )
+    {
+      LCparts[ i ][ j ] = this->m_LinearityConditionParts[ i * NofLParts + j ]->GetBufferPointer();
+    }
+  }
+
+  /** The ND operators A, B, C for orthonormality and properness, and
+   * D, E, G, F, H, I for linearity, in the order of the linearity parts.
+   */
+  const ScalarType( &ops )[ 9 ][ 27 ] = threaderParameters.st_OperatorsND;
+  const unsigned int    linearityOps[ 6 ] = { 3, 4, 6, 5, 7, 8 };
+
+  const ScalarType      rigidityCoefficientSum    = threaderParameters.st_RigidityCoefficientSum;
+  const double          rigidityCoefficientSumSqr = rigidityCoefficientSum * rigidityCoefficientSum;
+  DerivativeValueType * derivative                = threaderParameters.st_DerivativePointer;
+
+  /** Loop over the dilated active region of this thread. */
+  MeasureType   gradMagLC = NumericTraits< MeasureType >::Zero;
+  MeasureType   gradMagOC = NumericTraits< MeasureType >::Zero;
+  MeasureType   gradMagPC = NumericTraits< MeasureType >::Zero;
+  double        tmpOC[ 3 ], tmpPC[ 3 ], tmpLC[ 3 ];
+  SizeValueType xo[ 3 ], yo[ 3 ], zo[ 3 ] = { 0, 0, 0 };
+  for( SizeValueType z = lower[ 2 ]; z < upper[ 2 ]; ++z )
+  {
+    if( ImageDimension == 3 )
+    {
+      zo[ 0 ] = ( z > 0 ? z - 1 : z ) * sliceSize;
+      zo[ 1 ] = z * sliceSize;
+      zo[ 2 ] = ( z + 1 < size[ 2 ] ? z + 1 : z ) * sliceSize;
+    }
+    for( SizeValueType y = lower[ 1 ]; y < upper[ 1 ]; ++y )
+    {
+      yo[ 0 ] = ( y > 0 ? y - 1 : y ) * size[ 0 ];
+      yo[ 1 ] = y * size[ 0 ];
+      yo[ 2 ] = ( y + 1 < size[ 1 ] ? y + 1 : y ) * size[ 0 ];
+      for( SizeValueType x = lower[ 0 ]; x < upper[ 0 ]; ++x )
+      {
+        xo[ 0 ] = x > 0 ? x - 1 : x;
+        xo[ 1 ] = x;
+        xo[ 2 ] = x + 1 < size[ 0 ] ? x + 1 : x;
+
+        /** TASK 7:
+         * Calculate the filtered versions of the subparts, skipping
+         * neighbors with a zero rigidity coefficient.
+         */
+        for( unsigned int i = 0; i < ImageDimension; i++ )
+        {
+          tmpOC[ i ] = 0.0; tmpPC[ i ] = 0.0; tmpLC[ i ] = 0.0;
+        }
+        for( unsigned int kz = 0; kz < nkz; kz++ )
+        {
+          for( unsigned int ky = 0; ky < 3; ky++ )
+          {
+            for( unsigned int kx = 0; kx < 3; kx++ )
+            {
+              const SizeValueType n  = zo[ kz ] + yo[ ky ] + xo[ kx ];
+              const ScalarType    cn = rigidityCoefficients[ n ];
+              if( cn == NumericTraits< ScalarType >::Zero )
+              {
+                continue;
+              }
+
+              const unsigned int k = kx + 3 * ky + 9 * kz;
+              for( unsigned int i = 0; i < ImageDimension; i++ )
+              {
+                if( this->m_CalculateOrthonormalityCondition )
+                {
+                  tmpOC[ i ] += ops[ 0 ][ k ] * OCparts[ i ][ 0 ][ n ] * cn;
+                  tmpOC[ i ] += ops[ 1 ][ k ] * OCparts[ i ][ 1 ][ n ] * cn;
+                  if( ImageDimension == 3 )
+                  {
+                    tmpOC[ i ] += ops[ 2 ][ k ] * OCparts[ i ][ 2 ][ n ] * cn;
+                  }
+                }
+                if( this->m_CalculatePropernessCondition )
+                {
+                  tmpPC[ i ] += ops[ 0 ][ k ] * PCparts[ i ][ 0 ][ n ] * cn;
+                  tmpPC[ i ] += ops[ 1 ][ k ] * PCparts[ i ][ 1 ][ n ] * cn;
+                  if( ImageDimension == 3 )
+                  {
+                    tmpPC[ i ] += ops[ 2 ][ k ] * PCparts[ i ][ 2 ][ n ] * cn;
+                  }
+                }
+                if( this->m_CalculateLinearityCondition )
+                {
+                  for( unsigned int j = 0; j < NofLParts; j++ )
+                  {
+                    tmpLC[ i ] += ops[ linearityOps[ j ] ][ k ] * LCparts[ i ][ j ][ n ] * cn;
+                  }
+                }
+              } // end for i
+            }
+          }
+        } // end loop over neighborhood
+
+        /** TASK 8:
+         * Add it all to create the final derivative.
+         * NOTE: unlike the values, for the derivatives weight * derivative is returned.
+         */
+        const SizeValueType offset = z * sliceSize + yo[ 1 ] + x;
+        for( unsigned int i = 0; i < ImageDimension; i++ )
+        {
+          ScalarType tmpDIs = NumericTraits< ScalarType >::Zero;
+
+          /** Compute gradient magnitude of LC. */
+          ScalarType tmpLCw = this->m_LinearityConditionWeight * static_cast< ScalarType >( tmpLC[ i ] );
+          gradMagLC += tmpLCw * tmpLCw / rigidityCoefficientSumSqr;
+
+          /** Compute gradient magnitude of OC. */
+          ScalarType tmpOCw = this->m_OrthonormalityConditionWeight * static_cast< ScalarType >( tmpOC[ i ] );
+          gradMagOC += tmpOCw * tmpOCw / rigidityCoefficientSumSqr;
+
+          /** Compute gradient magnitude of PC. */
+          ScalarType tmpPCw = this->m_PropernessConditionWeight * static_cast< ScalarType >( tmpPC[ i ] );
+          gradMagPC += tmpPCw * tmpPCw / rigidityCoefficientSumSqr;
+
+          /** Compute derivative contribution. */
+          if( this->m_UseLinearityCondition )
+          {
+            tmpDIs += tmpLCw;
+          }
+          if( this->m_UseOrthonormalityCondition )
+          {
+            tmpDIs += tmpOCw;
+          }
+          if( this->m_UsePropernessCondition )
+          {
+            tmpDIs += tmpPCw;
+          }
+          derivative[ i * numberOfCoefficients + offset ] = tmpDIs / rigidityCoefficientSum;
+        }
+      } // end for x
+    }   // end for y
+  }     // end for z
+
+  /** Store the gradient magnitudes of this thread. */
+  TransformRigidityPenaltyTermPerThreadStruct & perThread
+    = this->m_TransformRigidityPenaltyTermPerThreadVariables[ threadId ];
+  perThread.st_LinearityConditionGradientMagnitude      = gradMagLC;
+  perThread.st_OrthonormalityConditionGradientMagnitude = gradMagOC;
+  perThread.st_PropernessConditionGradientMagnitude     = gradMagPC;
+
+} // end ThreadedComputeDerivative()
+
+
+/**
+ * ****************** ComputeOrthonormalityConditionParts *******************
+ */
+
+template< class TFixedImage, class TScalarType >
+typename TransformRigidityPenaltyTerm< TFixedImage, TScalarType >::MeasureType
+TransformRigidityPenaltyTerm< TFixedImage, TScalarType >
+::ComputeOrthonormalityConditionParts(
+  const ScalarType mu_A[ 3 ], const ScalarType mu_B[ 3 ], const ScalarType mu_C[ 3 ],
+  ScalarType parts[ 3 ][ 3 ] ) const
+{
+  /** Copy values: this way we avoid indexing so many times.
+   * It also improves code readability.
+   */
+  const ScalarType mu1_A = mu_A[ 0 ]; const ScalarType mu2_A = mu_A[ 1 ]; const ScalarType mu3_A = mu_A[ 2 ];
+  const ScalarType mu1_B = mu_B[ 0 ]; const ScalarType mu2_B = mu_B[ 1 ]; const ScalarType mu3_B = mu_B[ 2 ];
+  const ScalarType mu1_C = mu_C[ 0 ]; const ScalarType mu2_C = mu_C[ 1 ]; const ScalarType mu3_C = mu_C[ 2 ];
+
+  MeasureType value = NumericTraits< MeasureType >::Zero;
+  ScalarType  valueOC;
+
+  if( ImageDimension == 2 )
+  {
+    /** Calculate the value of the orthonormality condition. */
+    value = (
+      vcl_pow(
+      +( 1.0 + mu1_A ) * ( 1.0 + mu1_A )
+      + mu2_A * mu2_A
+      - 1.0,
+      2.0 )
+      + vcl_pow(
+      +mu1_B * mu1_B
+      + ( 1.0 + mu2_B ) * ( 1.0 + mu2_B )
+      - 1.0,
+      2.0 )
+      + vcl_pow(
+      +( 1.0 + mu1_A ) * mu1_B
+      + mu2_A * ( 1.0 + mu2_B ),
+      2.0 )
+      );
+    /** Calculate the derivative of the orthonormality condition. */
+    /** mu1, part 1 */
+    valueOC
+      = +2.0 * ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * ( 1.0 + mu1_A )
+      + 2.0 * mu2_A * mu2_A * ( 1.0 + mu1_A )
+      - 2.0 * ( 1.0 + mu1_A )
+      + mu1_B * mu1_B * ( 1.0 + mu1_A )
+      + mu2_A * ( 1.0 + mu2_B ) * mu1_B;
+    parts[ 0 ][ 0 ] = 2.0 * valueOC;
+    /** mu1, part2*/
+    valueOC
+      = +mu1_B * ( 1.0 + mu1_A ) * ( 1.0 + mu1_A )
+      + mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu1_A )
+      + 2.0 * mu1_B * mu1_B * mu1_B
+      + 2.0 * mu1_B * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B )
+      - 2.0 * mu1_B;
+    parts[ 0 ][ 1 ] = 2.0 * valueOC;
+    /** mu2, part 1 */
+    valueOC
+      = +2.0 * mu2_A * mu2_A * mu2_A
+      + 2.0 * mu2_A * ( 1.0 + mu1_A ) * ( 1.0 + mu1_A )
+      - 2.0 * mu2_A
+      + mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B )
+      + mu1_B * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B );
+    parts[ 1 ][ 0 ] = 2.0 * valueOC;
+    /** mu2, part2*/
+    valueOC
+      = +mu2_A * mu2_A * ( 1.0 + mu2_B )
+      + mu1_B * ( 1.0 + mu1_A ) * mu2_A
+      + 2.0 * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B )
+      + 2.0 * mu1_B * mu1_B * ( 1.0 + mu2_B )
+      - 2.0 * ( 1.0 + mu2_B );
+    parts[ 1 ][ 1 ] = 2.0 * valueOC;
+  } // end if dim == 2
+  else if( ImageDimension == 3 )
+  {
+    /** Calculate the value of the orthonormality condition. */
+    value = (
+      vcl_pow(
+      +( 1.0 + mu1_A ) * ( 1.0 + mu1_A )
+      + mu2_A * mu2_A
+      + mu3_A * mu3_A
+      - 1.0,
+      2.0 )
+      + vcl_pow(
+      +( 1.0 + mu1_A ) * mu1_B
+      + mu2_A * ( 1.0 + mu2_B )
+      + mu3_A * mu3_B,
+      2.0 )
+      + vcl_pow(
+      +( 1.0 + mu1_A ) * mu1_C
+      + mu2_A * mu2_C
+      + mu3_A * ( 1.0 + mu3_C ),
+      2.0 )
+      + vcl_pow(
+      +mu1_B * mu1_B
+      + ( 1.0 + mu2_B ) * ( 1.0 + mu2_B )
+      + mu3_B * mu3_B
+      - 1.0,
+      2.0 )
+      + vcl_pow(
+      +mu1_B * mu1_C
+      + ( 1.0 + mu2_B ) * mu2_C
+      + mu3_B * ( 1.0 + mu3_C ),
+      2.0 )
+      + vcl_pow(
+      +mu1_C * mu1_C
+      + mu2_C * mu2_C
+      + ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
+      - 1.0,
+      2.0 ) );
+    /** Calculate the derivative of the orthonormality condition. */
+    /** mu1, part 1 */
+    valueOC
+      = +2.0 * ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * ( 1.0 + mu1_A )
+      + 2.0 * mu2_A * mu2_A * ( 1.0 + mu1_A )
+      + 2.0 * ( 1.0 + mu1_A ) * mu3_A * mu3_A
+      - 2.0 * ( 1.0 + mu1_A )
+      + mu1_B * mu1_B * ( 1.0 + mu1_A )
+      + mu2_A * ( 1.0 + mu2_B ) * mu1_B
+      + mu1_B * mu3_A * mu3_B
+      + ( 1.0 + mu1_A ) * mu1_C * mu1_C
+      + mu1_C * mu2_A * mu2_C
+      + mu1_C * mu3_A * ( 1.0 + mu3_C );
+    parts[ 0 ][ 0 ] = 2.0 * valueOC;
+    /** mu1, part2 */
+    valueOC
+      = +( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * mu1_B
+      + ( 1.0 + mu1_A ) * mu2_A * mu3_B
+      + ( 1.0 + mu1_A ) * mu3_A * mu3_B
+      + mu1_B * mu1_B * mu1_B
+      + mu1_B * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B )
+      + mu1_B * mu3_B * mu3_B
+      - mu1_B
+      + mu1_B * mu1_C * mu1_C
+      + mu1_C * ( 1.0 + mu2_B ) * mu2_C
+      + mu1_C * mu3_B * ( 1.0 + mu3_C );
+    parts[ 0 ][ 1 ] = 2.0 * valueOC;
+    /** mu1, part3 */
+    valueOC
+      = +( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * mu1_C
+      + ( 1.0 + mu1_A ) * mu2_A * mu2_C
+      + ( 1.0 + mu1_A ) * mu3_A * ( 1.0 + mu3_C )
+      + mu1_B * mu1_B * mu1_C
+      + mu1_B * ( 1.0 + mu2_B ) * mu2_C
+      + mu1_B * mu3_B * ( 1.0 + mu3_C )
+      + 2.0 * mu1_C * mu1_C * mu1_C
+      + 2.0 * mu1_C * mu2_C * mu2_C
+      + 2.0 * mu1_C * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
+      - 2.0 * mu1_C;
+    parts[ 0 ][ 2 ] = 2.0 * valueOC;
+    /** mu2, part 1 */
+    valueOC
+      = +2.0 * mu2_A * mu2_A * mu2_A
+      + 2.0 * mu2_A * ( 1.0 + mu1_A ) * ( 1.0 + mu1_A )
+      - 2.0 * mu2_A
+      + 2.0 * mu2_A * mu3_A * mu3_A
+      + mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B )
+      + mu1_B * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B )
+      + ( 1.0 + mu2_B ) * mu3_A * mu3_B
+      + mu2_A * mu2_C * mu2_C
+      + ( 1.0 + mu1_A ) * mu1_C * mu2_C
+      + mu2_C * mu3_A * ( 1.0 + mu3_C );
+    parts[ 1 ][ 0 ] = 2.0 * valueOC;
+    /** mu2, part2 */
+    valueOC
+      = +mu2_A * mu2_A * ( 1.0 + mu2_B )
+      + mu1_B * ( 1.0 + mu1_A ) * mu2_A
+      + mu2_A * mu3_A * mu3_B
+      + 2.0 * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B )
+      + 2.0 * mu1_B * mu1_B * ( 1.0 + mu2_B )
+      - 2.0 * ( 1.0 + mu2_B )
+      + 2.0 * ( 1.0 + mu2_B ) * mu3_B * mu3_B
+      + ( 1.0 + mu2_B ) * mu2_C * mu2_C
+      + mu1_B * mu1_C * mu2_C
+      + mu2_C * mu3_B * ( 1.0 + mu3_C );
+    parts[ 1 ][ 1 ] = 2.0 * valueOC;
+    /** mu2, part 3 */
+    valueOC
+      = +mu2_A * mu2_A * mu2_C
+      + ( 1.0 + mu1_A ) * mu1_C * mu2_A
+      + mu2_A * mu3_A * ( 1.0 + mu3_C )
+      + ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * mu2_C
+      + mu1_B * mu1_C * mu2_B
+      + ( 1.0 + mu2_B ) * mu3_B * ( 1.0 + mu3_C )
+      + 2.0 * mu2_C * mu2_C * mu2_C
+      + 2.0 * mu1_C * mu1_C * mu2_C
+      + 2.0 * mu2_C * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
+      - 2.0 * mu2_C;
+    parts[ 1 ][ 2 ] = 2.0 * valueOC;
+    /** mu3, part 1 */
+    valueOC
+      = +2.0 * mu3_A * mu3_A * mu3_A
+      + 2.0 * mu3_A * ( 1.0 + mu1_A ) * ( 1.0 + mu1_A )
+      - 2.0 * mu3_A
+      + 2.0 * mu2_A * mu2_A * mu3_A
+      + mu3_A * mu3_B * mu3_B
+      + mu1_B * ( 1.0 + mu1_A ) * mu3_B
+      + ( 1.0 + mu2_B ) * mu2_A * mu3_B
+      + mu3_A * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
+      + ( 1.0 + mu1_A ) * mu1_C * ( 1.0 + mu3_C )
+      + mu2_C * mu2_A * ( 1.0 + mu3_C );
+    parts[ 2 ][ 0 ] = 2.0 * valueOC;
+    /** mu3, part2 */
+    valueOC
+      = +mu3_A * mu3_A * mu3_B
+      + mu1_B * ( 1.0 + mu1_A ) * mu3_A
+      + mu2_A * mu3_A * ( 1.0 + mu2_B )
+      + 2.0 *  mu3_B *  mu3_B *  mu3_B
+      + 2.0 * mu1_B * mu1_B *  mu3_B
+      - 2.0 *  mu3_B
+      + 2.0 * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * mu3_B
+      + mu3_B * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
+      + mu1_B * mu1_C * ( 1.0 + mu3_C )
+      + mu2_C * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C );
+    parts[ 2 ][ 1 ] = 2.0 * valueOC;
+    /** mu3, part 3 */
+    valueOC
+      = +mu3_A * mu3_A * ( 1.0 + mu3_C )
+      + ( 1.0 + mu1_A ) * mu1_C * mu3_A
+      + mu2_A * mu3_A * mu2_C
+      + mu3_B * mu3_B * ( 1.0 + mu3_C )
+      + mu1_B * mu1_C * mu3_B
+      + ( 1.0 + mu2_B ) * mu3_B * mu2_C
+      + 2.0 * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
+      + 2.0 * mu1_C * mu1_C * ( 1.0 + mu3_C )
+      + 2.0 * mu2_C * mu2_C * ( 1.0 + mu3_C )
+      - 2.0 * ( 1.0 + mu3_C );
+    parts[ 2 ][ 2 ] = 2.0 * valueOC;
+  } // end if dim == 3
+
+  return value;
+
+} // end ComputeOrthonormalityConditionParts()
+
+
+/**
+ * ****************** ComputePropernessConditionParts *******************
+ */
+
+template< class TFixedImage, class TScalarType >
+typename TransformRigidityPenaltyTerm< TFixedImage, TScalarType >::MeasureType
+TransformRigidityPenaltyTerm< TFixedImage, TScalarType >
+::ComputePropernessConditionParts(
+  const ScalarType mu_A[ 3 ], const ScalarType mu_B[ 3 ], const ScalarType mu_C[ 3 ],
+  ScalarType parts[ 3 ][ 3 ] ) const
+{
+  /** Copy values: this way we avoid indexing so many times.
+   * It also improves code readability.
+   */
+  const ScalarType mu1_A = mu_A[ 0 ]; const ScalarType mu2_A = mu_A[ 1 ]; const ScalarType mu3_A = mu_A[ 2 ];
+  const ScalarType mu1_B = mu_B[ 0 ]; const ScalarType mu2_B = mu_B[ 1 ]; const ScalarType mu3_B = mu_B[ 2 ];
+  const ScalarType mu1_C = mu_C[ 0 ]; const ScalarType mu2_C = mu_C[ 1 ]; const ScalarType mu3_C = mu_C[ 2 ];
+
+  MeasureType value = NumericTraits< MeasureType >::Zero;
+  ScalarType  valuePC;
+
+  if( ImageDimension == 2 )
+  {
+    /** Calculate the value of the properness condition. */
+    value = (
+      vcl_pow(
+      +( 1.0 + mu1_A ) * ( 1.0 + mu2_B )
+      - mu2_A * mu1_B
+      - 1.0,
+      2.0 )
+      );
+    /** Calculate the derivative of the properness condition. */
+    /** mu1, part 1 */
+    valuePC
+      = +( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * ( 1.0 + mu1_A )
+      - mu2_A * ( 1.0 + mu2_B ) * mu1_B
+      - ( 1.0 + mu2_B );
+    parts[ 0 ][ 0 ] = 2.0 * valuePC;
+    /** mu1, part 2 */
+    valuePC
+      = +mu2_A
+      + mu2_A * mu2_A * mu1_B
+      - mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu1_A );
+    parts[ 0 ][ 1 ] = 2.0 * valuePC;
+    /** mu2, part 1 */
+    valuePC
+      = +mu1_B * mu1_B * mu2_A
+      - mu1_B * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B )
+      + mu1_B;
+    parts[ 1 ][ 0 ] = 2.0 * valuePC;
+    /** mu2, part 2 */
+    valuePC
+      = -( 1.0 + mu1_A )
+      + ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B )
+      - mu1_B * ( 1.0 + mu1_A ) * mu2_A;
+    parts[ 1 ][ 1 ] = 2.0 * valuePC;
+  } // end if dim == 2
+  else if( ImageDimension == 3 )
+  {
+    /** Calculate the value of the properness condition. */
+    value = (
+      vcl_pow(
+      -mu1_C * ( 1.0 + mu2_B ) * mu3_A
+      + mu1_B * mu2_C * mu3_A
+      + mu1_C * mu2_A * mu3_B
+      - ( 1.0 + mu1_A ) * mu2_C * mu3_B
+      - mu1_B * mu2_A * ( 1.0 + mu3_C )
+      + ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C )
+      - 1.0,
+      2.0 )
+      );
+    /** Calculate the derivative of the properness condition. */
+    /** mu1, part 1 */
+    valuePC
+      = +( 1.0 + mu1_A ) * mu2_C * mu2_C * mu3_B * mu3_B
+      + ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
+      + mu1_C * ( 1.0 + mu2_B ) * mu2_C * mu3_A * mu3_B
+      - mu1_C * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * mu3_A * ( 1.0 + mu3_C )
+      - mu1_B * mu2_C * mu2_C * mu3_A * mu3_B
+      + mu1_B * ( 1.0 + mu2_B ) * mu2_C * mu3_A * ( 1.0 + mu3_C )
+      - mu1_C * mu2_A * mu2_C * mu3_B * mu3_B
+      + mu1_C * mu2_A * ( 1.0 + mu2_B ) * mu3_B * ( 1.0 + mu3_C )
+      + mu1_B * mu2_A * mu2_C * mu3_B * ( 1.0 + mu3_C )
+      - 2.0 * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * mu2_C * mu3_B * ( 1.0 + mu3_C )
+      + mu2_C * mu3_B
+      - mu1_B * mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
+      - ( 1.0 + mu2_B ) * ( 1.0 + mu3_C );
+    parts[ 0 ][ 0 ] = 2.0 * valuePC;
+    /** mu1, part 2 */
+    valuePC
+      = +mu1_B * mu2_C * mu2_C * mu3_A * mu3_A
+      + mu1_B * mu2_A * mu2_A * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
+      - mu1_C * ( 1.0 + mu2_B ) * mu2_C * mu3_A * mu3_A
+      + mu1_C * mu2_A * ( 1.0 + mu2_B ) * mu3_A * ( 1.0 + mu3_C )
+      + mu1_C * mu2_A * mu2_C * mu3_A * mu3_B
+      - ( 1.0 + mu1_A ) * mu2_C * mu2_C * mu3_A * mu3_B
+      - 2.0 * mu1_B * mu2_A * mu2_C * mu3_A * ( 1.0 + mu3_C )
+      + ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * mu2_C * mu3_A * ( 1.0 + mu3_C )
+      - mu2_C * mu3_A
+      - mu1_C * mu2_A * mu2_A * mu3_B * ( 1.0 + mu3_C )
+      + ( 1.0 + mu1_A ) * mu2_A * mu2_C * mu3_B * ( 1.0 + mu3_C )
+      - ( 1.0 + mu1_A ) * mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
+      + mu2_A * ( 1.0 + mu3_C );
+    parts[ 0 ][ 1 ] = 2.0 * valuePC;
+    /** mu1, part 3 */
+    valuePC
+      = +mu1_C * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * mu3_A * mu3_A
+      + mu1_C * mu2_A * mu2_A * mu3_B * mu3_B
+      - mu1_B * ( 1.0 + mu2_B ) * mu2_C * mu3_A * mu3_A
+      - 2.0 * mu1_C * mu2_A * ( 1.0 + mu2_B ) * mu3_A * mu3_B
+      + ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * mu2_C * mu3_A * mu3_B
+      + mu1_B * mu2_A * ( 1.0 + mu2_B ) * mu3_A * ( 1.0 + mu3_C )
+      - ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * mu3_A * ( 1.0 + mu3_C )
+      + ( 1.0 + mu2_B ) * mu3_A
+      + mu1_B * mu2_A * mu2_C * mu3_A * mu3_B
+      - ( 1.0 + mu1_A ) * mu2_A * mu2_C * mu3_B * mu3_B
+      - mu1_B * mu2_A * mu2_A * mu3_B * ( 1.0 + mu3_C )
+      + ( 1.0 + mu1_A ) * mu2_A * ( 1.0 + mu2_B ) * mu3_B * ( 1.0 + mu3_C )
+      - mu2_A * mu3_B;
+    parts[ 0 ][ 2 ] = 2.0 * valuePC;
+    /** mu2, part 1 */
+    valuePC
+      = +mu1_C * mu1_C * mu2_A * mu3_B * mu3_B
+      + mu1_B * mu1_B * mu2_A * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
+      - mu1_C * mu1_C * ( 1.0 + mu2_B ) * mu3_A * mu3_B
+      + mu1_B * mu1_C * ( 1.0 + mu2_B ) * mu3_A * ( 1.0 + mu3_C )
+      + mu1_B * mu1_C * mu2_C * mu3_A * mu3_B
+      - mu1_B * mu1_B * mu2_C * mu3_A * ( 1.0 + mu3_C )
+      - ( 1.0 + mu1_A ) * mu1_C * mu2_C * mu3_B * mu3_B
+      - 2.0 * mu1_B * mu1_C * mu2_A * mu3_B * ( 1.0 + mu3_C )
+      + ( 1.0 + mu1_A ) * mu1_C * ( 1.0 + mu2_B ) * mu3_B * ( 1.0 + mu3_C )
+      - mu1_C * mu3_B
+      + ( 1.0 + mu1_A ) * mu1_B * mu2_C * mu3_B * ( 1.0 + mu3_C )
+      - ( 1.0 + mu1_A ) * mu1_B * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
+      + mu1_B * ( 1.0 + mu3_C );
+    parts[ 1 ][ 0 ] = 2.0 * valuePC;
+    /** mu2, part 2 */
+    valuePC
+      = +mu1_C * mu1_C * ( 1.0 + mu2_B ) * mu3_A * mu3_A
+      + ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
+      - mu1_B * mu1_C * mu2_C * mu3_A * mu3_A
+      - mu1_C * mu1_C * mu2_A * mu3_A * mu3_B
+      + ( 1.0 + mu1_A ) * mu1_C * mu2_C * mu3_A * mu3_B
+      + mu1_B * mu1_C * mu2_A * mu3_A * ( 1.0 + mu3_C )
+      - 2.0 * ( 1.0 + mu1_A ) * mu1_C * ( 1.0 + mu2_B ) * mu3_A * ( 1.0 + mu3_C )
+      + mu1_C * mu3_A
+      + ( 1.0 + mu1_A ) * mu1_B * mu2_C * mu3_A * ( 1.0 + mu3_C )
+      + ( 1.0 + mu1_A ) * mu1_C * mu2_A * mu3_B * ( 1.0 + mu3_C )
+      - ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * mu2_C * mu3_B * ( 1.0 + mu3_C )
+      - ( 1.0 + mu1_A ) * mu1_B * mu2_A * ( 1.0 + mu3_C ) * ( 1.0 + mu3_C )
+      - ( 1.0 + mu1_A ) * ( 1.0 + mu3_C );
+    parts[ 1 ][ 1 ] = 2.0 * valuePC;
+    /** mu2, part 3 */
+    valuePC
+      = +mu1_B * mu1_B * mu2_C * mu3_A * mu3_A
+      + ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * mu2_C * mu3_B * mu3_B
+      - mu1_B * mu1_C * ( 1.0 + mu2_B ) * mu3_A * mu3_A
+      + ( 1.0 + mu1_A ) * mu1_C * ( 1.0 + mu2_B ) * mu3_A * mu3_B
+      + mu1_B * mu1_C * mu2_A * mu3_A * mu3_B
+      - 2.0 * ( 1.0 + mu1_A ) * mu1_B * mu2_C * mu3_A * mu3_B
+      - mu1_B * mu1_B * mu2_A * mu3_A * ( 1.0 + mu3_C )
+      + ( 1.0 + mu1_A ) * mu1_B * ( 1.0 + mu2_B ) * mu3_A * ( 1.0 + mu3_C )
+      - mu1_B * mu3_A
+      - ( 1.0 + mu1_A ) * mu1_C * mu2_A * mu3_B * mu3_B
+      + ( 1.0 + mu1_A ) * mu1_B * mu2_A * mu3_B * ( 1.0 + mu3_C )
+      - ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * mu3_B * ( 1.0 + mu3_C )
+      + ( 1.0 + mu1_A ) * mu3_B;
+    parts[ 1 ][ 2 ] = 2.0 * valuePC;
+    /** mu3, part 1 */
+    valuePC
+      = +mu1_C * mu1_C * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * mu3_A
+      + mu1_B * mu1_B * mu2_C * mu2_C * mu3_A
+      - 2.0 * mu1_B * mu1_C * ( 1.0 + mu2_B ) * mu2_C * mu3_A
+      - mu1_C * mu1_C * mu2_A * ( 1.0 + mu2_B ) * mu3_B
+      + ( 1.0 + mu1_A ) * mu1_C * ( 1.0 + mu2_B ) * mu2_C * mu3_B
+      + mu1_B * mu1_C * mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C )
+      - ( 1.0 + mu1_A ) * mu1_C * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C )
+      + mu1_C * ( 1.0 + mu2_B )
+      + mu1_B * mu1_C * mu2_A * mu2_C * mu3_B
+      - ( 1.0 + mu1_A ) * mu1_B * mu2_C * mu2_C * mu3_B
+      - mu1_B * mu1_B * mu2_A * mu2_C * ( 1.0 + mu3_C )
+      + ( 1.0 + mu1_A ) * mu1_B * ( 1.0 + mu2_B ) * mu2_C * ( 1.0 + mu3_C )
+      + mu1_B * mu2_C;
+    parts[ 2 ][ 0 ] = 2.0 * valuePC;
+    /** mu3, part 2 */
+    valuePC
+      = +mu1_C * mu1_C * mu2_A * mu2_A * mu3_B
+      + ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * mu2_C * mu2_C * mu3_B
+      - mu1_C * mu1_C * mu2_A * ( 1.0 + mu2_B ) * mu3_A
+      + ( 1.0 + mu1_A ) * mu1_C * ( 1.0 + mu2_B ) * mu2_C * mu3_A
+      + mu1_B * mu1_C * mu2_A * mu2_C * mu3_A
+      - ( 1.0 + mu1_A ) * mu1_B * mu2_C * mu2_C * mu3_A
+      - 2.0 * ( 1.0 + mu1_A ) * mu1_C * mu2_A * mu2_C * mu3_B
+      - mu1_B * mu1_C * mu2_A * mu2_A * ( 1.0 + mu3_C )
+      + ( 1.0 + mu1_A ) * mu1_C * mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C )
+      - mu1_C * mu2_A
+      + ( 1.0 + mu1_A ) * mu1_B * mu2_A * mu2_C * ( 1.0 + mu3_C )
+      - ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * mu2_C * ( 1.0 + mu3_C )
+      + ( 1.0 + mu1_A ) * mu2_C;
+    parts[ 2 ][ 1 ] = 2.0 * valuePC;
+    /** mu3, part 3 */
+    valuePC
+      = +mu1_B * mu1_B * mu2_A * mu2_A * ( 1.0 + mu3_C )
+      + ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C )
+      + mu1_B * mu1_C * mu2_A * ( 1.0 + mu2_B ) * mu3_A
+      - ( 1.0 + mu1_A ) * mu1_C * ( 1.0 + mu2_B ) * ( 1.0 + mu2_B ) * mu3_A
+      - mu1_B * mu1_B * mu2_A * mu2_C * mu3_A
+      + ( 1.0 + mu1_A ) * mu1_B * ( 1.0 + mu2_B ) * mu2_C * mu3_A
+      - mu1_B * mu1_C * mu2_A * mu2_A * mu3_B
+      + ( 1.0 + mu1_A ) * mu1_C * mu2_A * ( 1.0 + mu2_B ) * mu3_B
+      + ( 1.0 + mu1_A ) * mu1_B * mu2_A * mu2_C * mu3_B
+      + ( 1.0 + mu1_A ) * ( 1.0 + mu1_A ) * ( 1.0 + mu2_B ) * mu2_C * mu3_B
+      - 2.0 * ( 1.0 + mu1_A ) * mu1_B * mu2_A * ( 1.0 + mu2_B ) * ( 1.0 + mu3_C )
+      + mu1_B * mu2_A
+      - ( 1.0 + mu1_A ) * ( 1.0 + mu2_B );
+    parts[ 2 ][ 2 ] = 2.0 * valuePC;
+  } // end if dim == 3
+
+  return value;
+
+} // end ComputePropernessConditionParts()
+
+
 /**
  * ********************* PrintSelf ******************************
  */
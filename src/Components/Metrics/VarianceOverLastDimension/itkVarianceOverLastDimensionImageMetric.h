@@ -144,6 +144,9 @@ public:
     DerivativeType & derivative ) const;
 
   /** Get value and derivatives for multiple valued optimizers. */
+  void GetValueAndDerivativeSingleThreaded( const TransformParametersType & parameters,
+    MeasureType & value, DerivativeType & derivative ) const;
+
   virtual void GetValueAndDerivative( const TransformParametersType & parameters,
     MeasureType & Value, DerivativeType & Derivative ) const;
 
@@ -182,6 +185,13 @@ protected:
     const MovingImageDerivativeType & movingImageDerivative,
     DerivativeType & imageJacobian ) const;
 
+  /** Get value and derivatives for each thread. */
+  inline void ThreadedGetValueAndDerivative( ThreadIdType threadID );
+
+  /** Gather the values and derivatives from all threads. */
+  inline void AfterThreadedGetValueAndDerivative(
+    MeasureType & value, DerivativeType & derivative ) const;
+
 private:
 
   VarianceOverLastDimensionImageMetric( const Self & ); // purposely not implemented
@@ -190,6 +200,39 @@ private:
   /** Sample n random numbers from 0..m and add them to the vector. */
   void SampleRandom( const int n, const int m, std::vector< int > & numbers ) const;
 
+  /** Intermediate results of one fixed image sample, along the last dimension. */
+  struct LastDimensionWorkspaceType
+  {
+    std::vector< RealType >                   m_MovingImageValues;
+    std::vector< DerivativeType >             m_ImageJacobians;
+    std::vector< NonZeroJacobianIndicesType > m_NonZeroJacobianIndices;
+    TransformJacobianType                     m_Jacobian;
+    DerivativeType                            m_ImageJacobian;
+  };
+
+  /** Allocate the workspace for numberOfPositions positions along the last dimension. */
+  void InitializeLastDimensionWorkspace( const unsigned int numberOfPositions,
+    LastDimensionWorkspaceType & workspace ) const;
+
+  /** Add the variance along the last dimension at fixedPoint to measure, and
+   * its derivative to derivative. The positions along the last dimension are
+   * given by lastDimPositions. Returns false if no position was valid.
+   * Used by both the single-threaded and the multi-threaded code.
+   */
+  bool UpdateValueAndDerivativeTerms( const FixedImagePointType & fixedPoint,
+    const int * lastDimPositions, LastDimensionWorkspaceType & workspace,
+    MeasureType & measure, DerivativeType & derivative ) const;
+
+  /** Subtract the mean over the last dimension from the derivative. */
+  void SubtractMeanFromDerivative( DerivativeType & derivative ) const;
+
+  /** The random positions along the last dimension of all samples, when
+   * SampleLastDimensionRandomly is true. They are drawn single-threadedly
+   * before the threads are launched, in the same order as the single-threaded
+   * code, so that both give the same results.
+   */
+  mutable std::vector< int > m_RandomLastDimPositions;
+
   /** Variables to control random sampling in last dimension. */
   bool         m_SampleLastDimensionRandomly;
   unsigned int m_NumSamplesLastDimension;
@@ -22,6 +22,7 @@
 #include "itkMersenneTwisterRandomVariateGenerator.h"
 #include "vnl/algo/vnl_matrix_update.h"
 #include <numeric>
+#include <algorithm>
 
 namespace itk
 {
@@ -355,13 +356,229 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
 
 
 /**
- * ******************* GetValueAndDerivative *******************
+ * ******************* InitializeLastDimensionWorkspace *******************
  */
 
 template< class TFixedImage, class TMovingImage >
 void
 VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
-::GetValueAndDerivative( const TransformParametersType & parameters,
+::InitializeLastDimensionWorkspace( const unsigned int numberOfPositions,
+  LastDimensionWorkspaceType & workspace ) const
+{
+  const NumberOfParametersType nnzji = this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices();
+
+  workspace.m_MovingImageValues.resize( numberOfPositions );
+  workspace.m_ImageJacobians.resize( numberOfPositions );
+  workspace.m_NonZeroJacobianIndices.assign( numberOfPositions, NonZeroJacobianIndicesType() );
+  workspace.m_ImageJacobian.SetSize( nnzji );
+
+} // end InitializeLastDimensionWorkspace()
+
+
+/**
+ * ******************* UpdateValueAndDerivativeTerms *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+bool
+VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
+::UpdateValueAndDerivativeTerms( const FixedImagePointType & fixedPoint,
+  const int * lastDimPositions, LastDimensionWorkspaceType & workspace,
+  MeasureType & measure, DerivativeType & derivative ) const
+{
+  typedef typename DerivativeType::ValueType DerivativeValueType;
+
+  /** Retrieve slowest varying dimension. */
+  const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int realNumLastDimPositions = workspace.m_MovingImageValues.size();
+
+  std::vector< RealType > &                   MT     = workspace.m_MovingImageValues;
+  std::vector< DerivativeType > &             dMTdmu = workspace.m_ImageJacobians;
+  std::vector< NonZeroJacobianIndicesType > & nzjis  = workspace.m_NonZeroJacobianIndices;
+
+  /** Initialize MT vector. */
+  std::fill( MT.begin(), MT.end(), itk::NumericTraits< RealType >::ZeroValue() );
+
+  /** Transform sampled point to voxel coordinates. */
+  FixedImagePointType           point = fixedPoint;
+  FixedImageContinuousIndexType voxelCoord;
+  this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( point, voxelCoord );
+
+  /** Loop over the slowest varying dimension. */
+  float        sumValues        = 0.0;
+  float        sumValuesSquared = 0.0;
+  unsigned int numSamplesOk     = 0;
+
+  /** First loop over t: compute M(T(x,t)), dM(T(x,t))/dmu, nzji and store. */
+  for( unsigned int d = 0; d < realNumLastDimPositions; ++d )
+  {
+    /** Initialize some variables. */
+    RealType                  movingImageValue;
+    MovingImagePointType      mappedPoint;
+    MovingImageDerivativeType movingImageDerivative;
+
+    /** Set fixed point's last dimension to lastDimPosition. */
+    voxelCoord[ lastDim ] = lastDimPositions[ d ];
+    /** Transform sampled point back to world coordinates. */
+    this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, point );
+    /** Transform point and check if it is inside the B-spline support region. */
+    bool sampleOk = this->TransformPoint( point, mappedPoint );
+
+    /** Check if point is inside mask. */
+    if( sampleOk )
+    {
+      sampleOk = this->IsInsideMovingMask( mappedPoint );
+    }
+
+    /** Compute the moving image value and check if the point is
+    * inside the moving image buffer. */
+    if( sampleOk )
+    {
+      sampleOk = this->EvaluateMovingImageValueAndDerivative(
+        mappedPoint, movingImageValue, &movingImageDerivative );
+    }
+
+    if( sampleOk )
+    {
+      /** Update value terms **/
+      numSamplesOk++;
+      sumValues        += movingImageValue;
+      sumValuesSquared += movingImageValue * movingImageValue;
+
+      /** Get the TransformJacobian dT/dmu. */
+      this->EvaluateTransformJacobian( point, workspace.m_Jacobian, nzjis[ d ] );
+
+      /** Compute the innerproduct (dM/dx)^T (dT/dmu). */
+      this->EvaluateTransformJacobianInnerProduct(
+        workspace.m_Jacobian, movingImageDerivative, workspace.m_ImageJacobian );
+
+      /** Store values. */
+      MT[ d ]     = movingImageValue;
+      dMTdmu[ d ] = workspace.m_ImageJacobian;
+    }
+    else
+    {
+      dMTdmu[ d ] = DerivativeType( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
+      dMTdmu[ d ].Fill( itk::NumericTraits< DerivativeValueType >::ZeroValue() );
+      nzjis[ d ] = NonZeroJacobianIndicesType( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices(), 0 );
+    } // end if sampleOk
+  }
+
+  if( numSamplesOk == 0 )
+  {
+    return false;
+  }
+
+  /** Compute average intensity value. */
+  const float expectedValue = sumValues / static_cast< float >( numSamplesOk );
+  /** Add this variance to the variance sum. */
+  const float expectedSquaredValue = sumValuesSquared / static_cast< float >( numSamplesOk );
+  measure += expectedSquaredValue - expectedValue * expectedValue;
+
+  /** Second loop over t: update derivative. */
+  for( unsigned int d = 0; d < realNumLastDimPositions; ++d )
+  {
+    for( unsigned int j = 0; j < nzjis[ d ].size(); ++j )
+    {
+      derivative[ nzjis[ d ][ j ] ] += ( 2.0 * ( MT[ d ] - expectedValue ) * dMTdmu[ d ][ j ] )
+        / static_cast< float >( numSamplesOk );
+    }
+  }
+
+  return true;
+
+} // end UpdateValueAndDerivativeTerms()
+
+
+/**
+ * ******************* SubtractMeanFromDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
+::SubtractMeanFromDerivative( DerivativeType & derivative ) const
+{
+  /** Retrieve slowest varying dimension and its size. */
+  const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int lastDimSize
+    = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
+
+  if( !this->m_TransformIsStackTransform )
+  {
+    /** Update derivative per dimension.
+    * Parameters are ordered xxxxxxx yyyyyyy zzzzzzz ttttttt and
+    * per dimension xyz.
+    */
+    const unsigned int lastDimGridSize              = this->m_GridSize[ lastDim ];
+    const unsigned int numParametersPerDimension    = this->GetNumberOfParameters() / this->GetMovingImage()->GetImageDimension();
+    const unsigned int numControlPointsPerDimension = numParametersPerDimension / lastDimGridSize;
+    DerivativeType     mean( numControlPointsPerDimension );
+    for( unsigned int d = 0; d < this->GetMovingImage()->GetImageDimension(); ++d )
+    {
+      /** Compute mean per dimension. */
+      mean.Fill( 0.0 );
+      const unsigned int starti = numParametersPerDimension * d;
+      for( unsigned int i = starti; i < starti + numParametersPerDimension; ++i )
+      {
+        const unsigned int index = i % numControlPointsPerDimension;
+        mean[ index ] += derivative[ i ];
+      }
+      mean /= static_cast< double >( lastDimGridSize );
+
+      /** Update derivative for every control point per dimension. */
+      for( unsigned int i = starti; i < starti + numParametersPerDimension; ++i )
+      {
+        const unsigned int index = i % numControlPointsPerDimension;
+        derivative[ i ] -= mean[ index ];
+      }
+    }
+  }
+  else
+  {
+    /** Update derivative per dimension.
+    * Parameters are ordered x0x0x0y0y0y0z0z0z0x1x1x1y1y1y1z1z1z1 with
+    * the number the time point index.
+    */
+    const unsigned int numParametersPerLastDimension = this->GetNumberOfParameters() / lastDimSize;
+    DerivativeType     mean( numParametersPerLastDimension );
+    mean.Fill( 0.0 );
+
+    /** Compute mean per control point. */
+    for( unsigned int t = 0; t < lastDimSize; ++t )
+    {
+      const unsigned int startc = numParametersPerLastDimension * t;
+      for( unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c )
+      {
+        const unsigned int index = c % numParametersPerLastDimension;
+        mean[ index ] += derivative[ c ];
+      }
+    }
+    mean /= static_cast< double >( lastDimSize );
+
+    /** Update derivative per control point. */
+    for( unsigned int t = 0; t < lastDimSize; ++t )
+    {
+      const unsigned int startc = numParametersPerLastDimension * t;
+      for( unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c )
+      {
+        const unsigned int index = c % numParametersPerLastDimension;
+        derivative[ c ] -= mean[ index ];
+      }
+    }
+  }
+
+} // end SubtractMeanFromDerivative()
+
+
+/**
+ * ******************* GetValueAndDerivativeSingleThreaded *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
+::GetValueAndDerivativeSingleThreaded( const TransformParametersType & parameters,
   MeasureType & value, DerivativeType & derivative ) const
 {
   itkDebugMacro( "GetValueAndDerivative( " << parameters << " ) " );
@@ -415,28 +632,21 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
     }
   }
 
-  /** Create variables to store intermediate results in. */
-  TransformJacobianType jacobian;
-  DerivativeType        imageJacobian( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
-
   /** Get real last dim samples. */
   const unsigned int realNumLastDimPositions
     = this->m_SampleLastDimensionRandomly
     ? this->m_NumSamplesLastDimension + this->m_NumAdditionalSamplesFixed
     : lastDimSize;
 
-  /** Variable to store and nzjis. */
-  std::vector< NonZeroJacobianIndicesType > nzjis(
-  realNumLastDimPositions, NonZeroJacobianIndicesType() );
-
-  std::vector< RealType >       MT( realNumLastDimPositions );
-  std::vector< DerivativeType > dMTdmu( realNumLastDimPositions );
+  /** Create variables to store intermediate results in. */
+  LastDimensionWorkspaceType workspace;
+  this->InitializeLastDimensionWorkspace( realNumLastDimPositions, workspace );
 
   /** Loop over the fixed image samples to calculate the variance over time for every sample position. */
   for( fiter = fbegin; fiter != fend; ++fiter )
   {
     /** Read fixed coordinates. */
-    FixedImagePointType fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
+    const FixedImagePointType & fixedPoint = ( *fiter ).Value().m_ImageCoordinates;
 
     /** Determine random last dimension positions if needed. */
     if( this->m_SampleLastDimensionRandomly )
@@ -444,176 +654,221 @@ VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
       this->SampleRandom( this->m_NumSamplesLastDimension, lastDimSize, lastDimPositions );
     }
 
-    /** Initialize MT vector. */
-    std::fill( MT.begin(), MT.end(), itk::NumericTraits< RealType >::ZeroValue() );
+    /** Compute the variance over time and its derivative. */
+    if( this->UpdateValueAndDerivativeTerms( fixedPoint, &lastDimPositions[ 0 ],
+      workspace, measure, derivative ) )
+    {
+      this->m_NumberOfPixelsCounted++;
+    }
+  } // end for loop over the image sample container
 
-    /** Transform sampled point to voxel coordinates. */
-    FixedImageContinuousIndexType voxelCoord;
-    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex( fixedPoint, voxelCoord );
+  /** Check if enough samples were valid. */
+  this->CheckNumberOfSamples(
+    sampleContainer->Size(), this->m_NumberOfPixelsCounted );
 
-    /** Loop over the slowest varying dimension. */
-    float        sumValues        = 0.0;
-    float        sumValuesSquared = 0.0;
-    unsigned int numSamplesOk     = 0;
+  /** Compute average over variances and normalize with initial variance. */
+  measure    /= static_cast< float >( this->m_NumberOfPixelsCounted * this->m_InitialVariance );
+  derivative /= static_cast< float >( this->m_NumberOfPixelsCounted * this->m_InitialVariance );
 
-    /** First loop over t: compute M(T(x,t)), dM(T(x,t))/dmu, nzji and store. */
-    for( unsigned int d = 0; d < realNumLastDimPositions; ++d )
-    {
-      /** Initialize some variables. */
-      RealType                  movingImageValue;
-      MovingImagePointType      mappedPoint;
-      MovingImageDerivativeType movingImageDerivative;
+  /** Subtract mean from derivative elements. */
+  if( this->m_SubtractMean )
+  {
+    this->SubtractMeanFromDerivative( derivative );
+  }
 
-      /** Set fixed point's last dimension to lastDimPosition. */
-      voxelCoord[ lastDim ] = lastDimPositions[ d ];
-      /** Transform sampled point back to world coordinates. */
-      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint( voxelCoord, fixedPoint );
-      /** Transform point and check if it is inside the B-spline support region. */
-      bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
+  /** Return the measure value. */
+  value = measure;
 
-      /** Check if point is inside mask. */
-      if( sampleOk )
-      {
-        sampleOk = this->IsInsideMovingMask( mappedPoint );
-      }
+} // end GetValueAndDerivativeSingleThreaded()
 
-      /** Compute the moving image value and check if the point is
-      * inside the moving image buffer. */
-      if( sampleOk )
-      {
-        sampleOk = this->EvaluateMovingImageValueAndDerivative(
-          mappedPoint, movingImageValue, &movingImageDerivative );
-      }
 
-      if( sampleOk )
-      {
-        /** Update value terms **/
-        numSamplesOk++;
-        sumValues        += movingImageValue;
-        sumValuesSquared += movingImageValue * movingImageValue;
+/**
+ * ******************* GetValueAndDerivative *******************
+ */
 
-        /** Get the TransformJacobian dT/dmu. */
-        this->EvaluateTransformJacobian( fixedPoint, jacobian, nzjis[ d ] );
+template< class TFixedImage, class TMovingImage >
+void
+VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
+::GetValueAndDerivative( const TransformParametersType & parameters,
+  MeasureType & value, DerivativeType & derivative ) const
+{
+  /** Option for now to still use the single threaded code. */
+  if( !this->m_UseMultiThread )
+  {
+    return this->GetValueAndDerivativeSingleThreaded(
+      parameters, value, derivative );
+  }
 
-        /** Compute the innerproduct (dM/dx)^T (dT/dmu). */
-        this->EvaluateTransformJacobianInnerProduct(
-          jacobian, movingImageDerivative, imageJacobian );
+  /** Call non-thread-safe stuff, such as:
+   *   this->SetTransformParameters( parameters );
+   *   this->GetImageSampler()->Update();
+   * See GetValueAndDerivativeSingleThreaded() for details.
+   */
+  this->BeforeThreadedGetValueAndDerivative( parameters );
 
-        /** Store values. */
-        MT[ d ]     = movingImageValue;
-        dMTdmu[ d ] = imageJacobian;
-      }
-      else
-      {
-        dMTdmu[ d ] = DerivativeType( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices() );
-        dMTdmu[ d ].Fill( itk::NumericTraits< DerivativeValueType >::ZeroValue() );
-        nzjis[ d ] = NonZeroJacobianIndicesType( this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices(), 0 );
-      } // end if sampleOk
+  /** The random number generator is not thread-safe. Therefore, draw the
+   * positions along the last dimension for all samples here, in the same
+   * order as the single-threaded code does.
+   */
+  this->m_RandomLastDimPositions.clear();
+  if( this->m_SampleLastDimensionRandomly )
+  {
+    const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+    const unsigned int lastDimSize
+      = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
+    const SizeValueType numberOfSamples = this->GetImageSampler()->GetOutput()->Size();
+    const unsigned int  realNumLastDimPositions
+      = this->m_NumSamplesLastDimension + this->m_NumAdditionalSamplesFixed;
+
+    std::vector< int > lastDimPositions;
+    this->m_RandomLastDimPositions.reserve( numberOfSamples * realNumLastDimPositions );
+    for( SizeValueType i = 0; i < numberOfSamples; ++i )
+    {
+      this->SampleRandom( this->m_NumSamplesLastDimension, lastDimSize, lastDimPositions );
+      this->m_RandomLastDimPositions.insert( this->m_RandomLastDimPositions.end(),
+        lastDimPositions.begin(), lastDimPositions.end() );
     }
+  }
 
-    if( numSamplesOk > 0 )
-    {
-      this->m_NumberOfPixelsCounted++;
+  /** Launch multi-threading metric */
+  this->LaunchGetValueAndDerivativeThreaderCallback();
 
-      /** Compute average intensity value. */
-      const float expectedValue = sumValues / static_cast< float >( numSamplesOk );
-      /** Add this variance to the variance sum. */
-      const float expectedSquaredValue = sumValuesSquared / static_cast< float >( numSamplesOk );
-      measure += expectedSquaredValue - expectedValue * expectedValue;
+  /** Gather the metric values and derivatives from all threads. */
+  this->AfterThreadedGetValueAndDerivative( value, derivative );
+
+} // end GetValueAndDerivative()
+
+
+/**
+ * ******************* ThreadedGetValueAndDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
+::ThreadedGetValueAndDerivative( ThreadIdType threadId )
+{
+  /** Retrieve slowest varying dimension and its size. */
+  const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int lastDimSize
+    = this->GetFixedImage()->GetLargestPossibleRegion().GetSize( lastDim );
+
+  /** Positions along the last dimension when random sampling is turned off. */
+  std::vector< int > allLastDimPositions( lastDimSize );
+  for( unsigned int i = 0; i < lastDimSize; ++i )
+  {
+    allLastDimPositions[ i ] = i;
+  }
+
+  /** Get real last dim samples. */
+  const unsigned int realNumLastDimPositions
+    = this->m_SampleLastDimensionRandomly
+    ? this->m_NumSamplesLastDimension + this->m_NumAdditionalSamplesFixed
+    : lastDimSize;
+
+  /** Create variables to store intermediate results in. */
+  LastDimensionWorkspaceType workspace;
+  this->InitializeLastDimensionWorkspace( realNumLastDimPositions, workspace );
+
+  /** Get a handle to the pre-allocated derivative for the current thread.
+   * The initialization is performed at the beginning of each resolution in
+   * InitializeThreadingParameters(), and at the end of each iteration in
+   * AfterThreadedGetValueAndDerivative() and the accumulate functions.
+   */
+  DerivativeType & derivative = this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_Derivative;
+
+  /** The samples are handed out to this thread in one or more ranges
+   * [pos_begin, pos_end) by the sample scheduler.
+   */
+  SizeValueType pos_begin = 0;
+  SizeValueType pos_end   = 0;
 
-      /** Second loop over t: update derivative. */
-      for( unsigned int d = 0; d < realNumLastDimPositions; ++d )
+  /** Create variables to store intermediate results. circumvent false sharing */
+  unsigned long numberOfPixelsCounted = 0;
+  MeasureType   measure               = NumericTraits< MeasureType >::Zero;
+
+  /** Loop over the sample ranges assigned to this thread. */
+  while( this->GetNextSampleRange( threadId, pos_begin, pos_end ) )
+  {
+    for( SizeValueType i = pos_begin; i < pos_end; ++i )
+    {
+      /** Read fixed coordinates. */
+      FixedImagePointType fixedPoint;
+      RealType            fixedImageValue;
+      this->GetThreaderSample( i, fixedPoint, fixedImageValue );
+
+      /** Get the positions along the last dimension of this sample. */
+      const int * lastDimPositions = this->m_SampleLastDimensionRandomly
+        ? &this->m_RandomLastDimPositions[ i * realNumLastDimPositions ]
+        : &allLastDimPositions[ 0 ];
+
+      /** Compute the variance over time and its derivative. */
+      if( this->UpdateValueAndDerivativeTerms( fixedPoint, lastDimPositions,
+        workspace, measure, derivative ) )
       {
-        for( unsigned int j = 0; j < nzjis[ d ].size(); ++j )
-        {
-          derivative[ nzjis[ d ][ j ] ] += ( 2.0 * ( MT[ d ] - expectedValue ) * dMTdmu[ d ][ j ] )
-            / static_cast< float >( numSamplesOk );
-        }
+        ++numberOfPixelsCounted;
       }
-
     }
-  } // end for loop over the image sample container
+  } // end while loop over the sample ranges
+
+  /** Only update these variables at the end to prevent unnecessary "false sharing". */
+  this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_NumberOfPixelsCounted = numberOfPixelsCounted;
+  this->m_GetValueAndDerivativePerThreadVariables[ threadId ].st_Value                 = measure;
+
+} // end ThreadedGetValueAndDerivative()
+
+
+/**
+ * ******************* AfterThreadedGetValueAndDerivative *******************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+VarianceOverLastDimensionImageMetric< TFixedImage, TMovingImage >
+::AfterThreadedGetValueAndDerivative(
+  MeasureType & value, DerivativeType & derivative ) const
+{
+  /** Profile the accumulation of the thread results, if desired. */
+  PhaseProfiler::ScopedProbe probe( "AfterThreadedGetValueAndDerivative" );
+
+  /** Accumulate the number of pixels and the values. */
+  this->m_NumberOfPixelsCounted = 0;
+  value = NumericTraits< MeasureType >::Zero;
+  for( ThreadIdType i = 0; i < this->m_NumberOfThreads; ++i )
+  {
+    this->m_NumberOfPixelsCounted += this->m_GetValueAndDerivativePerThreadVariables[ i ].st_NumberOfPixelsCounted;
+    value                         += this->m_GetValueAndDerivativePerThreadVariables[ i ].st_Value;
+
+    /** Reset these variables for the next iteration. */
+    this->m_GetValueAndDerivativePerThreadVariables[ i ].st_NumberOfPixelsCounted = 0;
+    this->m_GetValueAndDerivativePerThreadVariables[ i ].st_Value = NumericTraits< MeasureType >::Zero;
+  }
 
   /** Check if enough samples were valid. */
+  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
   this->CheckNumberOfSamples(
     sampleContainer->Size(), this->m_NumberOfPixelsCounted );
 
   /** Compute average over variances and normalize with initial variance. */
-  measure    /= static_cast< float >( this->m_NumberOfPixelsCounted * this->m_InitialVariance );
-  derivative /= static_cast< float >( this->m_NumberOfPixelsCounted * this->m_InitialVariance );
+  const float normalization
+    = static_cast< float >( this->m_NumberOfPixelsCounted * this->m_InitialVariance );
+  value /= normalization;
+
+  /** Accumulate and normalize the derivatives, multi-threadedly. */
+  derivative.SetSize( this->GetNumberOfParameters() );
+  this->m_ThreaderMetricParameters.st_DerivativePointer   = derivative.begin();
+  this->m_ThreaderMetricParameters.st_NormalizationFactor = normalization;
+
+  this->ExecuteThreaderCallback( this->AccumulateDerivativesThreaderCallback,
+    const_cast< void * >( static_cast< const void * >( &this->m_ThreaderMetricParameters ) ) );
 
   /** Subtract mean from derivative elements. */
   if( this->m_SubtractMean )
   {
-    if( !this->m_TransformIsStackTransform )
-    {
-      /** Update derivative per dimension.
-      * Parameters are ordered xxxxxxx yyyyyyy zzzzzzz ttttttt and
-      * per dimension xyz.
-      */
-      const unsigned int lastDimGridSize              = this->m_GridSize[ lastDim ];
-      const unsigned int numParametersPerDimension    = this->GetNumberOfParameters() / this->GetMovingImage()->GetImageDimension();
-      const unsigned int numControlPointsPerDimension = numParametersPerDimension / lastDimGridSize;
-      DerivativeType     mean( numControlPointsPerDimension );
-      for( unsigned int d = 0; d < this->GetMovingImage()->GetImageDimension(); ++d )
-      {
-        /** Compute mean per dimension. */
-        mean.Fill( 0.0 );
-        const unsigned int starti = numParametersPerDimension * d;
-        for( unsigned int i = starti; i < starti + numParametersPerDimension; ++i )
-        {
-          const unsigned int index = i % numControlPointsPerDimension;
-          mean[ index ] += derivative[ i ];
-        }
-        mean /= static_cast< double >( lastDimGridSize );
-
-        /** Update derivative for every control point per dimension. */
-        for( unsigned int i = starti; i < starti + numParametersPerDimension; ++i )
-        {
-          const unsigned int index = i % numControlPointsPerDimension;
-          derivative[ i ] -= mean[ index ];
-        }
-      }
-    }
-    else
-    {
-      /** Update derivative per dimension.
-      * Parameters are ordered x0x0x0y0y0y0z0z0z0x1x1x1y1y1y1z1z1z1 with
-      * the number the time point index.
-      */
-      const unsigned int numParametersPerLastDimension = this->GetNumberOfParameters() / lastDimSize;
-      DerivativeType     mean( numParametersPerLastDimension );
-      mean.Fill( 0.0 );
-
-      /** Compute mean per control point. */
-      for( unsigned int t = 0; t < lastDimSize; ++t )
-      {
-        const unsigned int startc = numParametersPerLastDimension * t;
-        for( unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c )
-        {
-          const unsigned int index = c % numParametersPerLastDimension;
-          mean[ index ] += derivative[ c ];
-        }
-      }
-      mean /= static_cast< double >( lastDimSize );
-
-      /** Update derivative per control point. */
-      for( unsigned int t = 0; t < lastDimSize; ++t )
-      {
-        const unsigned int startc = numParametersPerLastDimension * t;
-        for( unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c )
-        {
-          const unsigned int index = c % numParametersPerLastDimension;
-          derivative[ c ] -= mean[ index ];
-        }
-      }
-    }
+    this->SubtractMeanFromDerivative( derivative );
   }
 
-  /** Return the measure value. */
-  value = measure;
-
-} // end GetValueAndDerivative()
+} // end AfterThreadedGetValueAndDerivative()
 
 
 } // end namespace itk
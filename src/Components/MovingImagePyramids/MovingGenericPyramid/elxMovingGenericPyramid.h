@@ -65,6 +65,13 @@ namespace elastix
  *    for rescaling the image, or the ResampleImageFilter. Shrinker is faster.\n
  *    example: <tt>(ImagePyramidUseShrinkImageFilter "true")</tt>\n
  *    Default false, so by default the resampler is used.
+ * \parameter ImagePyramidUseCascadedComputation: Flag to specify if a resolution level is
+ *    derived from the next finer level, by smoothing it with the incremental sigma and
+ *    rescaling it with the relative factors, where the schedules permit it. This is faster
+ *    for large images, but approximates the direct computation. Only used when
+ *    ComputePyramidImagesPerResolution is false.\n
+ *    example: <tt>(ImagePyramidUseCascadedComputation "true")</tt>\n
+ *    Default false.
  *
  * \ingroup ImagePyramids
  */
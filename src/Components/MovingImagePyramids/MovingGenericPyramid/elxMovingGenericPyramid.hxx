@@ -144,6 +144,12 @@ MovingGenericPyramid< TElastix >
     "ImagePyramidUseShrinkImageFilter", 0, false );
   this->SetUseShrinkImageFilter( useShrinkImageFilter );
 
+  /** Derive the levels from the finer levels where possible. */
+  bool useCascadedComputation = false;
+  this->m_Configuration->ReadParameter( useCascadedComputation,
+    "ImagePyramidUseCascadedComputation", 0, false );
+  this->SetUseCascadedComputation( useCascadedComputation );
+
   /** Decide whether or not to compute the pyramid images only for the current
    * resolution. Setting the option to true saves memory, since only one level
    * of the pyramid gets allocated per resolution.
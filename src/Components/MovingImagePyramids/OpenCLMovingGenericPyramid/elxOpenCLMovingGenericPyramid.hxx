@@ -121,6 +121,7 @@ OpenCLMovingGenericPyramid< TElastix >
     this->m_GPUPyramid->SetSmoothingSchedule( this->GetSmoothingSchedule() );
     this->m_GPUPyramid->SetUseShrinkImageFilter( this->GetUseShrinkImageFilter() );
     this->m_GPUPyramid->SetComputeOnlyForCurrentLevel( this->GetComputeOnlyForCurrentLevel() );
+    this->m_GPUPyramid->SetUseCascadedComputation( this->GetUseCascadedComputation() );
   }
 
   if( this->m_GPUPyramidReady )
@@ -589,6 +589,8 @@ AdaptiveStochasticGradientDescent< TElastix >
     this->m_NumberOfBandStructureSamples );
   computeJacobianTerms->SetNumberOfJacobianMeasurements(
     this->m_NumberOfJacobianMeasurements );
+  computeJacobianTerms->SetUseMultiThread( this->GetUseMultiThread() );
+  computeJacobianTerms->SetNumberOfThreads( this->m_Threader->GetNumberOfThreads() );
 
   /** Check if use scales. */
   bool useScales = this->GetUseScales();
@@ -23,6 +23,12 @@
 #include "itkImageRandomSamplerBase.h"
 #include "itkImageRandomCoordinateSampler.h"
 #include "itkScaledSingleValuedNonLinearOptimizer.h"
+#include "itkMultiThreader.h"
+#include "itkArray2D.h"
+#include "vnl/vnl_sparse_matrix.h"
+#include "vnl/vnl_diag_matrix.h"
+
+#include <vector>
 
 namespace itk
 {
@@ -32,6 +38,11 @@ namespace itk
  * More specifically this class computes the Jacobian terms related to the automatic
  * parameter estimation for the adaptive stochastic gradient descent optimizer.
  * Details can be found in the paper.
+ *
+ * The Jacobian measurements can be processed multi-threadedly. Each thread
+ * then accumulates the covariance of its part of the samples, storing only
+ * the rows of the parameters it touches, after which the rows of the
+ * covariance matrix are merged in parallel.
  */
 
 template< class TFixedImage, class TTransform >
@@ -91,6 +102,17 @@ public:
   itkSetMacro( NumberOfBandStructureSamples, unsigned int );
   itkSetMacro( NumberOfJacobianMeasurements, SizeValueType );
 
+  /** Set the number of threads. */
+  void SetNumberOfThreads( ThreadIdType numberOfThreads )
+  {
+    this->m_Threader->SetNumberOfThreads( numberOfThreads );
+  }
+
+
+  /** Use multi-threading or not. Default false. */
+  itkSetMacro( UseMultiThread, bool );
+  itkGetConstMacro( UseMultiThread, bool );
+
   /** Set the region over which the metric will be computed. */
   void SetFixedImageRegion( const FixedImageRegionType & region )
   {
@@ -146,6 +168,18 @@ protected:
   typedef typename TransformType::ScalarType             CoordinateRepresentationType;
   typedef typename TransformType::NumberOfParametersType NumberOfParametersType;
 
+  /** Typedefs for the covariance matrix. */
+  typedef double                                   CovarianceValueType;
+  typedef vnl_sparse_matrix< CovarianceValueType > SparseCovarianceMatrixType;
+  typedef vnl_diag_matrix< CovarianceValueType >   DiagCovarianceMatrixType;
+
+  /** Typedefs for multi-threading. */
+  typedef itk::MultiThreader             ThreaderType;
+  typedef ThreaderType::ThreadInfoStruct ThreadInfoType;
+
+  ThreaderType::Pointer m_Threader;
+  bool                  m_UseMultiThread;
+
   /** Sample the fixed image to compute the Jacobian terms. */
   // \todo: note that this is an exact copy of itk::ComputeDisplacementDistribution
   // in the future it would be better to refactoring this part of the code.
@@ -157,6 +191,67 @@ private:
   ComputeJacobianTerms( const Self & ); // purposely not implemented
   void operator=( const Self & );       // purposely not implemented
 
+  /** The per-thread part of the covariance matrix. The elements in the
+   * dominant bands are stored per touched row: row p is stored at
+   * st_BandRows[ st_BandRowIndices[ p ] * bandcovsize ]. The other
+   * elements are stored in the sparse matrix st_Covariance.
+   */
+  struct ComputeJacobianTermsPerThreadStruct
+  {
+    std::vector< int >                 st_BandRowIndices;
+    std::vector< CovarianceValueType > st_BandRows;
+    SparseCovarianceMatrixType         st_Covariance;
+    double                             st_MaxJJ;
+    double                             st_MaxJCJ;
+  };
+  std::vector< ComputeJacobianTermsPerThreadStruct > m_ComputePerThreadVariables;
+
+  /** The data shared by the threads. */
+  struct MultiThreaderParameterType
+  {
+    Self *                              st_Self;
+    ImageSampleContainerType *          st_SampleContainer;
+    const std::vector< unsigned int > * st_BandCovMap;
+    const std::vector< unsigned int > * st_BandCovMap2;
+    SparseCovarianceMatrixType *        st_Covariance;
+    const DiagCovarianceMatrixType *    st_DiagonalCovariance;
+  };
+
+  /** Run a threaded function on all threads, or on the calling thread only
+   * if multi-threading is switched off.
+   */
+  void ExecuteThreaderCallback( ThreadFunctionType callback,
+    MultiThreaderParameterType & parameters );
+
+  /** The callback functions. */
+  static ITK_THREAD_RETURN_TYPE ComputeCovarianceThreaderCallback( void * arg );
+
+  static ITK_THREAD_RETURN_TYPE MergeCovarianceThreaderCallback( void * arg );
+
+  static ITK_THREAD_RETURN_TYPE ComputeMaxJacobianTermsThreaderCallback( void * arg );
+
+  /** Accumulate the covariance of the Jacobians of a range of samples (TERM 1). */
+  void ThreadedComputeCovariance( ThreadIdType threadId, ThreadIdType numberOfThreads,
+    const MultiThreaderParameterType & parameters );
+
+  /** Add the band and sparse parts of all threads for a range of rows to the
+   * covariance matrix.
+   */
+  void ThreadedMergeCovariance( ThreadIdType threadId, ThreadIdType numberOfThreads,
+    const MultiThreaderParameterType & parameters );
+
+  /** Compute maxJJ and maxJCJ for a range of samples (TERM 3 and 4). */
+  void ThreadedComputeMaxJacobianTerms( ThreadIdType threadId, ThreadIdType numberOfThreads,
+    const MultiThreaderParameterType & parameters );
+
+  /** Add jactjac / n, with the nonzero Jacobian indices jacind, to the
+   * per-thread covariance.
+   */
+  void UpdateCovariance( const Array2D< CovarianceValueType > & jactjac,
+    const NonZeroJacobianIndicesType & jacind, const double n,
+    const MultiThreaderParameterType & parameters,
+    ComputeJacobianTermsPerThreadStruct & threadVariables ) const;
+
 };
 
 } // end namespace itk
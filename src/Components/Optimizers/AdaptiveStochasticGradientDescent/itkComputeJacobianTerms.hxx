@@ -25,6 +25,8 @@
 #include "vnl/vnl_diag_matrix.h"
 #include "vnl/vnl_sparse_matrix.h"
 
+#include <algorithm>
+
 namespace itk
 {
 /**
@@ -45,6 +47,9 @@ ComputeJacobianTerms< TFixedImage, TTransform >
   this->m_NumberOfBandStructureSamples = 0;
   this->m_NumberOfJacobianMeasurements = 0;
 
+  this->m_Threader       = ThreaderType::New();
+  this->m_UseMultiThread = false;
+
 } // end Constructor
 
 
@@ -73,13 +78,6 @@ ComputeJacobianTerms< TFixedImage, TTransform >
    * Term 4: maxJCJ, see (54)
    */
 
-  typedef double                                   CovarianceValueType;
-  typedef itk::Array2D< CovarianceValueType >      CovarianceMatrixType;
-  typedef vnl_sparse_matrix< CovarianceValueType > SparseCovarianceMatrixType;
-  typedef SparseCovarianceMatrixType::row          SparseRowType;
-  typedef itk::Array< SizeValueType >              NonZeroJacobianIndicesExpandedType;
-  typedef vnl_diag_matrix< CovarianceValueType >   DiagCovarianceMatrixType;
-
   /** Initialize. */
   TrC = TrCC = maxJJ = maxJCJ = 0.0;
 
@@ -87,26 +85,14 @@ ComputeJacobianTerms< TFixedImage, TTransform >
   ImageSampleContainerPointer sampleContainer = 0;
   SampleFixedImageForJacobianTerms( sampleContainer );
   const SizeValueType nrofsamples = sampleContainer->Size();
-  const double        n           = static_cast< double >( nrofsamples );
 
   /** Get the number of parameters. */
   const unsigned int P = static_cast< unsigned int >(
     this->m_Transform->GetNumberOfParameters() );
 
-  /** Get transform and set current position. */
-  typename TransformType::Pointer transform
-    = this->m_Transform;
+  /** Get the output dimension of the transform. */
   const unsigned int outdim = this->m_Transform->GetOutputSpaceDimension();
 
-  /** Get scales vector */
-  const ScalesType & scales = this->m_Scales;
-
-  /** Create iterator over the sample container. */
-  typename ImageSampleContainerType::ConstIterator iter;
-  typename ImageSampleContainerType::ConstIterator begin = sampleContainer->Begin();
-  typename ImageSampleContainerType::ConstIterator end   = sampleContainer->End();
-  unsigned int samplenr = 0;
-
   /** Variables for nonzerojacobian indices and the Jacobian. */
   NumberOfParametersType sizejacind
     = this->m_Transform->GetNumberOfNonZeroJacobianIndices();
@@ -115,16 +101,10 @@ ComputeJacobianTerms< TFixedImage, TTransform >
   NonZeroJacobianIndicesType jacind( sizejacind );
   jacind[ 0 ] = 0;
   if( sizejacind > 1 ) { jacind[ 1 ] = 0; }
-  NonZeroJacobianIndicesType prevjacind = jacind;
 
-  /** Initialize covariance matrix. Sparse, diagonal, and band form. */
+  /** Initialize covariance matrix. Sparse and diagonal form. */
   SparseCovarianceMatrixType cov( P, P );
   DiagCovarianceMatrixType   diagcov( P, 0.0 );
-  CovarianceMatrixType       bandcov;
-
-  /** For temporary storage of J'J. */
-  CovarianceMatrixType jactjac( sizejacind, sizejacind );
-  jactjac.Fill( 0.0 );
 
   typedef std::vector< unsigned int >             DifHistType;
   typedef std::pair< unsigned int, unsigned int > FreqPairType;
@@ -146,12 +126,12 @@ ComputeJacobianTerms< TFixedImage, TTransform >
    * which values of q-p occur often. This is done by making a histogram.
    * The histogram is then sorted and the most occurring bands
    * are determined. The covariance elements in these bands will not
-   * be stored in the sparse matrix structure 'cov', but in the band
-   * matrix 'bandcov', which is much faster.
-   * Only after the bandcov and cov have been filled (by looping over
-   * all Jacobian measurements in the sample container, the bandcov
-   * matrix is injected in the cov matrix, for easy further calculations,
-   * and the bandcov matrix is deleted.
+   * be stored in a sparse matrix structure, but in the band rows of
+   * the threads, which is much faster.
+   * Only after these have been filled (by looping over all Jacobian
+   * measurements in the sample container), the band rows and the sparse
+   * elements of all threads are merged into the cov matrix, for easy
+   * further calculations.
    */
   unsigned int onezero = 0;
   for( unsigned int s = 0; s < this->m_NumberOfBandStructureSamples; ++s )
@@ -216,9 +196,14 @@ ComputeJacobianTerms< TFixedImage, TTransform >
     bandcovMap2[ b ]                 = difHist2It->second;
   }
 
-  /** Initialize band matrix. */
-  bandcov = CovarianceMatrixType( P, bandcovsize );
-  bandcov.Fill( 0.0 );
+  /** Set up the data shared by the threads. */
+  MultiThreaderParameterType parameters;
+  parameters.st_Self               = this;
+  parameters.st_SampleContainer    = sampleContainer.GetPointer();
+  parameters.st_BandCovMap         = &bandcovMap;
+  parameters.st_BandCovMap2        = &bandcovMap2;
+  parameters.st_Covariance         = &cov;
+  parameters.st_DiagonalCovariance = &diagcov;
 
   /**
    *    TERM 1
@@ -226,117 +211,17 @@ ComputeJacobianTerms< TFixedImage, TTransform >
    * Loop over image and compute Jacobian.
    * Compute C = 1/n \sum_i J_i^T J_i
    * Possibly apply scaling afterwards.
+   * Every thread accumulates its part of the samples, after which the
+   * rows of all threads are merged into cov.
    */
-  jacind[ 0 ] = 0;
-  if( sizejacind > 1 ) { jacind[ 1 ] = 0; }
-  for( iter = begin; iter != end; ++iter )
-  {
-    /** Print progress 0-50%.
-     *progressObserver->UpdateAndPrintProgress( samplenr );*/
-    ++samplenr;
-
-    /** Read fixed coordinates and get Jacobian J_j. */
-    const FixedImagePointType & point = ( *iter ).Value().m_ImageCoordinates;
-    this->m_Transform->GetJacobian( point, jacj, jacind  );
-
-    /** Skip invalid Jacobians in the beginning, if any. */
-    if( sizejacind > 1 )
-    {
-      if( jacind[ 0 ] == jacind[ 1 ] ) { continue; }
-    }
-
-    if( jacind == prevjacind )
-    {
-      /** Update sum of J_j^T J_j. */
-      vnl_fastops::inc_X_by_AtA( jactjac, jacj );
-    }
-    else
-    {
-      /** The following should only be done after the first sample. */
-      if( iter != begin )
-      {
-        /** Update covariance matrix. */
-        for( unsigned int pi = 0; pi < sizejacind; ++pi )
-        {
-          const unsigned int p = prevjacind[ pi ];
-          for( unsigned int qi = 0; qi < sizejacind; ++qi )
-          {
-            const unsigned int q = prevjacind[ qi ];
-            if( q >= p )
-            {
-              const double tempval = jactjac( pi, qi ) / n;
-              if( vcl_abs( tempval ) > 1e-14 )
-              {
-                const unsigned int bandindex = bandcovMap[ q - p ];
-                if( bandindex < bandcovsize )
-                {
-                  bandcov( p, bandindex ) += tempval;
-                }
-                else
-                {
-                  cov( p, q ) += tempval;
-                }
-              }
-            }
-          } // qi
-        }   // pi
-      }     // end if
+  this->ExecuteThreaderCallback( ComputeCovarianceThreaderCallback, parameters );
+  this->ExecuteThreaderCallback( MergeCovarianceThreaderCallback, parameters );
 
-      /** Initialize jactjac by J_j^T J_j. */
-      vnl_fastops::AtA( jactjac, jacj );
-
-      /** Remember nonzerojacobian indices. */
-      prevjacind = jacind;
-    } // end else
-
-  } // end iter loop: end computation of covariance matrix
-
-  /** Update covariance matrix once again to include last jactjac updates
-   * \todo: a bit ugly that this loop is copied from above.
-   */
-  for( unsigned int pi = 0; pi < sizejacind; ++pi )
-  {
-    const unsigned int p = prevjacind[ pi ];
-    for( unsigned int qi = 0; qi < sizejacind; ++qi )
-    {
-      const unsigned int q = prevjacind[ qi ];
-      if( q >= p )
-      {
-        const double tempval = jactjac( pi, qi ) / n;
-        if( vcl_abs( tempval ) > 1e-14 )
-        {
-          const unsigned int bandindex = bandcovMap[ q - p ];
-          if( bandindex < bandcovsize )
-          {
-            bandcov( p, bandindex ) += tempval;
-          }
-          else
-          {
-            cov( p, q ) += tempval;
-          }
-        }
-      }
-    } // qi
-  }   // pi
-
-  /** Copy the bandmatrix into the sparse matrix and empty the bandcov matrix.
-   * \todo: perhaps work further with this bandmatrix instead.
-   */
-  for( unsigned int p = 0; p < P; ++p )
-  {
-    for( unsigned int b = 0; b < bandcovsize; ++b )
-    {
-      const double tempval = bandcov( p, b );
-      if( vcl_abs( tempval ) > 1e-14 )
-      {
-        const unsigned int q = p + bandcovMap2[ b ];
-        cov( p, q ) = tempval;
-      }
-    }
-  }
-  bandcov.set_size( 0, 0 );
+  /** Release the memory of the per-thread covariances. */
+  this->m_ComputePerThreadVariables.clear();
 
   /** Apply scales. the use of m_Scales maybe something wrong. */
+  const ScalesType & scales = this->m_Scales;
   if( this->m_UseScales )
   {
     for( unsigned int p = 0; p < P; ++p )
@@ -389,10 +274,389 @@ ComputeJacobianTerms< TFixedImage, TTransform >
    * Compute maxJJ and maxJCJ
    * \li maxJJ = max_j [ ||J_j||_F^2 + 2\sqrt{2} || J_j J_j^T ||_F ]
    * \li maxJCJ = max_j [ Tr( J_j C J_j^T ) + 2\sqrt{2} || J_j C J_j^T ||_F ]
+   * Every thread computes the maxima over its part of the samples.
    */
+  this->ExecuteThreaderCallback( ComputeMaxJacobianTermsThreaderCallback, parameters );
+
   maxJJ  = 0.0;
   maxJCJ = 0.0;
-  const double sqrt2 = vcl_sqrt( static_cast< double >( 2.0 ) );
+  for( unsigned int i = 0; i < this->m_ComputePerThreadVariables.size(); ++i )
+  {
+    maxJJ  = vnl_math_max( maxJJ, this->m_ComputePerThreadVariables[ i ].st_MaxJJ );
+    maxJCJ = vnl_math_max( maxJCJ, this->m_ComputePerThreadVariables[ i ].st_MaxJCJ );
+  }
+
+  /** Release the memory of the threads. */
+  this->m_ComputePerThreadVariables.clear();
+
+} // end ComputeParameters()
+
+
+/**
+ * ************************* ExecuteThreaderCallback ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputeJacobianTerms< TFixedImage, TTransform >
+::ExecuteThreaderCallback( ThreadFunctionType callback,
+  MultiThreaderParameterType & parameters )
+{
+  if( this->m_UseMultiThread )
+  {
+    this->m_ComputePerThreadVariables.resize( this->m_Threader->GetNumberOfThreads() );
+    this->m_Threader->SetSingleMethod( callback, &parameters );
+    this->m_Threader->SingleMethodExecute();
+  }
+  else
+  {
+    /** Mimic the threader, using only the calling thread. */
+    this->m_ComputePerThreadVariables.resize( 1 );
+    ThreadInfoType infoStruct;
+    infoStruct.ThreadID        = 0;
+    infoStruct.NumberOfThreads = 1;
+    infoStruct.UserData        = &parameters;
+    callback( &infoStruct );
+  }
+
+} // end ExecuteThreaderCallback()
+
+
+/**
+ * ************************* ComputeCovarianceThreaderCallback ************************
+ */
+
+template< class TFixedImage, class TTransform >
+ITK_THREAD_RETURN_TYPE
+ComputeJacobianTerms< TFixedImage, TTransform >
+::ComputeCovarianceThreaderCallback( void * arg )
+{
+  /** Get the current thread id and user data. */
+  ThreadInfoType *             infoStruct = static_cast< ThreadInfoType * >( arg );
+  MultiThreaderParameterType * parameters
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+
+  /** Call the real implementation. */
+  parameters->st_Self->ThreadedComputeCovariance(
+    infoStruct->ThreadID, infoStruct->NumberOfThreads, *parameters );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ComputeCovarianceThreaderCallback()
+
+
+/**
+ * ************************* MergeCovarianceThreaderCallback ************************
+ */
+
+template< class TFixedImage, class TTransform >
+ITK_THREAD_RETURN_TYPE
+ComputeJacobianTerms< TFixedImage, TTransform >
+::MergeCovarianceThreaderCallback( void * arg )
+{
+  /** Get the current thread id and user data. */
+  ThreadInfoType *             infoStruct = static_cast< ThreadInfoType * >( arg );
+  MultiThreaderParameterType * parameters
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+
+  /** Call the real implementation. */
+  parameters->st_Self->ThreadedMergeCovariance(
+    infoStruct->ThreadID, infoStruct->NumberOfThreads, *parameters );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end MergeCovarianceThreaderCallback()
+
+
+/**
+ * ************************* ComputeMaxJacobianTermsThreaderCallback ************************
+ */
+
+template< class TFixedImage, class TTransform >
+ITK_THREAD_RETURN_TYPE
+ComputeJacobianTerms< TFixedImage, TTransform >
+::ComputeMaxJacobianTermsThreaderCallback( void * arg )
+{
+  /** Get the current thread id and user data. */
+  ThreadInfoType *             infoStruct = static_cast< ThreadInfoType * >( arg );
+  MultiThreaderParameterType * parameters
+    = static_cast< MultiThreaderParameterType * >( infoStruct->UserData );
+
+  /** Call the real implementation. */
+  parameters->st_Self->ThreadedComputeMaxJacobianTerms(
+    infoStruct->ThreadID, infoStruct->NumberOfThreads, *parameters );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+} // end ComputeMaxJacobianTermsThreaderCallback()
+
+
+/**
+ * ************************* UpdateCovariance ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputeJacobianTerms< TFixedImage, TTransform >
+::UpdateCovariance( const Array2D< CovarianceValueType > & jactjac,
+  const NonZeroJacobianIndicesType & jacind, const double n,
+  const MultiThreaderParameterType & parameters,
+  ComputeJacobianTermsPerThreadStruct & threadVariables ) const
+{
+  const std::vector< unsigned int > & bandcovMap  = *parameters.st_BandCovMap;
+  const unsigned int                  bandcovsize = parameters.st_BandCovMap2->size();
+  const unsigned int                  sizejacind  = jacind.GetSize();
+
+  for( unsigned int pi = 0; pi < sizejacind; ++pi )
+  {
+    const unsigned int p = jacind[ pi ];
+    for( unsigned int qi = 0; qi < sizejacind; ++qi )
+    {
+      const unsigned int q = jacind[ qi ];
+      if( q >= p )
+      {
+        const double tempval = jactjac( pi, qi ) / n;
+        if( vcl_abs( tempval ) > 1e-14 )
+        {
+          const unsigned int bandindex = bandcovMap[ q - p ];
+          if( bandindex < bandcovsize )
+          {
+            /** Allocate the band row at the first touch of row p. */
+            int & rowIndex = threadVariables.st_BandRowIndices[ p ];
+            if( rowIndex < 0 )
+            {
+              rowIndex = static_cast< int >( threadVariables.st_BandRows.size() / bandcovsize );
+              threadVariables.st_BandRows.resize(
+                threadVariables.st_BandRows.size() + bandcovsize, 0.0 );
+            }
+            threadVariables.st_BandRows[ rowIndex * bandcovsize + bandindex ] += tempval;
+          }
+          else
+          {
+            threadVariables.st_Covariance( p, q ) += tempval;
+          }
+        }
+      }
+    } // qi
+  }   // pi
+
+} // end UpdateCovariance()
+
+
+/**
+ * ************************* ThreadedComputeCovariance ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputeJacobianTerms< TFixedImage, TTransform >
+::ThreadedComputeCovariance( ThreadIdType threadId, ThreadIdType numberOfThreads,
+  const MultiThreaderParameterType & parameters )
+{
+  typedef itk::Array2D< CovarianceValueType > CovarianceMatrixType;
+
+  /** Get the samples of this thread. */
+  ImageSampleContainerType & sampleContainer = *parameters.st_SampleContainer;
+  const SizeValueType        nrofsamples     = sampleContainer.Size();
+  const double               n               = static_cast< double >( nrofsamples );
+  const SizeValueType        pos_begin       = nrofsamples * threadId / numberOfThreads;
+  const SizeValueType        pos_end         = nrofsamples * ( threadId + 1 ) / numberOfThreads;
+
+  /** Initialize the per-thread covariance. */
+  const unsigned int                    P = this->m_Transform->GetNumberOfParameters();
+  ComputeJacobianTermsPerThreadStruct & threadVariables
+    = this->m_ComputePerThreadVariables[ threadId ];
+  threadVariables.st_BandRowIndices.assign( P, -1 );
+  threadVariables.st_BandRows.clear();
+  threadVariables.st_Covariance.resize( P, P );
+
+  /** Variables for nonzerojacobian indices and the Jacobian. */
+  const unsigned int     outdim = this->m_Transform->GetOutputSpaceDimension();
+  NumberOfParametersType sizejacind
+    = this->m_Transform->GetNumberOfNonZeroJacobianIndices();
+  JacobianType jacj( outdim, sizejacind );
+  jacj.Fill( 0.0 );
+  NonZeroJacobianIndicesType jacind( sizejacind );
+  NonZeroJacobianIndicesType prevjacind( sizejacind );
+  bool                       hasPrevious = false;
+
+  /** For temporary storage of J'J. */
+  CovarianceMatrixType jactjac( sizejacind, sizejacind );
+  jactjac.Fill( 0.0 );
+
+  for( SizeValueType i = pos_begin; i < pos_end; ++i )
+  {
+    /** Read fixed coordinates and get Jacobian J_j. */
+    const FixedImagePointType & point = sampleContainer.GetElement( i ).m_ImageCoordinates;
+    this->m_Transform->GetJacobian( point, jacj, jacind );
+
+    /** Skip invalid Jacobians in the beginning, if any. */
+    if( sizejacind > 1 )
+    {
+      if( jacind[ 0 ] == jacind[ 1 ] ) { continue; }
+    }
+
+    if( hasPrevious && jacind == prevjacind )
+    {
+      /** Update sum of J_j^T J_j. */
+      vnl_fastops::inc_X_by_AtA( jactjac, jacj );
+    }
+    else
+    {
+      /** Update covariance matrix with the previous nonzero Jacobian indices. */
+      if( hasPrevious )
+      {
+        this->UpdateCovariance( jactjac, prevjacind, n, parameters, threadVariables );
+      }
+
+      /** Initialize jactjac by J_j^T J_j. */
+      vnl_fastops::AtA( jactjac, jacj );
+
+      /** Remember nonzerojacobian indices. */
+      prevjacind  = jacind;
+      hasPrevious = true;
+    }
+  } // end loop over the samples of this thread
+
+  /** Update covariance matrix once again to include last jactjac updates. */
+  if( hasPrevious )
+  {
+    this->UpdateCovariance( jactjac, prevjacind, n, parameters, threadVariables );
+  }
+
+} // end ThreadedComputeCovariance()
+
+
+/**
+ * ************************* ThreadedMergeCovariance ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputeJacobianTerms< TFixedImage, TTransform >
+::ThreadedMergeCovariance( ThreadIdType threadId, ThreadIdType numberOfThreads,
+  const MultiThreaderParameterType & parameters )
+{
+  typedef typename SparseCovarianceMatrixType::row            SparseRowType;
+  typedef std::pair< unsigned int, CovarianceValueType >      ElementType;
+
+  const std::vector< unsigned int > & bandcovMap2 = *parameters.st_BandCovMap2;
+  const unsigned int                  bandcovsize = bandcovMap2.size();
+  SparseCovarianceMatrixType &        cov         = *parameters.st_Covariance;
+
+  /** Get the rows of this thread. The rows are independent, so each thread
+   * can write its own rows of the sparse matrix.
+   */
+  const unsigned int P         = cov.rows();
+  const unsigned int row_begin = static_cast< unsigned int >(
+    static_cast< SizeValueType >( P ) * threadId / numberOfThreads );
+  const unsigned int row_end = static_cast< unsigned int >(
+    static_cast< SizeValueType >( P ) * ( threadId + 1 ) / numberOfThreads );
+
+  const unsigned int                 numberOfParts = this->m_ComputePerThreadVariables.size();
+  std::vector< CovarianceValueType > bandrow( bandcovsize );
+  std::vector< ElementType >         elements;
+  std::vector< int >                 columns;
+  std::vector< CovarianceValueType > values;
+
+  for( unsigned int p = row_begin; p < row_end; ++p )
+  {
+    /** Sum the band rows and collect the sparse elements of all threads. */
+    std::fill( bandrow.begin(), bandrow.end(), 0.0 );
+    elements.clear();
+    for( unsigned int t = 0; t < numberOfParts; ++t )
+    {
+      ComputeJacobianTermsPerThreadStruct & threadVariables = this->m_ComputePerThreadVariables[ t ];
+      const int                             rowIndex        = threadVariables.st_BandRowIndices[ p ];
+      if( rowIndex >= 0 )
+      {
+        const CovarianceValueType * row = &threadVariables.st_BandRows[ rowIndex * bandcovsize ];
+        for( unsigned int b = 0; b < bandcovsize; ++b )
+        {
+          bandrow[ b ] += row[ b ];
+        }
+      }
+      if( !threadVariables.st_Covariance.empty_row( p ) )
+      {
+        const SparseRowType & covrowp = threadVariables.st_Covariance.get_row( p );
+        for( typename SparseRowType::const_iterator it = covrowp.begin(); it != covrowp.end(); ++it )
+        {
+          elements.push_back( ElementType( ( *it ).first, ( *it ).second ) );
+        }
+      }
+    }
+
+    /** Only copy the significant band elements, as done for the sparse elements. */
+    for( unsigned int b = 0; b < bandcovsize; ++b )
+    {
+      if( vcl_abs( bandrow[ b ] ) > 1e-14 )
+      {
+        elements.push_back( ElementType( p + bandcovMap2[ b ], bandrow[ b ] ) );
+      }
+    }
+    if( elements.empty() )
+    {
+      continue;
+    }
+
+    /** Add the elements with equal column numbers and set the row. */
+    std::sort( elements.begin(), elements.end() );
+    columns.clear();
+    values.clear();
+    for( unsigned int i = 0; i < elements.size(); ++i )
+    {
+      if( !columns.empty() && static_cast< unsigned int >( columns.back() ) == elements[ i ].first )
+      {
+        values.back() += elements[ i ].second;
+      }
+      else
+      {
+        columns.push_back( static_cast< int >( elements[ i ].first ) );
+        values.push_back( elements[ i ].second );
+      }
+    }
+    cov.set_row( p, columns, values );
+  }
+
+} // end ThreadedMergeCovariance()
+
+
+/**
+ * ************************* ThreadedComputeMaxJacobianTerms ************************
+ */
+
+template< class TFixedImage, class TTransform >
+void
+ComputeJacobianTerms< TFixedImage, TTransform >
+::ThreadedComputeMaxJacobianTerms( ThreadIdType threadId, ThreadIdType numberOfThreads,
+  const MultiThreaderParameterType & parameters )
+{
+  typedef typename SparseCovarianceMatrixType::row SparseRowType;
+  typedef itk::Array< SizeValueType >              NonZeroJacobianIndicesExpandedType;
+
+  /** Get the samples of this thread. */
+  ImageSampleContainerType & sampleContainer = *parameters.st_SampleContainer;
+  const SizeValueType        nrofsamples     = sampleContainer.Size();
+  const SizeValueType        pos_begin       = nrofsamples * threadId / numberOfThreads;
+  const SizeValueType        pos_end         = nrofsamples * ( threadId + 1 ) / numberOfThreads;
+
+  /** The covariance matrix is only read here. */
+  SparseCovarianceMatrixType &     cov     = *parameters.st_Covariance;
+  const DiagCovarianceMatrixType & diagcov = *parameters.st_DiagonalCovariance;
+  const ScalesType &               scales  = this->m_Scales;
+
+  /** Variables for nonzerojacobian indices and the Jacobian. */
+  const unsigned int     P      = this->m_Transform->GetNumberOfParameters();
+  const unsigned int     outdim = this->m_Transform->GetOutputSpaceDimension();
+  NumberOfParametersType sizejacind
+    = this->m_Transform->GetNumberOfNonZeroJacobianIndices();
+  JacobianType jacj( outdim, sizejacind );
+  jacj.Fill( 0.0 );
+  NonZeroJacobianIndicesType jacind( sizejacind );
+
+  double       maxJJ  = 0.0;
+  double       maxJCJ = 0.0;
+  const double sqrt2  = vcl_sqrt( static_cast< double >( 2.0 ) );
 
   JacobianType                       jacjjacj( outdim, outdim );
   JacobianType                       jacjcov( outdim, sizejacind );
@@ -402,12 +666,11 @@ ComputeJacobianTerms< TFixedImage, TTransform >
   JacobianType                       jacjcovjacj( outdim, outdim );
   NonZeroJacobianIndicesExpandedType jacindExpanded( P );
 
-  samplenr = 0;
-  for( iter = begin; iter != end; ++iter )
+  for( SizeValueType i = pos_begin; i < pos_end; ++i )
   {
     /** Read fixed coordinates and get Jacobian. */
-    const FixedImagePointType & point = ( *iter ).Value().m_ImageCoordinates;
-    this->m_Transform->GetJacobian( point, jacj, jacind  );
+    const FixedImagePointType & point = sampleContainer.GetElement( i ).m_ImageCoordinates;
+    this->m_Transform->GetJacobian( point, jacj, jacind );
 
     /** Apply scales, if necessary. */
     if( this->m_UseScales )
@@ -456,8 +719,8 @@ ComputeJacobianTerms< TFixedImage, TTransform >
       const unsigned int p = jacind[ pi ];
       if( !cov.empty_row( p ) )
       {
-        SparseRowType & covrowp = cov.get_row( p );
-        typename SparseRowType::iterator covrowpit;
+        const SparseRowType & covrowp = cov.get_row( p );
+        typename SparseRowType::const_iterator covrowpit;
 
         /** Loop over row p of the sparse cov matrix. */
         for( covrowpit = covrowp.begin(); covrowpit != covrowp.end(); ++covrowpit )
@@ -502,16 +765,13 @@ ComputeJacobianTerms< TFixedImage, TTransform >
     /** Max_j [JCJ_j]. */
     maxJCJ = vnl_math_max( maxJCJ, JCJ_j );
 
-    /** Show progress 50-100%. */
-    //progressObserver->UpdateAndPrintProgress( samplenr + nrofsamples );
-    ++samplenr;
-
-  } // end loop over sample container
+  } // end loop over the samples of this thread
 
-  /** Finalize progress information. */
-  //progressObserver->PrintProgress( 1.0 );
+  /** Only store the results at the end, to prevent false sharing. */
+  this->m_ComputePerThreadVariables[ threadId ].st_MaxJJ  = maxJJ;
+  this->m_ComputePerThreadVariables[ threadId ].st_MaxJCJ = maxJCJ;
 
-} // end ComputeJacobianTerms()
+} // end ThreadedComputeMaxJacobianTerms()
 
 
 /**
@@ -108,6 +108,17 @@ namespace elastix
  *    example: <tt>(UpdateBDPeriod 0 0 50)</tt> \n
  *    Default: 0 (so, automatically determined).
  *
+ * At the end of each resolution the number of generations per second is
+ * reported in the elastix.log file.
+ *
+ * This component always evaluates the offspring sequentially. The concurrent
+ * evaluation of itk::CMAEvolutionStrategyOptimizer needs independent cost
+ * functions (SetIndependentCostFunctions()), and this component does not
+ * supply them: the elastix metrics keep their intermediate results in the
+ * metric itself, and the registration creates only one instance of each.
+ * The concurrent mode is therefore only available through the ITK API.
+ * Note that the metric evaluation itself is multi-threaded for most metrics.
+ *
  * \ingroup Optimizers
  */
 
@@ -295,6 +295,9 @@ CMAEvolutionStrategy< TElastix >
   /** Print the stopping condition */
   elxout << "Stopping condition: " << stopcondition << "." << std::endl;
 
+  /** Print the speed of the optimizer */
+  elxout << "Generations per second: " << this->GetGenerationsPerSecond() << std::endl;
+
 }   // end AfterEachResolution
 
 
@@ -26,6 +26,7 @@
 #include "itkCommand.h"
 #include "itkEventObject.h"
 #include "itkExceptionObject.h"
+#include "itkRealTimeClock.h"
 
 namespace itk
 {
@@ -76,6 +77,8 @@ CMAEvolutionStrategyOptimizer::CMAEvolutionStrategyOptimizer()
   this->m_PositionToleranceMax       = 1e8;
   this->m_ValueTolerance             = 1e-12;
 
+  this->m_GenerationsPerSecond = 0.0;
+
 }   // end constructor
 
 
@@ -124,6 +127,9 @@ CMAEvolutionStrategyOptimizer::PrintSelf( std::ostream & os, Indent indent ) con
   os << indent << "m_PositionToleranceMin: " << this->m_PositionToleranceMin << std::endl;
   os << indent << "m_PositionToleranceMax: " << this->m_PositionToleranceMax << std::endl;
   os << indent << "m_ValueTolerance: " << this->m_ValueTolerance << std::endl;
+  os << indent << "m_IndependentCostFunctions: " << this->m_IndependentCostFunctions.size()
+     << " instances" << std::endl;
+  os << indent << "m_GenerationsPerSecond: " << this->m_GenerationsPerSecond << std::endl;
 
   os << indent << "m_RecombinationWeights: " << this->m_RecombinationWeights << std::endl;
   os << indent << "m_C: " << this->m_C << std::endl;
@@ -136,6 +142,22 @@ CMAEvolutionStrategyOptimizer::PrintSelf( std::ostream & os, Indent indent ) con
 }   // end PrintSelf;
 
 
+/**
+ * ******************* SetIndependentCostFunctions *********************
+ */
+
+void
+CMAEvolutionStrategyOptimizer::SetIndependentCostFunctions(
+  const CostFunctionContainerType & costFunctions )
+{
+  itkDebugMacro( "SetIndependentCostFunctions" );
+
+  this->m_IndependentCostFunctions = costFunctions;
+  this->Modified();
+
+}   // end SetIndependentCostFunctions
+
+
 /**
  * ******************* StartOptimization *********************
  */
@@ -158,6 +180,28 @@ CMAEvolutionStrategyOptimizer::StartOptimization()
   /** Initialize the scaledCostFunction with the currently set scales */
   this->InitializeScales();
 
+  /** Wrap the independent cost functions like the scaledCostFunction,
+   * and create one thread per cost function instance. */
+  this->m_IndependentScaledCostFunctions.clear();
+  for( unsigned int i = 0; i < this->m_IndependentCostFunctions.size(); ++i )
+  {
+    ScaledCostFunctionType::Pointer scaledCostFunction = ScaledCostFunctionType::New();
+    scaledCostFunction->SetUnscaledCostFunction( this->m_IndependentCostFunctions[ i ] );
+    scaledCostFunction->SetUseScales( this->GetUseScales() );
+    scaledCostFunction->SetSquaredScales( this->GetScaledCostFunction()->GetSquaredScales() );
+    scaledCostFunction->SetNegateCostFunction( this->GetMaximize() );
+    this->m_IndependentScaledCostFunctions.push_back( scaledCostFunction );
+  }
+  if( !this->m_IndependentScaledCostFunctions.empty() )
+  {
+    if( this->m_ThreadPool.IsNull() )
+    {
+      this->m_ThreadPool = ThreadPoolType::New();
+    }
+    this->m_ThreadPool->SetNumberOfThreads(
+      this->m_IndependentScaledCostFunctions.size() + 1 );
+  }
+
   /** Set the current position as the scaled initial position */
   this->SetCurrentPosition( this->GetInitialPosition() );
 
@@ -190,6 +234,12 @@ CMAEvolutionStrategyOptimizer::ResumeOptimization()
   this->m_Stop          = false;
   this->m_StopCondition = Unknown;
 
+  /** Measure the number of generations per second */
+  RealTimeClock::Pointer clock               = RealTimeClock::New();
+  const double           startTime           = clock->GetTimeInSeconds();
+  unsigned long          numberOfGenerations = 0;
+  this->m_GenerationsPerSecond = 0.0;
+
   this->InvokeEvent( StartEvent() );
 
   try
@@ -230,6 +280,13 @@ CMAEvolutionStrategyOptimizer::ResumeOptimization()
       break;
     }
 
+    ++numberOfGenerations;
+    const double elapsedTime = clock->GetTimeInSeconds() - startTime;
+    if( elapsedTime > 0.0 )
+    {
+      this->m_GenerationsPerSecond = numberOfGenerations / elapsedTime;
+    }
+
     /** Give the user opportunity to observe progress (current value/position/sigma etc.) */
     this->InvokeEvent( IterationEvent() );
 
@@ -500,50 +557,58 @@ CMAEvolutionStrategyOptimizer::GenerateOffspring( void )
 {
   itkDebugMacro( "GenerateOffspring" );
 
-  /** Get the number of parameters from the cost function */
-  const unsigned int numberOfParameters
-    = this->GetScaledCostFunction()->GetNumberOfParameters();
-
   /** Some casts/aliases: */
-  const unsigned int N      = numberOfParameters;
-  const unsigned int lambda = this->m_PopulationSize;
+  const unsigned int lambda     = this->m_PopulationSize;
+  const bool         concurrent = !this->m_IndependentScaledCostFunctions.empty();
 
   /** Clear the old values */
   this->m_CostFunctionValues.clear();
 
-  /** Fill the m_NormalizedSearchDirs and SearchDirs */
-  unsigned int lam       = 0;
-  unsigned int nrOfFails = 0;
-  while( lam < lambda )
+  /** Evaluate the offspring concurrently if possible. The search directions
+   * are all drawn before the evaluation, in the same order as below. */
+  if( concurrent )
   {
-    /** draw from distribution N(0,I) */
-    for( unsigned int par = 0; par < N; ++par )
+    for( unsigned int lam = 0; lam < lambda; ++lam )
     {
-      this->m_NormalizedSearchDirs[ lam ][ par ]
-        = this->m_RandomGenerator->GetNormalVariate();
+      this->GenerateSearchDirection( lam );
     }
-    /** Make like it was drawn from N(0,C) */
-    if( this->GetUseCovarianceMatrixAdaptation() )
+    this->EvaluateOffspringConcurrently();
+  }
+
+  /** Fill the m_NormalizedSearchDirs and SearchDirs */
+  unsigned int    lam       = 0;
+  unsigned int    nrOfFails = 0;
+  ExceptionObject lastError;
+  while( lam < lambda )
+  {
+    MeasureType costFunctionValue = 0.0;
+    bool        success           = true;
+    if( concurrent && nrOfFails == 0 )
     {
-      this->m_SearchDirs[ lam ] = this->m_B * ( this->m_D * this->m_NormalizedSearchDirs[ lam ] );
+      /** Use the value that was computed concurrently */
+      costFunctionValue = this->m_OffspringValues[ lam ];
+      success           = this->m_OffspringEvaluated[ lam ] != 0;
     }
     else
     {
-      this->m_SearchDirs[ lam ] = this->m_NormalizedSearchDirs[ lam ];
-    }
-    /** Make like it was drawn from N( 0, sigma^2 C ) */
-    this->m_SearchDirs[ lam ] *= this->m_CurrentSigma;
+      this->GenerateSearchDirection( lam );
 
-    /** Compute the cost function */
-    MeasureType costFunctionValue = 0.0;
-    /** x_lam = m + d_lam */
-    ParametersType x_lam = this->GetScaledCurrentPosition();
-    x_lam += this->m_SearchDirs[ lam ];
-    try
-    {
-      costFunctionValue = this->GetScaledValue( x_lam );
+      /** Compute the cost function */
+      /** x_lam = m + d_lam */
+      ParametersType x_lam = this->GetScaledCurrentPosition();
+      x_lam += this->m_SearchDirs[ lam ];
+      try
+      {
+        costFunctionValue = this->GetScaledValue( x_lam );
+      }
+      catch( ExceptionObject & err )
+      {
+        success   = false;
+        lastError = err;
+      }
     }
-    catch( ExceptionObject & err )
+
+    if( !success )
     {
       ++nrOfFails;
       /** try another parameter vector if we haven't tried that for 10 times already */
@@ -555,9 +620,10 @@ CMAEvolutionStrategyOptimizer::GenerateOffspring( void )
       {
         this->m_StopCondition = MetricError;
         this->StopOptimization();
-        throw err;
+        throw lastError;
       }
     }
+
     /** Successfull cost function evaluation */
     this->m_CostFunctionValues.push_back(
       MeasureIndexPairType( costFunctionValue, lam ) );
@@ -572,6 +638,108 @@ CMAEvolutionStrategyOptimizer::GenerateOffspring( void )
 }   // end GenerateOffspring
 
 
+/**
+ * ****************** GenerateSearchDirection *********************
+ */
+
+void
+CMAEvolutionStrategyOptimizer::GenerateSearchDirection( unsigned int lam )
+{
+  /** Get the number of parameters from the cost function */
+  const unsigned int N = this->GetScaledCostFunction()->GetNumberOfParameters();
+
+  /** draw from distribution N(0,I) */
+  for( unsigned int par = 0; par < N; ++par )
+  {
+    this->m_NormalizedSearchDirs[ lam ][ par ]
+      = this->m_RandomGenerator->GetNormalVariate();
+  }
+  /** Make like it was drawn from N(0,C) */
+  if( this->GetUseCovarianceMatrixAdaptation() )
+  {
+    this->m_SearchDirs[ lam ] = this->m_B * ( this->m_D * this->m_NormalizedSearchDirs[ lam ] );
+  }
+  else
+  {
+    this->m_SearchDirs[ lam ] = this->m_NormalizedSearchDirs[ lam ];
+  }
+  /** Make like it was drawn from N( 0, sigma^2 C ) */
+  this->m_SearchDirs[ lam ] *= this->m_CurrentSigma;
+
+}   // end GenerateSearchDirection
+
+
+/**
+ * ****************** EvaluateOffspringConcurrently *********************
+ */
+
+void
+CMAEvolutionStrategyOptimizer::EvaluateOffspringConcurrently( void )
+{
+  itkDebugMacro( "EvaluateOffspringConcurrently" );
+
+  this->m_OffspringValues.assign( this->m_PopulationSize, NumericTraits< MeasureType >::Zero );
+  this->m_OffspringEvaluated.assign( this->m_PopulationSize, 0 );
+
+  this->m_ThreadPool->SetSingleMethod( EvaluateOffspringThreaderCallback, this );
+  this->m_ThreadPool->SingleMethodExecute();
+
+}   // end EvaluateOffspringConcurrently
+
+
+/**
+ * ****************** EvaluateOffspringThreaderCallback *********************
+ */
+
+ITK_THREAD_RETURN_TYPE
+CMAEvolutionStrategyOptimizer::EvaluateOffspringThreaderCallback( void * arg )
+{
+  ThreadInfoType *   infoStruct = static_cast< ThreadInfoType * >( arg );
+  const ThreadIdType threadId   = infoStruct->ThreadID;
+  Self *             self       = static_cast< Self * >( infoStruct->UserData );
+
+  self->ThreadedEvaluateOffspring( threadId );
+
+  return ITK_THREAD_RETURN_VALUE;
+
+}   // end EvaluateOffspringThreaderCallback
+
+
+/**
+ * ****************** ThreadedEvaluateOffspring *********************
+ */
+
+void
+CMAEvolutionStrategyOptimizer::ThreadedEvaluateOffspring( ThreadIdType threadId )
+{
+  /** Thread 0 uses the cost function itself, the other threads each use
+   * their own independent instance. */
+  const ScaledCostFunctionType * costFunction = threadId == 0
+    ? this->GetScaledCostFunction()
+    : this->m_IndependentScaledCostFunctions[ threadId - 1 ].GetPointer();
+  const unsigned int numberOfThreads = this->m_IndependentScaledCostFunctions.size() + 1;
+
+  for( unsigned int lam = threadId; lam < this->m_PopulationSize; lam += numberOfThreads )
+  {
+    /** x_lam = m + d_lam */
+    ParametersType x_lam = this->GetScaledCurrentPosition();
+    x_lam += this->m_SearchDirs[ lam ];
+
+    /** Failures are handled by GenerateOffspring() */
+    try
+    {
+      this->m_OffspringValues[ lam ]    = costFunction->GetValue( x_lam );
+      this->m_OffspringEvaluated[ lam ] = 1;
+    }
+    catch( ExceptionObject & )
+    {
+      this->m_OffspringEvaluated[ lam ] = 0;
+    }
+  }
+
+}   // end ThreadedEvaluateOffspring
+
+
 /**
  * ****************** SortCostFunctionValues *********************
  */
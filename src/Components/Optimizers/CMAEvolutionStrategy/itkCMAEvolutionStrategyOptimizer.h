@@ -27,6 +27,7 @@
 #include "itkArray.h"
 #include "itkArray2D.h"
 #include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkPersistentThreadPool.h"
 #include "vnl/vnl_diag_matrix.h"
 
 namespace itk
@@ -43,6 +44,15 @@ namespace itk
  *   - See also the Matlab code, cmaes.m, which you can download from the
  *     website mentioned above.
  *
+ * The cost function values of the offspring of one generation are
+ * independent, so they may be computed concurrently. This requires
+ * independent instances of the cost function, set with
+ * SetIndependentCostFunctions(), since cost functions generally store
+ * intermediate results during GetValue(). The search directions are drawn
+ * before the offspring is evaluated, in the same order as in the
+ * sequential case, so both give the same results as long as no evaluation
+ * fails.
+ *
  * \ingroup Numerics Optimizers
  */
 
@@ -67,6 +77,8 @@ public:
   typedef Superclass::MeasureType            MeasureType;
   typedef Superclass::ScalesType             ScalesType;
 
+  typedef std::vector< CostFunctionType::Pointer > CostFunctionContainerType;
+
   typedef enum {
     MetricError,
     MaximumNumberOfIterations,
@@ -219,6 +231,21 @@ public:
   itkSetMacro( ValueTolerance, double );
   itkGetConstMacro( ValueTolerance, double );
 
+  /** Setting: independent instances of the cost function, which are used
+   * together with the cost function set by SetCostFunction() to evaluate
+   * the offspring concurrently, one thread per cost function instance.
+   * All instances should return the same value for the same parameters.
+   * A cost function with a thread-safe GetValue() may be added more than
+   * once. Default: empty, so the offspring is evaluated sequentially. */
+  virtual void SetIndependentCostFunctions( const CostFunctionContainerType & costFunctions );
+
+  const CostFunctionContainerType & GetIndependentCostFunctions( void ) const
+  { return this->m_IndependentCostFunctions; }
+
+  /** The number of generations per second of the last run, measured
+   * from the start of ResumeOptimization(). */
+  itkGetConstMacro( GenerationsPerSecond, double );
+
 protected:
 
   typedef Array< double >               RecombinationWeightsType;
@@ -233,6 +260,10 @@ protected:
 
   typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
 
+  typedef std::vector< ScaledCostFunctionType::Pointer > ScaledCostFunctionContainerType;
+  typedef PersistentThreadPool                           ThreadPoolType;
+  typedef ThreadPoolType::ThreadInfoType                 ThreadInfoType;
+
   /** The random number generator used to generate the offspring. */
   RandomGeneratorType::Pointer m_RandomGenerator;
 
@@ -358,6 +389,17 @@ protected:
    * and m_CostFunctionValues */
   virtual void GenerateOffspring( void );
 
+  /** Draw m_NormalizedSearchDirs[ lam ] and compute m_SearchDirs[ lam ] */
+  virtual void GenerateSearchDirection( unsigned int lam );
+
+  /** Evaluate the cost function for all search directions concurrently,
+   * using the independent cost functions. Fills m_OffspringValues and
+   * m_OffspringEvaluated. */
+  virtual void EvaluateOffspringConcurrently( void );
+
+  /** Evaluate the offspring members lam = threadId + k * numberOfThreads. */
+  void ThreadedEvaluateOffspring( ThreadIdType threadId );
+
   /** Sort the m_CostFunctionValues vector and update m_MeasureHistory */
   virtual void SortCostFunctionValues( void );
 
@@ -423,6 +465,20 @@ private:
   double        m_PositionToleranceMin;
   double        m_ValueTolerance;
 
+  /** Concurrent evaluation of the offspring. m_OffspringEvaluated is a
+   * vector of unsigned char, since the elements are written by different
+   * threads. */
+  CostFunctionContainerType       m_IndependentCostFunctions;
+  ScaledCostFunctionContainerType m_IndependentScaledCostFunctions;
+  ThreadPoolType::Pointer         m_ThreadPool;
+  std::vector< MeasureType >      m_OffspringValues;
+  std::vector< unsigned char >    m_OffspringEvaluated;
+
+  double m_GenerationsPerSecond;
+
+  /** The callback that is executed by the threads of m_ThreadPool. */
+  static ITK_THREAD_RETURN_TYPE EvaluateOffspringThreaderCallback( void * arg );
+
 };
 
 } // end namespace itk
@@ -48,6 +48,25 @@ namespace elastix
  *   This varies the second transform parameter in the range [-4.0 3.0] with steps of 1.0
  *   and the third parameter in the range [-1.0 1.0] with steps of 0.5. The names are used
  *   as column headers in the screen output.
+ * \parameter CoarseGridStride: Search the space coarse-to-fine: first only the points
+ *   of which all indices are multiples of this stride, then the full grid around the best
+ *   coarse points. A value of 1 searches the full grid.\n
+ *   example: <tt>(CoarseGridStride 4 2)</tt> \n
+ *   Default value: 1. Can be specified for each resolution.\n
+ * \parameter NumberOfRefinementCells: The number of best coarse grid points around which
+ *   the full grid is searched, if CoarseGridStride is larger than 1.\n
+ *   example: <tt>(NumberOfRefinementCells 5)</tt> \n
+ *   Default value: 1. Can be specified for each resolution.\n
+ *
+ * In a coarse-to-fine search the points of the OptimizationSurface that are not
+ * evaluated are set to NaN.
+ *
+ * This component always evaluates the grid points sequentially. The concurrent
+ * evaluation of itk::FullSearchOptimizer needs independent cost functions
+ * (SetIndependentCostFunctions()), and this component does not supply them:
+ * the elastix metrics keep their intermediate results in the metric itself,
+ * and the registration creates only one instance of each. The concurrent mode
+ * is therefore only available through the ITK API.
  *
  * \ingroup Optimizers
  * \sa FullSearchOptimizer
@@ -181,6 +181,24 @@ FullSearch< TElastix >
     this->m_OptimizationSurface->Allocate();
     /** \todo try/catch block around Allocate? */
 
+    /** Read the settings of the coarse-to-fine search. */
+    unsigned int coarseGridStride = 1;
+    this->m_Configuration->ReadParameter( coarseGridStride,
+      "CoarseGridStride", this->GetComponentLabel(), level, 0 );
+    this->SetCoarseGridStride( coarseGridStride );
+
+    unsigned int numberOfRefinementCells = 1;
+    this->m_Configuration->ReadParameter( numberOfRefinementCells,
+      "NumberOfRefinementCells", this->GetComponentLabel(), level, 0 );
+    this->SetNumberOfRefinementCells( numberOfRefinementCells );
+
+    /** Mark the points that are not evaluated in a coarse-to-fine search. */
+    if( this->GetCoarseGridStride() > 1 )
+    {
+      this->m_OptimizationSurface->FillBuffer(
+        itk::NumericTraits< float >::quiet_NaN() );
+    }
+
     /** Set the name of this image on disk. */
     std::string resultImageFormat = "mhd";
     this->m_Configuration->ReadParameter(
@@ -194,10 +212,20 @@ FullSearch< TElastix >
       << "." << resultImageFormat;
     this->m_OptimizationSurface->SetOutputFileName( makeString.str().c_str() );
 
-    elxout
-      << "Total number of iterations needed in this resolution: "
-      << this->GetNumberOfIterations()
-      << "." << std::endl;
+    if( this->GetCoarseGridStride() > 1 )
+    {
+      elxout
+        << "Coarse-to-fine search with a coarse grid stride of "
+        << this->GetCoarseGridStride() << ", refined around the best "
+        << this->GetNumberOfRefinementCells() << " coarse points." << std::endl;
+    }
+    else
+    {
+      elxout
+        << "Total number of iterations needed in this resolution: "
+        << this->GetNumberOfIterations()
+        << "." << std::endl;
+    }
 
   }
   else
@@ -24,6 +24,8 @@
 #include "itkEventObject.h"
 #include "itkExceptionObject.h"
 #include "itkNumericTraits.h"
+#include <algorithm>
+#include <set>
 
 namespace itk
 {
@@ -45,6 +47,8 @@ FullSearchOptimizer
   m_NumberOfSearchSpaceDimensions = 0;
   m_SearchSpace                   = 0;
   m_LastSearchSpaceChanges        = 0;
+  m_CoarseGridStride              = 1;
+  m_NumberOfRefinementCells       = 1;
 
 }   //end constructor
 
@@ -80,6 +84,16 @@ FullSearchOptimizer
     m_BestValue = NumericTraits< double >::max();
   }
 
+  /** Create one thread per cost function instance. */
+  if( !m_IndependentCostFunctions.empty() )
+  {
+    if( m_ThreadPool.IsNull() )
+    {
+      m_ThreadPool = ThreadPoolType::New();
+    }
+    m_ThreadPool->SetNumberOfThreads( m_IndependentCostFunctions.size() + 1 );
+  }
+
   this->ResumeOptimization();
 
 }
@@ -98,12 +112,217 @@ FullSearchOptimizer
   m_Stop = false;
 
   InvokeEvent( StartEvent() );
-  while( !m_Stop )
+
+  if( m_CoarseGridStride > 1 )
+  {
+    this->SearchCoarseToFine();
+  }
+  else
+  {
+    this->SearchFullGrid();
+  }
+
+}   //end function ResumeOptimization
+
+
+/**
+ * ********************** SearchFullGrid *************************
+ */
+void
+FullSearchOptimizer
+::SearchFullGrid( void )
+{
+  itkDebugMacro( "SearchFullGrid" );
+
+  /** Visit the grid points in chunks, to avoid storing the numbers of
+   * all points of large search spaces. */
+  const unsigned long      numberOfIterations = this->GetNumberOfIterations();
+  const unsigned long      chunkSize          = 4096;
+  PointNumberContainerType pointNumbers;
+  MeasureContainerType     values;
+  while( !m_Stop && m_CurrentIteration < numberOfIterations )
+  {
+    const unsigned long end
+      = std::min( m_CurrentIteration + chunkSize, numberOfIterations );
+    pointNumbers.clear();
+    for( unsigned long pointNumber = m_CurrentIteration; pointNumber < end; ++pointNumber )
+    {
+      pointNumbers.push_back( pointNumber );
+    }
+    this->EvaluatePoints( pointNumbers, values );
+  }
+
+  if( !m_Stop )
+  {
+    m_StopCondition = FullRangeSearched;
+    StopOptimization();
+  }
+
+}   // end SearchFullGrid
+
+
+/**
+ * ********************** SearchCoarseToFine *********************
+ */
+void
+FullSearchOptimizer
+::SearchCoarseToFine( void )
+{
+  itkDebugMacro( "SearchCoarseToFine" );
+
+  const unsigned int          searchSpaceDimension = this->GetNumberOfSearchSpaceDimensions();
+  const SearchSpaceSizeType & searchSpaceSize      = this->GetSearchSpaceSize();
+  const IndexValueType        stride               = static_cast< IndexValueType >( m_CoarseGridStride );
+
+  /** The search is restarted when resumed. */
+  m_CurrentIteration = 0;
+
+  /** Collect the coarse grid points: all indices are multiples of the stride. */
+  PointNumberContainerType coarsePoints;
+  const unsigned long      numberOfIterations = this->GetNumberOfIterations();
+  SearchSpaceIndexType     index( searchSpaceDimension );
+  index.Fill( 0 );
+  for( unsigned long i = 0; i < numberOfIterations; ++i )
+  {
+    coarsePoints.push_back( this->IndexToPointNumber( index ) );
+
+    /** Go to the next coarse index, dimension 0 fastest. */
+    unsigned int ssdim = 0;
+    for( ; ssdim < searchSpaceDimension; ++ssdim )
+    {
+      index[ ssdim ] += stride;
+      if( index[ ssdim ] < static_cast< IndexValueType >( searchSpaceSize[ ssdim ] ) )
+      {
+        break;
+      }
+      index[ ssdim ] = 0;
+    }
+    if( ssdim == searchSpaceDimension )
+    {
+      break;
+    }
+  }
+
+  /** Evaluate the coarse grid. */
+  MeasureContainerType coarseValues;
+  this->EvaluatePoints( coarsePoints, coarseValues );
+  if( m_Stop )
+  {
+    return;
+  }
+
+  /** Select the best coarse points. */
+  std::vector< std::pair< MeasureType, unsigned long > > rankedPoints( coarsePoints.size() );
+  for( unsigned long i = 0; i < coarsePoints.size(); ++i )
+  {
+    rankedPoints[ i ].first  = m_Maximize ? -coarseValues[ i ] : coarseValues[ i ];
+    rankedPoints[ i ].second = coarsePoints[ i ];
+  }
+  const unsigned long numberOfRefinementCells = std::min(
+    static_cast< unsigned long >( m_NumberOfRefinementCells ),
+    static_cast< unsigned long >( rankedPoints.size() ) );
+  std::partial_sort( rankedPoints.begin(),
+    rankedPoints.begin() + numberOfRefinementCells, rankedPoints.end() );
+
+  /** Collect the points of the full grid around the best coarse points,
+   * except the coarse points themselves. A std::set is used to visit the
+   * points of overlapping cells only once, in the order of a full search. */
+  std::set< unsigned long > finePointSet;
+  SearchSpaceIndexType      minimumIndex( searchSpaceDimension );
+  SearchSpaceIndexType      maximumIndex( searchSpaceDimension );
+  for( unsigned long c = 0; c < numberOfRefinementCells; ++c )
+  {
+    const SearchSpaceIndexType coarseIndex = this->PointNumberToIndex( rankedPoints[ c ].second );
+    for( unsigned int ssdim = 0; ssdim < searchSpaceDimension; ++ssdim )
+    {
+      minimumIndex[ ssdim ] = std::max( coarseIndex[ ssdim ] - stride + 1,
+        static_cast< IndexValueType >( 0 ) );
+      maximumIndex[ ssdim ] = std::min( coarseIndex[ ssdim ] + stride - 1,
+        static_cast< IndexValueType >( searchSpaceSize[ ssdim ] ) - 1 );
+    }
+
+    index = minimumIndex;
+    bool done = false;
+    while( !done )
+    {
+      bool isCoarsePoint = true;
+      for( unsigned int ssdim = 0; ssdim < searchSpaceDimension; ++ssdim )
+      {
+        isCoarsePoint &= ( index[ ssdim ] % stride == 0 );
+      }
+      if( !isCoarsePoint )
+      {
+        finePointSet.insert( this->IndexToPointNumber( index ) );
+      }
+
+      /** Go to the next index in the box, dimension 0 fastest. */
+      done = true;
+      for( unsigned int ssdim = 0; ssdim < searchSpaceDimension; ++ssdim )
+      {
+        if( index[ ssdim ] < maximumIndex[ ssdim ] )
+        {
+          ++index[ ssdim ];
+          done = false;
+          break;
+        }
+        index[ ssdim ] = minimumIndex[ ssdim ];
+      }
+    }
+  }
+
+  /** Evaluate the refined grid. */
+  const PointNumberContainerType finePoints( finePointSet.begin(), finePointSet.end() );
+  MeasureContainerType           fineValues;
+  this->EvaluatePoints( finePoints, fineValues );
+
+  if( !m_Stop )
+  {
+    m_StopCondition = FullRangeSearched;
+    StopOptimization();
+  }
+
+}   // end SearchCoarseToFine
+
+
+/**
+ * ********************** EvaluatePoints *************************
+ */
+void
+FullSearchOptimizer
+::EvaluatePoints( const PointNumberContainerType & pointNumbers,
+  MeasureContainerType & values )
+{
+  /** Sequentially, the points are evaluated and reported one by one. */
+  const unsigned int  numberOfThreads = m_IndependentCostFunctions.size() + 1;
+  const unsigned long batchSize       = numberOfThreads > 1 ? 16 * numberOfThreads : 1;
+
+  values.clear();
+  for( unsigned long begin = 0; begin < pointNumbers.size() && !m_Stop; begin += batchSize )
   {
+    const unsigned long end = std::min(
+      begin + batchSize, static_cast< unsigned long >( pointNumbers.size() ) );
 
+    /** Compute the positions of this batch. */
+    m_BatchPositions.resize( end - begin );
+    m_BatchValues.resize( end - begin );
+    for( unsigned long i = begin; i < end; ++i )
+    {
+      m_BatchPositions[ i - begin ]
+        = this->IndexToPosition( this->PointNumberToIndex( pointNumbers[ i ] ) );
+    }
+
+    /** Evaluate the batch. */
     try
     {
-      m_Value = m_CostFunction->GetValue( this->GetCurrentPosition() );
+      if( numberOfThreads > 1 )
+      {
+        m_ThreadPool->SetSingleMethod( EvaluateBatchThreaderCallback, this );
+        m_ThreadPool->SingleMethodExecute();
+      }
+      else
+      {
+        m_BatchValues[ 0 ] = m_CostFunction->GetValue( m_BatchPositions[ 0 ] );
+      }
     }
     catch( ExceptionObject & err )
     {
@@ -116,37 +335,91 @@ FullSearchOptimizer
       throw err;
     }
 
-    if( m_Stop )
+    /** Report the points of the batch. */
+    for( unsigned long i = begin; i < end; ++i )
     {
-      break;
-    }
+      m_CurrentIndexInSearchSpace = this->PointNumberToIndex( pointNumbers[ i ] );
+      m_CurrentPointInSearchSpace = this->IndexToPoint( m_CurrentIndexInSearchSpace );
+      this->SetCurrentPosition( m_BatchPositions[ i - begin ] );
+      m_Value = m_BatchValues[ i - begin ];
+      values.push_back( m_Value );
+
+      /** Check if the value is a minimum or maximum */
+      if( ( m_Value < m_BestValue )  ^  m_Maximize )         // ^ = xor, yields true if only one of the expressions is true
+      {
+        m_BestValue              = m_Value;
+        m_BestPointInSearchSpace = m_CurrentPointInSearchSpace;
+        m_BestIndexInSearchSpace = m_CurrentIndexInSearchSpace;
+      }
 
-    /** Check if the value is a minimum or maximum */
-    if( ( m_Value < m_BestValue )  ^  m_Maximize )         // ^ = xor, yields true if only one of the expressions is true
-    {
-      m_BestValue              = m_Value;
-      m_BestPointInSearchSpace = m_CurrentPointInSearchSpace;
-      m_BestIndexInSearchSpace = m_CurrentIndexInSearchSpace;
+      this->InvokeEvent( IterationEvent() );
+
+      /** Prepare for next step */
+      m_CurrentIteration++;
+
+      if( m_Stop )
+      {
+        break;
+      }
     }
+  }
 
-    this->InvokeEvent( IterationEvent() );
+}   // end EvaluatePoints
 
-    /** Prepare for next step */
-    m_CurrentIteration++;
 
-    if( m_CurrentIteration >= this->GetNumberOfIterations() )
-    {
-      m_StopCondition = FullRangeSearched;
-      StopOptimization();
-      break;
-    }
+/**
+ * ****************** EvaluateBatchThreaderCallback ******************
+ */
+ITK_THREAD_RETURN_TYPE
+FullSearchOptimizer
+::EvaluateBatchThreaderCallback( void * arg )
+{
+  ThreadInfoType *   infoStruct = static_cast< ThreadInfoType * >( arg );
+  const ThreadIdType threadId   = infoStruct->ThreadID;
+  Self *             self       = static_cast< Self * >( infoStruct->UserData );
 
-    /** Set the next position in search space. */
-    this->UpdateCurrentPosition();
+  self->ThreadedEvaluateBatch( threadId );
 
-  }   // end while
+  return ITK_THREAD_RETURN_VALUE;
 
-}   //end function ResumeOptimization
+}   // end EvaluateBatchThreaderCallback
+
+
+/**
+ * ********************* ThreadedEvaluateBatch *******************
+ */
+void
+FullSearchOptimizer
+::ThreadedEvaluateBatch( ThreadIdType threadId )
+{
+  /** Thread 0 uses the cost function itself, the other threads each use
+   * their own independent instance. */
+  const CostFunctionType * costFunction = threadId == 0
+    ? m_CostFunction.GetPointer()
+    : m_IndependentCostFunctions[ threadId - 1 ].GetPointer();
+  const unsigned int numberOfThreads = m_IndependentCostFunctions.size() + 1;
+
+  for( unsigned long i = threadId; i < m_BatchPositions.size(); i += numberOfThreads )
+  {
+    m_BatchValues[ i ] = costFunction->GetValue( m_BatchPositions[ i ] );
+  }
+
+}   // end ThreadedEvaluateBatch
+
+
+/**
+ * ********************* SetIndependentCostFunctions *************
+ */
+void
+FullSearchOptimizer
+::SetIndependentCostFunctions( const CostFunctionContainerType & costFunctions )
+{
+  itkDebugMacro( "SetIndependentCostFunctions" );
+
+  m_IndependentCostFunctions = costFunctions;
+  this->Modified();
+
+}   // end SetIndependentCostFunctions
 
 
 /**
@@ -463,6 +736,51 @@ FullSearchOptimizer
 }   // end IndexToPoint
 
 
+/**
+ * ********************* PointNumberToIndex *********************
+ */
+FullSearchOptimizer::SearchSpaceIndexType
+FullSearchOptimizer
+::PointNumberToIndex( unsigned long pointNumber )
+{
+  const unsigned int          searchSpaceDimension = this->GetNumberOfSearchSpaceDimensions();
+  const SearchSpaceSizeType & searchSpaceSize      = this->GetSearchSpaceSize();
+  SearchSpaceIndexType        index( searchSpaceDimension );
+
+  /** Dimension 0 runs fastest, as in UpdateCurrentPosition(). */
+  for( unsigned int ssdim = 0; ssdim < searchSpaceDimension; ssdim++ )
+  {
+    index[ ssdim ] = static_cast< IndexValueType >( pointNumber % searchSpaceSize[ ssdim ] );
+    pointNumber   /= searchSpaceSize[ ssdim ];
+  }
+
+  return index;
+
+}   // end PointNumberToIndex
+
+
+/**
+ * ********************* IndexToPointNumber *********************
+ */
+unsigned long
+FullSearchOptimizer
+::IndexToPointNumber( const SearchSpaceIndexType & index )
+{
+  const unsigned int          searchSpaceDimension = this->GetNumberOfSearchSpaceDimensions();
+  const SearchSpaceSizeType & searchSpaceSize      = this->GetSearchSpaceSize();
+
+  unsigned long pointNumber = 0;
+  for( unsigned int ssdim = searchSpaceDimension; ssdim > 0; ssdim-- )
+  {
+    pointNumber = pointNumber * searchSpaceSize[ ssdim - 1 ]
+      + static_cast< unsigned long >( index[ ssdim - 1 ] );
+  }
+
+  return pointNumber;
+
+}   // end IndexToPointNumber
+
+
 } // end namespace itk
 
 #endif // #ifndef __itkFullSearchOptimizer_cxx
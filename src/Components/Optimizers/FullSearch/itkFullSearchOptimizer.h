@@ -24,6 +24,9 @@
 #include "itkImage.h"
 #include "itkArray.h"
 #include "itkFixedArray.h"
+#include "itkNumericTraits.h"
+#include "itkPersistentThreadPool.h"
+#include <vector>
 
 namespace itk
 {
@@ -35,6 +38,17 @@ namespace itk
  * Optimizer that scans a subspace of the parameter space
  * and searches for the best parameters.
  *
+ * The grid points can be evaluated concurrently, if independent instances
+ * of the cost function are set with SetIndependentCostFunctions(). The
+ * points are evaluated in batches, and reported one by one with an
+ * IterationEvent, in the same order as in the sequential case.
+ *
+ * Instead of the full grid, a coarse-to-fine search can be done by setting
+ * the CoarseGridStride larger than 1. Then, only the grid points of which
+ * all indices are multiples of the stride are evaluated first. After that,
+ * all grid points around the best NumberOfRefinementCells coarse points,
+ * so within the coarse grid cells that touch these points, are evaluated.
+ *
  * \todo This optimizer has similar functionality as the recently added
  * itkExhaustiveOptimizer. See if we can replace it by that optimizer,
  * or inherit from it.
@@ -89,6 +103,9 @@ public:
   /** The size of each dimension to be searched ((max-min)/step)) */
   typedef Array< SizeValueType > SearchSpaceSizeType;
 
+  /** A container of independent cost functions. */
+  typedef std::vector< CostFunctionPointer > CostFunctionContainerType;
+
   /** NB: The methods SetScales has no influence! */
 
   /** Methods to configure the cost function. */
@@ -171,6 +188,33 @@ public:
   /** Convert an index to a point */
   virtual SearchSpacePointType IndexToPoint( const SearchSpaceIndexType & index );
 
+  /** Convert the number of a point in the grid, which is the iteration
+   * number at which the point is visited in a full search, to an index,
+   * and vice versa. */
+  virtual SearchSpaceIndexType PointNumberToIndex( unsigned long pointNumber );
+
+  virtual unsigned long IndexToPointNumber( const SearchSpaceIndexType & index );
+
+  /** Set/Get the stride of the coarse grid for a coarse-to-fine search.
+   * Default: 1, so the full grid is searched. */
+  itkSetClampMacro( CoarseGridStride, unsigned int, 1, NumericTraits< unsigned int >::max() );
+  itkGetConstMacro( CoarseGridStride, unsigned int );
+
+  /** Set/Get the number of best coarse grid points around which the grid is
+   * refined in a coarse-to-fine search. Default: 1 */
+  itkSetClampMacro( NumberOfRefinementCells, unsigned int, 1, NumericTraits< unsigned int >::max() );
+  itkGetConstMacro( NumberOfRefinementCells, unsigned int );
+
+  /** Set independent instances of the cost function, which are used
+   * together with the cost function set by SetCostFunction() to evaluate
+   * the grid points concurrently, one thread per cost function instance.
+   * All instances should return the same value for the same parameters.
+   * Default: empty, so the grid points are evaluated sequentially. */
+  virtual void SetIndependentCostFunctions( const CostFunctionContainerType & costFunctions );
+
+  const CostFunctionContainerType & GetIndependentCostFunctions( void ) const
+  { return this->m_IndependentCostFunctions; }
+
   /** Get the current iteration number. */
   itkGetConstMacro( CurrentIteration, unsigned long );
 
@@ -215,6 +259,22 @@ protected:
   unsigned long m_LastSearchSpaceChanges;
   virtual void ProcessSearchSpaceChanges( void );
 
+  typedef std::vector< unsigned long > PointNumberContainerType;
+  typedef std::vector< MeasureType >   MeasureContainerType;
+
+  /** Evaluate the grid points with the given numbers, in batches that are
+   * evaluated concurrently if independent cost functions are set. The
+   * points are reported in the given order with an IterationEvent, and
+   * their values are returned. Stops early if the optimization is stopped. */
+  virtual void EvaluatePoints( const PointNumberContainerType & pointNumbers,
+    MeasureContainerType & values );
+
+  /** Evaluate all grid points from the current iteration on. */
+  virtual void SearchFullGrid( void );
+
+  /** Evaluate the coarse grid, and refine around the best coarse points. */
+  virtual void SearchCoarseToFine( void );
+
 private:
 
   FullSearchOptimizer( const Self & ); // purposely not implemented
@@ -222,6 +282,24 @@ private:
 
   unsigned long m_CurrentIteration;
 
+  unsigned int m_CoarseGridStride;
+  unsigned int m_NumberOfRefinementCells;
+
+  /** Concurrent evaluation of a batch of grid points. */
+  typedef PersistentThreadPool           ThreadPoolType;
+  typedef ThreadPoolType::ThreadInfoType ThreadInfoType;
+
+  CostFunctionContainerType     m_IndependentCostFunctions;
+  ThreadPoolType::Pointer       m_ThreadPool;
+  std::vector< ParametersType > m_BatchPositions;
+  MeasureContainerType          m_BatchValues;
+
+  /** The callback that is executed by the threads of m_ThreadPool. */
+  static ITK_THREAD_RETURN_TYPE EvaluateBatchThreaderCallback( void * arg );
+
+  /** Evaluate the batch points i = threadId + k * numberOfThreads. */
+  void ThreadedEvaluateBatch( ThreadIdType threadId );
+
 };
 
 } // end namespace itk
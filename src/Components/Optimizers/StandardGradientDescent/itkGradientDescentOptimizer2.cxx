@@ -21,6 +21,7 @@
 #include "itkCommand.h"
 #include "itkEventObject.h"
 #include "itkExceptionObject.h"
+#include "itkPhaseProfiler.h"
 
 #ifdef ELASTIX_USE_OPENMP
 #include <omp.h>
@@ -54,6 +55,9 @@ GradientDescentOptimizer2
   this->m_UseMultiThread = false;
   this->m_UseOpenMP      = false;
   this->m_UseEigen       = false;
+
+  this->m_UseSparseGradient = false;
+  this->m_GradientIsSparse  = false;
   //this->m_Threader->SetUseThreadPool( true );
 
 } // end Constructor
@@ -79,6 +83,8 @@ GradientDescentOptimizer2
      << this->m_Value;
   os << indent << "StopCondition: "
      << this->m_StopCondition;
+  os << indent << "UseSparseGradient: "
+     << this->m_UseSparseGradient;
   os << std::endl;
   os << indent << "Gradient: "
      << this->m_Gradient;
@@ -131,12 +137,25 @@ GradientDescentOptimizer2
                    = this->GetScaledCostFunction()->GetNumberOfParameters();
   this->m_Gradient = DerivativeType( spaceDimension );   // check this
 
+  /** Use the sparse gradient if desired and supported by the cost function. */
+  this->m_GradientIsSparse = this->m_UseSparseGradient
+    && this->GetScaledCostFunction()->GetSupportsSparseDerivative();
+
   while( !this->m_Stop )
   {
     try
     {
-      this->GetScaledValueAndDerivative(
-        this->GetScaledCurrentPosition(), m_Value, m_Gradient );
+      PhaseProfiler::ScopedProbe probe( "GetValueAndDerivative" );
+      if( this->m_GradientIsSparse )
+      {
+        this->GetScaledValueAndSparseDerivative(
+          this->GetScaledCurrentPosition(), m_Value, m_SparseGradient );
+      }
+      else
+      {
+        this->GetScaledValueAndDerivative(
+          this->GetScaledCurrentPosition(), m_Value, m_Gradient );
+      }
     }
     catch( ExceptionObject & err )
     {
@@ -214,6 +233,9 @@ GradientDescentOptimizer2
 {
   itkDebugMacro( "AdvanceOneStep" );
 
+  /** Profile the update of the position, if desired. */
+  PhaseProfiler::ScopedProbe probe( "AdvanceOneStep" );
+
   /** Get space dimension. */
   const unsigned int spaceDimension
     = this->GetScaledCostFunction()->GetNumberOfParameters();
@@ -222,8 +244,13 @@ GradientDescentOptimizer2
   ParametersType & newPosition = this->m_ScaledCurrentPosition;
 
   /** Advance one step. */
+  // with a sparse gradient, only update the touched blocks in place
+  if( this->m_GradientIsSparse )
+  {
+    this->m_SparseGradient.AddTo( newPosition, -this->m_LearningRate );
+  }
   // single-threadedly
-  if( true )
+  else if( true )
   //if( !this->m_UseMultiThread || true )   // for now force single-threaded since it is fastest most of the times
   //if( !this->m_UseMultiThread && false ) // force multi-threaded
   {
@@ -314,6 +341,8 @@ GradientDescentOptimizer2
     delete temp;
   }
 
+  /** The observers of the IterationEvent are not part of this phase. */
+  probe.Stop();
   this->InvokeEvent( IterationEvent() );
 
 } // end AdvanceOneStep()
@@ -75,6 +75,7 @@ public:
   typedef Superclass::ScalesType                ScalesType;
   typedef Superclass::ScaledCostFunctionType    ScaledCostFunctionType;
   typedef Superclass::ScaledCostFunctionPointer ScaledCostFunctionPointer;
+  typedef Superclass::SparseDerivativeType      SparseDerivativeType;
 
   /** Codes of stopping conditions
    * The MinimumStepSize stopcondition never occurs, but may
@@ -126,6 +127,26 @@ public:
   /** Get current gradient. */
   itkGetConstReferenceMacro( Gradient, DerivativeType );
 
+  /** Set/Get whether the gradient is computed as a sparse derivative, if
+   * the cost function supports it, see SparseDerivativeCostFunction. In
+   * that case AdvanceOneStep() only updates the parameters of the blocks
+   * that the gradient touches, and GetGradient() is not updated; use
+   * GetSparseGradient() instead. Subclasses that use the dense gradient
+   * should leave this off. Default: false.
+   */
+  itkSetMacro( UseSparseGradient, bool );
+  itkGetConstMacro( UseSparseGradient, bool );
+
+  /** Get the current sparse gradient. */
+  const SparseDerivativeType & GetSparseGradient( void ) const
+  {
+    return this->m_SparseGradient;
+  }
+
+
+  /** Whether the current gradient is the sparse gradient. */
+  itkGetConstMacro( GradientIsSparse, bool );
+
   /** Set the number of threads. */
   void SetNumberOfThreads( ThreadIdType numberOfThreads )
   {
@@ -135,6 +156,7 @@ public:
 
   //itkGetConstReferenceMacro( NumberOfThreads, ThreadIdType );
   itkSetMacro( UseMultiThread, bool );
+  itkGetConstMacro( UseMultiThread, bool );
 
   itkSetMacro( UseOpenMP, bool );
   itkSetMacro( UseEigen, bool );
@@ -150,10 +172,12 @@ protected:
   typedef ThreaderType::ThreadInfoStruct ThreadInfoType;
 
   // made protected so subclass can access
-  double            m_Value;
-  DerivativeType    m_Gradient;
-  double            m_LearningRate;
-  StopConditionType m_StopCondition;
+  double               m_Value;
+  DerivativeType       m_Gradient;
+  SparseDerivativeType m_SparseGradient;
+  bool                 m_GradientIsSparse;
+  double               m_LearningRate;
+  StopConditionType    m_StopCondition;
 
   ThreaderType::Pointer m_Threader;
 
@@ -176,6 +200,7 @@ private:
 
   bool m_UseOpenMP;
   bool m_UseEigen;
+  bool m_UseSparseGradient;
 
   /** The callback function. */
   static ITK_THREAD_RETURN_TYPE AdvanceOneStepThreaderCallback( void * arg );
@@ -89,6 +89,19 @@ namespace elastix
  *    example: <tt>(Metric0Use "false" "true")</tt> \n
  *    example: <tt>(Metric1Use "true" "false")</tt> \n
  *    The default is "true".
+ * \parameter UseTransformSampleCache: Whether the mapped points and transform
+ *    Jacobians of the samples are computed once per iteration and shared by
+ *    the metrics. This only helps metrics that use the same ImageSampler,
+ *    i.e. when only one sampler is given, and costs memory for a Jacobian per
+ *    sample. \n
+ *    example: <tt>(UseTransformSampleCache "true")</tt> \n
+ *    The default is "false".
+ * \parameter UseSparseDerivatives: Whether metrics that only affect a small
+ *    part of the parameters, such as the CorrespondingPointsEuclideanDistanceMetric
+ *    and the DisplacementMagnitudePenalty with a masked sampler, return a
+ *    sparse derivative, which is combined without creating a dense copy. \n
+ *    example: <tt>(UseSparseDerivatives "true")</tt> \n
+ *    The default is "false".
  *
  * \ingroup Registrations
  */
@@ -114,6 +114,16 @@ MultiMetricMultiResolutionRegistration< TElastix >
   }
   else { this->GetCombinationMetric()->SetUseMultiThread( false ); }
 
+  /** Share the mapped points and transform Jacobians between the metrics. */
+  bool useTransformSampleCache = false;
+  this->GetConfiguration()->ReadParameter( useTransformSampleCache, "UseTransformSampleCache", 0 );
+  this->GetCombinationMetric()->SetUseTransformSampleCache( useTransformSampleCache );
+
+  /** Let the metrics that support it return a sparse derivative. */
+  bool useSparseDerivatives = false;
+  this->GetConfiguration()->ReadParameter( useSparseDerivatives, "UseSparseDerivatives", 0 );
+  this->GetCombinationMetric()->SetUseSparseDerivatives( useSparseDerivatives );
+
 } // end BeforeRegistration()
 
 
@@ -50,6 +50,11 @@ namespace itk
  * why we chose to reimplement the Get{Transform,Interpolator}()
  * methods.
  *
+ * When UseMultiThread is on, the sub metrics are evaluated concurrently.
+ * The threads of this metric are divided over the concurrently running
+ * sub metrics, so that the total number of threads stays within the
+ * number of threads of this metric. When there are fewer threads than
+ * metrics, each thread evaluates several metrics in turn.
  *
  * \ingroup RegistrationMetrics
  *
@@ -112,6 +117,7 @@ public:
   typedef typename Superclass::DerivativeType             DerivativeType;
   typedef typename Superclass::DerivativeValueType        DerivativeValueType;
   typedef typename Superclass::ParametersType             ParametersType;
+  typedef typename Superclass::SparseDerivativeType       SparseDerivativeType;
 
   /** Some typedefs for computing the SelfHessian */
   typedef typename Superclass::HessianValueType HessianValueType;
@@ -165,6 +171,9 @@ public:
   typedef typename Superclass::ThreaderType   ThreaderType;
   typedef typename Superclass::ThreadInfoType ThreadInfoType;
 
+  /** Typedefs for the transform sample cache. */
+  typedef typename Superclass::TransformSampleCacheType TransformSampleCacheType;
+
   /**
    * Get and set the metrics and their weights.
    **/
@@ -200,8 +209,30 @@ public:
   itkSetMacro( UseRelativeWeights, bool );
   itkGetMacro( UseRelativeWeights, bool );
 
-  /** \todo: Temporary, should think about interface. */
+  /** Set and Get the UseMultiThread variable. If on, the sub metrics are
+   * evaluated concurrently. Call Initialize() after changing it, since it
+   * determines the number of threads that each sub metric is given.
+   */
   itkSetMacro( UseMultiThread, bool );
+  itkGetConstMacro( UseMultiThread, bool );
+
+  /** Set and Get the UseTransformSampleCache variable. If on, the mapped
+   * points and transform Jacobians of the samples are computed once per
+   * iteration, and shared by the sub metrics with the same image sampler
+   * and transform; see TransformSampleCache. Call Initialize() after
+   * changing it. Default: false.
+   */
+  itkSetMacro( UseTransformSampleCache, bool );
+  itkGetConstMacro( UseTransformSampleCache, bool );
+
+  /** Set and Get the UseSparseDerivatives variable. If on, the sub metrics
+   * that support it, such as the corresponding points metric, return their
+   * derivative as a SparseDerivativeType. Scaling, adding and computing the
+   * magnitude of these derivatives then only touches the blocks of
+   * parameters that they affect. Default: false.
+   */
+  itkSetMacro( UseSparseDerivatives, bool );
+  itkGetConstMacro( UseSparseDerivatives, bool );
 
   /** Select which metrics are used.
    * This is useful in case you want to compute a certain measure, but not
@@ -393,6 +424,19 @@ public:
     MeasureType & value,
     DerivativeType & derivative ) const;
 
+  /** A sparse derivative is supported if UseSparseDerivatives is on and
+   * all used sub metrics support it.
+   */
+  virtual bool GetSupportsSparseDerivative( void ) const;
+
+  /** Combine the sparse derivatives of the sub metrics, without creating
+   * a dense derivative.
+   */
+  virtual void GetValueAndSparseDerivative(
+    const ParametersType & parameters,
+    MeasureType & value,
+    SparseDerivativeType & derivative ) const;
+
   /** Experimental feature: compute SelfHessian. */
   virtual void GetSelfHessian(
     const TransformParametersType & parameters,
@@ -427,6 +471,8 @@ protected:
   std::vector< bool >                            m_UseMetric;
   mutable std::vector< MeasureType >             m_MetricValues;
   mutable std::vector< DerivativeType >          m_MetricDerivatives;
+  mutable std::vector< SparseDerivativeType >    m_MetricSparseDerivatives;
+  mutable std::vector< bool >                    m_MetricDerivativeIsSparse;
   mutable std::vector< double >                  m_MetricDerivativesMagnitude;
   mutable std::vector< double >                  m_MetricComputationTime;
 
@@ -450,14 +496,50 @@ private:
    */
   double GetFinalMetricWeight( unsigned int pos ) const;
 
+  /** The number of threads that evaluate the sub metrics concurrently. */
+  ThreadIdType GetNumberOfMetricEvaluationThreads( void ) const;
+
+  /** The number of threads that sub metric i may use itself. Summed over
+   * the sub metrics that run at the same time, this does not exceed the
+   * number of threads of this metric.
+   */
+  ThreadIdType GetNumberOfThreadsOfMetric( unsigned int pos ) const;
+
+  /** Let all sub metrics set their own transform parameters again, and
+   * empty the transform sample cache, so that calling the sub metrics
+   * directly after an evaluation of this metric is safe.
+   */
+  void ResetSubMetricsAfterEvaluation( void ) const;
+
+  /** Return the sparse derivative interface of sub metric i, if
+   * UseSparseDerivatives is on and the sub metric supports it, else 0.
+   */
+  const SparseDerivativeCostFunction * GetSparseDerivativeMetric( unsigned int pos ) const;
+
+  /** Compute the values and the dense or sparse derivatives of all sub
+   * metrics, serially or concurrently. Used by GetValueAndDerivative()
+   * and GetValueAndSparseDerivative().
+   */
+  void ComputeMetricValuesAndDerivatives( const ParametersType & parameters,
+    const bool useMultiThread ) const;
+
+  /** Compute the value and derivative of sub metric i. Thread-safe for
+   * different sub metrics.
+   */
+  void ComputeMetricValueAndDerivative( unsigned int pos,
+    const ParametersType & parameters ) const;
+
+  /** Combine the values of the sub metrics, using the final weights. */
+  MeasureType CombineMetricValues( void ) const;
+
   /** For threading: store thread data. */
   struct MultiThreaderComboMetricsType
   {
-    std::vector< SingleValuedCostFunctionPointer > st_MetricsIterator;
-    typename std::vector< MeasureType >::iterator st_MetricValuesIterator;
-    typename std::vector< DerivativeType >::iterator st_MetricDerivativesIterator;
-    std::vector< double > st_MetricComputationTime;
-    ParametersType *           st_Parameters;
+    Self *                         st_ThisComboMetric;
+    const ParametersType *         st_Parameters;
+    std::vector< double >          st_MetricComputationTime;
+    std::vector< ExceptionObject > st_MetricExceptions;
+    std::vector< unsigned char >   st_MetricExceptionThrown;
   };
 
   struct MultiThreaderCombineDerivativeType
@@ -468,6 +550,8 @@ private:
   };
 
   bool m_UseMultiThread;
+  bool m_UseTransformSampleCache;
+  bool m_UseSparseDerivatives;
 
 };
 
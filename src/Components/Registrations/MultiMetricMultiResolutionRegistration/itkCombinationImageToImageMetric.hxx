@@ -21,6 +21,8 @@
 #include "itkCombinationImageToImageMetric.h"
 #include "itkTimeProbe.h"
 #include "itkMath.h"
+#include "itkPhaseProfiler.h"
+#include <algorithm>
 
 
 /** Macros to reduce some copy-paste work.
@@ -165,7 +167,9 @@ CombinationImageToImageMetric< TFixedImage, TMovingImage >
   this->m_UseRelativeWeights = false;
   this->ComputeGradientOff();
 
-  this->m_UseMultiThread = true;
+  this->m_UseMultiThread          = true;
+  this->m_UseTransformSampleCache = false;
+  this->m_UseSparseDerivatives    = false;
 
 } // end Constructor
 
@@ -281,6 +285,8 @@ CombinationImageToImageMetric< TFixedImage, TMovingImage >
     this->m_UseMetric.resize( count );
     this->m_MetricValues.resize( count );
     this->m_MetricDerivatives.resize( count );
+    this->m_MetricSparseDerivatives.resize( count );
+    this->m_MetricDerivativeIsSparse.resize( count, false );
     this->m_MetricDerivativesMagnitude.resize( count );
     this->m_MetricComputationTime.resize( count );
     this->Modified();
@@ -523,6 +529,11 @@ const typename CombinationImageToImageMetric< TFixedImage, TMovingImage >
   }
   else
   {
+    /** A sparse derivative is only made dense when it is asked for. */
+    if( this->m_MetricDerivativeIsSparse[ pos ] )
+    {
+      this->m_MetricSparseDerivatives[ pos ].GetDense( this->m_MetricDerivatives[ pos ] );
+    }
     return this->m_MetricDerivatives[ pos ];
   }
 
@@ -618,6 +629,21 @@ CombinationImageToImageMetric< TFixedImage, TMovingImage >
     itkExceptionMacro( << "At least one metric should be set!" );
   }
 
+  /** Create or remove the transform sample cache. */
+  if( this->m_UseTransformSampleCache )
+  {
+    if( this->m_TransformSampleCache.IsNull() )
+    {
+      this->m_TransformSampleCache = TransformSampleCacheType::New();
+    }
+    this->m_TransformSampleCache->SetNumberOfThreads( this->GetNumberOfThreads() );
+    this->m_TransformSampleCache->Clear();
+  }
+  else
+  {
+    this->m_TransformSampleCache = 0;
+  }
+
   /** Call Initialize for all metrics. */
   for( unsigned int i = 0; i < this->GetNumberOfMetrics(); i++ )
   {
@@ -630,11 +656,12 @@ CombinationImageToImageMetric< TFixedImage, TMovingImage >
     PointSetMetricType * testPtr2 = dynamic_cast< PointSetMetricType * >( this->GetMetric( i ) );
     if( testPtr1 )
     {
-      // The NumberOfThreadsPerMetric is changed after Initialize() so we save it before and then
-      // set it on.
-      unsigned nrOfThreadsPerMetric = this->GetNumberOfThreads();
+      /** Initialize() resets the number of threads of the sub metric,
+       * so its share of the threads of this metric is set afterwards.
+       */
       testPtr1->Initialize();
-      testPtr1->SetNumberOfThreads( nrOfThreadsPerMetric );
+      testPtr1->SetNumberOfThreads( this->GetNumberOfThreadsOfMetric( i ) );
+      testPtr1->SetTransformSampleCache( this->m_TransformSampleCache );
     }
     else if( testPtr2 )
     {
@@ -654,10 +681,13 @@ void
 CombinationImageToImageMetric< TFixedImage, TMovingImage >
 ::InitializeThreadingParameters( void ) const
 {
-  /** Initialize the derivatives. */
+  /** Initialize the dense derivatives. */
   for( ThreadIdType i = 0; i < this->GetNumberOfMetrics(); ++i )
   {
-    this->m_MetricDerivatives[ i ].SetSize( this->GetNumberOfParameters() );
+    if( !this->m_MetricDerivativeIsSparse[ i ] )
+    {
+      this->m_MetricDerivatives[ i ].SetSize( this->GetNumberOfParameters() );
+    }
   }
 } // end InitializeThreadingParameters()
 
@@ -696,6 +726,89 @@ CombinationImageToImageMetric< TFixedImage, TMovingImage >
 } // end GetFinalMetricWeight()
 
 
+/**
+ * ********************* GetNumberOfMetricEvaluationThreads ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+ThreadIdType
+CombinationImageToImageMetric< TFixedImage, TMovingImage >
+::GetNumberOfMetricEvaluationThreads( void ) const
+{
+  if( !this->m_UseMultiThread || this->m_NumberOfMetrics < 2 )
+  {
+    return 1;
+  }
+
+  const ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+  return std::max< ThreadIdType >( 1,
+    std::min< ThreadIdType >( numberOfThreads, this->m_NumberOfMetrics ) );
+
+} // end GetNumberOfMetricEvaluationThreads()
+
+
+/**
+ * ********************* GetNumberOfThreadsOfMetric ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+ThreadIdType
+CombinationImageToImageMetric< TFixedImage, TMovingImage >
+::GetNumberOfThreadsOfMetric( unsigned int pos ) const
+{
+  const ThreadIdType numberOfThreads           = this->GetNumberOfThreads();
+  const ThreadIdType numberOfEvaluationThreads = this->GetNumberOfMetricEvaluationThreads();
+  if( numberOfEvaluationThreads < 2 )
+  {
+    return numberOfThreads;
+  }
+
+  /** Metric pos is evaluated by thread pos % numberOfEvaluationThreads.
+   * Divide the threads evenly over the evaluation threads, giving the
+   * remainder to the first ones.
+   */
+  const ThreadIdType evaluationThread = pos % numberOfEvaluationThreads;
+  ThreadIdType       share            = numberOfThreads / numberOfEvaluationThreads;
+  if( evaluationThread < numberOfThreads % numberOfEvaluationThreads )
+  {
+    ++share;
+  }
+  return share;
+
+} // end GetNumberOfThreadsOfMetric()
+
+
+/**
+ * ********************* ResetSubMetricsAfterEvaluation ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+CombinationImageToImageMetric< TFixedImage, TMovingImage >
+::ResetSubMetricsAfterEvaluation( void ) const
+{
+  for( unsigned int i = 0; i < this->m_NumberOfMetrics; i++ )
+  {
+    ImageMetricType *    testPtr1 = dynamic_cast< ImageMetricType * >( this->GetMetric( i ) );
+    PointSetMetricType * testPtr2 = dynamic_cast< PointSetMetricType * >( this->GetMetric( i ) );
+    if( testPtr1 )
+    {
+      testPtr1->SetUseMetricSingleThreaded( true );
+    }
+    if( testPtr2 )
+    {
+      testPtr2->SetUseMetricSingleThreaded( true );
+    }
+  }
+
+  if( this->m_TransformSampleCache.IsNotNull() )
+  {
+    this->m_TransformSampleCache->Clear();
+  }
+
+} // end ResetSubMetricsAfterEvaluation()
+
+
 /**
  * ********************* GetValue ****************************
  */
@@ -785,6 +898,7 @@ CombinationImageToImageMetric< TFixedImage, TMovingImage >
 
     /** store ... */
     this->m_MetricDerivatives[ i ]          = tmpDerivative;
+    this->m_MetricDerivativeIsSparse[ i ]   = false;
     this->m_MetricDerivativesMagnitude[ i ] = tmpDerivative.magnitude();
     this->m_MetricComputationTime[ i ]      = timer.GetMean() * 1000.0;
 
@@ -819,23 +933,97 @@ CombinationImageToImageMetric< TFixedImage, TMovingImage >
 
 
 /**
- * ********************* GetValueAndDerivative ****************************
+ * ********************* GetSparseDerivativeMetric ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+const SparseDerivativeCostFunction *
+CombinationImageToImageMetric< TFixedImage, TMovingImage >
+::GetSparseDerivativeMetric( unsigned int pos ) const
+{
+  if( !this->m_UseSparseDerivatives )
+  {
+    return 0;
+  }
+
+  const SparseDerivativeCostFunction * sparseMetric
+    = dynamic_cast< const SparseDerivativeCostFunction * >( this->m_Metrics[ pos ].GetPointer() );
+  if( sparseMetric && sparseMetric->GetSupportsSparseDerivative() )
+  {
+    return sparseMetric;
+  }
+  return 0;
+
+} // end GetSparseDerivativeMetric()
+
+
+/**
+ * ********************* GetSupportsSparseDerivative ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+bool
+CombinationImageToImageMetric< TFixedImage, TMovingImage >
+::GetSupportsSparseDerivative( void ) const
+{
+  if( !this->m_UseSparseDerivatives || this->m_NumberOfMetrics == 0 )
+  {
+    return false;
+  }
+
+  for( unsigned int i = 0; i < this->m_NumberOfMetrics; i++ )
+  {
+    if( this->m_UseMetric[ i ] && !this->GetSparseDerivativeMetric( i ) )
+    {
+      return false;
+    }
+  }
+  return true;
+
+} // end GetSupportsSparseDerivative()
+
+
+/**
+ * ********************* ComputeMetricValueAndDerivative ****************************
  */
 
 template< class TFixedImage, class TMovingImage >
 void
 CombinationImageToImageMetric< TFixedImage, TMovingImage >
-::GetValueAndDerivative(
-  const ParametersType & parameters,
-  MeasureType & value,
-  DerivativeType & derivative ) const
+::ComputeMetricValueAndDerivative( unsigned int pos,
+  const ParametersType & parameters ) const
+{
+  if( this->m_MetricDerivativeIsSparse[ pos ] )
+  {
+    this->GetSparseDerivativeMetric( pos )->GetValueAndSparseDerivative( parameters,
+      this->m_MetricValues[ pos ], this->m_MetricSparseDerivatives[ pos ] );
+  }
+  else
+  {
+    this->m_Metrics[ pos ]->GetValueAndDerivative( parameters,
+      this->m_MetricValues[ pos ], this->m_MetricDerivatives[ pos ] );
+  }
+
+} // end ComputeMetricValueAndDerivative()
+
+
+/**
+ * ********************* ComputeMetricValuesAndDerivatives ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+CombinationImageToImageMetric< TFixedImage, TMovingImage >
+::ComputeMetricValuesAndDerivatives( const ParametersType & parameters,
+  const bool useMultiThread ) const
 {
   /** Declare timer and multi-threader. */
   itk::TimeProbe timer;
   typename ThreaderType::Pointer local_threader = ThreaderType::New();
 
   /** This function must be called before the multi-threaded code.
-   * It calls all the non thread-safe stuff.
+   * It calls all the non thread-safe stuff. Also decide which sub
+   * metrics return a sparse derivative.
    */
   for( unsigned int i = 0; i < this->m_NumberOfMetrics; i++ )
   {
@@ -853,169 +1041,293 @@ CombinationImageToImageMetric< TFixedImage, TMovingImage >
       testPtr2->BeforeThreadedGetValueAndDerivative( parameters );
       testPtr2->SetUseMetricSingleThreaded( false );
     }
+    this->m_MetricDerivativeIsSparse[ i ] = this->GetSparseDerivativeMetric( i ) != 0;
   }
 
   /** Initialize some threading related parameters. */
   this->InitializeThreadingParameters();
 
-  /** Decide whether or not to use multi-threading.
-   * If the global maximum number of threads is smaller than the number
-   * of metrics, then setting the number of threads to the number of
-   * threads will result in a bug: all metrics after the max will not be
-   * run. For now we decide to run this metric single-threadedly in that case.
-   *
-   * Actually we should sum the number of threads of each metric and check that
-   * it does not surpass the global maximum. But for now we don't.
-   */
-  bool useMultiThread = this->m_UseMultiThread;
-  if( MultiThreader::GetGlobalMaximumNumberOfThreads() < this->m_NumberOfMetrics )
+  try
   {
-    useMultiThread = false;
-  }
-
-  // For now we disable multi-threading of the combo metric, since the MacMini build
-  // segfaults with it. Have to investigate this issue later
-  useMultiThread = false;
+    /** Fill the transform sample cache, now that the samplers are updated. */
+    if( this->m_TransformSampleCache.IsNotNull() )
+    {
+      this->m_TransformSampleCache->Clear();
+      for( unsigned int i = 0; i < this->m_NumberOfMetrics; i++ )
+      {
+        ImageMetricType * testPtr1 = dynamic_cast< ImageMetricType * >( this->GetMetric( i ) );
+        if( testPtr1 )
+        {
+          testPtr1->UpdateTransformSampleCache();
+        }
+      }
+    }
 
-  /** Compute all metric values and derivatives, single-threadedly. */
-  if( !useMultiThread )
-  {
-    for( unsigned int i = 0; i < this->m_NumberOfMetrics; i++ )
+    /** Compute all metric values and derivatives, single-threadedly. */
+    if( !useMultiThread )
     {
-      /** Compute ... */
-      timer.Reset();
-      timer.Start();
-      this->m_Metrics[ i ]->GetValueAndDerivative( parameters,
-        this->m_MetricValues[ i ], this->m_MetricDerivatives[ i ] );
-      timer.Stop();
-
-      /** Store computation time. */
-      this->m_MetricComputationTime[ i ] = timer.GetMean() * 1000.0;
+      for( unsigned int i = 0; i < this->m_NumberOfMetrics; i++ )
+      {
+        /** Compute ... */
+        timer.Reset();
+        timer.Start();
+        this->ComputeMetricValueAndDerivative( i, parameters );
+        timer.Stop();
+
+        /** Store computation time. */
+        this->m_MetricComputationTime[ i ] = timer.GetMean() * 1000.0;
+      }
+    }
+    /** Compute all metric values and derivatives, multi-threadedly. */
+    else
+    {
+      /** Setup struct with multi-threading information. */
+      MultiThreaderComboMetricsType temp_c;
+      temp_c.st_ThisComboMetric = const_cast< Self * >( this );
+      temp_c.st_Parameters      = &parameters;
+      temp_c.st_MetricComputationTime.resize( this->m_NumberOfMetrics, 0.0 );
+      temp_c.st_MetricExceptions.resize( this->m_NumberOfMetrics );
+      temp_c.st_MetricExceptionThrown.resize( this->m_NumberOfMetrics, 0 );
+
+      /** GetValueAndDerivative */
+      local_threader->SetNumberOfThreads( this->GetNumberOfMetricEvaluationThreads() );
+      local_threader->SetSingleMethod( GetValueAndDerivativeComboThreaderCallback, &temp_c );
+      local_threader->SingleMethodExecute();
+
+      /** Store computation time and forward the first exception. */
+      for( unsigned int i = 0; i < this->m_NumberOfMetrics; i++ )
+      {
+        this->m_MetricComputationTime[ i ] = temp_c.st_MetricComputationTime[ i ];
+      }
+      for( unsigned int i = 0; i < this->m_NumberOfMetrics; i++ )
+      {
+        if( temp_c.st_MetricExceptionThrown[ i ] )
+        {
+          throw temp_c.st_MetricExceptions[ i ];
+        }
+      }
     }
   }
-  /** Compute all metric values and derivatives, multi-threadedly. */
-  else
+  catch( ... )
   {
-    /** Setup struct with multi-threading information. */
-    MultiThreaderComboMetricsType * temp_c = new MultiThreaderComboMetricsType;
-    temp_c->st_MetricsIterator           = this->m_Metrics;
-    temp_c->st_MetricDerivativesIterator = this->m_MetricDerivatives.begin();
-    temp_c->st_MetricValuesIterator      = this->m_MetricValues.begin();
-    temp_c->st_MetricComputationTime.resize( this->m_NumberOfMetrics, 0 );
-    temp_c->st_Parameters = const_cast< ParametersType * >( &parameters );
-
-    /** GetValueAndDerivative */
-    local_threader->SetNumberOfThreads( this->m_NumberOfMetrics );
-    local_threader->SetSingleMethod( GetValueAndDerivativeComboThreaderCallback, temp_c );
-    local_threader->SingleMethodExecute();
+    this->ResetSubMetricsAfterEvaluation();
+    throw;
+  }
+  this->ResetSubMetricsAfterEvaluation();
 
-    /** Store computation time. */
-    for( unsigned int i = 0; i < this->m_NumberOfMetrics; i++ )
+} // end ComputeMetricValuesAndDerivatives()
+
+
+/**
+ * ********************* CombineMetricValues ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+typename CombinationImageToImageMetric< TFixedImage, TMovingImage >::MeasureType
+CombinationImageToImageMetric< TFixedImage, TMovingImage >
+::CombineMetricValues( void ) const
+{
+  MeasureType value = NumericTraits< MeasureType >::Zero;
+  for( unsigned int i = 0; i < this->m_NumberOfMetrics; i++ )
+  {
+    if( this->m_UseMetric[ i ] )
     {
-      this->m_MetricComputationTime[ i ] = temp_c->st_MetricComputationTime[ i ];
-    }
+      double weight = this->GetFinalMetricWeight( i );
+      value += weight * this->m_MetricValues[ i ];
+    } // end if m_UseMetric[i]
+  }   // end of combine metrics
 
-    delete temp_c;
-  }
+  return value;
+
+} // end CombineMetricValues()
+
+
+/**
+ * ********************* GetValueAndDerivative ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+CombinationImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueAndDerivative(
+  const ParametersType & parameters,
+  MeasureType & value,
+  DerivativeType & derivative ) const
+{
+  /** Declare the multi-threader. */
+  typename ThreaderType::Pointer local_threader = ThreaderType::New();
+
+  /** Decide whether or not to evaluate the sub metrics concurrently.
+   * The number of threads of the sub metrics was already divided in
+   * Initialize(), and when there are fewer threads than metrics each
+   * thread evaluates several metrics. The phase profiler keeps a single
+   * stack of phases, so profiled runs are evaluated serially.
+   */
+  const bool useMultiThread = this->GetNumberOfMetricEvaluationThreads() > 1
+    && !PhaseProfiler::GetEnabled();
+
+  /** Compute all metric values and derivatives. */
+  this->ComputeMetricValuesAndDerivatives( parameters, useMultiThread );
+  derivative.SetSize( this->GetNumberOfParameters() );
 
   /** Compute the derivative magnitude, single-threadedly. */
-  // I get random segfaults on the Linux or Mac systems when this is enabled.
-  // For now disable multi-threading and force single-threaded:
-  //if( !this->m_UseMultiThread )
-  if( true )
+  if( !useMultiThread )
   {
     for( unsigned int i = 0; i < this->m_NumberOfMetrics; i++ )
     {
-      this->m_MetricDerivativesMagnitude[ i ] = this->m_MetricDerivatives[ i ].magnitude();
+      if( this->m_MetricDerivativeIsSparse[ i ] )
+      {
+        this->m_MetricDerivativesMagnitude[ i ]
+          = vcl_sqrt( this->m_MetricSparseDerivatives[ i ].GetSquaredMagnitude() );
+      }
+      else
+      {
+        this->m_MetricDerivativesMagnitude[ i ] = this->m_MetricDerivatives[ i ].magnitude();
+      }
     }
   }
   /** Compute the derivative magnitude, multi-threadedly. */
   else
   {
     /** Setup struct with multi-threading information. */
-    ThreadIdType                         numberOfThreads = this->GetNumberOfThreads();
-    MultiThreaderCombineDerivativeType * temp_m          = new MultiThreaderCombineDerivativeType;
-    temp_m->st_ThisComboMetric = const_cast< Self * >( this );
-    temp_m->st_DerivativesSumOfSquares.resize( numberOfThreads * this->m_NumberOfMetrics );
+    local_threader->SetNumberOfThreads( this->GetNumberOfThreads() );
+    const ThreadIdType                 numberOfThreads = local_threader->GetNumberOfThreads();
+    MultiThreaderCombineDerivativeType temp_m;
+    temp_m.st_ThisComboMetric = const_cast< Self * >( this );
+    temp_m.st_DerivativesSumOfSquares.resize( numberOfThreads * this->m_NumberOfMetrics, 0.0 );
+    temp_m.st_Derivative = 0;
 
     /** Compute derivatives magnitude multi-threadedly. */
-    local_threader->SetNumberOfThreads( numberOfThreads );
-    local_threader->SetSingleMethod( ComputeDerivativesMagnitudeThreaderCallback, temp_m );
+    local_threader->SetSingleMethod( ComputeDerivativesMagnitudeThreaderCallback, &temp_m );
     local_threader->SingleMethodExecute();
 
-    /** Gather the results. */
+    /** Gather the results. The sparse derivatives are skipped by the
+     * threads, since they are small.
+     */
     for( unsigned int i = 0; i < this->m_NumberOfMetrics; i++ )
     {
       double mag = 0.0;
-      for( unsigned int j = 0; j < numberOfThreads; j++ )
+      if( this->m_MetricDerivativeIsSparse[ i ] )
+      {
+        mag = this->m_MetricSparseDerivatives[ i ].GetSquaredMagnitude();
+      }
+      else
       {
-        mag += temp_m->st_DerivativesSumOfSquares[ i * numberOfThreads + j ];
+        for( unsigned int j = 0; j < numberOfThreads; j++ )
+        {
+          mag += temp_m.st_DerivativesSumOfSquares[ i * numberOfThreads + j ];
+        }
       }
       this->m_MetricDerivativesMagnitude[ i ] = vcl_sqrt( mag );
     }
-
-    delete temp_m;
   }
 
   /** Combine the metric values, single-threadedly. */
-  value = NumericTraits< MeasureType >::Zero;
-  for( unsigned int i = 0; i < this->m_NumberOfMetrics; i++ )
-  {
-    if( this->m_UseMetric[ i ] )
-    {
-      double weight = this->GetFinalMetricWeight( i );
-      value += weight * this->m_MetricValues[ i ];
-    } // end if m_UseMetric[i]
-  }   // end of combine metrics
+  value = this->CombineMetricValues();
 
-  /** Combine the metric derivatives, single-threadedly. */
-  // I get random segfaults on the linux or Mac systems when this is enabled.
-  // For now disable multi-threading and force single-threaded:
-  //if( !this->m_UseMultiThread )
-  if( true )
+  /** Combine the dense metric derivatives, single-threadedly. */
+  if( !useMultiThread )
   {
-    /** The first derivative. */
-    if( this->m_UseMetric[ 0 ] )
-    {
-      double weight = this->GetFinalMetricWeight( 0 );
-      derivative = weight * this->m_MetricDerivatives[ 0 ];
-    }
-    else
-    {
-      derivative.Fill( 0 );
-    }
-
-    /** The remaining derivatives. */
-    for( unsigned int i = 1; i < this->m_NumberOfMetrics; i++ )
+    /** The first dense derivative is assigned, the others are added. */
+    bool derivativeIsSet = false;
+    for( unsigned int i = 0; i < this->m_NumberOfMetrics; i++ )
     {
-      /** and combine. */
-      if( this->m_UseMetric[ i ] )
+      if( this->m_UseMetric[ i ] && !this->m_MetricDerivativeIsSparse[ i ] )
       {
         double weight = this->GetFinalMetricWeight( i );
-        derivative += weight * this->m_MetricDerivatives[ i ];
+        if( !derivativeIsSet )
+        {
+          derivative      = weight * this->m_MetricDerivatives[ i ];
+          derivativeIsSet = true;
+        }
+        else
+        {
+          derivative += weight * this->m_MetricDerivatives[ i ];
+        }
       } // end if m_UseMetric[i]
     }   // end of combine metrics
+
+    if( !derivativeIsSet )
+    {
+      derivative.Fill( 0 );
+    }
   }
-  /** Combine the derivatives, multi-threadedly. */
+  /** Combine the dense derivatives, multi-threadedly. */
   else
   {
     /** Setup struct with multi-threading information. */
-    ThreadIdType                         numberOfThreads = this->GetNumberOfThreads();
-    MultiThreaderCombineDerivativeType * temp_d          = new MultiThreaderCombineDerivativeType;
-    temp_d->st_ThisComboMetric = const_cast< Self * >( this );
-    temp_d->st_Derivative      = &derivative[ 0 ];
+    MultiThreaderCombineDerivativeType temp_d;
+    temp_d.st_ThisComboMetric = const_cast< Self * >( this );
+    temp_d.st_Derivative      = derivative.data_block();
 
     /** Combine derivatives */
-    local_threader->SetNumberOfThreads( numberOfThreads );
-    local_threader->SetSingleMethod( CombineDerivativesThreaderCallback, temp_d );
+    local_threader->SetNumberOfThreads( this->GetNumberOfThreads() );
+    local_threader->SetSingleMethod( CombineDerivativesThreaderCallback, &temp_d );
     local_threader->SingleMethodExecute();
+  }
 
-    delete temp_d;
+  /** Add the sparse derivatives, which only touches their blocks. */
+  for( unsigned int i = 0; i < this->m_NumberOfMetrics; i++ )
+  {
+    if( this->m_UseMetric[ i ] && this->m_MetricDerivativeIsSparse[ i ] )
+    {
+      this->m_MetricSparseDerivatives[ i ].AddTo( derivative, this->GetFinalMetricWeight( i ) );
+    }
   }
 
 } // end GetValueAndDerivative()
 
 
+/**
+ * ********************* GetValueAndSparseDerivative ****************************
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+CombinationImageToImageMetric< TFixedImage, TMovingImage >
+::GetValueAndSparseDerivative(
+  const ParametersType & parameters,
+  MeasureType & value,
+  SparseDerivativeType & derivative ) const
+{
+  if( !this->GetSupportsSparseDerivative() )
+  {
+    itkExceptionMacro( << "Not all used sub metrics support a sparse derivative." );
+  }
+
+  /** Compute all metric values and derivatives, see GetValueAndDerivative(). */
+  const bool useMultiThread = this->GetNumberOfMetricEvaluationThreads() > 1
+    && !PhaseProfiler::GetEnabled();
+  this->ComputeMetricValuesAndDerivatives( parameters, useMultiThread );
+
+  /** Compute the derivative magnitude. Unused metrics may be dense. */
+  for( unsigned int i = 0; i < this->m_NumberOfMetrics; i++ )
+  {
+    if( this->m_MetricDerivativeIsSparse[ i ] )
+    {
+      this->m_MetricDerivativesMagnitude[ i ]
+        = vcl_sqrt( this->m_MetricSparseDerivatives[ i ].GetSquaredMagnitude() );
+    }
+    else
+    {
+      this->m_MetricDerivativesMagnitude[ i ] = this->m_MetricDerivatives[ i ].magnitude();
+    }
+  }
+
+  /** Combine the metric values and the derivatives of the used metrics. */
+  value = this->CombineMetricValues();
+  derivative.SetSize( this->GetNumberOfParameters() );
+  for( unsigned int i = 0; i < this->m_NumberOfMetrics; i++ )
+  {
+    if( this->m_UseMetric[ i ] )
+    {
+      derivative.Add( this->m_MetricSparseDerivatives[ i ], this->GetFinalMetricWeight( i ) );
+    }
+  }
+
+} // end GetValueAndSparseDerivative()
+
+
 /**
  * **************** GetValueAndDerivativeThreaderCallback *******
  */
@@ -1028,17 +1340,42 @@ CombinationImageToImageMetric< TFixedImage, TMovingImage >
   ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
   ThreadIdType     threadID   = infoStruct->ThreadID;
 
+  ThreadIdType     nrOfThreads = infoStruct->NumberOfThreads;
+
   MultiThreaderComboMetricsType * temp
     = static_cast< MultiThreaderComboMetricsType * >( infoStruct->UserData );
+  Self * combo = temp->st_ThisComboMetric;
 
-  itk::TimeProbe timer;
-  timer.Start();
-  temp->st_MetricsIterator[ threadID ]->GetValueAndDerivative(
-    *temp->st_Parameters,
-    temp->st_MetricValuesIterator[ threadID ],
-    temp->st_MetricDerivativesIterator[ threadID ] );
-  timer.Stop();
-  temp->st_MetricComputationTime[ threadID ] = timer.GetMean() * 1000.0;
+  /** Each thread evaluates the metrics threadID, threadID + nrOfThreads, ...
+   * Exceptions are stored and rethrown by the calling thread.
+   */
+  for( unsigned int i = threadID; i < combo->m_NumberOfMetrics; i += nrOfThreads )
+  {
+    itk::TimeProbe timer;
+    timer.Start();
+    try
+    {
+      combo->ComputeMetricValueAndDerivative( i, *temp->st_Parameters );
+    }
+    catch( ExceptionObject & err )
+    {
+      temp->st_MetricExceptions[ i ]      = err;
+      temp->st_MetricExceptionThrown[ i ] = 1;
+    }
+    catch( std::exception & err )
+    {
+      temp->st_MetricExceptions[ i ] = ExceptionObject( __FILE__, __LINE__, err.what() );
+      temp->st_MetricExceptionThrown[ i ] = 1;
+    }
+    catch( ... )
+    {
+      temp->st_MetricExceptions[ i ] = ExceptionObject( __FILE__, __LINE__,
+        "Unknown exception while evaluating a sub metric." );
+      temp->st_MetricExceptionThrown[ i ] = 1;
+    }
+    timer.Stop();
+    temp->st_MetricComputationTime[ i ] = timer.GetMean() * 1000.0;
+  }
 
   return ITK_THREAD_RETURN_VALUE;
 
@@ -1076,17 +1413,18 @@ CombinationImageToImageMetric< TFixedImage, TMovingImage >
   double derivativeValue = 0.0;
   for( unsigned int i = 0; i < numberOfMetrics; i++ )
   {
-    if( temp->st_ThisComboMetric->m_UseMetric[ i ] )
+    if( temp->st_ThisComboMetric->m_MetricDerivativeIsSparse[ i ] )
     {
-      const DerivativeType & derivative   = temp->st_ThisComboMetric->m_MetricDerivatives[ i ];
-      double                 sumOfSquares = 0.0;
-      for( unsigned int j = jmin; j < jmax; j++ )
-      {
-        derivativeValue = derivative[ j ];
-        sumOfSquares   += derivativeValue * derivativeValue;
-      }
-      temp->st_DerivativesSumOfSquares[ i * nrOfThreads + threadId ] = sumOfSquares;
+      continue;
     }
+    const DerivativeType & derivative   = temp->st_ThisComboMetric->m_MetricDerivatives[ i ];
+    double                 sumOfSquares = 0.0;
+    for( unsigned int j = jmin; j < jmax; j++ )
+    {
+      derivativeValue = derivative[ j ];
+      sumOfSquares   += derivativeValue * derivativeValue;
+    }
+    temp->st_DerivativesSumOfSquares[ i * nrOfThreads + threadId ] = sumOfSquares;
   }
 
   return ITK_THREAD_RETURN_VALUE;
@@ -1121,28 +1459,40 @@ CombinationImageToImageMetric< TFixedImage, TMovingImage >
   unsigned int jmax = ( threadId + 1 ) * subSize;
   jmax = ( jmax > numberOfParameters ) ? numberOfParameters : jmax;
 
-  // First metric, assign
-  if( temp->st_ThisComboMetric->m_UseMetric[ 0 ] )
+  /** The first used dense derivative is assigned, the others are added.
+   * The sparse derivatives are added afterwards by the calling thread.
+   */
+  bool derivativeIsSet = false;
+  for( unsigned int i = 0; i < numberOfMetrics; i++ )
   {
-    double                 weight           = temp->st_ThisComboMetric->GetFinalMetricWeight( 0 );
-    const DerivativeType & metricDerivative = temp->st_ThisComboMetric->m_MetricDerivatives[ 0 ];
-    for( unsigned int j = jmin; j < jmax; j++ )
+    if( temp->st_ThisComboMetric->m_UseMetric[ i ]
+      && !temp->st_ThisComboMetric->m_MetricDerivativeIsSparse[ i ] )
     {
-      temp->st_Derivative[ j ] = weight * metricDerivative[ j ];
+      double                 weight           = temp->st_ThisComboMetric->GetFinalMetricWeight( i );
+      const DerivativeType & metricDerivative = temp->st_ThisComboMetric->m_MetricDerivatives[ i ];
+      if( !derivativeIsSet )
+      {
+        for( unsigned int j = jmin; j < jmax; j++ )
+        {
+          temp->st_Derivative[ j ] = weight * metricDerivative[ j ];
+        }
+        derivativeIsSet = true;
+      }
+      else
+      {
+        for( unsigned int j = jmin; j < jmax; j++ )
+        {
+          temp->st_Derivative[ j ] += weight * metricDerivative[ j ];
+        }
+      }
     }
   }
 
-  // Other metrics, add
-  for( unsigned int i = 1; i < numberOfMetrics; i++ )
+  if( !derivativeIsSet )
   {
-    if( temp->st_ThisComboMetric->m_UseMetric[ i ] )
+    for( unsigned int j = jmin; j < jmax; j++ )
     {
-      double                 weight           = temp->st_ThisComboMetric->GetFinalMetricWeight( i );
-      const DerivativeType & metricDerivative = temp->st_ThisComboMetric->m_MetricDerivatives[ i ];
-      for( unsigned int j = jmin; j < jmax; j++ )
-      {
-        temp->st_Derivative[ j ] += weight * metricDerivative[ j ];
-      }
+      temp->st_Derivative[ j ] = NumericTraits< DerivativeValueType >::Zero;
     }
   }
 
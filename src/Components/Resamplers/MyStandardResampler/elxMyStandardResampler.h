@@ -19,7 +19,7 @@
 #define __elxMyStandardResampler_h
 
 #include "elxIncludes.h" // include first to avoid MSVS warning
-#include "itkResampleImageFilter.h"
+#include "itkRayCastResampleImageFilter.h"
 
 namespace elastix
 {
@@ -28,6 +28,10 @@ namespace elastix
  * \class MyStandardResampler
  * \brief A resampler based on the itk::ResampleImageFilter.
  *
+ * The resampler is an itk::RayCastResampleImageFilter, which renders the
+ * result image with packets of rays if the FinalRayCastInterpolator is
+ * selected, and otherwise behaves as the itk::ResampleImageFilter.
+ *
  * The parameters used in this class are:
  * \parameter Resampler: Select this resampler as follows:\n
  *    <tt>(Resampler "DefaultResampler")</tt>
@@ -37,17 +41,23 @@ namespace elastix
 
 template< class TElastix >
 class MyStandardResampler :
-  public ResamplerBase< TElastix >::ITKBaseType,
+  public itk::RayCastResampleImageFilter<
+  typename ResamplerBase< TElastix >::InputImageType,
+  typename ResamplerBase< TElastix >::OutputImageType,
+  typename ResamplerBase< TElastix >::CoordRepType >,
   public ResamplerBase< TElastix >
 {
 public:
 
   /** Standard ITK-stuff. */
-  typedef MyStandardResampler                             Self;
-  typedef typename ResamplerBase< TElastix >::ITKBaseType Superclass1;
-  typedef ResamplerBase< TElastix >                       Superclass2;
-  typedef itk::SmartPointer< Self >                       Pointer;
-  typedef itk::SmartPointer< const Self >                 ConstPointer;
+  typedef MyStandardResampler Self;
+  typedef itk::RayCastResampleImageFilter<
+    typename ResamplerBase< TElastix >::InputImageType,
+    typename ResamplerBase< TElastix >::OutputImageType,
+    typename ResamplerBase< TElastix >::CoordRepType > Superclass1;
+  typedef ResamplerBase< TElastix >       Superclass2;
+  typedef itk::SmartPointer< Self >       Pointer;
+  typedef itk::SmartPointer< const Self > ConstPointer;
 
   /** Method for creation through the object factory. */
   itkNewMacro( Self );
@@ -74,6 +74,10 @@ namespace elastix
  *   <em>Nonrigid registration of dynamic medical imaging data using nD+t B-splines and a
  *   groupwise optimization approach</em>, C.T. Metz, S. Klein, M. Schaap, T. van Walsum and
  *   W.J. Niessen, Medical Image Analysis, in press.
+ * \parameter UseVectorizedTransformPoint: use the SSE2/AVX implementation of the
+ *   batched point transformation of the cubic B-spline. \n
+ *   example: <tt>(UseVectorizedTransformPoint "true")</tt> \n
+ *   The default is "false".
  *
  *
  * The transform parameters necessary for transformix, additionally defined by this class, are:
@@ -93,6 +93,12 @@ AdvancedBSplineTransform< TElastix >
     }
   }
 
+  /** Select the vectorized batch point transformation, if requested. */
+  bool useVectorizedTransformPoint = false;
+  this->GetConfiguration()->ReadParameter( useVectorizedTransformPoint,
+    "UseVectorizedTransformPoint", this->GetComponentLabel(), 0, 0, true );
+  this->m_BSplineTransform->SetUseVectorizedTransformPoint( useVectorizedTransformPoint );
+
   this->SetCurrentTransform( this->m_BSplineTransform );
   this->m_GridUpsampler = GridUpsamplerType::New();
   this->m_GridUpsampler->SetBSplineOrder( this->m_SplineOrder );
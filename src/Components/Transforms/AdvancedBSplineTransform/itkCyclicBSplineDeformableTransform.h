@@ -129,6 +129,15 @@ public:
     ParameterIndexArrayType & indices,
     bool & inside ) const;
 
+  /** Transform a batch of points. The native batch implementation of the
+   * superclass does not know about the cyclic dimension, so this calls
+   * TransformPoint() for each point.
+   */
+  virtual void TransformPoints(
+    const InputPointType * inputPoints,
+    OutputPointType * outputPoints,
+    SizeValueType numberOfPoints ) const;
+
   /** Compute the Jacobian of the transformation. */
   virtual void GetJacobian(
     const InputPointType & ipp,
@@ -245,6 +245,23 @@ CyclicBSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
 }
 
 
+/** Transform a batch of points. */
+template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
+void
+CyclicBSplineDeformableTransform< TScalarType, NDimensions, VSplineOrder >
+::TransformPoints(
+  const InputPointType * inputPoints,
+  OutputPointType * outputPoints,
+  SizeValueType numberOfPoints ) const
+{
+  for( SizeValueType i = 0; i < numberOfPoints; ++i )
+  {
+    /** Calls the TransformPoint() with 5 arguments of this class. */
+    outputPoints[ i ] = this->Superclass::TransformPoint( inputPoints[ i ] );
+  }
+}
+
+
 /** Compute the Jacobian in one position. */
 template< class TScalarType, unsigned int NDimensions, unsigned int VSplineOrder >
 void
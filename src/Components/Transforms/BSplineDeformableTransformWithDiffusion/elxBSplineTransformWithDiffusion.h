@@ -348,6 +348,24 @@ public:
    */
   virtual OutputPointType TransformPoint( const InputPointType  & point ) const;
 
+  /** Method to transform a batch of points. For the same reason as above,
+   * this calls the TransformPoint() of this class for each point, instead of
+   * the batch implementation of the BSplineCombinationTransform.
+   */
+  virtual void TransformPoints(
+    const InputPointType * inputPoints,
+    OutputPointType * outputPoints,
+    itk::SizeValueType numberOfPoints ) const;
+
+  /** Method to transform a batch of points that are stored as a structure of
+   * arrays. Like TransformPoints(), this calls the TransformPoint() of this
+   * class for each point, so that both layouts map the points in the same way.
+   */
+  virtual void TransformPointsSoA(
+    const ScalarType * const * inputCoordinates,
+    OutputPointType * outputPoints,
+    itk::SizeValueType numberOfPoints ) const;
+
   /**  Method to transform a point with extra arguments. Just calls
    * the Superclass1's implementation. Has to be present here since it is an
    * overloaded function.
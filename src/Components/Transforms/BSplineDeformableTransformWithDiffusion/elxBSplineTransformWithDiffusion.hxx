@@ -1458,6 +1458,51 @@ BSplineTransformWithDiffusion< TElastix >
 } // end TransformPoint()
 
 
+/**
+ * ******************* TransformPoints ******************
+ */
+
+template< class TElastix >
+void
+BSplineTransformWithDiffusion< TElastix >
+::TransformPoints(
+  const InputPointType * inputPoints,
+  OutputPointType * outputPoints,
+  itk::SizeValueType numberOfPoints ) const
+{
+  for( itk::SizeValueType i = 0; i < numberOfPoints; ++i )
+  {
+    outputPoints[ i ] = this->TransformPoint( inputPoints[ i ] );
+  }
+
+} // end TransformPoints()
+
+
+/**
+ * ******************* TransformPointsSoA ******************
+ */
+
+template< class TElastix >
+void
+BSplineTransformWithDiffusion< TElastix >
+::TransformPointsSoA(
+  const ScalarType * const * inputCoordinates,
+  OutputPointType * outputPoints,
+  itk::SizeValueType numberOfPoints ) const
+{
+  InputPointType inputPoint;
+  for( itk::SizeValueType i = 0; i < numberOfPoints; ++i )
+  {
+    for( unsigned int d = 0; d < SpaceDimension; ++d )
+    {
+      inputPoint[ d ] = inputCoordinates[ d ][ i ];
+    }
+    outputPoints[ i ] = this->TransformPoint( inputPoint );
+  }
+
+} // end TransformPointsSoA()
+
+
 } // end namespace elastix
 
 #endif // end #ifndef __elxBSplineTransformWithDiffusion_HXX__
@@ -64,6 +64,26 @@ namespace elastix
  *    CheckNumberOfSamples. \n
  *    example: <tt>(RequiredRatioOfValidSamples 0.1)</tt> \n
  *    The default is 0.25.
+ * \parameter UseDynamicSampleScheduling: Whether the samples are distributed
+ *    dynamically over the threads, in chunks, where idle threads steal work
+ *    from busy threads. Useful when the cost per sample varies a lot, for
+ *    example with masks. Can be given for each resolution. \n
+ *    example: <tt>(UseDynamicSampleScheduling "true")</tt> \n
+ *    The default is "false".
+ * \parameter SampleSchedulingChunkSize: The number of samples that a thread
+ *    claims at once when UseDynamicSampleScheduling is "true". \n
+ *    example: <tt>(SampleSchedulingChunkSize 256)</tt> \n
+ *    The default is 0, which means that it is determined automatically.
+ * \parameter UseStructureOfArraysSamples: Whether the multi-threaded metrics
+ *    read the samples from a structure of arrays (contiguous coordinate and
+ *    value arrays) instead of from an array of sample structs. \n
+ *    example: <tt>(UseStructureOfArraysSamples "true")</tt> \n
+ *    The default is "false".
+ * \parameter ShowThreadLoadImbalance: Whether the ratio of the slowest thread
+ *    time and the mean thread time is shown each iteration, in the column
+ *    Imbalance<metric label>. A value of 1 means perfect balance. \n
+ *    example: <tt>(ShowThreadLoadImbalance "true")</tt> \n
+ *    The default is "false".
  *
  * \ingroup Metrics
  * \ingroup ComponentBaseClasses
@@ -215,6 +235,7 @@ protected:
   /** \todo the method GetExactDerivative could as well be added here. */
 
   bool                             m_ShowExactMetricValue;
+  bool                             m_ShowThreadLoadImbalance;
   ExactMetricImageSamplerPointer   m_ExactMetricSampler;
   MeasureType                      m_CurrentExactMetricValue;
   ExactMetricSampleGridSpacingType m_ExactMetricSampleGridSpacing;
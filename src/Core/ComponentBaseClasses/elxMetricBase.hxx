@@ -33,6 +33,7 @@ MetricBase< TElastix >
 {
   /** Initialize. */
   this->m_ShowExactMetricValue    = false;
+  this->m_ShowThreadLoadImbalance = false;
   this->m_ExactMetricSampler      = 0;
   this->m_CurrentExactMetricValue = 0.0;
   this->m_ExactMetricSampleGridSpacing.Fill( 1 );
@@ -170,8 +171,48 @@ MetricBase< TElastix >
     }
     else { thisAsAdvanced->SetUseMultiThread( false ); }
 
+    /** Keep the threads alive between iterations? Default true. */
+    bool usePersistentThreadPool = true;
+    this->GetConfiguration()->ReadParameter( usePersistentThreadPool,
+      "UsePersistentThreadPool", this->GetComponentLabel(), level, 0, false );
+    thisAsAdvanced->SetUsePersistentThreadPool( usePersistentThreadPool );
+
+    /** Distribute the samples dynamically over the threads? Default false. */
+    bool useDynamicSampleScheduling = false;
+    this->GetConfiguration()->ReadParameter( useDynamicSampleScheduling,
+      "UseDynamicSampleScheduling", this->GetComponentLabel(), level, 0, false );
+    thisAsAdvanced->SetUseDynamicSampleScheduling( useDynamicSampleScheduling );
+
+    unsigned long chunkSize = 0;
+    this->GetConfiguration()->ReadParameter( chunkSize,
+      "SampleSchedulingChunkSize", this->GetComponentLabel(), level, 0, false );
+    thisAsAdvanced->SetSampleSchedulingChunkSize( chunkSize );
+
+    /** Read the samples from a structure of arrays? Default false. */
+    bool useStructureOfArraysSamples = false;
+    this->GetConfiguration()->ReadParameter( useStructureOfArraysSamples,
+      "UseStructureOfArraysSamples", this->GetComponentLabel(), level, 0, false );
+    thisAsAdvanced->SetUseStructureOfArraysSamples( useStructureOfArraysSamples );
+
   } // end Advanced metric
 
+  /** Define the name of the thread load imbalance column. */
+  std::string imbalanceColumn = "Imbalance";
+  imbalanceColumn += this->GetComponentLabel();
+  xl::xout[ "iteration" ].RemoveTargetCell( imbalanceColumn.c_str() );
+
+  /** Read the parameter file: Show the thread load imbalance in every iteration? */
+  bool showThreadLoadImbalance = false;
+  this->GetConfiguration()->ReadParameter( showThreadLoadImbalance,
+    "ShowThreadLoadImbalance", this->GetComponentLabel(), level, 0, false );
+  this->m_ShowThreadLoadImbalance = showThreadLoadImbalance && thisAsAdvanced != 0;
+  if( this->m_ShowThreadLoadImbalance )
+  {
+    xl::xout[ "iteration" ].AddTargetCell( imbalanceColumn.c_str() );
+    xl::xout[ "iteration" ][ imbalanceColumn.c_str() ]
+      << std::showpoint << std::fixed;
+  }
+
 } // end BeforeEachResolutionBase()
 
 
@@ -201,6 +242,18 @@ MetricBase< TElastix >
       << this->m_CurrentExactMetricValue;
   }
 
+  /** Show the ratio of the slowest thread time and the mean thread time. */
+  if( this->m_ShowThreadLoadImbalance )
+  {
+    std::string imbalanceColumn = "Imbalance";
+    imbalanceColumn += this->GetComponentLabel();
+
+    const AdvancedMetricType * thisAsAdvanced
+      = dynamic_cast< const AdvancedMetricType * >( this );
+    xl::xout[ "iteration" ][ imbalanceColumn.c_str() ]
+      << thisAsAdvanced->GetThreadLoadImbalance();
+  }
+
 } // end AfterEachIterationBase()
 
 
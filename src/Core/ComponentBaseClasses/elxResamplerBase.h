@@ -65,6 +65,13 @@ namespace elastix
  *    of the written image is desired.\n
  *    example: <tt>(CompressResultImage "true")</tt> \n
  *    The default is "false".
+ * \parameter ResultImageStreamingMemoryMB: the memory budget in MB for writing the
+ *    result image. Larger result images are resampled, cast and written in slabs
+ *    that fit within the budget, so that the full result image is never in memory.
+ *    This requires an image format that supports streamed writing, such as
+ *    uncompressed mhd; otherwise the result image is written at once.\n
+ *    example: <tt>(ResultImageStreamingMemoryMB 512)</tt> \n
+ *    The default is 0, which means no streaming.
  *
  * \ingroup Resamplers
  * \ingroup ComponentBaseClasses
@@ -175,9 +182,13 @@ public:
   /** Function to perform resample and write the result output image to a file. */
   virtual void ResampleAndWriteResultImage( const char * filename, const bool & showProgress = true );
 
-  /** Function to write the result output image to a file. */
+  /** Function to write the result output image to a file. If the number
+   * of stream divisions is larger than one, the image is requested from
+   * its source and written in that number of parts.
+   */
   virtual void WriteResultImage( OutputImageType *imageimage,
-    const char * filename, const bool & showProgress = true );
+    const char * filename, const bool & showProgress = true,
+    const unsigned int numberOfStreamDivisions = 1 );
 
   /** Function to create the result image in the format of an itk::Image. */
   virtual void CreateItkResultImage( void );
@@ -192,6 +203,11 @@ protected:
   /** Method that sets the transform, the interpolator and the inputImage. */
   virtual void SetComponents( void );
 
+  /** Get the number of stream divisions with which the result image is
+   * written, given the memory budget ResultImageStreamingMemoryMB.
+   */
+  virtual unsigned int GetNumberOfStreamDivisions( void ) const;
+
   /** Variable that defines to print the progress or not. */
   bool m_ShowProgress;
 
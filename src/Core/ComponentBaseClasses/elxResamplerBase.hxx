@@ -325,25 +325,34 @@ ResamplerBase< TElastix >
   }
 #endif
 
-  /** Do the resampling. */
-  try
-  {
-    this->GetAsITKBaseType()->Update();
-  }
-  catch( itk::ExceptionObject & excp )
-  {
-    /** Add information to the exception. */
-    excp.SetLocation( "ResamplerBase - WriteResultImage()" );
-    std::string err_str = excp.GetDescription();
-    err_str += "\nError occurred while resampling the image.\n";
-    excp.SetDescription( err_str );
+  /** Check if the result image should be written in parts. */
+  const unsigned int numberOfStreamDivisions = this->GetNumberOfStreamDivisions();
 
-    /** Pass the exception to an higher level. */
-    throw excp;
+  /** Do the resampling. When streaming, the writer requests the result
+   * image part by part from the resampler instead.
+   */
+  if( numberOfStreamDivisions == 1 )
+  {
+    try
+    {
+      this->GetAsITKBaseType()->Update();
+    }
+    catch( itk::ExceptionObject & excp )
+    {
+      /** Add information to the exception. */
+      excp.SetLocation( "ResamplerBase - WriteResultImage()" );
+      std::string err_str = excp.GetDescription();
+      err_str += "\nError occurred while resampling the image.\n";
+      excp.SetDescription( err_str );
+
+      /** Pass the exception to an higher level. */
+      throw excp;
+    }
   }
 
   /** Perform the writing. */
-  this->WriteResultImage( this->GetAsITKBaseType()->GetOutput(), filename, showProgress );
+  this->WriteResultImage( this->GetAsITKBaseType()->GetOutput(), filename,
+    showProgress, numberOfStreamDivisions );
 
   /** Disconnect from the resampler. */
 #ifndef _ELASTIX_BUILD_LIBRARY
@@ -364,7 +373,8 @@ template< class TElastix >
 void
 ResamplerBase< TElastix >
 ::WriteResultImage( OutputImageType *image,
-  const char * filename, const bool & showProgress )
+  const char * filename, const bool & showProgress,
+  const unsigned int numberOfStreamDivisions )
 {
   /** Check if ResampleInterpolator is the RayCastResampleInterpolator  */
   typedef itk::AdvancedRayCastInterpolateImageFunction<  InputImageType,
@@ -420,6 +430,7 @@ ResamplerBase< TElastix >
   writer->SetFileName( filename );
   writer->SetOutputComponentType( resultImagePixelType.c_str() );
   writer->SetUseCompression( doCompression );
+  writer->SetNumberOfStreamDivisions( numberOfStreamDivisions );
 
   /** Do the writing. */
   if( showProgress )
@@ -445,6 +456,27 @@ ResamplerBase< TElastix >
 } // end WriteResultImage()
 
 
+/**
+ * ******************* GetNumberOfStreamDivisions ********************
+ */
+
+template< class TElastix >
+unsigned int
+ResamplerBase< TElastix >
+::GetNumberOfStreamDivisions( void ) const
+{
+  /** Per voxel, a part holds the resampled value and its cast to the
+   * ResultImagePixelType, which is at most a double.
+   */
+  const double bytesPerPixel  = sizeof( OutputPixelType ) + sizeof( double );
+  const double numberOfPixels = static_cast< double >(
+    this->GetAsITKBaseType()->GetSize().CalculateProductOfElements() );
+  return this->ComputeNumberOfStreamDivisions( "ResultImageStreamingMemoryMB",
+    "The result image", numberOfPixels, bytesPerPixel );
+
+} // end GetNumberOfStreamDivisions()
+
+
 /*
  * ******************* CreateItkResultImage ********************
  * \todo: avoid code duplication with WriteResultImage function
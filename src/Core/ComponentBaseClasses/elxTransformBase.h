@@ -25,6 +25,7 @@
 #include "elxBaseComponentSE.h"
 #include "itkAdvancedTransform.h"
 #include "itkAdvancedCombinationTransform.h"
+#include "itkBinaryParametersFile.h"
 #include "elxComponentDatabase.h"
 #include "elxProgressCommand.h"
 
@@ -52,6 +53,19 @@ namespace elastix
  *   "Compose" by composition: \f$T(x) = T_1 ( T_0(x) )\f$.\n
  *   example: <tt>(HowToCombineTransforms "Add")</tt>\n
  *   Default: "Add".
+ * \parameter WriteTransformParametersBinary: Write the transform parameters to a binary
+ *   file next to the transform parameter file, which then refers to it with the
+ *   BinaryTransformParametersFileName entry. This speeds up writing and reading
+ *   for transforms with many parameters, such as dense B-spline grids.\n
+ *   example: <tt>(WriteTransformParametersBinary "true")</tt>\n
+ *   Default: "false".
+ * \parameter FieldStreamingMemoryMB: The memory budget in MB for the deformation field
+ *   (-def all), the spatial Jacobian determinant (-jac all) and the spatial Jacobian
+ *   (-jacmat all) that transformix writes. Larger fields are computed and written in slabs
+ *   that fit within the budget. This requires an image format that supports streamed
+ *   writing, such as uncompressed mhd; otherwise the field is written at once.\n
+ *   example: <tt>(FieldStreamingMemoryMB 1024)</tt>\n
+ *   Default: 0, which means no streaming.
  *
  * \transformparameter UseDirectionCosines: Controls whether to use or ignore the
  * direction cosines (world matrix, transform matrix) set in the images.
@@ -98,6 +112,11 @@ namespace elastix
  * \transformparameter TransformParameters: the transform parameter vector that defines the transformation.\n
  * example <tt>(TransformParameters 0.03 1.0 0.2 ...)</tt>\n
  * The number of entries is stored the NumberOfParameters entry.
+ * \transformparameter BinaryTransformParametersFileName: the name of a file that stores
+ * the transform parameter vector as raw little endian doubles, instead of the
+ * TransformParameters entry. A relative name is relative to the directory of the
+ * transform parameter file. The file is memory mapped when it is read.\n
+ * example <tt>(BinaryTransformParametersFileName "TransformParameters.0.raw")</tt>\n
  * \transformparameter NumberOfParameters: the length of the transform parameter vector.\n
  * example <tt>(NumberOfParameters 722)</tt>\n
  * \transformparameter InitialTransformParametersFileName: The location/name of an initial
@@ -186,8 +205,9 @@ public:
     CombinationTransformType::InitialTransformType InitialTransformType;
 
   /** Typedef's from Transform. */
-  typedef typename ITKBaseType::ParametersType ParametersType;
-  typedef typename ParametersType::ValueType   ValueType;
+  typedef typename ITKBaseType::ParametersType   ParametersType;
+  typedef typename ParametersType::ValueType     ValueType;
+  typedef itk::BinaryParametersFile< ValueType > BinaryParametersFileType;
 
   /** Typedef's for TransformPoint. */
   typedef typename ITKBaseType::InputPointType  InputPointType;
@@ -322,6 +342,24 @@ protected:
    */
   void AutomaticScalesEstimation( ScalesType & scales ) const;
 
+  /** Write the parameters as raw little endian values to a binary file.
+   * A relative file name is relative to the transform parameter file.
+   */
+  void WriteBinaryTransformParameters( const ParametersType & param,
+    const std::string & binaryFileName ) const;
+
+  /** Read the parameters from a binary file, by memory mapping it. The
+   * size of param determines the number of parameters that is expected.
+   */
+  void ReadBinaryTransformParameters( const std::string & binaryFileName,
+    ParametersType & param ) const;
+
+  /** Get the number of stream divisions with which a field of the output
+   * size and bytesPerPixel per voxel is written, given the memory budget
+   * FieldStreamingMemoryMB.
+   */
+  unsigned int GetNumberOfStreamDivisions( const std::size_t bytesPerPixel ) const;
+
   /** Member variables. */
   ParametersType * m_TransformParametersPointer;
   std::string      m_TransformParametersFileName;
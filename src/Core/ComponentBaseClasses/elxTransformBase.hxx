@@ -23,6 +23,7 @@
 #include "itkPointSet.h"
 #include "itkDefaultStaticMeshTraits.h"
 #include "itkTransformixInputPointFileReader.h"
+#include "itkTransformixPointTransformer.h"
 #include "vnl/vnl_math.h"
 #include <itksys/SystemTools.hxx>
 #include "itkVector.h"
@@ -403,49 +404,61 @@ TransformBase< TElastix >
     }
     this->m_TransformParametersPointer = new ParametersType( numberOfParameters );
 
-    /** Read the TransformParameters. */
-    std::vector< ValueType > vecPar( numberOfParameters,
-      itk::NumericTraits< ValueType >::ZeroValue() );
-    this->m_Configuration->ReadParameter( vecPar, "TransformParameters",
-      0, numberOfParameters - 1, true );
-
-    /** Sanity check. Are the number of found parameters the same as
-     * the number of specified parameters?
-     * Do not rely on vecPar.size(), since it is unchanged by ReadParameter(),
-     * so we cannot use: numberOfParametersFound = vecPar.size().
-     */
-    const std::size_t numberOfParametersFound
-      = this->m_Configuration->CountNumberOfParameterEntries( "TransformParameters" );
-
-    if( numberOfParametersFound != numberOfParameters )
+    /** Read the TransformParameters from a binary file, if specified. */
+    std::string binaryFileName = "";
+    this->m_Configuration->ReadParameter( binaryFileName,
+      "BinaryTransformParametersFileName", 0, false );
+    if( !binaryFileName.empty() )
     {
-      std::ostringstream makeMessage( "" );
-      makeMessage << "\nERROR: Invalid transform parameter file!\n"
-                  << "The number of parameters in \"TransformParameters\" is "
-                  << numberOfParametersFound
-                  << ", which does not match the number specified in \"NumberOfParameters\" ("
-                  << numberOfParameters << ").\n"
-                  << "The transform parameters should be specified as:\n"
-                  << "  (TransformParameters num num ... num)\n"
-                  << "with " << numberOfParameters << " parameters." << std::endl;
-      itkExceptionMacro( << makeMessage.str().c_str() );
-
-      /** Historical note:
-       * The old way of specifying parameters was
-       *  - for less than 20 parameters:
-       *      (TransformParameters num num ... num)
-       *  - Otherwise:
-       *      // (TransformParameters)
-       *      // num num ... num
-       *
-       * This behavior was deprecated since elastix 4.2, and removed in elastix 4.5.
-       */
+      this->ReadBinaryTransformParameters( binaryFileName,
+        *( this->m_TransformParametersPointer ) );
     }
-
-    /** Copy to m_TransformParametersPointer. */
-    for( unsigned int i = 0; i < numberOfParameters; i++ )
+    else
     {
-      ( *( this->m_TransformParametersPointer ) )[ i ] = vecPar[ i ];
+      /** Read the TransformParameters. */
+      std::vector< ValueType > vecPar( numberOfParameters,
+        itk::NumericTraits< ValueType >::ZeroValue() );
+      this->m_Configuration->ReadParameter( vecPar, "TransformParameters",
+        0, numberOfParameters - 1, true );
+
+      /** Sanity check. Are the number of found parameters the same as
+       * the number of specified parameters?
+       * Do not rely on vecPar.size(), since it is unchanged by ReadParameter(),
+       * so we cannot use: numberOfParametersFound = vecPar.size().
+       */
+      const std::size_t numberOfParametersFound
+        = this->m_Configuration->CountNumberOfParameterEntries( "TransformParameters" );
+
+      if( numberOfParametersFound != numberOfParameters )
+      {
+        std::ostringstream makeMessage( "" );
+        makeMessage << "\nERROR: Invalid transform parameter file!\n"
+                    << "The number of parameters in \"TransformParameters\" is "
+                    << numberOfParametersFound
+                    << ", which does not match the number specified in \"NumberOfParameters\" ("
+                    << numberOfParameters << ").\n"
+                    << "The transform parameters should be specified as:\n"
+                    << "  (TransformParameters num num ... num)\n"
+                    << "with " << numberOfParameters << " parameters." << std::endl;
+        itkExceptionMacro( << makeMessage.str().c_str() );
+
+        /** Historical note:
+         * The old way of specifying parameters was
+         *  - for less than 20 parameters:
+         *      (TransformParameters num num ... num)
+         *  - Otherwise:
+         *      // (TransformParameters)
+         *      // num num ... num
+         *
+         * This behavior was deprecated since elastix 4.2, and removed in elastix 4.5.
+         */
+      }
+
+      /** Copy to m_TransformParametersPointer. */
+      for( unsigned int i = 0; i < numberOfParameters; i++ )
+      {
+        ( *( this->m_TransformParametersPointer ) )[ i ] = vecPar[ i ];
+      }
     }
 
     /** Set the parameters into this transform. */
@@ -678,13 +691,33 @@ TransformBase< TElastix >
   /** Write the parameters of this transform. */
   if( this->m_ReadWriteTransformParameters )
   {
-    /** In this case, write in a normal way to the parameter file. */
-    xout[ "transpar" ] << "(TransformParameters ";
-    for( unsigned int i = 0; i < nrP - 1; i++ )
+    /** Check if the parameters should be written to a binary file. */
+    bool writeBinary = false;
+    this->m_Configuration->ReadParameter( writeBinary,
+      "WriteTransformParametersBinary", 0, false );
+
+    if( writeBinary && nrP > 0 )
     {
-      xout[ "transpar" ] << param[ i ] << " ";
+      /** Store the parameters next to the transform parameter file, and
+       * refer to it by its name only, so that the directory can be moved.
+       */
+      const std::string binaryFileName
+        = itksys::SystemTools::GetFilenameWithoutLastExtension(
+        this->m_TransformParametersFileName ) + ".raw";
+      this->WriteBinaryTransformParameters( param, binaryFileName );
+      xout[ "transpar" ] << "(BinaryTransformParametersFileName \""
+                         << binaryFileName << "\")" << std::endl;
+    }
+    else
+    {
+      /** In this case, write in a normal way to the parameter file. */
+      xout[ "transpar" ] << "(TransformParameters ";
+      for( unsigned int i = 0; i < nrP - 1; i++ )
+      {
+        xout[ "transpar" ] << param[ i ] << " ";
+      }
+      xout[ "transpar" ] << param[ nrP - 1 ] << ")" << std::endl;
     }
-    xout[ "transpar" ] << param[ nrP - 1 ] << ")" << std::endl;
   }
 
   /** Write the name of the parameters-file of the initial transform. */
@@ -1122,12 +1155,8 @@ TransformBase< TElastix >
   typedef typename FixedImageType::SpacingType          FixedImageSpacingType;
   typedef typename FixedImageType::IndexType            FixedImageIndexType;
   typedef typename FixedImageIndexType::IndexValueType  FixedImageIndexValueType;
-  typedef typename MovingImageType::IndexType           MovingImageIndexType;
-  typedef typename MovingImageIndexType::IndexValueType MovingImageIndexValueType;
   typedef
     itk::ContinuousIndex< double, FixedImageDimension >   FixedImageContinuousIndexType;
-  typedef
-    itk::ContinuousIndex< double, MovingImageDimension >  MovingImageContinuousIndexType;
   typedef typename FixedImageType::DirectionType FixedImageDirectionType;
 
   typedef bool DummyIPPPixelType;
@@ -1138,7 +1167,8 @@ TransformBase< TElastix >
     FixedImageDimension, MeshTraitsType >                PointSetType;
   typedef itk::TransformixInputPointFileReader<
     PointSetType >                                      IPPReaderType;
-  typedef itk::Vector< float, FixedImageDimension > DeformationVectorType;
+  typedef itk::TransformixPointTransformer<
+    ITKBaseType, FixedImageType, MovingImageType >      PointTransformerType;
 
   /** Construct an ipp-file reader. */
   typename IPPReaderType::Pointer ippReader = IPPReaderType::New();
@@ -1172,12 +1202,8 @@ TransformBase< TElastix >
   typename PointSetType::Pointer inputPointSet = ippReader->GetOutput();
 
   /** Create the storage classes. */
-  std::vector< FixedImageIndexType >   inputindexvec(  nrofpoints );
-  std::vector< InputPointType >        inputpointvec(  nrofpoints );
-  std::vector< OutputPointType >       outputpointvec( nrofpoints );
-  std::vector< FixedImageIndexType >   outputindexfixedvec( nrofpoints );
-  std::vector< MovingImageIndexType >  outputindexmovingvec( nrofpoints );
-  std::vector< DeformationVectorType > deformationvec( nrofpoints );
+  std::vector< FixedImageIndexType > inputindexvec(  nrofpoints );
+  std::vector< InputPointType >      inputpointvec(  nrofpoints );
 
   /** Make a temporary image with the right region info,
    * which we can use to convert between points and indices.
@@ -1202,16 +1228,7 @@ TransformBase< TElastix >
   dummyImage->SetDirection( direction );
 
   /** Temp vars */
-  FixedImageContinuousIndexType  fixedcindex;
-  MovingImageContinuousIndexType movingcindex;
-
-  /** Also output moving image indices if a moving image was supplied. */
-  bool alsoMovingIndices = false;
-  typename MovingImageType::Pointer movingImage = this->GetElastix()->GetMovingImage();
-  if( movingImage.IsNotNull() )
-  {
-    alsoMovingIndices = true;
-  }
+  FixedImageContinuousIndexType fixedcindex;
 
   /** Read the input points, as index or as point. */
   if( !( ippReader->GetPointsAreIndices() ) )
@@ -1251,97 +1268,27 @@ TransformBase< TElastix >
     }
   }
 
-  /** Apply the transform. */
+  /** Apply the transform, with multiple threads. Also output moving image
+   * indices if a moving image was supplied.
+   */
   elxout << "  The input points are transformed." << std::endl;
-  for( unsigned int j = 0; j < nrofpoints; j++ )
-  {
-    /** Call TransformPoint. */
-    outputpointvec[ j ] = this->GetAsITKBaseType()->TransformPoint( inputpointvec[ j ] );
-
-    /** Transform back to index in fixed image domain. */
-    dummyImage->TransformPhysicalPointToContinuousIndex(
-      outputpointvec[ j ], fixedcindex );
-    for( unsigned int i = 0; i < FixedImageDimension; i++ )
-    {
-      outputindexfixedvec[ j ][ i ] = static_cast< FixedImageIndexValueType >(
-        itk::Math::Round< double >( fixedcindex[ i ] ) );
-    }
-
-    if( alsoMovingIndices )
-    {
-      /** Transform back to index in moving image domain. */
-      movingImage->TransformPhysicalPointToContinuousIndex(
-        outputpointvec[ j ], movingcindex );
-      for( unsigned int i = 0; i < MovingImageDimension; i++ )
-      {
-        outputindexmovingvec[ j ][ i ] = static_cast< MovingImageIndexValueType >(
-          itk::Math::Round< double >( movingcindex[ i ] ) );
-      }
-    }
-
-    /** Compute displacement. */
-    deformationvec[ j ].CastFrom( outputpointvec[ j ] - inputpointvec[ j ] );
-  }
+  typename PointTransformerType::Pointer pointTransformer = PointTransformerType::New();
+  pointTransformer->SetTransform( this->GetAsITKBaseType() );
+  pointTransformer->SetFixedImage( dummyImage );
+  pointTransformer->SetMovingImage( this->GetElastix()->GetMovingImage() );
+  pointTransformer->SetInput( inputpointvec, inputindexvec );
+  pointTransformer->TransformPoints();
 
   /** Create filename and file stream. */
   std::string outputPointsFileName = this->m_Configuration
     ->GetCommandLineArgument( "-out" );
   outputPointsFileName += "outputpoints.txt";
   std::ofstream outputPointsFile( outputPointsFileName.c_str() );
-  outputPointsFile << std::showpoint << std::fixed;
   elxout << "  The transformed points are saved in: "
          <<  outputPointsFileName << std::endl;
 
   /** Print the results. */
-  for( unsigned int j = 0; j < nrofpoints; j++ )
-  {
-    /** The input index. */
-    outputPointsFile << "Point\t" << j << "\t; InputIndex = [ ";
-    for( unsigned int i = 0; i < FixedImageDimension; i++ )
-    {
-      outputPointsFile << inputindexvec[ j ][ i ] << " ";
-    }
-
-    /** The input point. */
-    outputPointsFile << "]\t; InputPoint = [ ";
-    for( unsigned int i = 0; i < FixedImageDimension; i++ )
-    {
-      outputPointsFile << inputpointvec[ j ][ i ] << " ";
-    }
-
-    /** The output index in fixed image. */
-    outputPointsFile << "]\t; OutputIndexFixed = [ ";
-    for( unsigned int i = 0; i < FixedImageDimension; i++ )
-    {
-      outputPointsFile << outputindexfixedvec[ j ][ i ] << " ";
-    }
-
-    /** The output point. */
-    outputPointsFile << "]\t; OutputPoint = [ ";
-    for( unsigned int i = 0; i < FixedImageDimension; i++ )
-    {
-      outputPointsFile << outputpointvec[ j ][ i ] << " ";
-    }
-
-    /** The output point minus the input point. */
-    outputPointsFile << "]\t; Deformation = [ ";
-    for( unsigned int i = 0; i < MovingImageDimension; i++ )
-    {
-      outputPointsFile << deformationvec[ j ][ i ] << " ";
-    }
-
-    if( alsoMovingIndices )
-    {
-      /** The output index in moving image. */
-      outputPointsFile << "]\t; OutputIndexMoving = [ ";
-      for( unsigned int i = 0; i < MovingImageDimension; i++ )
-      {
-        outputPointsFile << outputindexmovingvec[ j ][ i ] << " ";
-      }
-    }
-
-    outputPointsFile << "]" << std::endl;
-  } // end for nrofpoints
+  pointTransformer->WriteOutputPoints( outputPointsFile );
 
 } // end TransformPointsSomePoints()
 
@@ -1503,6 +1450,8 @@ TransformBase< TElastix >
     = DeformationFieldWriterType::New();
   defWriter->SetInput( infoChanger->GetOutput() );
   defWriter->SetFileName( makeFileName.str().c_str() );
+  defWriter->SetNumberOfStreamDivisions(
+    this->GetNumberOfStreamDivisions( sizeof( VectorPixelType ) ) );
 
   /** Do the writing. */
   elxout << "  Computing and writing the deformation field ..." << std::endl;
@@ -1525,6 +1474,24 @@ TransformBase< TElastix >
 } // end TransformPointsAllPoints()
 
 
+/**
+ * ************** GetNumberOfStreamDivisions **********************
+ */
+
+template< class TElastix >
+unsigned int
+TransformBase< TElastix >
+::GetNumberOfStreamDivisions( const std::size_t bytesPerPixel ) const
+{
+  const double numberOfPixels = static_cast< double >(
+    this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetSize()
+    .CalculateProductOfElements() );
+  return this->ComputeNumberOfStreamDivisions( "FieldStreamingMemoryMB",
+    "The field", numberOfPixels, static_cast< double >( bytesPerPixel ) );
+
+} // end GetNumberOfStreamDivisions()
+
+
 /**
  * ************** ComputeDeterminantOfSpatialJacobian **********************
  */
@@ -1606,6 +1573,8 @@ TransformBase< TElastix >
   typename JacobianWriterType::Pointer jacWriter = JacobianWriterType::New();
   jacWriter->SetInput( infoChanger->GetOutput() );
   jacWriter->SetFileName( makeFileName.str().c_str() );
+  jacWriter->SetNumberOfStreamDivisions(
+    this->GetNumberOfStreamDivisions( sizeof( typename JacobianImageType::PixelType ) ) );
 
   /** Do the writing. */
   elxout << "  Computing and writing the spatial Jacobian determinant..." << std::endl;
@@ -1709,6 +1678,8 @@ TransformBase< TElastix >
   typename JacobianWriterType::Pointer jacWriter = JacobianWriterType::New();
   jacWriter->SetInput( infoChanger->GetOutput() );
   jacWriter->SetFileName( makeFileName.str().c_str() );
+  jacWriter->SetNumberOfStreamDivisions(
+    this->GetNumberOfStreamDivisions( sizeof( OutputSpatialJacobianType ) ) );
   /** Hack to change the pixel type to vector. Not necessary for mhd. */
   typename PixelTypeChangeCommandType::Pointer jacStartWriteCommand
     = PixelTypeChangeCommandType::New();
@@ -1738,6 +1709,40 @@ TransformBase< TElastix >
 } // end ComputeSpatialJacobian()
 
 
+/**
+ * ************** WriteBinaryTransformParameters ****************
+ */
+
+template< class TElastix >
+void
+TransformBase< TElastix >
+::WriteBinaryTransformParameters( const ParametersType & param,
+  const std::string & binaryFileName ) const
+{
+  const std::string fullFileName = BinaryParametersFileType::GetPath(
+    binaryFileName, this->m_TransformParametersFileName );
+  BinaryParametersFileType::Write( fullFileName, param.data_block(), param.GetSize() );
+
+} // end WriteBinaryTransformParameters()
+
+
+/**
+ * ************** ReadBinaryTransformParameters ****************
+ */
+
+template< class TElastix >
+void
+TransformBase< TElastix >
+::ReadBinaryTransformParameters( const std::string & binaryFileName,
+  ParametersType & param ) const
+{
+  const std::string fullFileName = BinaryParametersFileType::GetPath(
+    binaryFileName, this->m_Configuration->GetCommandLineArgument( "-tp" ) );
+  BinaryParametersFileType::Read( fullFileName, param.data_block(), param.GetSize() );
+
+} // end ReadBinaryTransformParameters()
+
+
 /**
  * ************** SetTransformParametersFileName ****************
  */
@@ -114,6 +114,18 @@ protected:
   BaseComponentSE();
   virtual ~BaseComponentSE() {}
 
+  /** Get the number of parts in which an image of numberOfPixels voxels,
+   * of bytesPerPixel bytes each, is computed and written, such that a part
+   * fits in the memory budget in MB given by the parameter
+   * memoryBudgetParameterName. A budget of zero, the default, means that
+   * the image is written at once. The image is described as imageDescription
+   * in the message that reports the streaming.
+   */
+  unsigned int ComputeNumberOfStreamDivisions(
+    const std::string & memoryBudgetParameterName,
+    const std::string & imageDescription,
+    const double numberOfPixels, const double bytesPerPixel ) const;
+
   ElastixPointer       m_Elastix;
   ConfigurationPointer m_Configuration;
   RegistrationPointer  m_Registration;
@@ -20,6 +20,11 @@
 #define __elxBaseComponentSE_hxx
 
 #include "elxBaseComponentSE.h"
+#include "elxMacro.h"
+#include "xoutmain.h"
+
+#include <algorithm> // for std::min, std::max
+#include <cmath>
 
 namespace elastix
 {
@@ -93,6 +98,43 @@ BaseComponentSE< TElastix >::SetConfiguration( ConfigurationType * _arg )
 }   // end SetConfiguration
 
 
+/**
+ * ****************** ComputeNumberOfStreamDivisions ********************
+ */
+
+template< class TElastix >
+unsigned int
+BaseComponentSE< TElastix >::ComputeNumberOfStreamDivisions(
+  const std::string & memoryBudgetParameterName,
+  const std::string & imageDescription,
+  const double numberOfPixels, const double bytesPerPixel ) const
+{
+  /** Read the memory budget; zero means that the image is written at once. */
+  double memoryBudgetMB = 0.0;
+  this->m_Configuration->ReadParameter( memoryBudgetMB,
+    memoryBudgetParameterName, 0, false );
+  if( memoryBudgetMB <= 0.0 )
+  {
+    return 1;
+  }
+
+  /** Divide the image in slabs that fit in the budget. */
+  const double imageSizeMB = numberOfPixels * bytesPerPixel / ( 1024.0 * 1024.0 );
+  const double divisions   = std::ceil( imageSizeMB / memoryBudgetMB );
+  const unsigned int numberOfDivisions = static_cast< unsigned int >(
+    std::max( 1.0, std::min( divisions, numberOfPixels ) ) );
+
+  if( numberOfDivisions > 1 )
+  {
+    elxout << "  " << imageDescription << " (" << static_cast< unsigned long >( imageSizeMB )
+           << " MB) is computed and written in " << numberOfDivisions
+           << " parts of at most " << memoryBudgetMB << " MB." << std::endl;
+  }
+  return numberOfDivisions;
+
+} // end ComputeNumberOfStreamDivisions()
+
+
 } // end namespace elastix
 
 #endif // end #ifndef __elxBaseComponentSE_hxx
@@ -220,6 +220,13 @@ ElastixBase::BeforeAllBase( void )
     elxout << "-threads  " << check << std::endl;
   }
 
+  /** Check for appearance of -profile, which enables the phase profiler. */
+  check = this->GetConfiguration()->GetCommandLineArgument( "-profile" );
+  if( check != "" )
+  {
+    elxout << "-profile  " << check << std::endl;
+  }
+
   /** Check the very important UseDirectionCosines parameter. */
   this->m_UseDirectionCosines = true;
   bool retudc = this->GetConfiguration()->ReadParameter( this->m_UseDirectionCosines,
@@ -39,6 +39,7 @@
 #include "elxTransformBase.h"
 
 #include "itkTimeProbe.h"
+#include "itkPhaseProfiler.h"
 
 #include <sstream>
 #include <fstream>
@@ -106,6 +107,12 @@ namespace elastix
  * Ignoring it may easily lead to left/right swaps for example, which could
  * skrew up a (medical) analysis.
  *
+ * The command line argument "-profile true" enables the itk::PhaseProfiler.
+ * The time spent per iteration in the phases of the metric, the image sampler
+ * and the optimizer is then written per resolution to the files
+ * PhaseProfile.<ElastixLevel>.R<Resolution>.json and .csv, next to the
+ * IterationInfo files.
+ *
  * \ingroup Kernel
  */
 
@@ -368,6 +375,11 @@ protected:
 
   std::ofstream m_IterationInfoFile;
 
+  /** Write the PhaseProfiler statistics of the current resolution to
+   * PhaseProfile.<ElastixLevel>.R<Resolution>.json and .csv.
+   */
+  virtual void WritePhaseProfile( void ) const;
+
   /** Used by the callback functions, BeforeEachResolution() etc.).
    * This method calls a function in each component, in the following order:
    * \li Registration
@@ -558,6 +558,10 @@ ElastixTemplate< TFixedImage, TMovingImage >
   this->m_Timer0.Reset();
   this->m_Timer0.Start();
 
+  /** Enable the phase profiler if desired. */
+  itk::PhaseProfiler::SetEnabled(
+    this->GetConfiguration()->GetCommandLineArgument( "-profile" ) == "true" );
+
   /** Call all the BeforeRegistration() functions. */
   this->BeforeRegistrationBase();
   CallInEachComponent( &BaseComponentType::BeforeRegistrationBase );
@@ -637,6 +641,9 @@ ElastixTemplate< TFixedImage, TMovingImage >
   this->m_ResolutionTimer.Reset();
   this->m_ResolutionTimer.Start();
 
+  /** Profile the iterations of this resolution only. */
+  itk::PhaseProfiler::Reset();
+
   /** Start IterationTimer here, to make it possible to measure the time
    * of the first iteration.
    */
@@ -670,6 +677,12 @@ ElastixTemplate< TFixedImage, TMovingImage >
     << " s.\n";
   elxout << std::setprecision( this->GetDefaultOutputPrecision() );
 
+  /** Write the time spent in the phases of the iterations. */
+  if( itk::PhaseProfiler::GetEnabled() )
+  {
+    this->WritePhaseProfile();
+  }
+
   /** Call all the AfterEachResolution() functions. */
   this->AfterEachResolutionBase();
   CallInEachComponent( &BaseComponentType::AfterEachResolutionBase );
@@ -720,9 +733,11 @@ ElastixTemplate< TFixedImage, TMovingImage >
   }
 
   /** Call all the AfterEachIteration() functions. */
+  itk::PhaseProfiler::ScopedProbe probe( "AfterEachIteration" );
   this->AfterEachIterationBase();
   CallInEachComponent( &BaseComponentType::AfterEachIterationBase );
   CallInEachComponent( &BaseComponentType::AfterEachIteration );
+  probe.Stop();
 
   /** Write the iteration number to the table. */
   xout[ "iteration" ][ "1:ItNr" ] << m_IterationCounter;
@@ -730,6 +745,7 @@ ElastixTemplate< TFixedImage, TMovingImage >
   /** Time in this iteration. */
   this->m_IterationTimer.Stop();
   xout[ "iteration" ][ "Time[ms]" ] << this->m_IterationTimer.GetMean() * 1000.0;
+  itk::PhaseProfiler::AddPhaseTime( "Iteration", this->m_IterationTimer.GetMean() );
 
   /** Write the iteration info of this iteration. */
   xout[ "iteration" ].WriteBufferedData();
@@ -1174,6 +1190,43 @@ ElastixTemplate< TFixedImage, TMovingImage >
 } // end OpenIterationInfoFile()
 
 
+/**
+ * ************** WritePhaseProfile *************************
+ *
+ * Write the PhaseProfiler statistics of this resolution to the files
+ * PhaseProfile.<ElastixLevel>.R<Resolution>.json and .csv.
+ */
+
+template< class TFixedImage, class TMovingImage >
+void
+ElastixTemplate< TFixedImage, TMovingImage >
+::WritePhaseProfile( void ) const
+{
+  using namespace xl;
+
+  /** Create the PhaseProfile filename for this resolution, without extension. */
+  std::ostringstream makeFileName( "" );
+  makeFileName << this->m_Configuration->GetCommandLineArgument( "-out" )
+               << "PhaseProfile."
+               << this->m_Configuration->GetElastixLevel()
+               << ".R" << this->GetElxRegistrationBase()->GetAsITKBaseType()->GetCurrentLevel();
+  const std::string baseName = makeFileName.str();
+
+  /** Write the JSON and the CSV summary. */
+  std::ofstream jsonFile( ( baseName + ".json" ).c_str() );
+  std::ofstream csvFile( ( baseName + ".csv" ).c_str() );
+  if( !jsonFile.is_open() || !csvFile.is_open() )
+  {
+    xout[ "error" ] << "ERROR: File \"" << baseName
+                    << ".json\" or \".csv\" could not be opened!" << std::endl;
+    return;
+  }
+  itk::PhaseProfiler::WriteJSON( jsonFile );
+  itk::PhaseProfiler::WriteCSV( csvFile );
+
+} // end WritePhaseProfile()
+
+
 /**
  * ************** GetOriginalFixedImageDirection *********************
  * Determine the original fixed image direction (it might have been
@@ -363,7 +363,9 @@ PrintHelp( void )
   std::cout << "  -t0       parameter file for initial transform\n";
   std::cout << "  -priority set the process priority to high, abovenormal, normal (default),\n"
             << "            belownormal, or idle (Windows only option)\n";
-  std::cout << "  -threads  set the maximum number of threads of elastix\n"
+  std::cout << "  -threads  set the maximum number of threads of elastix\n";
+  std::cout << "  -profile  write the time spent in the phases of each resolution\n"
+            << "            to PhaseProfile.*.json/csv if \"true\"\n"
             << std::endl;
 
   /** The parameter file.*/
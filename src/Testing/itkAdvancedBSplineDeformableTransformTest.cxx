@@ -23,6 +23,7 @@
 #include <ctime>
 #include <fstream>
 #include <iomanip>
+#include <vector>
 
 //-------------------------------------------------------------------------------------
 
@@ -73,6 +74,8 @@ main( int argc, char * argv[] )
   typedef TransformType::InputPointType                InputPointType;
   typedef TransformType::OutputPointType               OutputPointType;
   typedef TransformType::ParametersType                ParametersType;
+  typedef TransformType::DerivativeType                DerivativeType;
+  typedef TransformType::MovingImageGradientType       MovingImageGradientType;
   typedef itk::Image< CoordinateRepresentationType,
     Dimension >                                         InputImageType;
   typedef InputImageType::RegionType    RegionType;
@@ -427,6 +430,53 @@ main( int argc, char * argv[] )
     return 1;
   }
 
+  /** The batched functions should return the same values as the per-point
+   * functions. Include points outside the valid region of the grid.
+   */
+  const unsigned int                        numberOfPoints = 100;
+  std::vector< InputPointType >             inputPoints( numberOfPoints );
+  std::vector< OutputPointType >            outputPoints( numberOfPoints );
+  std::vector< MovingImageGradientType >    gradients( numberOfPoints );
+  std::vector< DerivativeType >             imageJacobians( numberOfPoints, DerivativeType( nonzji ) );
+  std::vector< NonZeroJacobianIndicesType > nzjis( numberOfPoints, NonZeroJacobianIndicesType( nonzji ) );
+  for( unsigned int i = 0; i < numberOfPoints; ++i )
+  {
+    for( unsigned int j = 0; j < Dimension; ++j )
+    {
+      inputPoints[ i ][ j ] = -250.0 + 5.0 * i + 3.0 * j;
+      gradients[ i ][ j ]   = 1.0 + 0.1 * i - 0.3 * j;
+    }
+  }
+  transform->TransformPoints( &inputPoints[ 0 ], &outputPoints[ 0 ], numberOfPoints );
+  transform->EvaluateJacobianWithImageGradientProducts( &inputPoints[ 0 ],
+    &gradients[ 0 ], &imageJacobians[ 0 ], &nzjis[ 0 ], numberOfPoints );
+
+  DerivativeType imageJacobian( nonzji );
+  for( unsigned int i = 0; i < numberOfPoints; ++i )
+  {
+    transform->EvaluateJacobianWithImageGradientProduct(
+      inputPoints[ i ], gradients[ i ], imageJacobian, nzji );
+    if( outputPoints[ i ] != transform->TransformPoint( inputPoints[ i ] ) )
+    {
+      std::cerr << "ERROR: Advanced B-spline TransformPoints() returning incorrect result." << std::endl;
+      return 1;
+    }
+    if( imageJacobians[ i ] != imageJacobian || nzjis[ i ] != nzji )
+    {
+      std::cerr << "ERROR: Advanced B-spline EvaluateJacobianWithImageGradientProducts() "
+                << "returning incorrect result." << std::endl;
+      return 1;
+    }
+  }
+
+  /** The input and output arrays may be the same. */
+  transform->TransformPoints( &inputPoints[ 0 ], &inputPoints[ 0 ], numberOfPoints );
+  if( inputPoints != outputPoints )
+  {
+    std::cerr << "ERROR: Advanced B-spline TransformPoints() returning incorrect result in-place." << std::endl;
+    return 1;
+  }
+
   /** Exercise PrintSelf(). */
   transform->Print( std::cerr );
 
@@ -22,8 +22,10 @@
 // Report timings
 #include "itkTimeProbe.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
+#include <vector>
 
 //-------------------------------------------------------------------------------------
 // Create a class that inherits from the B-spline transform,
@@ -286,6 +288,46 @@ main( int argc, char * argv[] )
   timeProbeNEW.Stop();
   const double newTime = timeProbeNEW.GetMean();
 
+  /** Create a batch of distinct points inside the grid, for TransformPoints(). */
+  std::vector< InputPointType > inputPoints( N );
+  std::vector< OutputPointType > outputPointsScalar( N ), outputPointsVectorized( N );
+  for( unsigned int i = 0; i < N; ++i )
+  {
+    for( unsigned int j = 0; j < Dimension; ++j )
+    {
+      const double fraction = 0.5 + 0.45 * vcl_sin( 1.3 * i + 0.7 * j );
+      inputPoints[ i ][ j ] = gridOrigin[ j ]
+        + ( 1.0 + fraction * ( gridSize[ j ] - 4.0 ) ) * gridSpacing[ j ];
+    }
+  }
+
+  /** Time the batched TransformPoints with the scalar kernel. */
+  itk::TimeProbe timeProbeScalar, timeProbeVectorized;
+  transform->SetUseVectorizedTransformPoint( false );
+  timeProbeScalar.Start();
+  transform->TransformPoints( &inputPoints[ 0 ], &outputPointsScalar[ 0 ], N );
+  timeProbeScalar.Stop();
+  const double scalarTime = timeProbeScalar.GetMean();
+
+  /** Time the batched TransformPoints with the vectorized kernel. */
+  transform->SetUseVectorizedTransformPoint( true );
+  timeProbeVectorized.Start();
+  transform->TransformPoints( &inputPoints[ 0 ], &outputPointsVectorized[ 0 ], N );
+  timeProbeVectorized.Stop();
+  const double vectorizedTime = timeProbeVectorized.GetMean();
+
+  /** Check that both kernels give the same result, up to rounding. */
+  double maxDifference = 0.0;
+  for( unsigned int i = 0; i < N; ++i )
+  {
+    for( unsigned int j = 0; j < Dimension; ++j )
+    {
+      maxDifference = std::max( maxDifference,
+        vcl_abs( outputPointsScalar[ i ][ j ] - outputPointsVectorized[ i ][ j ] ) );
+    }
+    sum += outputPointsVectorized[ i ][ 0 ];
+  }
+
   // Avoid compiler optimizations, so use sum
   std::cerr << sum << std::endl; // works but ugly on screen
   //  volatile double a = sum; // works but gives unused variable warning
@@ -297,6 +339,19 @@ main( int argc, char * argv[] )
   std::cerr << "Time OLD = " << oldTime << " " << timeProbeOLD.GetUnit() << std::endl;
   std::cerr << "Time NEW = " << newTime << " " << timeProbeNEW.GetUnit() << std::endl;
   std::cerr << "Speedup factor = " << oldTime / newTime << std::endl;
+  std::cerr << "TransformPoints scalar     = "
+            << N / scalarTime << " points/" << timeProbeScalar.GetUnit() << std::endl;
+  std::cerr << "TransformPoints vectorized = "
+            << N / vectorizedTime << " points/" << timeProbeVectorized.GetUnit() << std::endl;
+  std::cerr << "Speedup factor = " << scalarTime / vectorizedTime << std::endl;
+  std::cerr << "Maximum difference = " << maxDifference << std::endl;
+
+  if( maxDifference > 1e-10 )
+  {
+    std::cerr << "ERROR: the vectorized TransformPoints differs from the "
+              << "scalar version." << std::endl;
+    return 1;
+  }
 
   /** Return a value. */
   return 0;
@@ -0,0 +1,170 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkBinaryParametersFile.h"
+#include "itkOptimizerParameters.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+/** This test checks the binary transform parameter files of elastix, i.e.
+ * the BinaryParametersFile that TransformBase uses for the
+ * WriteTransformParametersBinary option:
+ * \li GetPath() resolves a relative file name against the directory of the
+ *   transform parameter file, and leaves a full path untouched;
+ * \li Write() stores the values as little endian, whatever the byte order of
+ *   the system;
+ * \li Read() returns exactly the written values;
+ * \li Read() throws an exception when the file has another size than the
+ *   number of parameters implies.
+ */
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  /** Check. */
+  if( argc != 2 )
+  {
+    std::cerr << "ERROR: You should specify an output directory." << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string outputDirectory = argv[ 1 ];
+
+  typedef itk::OptimizerParameters< double >     ParametersType;
+  typedef ParametersType::ValueType              ValueType;
+  typedef itk::BinaryParametersFile< ValueType > BinaryParametersFileType;
+
+  /** Relative names are relative to the transform parameter file. */
+  const std::string tpFileName = outputDirectory + "/TransformParameters.0.txt";
+  const std::string binaryFileName = "TransformParameters.0.raw";
+  const std::string fullFileName = outputDirectory + "/" + binaryFileName;
+  if( BinaryParametersFileType::GetPath( binaryFileName, tpFileName ) != fullFileName
+    || BinaryParametersFileType::GetPath( fullFileName, "other/TransformParameters.0.txt" ) != fullFileName
+    || BinaryParametersFileType::GetPath( binaryFileName, "TransformParameters.0.txt" ) != binaryFileName )
+  {
+    std::cerr << "ERROR: GetPath() resolves \"" << binaryFileName << "\" against \""
+              << tpFileName << "\" as \""
+              << BinaryParametersFileType::GetPath( binaryFileName, tpFileName ) << "\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** Some parameters, including values that are not exactly representable
+   * in text with the default output precision.
+   */
+  const unsigned int numberOfParameters = 7;
+  ParametersType     parameters( numberOfParameters );
+  parameters[ 0 ] = 0.0;
+  parameters[ 1 ] = 1.0;
+  parameters[ 2 ] = -2.5;
+  parameters[ 3 ] = 1.0 / 3.0;
+  parameters[ 4 ] = -1.0e-300;
+  parameters[ 5 ] = 12345.678901234567;
+  parameters[ 6 ] = 3.0e300;
+
+  try
+  {
+    BinaryParametersFileType::Write(
+      BinaryParametersFileType::GetPath( binaryFileName, tpFileName ),
+      parameters.data_block(), parameters.GetSize() );
+  }
+  catch( itk::ExceptionObject & e )
+  {
+    std::cerr << "ERROR: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** The file must contain the bytes of the values, least significant first. */
+  std::ifstream       input( fullFileName.c_str(), std::ios::in | std::ios::binary );
+  std::vector< char > bytes( ( std::istreambuf_iterator< char >( input ) ),
+                             std::istreambuf_iterator< char >() );
+  input.close();
+  if( bytes.size() != numberOfParameters * sizeof( ValueType ) )
+  {
+    std::cerr << "ERROR: the file contains " << bytes.size() << " bytes." << std::endl;
+    return EXIT_FAILURE;
+  }
+  for( unsigned int i = 0; i < numberOfParameters; ++i )
+  {
+    unsigned long long bits = 0;
+    std::memcpy( &bits, &parameters[ i ], sizeof( ValueType ) );
+    for( unsigned int b = 0; b < sizeof( ValueType ); ++b )
+    {
+      const unsigned char expected = static_cast< unsigned char >( ( bits >> ( 8 * b ) ) & 0xff );
+      if( static_cast< unsigned char >( bytes[ i * sizeof( ValueType ) + b ] ) != expected )
+      {
+        std::cerr << "ERROR: byte " << b << " of parameter " << i
+                  << " is not stored in little endian order." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  /** Read the parameters back, via the name relative to the parameter file. */
+  ParametersType readParameters( numberOfParameters );
+  readParameters.Fill( -1.0 );
+  try
+  {
+    BinaryParametersFileType::Read(
+      BinaryParametersFileType::GetPath( binaryFileName, tpFileName ),
+      readParameters.data_block(), readParameters.GetSize() );
+  }
+  catch( itk::ExceptionObject & e )
+  {
+    std::cerr << "ERROR: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+  if( readParameters != parameters )
+  {
+    std::cerr << "ERROR: read " << readParameters
+              << ", while " << parameters << " was written." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** Reading more or fewer parameters than the file contains must fail. */
+  const unsigned int wrongSizes[] = { numberOfParameters - 1, numberOfParameters + 1 };
+  for( unsigned int s = 0; s < 2; ++s )
+  {
+    ParametersType wrongParameters( wrongSizes[ s ] );
+    bool           thrown = false;
+    try
+    {
+      BinaryParametersFileType::Read( fullFileName,
+        wrongParameters.data_block(), wrongParameters.GetSize() );
+    }
+    catch( itk::ExceptionObject & e )
+    {
+      std::cout << "Expected exception for " << wrongSizes[ s ]
+                << " parameters:" << e.GetDescription() << std::endl;
+      thrown = true;
+    }
+    if( !thrown )
+    {
+      std::cerr << "ERROR: reading " << wrongSizes[ s ] << " parameters from a file with "
+                << numberOfParameters << " parameters did not throw an exception." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+
+} // end main
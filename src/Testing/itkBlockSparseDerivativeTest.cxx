@@ -0,0 +1,266 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkBlockSparseDerivative.h"
+#include "MultiMetricMultiResolutionRegistration/itkCombinationImageToImageMetric.h"
+#include "AdvancedMeanSquares/itkAdvancedMeanSquaresImageToImageMetric.h"
+#include "DisplacementMagnitudePenalty/itkDisplacementMagnitudePenaltyTerm.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkImageFullSampler.h"
+#include "itkImageGridSampler.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+/** This test checks the BlockSparseDerivative against a dense derivative,
+ * and checks that a CombinationImageToImageMetric of a mean squares metric
+ * and a displacement magnitude penalty on a few samples gives the same
+ * value and derivative with and without sparse derivatives.
+ */
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int, char *[] )
+{
+  typedef itk::BlockSparseDerivative                SparseDerivativeType;
+  typedef SparseDerivativeType::DenseDerivativeType DenseDerivativeType;
+
+  /** Fill a sparse and a dense derivative with the same elements. The size
+   * is not a multiple of the block size.
+   */
+  const unsigned int   size = 1000;
+  SparseDerivativeType sparse;
+  DenseDerivativeType  dense( size );
+  sparse.SetSize( size );
+  dense.Fill( 0.0 );
+  const unsigned int indices[] = { 3, 5, 130, 998, 999, 64, 3 };
+  for( unsigned int i = 0; i < 7; ++i )
+  {
+    sparse[ indices[ i ] ] += 1.5 + i;
+    dense[ indices[ i ] ]  += 1.5 + i;
+  }
+
+  /** Blocks 0, 1, 2 and 15 are touched. */
+  if( sparse.GetNumberOfBlocks() != 4 )
+  {
+    std::cerr << "ERROR: expected 4 blocks, got " << sparse.GetNumberOfBlocks() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** Compare the elements, the magnitude, AddTo and Add. */
+  sparse *= 2.0;
+  dense  *= 2.0;
+  DenseDerivativeType fromSparse( size );
+  fromSparse.Fill( 1.0 );
+  sparse.AddTo( fromSparse, 0.5 );
+  SparseDerivativeType sum;
+  sum.SetSize( size );
+  sum[ 500 ] = 1.0;
+  sum.Add( sparse, -1.0 );
+  for( unsigned int j = 0; j < size; ++j )
+  {
+    const double expectedSum = ( j == 500 ? 1.0 : 0.0 ) - dense[ j ];
+    if( sparse.GetElement( j ) != dense[ j ]
+      || fromSparse[ j ] != 1.0 + 0.5 * dense[ j ]
+      || sum.GetElement( j ) != expectedSum )
+    {
+      std::cerr << "ERROR: element " << j << " differs from the dense derivative." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if( std::abs( sparse.GetSquaredMagnitude() - dense.squared_magnitude() ) > 1e-12 )
+  {
+    std::cerr << "ERROR: the magnitude differs from the dense derivative." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** Clear keeps the size. */
+  sparse.Clear();
+  if( sparse.GetNumberOfBlocks() != 0 || sparse.GetElement( 130 ) != 0.0 || sparse.GetSize() != size )
+  {
+    std::cerr << "ERROR: Clear() did not reset the derivative." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** Some basic type definitions for the metric test. */
+  const unsigned int Dimension   = 2;
+  const unsigned int SplineOrder = 3;
+  typedef float                                          PixelType;
+  typedef itk::Image< PixelType, Dimension >             ImageType;
+  typedef itk::CombinationImageToImageMetric<
+    ImageType, ImageType >                               CombinationMetricType;
+  typedef itk::AdvancedMeanSquaresImageToImageMetric<
+    ImageType, ImageType >                               MeanSquaresMetricType;
+  typedef itk::DisplacementMagnitudePenaltyTerm<
+    ImageType, double >                                  PenaltyType;
+  typedef itk::AdvancedBSplineDeformableTransform<
+    double, Dimension, SplineOrder >                     TransformType;
+  typedef itk::BSplineInterpolateImageFunction<
+    ImageType, double, double >                          InterpolatorType;
+  typedef itk::ImageFullSampler< ImageType >             FullSamplerType;
+  typedef itk::ImageGridSampler< ImageType >             GridSamplerType;
+  typedef CombinationMetricType::TransformParametersType ParametersType;
+  typedef CombinationMetricType::DerivativeType          DerivativeType;
+  typedef CombinationMetricType::MeasureType             MeasureType;
+
+  /** Create a fixed and a moving image. */
+  ImageType::SizeType imageSize;
+  imageSize.Fill( 40 );
+  ImageType::Pointer fixedImage  = ImageType::New();
+  ImageType::Pointer movingImage = ImageType::New();
+  fixedImage->SetRegions( imageSize );
+  fixedImage->Allocate();
+  movingImage->SetRegions( imageSize );
+  movingImage->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > fit( fixedImage, fixedImage->GetLargestPossibleRegion() );
+  itk::ImageRegionIteratorWithIndex< ImageType > mit( movingImage, movingImage->GetLargestPossibleRegion() );
+  for( fit.GoToBegin(), mit.GoToBegin(); !fit.IsAtEnd(); ++fit, ++mit )
+  {
+    const ImageType::IndexType index = fit.GetIndex();
+    const double               dx    = index[ 0 ] - 19.0;
+    const double               dy    = index[ 1 ] - 21.0;
+    fit.Set( static_cast< PixelType >( 100.0 * std::exp( -( dx * dx + dy * dy ) / 60.0 ) ) );
+    mit.Set( static_cast< PixelType >( 100.0 * std::exp( -( 2.0 * dx * dx + dy * dy ) / 50.0 ) ) );
+  }
+
+  /** Create a fine B-spline transform. */
+  TransformType::Pointer              transform = TransformType::New();
+  TransformType::RegionType::SizeType gridSize;
+  TransformType::SpacingType          gridSpacing;
+  TransformType::OriginType           gridOrigin;
+  gridSize.Fill( 24 );
+  gridSpacing.Fill( 2.0 );
+  gridOrigin.Fill( -4.0 );
+  TransformType::RegionType gridRegion;
+  gridRegion.SetSize( gridSize );
+  transform->SetGridRegion( gridRegion );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridOrigin( gridOrigin );
+
+  ParametersType parameters( transform->GetNumberOfParameters() );
+  for( unsigned int i = 0; i < parameters.GetSize(); ++i )
+  {
+    parameters[ i ] = 0.3 * std::sin( 0.37 * i );
+  }
+  transform->SetParameters( parameters );
+
+  /** Evaluate the combination without and with sparse derivatives. The
+   * penalty only sees a few samples, so it touches few parameters.
+   */
+  MeasureType    value[ 2 ];
+  DerivativeType derivative[ 2 ];
+  for( unsigned int v = 0; v < 2; ++v )
+  {
+    MeanSquaresMetricType::Pointer meanSquares = MeanSquaresMetricType::New();
+    meanSquares->SetImageSampler( FullSamplerType::New() );
+
+    GridSamplerType::Pointer              gridSampler = GridSamplerType::New();
+    GridSamplerType::SampleGridSpacingType samplingGridSpacing;
+    samplingGridSpacing.Fill( 16 );
+    gridSampler->SetSampleGridSpacing( samplingGridSpacing );
+    PenaltyType::Pointer penalty = PenaltyType::New();
+    penalty->SetImageSampler( gridSampler );
+
+    CombinationMetricType::Pointer combo = CombinationMetricType::New();
+    combo->SetNumberOfMetrics( 2 );
+    combo->SetMetric( meanSquares, 0 );
+    combo->SetMetric( penalty, 1 );
+    combo->SetMetricWeight( 1.0, 0 );
+    combo->SetMetricWeight( 100.0, 1 );
+    combo->SetFixedImage( fixedImage );
+    combo->SetMovingImage( movingImage );
+    combo->SetFixedImageRegion( fixedImage->GetLargestPossibleRegion() );
+    combo->SetTransform( transform );
+    combo->SetInterpolator( InterpolatorType::New() );
+    combo->SetUseSparseDerivatives( v == 1 );
+    combo->Initialize();
+
+    combo->GetValueAndDerivative( parameters, value[ v ], derivative[ v ] );
+
+    /** The mean squares metric is dense, so the combination does not
+     * support a sparse derivative itself.
+     */
+    if( combo->GetSupportsSparseDerivative() )
+    {
+      std::cerr << "ERROR: the combination should not support a sparse derivative." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  /** Compare the results. */
+  const double tolerance     = 1e-10;
+  double       maxDifference = 0.0;
+  double       maxDerivative = 0.0;
+  for( unsigned int i = 0; i < derivative[ 0 ].GetSize(); ++i )
+  {
+    maxDifference = std::max( maxDifference, std::abs( derivative[ 0 ][ i ] - derivative[ 1 ][ i ] ) );
+    maxDerivative = std::max( maxDerivative, std::abs( derivative[ 0 ][ i ] ) );
+  }
+  if( maxDerivative == 0.0
+    || std::abs( value[ 0 ] - value[ 1 ] ) > tolerance * std::abs( value[ 0 ] )
+    || maxDifference > tolerance * maxDerivative )
+  {
+    std::cerr << "ERROR: the results with and without sparse derivatives differ." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** The penalty alone returns the same derivative, sparse and dense. */
+  PenaltyType::Pointer                  penalty     = PenaltyType::New();
+  GridSamplerType::Pointer              gridSampler = GridSamplerType::New();
+  GridSamplerType::SampleGridSpacingType samplingGridSpacing;
+  samplingGridSpacing.Fill( 16 );
+  gridSampler->SetSampleGridSpacing( samplingGridSpacing );
+  penalty->SetImageSampler( gridSampler );
+  penalty->SetFixedImage( fixedImage );
+  penalty->SetMovingImage( movingImage );
+  penalty->SetFixedImageRegion( fixedImage->GetLargestPossibleRegion() );
+  penalty->SetTransform( transform );
+  penalty->SetInterpolator( InterpolatorType::New() );
+  penalty->Initialize();
+
+  MeasureType          denseValue  = 0.0;
+  MeasureType          sparseValue = 0.0;
+  DerivativeType       denseDerivative;
+  SparseDerivativeType sparseDerivative;
+  penalty->GetValueAndDerivative( parameters, denseValue, denseDerivative );
+  penalty->GetValueAndSparseDerivative( parameters, sparseValue, sparseDerivative );
+  for( unsigned int j = 0; j < denseDerivative.GetSize(); ++j )
+  {
+    if( denseDerivative[ j ] != sparseDerivative.GetElement( j ) )
+    {
+      std::cerr << "ERROR: the sparse penalty derivative differs at " << j << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if( denseValue != sparseValue
+    || sparseDerivative.GetNumberOfBlocks() * SparseDerivativeType::BlockSize >= denseDerivative.GetSize() )
+  {
+    std::cerr << "ERROR: the sparse penalty derivative is not sparse or has another value." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "The sparse penalty derivative uses " << sparseDerivative.GetNumberOfBlocks()
+            << " blocks for " << denseDerivative.GetSize() << " parameters." << std::endl;
+
+  return EXIT_SUCCESS;
+
+} // end main
@@ -0,0 +1,248 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "CMAEvolutionStrategy/itkCMAEvolutionStrategyOptimizer.h"
+#include "itkCommand.h"
+#include "itkSingleValuedCostFunction.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+/** This test optimizes an analytic, thread-safe cost function with the
+ * CMAEvolutionStrategyOptimizer, once sequentially and once with the
+ * offspring evaluated concurrently on independent cost functions. The
+ * random generator is reseeded before each run, so both runs must follow
+ * exactly the same optimization path. The test also checks that the
+ * optimum is approached and that the number of generations per second
+ * has been measured.
+ */
+
+//-------------------------------------------------------------------------------------
+
+namespace
+{
+
+/** A rotated ellipsoid, f(x) = sum_i w_i ( ( x_i + x_{i+1} ) / 2 - c_i )^2,
+ * with a minimum of zero. The number of parameters is odd, so that the
+ * rotation is not singular. GetValue() does not store anything, so it is
+ * thread-safe.
+ */
+class EllipsoidCostFunction : public itk::SingleValuedCostFunction
+{
+public:
+
+  typedef EllipsoidCostFunction           Self;
+  typedef itk::SingleValuedCostFunction   Superclass;
+  typedef itk::SmartPointer< Self >       Pointer;
+  typedef itk::SmartPointer< const Self > ConstPointer;
+  itkNewMacro( Self );
+  itkTypeMacro( EllipsoidCostFunction, SingleValuedCostFunction );
+
+  typedef Superclass::ParametersType ParametersType;
+  typedef Superclass::DerivativeType DerivativeType;
+  typedef Superclass::MeasureType    MeasureType;
+
+  static const unsigned int NumberOfParameters = 7;
+
+  virtual unsigned int GetNumberOfParameters( void ) const
+  { return NumberOfParameters; }
+
+  virtual MeasureType GetValue( const ParametersType & parameters ) const
+  {
+    MeasureType value = 0.0;
+    for( unsigned int i = 0; i < NumberOfParameters; ++i )
+    {
+      const double y = 0.5 * ( parameters[ i ] + parameters[ ( i + 1 ) % NumberOfParameters ] )
+        - this->GetOptimum( i );
+      value += ( 1.0 + i ) * y * y;
+    }
+    return value;
+  }
+
+
+  virtual void GetDerivative( const ParametersType &, DerivativeType & ) const
+  {
+    itkExceptionMacro( << "The derivative is not used by the optimizer." );
+  }
+
+
+  /** The minimum of the ellipsoid in the rotated coordinates. */
+  static double GetOptimum( const unsigned int i )
+  { return 1.0 + 0.25 * i; }
+
+protected:
+
+  EllipsoidCostFunction() {}
+  virtual ~EllipsoidCostFunction() {}
+
+private:
+
+  EllipsoidCostFunction( const Self & ); // purposely not implemented
+  void operator=( const Self & );        // purposely not implemented
+
+};
+
+typedef itk::CMAEvolutionStrategyOptimizer OptimizerType;
+typedef OptimizerType::ParametersType      ParametersType;
+typedef OptimizerType::MeasureType         MeasureType;
+
+/** Store the value and position of each iteration. */
+class PathObserver : public itk::Command
+{
+public:
+
+  typedef PathObserver              Self;
+  typedef itk::Command              Superclass;
+  typedef itk::SmartPointer< Self > Pointer;
+  itkNewMacro( Self );
+
+  std::vector< MeasureType >    m_Values;
+  std::vector< ParametersType > m_Positions;
+
+  virtual void Execute( itk::Object * caller, const itk::EventObject & event )
+  {
+    this->Execute( const_cast< const itk::Object * >( caller ), event );
+  }
+
+
+  virtual void Execute( const itk::Object * caller, const itk::EventObject & event )
+  {
+    const OptimizerType * optimizer = dynamic_cast< const OptimizerType * >( caller );
+    if( optimizer != 0 && itk::IterationEvent().CheckEvent( &event ) )
+    {
+      this->m_Values.push_back( optimizer->GetCurrentValue() );
+      this->m_Positions.push_back( optimizer->GetCurrentPosition() );
+    }
+  }
+
+protected:
+
+  PathObserver() {}
+  virtual ~PathObserver() {}
+
+};
+
+/** Run the optimizer, sequentially or with three independent cost functions. */
+int
+RunOptimizer( const bool concurrent, PathObserver * observer, double & generationsPerSecond )
+{
+  EllipsoidCostFunction::Pointer costFunction = EllipsoidCostFunction::New();
+  OptimizerType::Pointer         optimizer    = OptimizerType::New();
+  optimizer->SetCostFunction( costFunction );
+  if( concurrent )
+  {
+    OptimizerType::CostFunctionContainerType independentCostFunctions;
+    for( unsigned int i = 0; i < 3; ++i )
+    {
+      independentCostFunctions.push_back( EllipsoidCostFunction::New().GetPointer() );
+    }
+    optimizer->SetIndependentCostFunctions( independentCostFunctions );
+  }
+
+  ParametersType initialPosition( EllipsoidCostFunction::NumberOfParameters );
+  initialPosition.Fill( 0.0 );
+  optimizer->SetInitialPosition( initialPosition );
+  optimizer->SetMaximumNumberOfIterations( 300 );
+  optimizer->SetPopulationSize( 12 );
+  optimizer->SetInitialSigma( 1.0 );
+  optimizer->AddObserver( itk::IterationEvent(), observer );
+
+  /** Both runs must draw the same random numbers. */
+  itk::Statistics::MersenneTwisterRandomVariateGenerator::GetInstance()->SetSeed( 1234 );
+
+  try
+  {
+    optimizer->StartOptimization();
+  }
+  catch( itk::ExceptionObject & e )
+  {
+    std::cerr << "ERROR: " << e << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  generationsPerSecond = optimizer->GetGenerationsPerSecond();
+  std::cout << ( concurrent ? "concurrent" : "sequential" ) << ": "
+            << optimizer->GetCurrentIteration() << " iterations, value "
+            << optimizer->GetCurrentValue() << ", "
+            << generationsPerSecond << " generations per second" << std::endl;
+
+  return EXIT_SUCCESS;
+
+} // end RunOptimizer()
+
+
+} // end namespace
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int, char *[] )
+{
+  PathObserver::Pointer observers[ 2 ];
+  double                generationsPerSecond[ 2 ];
+  for( unsigned int v = 0; v < 2; ++v )
+  {
+    observers[ v ] = PathObserver::New();
+    if( RunOptimizer( v == 1, observers[ v ], generationsPerSecond[ v ] ) != EXIT_SUCCESS )
+    {
+      return EXIT_FAILURE;
+    }
+    if( !( generationsPerSecond[ v ] > 0.0 ) )
+    {
+      std::cerr << "ERROR: the number of generations per second has not been measured." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  /** The concurrent evaluation must follow the sequential path exactly. */
+  const std::vector< MeasureType > &    values    = observers[ 0 ]->m_Values;
+  const std::vector< ParametersType > & positions = observers[ 0 ]->m_Positions;
+  if( values.empty() || values.size() != observers[ 1 ]->m_Values.size() )
+  {
+    std::cerr << "ERROR: the number of iterations differs: " << values.size()
+              << " and " << observers[ 1 ]->m_Values.size() << "." << std::endl;
+    return EXIT_FAILURE;
+  }
+  for( unsigned int it = 0; it < values.size(); ++it )
+  {
+    if( values[ it ] != observers[ 1 ]->m_Values[ it ]
+      || positions[ it ] != observers[ 1 ]->m_Positions[ it ] )
+    {
+      std::cerr << "ERROR: the concurrent path differs from the sequential path at iteration "
+                << it << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  /** The optimum must have been approached. */
+  const ParametersType & finalPosition = positions.back();
+  for( unsigned int i = 0; i < EllipsoidCostFunction::NumberOfParameters; ++i )
+  {
+    const double y = 0.5 * ( finalPosition[ i ]
+      + finalPosition[ ( i + 1 ) % EllipsoidCostFunction::NumberOfParameters ] );
+    if( std::abs( y - EllipsoidCostFunction::GetOptimum( i ) ) > 1e-3 )
+    {
+      std::cerr << "ERROR: the optimum has not been found: " << finalPosition << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+
+} // end main
@@ -0,0 +1,254 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "MultiMetricMultiResolutionRegistration/itkCombinationImageToImageMetric.h"
+#include "AdvancedMeanSquares/itkAdvancedMeanSquaresImageToImageMetric.h"
+#include "AdvancedNormalizedCorrelation/itkAdvancedNormalizedCorrelationImageToImageMetric.h"
+#include "BendingEnergyPenalty/itkTransformBendingEnergyPenaltyTerm.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkImageFullSampler.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+/** This test evaluates a CombinationImageToImageMetric of three sub metrics
+ * many times with concurrent sub metric evaluation, and compares every
+ * result with a serial evaluation of the same combination. It uses two
+ * threads (so that one thread evaluates two metrics) and four threads (so
+ * that the threads are divided over the metrics). Between the evaluations
+ * GetValue() is called, which checks that the sub metrics use the current
+ * parameters again after a concurrent evaluation. A third variant lets the
+ * sub metrics share one image sampler that also writes the structure of
+ * arrays samples, which are then read by the concurrent sub metrics.
+ *
+ * The test does not depend on timing, so it may be run under a thread
+ * sanitizer. The number of iterations can be passed as the first argument.
+ */
+
+//-------------------------------------------------------------------------------------
+
+namespace
+{
+
+const unsigned int Dimension   = 2;
+const unsigned int SplineOrder = 3;
+typedef float                                          PixelType;
+typedef itk::Image< PixelType, Dimension >             ImageType;
+typedef itk::CombinationImageToImageMetric<
+  ImageType, ImageType >                               CombinationMetricType;
+typedef itk::AdvancedMeanSquaresImageToImageMetric<
+  ImageType, ImageType >                               MeanSquaresMetricType;
+typedef itk::AdvancedNormalizedCorrelationImageToImageMetric<
+  ImageType, ImageType >                               CorrelationMetricType;
+typedef itk::TransformBendingEnergyPenaltyTerm<
+  ImageType, double >                                  BendingEnergyMetricType;
+typedef itk::AdvancedBSplineDeformableTransform<
+  double, Dimension, SplineOrder >                     TransformType;
+typedef itk::BSplineInterpolateImageFunction<
+  ImageType, double, double >                          InterpolatorType;
+typedef itk::ImageFullSampler< ImageType >             SamplerType;
+typedef CombinationMetricType::TransformParametersType ParametersType;
+typedef CombinationMetricType::DerivativeType          DerivativeType;
+typedef CombinationMetricType::MeasureType             MeasureType;
+
+/** Create a combination of three sub metrics that share the transform, and
+ * optionally one image sampler with structure of arrays samples.
+ */
+CombinationMetricType::Pointer
+CreateCombinationMetric( ImageType * fixedImage, ImageType * movingImage,
+  TransformType * transform, const unsigned int numberOfThreads, const bool useMultiThread,
+  const bool shareSampler )
+{
+  CombinationMetricType::Pointer combo = CombinationMetricType::New();
+  combo->SetNumberOfMetrics( 3 );
+
+  SamplerType::Pointer sharedSampler = SamplerType::New();
+
+  MeanSquaresMetricType::Pointer metric0 = MeanSquaresMetricType::New();
+  metric0->SetImageSampler( shareSampler ? sharedSampler : SamplerType::New() );
+  metric0->SetUseStructureOfArraysSamples( shareSampler );
+  combo->SetMetric( metric0, 0 );
+
+  CorrelationMetricType::Pointer metric1 = CorrelationMetricType::New();
+  metric1->SetImageSampler( shareSampler ? sharedSampler : SamplerType::New() );
+  metric1->SetUseStructureOfArraysSamples( shareSampler );
+  combo->SetMetric( metric1, 1 );
+
+  BendingEnergyMetricType::Pointer metric2 = BendingEnergyMetricType::New();
+  metric2->SetImageSampler( shareSampler ? sharedSampler : SamplerType::New() );
+  metric2->SetUseStructureOfArraysSamples( shareSampler );
+  combo->SetMetric( metric2, 2 );
+
+  combo->SetMetricWeight( 1.0, 0 );
+  combo->SetMetricWeight( 10.0, 1 );
+  combo->SetMetricWeight( 0.1, 2 );
+
+  combo->SetFixedImage( fixedImage );
+  combo->SetMovingImage( movingImage );
+  combo->SetFixedImageRegion( fixedImage->GetLargestPossibleRegion() );
+  combo->SetTransform( transform );
+  combo->SetInterpolator( InterpolatorType::New() );
+  combo->SetNumberOfThreads( numberOfThreads );
+  combo->SetUseMultiThread( useMultiThread );
+  combo->Initialize();
+
+  return combo;
+
+} // end CreateCombinationMetric()
+
+
+/** Check that two results are equal, up to the order of summation. */
+bool
+Compare( const MeasureType value0, const DerivativeType & derivative0,
+  const MeasureType value1, const DerivativeType & derivative1 )
+{
+  const double tolerance     = 1e-10;
+  double       maxDifference = 0.0;
+  double       maxDerivative = 0.0;
+  if( derivative0.GetSize() != derivative1.GetSize() )
+  {
+    return false;
+  }
+  for( unsigned int i = 0; i < derivative0.GetSize(); ++i )
+  {
+    maxDifference = std::max( maxDifference, std::abs( derivative0[ i ] - derivative1[ i ] ) );
+    maxDerivative = std::max( maxDerivative, std::abs( derivative0[ i ] ) );
+  }
+
+  return maxDerivative > 0.0
+         && std::abs( value0 - value1 ) <= tolerance * std::abs( value0 )
+         && maxDifference <= tolerance * maxDerivative;
+
+} // end Compare()
+
+
+} // end namespace
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  unsigned int numberOfIterations = 2000;
+  if( argc > 1 )
+  {
+    numberOfIterations = static_cast< unsigned int >( std::atoi( argv[ 1 ] ) );
+  }
+
+  /** Create a fixed and a moving image. */
+  ImageType::SizeType size;
+  size.Fill( 24 );
+  ImageType::Pointer fixedImage  = ImageType::New();
+  ImageType::Pointer movingImage = ImageType::New();
+  fixedImage->SetRegions( size );
+  fixedImage->Allocate();
+  movingImage->SetRegions( size );
+  movingImage->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > fit( fixedImage, fixedImage->GetLargestPossibleRegion() );
+  itk::ImageRegionIteratorWithIndex< ImageType > mit( movingImage, movingImage->GetLargestPossibleRegion() );
+  for( fit.GoToBegin(), mit.GoToBegin(); !fit.IsAtEnd(); ++fit, ++mit )
+  {
+    const ImageType::IndexType index = fit.GetIndex();
+    const double               dx    = index[ 0 ] - 11.0;
+    const double               dy    = index[ 1 ] - 13.0;
+    fit.Set( static_cast< PixelType >( 100.0 * std::exp( -( dx * dx + dy * dy ) / 30.0 ) ) );
+    mit.Set( static_cast< PixelType >( 100.0 * std::exp( -( dx * dx + 2.0 * dy * dy ) / 25.0 ) ) );
+  }
+
+  /** Create a B-spline transform. */
+  TransformType::Pointer              transform = TransformType::New();
+  TransformType::RegionType::SizeType gridSize;
+  TransformType::SpacingType          gridSpacing;
+  TransformType::OriginType           gridOrigin;
+  gridSize.Fill( 7 );
+  gridSpacing.Fill( 6.0 );
+  gridOrigin.Fill( -6.0 );
+  TransformType::RegionType gridRegion;
+  gridRegion.SetSize( gridSize );
+  transform->SetGridRegion( gridRegion );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridOrigin( gridOrigin );
+
+  ParametersType baseParameters( transform->GetNumberOfParameters() );
+  for( unsigned int i = 0; i < baseParameters.GetSize(); ++i )
+  {
+    baseParameters[ i ] = 0.8 * std::sin( 0.41 * i );
+  }
+  transform->SetParameters( baseParameters );
+
+  /** The serial reference and the concurrent variants. */
+  CombinationMetricType::Pointer reference
+    = CreateCombinationMetric( fixedImage, movingImage, transform, 4, false, false );
+  const unsigned int             numberOfThreads[] = { 2, 4, 4 };
+  const bool                     shareSampler[]    = { false, false, true };
+  const unsigned int             numberOfVariants  = 3;
+  CombinationMetricType::Pointer variants[ numberOfVariants ];
+  for( unsigned int v = 0; v < numberOfVariants; ++v )
+  {
+    variants[ v ] = CreateCombinationMetric( fixedImage, movingImage, transform,
+      numberOfThreads[ v ], true, shareSampler[ v ] );
+  }
+
+  /** Evaluate all variants for a changing set of parameters. */
+  for( unsigned int it = 0; it < numberOfIterations; ++it )
+  {
+    const ParametersType parameters     = baseParameters * ( 1.0 + 0.05 * ( it % 7 ) );
+    const ParametersType nextParameters = baseParameters * ( 1.0 + 0.05 * ( ( it + 1 ) % 7 ) );
+
+    MeasureType    referenceValue = 0.0;
+    DerivativeType referenceDerivative;
+    reference->GetValueAndDerivative( parameters, referenceValue, referenceDerivative );
+    const MeasureType referenceNextValue = reference->GetValue( nextParameters );
+
+    for( unsigned int v = 0; v < numberOfVariants; ++v )
+    {
+      MeasureType    value     = 0.0;
+      MeasureType    nextValue = 0.0;
+      DerivativeType derivative;
+      try
+      {
+        variants[ v ]->GetValueAndDerivative( parameters, value, derivative );
+        nextValue = variants[ v ]->GetValue( nextParameters );
+      }
+      catch( itk::ExceptionObject & e )
+      {
+        std::cerr << "ERROR: iteration " << it << ", variant " << v << ": " << e << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      if( !Compare( referenceValue, referenceDerivative, value, derivative )
+        || std::abs( referenceNextValue - nextValue ) > 1e-10 * std::abs( referenceNextValue ) )
+      {
+        std::cerr << "ERROR: iteration " << it << ": the concurrent evaluation with "
+                  << numberOfThreads[ v ] << " threads"
+                  << ( shareSampler[ v ] ? " and a shared sampler" : "" )
+                  << " differs from the serial evaluation." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  std::cout << "Evaluated " << numberOfIterations << " iterations of "
+            << numberOfVariants << " concurrent variants." << std::endl;
+
+  return EXIT_SUCCESS;
+
+} // end main
@@ -0,0 +1,146 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "AdaptiveStochasticGradientDescent/itkComputeJacobianTerms.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkImage.h"
+#include "itkTimeProbe.h"
+
+#include <cmath>
+#include <iostream>
+
+/** This test checks that the multi-threaded ComputeJacobianTerms, which
+ * accumulates the covariance per thread (ThreadedComputeCovariance), merges
+ * the rows in parallel (ThreadedMergeCovariance) and computes the maxima per
+ * thread (ThreadedComputeMaxJacobianTerms), gives the same TrC, TrCC, maxJJ
+ * and maxJCJ as the single-threaded computation, for a B-spline transform,
+ * with and without scales. The threads sum in another order, so the results
+ * should be equal up to rounding. It also prints the time of both.
+ */
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  /** Some basic type definitions. */
+  const unsigned int Dimension   = 3;
+  const unsigned int SplineOrder = 3;
+  typedef float                                       PixelType;
+  typedef itk::Image< PixelType, Dimension >          ImageType;
+  typedef itk::AdvancedBSplineDeformableTransform<
+    double, Dimension, SplineOrder >                  TransformType;
+  typedef itk::ComputeJacobianTerms<
+    ImageType, TransformType >                        ComputeJacobianTermsType;
+  typedef ComputeJacobianTermsType::ScalesType        ScalesType;
+  typedef TransformType::ParametersType               ParametersType;
+
+  /** Create a fixed image, of which only the geometry is used. */
+  ImageType::SizeType size;
+  size.Fill( 30 );
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  image->FillBuffer( 0.0f );
+
+  /** Create a B-spline transform with some deformation. */
+  TransformType::Pointer              transform = TransformType::New();
+  TransformType::RegionType::SizeType gridSize;
+  TransformType::SpacingType          gridSpacing;
+  TransformType::OriginType           gridOrigin;
+  gridSize.Fill( 12 );
+  gridSpacing.Fill( 4.0 );
+  gridOrigin.Fill( -6.0 );
+  TransformType::RegionType gridRegion;
+  gridRegion.SetSize( gridSize );
+  transform->SetGridRegion( gridRegion );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridOrigin( gridOrigin );
+
+  const unsigned int numberOfParameters = transform->GetNumberOfParameters();
+  ParametersType     parameters( numberOfParameters );
+  ScalesType         scales( numberOfParameters );
+  for( unsigned int i = 0; i < numberOfParameters; ++i )
+  {
+    parameters[ i ] = 0.8 * std::sin( 0.37 * i ) + 0.3 * std::cos( 1.3 * i );
+    scales[ i ]     = 1.0 + 0.25 * ( i % 7 );
+  }
+  transform->SetParameters( parameters );
+
+  /** The settings of the variants to test: with and without scales.
+   * For each setting the single-threaded version is the reference.
+   */
+  const bool         useScales[]      = { false, true };
+  const char *       names[]          = { "without scales", "with scales" };
+  const unsigned int numberOfSettings = 2;
+
+  for( unsigned int s = 0; s < numberOfSettings; ++s )
+  {
+    double terms[ 2 ][ 4 ];
+    for( unsigned int v = 0; v < 2; ++v )
+    {
+      ComputeJacobianTermsType::Pointer computeJacobianTerms = ComputeJacobianTermsType::New();
+      computeJacobianTerms->SetFixedImage( image );
+      computeJacobianTerms->SetFixedImageRegion( image->GetLargestPossibleRegion() );
+      computeJacobianTerms->SetTransform( transform );
+      computeJacobianTerms->SetMaxBandCovSize( 192 );
+      computeJacobianTerms->SetNumberOfBandStructureSamples( 10 );
+      computeJacobianTerms->SetNumberOfJacobianMeasurements( 5000 );
+      computeJacobianTerms->SetUseScales( useScales[ s ] );
+      computeJacobianTerms->SetScales( scales );
+      computeJacobianTerms->SetUseMultiThread( v == 1 );
+      computeJacobianTerms->SetNumberOfThreads( 4 );
+
+      itk::TimeProbe timer;
+      timer.Start();
+      try
+      {
+        computeJacobianTerms->ComputeParameters(
+          terms[ v ][ 0 ], terms[ v ][ 1 ], terms[ v ][ 2 ], terms[ v ][ 3 ] );
+      }
+      catch( itk::ExceptionObject & e )
+      {
+        std::cerr << "ERROR: " << e << std::endl;
+        return EXIT_FAILURE;
+      }
+      timer.Stop();
+
+      std::cout << names[ s ] << ( v == 1 ? ", multi-threaded" : ", single-threaded" )
+                << ": TrC " << terms[ v ][ 0 ] << ", TrCC " << terms[ v ][ 1 ]
+                << ", maxJJ " << terms[ v ][ 2 ] << ", maxJCJ " << terms[ v ][ 3 ]
+                << ", time " << timer.GetMean() << " s" << std::endl;
+    }
+
+    /** Compare the four terms. */
+    const double tolerance   = 1e-10;
+    const char * termNames[] = { "TrC", "TrCC", "maxJJ", "maxJCJ" };
+    for( unsigned int j = 0; j < 4; ++j )
+    {
+      if( !( terms[ 0 ][ j ] > 0.0 )
+        || std::abs( terms[ 0 ][ j ] - terms[ 1 ][ j ] ) > tolerance * terms[ 0 ][ j ] )
+      {
+        std::cerr << "ERROR: the multi-threaded " << termNames[ j ] << " differs for the setting "
+                  << names[ s ] << ": " << terms[ 1 ][ j ] << " instead of "
+                  << terms[ 0 ][ j ] << "." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+
+} // end main
@@ -0,0 +1,226 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "GradientDifference/itkGradientDifferenceImageToImageMetric2.h"
+#include "NormalizedGradientCorrelation/itkNormalizedGradientCorrelationImageToImageMetric.h"
+#include "PatternIntensity/itkPatternIntensityImageToImageMetric.h"
+#include "itkAdvancedEuler3DTransform.h"
+#include "itkAdvancedRayCastInterpolateImageFunction.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkResampleImageFilter.h"
+#include "itkTimeProbe.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+/** This test compares the speed of the central and forward difference
+ * derivatives of the 2D-3D metrics GradientDifference,
+ * NormalizedGradientCorrelation and PatternIntensity. Every evaluation of
+ * these metrics renders a DRR, so the forward differences, which reuse the
+ * DRR at the current parameters, need P + 1 instead of 2P + 1 renders per
+ * GetValueAndDerivative(). The test prints the iterations per second of
+ * both modes, and checks that the results are finite and that the value is
+ * not changed by the derivative mode.
+ */
+
+const unsigned int Dimension = 3;
+typedef float                                   PixelType;
+typedef itk::Image< PixelType, Dimension >      ImageType;
+typedef itk::AdvancedEuler3DTransform< double > TransformType;
+typedef itk::AdvancedRayCastInterpolateImageFunction<
+  ImageType, double >                           RayCasterType;
+
+//-------------------------------------------------------------------------------------
+
+/** Time GetValueAndDerivative() of a metric in both derivative modes. */
+
+template< class TMetric >
+bool
+TimeMetric( const char * name, ImageType * fixedImage, ImageType * movingImage,
+  TransformType * transform, RayCasterType * rayCaster,
+  const typename TMetric::TransformParametersType & parameters,
+  const unsigned int iterations )
+{
+  typedef typename TMetric::MeasureType    MeasureType;
+  typedef typename TMetric::DerivativeType DerivativeType;
+  typedef typename TMetric::ScalesType     ScalesType;
+
+  ScalesType scales( transform->GetNumberOfParameters() );
+  scales.Fill( 1.0 );
+
+  double         iterationsPerSecond[ 2 ];
+  MeasureType    value[ 2 ];
+  DerivativeType derivative[ 2 ];
+  for( unsigned int forward = 0; forward < 2; ++forward )
+  {
+    typename TMetric::Pointer metric = TMetric::New();
+    metric->SetFixedImage( fixedImage );
+    metric->SetMovingImage( movingImage );
+    metric->SetFixedImageRegion( fixedImage->GetLargestPossibleRegion() );
+    metric->SetTransform( transform );
+    metric->SetInterpolator( rayCaster );
+    metric->SetScales( scales );
+    metric->SetUseForwardDifferences( forward == 1 );
+    metric->Initialize();
+
+    itk::TimeProbe timer;
+    timer.Start();
+    for( unsigned int i = 0; i < iterations; ++i )
+    {
+      metric->GetValueAndDerivative( parameters, value[ forward ], derivative[ forward ] );
+    }
+    timer.Stop();
+    iterationsPerSecond[ forward ] = iterations / timer.GetMean();
+
+    /** The value should not depend on the derivative mode. */
+    const MeasureType plainValue = metric->GetValue( parameters );
+    if( std::abs( plainValue - value[ forward ] ) > 1e-8 * ( 1.0 + std::abs( plainValue ) ) )
+    {
+      std::cerr << "ERROR: " << name << " returns a different value from "
+                << "GetValueAndDerivative() than from GetValue()." << std::endl;
+      return false;
+    }
+  }
+
+  for( unsigned int forward = 0; forward < 2; ++forward )
+  {
+    bool isFinite = vnl_math_isfinite( value[ forward ] );
+    for( unsigned int i = 0; i < derivative[ forward ].GetSize(); ++i )
+    {
+      isFinite &= vnl_math_isfinite( derivative[ forward ][ i ] );
+    }
+    if( !isFinite )
+    {
+      std::cerr << "ERROR: " << name << " returns a non-finite result." << std::endl;
+      return false;
+    }
+  }
+
+  std::cout << std::setw( 32 ) << std::left << name
+            << std::fixed << std::setprecision( 2 )
+            << " central: " << std::setw( 8 ) << iterationsPerSecond[ 0 ] << " it/s"
+            << "   forward: " << std::setw( 8 ) << iterationsPerSecond[ 1 ] << " it/s"
+            << "   speedup: " << iterationsPerSecond[ 1 ] / iterationsPerSecond[ 0 ]
+            << std::endl;
+  std::cout << std::setw( 32 ) << "" << " central derivative: " << derivative[ 0 ] << std::endl;
+  std::cout << std::setw( 32 ) << "" << " forward derivative: " << derivative[ 1 ] << std::endl;
+
+  return true;
+
+} // end TimeMetric()
+
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  typedef itk::ResampleImageFilter< ImageType, ImageType > ResamplerType;
+  typedef TransformType::ParametersType                    ParametersType;
+  typedef itk::GradientDifferenceImageToImageMetric<
+    ImageType, ImageType >                                 GDMetricType;
+  typedef itk::NormalizedGradientCorrelationImageToImageMetric<
+    ImageType, ImageType >                                 NGCMetricType;
+  typedef itk::PatternIntensityImageToImageMetric<
+    ImageType, ImageType >                                 PIMetricType;
+
+  /** The number of GetValueAndDerivative() calls to time. */
+  unsigned int iterations = 5;
+  if( argc > 1 )
+  {
+    iterations = atoi( argv[ 1 ] );
+  }
+
+  /** Create a volume with two blobs, centred around the origin. */
+  ImageType::SizeType    volumeSize;
+  ImageType::PointType   volumeOrigin;
+  ImageType::SpacingType volumeSpacing;
+  volumeSize.Fill( 48 );
+  volumeOrigin.Fill( -23.5 );
+  volumeSpacing.Fill( 1.0 );
+  ImageType::Pointer volume = ImageType::New();
+  volume->SetRegions( volumeSize );
+  volume->SetOrigin( volumeOrigin );
+  volume->SetSpacing( volumeSpacing );
+  volume->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( volume, volume->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    ImageType::PointType point;
+    volume->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+    const double r1 = ( point[ 0 ] - 5.0 ) * ( point[ 0 ] - 5.0 )
+      + point[ 1 ] * point[ 1 ] + ( point[ 2 ] + 3.0 ) * ( point[ 2 ] + 3.0 );
+    const double r2 = ( point[ 0 ] + 8.0 ) * ( point[ 0 ] + 8.0 )
+      + ( point[ 1 ] - 6.0 ) * ( point[ 1 ] - 6.0 ) + point[ 2 ] * point[ 2 ];
+    it.Set( static_cast< PixelType >( 100.0 * std::exp( -r1 / 40.0 ) + 60.0 * std::exp( -r2 / 20.0 ) ) );
+  }
+
+  /** The DRR plane is a single slice behind the volume, the source in front. */
+  ImageType::SizeType    drrSize;
+  ImageType::PointType   drrOrigin;
+  ImageType::SpacingType drrSpacing;
+  drrSize[ 0 ]   = 64; drrSize[ 1 ] = 64; drrSize[ 2 ] = 1;
+  drrOrigin[ 0 ] = -47.25; drrOrigin[ 1 ] = -47.25; drrOrigin[ 2 ] = -100.0;
+  drrSpacing.Fill( 1.5 );
+
+  TransformType::Pointer transform = TransformType::New();
+  TransformType::InputPointType center;
+  center.Fill( 0.0 );
+  transform->SetCenter( center );
+
+  RayCasterType::Pointer        rayCaster = RayCasterType::New();
+  RayCasterType::InputPointType focalPoint;
+  focalPoint[ 0 ] = 0.0; focalPoint[ 1 ] = 0.0; focalPoint[ 2 ] = 400.0;
+  rayCaster->SetTransform( transform );
+  rayCaster->SetFocalPoint( focalPoint );
+  rayCaster->SetThreshold( 0.0 );
+
+  /** Render the fixed image at the identity transform. */
+  ResamplerType::Pointer resampler = ResamplerType::New();
+  resampler->SetInput( volume );
+  resampler->SetTransform( transform );
+  resampler->SetInterpolator( rayCaster );
+  resampler->SetSize( drrSize );
+  resampler->SetOutputOrigin( drrOrigin );
+  resampler->SetOutputSpacing( drrSpacing );
+  resampler->SetDefaultPixelValue( 0 );
+  resampler->Update();
+  ImageType::Pointer drr = resampler->GetOutput();
+  drr->DisconnectPipeline();
+
+  /** Evaluate the metrics at a slightly misaligned pose. */
+  ParametersType parameters( transform->GetNumberOfParameters() );
+  parameters.Fill( 0.0 );
+  parameters[ 0 ] = 0.02; parameters[ 1 ] = -0.01; parameters[ 2 ] = 0.03;
+  parameters[ 3 ] = 1.5;  parameters[ 4 ] = -1.0;  parameters[ 5 ] = 0.5;
+
+  std::cout << "Timing " << iterations << " GetValueAndDerivative() calls of "
+            << drrSize[ 0 ] << "x" << drrSize[ 1 ] << " DRRs." << std::endl;
+
+  bool success = true;
+  success &= TimeMetric< GDMetricType >( "GradientDifference",
+    drr, volume, transform, rayCaster, parameters, iterations );
+  success &= TimeMetric< NGCMetricType >( "NormalizedGradientCorrelation",
+    drr, volume, transform, rayCaster, parameters, iterations );
+  success &= TimeMetric< PIMetricType >( "PatternIntensity",
+    drr, volume, transform, rayCaster, parameters, iterations );
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+
+} // end main
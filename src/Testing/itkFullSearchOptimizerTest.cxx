@@ -0,0 +1,288 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "FullSearch/itkFullSearchOptimizer.h"
+#include "itkCommand.h"
+#include "itkSingleValuedCostFunction.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+/** This test checks the FullSearchOptimizer:
+ * \li PointNumberToIndex() and IndexToPointNumber() are each other's
+ *   inverse, and a full search visits the points in the order of their
+ *   point numbers;
+ * \li a coarse-to-fine search finds the optimum of an analytic function,
+ *   with fewer evaluations than the full search;
+ * \li the concurrent evaluation with independent cost functions reports the
+ *   same points and values, in the same order, as the sequential evaluation,
+ *   so that the optimization surface is filled in the same way.
+ */
+
+//-------------------------------------------------------------------------------------
+
+namespace
+{
+
+/** A separable quadratic function of four parameters, of which the third is
+ * not searched. GetValue() does not store anything, so it is thread-safe.
+ */
+class QuadraticCostFunction : public itk::SingleValuedCostFunction
+{
+public:
+
+  typedef QuadraticCostFunction           Self;
+  typedef itk::SingleValuedCostFunction   Superclass;
+  typedef itk::SmartPointer< Self >       Pointer;
+  typedef itk::SmartPointer< const Self > ConstPointer;
+  itkNewMacro( Self );
+  itkTypeMacro( QuadraticCostFunction, SingleValuedCostFunction );
+
+  typedef Superclass::ParametersType ParametersType;
+  typedef Superclass::DerivativeType DerivativeType;
+  typedef Superclass::MeasureType    MeasureType;
+
+  virtual unsigned int GetNumberOfParameters( void ) const
+  { return 4; }
+
+  virtual MeasureType GetValue( const ParametersType & parameters ) const
+  {
+    const double d0 = parameters[ 0 ] - 0.75;
+    const double d1 = parameters[ 1 ] - 1.5;
+    const double d3 = parameters[ 3 ] - 0.375;
+    return d0 * d0 + 2.0 * d1 * d1 + 3.0 * d3 * d3 + parameters[ 2 ] * parameters[ 2 ];
+  }
+
+
+  virtual void GetDerivative( const ParametersType &, DerivativeType & ) const
+  {
+    itkExceptionMacro( << "The derivative is not used by the optimizer." );
+  }
+
+protected:
+
+  QuadraticCostFunction() {}
+  virtual ~QuadraticCostFunction() {}
+
+private:
+
+  QuadraticCostFunction( const Self & ); // purposely not implemented
+  void operator=( const Self & );        // purposely not implemented
+
+};
+
+typedef itk::FullSearchOptimizer            OptimizerType;
+typedef OptimizerType::ParametersType       ParametersType;
+typedef OptimizerType::MeasureType          MeasureType;
+typedef OptimizerType::SearchSpaceIndexType SearchSpaceIndexType;
+
+/** Store the index and value of each evaluated point. */
+class SurfaceObserver : public itk::Command
+{
+public:
+
+  typedef SurfaceObserver           Self;
+  typedef itk::Command              Superclass;
+  typedef itk::SmartPointer< Self > Pointer;
+  itkNewMacro( Self );
+
+  std::vector< SearchSpaceIndexType > m_Indices;
+  std::vector< MeasureType >          m_Values;
+
+  virtual void Execute( itk::Object * caller, const itk::EventObject & event )
+  {
+    this->Execute( const_cast< const itk::Object * >( caller ), event );
+  }
+
+
+  virtual void Execute( const itk::Object * caller, const itk::EventObject & event )
+  {
+    const OptimizerType * optimizer = dynamic_cast< const OptimizerType * >( caller );
+    if( optimizer != 0 && itk::IterationEvent().CheckEvent( &event ) )
+    {
+      this->m_Indices.push_back( optimizer->GetCurrentIndexInSearchSpace() );
+      this->m_Values.push_back( optimizer->GetValue() );
+    }
+  }
+
+protected:
+
+  SurfaceObserver() {}
+  virtual ~SurfaceObserver() {}
+
+};
+
+/** Create an optimizer with a search space of 17 x 9 x 9 points. */
+OptimizerType::Pointer
+CreateOptimizer( const bool concurrent, const unsigned int coarseGridStride )
+{
+  OptimizerType::Pointer optimizer = OptimizerType::New();
+  optimizer->SetCostFunction( QuadraticCostFunction::New() );
+  if( concurrent )
+  {
+    OptimizerType::CostFunctionContainerType independentCostFunctions;
+    for( unsigned int i = 0; i < 3; ++i )
+    {
+      independentCostFunctions.push_back( QuadraticCostFunction::New().GetPointer() );
+    }
+    optimizer->SetIndependentCostFunctions( independentCostFunctions );
+  }
+
+  ParametersType initialPosition( 4 );
+  initialPosition.Fill( 0.0 );
+  initialPosition[ 2 ] = 0.5;
+  optimizer->SetInitialPosition( initialPosition );
+  optimizer->AddSearchDimension( 0, -2.0, 2.0, 0.25 );
+  optimizer->AddSearchDimension( 1, -1.0, 3.0, 0.5 );
+  optimizer->AddSearchDimension( 3, 0.0, 1.0, 0.125 );
+  optimizer->SetCoarseGridStride( coarseGridStride );
+
+  return optimizer;
+
+} // end CreateOptimizer()
+
+
+/** Run the optimizer and record the evaluated points. */
+bool
+RunOptimizer( OptimizerType * optimizer, SurfaceObserver * observer )
+{
+  optimizer->AddObserver( itk::IterationEvent(), observer );
+  try
+  {
+    optimizer->StartOptimization();
+  }
+  catch( itk::ExceptionObject & e )
+  {
+    std::cerr << "ERROR: " << e << std::endl;
+    return false;
+  }
+
+  return optimizer->GetStopCondition() == OptimizerType::FullRangeSearched;
+
+} // end RunOptimizer()
+
+
+/** Check that the optimum at index ( 11, 5, 3 ) has been found. */
+bool
+CheckOptimum( OptimizerType * optimizer )
+{
+  const SearchSpaceIndexType & best     = optimizer->GetBestIndexInSearchSpace();
+  const ParametersType &       position = optimizer->GetCurrentPosition();
+  return best[ 0 ] == 11 && best[ 1 ] == 5 && best[ 2 ] == 3
+         && optimizer->GetBestValue() == 0.25
+         && position[ 0 ] == 0.75 && position[ 1 ] == 1.5
+         && position[ 2 ] == 0.5 && position[ 3 ] == 0.375;
+
+} // end CheckOptimum()
+
+
+} // end namespace
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int, char *[] )
+{
+  /** The point numbers and the indices must be each other's inverse. */
+  OptimizerType::Pointer optimizer          = CreateOptimizer( false, 1 );
+  const unsigned long    numberOfIterations = optimizer->GetNumberOfIterations();
+  if( numberOfIterations != 17 * 9 * 9 )
+  {
+    std::cerr << "ERROR: the search space has " << numberOfIterations << " points." << std::endl;
+    return EXIT_FAILURE;
+  }
+  for( unsigned long pointNumber = 0; pointNumber < numberOfIterations; ++pointNumber )
+  {
+    const SearchSpaceIndexType index = optimizer->PointNumberToIndex( pointNumber );
+    if( optimizer->IndexToPointNumber( index ) != pointNumber )
+    {
+      std::cerr << "ERROR: point number " << pointNumber << " maps to index " << index
+                << ", which maps to point number " << optimizer->IndexToPointNumber( index )
+                << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  /** Run the full and the coarse-to-fine search, sequentially and concurrently. */
+  const unsigned int       strides[] = { 1, 4 };
+  SurfaceObserver::Pointer observers[ 2 ][ 2 ];
+  for( unsigned int s = 0; s < 2; ++s )
+  {
+    for( unsigned int c = 0; c < 2; ++c )
+    {
+      optimizer           = CreateOptimizer( c == 1, strides[ s ] );
+      observers[ s ][ c ] = SurfaceObserver::New();
+      if( !RunOptimizer( optimizer, observers[ s ][ c ] ) || !CheckOptimum( optimizer ) )
+      {
+        std::cerr << "ERROR: the " << ( c == 1 ? "concurrent" : "sequential" )
+                  << " search with stride " << strides[ s ]
+                  << " did not find the optimum." << std::endl;
+        return EXIT_FAILURE;
+      }
+      if( optimizer->GetCurrentIteration() != observers[ s ][ c ]->m_Values.size() )
+      {
+        std::cerr << "ERROR: the number of iterations is not the number of reported points."
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    /** The concurrent evaluation must report the same surface, in the same order. */
+    if( observers[ s ][ 0 ]->m_Indices != observers[ s ][ 1 ]->m_Indices
+      || observers[ s ][ 0 ]->m_Values != observers[ s ][ 1 ]->m_Values )
+    {
+      std::cerr << "ERROR: the concurrent search with stride " << strides[ s ]
+                << " reports another surface than the sequential search." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  /** The full search visits the points in the order of their point numbers. */
+  const std::vector< SearchSpaceIndexType > & fullIndices = observers[ 0 ][ 0 ]->m_Indices;
+  if( fullIndices.size() != numberOfIterations )
+  {
+    std::cerr << "ERROR: the full search evaluated " << fullIndices.size() << " points." << std::endl;
+    return EXIT_FAILURE;
+  }
+  for( unsigned long pointNumber = 0; pointNumber < numberOfIterations; ++pointNumber )
+  {
+    if( fullIndices[ pointNumber ] != optimizer->PointNumberToIndex( pointNumber ) )
+    {
+      std::cerr << "ERROR: the full search visits index " << fullIndices[ pointNumber ]
+                << " at iteration " << pointNumber << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  /** The coarse-to-fine search evaluates the 5 x 3 x 3 coarse points, and
+   * the 7 x 7 x 7 points around the best coarse point ( 12, 4, 4 ), except
+   * that coarse point itself.
+   */
+  const unsigned long numberOfCoarseToFinePoints = 5 * 3 * 3 + 7 * 7 * 7 - 1;
+  std::cout << "full search: " << fullIndices.size() << " points, coarse-to-fine search: "
+            << observers[ 1 ][ 0 ]->m_Indices.size() << " points" << std::endl;
+  if( observers[ 1 ][ 0 ]->m_Indices.size() != numberOfCoarseToFinePoints )
+  {
+    std::cerr << "ERROR: the coarse-to-fine search should evaluate "
+              << numberOfCoarseToFinePoints << " points." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+
+} // end main
@@ -0,0 +1,150 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkGenericMultiResolutionPyramidImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+/** This test compares the cascaded computation of the
+ * GenericMultiResolutionPyramidImageFilter with the direct computation,
+ * for the shrinker and the resampler and the default schedules. The levels
+ * must have the same geometry, and approximately the same intensities; the
+ * time of each variant is printed. The image size can be passed as the
+ * first argument, for example 512 for a timing on a large volume.
+ */
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  /** Some basic type definitions. */
+  const unsigned int Dimension      = 3;
+  const unsigned int numberOfLevels = 4;
+  typedef short                                    InputPixelType;
+  typedef float                                    OutputPixelType;
+  typedef itk::Image< InputPixelType, Dimension >  InputImageType;
+  typedef itk::Image< OutputPixelType, Dimension > OutputImageType;
+  typedef itk::GenericMultiResolutionPyramidImageFilter<
+    InputImageType, OutputImageType >              PyramidType;
+
+  unsigned int imageSize = 64;
+  if( argc > 1 )
+  {
+    imageSize = static_cast< unsigned int >( std::atoi( argv[ 1 ] ) );
+  }
+
+  /** Create a smooth input image, scaled with the image size. */
+  InputImageType::SizeType size;
+  size.Fill( imageSize );
+  InputImageType::Pointer image = InputImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< InputImageType > it( image, image->GetLargestPossibleRegion() );
+  const double center = 0.5 * ( imageSize - 1.0 );
+  const double width  = 0.3 * imageSize;
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    const InputImageType::IndexType index = it.GetIndex();
+    const double                    dx    = ( index[ 0 ] - center ) / width;
+    const double                    dy    = ( index[ 1 ] - center ) / width;
+    const double                    dz    = ( index[ 2 ] - center ) / width;
+    const double                    value = 1000.0 * std::exp( -( dx * dx + 2.0 * dy * dy + dz * dz ) )
+      + 200.0 * std::sin( 2.0 * dx ) * std::cos( dz );
+    it.Set( static_cast< InputPixelType >( value ) );
+  }
+
+  /** Compute the pyramid directly and cascaded, with the shrinker and the
+   * resampler.
+   */
+  const double tolerance = 0.03;
+  const char * names[]   = { "direct", "cascaded" };
+  for( unsigned int s = 0; s < 2; ++s )
+  {
+    const bool           useShrinkImageFilter = ( s == 1 );
+    PyramidType::Pointer pyramid[ 2 ];
+    double               time[ 2 ];
+    for( unsigned int v = 0; v < 2; ++v )
+    {
+      pyramid[ v ] = PyramidType::New();
+      pyramid[ v ]->SetInput( image );
+      pyramid[ v ]->SetNumberOfLevels( numberOfLevels );
+      pyramid[ v ]->SetUseShrinkImageFilter( useShrinkImageFilter );
+      pyramid[ v ]->SetUseCascadedComputation( v == 1 );
+
+      itk::TimeProbe timer;
+      timer.Start();
+      try
+      {
+        pyramid[ v ]->Update();
+      }
+      catch( itk::ExceptionObject & e )
+      {
+        std::cerr << "ERROR: " << e << std::endl;
+        return EXIT_FAILURE;
+      }
+      timer.Stop();
+      time[ v ] = timer.GetMean();
+
+      std::cout << ( useShrinkImageFilter ? "shrinker" : "resampler" ) << ", "
+                << names[ v ] << ": time " << time[ v ] << " s" << std::endl;
+    }
+    std::cout << "speedup: " << time[ 0 ] / time[ 1 ] << std::endl;
+
+    /** Compare the levels, relative to the maximum intensity. */
+    for( unsigned int level = 0; level < numberOfLevels; ++level )
+    {
+      OutputImageType::Pointer direct   = pyramid[ 0 ]->GetOutput( level );
+      OutputImageType::Pointer cascaded = pyramid[ 1 ]->GetOutput( level );
+      if( direct->GetLargestPossibleRegion() != cascaded->GetLargestPossibleRegion()
+        || direct->GetSpacing() != cascaded->GetSpacing()
+        || direct->GetOrigin().EuclideanDistanceTo( cascaded->GetOrigin() ) > 1e-6 )
+      {
+        std::cerr << "ERROR: level " << level << " has another geometry." << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      itk::ImageRegionConstIterator< OutputImageType > dit( direct, direct->GetLargestPossibleRegion() );
+      itk::ImageRegionConstIterator< OutputImageType > cit( cascaded, cascaded->GetLargestPossibleRegion() );
+      double maxValue      = 0.0;
+      double maxDifference = 0.0;
+      for( dit.GoToBegin(), cit.GoToBegin(); !dit.IsAtEnd(); ++dit, ++cit )
+      {
+        maxValue      = std::max( maxValue, std::abs( static_cast< double >( dit.Get() ) ) );
+        maxDifference = std::max( maxDifference,
+          std::abs( static_cast< double >( dit.Get() ) - cit.Get() ) );
+      }
+
+      std::cout << "level " << level << ": relative difference "
+                << maxDifference / maxValue << std::endl;
+      if( maxValue == 0.0 || maxDifference > tolerance * maxValue )
+      {
+        std::cerr << "ERROR: level " << level << " of the cascaded computation differs." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+
+} // end main
@@ -0,0 +1,137 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkGenericMultiResolutionPyramidImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <cstdlib>
+#include <iostream>
+
+/** This test checks that the levels of the GenericMultiResolutionPyramidImageFilter
+ * that are neither smoothed nor rescaled share the buffer of the input image,
+ * and that the other levels, and the levels of a pyramid with another output
+ * type, have their own buffer with the right intensities.
+ */
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int, char *[] )
+{
+  /** Some basic type definitions. */
+  const unsigned int Dimension      = 2;
+  const unsigned int numberOfLevels = 3;
+  typedef float                                     PixelType;
+  typedef itk::Image< PixelType, Dimension >        ImageType;
+  typedef itk::Image< double, Dimension >           OtherImageType;
+  typedef itk::GenericMultiResolutionPyramidImageFilter<
+    ImageType, ImageType >                          PyramidType;
+  typedef itk::GenericMultiResolutionPyramidImageFilter<
+    ImageType, OtherImageType >                     OtherPyramidType;
+  typedef PyramidType::RescaleScheduleType          RescaleScheduleType;
+
+  /** Create an input image. */
+  ImageType::SizeType size;
+  size.Fill( 32 );
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    it.Set( static_cast< PixelType >( it.GetIndex()[ 0 ] + 3 * it.GetIndex()[ 1 ] ) );
+  }
+
+  /** Without smoothing and rescaling all levels share the input buffer. The
+   * smoothing schedule is zero, since it is not defined.
+   */
+  RescaleScheduleType schedule( numberOfLevels, Dimension );
+  schedule.Fill( 1 );
+  PyramidType::Pointer pyramid = PyramidType::New();
+  pyramid->SetInput( image );
+  pyramid->SetNumberOfLevels( numberOfLevels );
+  pyramid->SetRescaleSchedule( schedule );
+  pyramid->Update();
+  for( unsigned int level = 0; level < numberOfLevels; ++level )
+  {
+    if( pyramid->GetOutput( level )->GetBufferPointer() != image->GetBufferPointer() )
+    {
+      std::cerr << "ERROR: level " << level << " does not share the input buffer." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  /** With a rescale schedule and the default smoothing schedule only the
+   * last level shares the input buffer. The other levels were shared in the
+   * previous update, so this also checks that the input is not overwritten.
+   */
+  for( unsigned int level = 0; level < numberOfLevels; ++level )
+  {
+    for( unsigned int dim = 0; dim < Dimension; ++dim )
+    {
+      schedule[ level ][ dim ] = 1 << ( numberOfLevels - 1 - level );
+    }
+  }
+  pyramid->SetRescaleSchedule( schedule );
+  pyramid->SetUseShrinkImageFilter( true );
+  pyramid->Update();
+  for( unsigned int level = 0; level < numberOfLevels; ++level )
+  {
+    const bool shared = pyramid->GetOutput( level )->GetBufferPointer() == image->GetBufferPointer();
+    if( shared != ( level == numberOfLevels - 1 ) )
+    {
+      std::cerr << "ERROR: level " << level << " of the mixed schedule is "
+                << ( shared ? "" : "not " ) << "shared." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  /** The input must not have been modified by computing the other levels. */
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    if( it.Get() != static_cast< PixelType >( it.GetIndex()[ 0 ] + 3 * it.GetIndex()[ 1 ] ) )
+    {
+      std::cerr << "ERROR: the input image has been modified." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  /** With another output type the input is copied. */
+  OtherPyramidType::Pointer otherPyramid = OtherPyramidType::New();
+  otherPyramid->SetInput( image );
+  otherPyramid->SetNumberOfLevels( numberOfLevels );
+  schedule.Fill( 1 );
+  otherPyramid->SetRescaleSchedule( schedule );
+  otherPyramid->Update();
+  for( unsigned int level = 0; level < numberOfLevels; ++level )
+  {
+    itk::ImageRegionConstIterator< OtherImageType > oit( otherPyramid->GetOutput( level ),
+      otherPyramid->GetOutput( level )->GetLargestPossibleRegion() );
+    for( it.GoToBegin(), oit.GoToBegin(); !it.IsAtEnd(); ++it, ++oit )
+    {
+      if( oit.Get() != static_cast< double >( it.Get() ) )
+      {
+        std::cerr << "ERROR: level " << level << " has not been copied." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+
+} // end main
@@ -0,0 +1,286 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkAdvancedMeanSquaresImageToImageMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkAdvancedCombinationTransform.h"
+#include "itkAdvancedEuler3DTransform.h"
+#include "itkImageRandomSampler.h"
+#include "itkImageSampleContainerSoA.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <iomanip>
+
+/** This test compares the per-iteration time of the AdvancedMeanSquares
+ * metric, when the samples are read from the array-of-structs output of
+ * the image sampler, with the time when they are read from the
+ * structure-of-arrays output, which the sampler writes together with its
+ * normal output. A 3D B-spline registration setting is mimicked.
+ * It also checks that both layouts give identical metric values and
+ * derivatives, also for a combination transform as used by elastix, and that
+ * the structure-of-arrays container holds the same samples, at aligned
+ * addresses, for the serial and the multi-threaded sampler.
+ */
+
+//-------------------------------------------------------------------------------------
+
+template< class TSampler >
+bool
+CheckSamplesSoA( const TSampler * sampler )
+{
+  typedef typename TSampler::ImageSampleContainerType    SampleContainerType;
+  typedef typename TSampler::ImageSampleContainerSoAType SampleContainerSoAType;
+
+  const SampleContainerType *    samples    = sampler->GetOutput();
+  const SampleContainerSoAType * samplesSoA = sampler->GetOutputSoA();
+  if( samples->Size() == 0 || samplesSoA->Size() != samples->Size() )
+  {
+    std::cerr << "ERROR: the structure-of-arrays container has the wrong size." << std::endl;
+    return false;
+  }
+  for( unsigned int d = 0; d < SampleContainerSoAType::ImageDimension; ++d )
+  {
+    if( reinterpret_cast< std::size_t >( samplesSoA->GetCoordinates( d ) )
+      % SampleContainerSoAType::Alignment != 0 )
+    {
+      std::cerr << "ERROR: the coordinate array is not aligned." << std::endl;
+      return false;
+    }
+  }
+  for( unsigned long i = 0; i < samples->Size(); ++i )
+  {
+    typename SampleContainerSoAType::PointType point;
+    typename SampleContainerSoAType::RealType  value;
+    samplesSoA->GetSample( i, point, value );
+    if( point != samples->ElementAt( i ).m_ImageCoordinates
+      || value != samples->ElementAt( i ).m_ImageValue )
+    {
+      std::cerr << "ERROR: sample " << i << " differs between the containers." << std::endl;
+      return false;
+    }
+  }
+  return true;
+
+} // end CheckSamplesSoA()
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  /** Typedefs. */
+  const unsigned int Dimension = 3;
+  typedef float                                  PixelType;
+  typedef itk::Image< PixelType, Dimension >     ImageType;
+  typedef ImageType::RegionType                  RegionType;
+  typedef ImageType::SizeType                    SizeType;
+  typedef ImageType::IndexType                   IndexType;
+  typedef ImageType::SpacingType                 SpacingType;
+  typedef ImageType::PointType                   OriginType;
+  typedef ImageType::DirectionType               DirectionType;
+  typedef itk::ImageRegionIteratorWithIndex< ImageType > IteratorType;
+
+  typedef itk::AdvancedMeanSquaresImageToImageMetric<
+    ImageType, ImageType >                                MetricType;
+  typedef MetricType::MeasureType                         MeasureType;
+  typedef MetricType::DerivativeType                      DerivativeType;
+  typedef itk::AdvancedBSplineDeformableTransform< double, Dimension, 3 > TransformType;
+  typedef TransformType::ParametersType                   ParametersType;
+  typedef itk::ImageRandomSampler< ImageType >            SamplerType;
+  typedef itk::BSplineInterpolateImageFunction<
+    ImageType, double, double >                           InterpolatorType;
+
+  /** The number of iterations. Distinguish between Debug and Release mode. */
+#ifndef NDEBUG
+  const unsigned int iterations = 10;
+#else
+  const unsigned int iterations = 100;
+#endif
+
+  /** Create two smooth, shifted blobs as the fixed and moving image. */
+  SizeType imageSize; imageSize.Fill( 64 );
+  RegionType region; region.SetSize( imageSize );
+  ImageType::Pointer fixedImage  = ImageType::New();
+  ImageType::Pointer movingImage = ImageType::New();
+  fixedImage->SetRegions( region );  fixedImage->Allocate();
+  movingImage->SetRegions( region ); movingImage->Allocate();
+
+  IteratorType fit( fixedImage, region );
+  IteratorType mit( movingImage, region );
+  for( fit.GoToBegin(), mit.GoToBegin(); !fit.IsAtEnd(); ++fit, ++mit )
+  {
+    const IndexType index = fit.GetIndex();
+    double          rf = 0.0, rm = 0.0;
+    for( unsigned int d = 0; d < Dimension; ++d )
+    {
+      rf += vnl_math_sqr( index[ d ] - 32.0 );
+      rm += vnl_math_sqr( index[ d ] - 34.0 );
+    }
+    fit.Set( static_cast< PixelType >( 100.0 * vcl_exp( -rf / 200.0 ) ) );
+    mit.Set( static_cast< PixelType >( 100.0 * vcl_exp( -rm / 200.0 ) ) );
+  }
+
+  /** Setup a B-spline transform with a grid spacing of 8 voxels. */
+  TransformType::Pointer transform = TransformType::New();
+  SizeType               gridSize; gridSize.Fill( 64 / 8 + 3 );
+  RegionType             gridRegion; gridRegion.SetSize( gridSize );
+  SpacingType            gridSpacing; gridSpacing.Fill( 8.0 );
+  OriginType             gridOrigin; gridOrigin.Fill( -8.0 );
+  DirectionType          gridDirection; gridDirection.SetIdentity();
+  transform->SetGridOrigin( gridOrigin );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridRegion( gridRegion );
+  transform->SetGridDirection( gridDirection );
+
+  ParametersType parameters( transform->GetNumberOfParameters() );
+  for( unsigned int i = 0; i < parameters.GetSize(); ++i )
+  {
+    parameters[ i ] = 0.5 * vcl_sin( static_cast< double >( i ) );
+  }
+  transform->SetParameters( parameters );
+
+  /** Setup the sampler and the metric. */
+  SamplerType::Pointer sampler = SamplerType::New();
+  sampler->SetNumberOfSamples( 100000 );
+
+  MetricType::Pointer metric = MetricType::New();
+  metric->SetFixedImage( fixedImage );
+  metric->SetMovingImage( movingImage );
+  metric->SetFixedImageRegion( region );
+  metric->SetTransform( transform );
+  metric->SetInterpolator( InterpolatorType::New() );
+  metric->SetImageSampler( sampler );
+  metric->SetUseMultiThread( true );
+  metric->Initialize();
+
+  /** Check that the structure-of-arrays container holds the same samples,
+   * when the sampler generates it. The metric does so in Initialize(), when
+   * UseStructureOfArraysSamples is set.
+   */
+  sampler->Update();
+  if( sampler->GetOutputSoA()->Size() != 0 )
+  {
+    std::cerr << "ERROR: the structure-of-arrays container is generated by default." << std::endl;
+    return EXIT_FAILURE;
+  }
+  metric->SetUseStructureOfArraysSamples( true );
+  metric->Initialize();
+  sampler->Update();
+  if( !CheckSamplesSoA( sampler.GetPointer() ) )
+  {
+    return EXIT_FAILURE;
+  }
+
+  /** The multi-threaded sampler writes it while merging the thread results. */
+  SamplerType::Pointer threadedSampler = SamplerType::New();
+  threadedSampler->SetInput( fixedImage );
+  threadedSampler->SetInputImageRegion( region );
+  threadedSampler->SetNumberOfSamples( 10000 );
+  threadedSampler->SetUseMultiThread( true );
+  threadedSampler->GenerateOutputSoAOn();
+  threadedSampler->Update();
+  if( !CheckSamplesSoA( threadedSampler.GetPointer() ) )
+  {
+    return EXIT_FAILURE;
+  }
+
+  /** Time both layouts. */
+  itk::TimeProbe timerAoS, timerSoA;
+  MeasureType    valueAoS = 0.0, valueSoA = 0.0;
+  DerivativeType derivativeAoS, derivativeSoA;
+
+  metric->SetUseStructureOfArraysSamples( false );
+  for( unsigned int i = 0; i < iterations; ++i )
+  {
+    timerAoS.Start();
+    metric->GetValueAndDerivative( parameters, valueAoS, derivativeAoS );
+    timerAoS.Stop();
+  }
+
+  metric->SetUseStructureOfArraysSamples( true );
+  for( unsigned int i = 0; i < iterations; ++i )
+  {
+    timerSoA.Start();
+    metric->GetValueAndDerivative( parameters, valueSoA, derivativeSoA );
+    timerSoA.Stop();
+  }
+
+  /** Check that both layouts give identical results. */
+  std::cout << std::setprecision( 12 );
+  std::cout << "Value AoS = " << valueAoS << ", value SoA = " << valueSoA << std::endl;
+  if( valueAoS != valueSoA || derivativeAoS != derivativeSoA )
+  {
+    std::cerr << "ERROR: the structure-of-arrays samples give a different "
+              << "value or derivative." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** The combination transform must map the samples in the same way for
+   * both layouts, when the B-spline transform is composed with or added to
+   * an initial transform.
+   */
+  typedef itk::AdvancedCombinationTransform< double, Dimension > CombinationTransformType;
+  typedef itk::AdvancedEuler3DTransform< double >                EulerTransformType;
+
+  EulerTransformType::Pointer          initialTransform = EulerTransformType::New();
+  EulerTransformType::InputPointType   center;
+  EulerTransformType::OutputVectorType translation;
+  center.Fill( 32.0 );
+  translation[ 0 ] = 1.5; translation[ 1 ] = -0.75; translation[ 2 ] = 0.25;
+  initialTransform->SetCenter( center );
+  initialTransform->SetRotation( 0.05, -0.03, 0.02 );
+  initialTransform->SetTranslation( translation );
+
+  CombinationTransformType::Pointer combinationTransform = CombinationTransformType::New();
+  combinationTransform->SetInitialTransform( initialTransform );
+  combinationTransform->SetCurrentTransform( transform );
+  metric->SetTransform( combinationTransform );
+  metric->Initialize();
+
+  for( unsigned int useAddition = 0; useAddition < 2; ++useAddition )
+  {
+    combinationTransform->SetUseAddition( useAddition == 1 );
+
+    metric->SetUseStructureOfArraysSamples( false );
+    metric->GetValueAndDerivative( parameters, valueAoS, derivativeAoS );
+    metric->SetUseStructureOfArraysSamples( true );
+    metric->GetValueAndDerivative( parameters, valueSoA, derivativeSoA );
+
+    std::cout << std::setprecision( 12 );
+    std::cout << "Combination transform ( " << ( useAddition == 1 ? "addition" : "composition" )
+              << " ): value AoS = " << valueAoS << ", value SoA = " << valueSoA << std::endl;
+    if( valueAoS != valueSoA || derivativeAoS != derivativeSoA )
+    {
+      std::cerr << "ERROR: the structure-of-arrays samples give a different "
+                << "value or derivative for the combination transform." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  /** Report the metric time per iteration. */
+  std::cout << std::setprecision( 4 );
+  std::cout << "Metric time per iteration: AoS " << 1000.0 * timerAoS.GetMean()
+            << " ms, SoA " << 1000.0 * timerSoA.GetMean() << " ms, speedup "
+            << timerAoS.GetMean() / timerSoA.GetMean() << std::endl;
+
+  return EXIT_SUCCESS;
+
+} // end main
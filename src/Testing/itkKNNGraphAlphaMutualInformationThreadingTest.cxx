@@ -0,0 +1,169 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "KNNGraphAlphaMutualInformation/itkKNNGraphAlphaMutualInformationImageToImageMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkImageFullSampler.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+/** This test checks that the multi-threaded tree construction and query
+ * loop of the KNNGraphAlphaMutualInformationImageToImageMetric give the same
+ * value and derivative as the single-threaded implementation, for the
+ * standard and the priority tree searcher. It also prints the time of each
+ * variant.
+ */
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  /** Some basic type definitions. */
+  const unsigned int Dimension   = 2;
+  const unsigned int SplineOrder = 3;
+  typedef float                               PixelType;
+  typedef itk::Image< PixelType, Dimension >  ImageType;
+  typedef itk::KNNGraphAlphaMutualInformationImageToImageMetric<
+    ImageType, ImageType >                    MetricType;
+  typedef itk::AdvancedBSplineDeformableTransform<
+    double, Dimension, SplineOrder >          TransformType;
+  typedef itk::BSplineInterpolateImageFunction<
+    ImageType, double, double >               InterpolatorType;
+  typedef itk::ImageFullSampler< ImageType >  SamplerType;
+  typedef MetricType::TransformParametersType ParametersType;
+  typedef MetricType::DerivativeType          DerivativeType;
+  typedef MetricType::MeasureType             MeasureType;
+
+  /** Create a fixed and a moving image with a different intensity mapping. */
+  ImageType::SizeType size;
+  size.Fill( 48 );
+  ImageType::Pointer fixedImage  = ImageType::New();
+  ImageType::Pointer movingImage = ImageType::New();
+  fixedImage->SetRegions( size );
+  fixedImage->Allocate();
+  movingImage->SetRegions( size );
+  movingImage->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > fit( fixedImage, fixedImage->GetLargestPossibleRegion() );
+  itk::ImageRegionIteratorWithIndex< ImageType > mit( movingImage, movingImage->GetLargestPossibleRegion() );
+  for( fit.GoToBegin(), mit.GoToBegin(); !fit.IsAtEnd(); ++fit, ++mit )
+  {
+    const ImageType::IndexType index = fit.GetIndex();
+    const double               dx    = index[ 0 ] - 22.0;
+    const double               dy    = index[ 1 ] - 26.0;
+    const double               blob  = std::exp( -( dx * dx + dy * dy ) / 100.0 );
+    fit.Set( static_cast< PixelType >( 100.0 * blob + 10.0 * std::sin( 0.3 * index[ 0 ] ) ) );
+    mit.Set( static_cast< PixelType >( 200.0 - 150.0 * blob * blob + 5.0 * std::cos( 0.2 * index[ 1 ] ) ) );
+  }
+
+  /** Create a B-spline transform with some deformation. */
+  TransformType::Pointer                transform = TransformType::New();
+  TransformType::RegionType::SizeType   gridSize;
+  TransformType::SpacingType            gridSpacing;
+  TransformType::OriginType             gridOrigin;
+  gridSize.Fill( 8 );
+  gridSpacing.Fill( 9.0 );
+  gridOrigin.Fill( -9.0 );
+  TransformType::RegionType gridRegion;
+  gridRegion.SetSize( gridSize );
+  transform->SetGridRegion( gridRegion );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridOrigin( gridOrigin );
+
+  ParametersType parameters( transform->GetNumberOfParameters() );
+  for( unsigned int i = 0; i < parameters.GetSize(); ++i )
+  {
+    parameters[ i ] = 1.5 * std::sin( 0.37 * i );
+  }
+  transform->SetParameters( parameters );
+
+  /** The settings of the variants to test. Variant 2v + 1 is compared to 2v. */
+  const bool         usePrioritySearch[] = { false, false, true, true };
+  const bool         useMultiThread[]    = { false, true, false, true };
+  const char *       names[]             = { "standard", "standard, threaded",
+                                             "priority", "priority, threaded" };
+  const unsigned int numberOfVariants    = 4;
+
+  MeasureType    value[ numberOfVariants ];
+  MeasureType    valueOnly[ numberOfVariants ];
+  DerivativeType derivative[ numberOfVariants ];
+  for( unsigned int v = 0; v < numberOfVariants; ++v )
+  {
+    MetricType::Pointer metric = MetricType::New();
+    metric->SetFixedImage( fixedImage );
+    metric->SetMovingImage( movingImage );
+    metric->SetFixedImageRegion( fixedImage->GetLargestPossibleRegion() );
+    metric->SetTransform( transform );
+    metric->SetInterpolator( InterpolatorType::New() );
+    metric->SetImageSampler( SamplerType::New() );
+    metric->SetANNkDTree( 50, "ANN_KD_SL_MIDPT" );
+    if( usePrioritySearch[ v ] )
+    {
+      metric->SetANNPriorityTreeSearch( 20, 0.0 );
+    }
+    else
+    {
+      metric->SetANNStandardTreeSearch( 20, 0.0 );
+    }
+    metric->SetAlpha( 0.99 );
+    metric->SetUseMultiThread( useMultiThread[ v ] );
+    metric->Initialize();
+
+    itk::TimeProbe timer;
+    timer.Start();
+    metric->GetValueAndDerivative( parameters, value[ v ], derivative[ v ] );
+    timer.Stop();
+    valueOnly[ v ] = metric->GetValue( parameters );
+
+    std::cout << names[ v ] << ": value " << value[ v ]
+              << ", time " << timer.GetMean() << " s" << std::endl;
+  }
+
+  /** Compare the threaded variants with the single-threaded ones. */
+  const double tolerance = 1e-10;
+  for( unsigned int v = 1; v < numberOfVariants; v += 2 )
+  {
+    double maxDifference = 0.0;
+    double maxDerivative = 0.0;
+    for( unsigned int i = 0; i < derivative[ v - 1 ].GetSize(); ++i )
+    {
+      maxDifference = std::max( maxDifference, std::abs( derivative[ v - 1 ][ i ] - derivative[ v ][ i ] ) );
+      maxDerivative = std::max( maxDerivative, std::abs( derivative[ v - 1 ][ i ] ) );
+    }
+
+    std::cout << names[ v ] << ": maximum derivative difference " << maxDifference
+              << ", maximum derivative " << maxDerivative << std::endl;
+
+    /** Only the order of summation differs. */
+    if( maxDerivative == 0.0
+      || std::abs( value[ v - 1 ] - value[ v ] ) > tolerance * std::abs( value[ v - 1 ] )
+      || std::abs( valueOnly[ v ] - value[ v ] ) > tolerance * std::abs( value[ v ] )
+      || maxDifference > tolerance * maxDerivative )
+    {
+      std::cerr << "ERROR: the " << names[ v ] << " variant differs from the single-threaded variant." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+
+} // end main
@@ -0,0 +1,166 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "NormalizedMutualInformation/itkParzenWindowNormalizedMutualInformationImageToImageMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkExponentialLimiterFunction.h"
+#include "itkHardLimiterFunction.h"
+#include "itkImageFullSampler.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+/** This test checks that the low memory variant of the derivative of the
+ * ParzenWindowNormalizedMutualInformationImageToImageMetric, single- and
+ * multi-threaded, gives the same value and derivative as the variant with
+ * the explicit joint histogram derivative. It also prints the time of each
+ * variant.
+ */
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  /** Some basic type definitions. */
+  const unsigned int Dimension   = 2;
+  const unsigned int SplineOrder = 3;
+  typedef float                               PixelType;
+  typedef itk::Image< PixelType, Dimension >  ImageType;
+  typedef itk::ParzenWindowNormalizedMutualInformationImageToImageMetric<
+    ImageType, ImageType >                    MetricType;
+  typedef itk::AdvancedBSplineDeformableTransform<
+    double, Dimension, SplineOrder >          TransformType;
+  typedef itk::BSplineInterpolateImageFunction<
+    ImageType, double, double >               InterpolatorType;
+  typedef itk::ImageFullSampler< ImageType >  SamplerType;
+  typedef itk::HardLimiterFunction<
+    MetricType::RealType, Dimension >         FixedLimiterType;
+  typedef itk::ExponentialLimiterFunction<
+    MetricType::RealType, Dimension >         MovingLimiterType;
+  typedef MetricType::TransformParametersType ParametersType;
+  typedef MetricType::DerivativeType          DerivativeType;
+  typedef MetricType::MeasureType             MeasureType;
+
+  /** Create a fixed and a moving image with a different intensity mapping. */
+  ImageType::SizeType size;
+  size.Fill( 64 );
+  ImageType::Pointer fixedImage  = ImageType::New();
+  ImageType::Pointer movingImage = ImageType::New();
+  fixedImage->SetRegions( size );
+  fixedImage->Allocate();
+  movingImage->SetRegions( size );
+  movingImage->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > fit( fixedImage, fixedImage->GetLargestPossibleRegion() );
+  itk::ImageRegionIteratorWithIndex< ImageType > mit( movingImage, movingImage->GetLargestPossibleRegion() );
+  for( fit.GoToBegin(), mit.GoToBegin(); !fit.IsAtEnd(); ++fit, ++mit )
+  {
+    const ImageType::IndexType index = fit.GetIndex();
+    const double               dx    = index[ 0 ] - 30.0;
+    const double               dy    = index[ 1 ] - 34.0;
+    const double               blob  = std::exp( -( dx * dx + dy * dy ) / 150.0 );
+    fit.Set( static_cast< PixelType >( 100.0 * blob + 10.0 * std::sin( 0.2 * index[ 0 ] ) ) );
+    mit.Set( static_cast< PixelType >( 200.0 - 150.0 * blob * blob ) );
+  }
+
+  /** Create a B-spline transform with some deformation. */
+  TransformType::Pointer                transform = TransformType::New();
+  TransformType::RegionType::SizeType   gridSize;
+  TransformType::SpacingType            gridSpacing;
+  TransformType::OriginType             gridOrigin;
+  gridSize.Fill( 10 );
+  gridSpacing.Fill( 9.0 );
+  gridOrigin.Fill( -13.0 );
+  TransformType::RegionType gridRegion;
+  gridRegion.SetSize( gridSize );
+  transform->SetGridRegion( gridRegion );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridOrigin( gridOrigin );
+
+  ParametersType parameters( transform->GetNumberOfParameters() );
+  for( unsigned int i = 0; i < parameters.GetSize(); ++i )
+  {
+    parameters[ i ] = 1.5 * std::sin( 0.37 * i );
+  }
+  transform->SetParameters( parameters );
+
+  /** The settings of the variants to test. The first is the reference. */
+  const bool         useExplicitPDFDerivatives[] = { true, false, false };
+  const bool         useMultiThread[]            = { false, false, true };
+  const char *       names[]                     = { "explicit", "low memory", "low memory, threaded" };
+  const unsigned int numberOfVariants            = 3;
+
+  MeasureType    value[ numberOfVariants ];
+  DerivativeType derivative[ numberOfVariants ];
+  for( unsigned int v = 0; v < numberOfVariants; ++v )
+  {
+    MetricType::Pointer metric = MetricType::New();
+    metric->SetFixedImage( fixedImage );
+    metric->SetMovingImage( movingImage );
+    metric->SetFixedImageRegion( fixedImage->GetLargestPossibleRegion() );
+    metric->SetTransform( transform );
+    metric->SetInterpolator( InterpolatorType::New() );
+    metric->SetImageSampler( SamplerType::New() );
+    metric->SetFixedImageLimiter( FixedLimiterType::New() );
+    metric->SetMovingImageLimiter( MovingLimiterType::New() );
+    metric->SetNumberOfFixedHistogramBins( 32 );
+    metric->SetNumberOfMovingHistogramBins( 32 );
+    metric->SetUseExplicitPDFDerivatives( useExplicitPDFDerivatives[ v ] );
+    metric->SetUseMultiThread( useMultiThread[ v ] );
+    metric->Initialize();
+
+    itk::TimeProbe timer;
+    timer.Start();
+    metric->GetValueAndDerivative( parameters, value[ v ], derivative[ v ] );
+    timer.Stop();
+
+    std::cout << names[ v ] << ": value " << value[ v ]
+              << ", time " << timer.GetMean() << " s" << std::endl;
+  }
+
+  /** Compare the results with the explicit variant. */
+  const double tolerance = 1e-8;
+  for( unsigned int v = 1; v < numberOfVariants; ++v )
+  {
+    double maxDifference = 0.0;
+    double maxDerivative = 0.0;
+    for( unsigned int i = 0; i < derivative[ 0 ].GetSize(); ++i )
+    {
+      maxDifference = std::max( maxDifference, std::abs( derivative[ 0 ][ i ] - derivative[ v ][ i ] ) );
+      maxDerivative = std::max( maxDerivative, std::abs( derivative[ 0 ][ i ] ) );
+    }
+
+    std::cout << names[ v ] << ": maximum derivative difference " << maxDifference
+              << ", maximum derivative " << maxDerivative << std::endl;
+
+    /** The explicit variant stores the joint histogram derivative in floats. */
+    if( maxDerivative == 0.0
+      || std::abs( value[ 0 ] - value[ v ] ) > tolerance * std::abs( value[ 0 ] )
+      || maxDifference > 1e-5 * maxDerivative )
+    {
+      std::cerr << "ERROR: the " << names[ v ] << " variant differs from the explicit variant." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+
+} // end main
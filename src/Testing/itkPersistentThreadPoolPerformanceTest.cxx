@@ -0,0 +1,222 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkPersistentThreadPool.h"
+#include "itkMultiThreader.h"
+#include "itkArray.h"
+#include "itkNumericTraits.h"
+#include <vector>
+#include <algorithm>
+#include <iomanip>
+
+// Report timings
+#include "itkTimeProbe.h"
+#include "itkTimeProbesCollectorBase.h"
+
+/** This test compares the per-iteration overhead of the ITK MultiThreader,
+ * which spawns and joins threads at every call, with the overhead of the
+ * PersistentThreadPool, which keeps its threads alive between calls.
+ * It mimics the two threaded phases of an AdvancedImageToImageMetric
+ * iteration: a ThreadedGetValueAndDerivative-like step, that loops over
+ * a part of the samples, and an accumulation of the per-thread derivatives.
+ * The results of both paths are checked for equality.
+ */
+
+typedef double       DerivativeValueType;
+typedef unsigned int ThreadIdType;
+
+class MetricTEMP
+{
+public:
+
+  typedef itk::Array< DerivativeValueType > DerivativeType;
+  typedef itk::MultiThreader                ThreaderType;
+  typedef ThreaderType::ThreadInfoStruct    ThreadInfoType;
+
+  unsigned long                 m_NumberOfSamples;
+  unsigned long                 m_NumberOfParameters;
+  std::vector< DerivativeType > m_ThreaderDerivatives;
+  std::vector< double >         m_ThreaderValues;
+  DerivativeType                m_Derivative;
+
+  /** Threaded part 1: each thread computes a value and a derivative
+   * over its part of the samples. */
+  static ITK_THREAD_RETURN_TYPE GetValueAndDerivativeThreaderCallback( void * arg )
+  {
+    ThreadInfoType * infoStruct  = static_cast< ThreadInfoType * >( arg );
+    ThreadIdType     threadID    = infoStruct->ThreadID;
+    ThreadIdType     nrOfThreads = infoStruct->NumberOfThreads;
+    MetricTEMP *     metric      = static_cast< MetricTEMP * >( infoStruct->UserData );
+
+    const unsigned long subSize = ( metric->m_NumberOfSamples + nrOfThreads - 1 ) / nrOfThreads;
+    const unsigned long begin   = std::min( threadID * subSize, metric->m_NumberOfSamples );
+    const unsigned long end     = std::min( begin + subSize, metric->m_NumberOfSamples );
+
+    double           value      = 0.0;
+    DerivativeType & derivative = metric->m_ThreaderDerivatives[ threadID ];
+    for( unsigned long i = begin; i < end; ++i )
+    {
+      value += static_cast< double >( i % 7 );
+      derivative[ i % metric->m_NumberOfParameters ] += 0.5;
+    }
+    metric->m_ThreaderValues[ threadID ] = value;
+
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+
+  /** Threaded part 2: accumulate and reset the per-thread derivatives. */
+  static ITK_THREAD_RETURN_TYPE AccumulateDerivativesThreaderCallback( void * arg )
+  {
+    ThreadInfoType * infoStruct  = static_cast< ThreadInfoType * >( arg );
+    ThreadIdType     threadID    = infoStruct->ThreadID;
+    ThreadIdType     nrOfThreads = infoStruct->NumberOfThreads;
+    MetricTEMP *     metric      = static_cast< MetricTEMP * >( infoStruct->UserData );
+
+    const unsigned long numPar  = metric->m_NumberOfParameters;
+    const unsigned long subSize = ( numPar + nrOfThreads - 1 ) / nrOfThreads;
+    const unsigned long jmin    = std::min( threadID * subSize, numPar );
+    const unsigned long jmax    = std::min( jmin + subSize, numPar );
+
+    for( unsigned long j = jmin; j < jmax; ++j )
+    {
+      DerivativeValueType tmp = 0.0;
+      for( ThreadIdType i = 0; i < nrOfThreads; ++i )
+      {
+        tmp += metric->m_ThreaderDerivatives[ i ][ j ];
+        metric->m_ThreaderDerivatives[ i ][ j ] = 0.0;
+      }
+      metric->m_Derivative[ j ] = tmp;
+    }
+
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+
+  void Initialize( unsigned long nrOfSamples, unsigned long nrOfParameters, ThreadIdType nrOfThreads )
+  {
+    this->m_NumberOfSamples    = nrOfSamples;
+    this->m_NumberOfParameters = nrOfParameters;
+    this->m_ThreaderDerivatives.resize( nrOfThreads );
+    this->m_ThreaderValues.assign( nrOfThreads, 0.0 );
+    for( ThreadIdType t = 0; t < nrOfThreads; ++t )
+    {
+      this->m_ThreaderDerivatives[ t ].SetSize( nrOfParameters );
+      this->m_ThreaderDerivatives[ t ].Fill( 0.0 );
+    }
+    this->m_Derivative.SetSize( nrOfParameters );
+    this->m_Derivative.Fill( 0.0 );
+  }
+
+
+  double GetValue( void ) const
+  {
+    double value = 0.0;
+    for( std::size_t t = 0; t < this->m_ThreaderValues.size(); ++t )
+    {
+      value += this->m_ThreaderValues[ t ];
+    }
+    return value;
+  }
+
+
+};
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  std::cout << std::fixed << std::showpoint << std::setprecision( 8 );
+
+  /** Setup. */
+  itk::MultiThreader::Pointer        threader  = itk::MultiThreader::New();
+  itk::PersistentThreadPool::Pointer pool      = itk::PersistentThreadPool::New();
+  const ThreadIdType                 nrThreads = threader->GetNumberOfThreads();
+  threader->SetUseThreadPool( false ); // as in the AdvancedImageToImageMetric
+  pool->SetNumberOfThreads( nrThreads );
+  std::cout << "Number of threads: " << nrThreads << "\n" << std::endl;
+
+  /** Small sample counts are where the thread creation overhead matters. */
+  std::vector< unsigned long > sampleSizes;
+  sampleSizes.push_back( 1e2 ); sampleSizes.push_back( 1e3 );
+  sampleSizes.push_back( 1e4 ); sampleSizes.push_back( 1e5 );
+  const unsigned long nrOfParameters = 1000;
+  const unsigned int  iterations     = 2000;
+
+  MetricTEMP metric;
+  for( unsigned int s = 0; s < sampleSizes.size(); ++s )
+  {
+    std::cout << "Number of samples = " << sampleSizes[ s ] << std::endl;
+    itk::TimeProbesCollectorBase timeCollector;
+
+    /** Spawn-per-call path. */
+    metric.Initialize( sampleSizes[ s ], nrOfParameters, nrThreads );
+    for( unsigned int i = 0; i < iterations; ++i )
+    {
+      timeCollector.Start( "MultiThreader" );
+      threader->SetSingleMethod( MetricTEMP::GetValueAndDerivativeThreaderCallback, &metric );
+      threader->SingleMethodExecute();
+      threader->SetSingleMethod( MetricTEMP::AccumulateDerivativesThreaderCallback, &metric );
+      threader->SingleMethodExecute();
+      timeCollector.Stop( "MultiThreader" );
+    }
+    const double                     valueThreader      = metric.GetValue();
+    const MetricTEMP::DerivativeType derivativeThreader = metric.m_Derivative;
+
+    /** Persistent pool path. */
+    metric.Initialize( sampleSizes[ s ], nrOfParameters, nrThreads );
+    for( unsigned int i = 0; i < iterations; ++i )
+    {
+      timeCollector.Start( "PersistentThreadPool" );
+      pool->SetSingleMethod( MetricTEMP::GetValueAndDerivativeThreaderCallback, &metric );
+      pool->SingleMethodExecute();
+      pool->SetSingleMethod( MetricTEMP::AccumulateDerivativesThreaderCallback, &metric );
+      pool->SingleMethodExecute();
+      timeCollector.Stop( "PersistentThreadPool" );
+    }
+    const double valuePool = metric.GetValue();
+
+    /** Check that both paths give identical results. */
+    if( valuePool != valueThreader || metric.m_Derivative != derivativeThreader )
+    {
+      std::cerr << "ERROR: the PersistentThreadPool gives a different result "
+                << "than the MultiThreader." << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    /** Report timings for this number of samples. */
+    timeCollector.Report();
+    std::cout << std::endl;
+  }
+
+  /** Exceptions in the threads should be passed to the caller. */
+  pool->SetSingleMethod( 0, 0 );
+  try
+  {
+    pool->SingleMethodExecute();
+    std::cerr << "ERROR: no exception thrown for an empty method." << std::endl;
+    return EXIT_FAILURE;
+  }
+  catch( itk::ExceptionObject & )
+  {
+    // expected
+  }
+
+  return EXIT_SUCCESS;
+
+} // end main
@@ -0,0 +1,138 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkPhaseProfiler.h"
+
+#include <iostream>
+#include <sstream>
+
+/** This test checks that the PhaseProfiler records nested phases with
+ * their paths and call counts, that disabled probes record nothing, and
+ * that the JSON and CSV output contain all phases, with all times in
+ * milliseconds.
+ */
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  typedef itk::PhaseProfiler                         ProfilerType;
+  typedef ProfilerType::PhaseStatisticsContainerType PhaseStatisticsContainerType;
+
+  const unsigned int iterations = 10;
+
+  /** Disabled probes should not record anything. */
+  ProfilerType::Reset();
+  ProfilerType::SetEnabled( false );
+  {
+    ProfilerType::ScopedProbe probe( "Disabled" );
+  }
+  if( !ProfilerType::GetPhaseStatistics().empty() )
+  {
+    std::cerr << "ERROR: a disabled probe recorded a phase." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** Mimic the phases of a number of iterations. */
+  ProfilerType::SetEnabled( true );
+  for( unsigned int i = 0; i < iterations; ++i )
+  {
+    {
+      ProfilerType::ScopedProbe probe( "GetValueAndDerivative" );
+      {
+        ProfilerType::ScopedProbe probe2( "BeforeThreadedGetValueAndDerivative" );
+        ProfilerType::ScopedProbe probe3( "ImageSampler" );
+      }
+      ProfilerType::ScopedProbe probe4( "ThreadedGetValueAndDerivative" );
+    }
+    ProfilerType::ScopedProbe probe5( "AdvanceOneStep" );
+    probe5.Stop();
+    ProfilerType::AddPhaseTime( "Iteration", 0.001 );
+  }
+
+  /** Check the phases, which are stored in the order of their first call. */
+  const PhaseStatisticsContainerType phases = ProfilerType::GetPhaseStatistics();
+  const char *                       expectedPaths[] = {
+    "GetValueAndDerivative",
+    "GetValueAndDerivative/BeforeThreadedGetValueAndDerivative",
+    "GetValueAndDerivative/BeforeThreadedGetValueAndDerivative/ImageSampler",
+    "GetValueAndDerivative/ThreadedGetValueAndDerivative",
+    "AdvanceOneStep",
+    "Iteration"
+  };
+  const unsigned int expectedDepths[] = { 0, 1, 2, 1, 0, 0 };
+  const unsigned int numberOfPhases   = 6;
+  if( phases.size() != numberOfPhases )
+  {
+    std::cerr << "ERROR: " << phases.size() << " phases were recorded instead of "
+              << numberOfPhases << "." << std::endl;
+    return EXIT_FAILURE;
+  }
+  for( unsigned int p = 0; p < numberOfPhases; ++p )
+  {
+    if( phases[ p ].m_Path != expectedPaths[ p ]
+      || phases[ p ].m_Depth != expectedDepths[ p ]
+      || phases[ p ].m_NumberOfCalls != iterations
+      || phases[ p ].m_MinimumTime > phases[ p ].m_MaximumTime
+      || phases[ p ].m_TotalTime < 0.0 )
+    {
+      std::cerr << "ERROR: phase " << p << " (" << phases[ p ].m_Path
+                << ") has wrong statistics." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  /** The output should contain all phases. */
+  std::ostringstream json, csv;
+  ProfilerType::WriteJSON( json );
+  ProfilerType::WriteCSV( csv );
+  std::cout << json.str() << std::endl << csv.str() << std::endl;
+  for( unsigned int p = 0; p < numberOfPhases; ++p )
+  {
+    const std::string quotedPath = std::string( "\"" ) + expectedPaths[ p ] + "\"";
+    const std::string csvLine    = std::string( "\n" ) + expectedPaths[ p ] + ",";
+    if( json.str().find( quotedPath ) == std::string::npos
+      || csv.str().find( csvLine ) == std::string::npos )
+    {
+      std::cerr << "ERROR: phase " << expectedPaths[ p ]
+                << " is missing in the output." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  /** All times should be written in milliseconds. */
+  if( json.str().find( "\"total_ms\"" ) == std::string::npos
+    || json.str().find( "_s\"" ) != std::string::npos
+    || csv.str().find( "total_ms," ) == std::string::npos )
+  {
+    std::cerr << "ERROR: the output mixes time units." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** Reset should clear all phases. */
+  ProfilerType::Reset();
+  ProfilerType::SetEnabled( false );
+  if( !ProfilerType::GetPhaseStatistics().empty() )
+  {
+    std::cerr << "ERROR: Reset() did not clear the phases." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+
+} // end main
@@ -0,0 +1,195 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkRayCastResampleImageFilter.h"
+#include "itkAdvancedEuler3DTransform.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+/** This test compares the speed of rendering a DRR with the
+ * ResampleImageFilter, which casts one ray per output pixel, and with the
+ * RayCastResampleImageFilter, which casts the rays in packets. It prints
+ * the number of rays per second, for one and for all threads, and with a
+ * zero and a positive threshold, for which planes of voxels below the
+ * threshold are skipped. It checks that both filters render the same DRR.
+ */
+
+const unsigned int Dimension = 3;
+typedef float                                   PixelType;
+typedef itk::Image< PixelType, Dimension >      ImageType;
+typedef itk::AdvancedEuler3DTransform< double > TransformType;
+typedef itk::AdvancedRayCastInterpolateImageFunction<
+  ImageType, double >                           RayCasterType;
+
+//-------------------------------------------------------------------------------------
+
+/** Render a DRR a number of times, and return the rays per second. */
+
+template< class TResampler >
+double
+Render( ImageType * volume, TransformType * transform, RayCasterType * rayCaster,
+  const ImageType::SizeType & drrSize, const ImageType::PointType & drrOrigin,
+  const ImageType::SpacingType & drrSpacing, const unsigned int numberOfThreads,
+  const unsigned int iterations, ImageType::Pointer & drr )
+{
+  typename TResampler::Pointer resampler = TResampler::New();
+  resampler->SetInput( volume );
+  resampler->SetTransform( transform );
+  resampler->SetInterpolator( rayCaster );
+  resampler->SetSize( drrSize );
+  resampler->SetOutputOrigin( drrOrigin );
+  resampler->SetOutputSpacing( drrSpacing );
+  resampler->SetDefaultPixelValue( 0 );
+  resampler->SetNumberOfThreads( numberOfThreads );
+
+  itk::TimeProbe timer;
+  timer.Start();
+  for( unsigned int i = 0; i < iterations; ++i )
+  {
+    resampler->Modified();
+    resampler->Update();
+  }
+  timer.Stop();
+
+  drr = resampler->GetOutput();
+  drr->DisconnectPipeline();
+
+  const double numberOfRays = static_cast< double >( drrSize[ 0 ] * drrSize[ 1 ] ) * iterations;
+  return numberOfRays / timer.GetMean();
+
+} // end Render()
+
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  typedef itk::ResampleImageFilter< ImageType, ImageType >        ResamplerType;
+  typedef itk::RayCastResampleImageFilter< ImageType, ImageType > RayCastResamplerType;
+
+  /** The number of DRRs to render per setting. */
+  unsigned int iterations = 5;
+  if( argc > 1 )
+  {
+    iterations = atoi( argv[ 1 ] );
+  }
+
+  /** Create a volume with an ellipsoid, in air, centred around the origin. */
+  ImageType::SizeType    volumeSize;
+  ImageType::PointType   volumeOrigin;
+  ImageType::SpacingType volumeSpacing;
+  volumeSize.Fill( 96 );
+  volumeOrigin.Fill( -47.5 );
+  volumeSpacing.Fill( 1.0 );
+  ImageType::Pointer volume = ImageType::New();
+  volume->SetRegions( volumeSize );
+  volume->SetOrigin( volumeOrigin );
+  volume->SetSpacing( volumeSpacing );
+  volume->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( volume, volume->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    ImageType::PointType point;
+    volume->TransformIndexToPhysicalPoint( it.GetIndex(), point );
+    const double r = point[ 0 ] * point[ 0 ] / 900.0
+      + point[ 1 ] * point[ 1 ] / 400.0 + point[ 2 ] * point[ 2 ] / 625.0;
+    const double texture = 20.0 * std::sin( 0.3 * point[ 0 ] ) * std::cos( 0.2 * point[ 1 ] );
+    it.Set( static_cast< PixelType >( r < 1.0 ? 100.0 + texture : 0.0 ) );
+  }
+
+  /** The DRR plane is a single slice behind the volume, the source in front. */
+  ImageType::SizeType    drrSize;
+  ImageType::PointType   drrOrigin;
+  ImageType::SpacingType drrSpacing;
+  drrSize[ 0 ]   = 128; drrSize[ 1 ] = 128; drrSize[ 2 ] = 1;
+  drrOrigin[ 0 ] = -95.25; drrOrigin[ 1 ] = -95.25; drrOrigin[ 2 ] = -200.0;
+  drrSpacing.Fill( 1.5 );
+
+  TransformType::Pointer        transform = TransformType::New();
+  TransformType::InputPointType center;
+  center.Fill( 0.0 );
+  transform->SetCenter( center );
+  TransformType::ParametersType parameters( transform->GetNumberOfParameters() );
+  parameters.Fill( 0.0 );
+  parameters[ 0 ] = 0.1; parameters[ 1 ] = -0.05; parameters[ 2 ] = 0.2;
+  parameters[ 3 ] = 2.0; parameters[ 4 ] = -1.0;  parameters[ 5 ] = 0.5;
+  transform->SetParameters( parameters );
+
+  RayCasterType::Pointer        rayCaster = RayCasterType::New();
+  RayCasterType::InputPointType focalPoint;
+  focalPoint[ 0 ] = 0.0; focalPoint[ 1 ] = 0.0; focalPoint[ 2 ] = 500.0;
+  rayCaster->SetTransform( transform );
+  rayCaster->SetFocalPoint( focalPoint );
+
+  const unsigned int threads[] = { 1, itk::MultiThreader::GetGlobalDefaultNumberOfThreads() };
+  const unsigned int numberOfThreadSettings = threads[ 1 ] > 1 ? 2 : 1;
+  const double       thresholds[] = { 0.0, 50.0 };
+
+  std::cout << "Rendering " << iterations << " DRRs of " << drrSize[ 0 ] << "x" << drrSize[ 1 ]
+            << " rays through a volume of " << volumeSize[ 0 ] << "^3 voxels." << std::endl;
+  std::cout << std::fixed << std::setprecision( 0 );
+
+  for( unsigned int t = 0; t < 2; ++t )
+  {
+    rayCaster->SetThreshold( thresholds[ t ] );
+
+    for( unsigned int n = 0; n < numberOfThreadSettings; ++n )
+    {
+      const unsigned int numberOfThreads = threads[ n ];
+      ImageType::Pointer drr, packetDRR;
+      const double       raysPerSecond = Render< ResamplerType >( volume, transform, rayCaster,
+        drrSize, drrOrigin, drrSpacing, numberOfThreads, iterations, drr );
+      const double packetRaysPerSecond = Render< RayCastResamplerType >( volume, transform, rayCaster,
+        drrSize, drrOrigin, drrSpacing, numberOfThreads, iterations, packetDRR );
+
+      std::cout << "threshold " << std::setw( 3 ) << thresholds[ t ]
+                << ", " << std::setw( 2 ) << numberOfThreads << " thread(s): "
+                << "per ray " << std::setw( 10 ) << raysPerSecond << " rays/s, "
+                << "packets " << std::setw( 10 ) << packetRaysPerSecond << " rays/s, "
+                << "speedup " << std::setprecision( 2 ) << packetRaysPerSecond / raysPerSecond
+                << std::setprecision( 0 ) << std::endl;
+
+      /** Both filters should render the same DRR, up to rounding. */
+      itk::ImageRegionConstIterator< ImageType > it1( drr, drr->GetLargestPossibleRegion() );
+      itk::ImageRegionConstIterator< ImageType > it2( packetDRR, packetDRR->GetLargestPossibleRegion() );
+      double                                     maxValue = 0.0, maxDifference = 0.0;
+      for( ; !it1.IsAtEnd(); ++it1, ++it2 )
+      {
+        maxValue      = std::max( maxValue, static_cast< double >( std::abs( it1.Get() ) ) );
+        maxDifference = std::max( maxDifference,
+          static_cast< double >( std::abs( it1.Get() - it2.Get() ) ) );
+      }
+      if( maxValue == 0.0 || maxDifference > 1e-4 * maxValue )
+      {
+        std::cerr << std::scientific << "ERROR: the DRRs differ, maximum difference "
+                  << maxDifference << " for a maximum value of " << maxValue << "." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+
+} // end main
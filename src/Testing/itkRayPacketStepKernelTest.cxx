@@ -0,0 +1,253 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkRayPacketStepKernel.h"
+#include "itkAdvancedRayCastInterpolateImageFunction.h"
+#include "itkAdvancedEuler3DTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+/** This test checks the RayPacketStepKernel, in the variant that the compiler
+ * selects (AVX, SSE2 or scalar), and the EvaluateRays() of the
+ * AdvancedRayCastInterpolateImageFunction that uses it:
+ * \li the kernel steps random ray states to exactly the positions and voxel
+ *   steps of a scalar reference, also for positions on and around integers
+ *   and for negative positions;
+ * \li EvaluateRays() gives the same values as the per-ray Evaluate() for
+ *   random rays, including rays that miss the volume and a number of rays
+ *   that is not a multiple of the packet size, with a zero threshold and
+ *   with thresholds for which planes of voxels are skipped and rays are
+ *   terminated early.
+ */
+
+const unsigned int Dimension = 3;
+typedef float                                   PixelType;
+typedef itk::Image< PixelType, Dimension >      ImageType;
+typedef itk::AdvancedEuler3DTransform< double > TransformType;
+typedef itk::AdvancedRayCastInterpolateImageFunction<
+  ImageType, double >                           RayCasterType;
+typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomNumberGeneratorType;
+
+//-------------------------------------------------------------------------------------
+
+/** Step random packets of rays with the kernel and with scalar code. */
+
+bool
+TestKernel( RandomNumberGeneratorType * randomNum )
+{
+  const unsigned int NumberOfLanes = RayCasterType::RayPacketSize;
+  typedef itk::RayPacketStepKernel< NumberOfLanes > KernelType;
+
+  double position[ 3 ][ NumberOfLanes ];
+  double increment[ 3 ][ NumberOfLanes ];
+  int    step[ 3 ][ NumberOfLanes ];
+  double referencePosition[ 3 ][ NumberOfLanes ];
+
+  for( unsigned int packet = 0; packet < 1000; ++packet )
+  {
+    /** Random ray states. Some packets start on integers and step by
+     * integers or halves, so that the truncation hits its edge cases.
+     */
+    const bool onIntegers = packet % 4 == 0;
+    for( unsigned int i = 0; i < 3; ++i )
+    {
+      for( unsigned int lane = 0; lane < NumberOfLanes; ++lane )
+      {
+        if( onIntegers )
+        {
+          position[ i ][ lane ]  = std::floor( randomNum->GetUniformVariate( -4.0, 100.0 ) );
+          increment[ i ][ lane ] = 0.5 * std::floor( randomNum->GetUniformVariate( -4.0, 5.0 ) );
+        }
+        else
+        {
+          position[ i ][ lane ]  = randomNum->GetUniformVariate( -4.0, 100.0 );
+          increment[ i ][ lane ] = randomNum->GetUniformVariate( -1.5, 1.5 );
+        }
+        referencePosition[ i ][ lane ] = position[ i ][ lane ];
+      }
+    }
+
+    for( unsigned int s = 0; s < 50; ++s )
+    {
+      KernelType::Step( position, increment, step );
+
+      for( unsigned int i = 0; i < 3; ++i )
+      {
+        for( unsigned int lane = 0; lane < NumberOfLanes; ++lane )
+        {
+          const double before = referencePosition[ i ][ lane ];
+          referencePosition[ i ][ lane ] += increment[ i ][ lane ];
+          const int referenceStep = static_cast< int >( referencePosition[ i ][ lane ] )
+            - static_cast< int >( before );
+
+          if( position[ i ][ lane ] != referencePosition[ i ][ lane ]
+            || step[ i ][ lane ] != referenceStep )
+          {
+            std::cerr << "ERROR: packet " << packet << ", step " << s << ", axis " << i
+                      << ", lane " << lane << ": the kernel gives position "
+                      << position[ i ][ lane ] << " and step " << step[ i ][ lane ]
+                      << ", instead of " << referencePosition[ i ][ lane ]
+                      << " and " << referenceStep << "." << std::endl;
+            return false;
+          }
+        }
+      }
+    }
+  }
+
+  return true;
+
+} // end TestKernel()
+
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  RandomNumberGeneratorType::Pointer randomNum = RandomNumberGeneratorType::GetInstance();
+  randomNum->SetSeed( 1234 );
+
+#if defined( ELX_RAY_PACKET_KERNEL_USE_AVX )
+  std::cout << "Testing the AVX kernel." << std::endl;
+#elif defined( ELX_RAY_PACKET_KERNEL_USE_SSE2 )
+  std::cout << "Testing the SSE2 kernel." << std::endl;
+#else
+  std::cout << "Testing the scalar kernel." << std::endl;
+#endif
+
+  if( !TestKernel( randomNum ) )
+  {
+    return EXIT_FAILURE;
+  }
+
+  /** Create a volume with an ellipsoid of random intensities, in air, and a
+   * bright block, so that with a high threshold only the planes of the block
+   * are integrated.
+   */
+  ImageType::SizeType    volumeSize;
+  ImageType::PointType   volumeOrigin;
+  ImageType::SpacingType volumeSpacing;
+  volumeSize.Fill( 48 );
+  volumeOrigin.Fill( -23.5 );
+  volumeSpacing.Fill( 1.0 );
+  ImageType::Pointer volume = ImageType::New();
+  volume->SetRegions( volumeSize );
+  volume->SetOrigin( volumeOrigin );
+  volume->SetSpacing( volumeSpacing );
+  volume->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( volume, volume->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    const ImageType::IndexType index = it.GetIndex();
+    ImageType::PointType       point;
+    volume->TransformIndexToPhysicalPoint( index, point );
+    const double r = point[ 0 ] * point[ 0 ] / 400.0
+      + point[ 1 ] * point[ 1 ] / 225.0 + point[ 2 ] * point[ 2 ] / 324.0;
+    bool inBlock = true;
+    for( unsigned int d = 0; d < Dimension; ++d )
+    {
+      inBlock &= index[ d ] >= 18 && index[ d ] < 26;
+    }
+    double value = r < 1.0 ? randomNum->GetUniformVariate( 50.0, 100.0 ) : 0.0;
+    if( inBlock )
+    {
+      value = 200.0;
+    }
+    it.Set( static_cast< PixelType >( value ) );
+  }
+
+  /** A random rigid transform and a focal point in front of the volume. */
+  TransformType::Pointer        transform = TransformType::New();
+  TransformType::InputPointType center;
+  center.Fill( 0.0 );
+  transform->SetCenter( center );
+  TransformType::ParametersType parameters( transform->GetNumberOfParameters() );
+  for( unsigned int i = 0; i < 3; ++i )
+  {
+    parameters[ i ]     = randomNum->GetUniformVariate( -0.3, 0.3 );
+    parameters[ i + 3 ] = randomNum->GetUniformVariate( -3.0, 3.0 );
+  }
+  transform->SetParameters( parameters );
+
+  RayCasterType::Pointer        rayCaster = RayCasterType::New();
+  RayCasterType::InputPointType focalPoint;
+  focalPoint[ 0 ] = 0.0; focalPoint[ 1 ] = 0.0; focalPoint[ 2 ] = 300.0;
+  rayCaster->SetInputImage( volume );
+  rayCaster->SetTransform( transform );
+  rayCaster->SetFocalPoint( focalPoint );
+
+  /** Random points behind the volume; the outer rays miss it. The number of
+   * rays is not a multiple of the packet size.
+   */
+  const unsigned int                     numberOfRays = 2003;
+  std::vector< RayCasterType::PointType > points( numberOfRays );
+  for( unsigned int i = 0; i < numberOfRays; ++i )
+  {
+    points[ i ][ 0 ] = randomNum->GetUniformVariate( -60.0, 60.0 );
+    points[ i ][ 1 ] = randomNum->GetUniformVariate( -60.0, 60.0 );
+    points[ i ][ 2 ] = randomNum->GetUniformVariate( -150.0, -100.0 );
+  }
+
+  /** Compare EvaluateRays() with Evaluate() for a zero threshold, for a
+   * threshold within the ellipsoid, and for a threshold for which only the
+   * block is integrated.
+   */
+  const double thresholds[] = { 0.0, 75.0, 150.0 };
+  for( unsigned int t = 0; t < 3; ++t )
+  {
+    rayCaster->SetThreshold( thresholds[ t ] );
+
+    std::vector< RayCasterType::OutputType > values( numberOfRays );
+    rayCaster->EvaluateRays( &points[ 0 ], numberOfRays, &values[ 0 ] );
+
+    double       maxValue = 0.0, maxDifference = 0.0;
+    unsigned int numberOfHits = 0;
+    for( unsigned int i = 0; i < numberOfRays; ++i )
+    {
+      const double reference = rayCaster->Evaluate( points[ i ] );
+      maxValue      = std::max( maxValue, std::abs( reference ) );
+      maxDifference = std::max( maxDifference,
+        static_cast< double >( std::abs( values[ i ] - reference ) ) );
+      if( reference != 0.0 )
+      {
+        ++numberOfHits;
+      }
+    }
+
+    std::cout << "threshold " << thresholds[ t ] << ": " << numberOfHits << " of "
+              << numberOfRays << " rays hit, maximum value " << maxValue
+              << ", maximum difference " << maxDifference << std::endl;
+
+    if( numberOfHits == 0 || numberOfHits == numberOfRays
+      || maxDifference > 1e-4 * maxValue )
+    {
+      std::cerr << "ERROR: EvaluateRays() differs from Evaluate() for threshold "
+                << thresholds[ t ] << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+
+} // end main
@@ -0,0 +1,180 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "RigidityPenalty/itkTransformRigidityPenaltyTerm.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+/** This test checks that the multi-threaded GetValueAndDerivative() of the
+ * TransformRigidityPenaltyTerm gives the same value and derivative as the
+ * single-threaded implementation, both for a rigid block in the moving image
+ * and for a completely rigid image. The multi-threaded version fuses the
+ * filtering and only visits the nonzero rigidity coefficients, so the
+ * results should be equal up to rounding. It also prints the time of both.
+ */
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  /** Some basic type definitions. */
+  const unsigned int Dimension   = 3;
+  const unsigned int SplineOrder = 3;
+  typedef float                                       PixelType;
+  typedef itk::Image< PixelType, Dimension >          ImageType;
+  typedef itk::TransformRigidityPenaltyTerm<
+    ImageType, double >                               MetricType;
+  typedef MetricType::RigidityImageType               RigidityImageType;
+  typedef itk::AdvancedBSplineDeformableTransform<
+    double, Dimension, SplineOrder >                  TransformType;
+  typedef itk::LinearInterpolateImageFunction<
+    ImageType, double >                               InterpolatorType;
+  typedef MetricType::ParametersType                  ParametersType;
+  typedef MetricType::DerivativeType                  DerivativeType;
+  typedef MetricType::MeasureType                     MeasureType;
+
+  /** Create a fixed and moving image, which are only needed for the initialization. */
+  ImageType::SizeType size;
+  size.Fill( 40 );
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  image->FillBuffer( 0.0f );
+
+  /** Create a moving rigidity image with a rigid block. */
+  RigidityImageType::Pointer rigidityImage = RigidityImageType::New();
+  rigidityImage->SetRegions( size );
+  rigidityImage->Allocate();
+  itk::ImageRegionIteratorWithIndex< RigidityImageType > it(
+    rigidityImage, rigidityImage->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    const RigidityImageType::IndexType index = it.GetIndex();
+    bool                               inside = true;
+    for( unsigned int d = 0; d < Dimension; ++d )
+    {
+      inside &= index[ d ] >= 12 && index[ d ] < 26;
+    }
+    it.Set( inside ? 1.0 : 0.0 );
+  }
+
+  /** Create a B-spline transform with some deformation. */
+  TransformType::Pointer              transform = TransformType::New();
+  TransformType::RegionType::SizeType gridSize;
+  TransformType::SpacingType          gridSpacing;
+  TransformType::OriginType           gridOrigin;
+  gridSize.Fill( 14 );
+  gridSpacing.Fill( 4.0 );
+  gridOrigin.Fill( -6.0 );
+  TransformType::RegionType gridRegion;
+  gridRegion.SetSize( gridSize );
+  transform->SetGridRegion( gridRegion );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridOrigin( gridOrigin );
+
+  ParametersType parameters( transform->GetNumberOfParameters() );
+  for( unsigned int i = 0; i < parameters.GetSize(); ++i )
+  {
+    parameters[ i ] = 0.8 * std::sin( 0.37 * i ) + 0.3 * std::cos( 1.3 * i );
+  }
+  transform->SetParameters( parameters );
+
+  /** The settings of the variants to test: a rigid block or everything rigid.
+   * For each setting the single-threaded version is the reference.
+   */
+  const bool         useRigidityImage[] = { true, false };
+  const char *       names[]            = { "rigid block", "all rigid" };
+  const unsigned int numberOfSettings   = 2;
+
+  for( unsigned int s = 0; s < numberOfSettings; ++s )
+  {
+    MeasureType    value[ 2 ];
+    DerivativeType derivative[ 2 ];
+    MeasureType    conditionValues[ 2 ][ 6 ];
+    for( unsigned int v = 0; v < 2; ++v )
+    {
+      MetricType::Pointer metric = MetricType::New();
+      metric->SetFixedImage( image );
+      metric->SetMovingImage( image );
+      metric->SetFixedImageRegion( image->GetLargestPossibleRegion() );
+      metric->SetTransform( transform );
+      metric->SetInterpolator( InterpolatorType::New() );
+      metric->SetUseFixedRigidityImage( false );
+      metric->SetUseMovingRigidityImage( useRigidityImage[ s ] );
+      metric->SetMovingRigidityImage( rigidityImage );
+      metric->SetDilateRigidityImages( false );
+      metric->SetLinearityConditionWeight( 2.0 );
+      metric->SetOrthonormalityConditionWeight( 1.0 );
+      metric->SetPropernessConditionWeight( 3.0 );
+      metric->SetUseMultiThread( v == 1 );
+      metric->Initialize();
+
+      itk::TimeProbe timer;
+      timer.Start();
+      metric->GetValueAndDerivative( parameters, value[ v ], derivative[ v ] );
+      timer.Stop();
+
+      conditionValues[ v ][ 0 ] = metric->GetLinearityConditionValue();
+      conditionValues[ v ][ 1 ] = metric->GetOrthonormalityConditionValue();
+      conditionValues[ v ][ 2 ] = metric->GetPropernessConditionValue();
+      conditionValues[ v ][ 3 ] = metric->GetLinearityConditionGradientMagnitude();
+      conditionValues[ v ][ 4 ] = metric->GetOrthonormalityConditionGradientMagnitude();
+      conditionValues[ v ][ 5 ] = metric->GetPropernessConditionGradientMagnitude();
+
+      std::cout << names[ s ] << ( v == 1 ? ", multi-threaded" : ", single-threaded" )
+                << ": value " << value[ v ] << ", time " << timer.GetMean() << " s" << std::endl;
+    }
+
+    /** Compare the values, the condition values and the derivatives. */
+    const double tolerance     = 1e-10;
+    double       maxDifference = 0.0;
+    double       maxDerivative = 0.0;
+    for( unsigned int i = 0; i < derivative[ 0 ].GetSize(); ++i )
+    {
+      maxDifference = std::max( maxDifference, std::abs( derivative[ 0 ][ i ] - derivative[ 1 ][ i ] ) );
+      maxDerivative = std::max( maxDerivative, std::abs( derivative[ 0 ][ i ] ) );
+    }
+    bool conditionValuesEqual = true;
+    for( unsigned int j = 0; j < 6; ++j )
+    {
+      conditionValuesEqual &= std::abs( conditionValues[ 0 ][ j ] - conditionValues[ 1 ][ j ] )
+        <= tolerance * std::abs( conditionValues[ 0 ][ j ] );
+    }
+
+    std::cout << names[ s ] << ": maximum derivative difference " << maxDifference
+              << ", maximum derivative " << maxDerivative << std::endl;
+
+    if( maxDerivative == 0.0 || !conditionValuesEqual
+      || std::abs( value[ 0 ] - value[ 1 ] ) > tolerance * std::abs( value[ 0 ] )
+      || maxDifference > tolerance * maxDerivative )
+    {
+      std::cerr << "ERROR: the multi-threaded version differs for the setting "
+                << names[ s ] << "." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+
+} // end main
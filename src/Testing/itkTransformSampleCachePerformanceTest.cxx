@@ -0,0 +1,192 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "MultiMetricMultiResolutionRegistration/itkCombinationImageToImageMetric.h"
+#include "AdvancedMattesMutualInformation/itkParzenWindowMutualInformationImageToImageMetric.h"
+#include "AdvancedMeanSquares/itkAdvancedMeanSquaresImageToImageMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkExponentialLimiterFunction.h"
+#include "itkHardLimiterFunction.h"
+#include "itkImageGridSampler.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+/** This test compares a combination of a Mattes mutual information and a
+ * mean squares metric, that share an image sampler and a B-spline
+ * transform, with and without the TransformSampleCache. Both variants
+ * must give the same value and derivative; the time per iteration of
+ * each variant is printed. The number of iterations can be passed as the
+ * first argument.
+ */
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  /** Some basic type definitions. */
+  const unsigned int Dimension   = 3;
+  const unsigned int SplineOrder = 3;
+  typedef float                                          PixelType;
+  typedef itk::Image< PixelType, Dimension >             ImageType;
+  typedef itk::CombinationImageToImageMetric<
+    ImageType, ImageType >                               CombinationMetricType;
+  typedef itk::ParzenWindowMutualInformationImageToImageMetric<
+    ImageType, ImageType >                               MattesMetricType;
+  typedef itk::AdvancedMeanSquaresImageToImageMetric<
+    ImageType, ImageType >                               MeanSquaresMetricType;
+  typedef itk::AdvancedBSplineDeformableTransform<
+    double, Dimension, SplineOrder >                     TransformType;
+  typedef itk::BSplineInterpolateImageFunction<
+    ImageType, double, double >                          InterpolatorType;
+  typedef itk::ImageGridSampler< ImageType >             SamplerType;
+  typedef itk::HardLimiterFunction<
+    MattesMetricType::RealType, Dimension >              FixedLimiterType;
+  typedef itk::ExponentialLimiterFunction<
+    MattesMetricType::RealType, Dimension >              MovingLimiterType;
+  typedef CombinationMetricType::TransformParametersType ParametersType;
+  typedef CombinationMetricType::DerivativeType          DerivativeType;
+  typedef CombinationMetricType::MeasureType             MeasureType;
+
+  unsigned int numberOfIterations = 10;
+  if( argc > 1 )
+  {
+    numberOfIterations = static_cast< unsigned int >( std::atoi( argv[ 1 ] ) );
+  }
+
+  /** Create a fixed and a moving image. */
+  ImageType::SizeType size;
+  size.Fill( 32 );
+  ImageType::Pointer fixedImage  = ImageType::New();
+  ImageType::Pointer movingImage = ImageType::New();
+  fixedImage->SetRegions( size );
+  fixedImage->Allocate();
+  movingImage->SetRegions( size );
+  movingImage->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > fit( fixedImage, fixedImage->GetLargestPossibleRegion() );
+  itk::ImageRegionIteratorWithIndex< ImageType > mit( movingImage, movingImage->GetLargestPossibleRegion() );
+  for( fit.GoToBegin(), mit.GoToBegin(); !fit.IsAtEnd(); ++fit, ++mit )
+  {
+    const ImageType::IndexType index = fit.GetIndex();
+    const double               dx    = index[ 0 ] - 15.0;
+    const double               dy    = index[ 1 ] - 16.0;
+    const double               dz    = index[ 2 ] - 17.0;
+    const double               r2    = dx * dx + dy * dy + dz * dz;
+    fit.Set( static_cast< PixelType >( 100.0 * std::exp( -r2 / 80.0 ) ) );
+    mit.Set( static_cast< PixelType >( 100.0 * std::exp( -( r2 + 0.3 * dx * dy ) / 70.0 ) ) );
+  }
+
+  /** Create a B-spline transform with some deformation. */
+  TransformType::Pointer              transform = TransformType::New();
+  TransformType::RegionType::SizeType gridSize;
+  TransformType::SpacingType          gridSpacing;
+  TransformType::OriginType           gridOrigin;
+  gridSize.Fill( 8 );
+  gridSpacing.Fill( 6.0 );
+  gridOrigin.Fill( -6.0 );
+  TransformType::RegionType gridRegion;
+  gridRegion.SetSize( gridSize );
+  transform->SetGridRegion( gridRegion );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridOrigin( gridOrigin );
+
+  ParametersType parameters( transform->GetNumberOfParameters() );
+  for( unsigned int i = 0; i < parameters.GetSize(); ++i )
+  {
+    parameters[ i ] = 0.5 * std::sin( 0.23 * i );
+  }
+  transform->SetParameters( parameters );
+
+  /** Evaluate the combination without and with the cache. */
+  const bool         useCache[] = { false, true };
+  const char *       names[]    = { "without cache", "with cache" };
+  MeasureType        value[ 2 ];
+  DerivativeType     derivative[ 2 ];
+  double             time[ 2 ];
+  for( unsigned int v = 0; v < 2; ++v )
+  {
+    /** Both metrics use the same sampler. */
+    SamplerType::Pointer sampler = SamplerType::New();
+    SamplerType::SampleGridSpacingType samplingGridSpacing;
+    samplingGridSpacing.Fill( 2 );
+    sampler->SetSampleGridSpacing( samplingGridSpacing );
+
+    MattesMetricType::Pointer mattes = MattesMetricType::New();
+    mattes->SetImageSampler( sampler );
+    mattes->SetFixedImageLimiter( FixedLimiterType::New() );
+    mattes->SetMovingImageLimiter( MovingLimiterType::New() );
+    mattes->SetNumberOfFixedHistogramBins( 32 );
+    mattes->SetNumberOfMovingHistogramBins( 32 );
+    mattes->SetUseExplicitPDFDerivatives( false );
+
+    MeanSquaresMetricType::Pointer meanSquares = MeanSquaresMetricType::New();
+    meanSquares->SetImageSampler( sampler );
+
+    CombinationMetricType::Pointer combo = CombinationMetricType::New();
+    combo->SetNumberOfMetrics( 2 );
+    combo->SetMetric( mattes, 0 );
+    combo->SetMetric( meanSquares, 1 );
+    combo->SetMetricWeight( 1.0, 0 );
+    combo->SetMetricWeight( 0.01, 1 );
+    combo->SetFixedImage( fixedImage );
+    combo->SetMovingImage( movingImage );
+    combo->SetFixedImageRegion( fixedImage->GetLargestPossibleRegion() );
+    combo->SetTransform( transform );
+    combo->SetInterpolator( InterpolatorType::New() );
+    combo->SetUseTransformSampleCache( useCache[ v ] );
+    combo->Initialize();
+
+    itk::TimeProbe timer;
+    for( unsigned int it = 0; it < numberOfIterations; ++it )
+    {
+      timer.Start();
+      combo->GetValueAndDerivative( parameters, value[ v ], derivative[ v ] );
+      timer.Stop();
+    }
+    time[ v ] = timer.GetMean();
+
+    std::cout << names[ v ] << ": value " << value[ v ]
+              << ", time " << time[ v ] << " s per iteration" << std::endl;
+  }
+  std::cout << "speedup: " << time[ 0 ] / time[ 1 ] << std::endl;
+
+  /** Compare the results. */
+  const double tolerance     = 1e-10;
+  double       maxDifference = 0.0;
+  double       maxDerivative = 0.0;
+  for( unsigned int i = 0; i < derivative[ 0 ].GetSize(); ++i )
+  {
+    maxDifference = std::max( maxDifference, std::abs( derivative[ 0 ][ i ] - derivative[ 1 ][ i ] ) );
+    maxDerivative = std::max( maxDerivative, std::abs( derivative[ 0 ][ i ] ) );
+  }
+  if( maxDerivative == 0.0
+    || std::abs( value[ 0 ] - value[ 1 ] ) > tolerance * std::abs( value[ 0 ] )
+    || maxDifference > tolerance * maxDerivative )
+  {
+    std::cerr << "ERROR: the results with and without cache differ." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+
+} // end main
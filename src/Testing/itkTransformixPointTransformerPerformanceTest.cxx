@@ -0,0 +1,189 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkTransformixPointTransformer.h"
+#include "itkTransformixInputPointFileReader.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkImage.h"
+#include "itkPointSet.h"
+#include "itkDefaultStaticMeshTraits.h"
+#include "itkMultiThreader.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+/** This test measures the number of points per second that transformix
+ * transforms and writes to an outputpoints.txt file, with one thread and
+ * with the default number of threads. A large point file is generated,
+ * read with the TransformixInputPointFileReader, and transformed with a
+ * 3D B-spline transform. The outputs of both runs should be identical,
+ * and equal to the result of TransformPoint().
+ */
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  /** Check. */
+  if( argc != 2 )
+  {
+    std::cerr << "ERROR: You should specify an output directory." << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string outputDirectory = argv[ 1 ];
+
+  /** Typedefs. */
+  const unsigned int Dimension = 3;
+  typedef itk::Image< short, Dimension >               ImageType;
+  typedef ImageType::RegionType                        RegionType;
+  typedef ImageType::SizeType                          SizeType;
+  typedef ImageType::SpacingType                       SpacingType;
+  typedef ImageType::PointType                         OriginType;
+  typedef ImageType::DirectionType                     DirectionType;
+  typedef ImageType::IndexType                         IndexType;
+  typedef itk::AdvancedBSplineDeformableTransform< double, Dimension, 3 > TransformType;
+  typedef TransformType::ParametersType                ParametersType;
+  typedef TransformType::InputPointType                InputPointType;
+  typedef itk::TransformixPointTransformer<
+    TransformType, ImageType, ImageType >              PointTransformerType;
+  typedef itk::DefaultStaticMeshTraits<
+    bool, Dimension, Dimension, double >               MeshTraitsType;
+  typedef itk::PointSet< bool, Dimension, MeshTraitsType > PointSetType;
+  typedef itk::TransformixInputPointFileReader< PointSetType > ReaderType;
+
+  /** The number of points. Distinguish between Debug and Release mode. */
+#ifndef NDEBUG
+  const unsigned long numberOfPoints = 10000;
+#else
+  const unsigned long numberOfPoints = 1000000;
+#endif
+
+  /** The fixed image domain, 128^3 voxels of 1 mm. */
+  SizeType imageSize; imageSize.Fill( 128 );
+  RegionType         region; region.SetSize( imageSize );
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( region );
+
+  /** Setup a B-spline transform with a grid spacing of 8 mm. */
+  TransformType::Pointer transform = TransformType::New();
+  SizeType               gridSize; gridSize.Fill( 128 / 8 + 3 );
+  RegionType             gridRegion; gridRegion.SetSize( gridSize );
+  SpacingType            gridSpacing; gridSpacing.Fill( 8.0 );
+  OriginType             gridOrigin; gridOrigin.Fill( -8.0 );
+  DirectionType          gridDirection; gridDirection.SetIdentity();
+  transform->SetGridOrigin( gridOrigin );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridRegion( gridRegion );
+  transform->SetGridDirection( gridDirection );
+
+  ParametersType parameters( transform->GetNumberOfParameters() );
+  for( unsigned int i = 0; i < parameters.GetSize(); ++i )
+  {
+    parameters[ i ] = 2.0 * vcl_sin( 0.1 * static_cast< double >( i ) );
+  }
+  transform->SetParameters( parameters );
+
+  /** Generate the input point file. */
+  const std::string inputFileName = outputDirectory + "/TransformixPointTransformerInputPoints.txt";
+  {
+    std::ofstream inputFile( inputFileName.c_str() );
+    inputFile << "point\n" << numberOfPoints << "\n";
+    inputFile << std::setprecision( 10 );
+    for( unsigned long j = 0; j < numberOfPoints; ++j )
+    {
+      for( unsigned int i = 0; i < Dimension; ++i )
+      {
+        inputFile << 63.5 + 60.0 * vcl_sin( 0.37 * j + 1.3 * i ) << " ";
+      }
+      inputFile << "\n";
+    }
+  }
+
+  /** Read the point file, and compute the input indices. */
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( inputFileName.c_str() );
+  reader->Update();
+  PointSetType::Pointer            pointSet = reader->GetOutput();
+  std::vector< InputPointType >    inputPoints( numberOfPoints );
+  std::vector< IndexType >         inputIndices( numberOfPoints );
+  for( unsigned long j = 0; j < numberOfPoints; ++j )
+  {
+    pointSet->GetPoint( j, &inputPoints[ j ] );
+    image->TransformPhysicalPointToIndex( inputPoints[ j ], inputIndices[ j ] );
+  }
+
+  /** Transform and write with one thread and with all threads. */
+  const itk::ThreadIdType numberOfThreads[ 2 ]
+    = { 1, itk::MultiThreader::GetGlobalDefaultNumberOfThreads() };
+  std::string output[ 2 ];
+  std::cout << std::fixed << std::setprecision( 0 );
+  for( unsigned int run = 0; run < 2; ++run )
+  {
+    PointTransformerType::Pointer pointTransformer = PointTransformerType::New();
+    pointTransformer->SetTransform( transform );
+    pointTransformer->SetFixedImage( image );
+    pointTransformer->SetMovingImage( image );
+    pointTransformer->SetNumberOfThreads( numberOfThreads[ run ] );
+    pointTransformer->SetInput( inputPoints, inputIndices );
+
+    itk::TimeProbe     transformProbe, writeProbe;
+    std::ostringstream outputStream;
+    transformProbe.Start();
+    pointTransformer->TransformPoints();
+    transformProbe.Stop();
+    writeProbe.Start();
+    pointTransformer->WriteOutputPoints( outputStream );
+    writeProbe.Stop();
+    output[ run ] = outputStream.str();
+
+    std::cout << "Threads: " << numberOfThreads[ run ]
+              << "\n  transform: " << numberOfPoints / transformProbe.GetMean() << " points/s"
+              << "\n  write:     " << numberOfPoints / writeProbe.GetMean() << " points/s"
+              << "\n  total:     " << numberOfPoints
+      / ( transformProbe.GetMean() + writeProbe.GetMean() ) << " points/s" << std::endl;
+
+    /** Check the transformed points against TransformPoint(). */
+    for( unsigned long j = 0; j < numberOfPoints; j += 97 )
+    {
+      if( pointTransformer->GetOutputPoints()[ j ]
+        .EuclideanDistanceTo( transform->TransformPoint( inputPoints[ j ] ) ) > 1e-10 )
+      {
+        std::cerr << "ERROR: point " << j << " is transformed incorrectly." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  /** The output should not depend on the number of threads. */
+  if( output[ 0 ] != output[ 1 ] )
+  {
+    std::cerr << "ERROR: the output depends on the number of threads." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  /** Write the output, as transformix would. */
+  std::ofstream outputFile( ( outputDirectory + "/TransformixPointTransformerOutputPoints.txt" ).c_str() );
+  outputFile << output[ 1 ];
+
+  return EXIT_SUCCESS;
+
+} // end main
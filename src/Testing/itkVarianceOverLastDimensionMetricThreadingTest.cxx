@@ -0,0 +1,153 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "VarianceOverLastDimension/itkVarianceOverLastDimensionImageMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkImageFullSampler.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+/** This test checks that the multi-threaded GetValueAndDerivative() of the
+ * VarianceOverLastDimensionImageMetric gives the same value and derivative
+ * as the single-threaded implementation, with and without random sampling
+ * of the last dimension and subtraction of the mean derivative. Only the
+ * order of the summation differs, so the results should be equal up to
+ * rounding.
+ */
+
+//-------------------------------------------------------------------------------------
+
+int
+main( int argc, char * argv[] )
+{
+  /** Some basic type definitions: a 2D image series. */
+  const unsigned int Dimension   = 3;
+  const unsigned int SplineOrder = 3;
+  typedef float                               PixelType;
+  typedef itk::Image< PixelType, Dimension >  ImageType;
+  typedef itk::VarianceOverLastDimensionImageMetric<
+    ImageType, ImageType >                    MetricType;
+  typedef itk::AdvancedBSplineDeformableTransform<
+    double, Dimension, SplineOrder >          TransformType;
+  typedef itk::BSplineInterpolateImageFunction<
+    ImageType, double, double >               InterpolatorType;
+  typedef itk::ImageFullSampler< ImageType >  SamplerType;
+  typedef MetricType::TransformParametersType ParametersType;
+  typedef MetricType::DerivativeType          DerivativeType;
+  typedef MetricType::MeasureType             MeasureType;
+
+  /** Create an image series with a moving blob. */
+  ImageType::SizeType size;
+  size[ 0 ] = 24; size[ 1 ] = 24; size[ 2 ] = 6;
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions( size );
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex< ImageType > it( image, image->GetLargestPossibleRegion() );
+  for( it.GoToBegin(); !it.IsAtEnd(); ++it )
+  {
+    const ImageType::IndexType index = it.GetIndex();
+    const double               dx    = index[ 0 ] - 10.0 - 0.5 * index[ 2 ];
+    const double               dy    = index[ 1 ] - 12.0 + 0.3 * index[ 2 ];
+    it.Set( static_cast< PixelType >( 100.0 * std::exp( -( dx * dx + dy * dy ) / 30.0 ) ) );
+  }
+
+  /** Create a B-spline transform with some deformation. */
+  TransformType::Pointer                transform = TransformType::New();
+  TransformType::RegionType::SizeType   gridSize;
+  TransformType::SpacingType            gridSpacing;
+  TransformType::OriginType             gridOrigin;
+  gridSize[ 0 ]    = 10; gridSize[ 1 ] = 10; gridSize[ 2 ] = 10;
+  gridSpacing[ 0 ] = 4.0; gridSpacing[ 1 ] = 4.0; gridSpacing[ 2 ] = 1.0;
+  gridOrigin[ 0 ]  = -6.0; gridOrigin[ 1 ] = -6.0; gridOrigin[ 2 ] = -2.0;
+  TransformType::RegionType gridRegion;
+  gridRegion.SetSize( gridSize );
+  transform->SetGridRegion( gridRegion );
+  transform->SetGridSpacing( gridSpacing );
+  transform->SetGridOrigin( gridOrigin );
+
+  ParametersType parameters( transform->GetNumberOfParameters() );
+  for( unsigned int i = 0; i < parameters.GetSize(); ++i )
+  {
+    parameters[ i ] = 0.5 * std::sin( 0.37 * i );
+  }
+  transform->SetParameters( parameters );
+
+  /** The settings of the cases to test. */
+  const bool         sampleRandomly[] = { false, true, false, true };
+  const bool         subtractMean[]   = { false, false, true, true };
+  const unsigned int numberOfCases    = 4;
+
+  for( unsigned int c = 0; c < numberOfCases; ++c )
+  {
+    MeasureType    value[ 2 ];
+    DerivativeType derivative[ 2 ];
+    for( unsigned int useMultiThread = 0; useMultiThread < 2; ++useMultiThread )
+    {
+      MetricType::Pointer metric = MetricType::New();
+      metric->SetFixedImage( image );
+      metric->SetMovingImage( image );
+      metric->SetFixedImageRegion( image->GetLargestPossibleRegion() );
+      metric->SetTransform( transform );
+      metric->SetInterpolator( InterpolatorType::New() );
+      metric->SetImageSampler( SamplerType::New() );
+      metric->SetSampleLastDimensionRandomly( sampleRandomly[ c ] );
+      metric->SetNumSamplesLastDimension( 4 );
+      metric->SetSubtractMean( subtractMean[ c ] );
+      metric->SetGridSize( gridSize );
+      metric->SetTransformIsStackTransform( false );
+      metric->SetUseMultiThread( useMultiThread == 1 );
+      metric->Initialize();
+
+      /** Both runs should draw the same random positions. */
+      itk::Statistics::MersenneTwisterRandomVariateGenerator::GetInstance()->SetSeed( 2016 );
+      metric->GetValueAndDerivative( parameters, value[ useMultiThread ], derivative[ useMultiThread ] );
+    }
+
+    /** Compare the results. */
+    const double tolerance = 1e-10;
+    double       maxDifference = 0.0;
+    double       maxDerivative = 0.0;
+    if( derivative[ 0 ].GetSize() != derivative[ 1 ].GetSize() )
+    {
+      std::cerr << "ERROR: the derivatives have different sizes." << std::endl;
+      return EXIT_FAILURE;
+    }
+    for( unsigned int i = 0; i < derivative[ 0 ].GetSize(); ++i )
+    {
+      maxDifference = std::max( maxDifference, std::abs( derivative[ 0 ][ i ] - derivative[ 1 ][ i ] ) );
+      maxDerivative = std::max( maxDerivative, std::abs( derivative[ 0 ][ i ] ) );
+    }
+
+    std::cout << "Case " << c << ": value " << value[ 0 ] << " / " << value[ 1 ]
+              << ", maximum derivative difference " << maxDifference << std::endl;
+
+    if( std::abs( value[ 0 ] - value[ 1 ] ) > tolerance * std::abs( value[ 0 ] )
+      || maxDifference > tolerance * maxDerivative )
+    {
+      std::cerr << "ERROR: the single- and multi-threaded results differ." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+
+} // end main